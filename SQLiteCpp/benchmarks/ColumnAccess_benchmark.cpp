@@ -0,0 +1,96 @@
+/**
+ * @file    ColumnAccess_benchmark.cpp
+ * @ingroup benchmarks
+ * @brief   Compare the time to scan rows with Column objects, ColumnView and typed getColumns().
+ *
+ * Usage: SQLiteCpp_ColumnAccess_benchmark [row count]
+ *
+ * Copyright (c) 2012-2016 Sebastien Rombauts (sebastien.rombauts@gmail.com)
+ *
+ * Distributed under the MIT License (MIT) (See accompanying file LICENSE.txt
+ * or copy at http://opensource.org/licenses/MIT)
+ */
+
+#include <SQLiteCpp/SQLiteCpp.h>
+
+#include <chrono>
+#include <cstdlib>
+#include <iostream>
+#include <string>
+#include <vector>
+
+
+/// Time one full scan of the table, and print the number of rows per second
+template<typename Scan>
+static void run(SQLite::Database& aDatabase, const char* apName, const int aRowCount, Scan aScan)
+{
+    SQLite::Statement query(aDatabase, "SELECT id, name, weight FROM test");
+    const std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+    long long checksum = 0;
+    while (query.executeStep())
+    {
+        checksum += aScan(query);
+    }
+    const double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    std::cout << apName << ": " << seconds * 1000 << " ms, "
+              << static_cast<long long>(aRowCount / seconds) << " rows/s (checksum " << checksum << ")\n";
+}
+
+int main(int argc, char** argv)
+{
+    const int rowCount = (argc > 1) ? std::atoi(argv[1]) : 1000000;
+
+    SQLite::Database db(":memory:", SQLite::OPEN_READWRITE|SQLite::OPEN_CREATE);
+    db.exec("CREATE TABLE test (id INTEGER PRIMARY KEY, name TEXT, weight REAL)");
+    {
+        std::vector<std::string> columns;
+        columns.push_back("id");
+        columns.push_back("name");
+        columns.push_back("weight");
+        SQLite::BulkInserter inserter(db, "test", columns);
+        for (int i = 0; i < rowCount; ++i)
+        {
+            inserter.insert(i, "name of the row number " + std::to_string(i), i * 0.5);
+        }
+        inserter.flush();
+    }
+    std::cout << rowCount << " rows\n";
+
+    run(db, "Column by index     ", rowCount, [](SQLite::Statement& aQuery) {
+        const int id = aQuery.getColumn(0).getInt();
+        const std::string name = aQuery.getColumn(1).getString();
+        const double weight = aQuery.getColumn(2).getDouble();
+        return id + static_cast<long long>(name.size()) + static_cast<long long>(weight);
+    });
+    run(db, "Column by name      ", rowCount, [](SQLite::Statement& aQuery) {
+        const int id = aQuery.getColumn("id").getInt();
+        const std::string name = aQuery.getColumn("name").getString();
+        const double weight = aQuery.getColumn("weight").getDouble();
+        return id + static_cast<long long>(name.size()) + static_cast<long long>(weight);
+    });
+    run(db, "ColumnView by index ", rowCount, [](SQLite::Statement& aQuery) {
+        const int id = aQuery.getColumnView(0).getInt();
+        const int nameSize = aQuery.getColumnView(1).getBytes();
+        const double weight = aQuery.getColumnView(2).getDouble();
+        return id + nameSize + static_cast<long long>(weight);
+    });
+    run(db, "ColumnView by name  ", rowCount, [](SQLite::Statement& aQuery) {
+        const int id = aQuery.getColumnView("id").getInt();
+        const int nameSize = aQuery.getColumnView("name").getBytes();
+        const double weight = aQuery.getColumnView("weight").getDouble();
+        return id + nameSize + static_cast<long long>(weight);
+    });
+#if (__cplusplus >= 201703L) || (defined(_MSVC_LANG) && (_MSVC_LANG >= 201703L))
+    run(db, "getColumns<string_view>", rowCount, [](SQLite::Statement& aQuery) {
+        const auto [id, name, weight] = aQuery.getColumns<int, std::string_view, double>();
+        return id + static_cast<long long>(name.size()) + static_cast<long long>(weight);
+    });
+#elif (__cplusplus >= 201402L) || ( defined(_MSC_VER) && (_MSC_VER >= 1900) )
+    run(db, "getColumns<const char*>", rowCount, [](SQLite::Statement& aQuery) {
+        const std::tuple<int, const char*, double> row = aQuery.getColumns<int, const char*, double>();
+        return std::get<0>(row) + static_cast<long long>(std::get<1>(row)[0]) + static_cast<long long>(std::get<2>(row));
+    });
+#endif
+
+    return EXIT_SUCCESS;
+}
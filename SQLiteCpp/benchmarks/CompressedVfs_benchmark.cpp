@@ -0,0 +1,105 @@
+/**
+ * @file    CompressedVfs_benchmark.cpp
+ * @ingroup benchmarks
+ * @brief   Compare the file size, the write and the read throughput of a database of JSON documents,
+ *          with the default VFS and with the zlib CompressedVfs.
+ *
+ * Usage: SQLiteCpp_CompressedVfs_benchmark [document count] [compression level] [cache size in KiB]
+ *
+ * Copyright (c) 2012-2016 Sebastien Rombauts (sebastien.rombauts@gmail.com)
+ *
+ * Distributed under the MIT License (MIT) (See accompanying file LICENSE.txt
+ * or copy at http://opensource.org/licenses/MIT)
+ */
+
+#include <SQLiteCpp/SQLiteCpp.h>
+#include <SQLiteCpp/CompressedVfs.h>
+
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <iostream>
+#include <string>
+
+
+/// Return the size of a file, in bytes
+static long long getFileSize(const char* apFilename)
+{
+    std::ifstream file(apFilename, std::ios::binary | std::ios::ate);
+    return static_cast<long long>(file.tellg());
+}
+
+/// Return a JSON document, compressible as typical application data
+static std::string getDocument(const int aIndex)
+{
+    const std::string id = std::to_string(aIndex);
+    return "{\"id\":" + id + ",\"name\":\"user " + id + "\",\"email\":\"user" + id + "@example.com\""
+           ",\"address\":{\"street\":\"" + std::to_string(aIndex % 997) + " Main Street\",\"city\":\"Springfield\""
+           ",\"zip\":\"" + std::to_string(10000 + aIndex % 89999) + "\"},\"tags\":[\"alpha\",\"beta\",\"gamma\"]"
+           ",\"active\":" + ((aIndex % 3) ? "true" : "false") + ",\"score\":" + std::to_string(aIndex % 1000) + "}";
+}
+
+/// Write the documents to a new database, read them back, and print the file size and the throughputs
+static void run(const char* apName, const char* apFilename, const char* apVfs, const int aCount, const int aCacheKiB)
+{
+    std::remove(apFilename);
+    long long bytes = 0;
+    double writeSeconds = 0.0;
+    {
+        SQLite::Database db(apFilename, SQLite::OPEN_READWRITE|SQLite::OPEN_CREATE, 0, apVfs);
+        db.exec("CREATE TABLE docs (id INTEGER PRIMARY KEY, doc TEXT)");
+        const std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+        SQLite::Transaction transaction(db);
+        SQLite::Statement insert(db, "INSERT INTO docs (doc) VALUES (?)");
+        for (int i = 0; i < aCount; ++i)
+        {
+            const std::string document = getDocument(i);
+            bytes += static_cast<long long>(document.size());
+            insert.bind(1, document);
+            insert.exec();
+            insert.reset();
+        }
+        transaction.commit();
+        writeSeconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    }
+    const long long fileSize = getFileSize(apFilename);
+
+    double readSeconds = 0.0;
+    long long readBytes = 0;
+    {
+        // A new connection, with a small page cache, reads all the pages through the VFS
+        SQLite::Database db(apFilename, SQLite::OPEN_READONLY, 0, apVfs);
+        db.exec("PRAGMA cache_size=-" + std::to_string(aCacheKiB));
+        const std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+        readBytes = db.execAndGet("SELECT sum(length(doc)) FROM docs").getInt64();
+        readSeconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    }
+    std::remove(apFilename);
+
+    const double megabytes = bytes / (1024.0 * 1024.0);
+    std::cout << apName << ": " << fileSize / 1024 << " KiB"
+              << ", write " << writeSeconds * 1000 << " ms (" << megabytes / writeSeconds << " MiB/s)"
+              << ", read " << readSeconds * 1000 << " ms (" << megabytes / readSeconds << " MiB/s)"
+              << (readBytes == bytes ? "" : " MISMATCH") << "\n";
+}
+
+int main(int argc, char** argv)
+{
+    const int count = (argc > 1) ? std::atoi(argv[1]) : 200000;
+    const int level = (argc > 2) ? std::atoi(argv[2]) : -1;
+    const int cacheKiB = (argc > 3) ? std::atoi(argv[3]) : 2000;
+
+    SQLite::CompressedVfs vfs("zlib", level);
+    std::cout << count << " documents of " << getDocument(count / 2).size() << " bytes, zlib level " << level << "\n";
+
+    run("default VFS ", "CompressedVfs_benchmark_default.db3", NULL, count, cacheKiB);
+    run("zlib VFS    ", "CompressedVfs_benchmark_zlib.db3", vfs.getName().c_str(), count, cacheKiB);
+
+    const SQLite::CompressedVfs::Stats stats = vfs.getStats();
+    std::cout << "zlib VFS: " << stats.mPagesWritten << " pages written, compressed to "
+              << (stats.mBytesWritten > 0 ? 100 * stats.mCompressedBytes / stats.mBytesWritten : 0) << "%, "
+              << stats.mPagesRead << " pages read, " << stats.mCacheHits << " cache hits, "
+              << stats.mCommits << " commits\n";
+    return 0;
+}
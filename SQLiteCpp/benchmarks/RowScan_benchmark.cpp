@@ -0,0 +1,98 @@
+/**
+ * @file    RowScan_benchmark.cpp
+ * @ingroup benchmarks
+ * @brief   Compare the time to scan a large table row by row, with a typed row iterator, and by columnar batches.
+ *
+ * Usage: SQLiteCpp_RowScan_benchmark [row count] [batch size]
+ *
+ * Copyright (c) 2012-2016 Sebastien Rombauts (sebastien.rombauts@gmail.com)
+ *
+ * Distributed under the MIT License (MIT) (See accompanying file LICENSE.txt
+ * or copy at http://opensource.org/licenses/MIT)
+ */
+
+#include <SQLiteCpp/SQLiteCpp.h>
+
+#include <chrono>
+#include <cstdlib>
+#include <iostream>
+#include <string>
+#include <vector>
+
+
+/// Time one full scan of the table, and print the number of rows per second
+template<typename Scan>
+static void run(SQLite::Database& aDatabase, const char* apName, const int aRowCount, Scan aScan)
+{
+    SQLite::Statement query(aDatabase, "SELECT id, quantity, price FROM test");
+    const std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+    const double total = aScan(query);
+    const double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    std::cout << apName << ": " << seconds * 1000 << " ms, "
+              << static_cast<long long>(aRowCount / seconds) << " rows/s (total " << total << ")\n";
+}
+
+int main(int argc, char** argv)
+{
+    const int rowCount = (argc > 1) ? std::atoi(argv[1]) : 10000000;
+
+    SQLite::Database db(":memory:", SQLite::OPEN_READWRITE|SQLite::OPEN_CREATE);
+    db.exec("CREATE TABLE test (id INTEGER PRIMARY KEY, quantity INTEGER, price REAL)");
+    {
+        std::vector<std::string> columns;
+        columns.push_back("id");
+        columns.push_back("quantity");
+        columns.push_back("price");
+        SQLite::BulkInserter inserter(db, "test", columns);
+        for (int i = 0; i < rowCount; ++i)
+        {
+            inserter.insert(i, i % 100, (i % 1000) * 0.25);
+        }
+        inserter.flush();
+    }
+    std::cout << rowCount << " rows\n";
+
+    run(db, "executeStep/getColumn       ", rowCount, [](SQLite::Statement& aQuery) {
+        double total = 0.0;
+        while (aQuery.executeStep())
+        {
+            const long long id = aQuery.getColumn(0);
+            const int quantity = aQuery.getColumn(1);
+            const double price = aQuery.getColumn(2);
+            total += (id & 1) + quantity * price;
+        }
+        return total;
+    });
+#if (__cplusplus >= 201402L) || ( defined(_MSC_VER) && (_MSC_VER >= 1900) )
+    const std::size_t batchSize = (argc > 2) ? std::atoi(argv[2]) : 4096;
+    run(db, "rows<long long, int, double>", rowCount, [](SQLite::Statement& aQuery) {
+        double total = 0.0;
+        for (const std::tuple<long long, int, double>& row : aQuery.rows<long long, int, double>())
+        {
+            total += (std::get<0>(row) & 1) + std::get<1>(row) * std::get<2>(row);
+        }
+        return total;
+    });
+    run(db, "fetchColumns batches        ", rowCount, [batchSize](SQLite::Statement& aQuery) {
+        double total = 0.0;
+        std::vector<long long> ids;
+        std::vector<int> quantities;
+        std::vector<double> prices;
+        while (aQuery.fetchColumns(batchSize, ids, quantities, prices) > 0)
+        {
+            // Vectorizable loop over contiguous arrays
+            const std::size_t count = prices.size();
+            const long long* pIds = ids.data();
+            const int* pQuantities = quantities.data();
+            const double* pPrices = prices.data();
+            for (std::size_t i = 0; i < count; ++i)
+            {
+                total += (pIds[i] & 1) + pQuantities[i] * pPrices[i];
+            }
+        }
+        return total;
+    });
+#endif
+
+    return EXIT_SUCCESS;
+}
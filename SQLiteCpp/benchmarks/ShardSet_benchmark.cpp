@@ -0,0 +1,124 @@
+/**
+ * @file    ShardSet_benchmark.cpp
+ * @ingroup benchmarks
+ * @brief   Compare a query on each shard of a set of databases, run in a sequential loop and in parallel by a ShardSet.
+ *
+ * Usage: SQLiteCpp_ShardSet_benchmark [shard count] [rows per shard] [thread count]
+ *
+ * Copyright (c) 2012-2016 Sebastien Rombauts (sebastien.rombauts@gmail.com)
+ *
+ * Distributed under the MIT License (MIT) (See accompanying file LICENSE.txt
+ * or copy at http://opensource.org/licenses/MIT)
+ */
+
+#include <SQLiteCpp/SQLiteCpp.h>
+
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <iostream>
+#include <string>
+#include <vector>
+
+
+/// Query scanning a whole shard, as a cross-shard report does
+static const char* const QUERY = "SELECT country, count(*), sum(amount), max(amount) FROM orders WHERE amount > ? GROUP BY country";
+
+/// Create the shards, each one with its own orders
+static std::vector<std::string> createShards(const int aShardCount, const int aRowCount)
+{
+    std::vector<std::string> filenames;
+    for (int shard = 0; shard < aShardCount; ++shard)
+    {
+        const std::string filename = "ShardSet_benchmark_" + std::to_string(shard) + ".db3";
+        std::remove(filename.c_str());
+        SQLite::Database db(filename, SQLite::OPEN_READWRITE|SQLite::OPEN_CREATE);
+        db.exec("CREATE TABLE orders (id INTEGER PRIMARY KEY, country TEXT, amount INTEGER)");
+        SQLite::Transaction transaction(db);
+        SQLite::Statement insert(db, "INSERT INTO orders (country, amount) VALUES (?, ?)");
+        for (int i = 0; i < aRowCount; ++i)
+        {
+            static const char* const countries[] = { "de", "es", "fr", "it", "uk" };
+            insert.bind(1, countries[(i * 7 + shard) % 5]);
+            insert.bind(2, (i * 31 + shard) % 1000);
+            insert.exec();
+            insert.reset();
+        }
+        transaction.commit();
+        filenames.push_back(filename);
+    }
+    return filenames;
+}
+
+/// Return the elapsed time since the provided time point, in milliseconds
+static double getElapsedMs(const std::chrono::steady_clock::time_point& aStart)
+{
+    return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - aStart).count();
+}
+
+int main(int argc, char** argv)
+{
+    const int shardCount = (argc > 1) ? std::atoi(argv[1]) : 16;
+    const int rowCount = (argc > 2) ? std::atoi(argv[2]) : 200000;
+    const std::size_t threadCount = (argc > 3) ? static_cast<std::size_t>(std::atoi(argv[3])) : 0;
+    const int iterations = 5;
+
+    const std::vector<std::string> filenames = createShards(shardCount, rowCount);
+    long long checksum = 0;
+    {
+        // Sequential loop over the shards, combining the counts by hand
+        std::vector<SQLite::Database*> databases;
+        for (std::size_t i = 0; i < filenames.size(); ++i)
+        {
+            databases.push_back(new SQLite::Database(filenames[i]));
+        }
+        const std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+        for (int iteration = 0; iteration < iterations; ++iteration)
+        {
+            long long count = 0;
+            for (std::size_t i = 0; i < databases.size(); ++i)
+            {
+                SQLite::Statement query(*databases[i], QUERY);
+                query.bind(1, 100);
+                while (query.executeStep())
+                {
+                    count += query.getColumn(1).getInt64();
+                }
+            }
+            checksum = count;
+        }
+        std::cout << "sequential loop: " << getElapsedMs(start) / iterations << " ms per query\n";
+        for (std::size_t i = 0; i < databases.size(); ++i)
+        {
+            delete databases[i];
+        }
+    }
+    {
+        SQLite::ShardSet shards(filenames, SQLite::OPEN_READONLY, threadCount);
+        const SQLite::ShardSet::Aggregate columns[] = { SQLite::ShardSet::KEY, SQLite::ShardSet::COUNT,
+                                                        SQLite::ShardSet::SUM, SQLite::ShardSet::MAX };
+        const std::vector<SQLite::ShardSet::Aggregate> aggregates(columns, columns + 4);
+        const std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+        for (int iteration = 0; iteration < iterations; ++iteration)
+        {
+            const std::vector<SQLite::ShardSet::TRow> rows = shards.aggregate(QUERY, aggregates, SQLite::ShardSet::TShards(),
+                                                                              [](SQLite::Statement& aQuery) { aQuery.bind(1, 100); });
+            long long count = 0;
+            for (std::size_t i = 0; i < rows.size(); ++i)
+            {
+                count += rows[i][1].mInteger;
+            }
+            if (count != checksum)
+            {
+                std::cout << "MISMATCH ";
+            }
+        }
+        std::cout << "ShardSet, " << shards.getThreadCount() << " threads: " << getElapsedMs(start) / iterations << " ms per query\n";
+    }
+
+    for (std::size_t i = 0; i < filenames.size(); ++i)
+    {
+        std::remove(filenames[i].c_str());
+    }
+    return 0;
+}
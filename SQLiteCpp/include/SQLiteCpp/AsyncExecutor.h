@@ -0,0 +1,315 @@
+/**
+ * @file    AsyncExecutor.h
+ * @ingroup SQLiteCpp
+ * @brief   Asynchronous execution of queries on dedicated reader threads and a single group-committing writer thread.
+ *
+ * Copyright (c) 2012-2016 Sebastien Rombauts (sebastien.rombauts@gmail.com)
+ *
+ * Distributed under the MIT License (MIT) (See accompanying file LICENSE.txt
+ * or copy at http://opensource.org/licenses/MIT)
+ */
+#pragma once
+
+#include <SQLiteCpp/ConnectionPool.h>
+
+#include <string>
+#include <vector>
+#include <deque>
+#include <memory>
+#include <thread>
+#include <future>
+#include <mutex>
+#include <condition_variable>
+#include <exception>
+#include <type_traits>
+#include <utility>
+
+
+namespace SQLite
+{
+
+
+/**
+ * @brief Asynchronous execution of queries, on threads owning their own Database Connections.
+ *
+ *  The executor opens a ConnectionPool on a WAL database, and dedicates one thread to each of its readers
+ * and one thread to its writer. Queries are closures taking the Database Connection, "R function(Database&)",
+ * queued with read() or write(); their result, or their exception, is delivered through a std::future<R>,
+ * or through any completion object with submit() (see AsyncExecutorPplx.h for pplx::task).
+ * The calling threads never block on disk I/O nor on database locks.
+ *
+ *  Writes are group-committed: the writer thread takes all the queued writes (up to a maximum),
+ * runs each of them in its own SAVEPOINT inside a single transaction, and commits once,
+ * so many small concurrent writes cost one fsync instead of one each.
+ * A write which throws is rolled back to its savepoint alone, and fails alone;
+ * the results of the other writes are only delivered once the transaction has been committed.
+ * If the error of a write makes SQLite roll back the whole transaction (SQLITE_FULL, SQLITE_IOERR, SQLITE_BUSY...),
+ * the writes which have run before it in the transaction fail with the same exception,
+ * and the next ones run in a new transaction.
+ * A write closure must not begin nor commit transactions itself.
+ *
+ * Thread-safety: read(), write() and submit() can be called from any thread.
+ * A closure must not keep references to the Database Connection, nor to the Statement objects it built, after it returns.
+ */
+class AsyncExecutor
+{
+public:
+    /// Type of the result of a query closure, delivered by value
+    template<typename Function>
+    struct Result
+    {
+        typedef typename std::decay<decltype(std::declval<Function&>()(std::declval<Database&>()))>::type type;
+    };
+
+    /**
+     * @brief Completion object delivering the result of a query to a std::promise.
+     *
+     *  Any completion object given to submit() must provide the same setValue() and setException() methods.
+     */
+    template<typename R>
+    class FutureCompletion
+    {
+    public:
+        explicit FutureCompletion(const std::shared_ptr<std::promise<R> >& aPromise) :
+            mPromise(aPromise)
+        {
+        }
+        void setValue(R&& aValue)
+        {
+            mPromise->set_value(std::move(aValue));
+        }
+        void setException(const std::exception_ptr& aException)
+        {
+            mPromise->set_exception(aException);
+        }
+
+    private:
+        std::shared_ptr<std::promise<R> > mPromise; ///< Promise of the future returned to the caller
+    };
+
+    /**
+     * @brief Open the database and start the reader and writer threads.
+     *
+     * @param[in] aFilename             UTF-8 path/uri to the database file
+     * @param[in] aReaderCount          Number of reader threads, each with its read-only connection
+     * @param[in] aSetup                Optional function called once on each connection (see ConnectionPool)
+     * @param[in] aMaxWritesPerCommit   Maximum number of queued writes group-committed in one transaction
+     *
+     * @throw SQLite::Exception in case of error
+     */
+    AsyncExecutor(const std::string&            aFilename,
+                  const std::size_t             aReaderCount = 2,
+                  const ConnectionPool::TSetup& aSetup = ConnectionPool::TSetup(),
+                  const std::size_t             aMaxWritesPerCommit = 1000);
+
+    /// Execute all the queued queries, then stop the threads and close the database.
+    ~AsyncExecutor() noexcept; // nothrow
+
+    /**
+     * @brief Queue a read-only query, executed by the first idle reader thread.
+     *
+     * @param[in] aFunction Closure "R function(Database&)" executing the query
+     *
+     * @return the future result of the closure
+     */
+    template<typename Function>
+    std::future<typename Result<Function>::type> read(Function aFunction)
+    {
+        typedef typename Result<Function>::type R;
+        const std::shared_ptr<std::promise<R> > promise = std::make_shared<std::promise<R> >();
+        std::future<R> future = promise->get_future();
+        submit(false, std::move(aFunction), FutureCompletion<R>(promise));
+        return future;
+    }
+
+    /**
+     * @brief Queue a write, group-committed with the other queued writes by the writer thread.
+     *
+     * @param[in] aFunction Closure "R function(Database&)" executing the write
+     *
+     * @return the future result of the closure, ready once the write has been committed
+     */
+    template<typename Function>
+    std::future<typename Result<Function>::type> write(Function aFunction)
+    {
+        typedef typename Result<Function>::type R;
+        const std::shared_ptr<std::promise<R> > promise = std::make_shared<std::promise<R> >();
+        std::future<R> future = promise->get_future();
+        submit(true, std::move(aFunction), FutureCompletion<R>(promise));
+        return future;
+    }
+
+    /**
+     * @brief Queue a query, delivering its result to a completion object.
+     *
+     * @param[in] abWrite       true for a write, false for a read-only query
+     * @param[in] aFunction     Closure "R function(Database&)" executing the query
+     * @param[in] aCompletion   Object with "setValue(R&&)" (or "setValue()" for void) and "setException(std::exception_ptr)",
+     *                          called on the reader or writer thread
+     *
+     * @throw SQLite::Exception if the executor is stopping
+     */
+    template<typename Function, typename Completion>
+    void submit(const bool abWrite, Function aFunction, Completion aCompletion)
+    {
+        typedef typename Result<Function>::type R;
+        std::unique_ptr<Task> task(new Job<R, Function, Completion>(std::move(aFunction), std::move(aCompletion)));
+        enqueue(abWrite, std::move(task));
+    }
+
+    /// Return the number of writes committed so far.
+    unsigned long long getWriteCount() const;
+
+    /// Return the number of transactions committed so far (each grouping one or more writes).
+    unsigned long long getCommitCount() const;
+
+private:
+    /// @{ AsyncExecutor must be non-copyable
+    AsyncExecutor(const AsyncExecutor&);
+    AsyncExecutor& operator=(const AsyncExecutor&);
+    /// @}
+
+    /// Queued query, with its completion
+    class Task
+    {
+    public:
+        virtual ~Task() noexcept {} // nothrow
+        /// Execute the query, keeping its result until complete()
+        virtual void run(Database& aDatabase) = 0;
+        /// Deliver the result
+        virtual void complete() noexcept = 0; // nothrow
+        /// Deliver an error
+        virtual void fail(const std::exception_ptr& aException) noexcept = 0; // nothrow
+    };
+
+    /// Result kept between run() and complete()
+    template<typename R>
+    struct Value
+    {
+        template<typename Function>
+        void run(Function& aFunction, Database& aDatabase)
+        {
+            mValue.reset(new R(aFunction(aDatabase)));
+        }
+        template<typename Completion>
+        void complete(Completion& aCompletion)
+        {
+            aCompletion.setValue(std::move(*mValue));
+        }
+        std::unique_ptr<R> mValue;
+    };
+
+    /// Typed queued query
+    template<typename R, typename Function, typename Completion>
+    class Job : public Task
+    {
+    public:
+        Job(Function&& aFunction, Completion&& aCompletion) :
+            mFunction(std::move(aFunction)),
+            mCompletion(std::move(aCompletion))
+        {
+        }
+        virtual void run(Database& aDatabase)
+        {
+            mValue.run(mFunction, aDatabase);
+        }
+        virtual void complete() noexcept // nothrow
+        {
+            try
+            {
+                mValue.complete(mCompletion);
+            }
+            catch (...)
+            {
+                fail(std::current_exception());
+            }
+        }
+        virtual void fail(const std::exception_ptr& aException) noexcept // nothrow
+        {
+            try
+            {
+                mCompletion.setException(aException);
+            }
+            catch (...)
+            {
+                // Nobody left to report to: the completion object itself is broken
+            }
+        }
+
+    private:
+        Function    mFunction;      ///< Closure executing the query
+        Completion  mCompletion;    ///< Completion object delivering the result
+        Value<R>    mValue;         ///< Result kept until complete()
+    };
+
+    typedef std::deque<std::unique_ptr<Task> > TTasks;
+
+    /// Queue a task for the readers or the writer
+    void enqueue(const bool abWrite, std::unique_ptr<Task>&& aTask);
+
+    /// Loop of the reader threads
+    void readLoop(ConnectionPool::Connection aReader) noexcept; // nothrow
+
+    /// Loop of the writer thread
+    void writeLoop(ConnectionPool::Connection aWriter) noexcept; // nothrow
+
+    /// Execute a group of writes in one transaction
+    void commitGroup(Database& aDatabase, TTasks& aWrites) noexcept; // nothrow
+
+    /// Rollback the transaction of the writer, if SQLite has not already done it
+    static void rollback(Database& aDatabase) noexcept; // nothrow
+
+private:
+    ConnectionPool              mPool;                  ///< Connections of the threads
+    std::size_t                 mMaxWritesPerCommit;    ///< Maximum number of writes per transaction
+    mutable std::mutex          mMutex;                 ///< Protect the queues and the counters
+    std::condition_variable     mReadQueued;            ///< Signaled when a read is queued, or on stop
+    std::condition_variable     mWriteQueued;           ///< Signaled when a write is queued, or on stop
+    TTasks                      mReads;                 ///< Queued reads
+    TTasks                      mWrites;                ///< Queued writes
+    bool                        mbStopping;             ///< True when the threads must stop once the queues are empty
+    unsigned long long          mWriteCount;            ///< Number of writes committed
+    unsigned long long          mCommitCount;           ///< Number of transactions committed
+    std::vector<std::thread>    mThreads;               ///< Reader threads, then the writer thread
+};
+
+/// @cond
+template<>
+struct AsyncExecutor::Value<void>
+{
+    template<typename Function>
+    void run(Function& aFunction, Database& aDatabase)
+    {
+        aFunction(aDatabase);
+    }
+    template<typename Completion>
+    void complete(Completion& aCompletion)
+    {
+        aCompletion.setValue();
+    }
+};
+
+template<>
+class AsyncExecutor::FutureCompletion<void>
+{
+public:
+    explicit FutureCompletion(const std::shared_ptr<std::promise<void> >& aPromise) :
+        mPromise(aPromise)
+    {
+    }
+    void setValue()
+    {
+        mPromise->set_value();
+    }
+    void setException(const std::exception_ptr& aException)
+    {
+        mPromise->set_exception(aException);
+    }
+
+private:
+    std::shared_ptr<std::promise<void> > mPromise;
+};
+/// @endcond
+
+
+}  // namespace SQLite
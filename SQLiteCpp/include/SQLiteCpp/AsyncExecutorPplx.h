@@ -0,0 +1,102 @@
+/**
+ * @file    AsyncExecutorPplx.h
+ * @ingroup SQLiteCpp
+ * @brief   pplx::task results for the AsyncExecutor, for use in cpprestsdk applications.
+ *
+ *  Header only: requires the cpprestsdk include directory and library, which SQLiteCpp itself does not depend on.
+ *
+ * Copyright (c) 2012-2016 Sebastien Rombauts (sebastien.rombauts@gmail.com)
+ *
+ * Distributed under the MIT License (MIT) (See accompanying file LICENSE.txt
+ * or copy at http://opensource.org/licenses/MIT)
+ */
+#pragma once
+
+#include <SQLiteCpp/AsyncExecutor.h>
+
+#include <pplx/pplxtasks.h>
+
+
+namespace SQLite
+{
+
+
+/**
+ * @brief Completion object delivering the result of an AsyncExecutor query to a pplx::task_completion_event.
+ */
+template<typename R>
+class PplxCompletion
+{
+public:
+    explicit PplxCompletion(const pplx::task_completion_event<R>& aEvent) :
+        mEvent(aEvent)
+    {
+    }
+    void setValue(R&& aValue)
+    {
+        mEvent.set(std::move(aValue));
+    }
+    void setException(const std::exception_ptr& aException)
+    {
+        mEvent.set_exception(aException);
+    }
+
+private:
+    pplx::task_completion_event<R> mEvent;  ///< Event of the task returned to the caller
+};
+
+/// @cond
+template<>
+class PplxCompletion<void>
+{
+public:
+    explicit PplxCompletion(const pplx::task_completion_event<void>& aEvent) :
+        mEvent(aEvent)
+    {
+    }
+    void setValue()
+    {
+        mEvent.set();
+    }
+    void setException(const std::exception_ptr& aException)
+    {
+        mEvent.set_exception(aException);
+    }
+
+private:
+    pplx::task_completion_event<void> mEvent;
+};
+/// @endcond
+
+/**
+ * @brief Queue a read-only query on the AsyncExecutor, returning a pplx::task of its result.
+ *
+ *  The continuations of the task do not run on the reader thread, which is immediately free for the next query:
+ * \code{.cpp}
+ * return readTask(executor, [id](SQLite::Database& db) { return loadName(db, id); })
+ *     .then([response](std::string name) { ... });
+ * \endcode
+ */
+template<typename Function>
+pplx::task<typename AsyncExecutor::Result<Function>::type> readTask(AsyncExecutor& aExecutor, Function aFunction)
+{
+    typedef typename AsyncExecutor::Result<Function>::type R;
+    pplx::task_completion_event<R> event;
+    aExecutor.submit(false, std::move(aFunction), PplxCompletion<R>(event));
+    return pplx::create_task(event);
+}
+
+/**
+ * @brief Queue a write on the AsyncExecutor, returning a pplx::task of its result, completed once committed.
+ */
+template<typename Function>
+pplx::task<typename AsyncExecutor::Result<Function>::type> writeTask(AsyncExecutor& aExecutor, Function aFunction)
+{
+    typedef typename AsyncExecutor::Result<Function>::type R;
+    pplx::task_completion_event<R> event;
+    aExecutor.submit(true, std::move(aFunction), PplxCompletion<R>(event));
+    return pplx::create_task(event);
+}
+
+
+}  // namespace SQLite
@@ -0,0 +1,174 @@
+/**
+ * @file    BackupDriver.h
+ * @ingroup SQLiteCpp
+ * @brief   Incremental online backup, throttled to a target I/O rate, optionally on a background thread.
+ *
+ * Copyright (c) 2012-2016 Sebastien Rombauts (sebastien.rombauts@gmail.com)
+ *
+ * Distributed under the MIT License (MIT) (See accompanying file LICENSE.txt
+ * or copy at http://opensource.org/licenses/MIT)
+ */
+#pragma once
+
+#include <SQLiteCpp/Database.h>
+
+#include <string>
+#include <memory>
+#include <functional>
+#include <chrono>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <exception>
+
+
+namespace SQLite
+{
+
+
+/**
+ * @brief Drive a SQLite::Backup step by step, so that a large database can be copied while it keeps being used.
+ *
+ *  Backup::executeStep() without argument copies the whole source database in one call, keeping it read-locked
+ * for the whole copy. The driver instead copies a few pages per step, releasing the source between steps,
+ * and paces the steps to a target I/O rate, so that the backup does not starve the application of disk bandwidth.
+ *
+ *  When the source database is modified by another connection between two steps, SQLite restarts the backup
+ * from the first page. The driver counts those restarts, and after too many of them copies all the remaining pages
+ * in one last step, so that a backup of a busy database always completes.
+ *
+ *  The driver either runs synchronously with run(), or on its own thread with start() and wait().
+ * It reports its progress through an optional callback, called on the backup thread after each step,
+ * and can be cancelled at any time with cancel().
+ *
+ * Thread-safety: start(), cancel(), wait(), isRunning() and getProgress() can be called from any thread.
+ * The source and destination connections given to the driver shall not be used by other threads while it runs;
+ * use the constructor taking filenames to let the driver open its own connections.
+ */
+class BackupDriver
+{
+public:
+    /// Progress of the backup, as of the most recent step
+    struct Progress
+    {
+        int         mRemainingPages;    ///< Number of source pages still to be copied
+        int         mTotalPages;        ///< Total number of pages in the source database
+        unsigned    mRestartCount;      ///< Number of times the backup restarted because the source was modified
+        long long   mCopiedBytes;       ///< Number of bytes copied so far, including the pages copied before restarts
+    };
+
+    /// Function called on the backup thread after each step
+    typedef std::function<void (const Progress&)> TProgressHandler;
+
+    /**
+     * @brief Prepare the backup of the main database of a source file to a destination file.
+     *
+     *  The driver opens its own read-only connection to the source, and read-write connection to the destination,
+     * so the application can keep using its connections to the source database while the backup runs.
+     *
+     * @param[in] aDestFilename     UTF-8 path/uri to the destination database file, created if needed
+     * @param[in] aSrcFilename      UTF-8 path/uri to the source database file
+     *
+     * @throw SQLite::Exception in case of error
+     */
+    BackupDriver(const std::string& aDestFilename,
+                 const std::string& aSrcFilename);
+
+    /**
+     * @brief Prepare the backup of the main database between two existing connections.
+     *
+     *  Writes made through the source connection itself are also applied to the destination without restarting the backup,
+     * but the connections shall not be used by other threads while the backup runs.
+     *
+     * @param[in] aDestDatabase     Destination database connection
+     * @param[in] aSrcDatabase      Source database connection
+     */
+    BackupDriver(Database& aDestDatabase,
+                 Database& aSrcDatabase);
+
+    /// Cancel the backup if it is running on its thread, and wait for the thread to finish.
+    ~BackupDriver() noexcept; // nothrow
+
+    /// Set the number of source pages copied by each step (default 100).
+    void setPagesPerStep(const int aPagesPerStep);
+
+    /// Set the target I/O rate in bytes per second, or 0 to only yield between steps (default 0).
+    void setMaxBytesPerSecond(const long long aMaxBytesPerSecond);
+
+    /// Set the number of restarts after which all the remaining pages are copied in one step, or -1 for no limit (default 3).
+    void setMaxRestarts(const int aMaxRestarts);
+
+    /// Set the time to wait before retrying a step while the source or destination is busy or locked (default 100 ms).
+    void setBusyRetryMs(const int aBusyRetryMs);
+
+    /// Set the function called on the backup thread after each step.
+    void setProgressHandler(const TProgressHandler& aProgressHandler);
+
+    /**
+     * @brief Execute the whole backup on the calling thread.
+     *
+     * @return true if the backup completed, false if it was cancelled
+     *
+     * @throw SQLite::Exception in case of error, or any exception thrown by the progress handler
+     */
+    bool run();
+
+    /**
+     * @brief Start the backup on a background thread.
+     *
+     * @throw SQLite::Exception if the backup is already running
+     */
+    void start();
+
+    /**
+     * @brief Wait for the backup started by start() to finish.
+     *
+     * @return true if the backup completed, false if it was cancelled
+     *
+     * @throw the exception which stopped the backup thread, if any
+     */
+    bool wait();
+
+    /// Ask the running backup to stop as soon as possible, interrupting its throttling pause.
+    void cancel();
+
+    /// Return true while the backup runs, synchronously or on its thread.
+    bool isRunning() const;
+
+    /// Return the progress of the backup, as of the most recent step.
+    Progress getProgress() const;
+
+private:
+    /// @{ BackupDriver must be non-copyable
+    BackupDriver(const BackupDriver&);
+    BackupDriver& operator=(const BackupDriver&);
+    /// @}
+
+    /// Copy the database step by step
+    bool execute();
+
+    /// Pause until the given time, unless cancelled; return false if cancelled
+    bool pauseUntil(const std::chrono::steady_clock::time_point& aTime);
+
+private:
+    std::unique_ptr<Database>   mpOwnedDest;        ///< Destination connection opened by the driver, if any
+    std::unique_ptr<Database>   mpOwnedSrc;         ///< Source connection opened by the driver, if any
+    Database&                   mDest;              ///< Destination database connection
+    Database&                   mSrc;               ///< Source database connection
+    int                         mPagesPerStep;      ///< Number of pages copied by each step
+    long long                   mMaxBytesPerSecond; ///< Target I/O rate, 0 for no throttling
+    int                         mMaxRestarts;       ///< Number of restarts before copying the rest in one step, -1 for no limit
+    int                         mBusyRetryMs;       ///< Pause before retrying a busy step
+    TProgressHandler            mProgressHandler;   ///< Called after each step
+    mutable std::mutex          mMutex;             ///< Protect the state below
+    std::condition_variable     mCancelled;         ///< Signaled by cancel(), to interrupt a pause
+    bool                        mbRunning;          ///< True while the backup runs
+    bool                        mbCancelled;        ///< True when the backup must stop
+    bool                        mbCompleted;        ///< True if the backup thread completed the backup
+    Progress                    mProgress;          ///< Progress as of the most recent step
+    std::exception_ptr          mException;         ///< Exception which stopped the backup thread
+    std::thread                 mThread;            ///< Background thread of start()
+};
+
+
+}  // namespace SQLite
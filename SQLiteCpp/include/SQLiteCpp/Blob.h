@@ -0,0 +1,188 @@
+/**
+ * @file    Blob.h
+ * @ingroup SQLiteCpp
+ * @brief   Incremental I/O on a BLOB value, streamed by chunks instead of held in memory.
+ *
+ * Copyright (c) 2012-2016 Sebastien Rombauts (sebastien.rombauts@gmail.com)
+ *
+ * Distributed under the MIT License (MIT) (See accompanying file LICENSE.txt
+ * or copy at http://opensource.org/licenses/MIT)
+ */
+#pragma once
+
+#include <SQLiteCpp/Database.h>
+
+#include <string>
+#include <vector>
+#include <streambuf>
+
+// Forward declarations to avoid inclusion of <sqlite3.h> in a header
+struct sqlite3;
+struct sqlite3_blob;
+
+
+namespace SQLite
+{
+
+
+/**
+ * @brief RAII encapsulation of a SQLite BLOB handle, for incremental I/O on one BLOB value.
+ *
+ *  Statement::bind() and Column::getBlob() need the whole value in memory. A Blob instead reads or writes
+ * any chunk of a BLOB at a given offset, so large values can be streamed with a constant amount of memory.
+ * See BlobStreamBuf for a std::streambuf over a Blob, and BlobCpprest.h for a cpprestsdk stream buffer.
+ *
+ *  Incremental I/O cannot change the size of a BLOB: to write a new value, first insert a zero-filled BLOB
+ * of the final size, with the SQL function "zeroblob(N)", then open it with a read-write Blob.
+ * \code{.cpp}
+ * SQLite::Statement insert(db, "INSERT INTO attachment (data) VALUES (zeroblob(?))");
+ * insert.bind(1, size);
+ * insert.exec();
+ * SQLite::Blob blob(db, "attachment", "data", db.getLastInsertRowid(), true);
+ * for (int offset = 0; offset < size; offset += chunkSize) { blob.write(chunk, chunkSize, offset); }
+ * \endcode
+ *
+ *  The handle is invalidated ("expired") when the row is modified or deleted by another statement:
+ * any further read or write then throws. reopen() moves the handle to another row of the same column,
+ * much faster than opening a new Blob.
+ *
+ * Thread-safety: a Blob object shall not be shared by multiple threads,
+ * and its Database connection shall not be used by other threads at the same time.
+ */
+class Blob
+{
+public:
+    /**
+     * @brief Open the BLOB value of a column of a row.
+     *
+     * @param[in] aDatabase         Database connection
+     * @param[in] aTable            Name of the table
+     * @param[in] aColumn           Name of the BLOB (or TEXT) column
+     * @param[in] aRowid            ROWID of the row
+     * @param[in] abReadWrite       true to open the BLOB for reading and writing, false for reading only
+     * @param[in] aDatabaseName     "main" for the main database, "temp", or the name of an attached database
+     *
+     * @throw SQLite::Exception in case of error, for instance if the row does not exist
+     */
+    Blob(Database&          aDatabase,
+         const std::string& aTable,
+         const std::string& aColumn,
+         const long long    aRowid,
+         const bool         abReadWrite = false,
+         const std::string& aDatabaseName = "main");
+
+    /// Close the BLOB handle.
+    ~Blob() noexcept; // nothrow
+
+    /**
+     * @brief Read a chunk of the BLOB.
+     *
+     * @param[out] apBuffer     Buffer of at least aSize bytes
+     * @param[in]  aSize        Number of bytes to read
+     * @param[in]  aOffset      Offset of the first byte to read; the chunk cannot extend past the end of the BLOB
+     *
+     * @throw SQLite::Exception in case of error, or if the row has been modified since the BLOB was opened
+     */
+    void read(void* apBuffer, const int aSize, const int aOffset);
+
+    /**
+     * @brief Write a chunk of the BLOB, which must have been opened for reading and writing.
+     *
+     * @param[in] apBuffer      Bytes to write
+     * @param[in] aSize         Number of bytes to write
+     * @param[in] aOffset       Offset of the first byte to write; the chunk cannot extend past the end of the BLOB
+     *
+     * @throw SQLite::Exception in case of error, or if the row has been modified since the BLOB was opened
+     */
+    void write(const void* apBuffer, const int aSize, const int aOffset);
+
+    /**
+     * @brief Move the handle to the same column of another row.
+     *
+     * @param[in] aRowid    ROWID of the new row
+     *
+     * @throw SQLite::Exception in case of error; the handle is then expired, and can only be reopened
+     */
+    void reopen(const long long aRowid);
+
+    /// Return the size of the BLOB in bytes.
+    int getBytes() const noexcept; // nothrow
+
+    /// Return the ROWID of the row of the BLOB.
+    long long getRowid() const noexcept // nothrow
+    {
+        return mRowid;
+    }
+
+    /// Return true if the BLOB has been opened for reading and writing.
+    bool isReadWrite() const noexcept // nothrow
+    {
+        return mbReadWrite;
+    }
+
+private:
+    /// @{ Blob must be non-copyable
+    Blob(const Blob&);
+    Blob& operator=(const Blob&);
+    /// @}
+
+private:
+    sqlite3*        mpSQLite;       ///< Pointer to SQLite Database Connection Handle, for error messages
+    sqlite3_blob*   mpBlob;         ///< Pointer to SQLite BLOB Handle
+    long long       mRowid;         ///< ROWID of the row of the BLOB
+    bool            mbReadWrite;    ///< true if the BLOB has been opened for reading and writing
+};
+
+
+/**
+ * @brief Buffered std::streambuf over a Blob, to use it with a std::istream or std::ostream.
+ *
+ *  Reads and writes go through a fixed size buffer, and reads larger than the buffer go directly to the Blob.
+ * The stream can seek anywhere inside the BLOB, but cannot write past its end.
+ * Errors of the Blob are reported as exceptions, which the standard streams turn into their badbit.
+ * \code{.cpp}
+ * SQLite::Blob blob(db, "attachment", "data", id);
+ * SQLite::BlobStreamBuf buffer(blob);
+ * std::istream input(&buffer);
+ * std::ofstream output("attachment.bin", std::ios_base::binary);
+ * output << input.rdbuf();
+ * \endcode
+ */
+class BlobStreamBuf : public std::streambuf
+{
+public:
+    /**
+     * @brief Set up a buffer over an opened Blob.
+     *
+     * @param[in] aBlob         Opened Blob, which must outlive the buffer
+     * @param[in] aBufferSize   Size of the buffer in bytes, the size of each read or write of the Blob
+     */
+    explicit BlobStreamBuf(Blob& aBlob, const std::size_t aBufferSize = 16 * 1024);
+
+    /// Write the pending output to the Blob, ignoring errors (call pubsync() first to check them).
+    virtual ~BlobStreamBuf() noexcept; // nothrow
+
+protected:
+    virtual int_type        underflow();
+    virtual int_type        overflow(int_type aChar);
+    virtual int             sync();
+    virtual std::streamsize showmanyc();
+    virtual std::streamsize xsgetn(char_type* apBuffer, std::streamsize aCount);
+    virtual pos_type        seekoff(off_type aOffset, std::ios_base::seekdir aDirection, std::ios_base::openmode aMode);
+    virtual pos_type        seekpos(pos_type aPosition, std::ios_base::openmode aMode);
+
+private:
+    /// Return the current position in the BLOB
+    int getPosition() const;
+
+    /// Write the pending output, and empty the get and put areas, leaving the position unchanged
+    void flush();
+
+private:
+    Blob&               mBlob;      ///< Underlying Blob
+    std::vector<char>   mBuffer;    ///< Get area or put area
+    int                 mOffset;    ///< Offset in the BLOB of the start of the buffer
+};
+
+
+}  // namespace SQLite
@@ -0,0 +1,278 @@
+/**
+ * @file    BlobCpprest.h
+ * @ingroup SQLiteCpp
+ * @brief   cpprestsdk stream buffer over a Blob, to stream a BLOB straight into an http_response or from an http_request.
+ *
+ *  Header only: requires the cpprestsdk include directory and library, which SQLiteCpp itself does not depend on.
+ *
+ * Copyright (c) 2012-2016 Sebastien Rombauts (sebastien.rombauts@gmail.com)
+ *
+ * Distributed under the MIT License (MIT) (See accompanying file LICENSE.txt
+ * or copy at http://opensource.org/licenses/MIT)
+ */
+#pragma once
+
+#include <SQLiteCpp/Blob.h>
+
+#include <cpprest/astreambuf.h>
+#include <cpprest/streams.h>
+
+#include <algorithm>
+#include <memory>
+
+
+namespace SQLite
+{
+
+
+/**
+ * @brief cpprestsdk stream buffer of bytes over a Blob, which it shares the ownership of.
+ *
+ *  Every operation executes synchronously on the calling thread, and returns an already completed task.
+ * The buffer is seekable and knows its size, so an http_response can send it with a Content-Length:
+ * \code{.cpp}
+ * std::shared_ptr<SQLite::Blob> blob = std::make_shared<SQLite::Blob>(db, "attachment", "data", id);
+ * response.set_body(SQLite::openBlobIstream(blob), blob->getBytes(), U("application/octet-stream"));
+ * \endcode
+ *
+ *  The Blob is closed when the last stream over it is destroyed; its Database connection must outlive it,
+ * and must not be used by other threads while the stream is read, for instance by the http_listener.
+ */
+class BlobCpprestBuffer : public concurrency::streams::details::streambuf_state_manager<uint8_t>
+{
+public:
+    typedef uint8_t char_type;
+    typedef concurrency::streams::details::basic_streambuf<uint8_t>::traits   traits;
+    typedef concurrency::streams::details::basic_streambuf<uint8_t>::int_type int_type;
+    typedef concurrency::streams::details::basic_streambuf<uint8_t>::pos_type pos_type;
+    typedef concurrency::streams::details::basic_streambuf<uint8_t>::off_type off_type;
+
+    /// Set up a buffer over an opened Blob, readable, and writable if the Blob has been opened for writing
+    explicit BlobCpprestBuffer(const std::shared_ptr<Blob>& apBlob) :
+        concurrency::streams::details::streambuf_state_manager<uint8_t>(
+            apBlob->isReadWrite() ? (std::ios_base::in | std::ios_base::out) : std::ios_base::in),
+        mpBlob(apBlob),
+        mPosition(0)
+    {
+    }
+
+    virtual ~BlobCpprestBuffer()
+    {
+        this->_close_read();
+        this->_close_write();
+    }
+
+    virtual bool can_seek() const
+    {
+        return this->is_open();
+    }
+    virtual bool has_size() const
+    {
+        return this->is_open();
+    }
+    virtual utility::size64_t size() const
+    {
+        return static_cast<utility::size64_t>(mpBlob->getBytes());
+    }
+    virtual size_t buffer_size(std::ios_base::openmode = std::ios_base::in) const
+    {
+        return 0;
+    }
+    virtual void set_buffer_size(size_t, std::ios_base::openmode = std::ios_base::in)
+    {
+    }
+    virtual size_t in_avail() const
+    {
+        return static_cast<size_t>(mpBlob->getBytes() - mPosition);
+    }
+    virtual pos_type getpos(std::ios_base::openmode aMode) const
+    {
+        if (((aMode & std::ios_base::in) && !this->can_read()) || ((aMode & std::ios_base::out) && !this->can_write()))
+        {
+            return static_cast<pos_type>(traits::eof());
+        }
+        return static_cast<pos_type>(mPosition);
+    }
+    virtual pos_type seekpos(pos_type aPosition, std::ios_base::openmode aMode)
+    {
+        if (((aMode & std::ios_base::in) && !this->can_read()) || ((aMode & std::ios_base::out) && !this->can_write())
+            || (aPosition < 0) || (aPosition > static_cast<pos_type>(mpBlob->getBytes())))
+        {
+            return static_cast<pos_type>(traits::eof());
+        }
+        mPosition = static_cast<int>(aPosition);
+        return aPosition;
+    }
+    virtual pos_type seekoff(off_type aOffset, std::ios_base::seekdir aDirection, std::ios_base::openmode aMode)
+    {
+        off_type base = 0;
+        if (std::ios_base::cur == aDirection)
+        {
+            base = mPosition;
+        }
+        else if (std::ios_base::end == aDirection)
+        {
+            base = mpBlob->getBytes();
+        }
+        return seekpos(static_cast<pos_type>(base + aOffset), aMode);
+    }
+    /// No direct access to the BLOB: readers fall back to getn()
+    virtual bool acquire(char_type*& aPtr, size_t& aCount)
+    {
+        aPtr = nullptr;
+        aCount = 0;
+        return false;
+    }
+    virtual void release(char_type*, size_t)
+    {
+    }
+
+protected:
+    virtual pplx::task<int_type> _putc(char_type aChar)
+    {
+        try
+        {
+            return pplx::task_from_result<int_type>((writeSome(&aChar, 1) == 1) ? aChar : traits::eof());
+        }
+        catch (...)
+        {
+            return pplx::task_from_exception<int_type>(std::current_exception());
+        }
+    }
+    virtual pplx::task<size_t> _putn(const char_type* apBuffer, size_t aCount)
+    {
+        try
+        {
+            return pplx::task_from_result(writeSome(apBuffer, aCount));
+        }
+        catch (...)
+        {
+            return pplx::task_from_exception<size_t>(std::current_exception());
+        }
+    }
+    virtual char_type* _alloc(size_t)
+    {
+        return nullptr;
+    }
+    virtual void _commit(size_t)
+    {
+    }
+    virtual pplx::task<size_t> _getn(char_type* apBuffer, size_t aCount)
+    {
+        try
+        {
+            return pplx::task_from_result(readSome(apBuffer, aCount, true));
+        }
+        catch (...)
+        {
+            return pplx::task_from_exception<size_t>(std::current_exception());
+        }
+    }
+    virtual size_t _scopy(char_type* apBuffer, size_t aCount)
+    {
+        return readSome(apBuffer, aCount, false);
+    }
+    virtual pplx::task<int_type> _bumpc()
+    {
+        try
+        {
+            return pplx::task_from_result(_sbumpc());
+        }
+        catch (...)
+        {
+            return pplx::task_from_exception<int_type>(std::current_exception());
+        }
+    }
+    virtual int_type _sbumpc()
+    {
+        char_type byte = 0;
+        return (readSome(&byte, 1, true) == 1) ? static_cast<int_type>(byte) : traits::eof();
+    }
+    virtual pplx::task<int_type> _getc()
+    {
+        try
+        {
+            return pplx::task_from_result(_sgetc());
+        }
+        catch (...)
+        {
+            return pplx::task_from_exception<int_type>(std::current_exception());
+        }
+    }
+    virtual int_type _sgetc()
+    {
+        char_type byte = 0;
+        return (readSome(&byte, 1, false) == 1) ? static_cast<int_type>(byte) : traits::eof();
+    }
+    virtual pplx::task<int_type> _nextc()
+    {
+        if (mPosition >= mpBlob->getBytes())
+        {
+            return pplx::task_from_result<int_type>(traits::eof());
+        }
+        ++mPosition;
+        return _getc();
+    }
+    virtual pplx::task<int_type> _ungetc()
+    {
+        if (0 == mPosition)
+        {
+            return pplx::task_from_result<int_type>(traits::eof());
+        }
+        --mPosition;
+        return _getc();
+    }
+    virtual pplx::task<bool> _sync()
+    {
+        return pplx::task_from_result(true); // writes are not buffered
+    }
+
+private:
+    /// Read up to aCount bytes at the current position, advancing it or not
+    size_t readSome(char_type* apBuffer, const size_t aCount, const bool abAdvance)
+    {
+        const size_t size = std::min(aCount, in_avail());
+        if (size > 0)
+        {
+            mpBlob->read(apBuffer, static_cast<int>(size), mPosition);
+            if (abAdvance)
+            {
+                mPosition += static_cast<int>(size);
+            }
+        }
+        return size;
+    }
+
+    /// Write up to aCount bytes at the current position, as a BLOB cannot grow, and advance it
+    size_t writeSome(const char_type* apBuffer, const size_t aCount)
+    {
+        const size_t size = std::min(aCount, in_avail());
+        if (size > 0)
+        {
+            mpBlob->write(apBuffer, static_cast<int>(size), mPosition);
+            mPosition += static_cast<int>(size);
+        }
+        return size;
+    }
+
+private:
+    std::shared_ptr<Blob>   mpBlob;     ///< Underlying Blob
+    int                     mPosition;  ///< Read and write position in the BLOB
+};
+
+/// Open a cpprestsdk input stream over a Blob.
+inline concurrency::streams::istream openBlobIstream(const std::shared_ptr<Blob>& apBlob)
+{
+    const concurrency::streams::streambuf<uint8_t> buffer(std::make_shared<BlobCpprestBuffer>(apBlob));
+    return concurrency::streams::istream(buffer);
+}
+
+/// Open a cpprestsdk output stream over a Blob opened for writing, for instance to receive an http_request body.
+inline concurrency::streams::ostream openBlobOstream(const std::shared_ptr<Blob>& apBlob)
+{
+    const concurrency::streams::streambuf<uint8_t> buffer(std::make_shared<BlobCpprestBuffer>(apBlob));
+    return concurrency::streams::ostream(buffer);
+}
+
+
+}  // namespace SQLite
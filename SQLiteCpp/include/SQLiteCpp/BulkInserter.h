@@ -0,0 +1,257 @@
+/**
+ * @file    BulkInserter.h
+ * @ingroup SQLiteCpp
+ * @brief   Fast loading of many rows into a table, with multi-row INSERT statements and chunked transactions.
+ *
+ * Copyright (c) 2012-2016 Sebastien Rombauts (sebastien.rombauts@gmail.com)
+ *
+ * Distributed under the MIT License (MIT) (See accompanying file LICENSE.txt
+ * or copy at http://opensource.org/licenses/MIT)
+ */
+#pragma once
+
+#include <SQLiteCpp/Exception.h>
+
+#include <string>
+#include <vector>
+#include <tuple>
+#include <memory>
+#include <chrono>
+#include <cstddef>
+
+
+namespace SQLite
+{
+
+
+// Forward declaration
+class Database;
+class Statement;
+
+/**
+ * @brief Fast loading of many rows into the columns of a table.
+ *
+ * Rows are gathered into multi-row "INSERT INTO table (columns) VALUES (?,?),(?,?)..." statements,
+ * with as many rows per statement as the SQLite limit on the number of host parameters allows,
+ * and the load is split in transactions of a configurable number of rows.
+ *
+ * Each transaction is a "SAVEPOINT", so the BulkInserter can also be used inside a transaction of the caller
+ * (for instance a SQLite::Transaction): its rows are then committed with the transaction of the caller,
+ * each "RELEASE" only ending one chunk.
+ *
+ * Each row is given as a list of values, as a std::tuple, or taken from a columnar source (one std::vector per column).
+ * Supported value types are the integral types (int, long, long long, std::int64_t, std::size_t...,
+ * the unsigned ones above LLONG_MAX wrapping to negative values), double, std::string and const char*,
+ * plus nullptr for a NULL value. The text values are copied until their row is inserted.
+ *
+ * The rows still pending when the BulkInserter is destroyed are rollbacked, as with a Transaction:
+ * call flush() to insert them and release the last savepoint.
+ * When a multi-row INSERT fails (e.g. a constraint violation), all the rows of that statement are discarded,
+ * whether valid or not, and the exception is thrown to the caller; the rows inserted before are kept,
+ * and the next rows can be inserted as usual.
+ *
+ * Optionally, the load can run with "PRAGMA synchronous=OFF" and, unless the database uses WAL,
+ * "PRAGMA journal_mode=MEMORY", trading durability of the database file in case of a crash during the load for speed.
+ * The previous settings are restored when the BulkInserter is destroyed.
+ * The journal mode cannot change inside a transaction, so only the synchronous setting is relaxed there.
+ *
+ * Thread-safety: same as the Database Connection it uses.
+ */
+class BulkInserter
+{
+public:
+    /**
+     * @brief Prepare the insertion of rows into the provided columns of a table.
+     *
+     * @param[in] aDatabase         the SQLite Database Connection
+     * @param[in] aTable            name of the table (inserted verbatim in the SQL query)
+     * @param[in] aColumns          names of the columns of each row (inserted verbatim in the SQL query)
+     * @param[in] aRowsPerCommit    number of rows inserted in each transaction
+     * @param[in] abFastLoad        true to relax the synchronous and journal_mode settings during the load
+     *
+     * @throw SQLite::Exception in case of error
+     */
+    BulkInserter(Database&                       aDatabase,
+                 const std::string&              aTable,
+                 const std::vector<std::string>& aColumns,
+                 const std::size_t               aRowsPerCommit = 100000,
+                 const bool                      abFastLoad = false);
+
+    /// Rollback the rows inserted since the last savepoint release, and restore the settings changed by the fast load.
+    ~BulkInserter() noexcept; // nothrow
+
+    /**
+     * @brief Insert one row, given as one value per column.
+     *
+     * @throw SQLite::Exception in case of error, or if the number of values does not match the number of columns
+     */
+    template<typename... Types>
+    void insert(const Types&... aValues)
+    {
+        checkValueCount(sizeof...(Types));
+        addValues(aValues...);
+        endRow();
+    }
+
+    /**
+     * @brief Insert one row, given as a tuple of one value per column.
+     *
+     * @throw SQLite::Exception in case of error, or if the size of the tuple does not match the number of columns
+     */
+    template<typename... Types>
+    void insert(const std::tuple<Types...>& aRow)
+    {
+        checkValueCount(sizeof...(Types));
+        TupleValues<sizeof...(Types)>::add(*this, aRow);
+        endRow();
+    }
+
+    /**
+     * @brief Insert all the rows of a columnar source, given as one vector of values per column.
+     *
+     * @throw SQLite::Exception in case of error, or if the vectors do not all have the same size
+     */
+    template<typename... Types>
+    void insertColumns(const std::vector<Types>&... aColumns)
+    {
+        static_assert(sizeof...(Types) > 0, "please invoke insertColumns with one or more columns");
+        checkValueCount(sizeof...(Types));
+        const std::size_t sizes[] = { aColumns.size()... };
+        for (std::size_t i = 1; i < sizeof...(Types); ++i)
+        {
+            if (sizes[i] != sizes[0])
+            {
+                throw SQLite::Exception("BulkInserter columns must all have the same number of rows.");
+            }
+        }
+        for (std::size_t row = 0; row < sizes[0]; ++row)
+        {
+            addValues(aColumns[row]...);
+            endRow();
+        }
+    }
+
+    /**
+     * @brief Insert the pending rows and release the current savepoint, committing it outside of a transaction.
+     *
+     * @throw SQLite::Exception in case of error
+     */
+    void flush();
+
+    /// Return the number of rows inserted so far, committed or not.
+    unsigned long long getRowCount() const noexcept // nothrow
+    {
+        return mRowCount;
+    }
+
+    /// Return the number of rows inserted by each multi-row INSERT statement.
+    std::size_t getRowsPerStatement() const noexcept // nothrow
+    {
+        return mRowsPerStatement;
+    }
+
+    /// Return the number of rows committed per second, from the first row to the last commit.
+    double getRowsPerSecond() const noexcept; // nothrow
+
+private:
+    /// @{ BulkInserter must be non-copyable
+    BulkInserter(const BulkInserter&);
+    BulkInserter& operator=(const BulkInserter&);
+    /// @}
+
+    /// Pending value of a row, bound to the multi-row statement when it is full
+    struct Value
+    {
+        int         mType;      //!< SQLite::INTEGER, SQLite::FLOAT, SQLite::TEXT or SQLite::Null
+        long long   mInteger;   //!< Integer value
+        double      mFloat;     //!< Floating point value
+        std::string mText;      //!< Text value, keeping its capacity from one row to the next
+    };
+
+    /// Add the values of a tuple, first to last
+    template<std::size_t N>
+    struct TupleValues
+    {
+        template<typename Tuple>
+        static void add(BulkInserter& aInserter, const Tuple& aRow)
+        {
+            TupleValues<N - 1>::add(aInserter, aRow);
+            aInserter.add(std::get<N - 1>(aRow));
+        }
+    };
+
+    void addValues()
+    {
+    }
+    template<typename Type, typename... Types>
+    void addValues(const Type& aValue, const Types&... aValues)
+    {
+        add(aValue);
+        addValues(aValues...);
+    }
+
+    /// @{ Add the next value of the current row
+    void add(const int                  aValue);
+    void add(const unsigned             aValue);
+    void add(const long                 aValue);
+    void add(const unsigned long        aValue);
+    void add(const long long            aValue);
+    void add(const unsigned long long   aValue);
+    void add(const double               aValue);
+    void add(const std::string&         aValue);
+    void add(const char*                apValue);
+    void add(std::nullptr_t);
+    /// @}
+
+    /// Restore the settings changed by the fast load
+    void restoreSettings();
+
+    /// Throw if the provided number of values does not match the number of columns
+    void checkValueCount(const std::size_t aCount) const;
+
+    /// Return the next value of the current row
+    Value& nextValue();
+
+    /// End the current row, executing the multi-row statement and committing when needed
+    void endRow();
+
+    /// Bind the pending rows to the provided statement, and execute it
+    void execute(Statement& aStatement);
+
+    /// Build the INSERT query for the provided number of rows
+    std::string buildQuery(const std::size_t aRowCount) const;
+
+private:
+    Database&                           mDatabase;          ///< Reference to the SQLite Database Connection
+    std::string                         mTable;             ///< Name of the table
+    std::vector<std::string>            mColumns;           ///< Names of the columns
+    std::size_t                         mRowsPerCommit;     ///< Number of rows per transaction
+    std::size_t                         mRowsPerStatement;  ///< Number of rows per multi-row INSERT statement
+    std::unique_ptr<Statement>          mStatement;         ///< Multi-row INSERT statement
+    std::vector<Value>                  mValues;            ///< Values of the pending rows
+    std::size_t                         mPendingRows;       ///< Number of complete pending rows
+    std::size_t                         mValueCount;        ///< Number of values of the current row
+    std::size_t                         mUncommittedRows;   ///< Number of rows inserted since the last savepoint release
+    unsigned long long                  mRowCount;          ///< Number of rows inserted
+    unsigned long long                  mCommittedRowCount; ///< Number of rows committed
+    bool                                mbInTransaction;    ///< True when a savepoint is open
+    bool                                mbFastLoad;         ///< True when the settings have been relaxed
+    int                                 mSynchronous;       ///< Synchronous setting to restore
+    std::string                         mJournalMode;       ///< Journal mode to restore, empty if unchanged
+    std::chrono::steady_clock::time_point mStart;           ///< Time of the first row
+    std::chrono::steady_clock::time_point mLastCommit;      ///< Time of the last commit
+};
+
+/// @cond
+template<>
+struct BulkInserter::TupleValues<0>
+{
+    template<typename Tuple>
+    static void add(BulkInserter&, const Tuple&)
+    {
+    }
+};
+/// @endcond
+
+
+}  // namespace SQLite
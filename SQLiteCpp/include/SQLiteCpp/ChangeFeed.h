@@ -0,0 +1,203 @@
+/**
+ * @file    ChangeFeed.h
+ * @ingroup SQLiteCpp
+ * @brief   Change-data-capture of a Database Connection: committed row changes published to subscribers.
+ *
+ * Copyright (c) 2012-2016 Sebastien Rombauts (sebastien.rombauts@gmail.com)
+ *
+ * Distributed under the MIT License (MIT) (See accompanying file LICENSE.txt
+ * or copy at http://opensource.org/licenses/MIT)
+ */
+#pragma once
+
+#include <SQLiteCpp/Database.h>
+
+#include <string>
+#include <vector>
+#include <memory>
+#include <functional>
+#include <atomic>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+
+
+namespace SQLite
+{
+
+// Operations of a row change, as reported by sqlite3_update_hook()
+
+/// A row was inserted
+extern const int CHANGE_INSERT; // SQLITE_INSERT
+/// A row was updated
+extern const int CHANGE_UPDATE; // SQLITE_UPDATE
+/// A row was deleted
+extern const int CHANGE_DELETE; // SQLITE_DELETE
+
+
+/// Change of a row of a rowid table
+struct Change
+{
+    std::string mDatabase;  ///< Name of the database of the table: "main", "temp", or the name of an attached database
+    std::string mTable;     ///< Name of the table
+    int         mOperation; ///< CHANGE_INSERT, CHANGE_UPDATE or CHANGE_DELETE
+    long long   mRowId;     ///< Rowid of the row (the new rowid of an UPDATE changing it)
+};
+
+/// Changes of a committed transaction, in the order of the changes
+struct ChangeBatch
+{
+    unsigned long long  mSequence;  ///< Number of the batch, from 1: a gap reveals batches dropped by a full queue
+    bool                mbOverflow; ///< True if changes were lost since the previous batch, or in this one
+    std::vector<Change> mChanges;   ///< Changes of the transaction
+};
+
+
+/**
+ * @brief Change-data-capture of a Database Connection: committed row changes published to subscribers.
+ *
+ *  The ChangeFeed registers the update, commit and rollback hooks of the connection: the row changes are
+ * buffered per transaction, discarded by a rollback, and published as a ChangeBatch once the transaction
+ * is committed. The batches go through a bounded lock-free queue to a dispatcher thread, which calls the subscribers:
+ * the writing connection never waits for them, and they can invalidate caches or push notifications
+ * within milliseconds of the commit, without scanning tables.
+ * \code{.cpp}
+ * SQLite::ChangeFeed feed(db);
+ * feed.subscribe([&cache](const SQLite::ChangeBatch& aBatch) {
+ *     for (const SQLite::Change& change : aBatch.mChanges)
+ *         cache.invalidate(change.mTable, change.mRowId);
+ * }, "users");
+ * \endcode
+ *
+ *  A batch is published only after the statement ending the transaction has completed: a COMMIT failing with
+ * SQLITE_BUSY publishes nothing, and its changes are published once a retry succeeds.
+ * The changes of a statement which failed and was rolled back inside a transaction are still reported
+ * when the transaction commits, as are the changes rolled back to a savepoint:
+ * subscribers must handle a change as "this row may have changed", and read its current state.
+ *
+ *  As documented for sqlite3_update_hook(), the changes of WITHOUT ROWID tables, the deletions
+ * of the truncate optimization (DELETE without WHERE clause, unless a trigger exists) and the changes made by
+ * the conflict resolution REPLACE are not reported. The feed uses the profile callback of the connection
+ * (sqlite3_profile()) to detect the end of each transaction: it cannot be combined with another user of these hooks.
+ *
+ *  When the queue is full, the batch is dropped and counted, and the next batch published is flagged
+ * by ChangeBatch::mbOverflow (and reveals the gap by its sequence number). The same flag marks a batch
+ * missing changes which could not be buffered, for lack of memory. A subscriber receiving it must reload its whole state:
+ * it is delivered to all the subscribers, even to those of a table without any change in the batch.
+ *
+ * Thread-safety: the subscribers are called by the dispatcher thread, one batch after the other.
+ * subscribe(), unsubscribe(), flush() and getStats() can be called from any thread, including from a subscriber
+ * (except flush()). The ChangeFeed must be destroyed before its Database Connection.
+ */
+class ChangeFeed
+{
+public:
+    /// Subscriber called with each committed batch
+    typedef std::function<void (const ChangeBatch&)> TSubscriber;
+
+    /// Counters of the change feed
+    struct Stats
+    {
+        unsigned long long  mCommittedBatches;  ///< Number of batches published
+        unsigned long long  mRolledBackBatches; ///< Number of transactions with changes discarded by a rollback
+        unsigned long long  mDroppedBatches;    ///< Number of batches dropped because the queue was full
+        unsigned long long  mChanges;           ///< Number of changes published
+    };
+
+    /**
+     * @brief Register the hooks of a connection, and start the dispatcher thread.
+     *
+     * @param[in] aDatabase         Connection to capture the changes of, which must outlive the ChangeFeed
+     * @param[in] aQueueCapacity    Maximum number of batches waiting for the dispatcher thread
+     */
+    explicit ChangeFeed(Database& aDatabase, const std::size_t aQueueCapacity = 1024);
+
+    /// Unregister the hooks, deliver the batches still in the queue, and stop the dispatcher thread.
+    ~ChangeFeed() noexcept; // nothrow
+
+    /**
+     * @brief Subscribe to the committed batches.
+     *
+     * @param[in] aSubscriber   Function called by the dispatcher thread with each batch
+     * @param[in] aTable        Name of a table, to receive only its changes (and no empty batch, unless flagged
+     *                          by ChangeBatch::mbOverflow), or "" for all changes
+     *
+     * @return the identifier of the subscription, for unsubscribe()
+     */
+    int subscribe(const TSubscriber& aSubscriber, const std::string& aTable = "");
+
+    /**
+     * @brief Cancel a subscription, which can still receive the batch being delivered.
+     *
+     * @return false if the subscription does not exist
+     */
+    bool unsubscribe(const int aSubscription);
+
+    /// Wait for the delivery of all the batches published so far (not to be called by a subscriber).
+    void flush();
+
+    /// Return the counters of the change feed.
+    Stats getStats() const;
+
+private:
+    /// @{ ChangeFeed must be non-copyable
+    ChangeFeed(const ChangeFeed&);
+    ChangeFeed& operator=(const ChangeFeed&);
+    /// @}
+
+    /// Subscription to the batches
+    struct Subscription
+    {
+        int         mId;            ///< Identifier of the subscription
+        std::string mTable;         ///< Table of the changes to deliver, or "" for all
+        TSubscriber mSubscriber;    ///< Function to call
+    };
+    typedef std::vector<Subscription> TSubscriptions;
+
+    /// @{ Hooks of the connection
+    static void updateHook(void* apFeed, int aOperation, const char* apDatabase, const char* apTable, long long aRowId);
+    static int commitHook(void* apFeed);
+    static void rollbackHook(void* apFeed);
+    static void profileHook(void* apFeed, const char* apQuery, unsigned long long aDurationNs);
+    /// @}
+
+    /// Push the changes of the committed transaction to the queue
+    void publish();
+
+    /// Deliver a batch to the subscribers
+    void deliver(const ChangeBatch& aBatch);
+
+    /// Loop of the dispatcher thread
+    void loop() noexcept; // nothrow
+
+private:
+    Database&                                   mDatabase;          ///< Connection to capture the changes of
+    // State of the connection, used by the hooks only
+    std::vector<Change>                         mPending;           ///< Changes of the current transaction
+    bool                                        mbCommitting;       ///< True once the commit hook has been called
+    unsigned long long                          mSequence;          ///< Sequence number of the last batch published
+    bool                                        mbOverflow;         ///< True when changes were lost since the last batch queued
+    // Single-producer single-consumer lock-free queue of the batches
+    std::vector<ChangeBatch*>                   mQueue;             ///< Ring buffer of the batches, with one unused slot
+    std::atomic<std::size_t>                    mQueueHead;         ///< Next slot to pop, written by the dispatcher thread
+    std::atomic<std::size_t>                    mQueueTail;         ///< Next slot to push, written by the hooks
+    std::atomic<bool>                           mbWaiting;          ///< True when the dispatcher thread may wait for a batch
+    std::atomic<unsigned long long>             mQueued;            ///< Sequence number of the last batch queued
+    // Counters, updated without lock by the hooks
+    std::atomic<unsigned long long>             mCommittedBatches;  ///< Number of batches published
+    std::atomic<unsigned long long>             mRolledBackBatches; ///< Number of transactions with changes discarded by a rollback
+    std::atomic<unsigned long long>             mDroppedBatches;    ///< Number of batches dropped because the queue was full
+    std::atomic<unsigned long long>             mChanges;           ///< Number of changes published
+    // Dispatcher thread and subscribers
+    mutable std::mutex                          mMutex;             ///< Protect the state below
+    std::condition_variable                     mWakeUp;            ///< Signaled when a batch is queued while the dispatcher waits, and on stop
+    std::condition_variable                     mDelivered;         ///< Signaled after the delivery of each batch
+    bool                                        mbStopping;         ///< True when the dispatcher thread must stop
+    unsigned long long                          mDeliveredSequence; ///< Sequence number of the last batch delivered
+    std::shared_ptr<const TSubscriptions>       mSubscriptions;     ///< Subscriptions, replaced on each change
+    int                                         mNextSubscription;  ///< Identifier of the next subscription
+    std::thread                                 mThread;            ///< Dispatcher thread
+};
+
+
+}  // namespace SQLite
@@ -113,6 +113,22 @@ public:
      */
     std::string getString() const noexcept; // nothrow
 
+#if (__cplusplus >= 201703L) || (defined(_MSVC_LANG) && (_MSVC_LANG >= 201703L)) // c++17: Visual Studio 2017
+    /**
+     * @brief Return a view of the text (or blob) value of the column, without copying it to a std::string.
+     *
+     * Note this correctly handles strings that contain null bytes.
+     *
+     * @warning The value viewed is only valid while the row of the statement is valid (until the next executeStep()).
+     */
+    std::string_view getStringView() const noexcept // nothrow
+    {
+        // getBlob() must be called before getBytes(), see getString()
+        const char* pData = static_cast<const char*>(getBlob());
+        return std::string_view(pData, static_cast<std::size_t>(getBytes()));
+    }
+#endif
+
     /**
      * @brief Return the type of the value of the column
      *
@@ -0,0 +1,178 @@
+/**
+ * @file    ColumnView.h
+ * @ingroup SQLiteCpp
+ * @brief   Non-owning view of a Column of the current row of a Statement, for allocation-free access.
+ *
+ * Copyright (c) 2012-2016 Sebastien Rombauts (sebastien.rombauts@gmail.com)
+ *
+ * Distributed under the MIT License (MIT) (See accompanying file LICENSE.txt
+ * or copy at http://opensource.org/licenses/MIT)
+ */
+#pragma once
+
+#include <string>
+
+#if (__cplusplus >= 201703L) || (defined(_MSVC_LANG) && (_MSVC_LANG >= 201703L)) // c++17: Visual Studio 2017
+#include <string_view>
+#endif
+
+// Forward declarations to avoid inclusion of <sqlite3.h> in a header
+struct sqlite3_stmt;
+
+
+namespace SQLite
+{
+
+
+/**
+ * @brief Non-owning view of a Column in the current row of the result of a Statement.
+ *
+ *  Contrary to a Column, a ColumnView does not share the ownership of the underlying sqlite3_stmt,
+ * so getting one costs neither a reference count increment nor a decrement: it is meant for tight loops
+ * reading millions of rows, through Statement::getColumnView() or Statement::getColumns().
+ *
+ * @warning A ColumnView is only valid while the row of the Statement it was taken from remains valid,
+ *          that is only until the next executeStep() call, and never after the Statement is destroyed.
+ *
+ * Thread-safety: same as the Statement it was taken from.
+ */
+class ColumnView
+{
+public:
+    /**
+     * @brief View of a Column in a Row of the result.
+     *
+     * @param[in] apStmt    The prepared SQLite Statement Object, pointing to a row of result
+     * @param[in] aIndex    Index of the column in the row of result, starting at 0
+     */
+    ColumnView(sqlite3_stmt* apStmt, const int aIndex) noexcept : // nothrow
+        mpStmt(apStmt),
+        mIndex(aIndex)
+    {
+    }
+
+    /// Return a pointer to the named assigned to this result column (potentially aliased)
+    const char* getName() const noexcept; // nothrow
+
+    /// Return the integer value of the column.
+    int         getInt() const noexcept; // nothrow
+    /// Return the 32bits unsigned integer value of the column (note that SQLite3 does not support unsigned 64bits).
+    unsigned    getUInt() const noexcept; // nothrow
+    /// Return the 64bits integer value of the column (note that SQLite3 does not support unsigned 64bits).
+    long long   getInt64() const noexcept; // nothrow
+    /// Return the double (64bits float) value of the column
+    double      getDouble() const noexcept; // nothrow
+    /**
+     * @brief Return a pointer to the text value (NULL terminated string) of the column.
+     *
+     * @warning The value pointed at is only valid until the next executeStep() call.
+     */
+    const char* getText(const char* apDefaultValue = "") const noexcept; // nothrow
+    /**
+     * @brief Return a pointer to the binary blob value of the column.
+     *
+     * @warning The value pointed at is only valid until the next executeStep() call.
+     */
+    const void* getBlob() const noexcept; // nothrow
+    /// Return a std::string copy of a TEXT or BLOB column (this one allocates).
+    std::string getString() const;
+
+#if (__cplusplus >= 201703L) || (defined(_MSVC_LANG) && (_MSVC_LANG >= 201703L)) // c++17: Visual Studio 2017
+    /**
+     * @brief Return a view of the text (or blob) value of the column, without copying it.
+     *
+     *  Correctly handles text containing null bytes.
+     *
+     * @warning The value viewed is only valid until the next executeStep() call.
+     */
+    std::string_view getStringView() const noexcept // nothrow
+    {
+        // SQLite docs: "The safest policy is to invoke… sqlite3_column_blob() followed by sqlite3_column_bytes()"
+        const char* pData = static_cast<const char*>(getBlob());
+        return std::string_view(pData, static_cast<std::size_t>(getBytes()));
+    }
+#endif
+
+    /**
+     * @brief Return the type of the value of the column
+     *
+     * Return either SQLite::INTEGER, SQLite::FLOAT, SQLite::TEXT, SQLite::BLOB, or SQLite::Null.
+     */
+    int getType() const noexcept; // nothrow
+
+    /// Test if the column is NULL (meaningful only before any conversion)
+    bool isNull() const noexcept; // nothrow
+
+    /// Return the number of bytes used by the text (or blob) value of the column
+    int getBytes() const noexcept; // nothrow
+
+    /// Return the index of the column in the row of result, starting at 0
+    int getIndex() const noexcept // nothrow
+    {
+        return mIndex;
+    }
+
+private:
+    sqlite3_stmt*   mpStmt;     ///< The prepared SQLite Statement Object (not owned)
+    int             mIndex;     ///< Index of the column in the row of result, starting at 0
+};
+
+
+/// @cond
+/// implementation detail of Statement::getColumns(): typed access to a ColumnView.
+namespace detail {
+template<typename T>
+struct ColumnGetter;
+
+template<>
+struct ColumnGetter<int>
+{
+    static int get(const ColumnView& aColumn) noexcept { return aColumn.getInt(); }
+};
+template<>
+struct ColumnGetter<unsigned>
+{
+    static unsigned get(const ColumnView& aColumn) noexcept { return aColumn.getUInt(); }
+};
+template<>
+struct ColumnGetter<long>
+{
+    static long get(const ColumnView& aColumn) noexcept { return static_cast<long>(aColumn.getInt64()); }
+};
+template<>
+struct ColumnGetter<long long>
+{
+    static long long get(const ColumnView& aColumn) noexcept { return aColumn.getInt64(); }
+};
+template<>
+struct ColumnGetter<double>
+{
+    static double get(const ColumnView& aColumn) noexcept { return aColumn.getDouble(); }
+};
+template<>
+struct ColumnGetter<const char*>
+{
+    static const char* get(const ColumnView& aColumn) noexcept { return aColumn.getText(); }
+};
+template<>
+struct ColumnGetter<std::string>
+{
+    static std::string get(const ColumnView& aColumn) { return aColumn.getString(); }
+};
+template<>
+struct ColumnGetter<ColumnView>
+{
+    static ColumnView get(const ColumnView& aColumn) noexcept { return aColumn; }
+};
+#if (__cplusplus >= 201703L) || (defined(_MSVC_LANG) && (_MSVC_LANG >= 201703L)) // c++17: Visual Studio 2017
+template<>
+struct ColumnGetter<std::string_view>
+{
+    static std::string_view get(const ColumnView& aColumn) noexcept { return aColumn.getStringView(); }
+};
+#endif
+} // namespace detail
+/// @endcond
+
+
+}  // namespace SQLite
@@ -0,0 +1,152 @@
+/**
+ * @file    CompressedVfs.h
+ * @ingroup SQLiteCpp
+ * @brief   Optional SQLite VFS storing the pages of the database files compressed with zlib.
+ *
+ * Copyright (c) 2012-2016 Sebastien Rombauts (sebastien.rombauts@gmail.com)
+ *
+ * Distributed under the MIT License (MIT) (See accompanying file LICENSE.txt
+ * or copy at http://opensource.org/licenses/MIT)
+ */
+#pragma once
+
+#include <string>
+#include <mutex>
+
+// Forward declaration to avoid inclusion of <sqlite3.h> in a header
+struct sqlite3_vfs;
+
+
+namespace SQLite
+{
+
+
+/**
+ * @brief Optional SQLite VFS storing the pages of the database files compressed with zlib.
+ *
+ *  The VFS is registered by the constructor, under its name, on top of the default VFS of SQLite,
+ * and is used by opening a Database with this name as its aVfs argument:
+ * \code{.cpp}
+ * SQLite::CompressedVfs vfs("zlib");
+ * SQLite::Database db("data.db3", SQLite::OPEN_READWRITE|SQLite::OPEN_CREATE, 0, vfs.getName());
+ * \endcode
+ *
+ *  A main database file opened through the VFS is a page-mapped container file:
+ * - two alternate headers, each with a sequence number and a CRC-32, so that a torn write of a header is detected,
+ * - the pages, each deflated on its own, in extents of variable size allocated in the free space of the file,
+ * - the page map: the extent and the CRC-32 of the uncompressed content of each page, itself deflated in an extent.
+ *
+ *  The pages written by a transaction are appended in the free space of the container, and the page map is
+ * written in a new extent when SQLite syncs the file, then committed by writing the next header:
+ * the extents of the previous page map remain intact until then, which keeps the file consistent
+ * whenever the process is interrupted. The CRC-32 of each page is verified when it is read,
+ * SQLITE_CORRUPT being returned on a mismatch. The most recently used pages are kept uncompressed
+ * in a small in-memory cache, in front of the page cache of SQLite, which serves the partial reads of pages.
+ *
+ *  Only the main database files are compressed: the rollback journals and the temporary files
+ * are passed through to the default VFS. Limitations:
+ * - the WAL journal mode requires the exclusive locking mode (PRAGMA locking_mode=EXCLUSIVE),
+ *   the shared-memory index not being supported,
+ * - the pages of the container keep the page size of the first write to the database:
+ *   changing it with a VACUUM works, but makes each page of SQLite span several pages of the container, or share one,
+ * - a file created by another VFS cannot be opened (SQLITE_NOTADB), and conversely:
+ *   use the Backup class to convert a database.
+ *
+ *  The CompressedVfs must outlive the Database Connections using it.
+ * This VFS is built only with the CMake option SQLITECPP_ENABLE_COMPRESSED_VFS, and requires zlib.
+ *
+ * Thread-safety: the VFS can be used by Database Connections of different threads,
+ * as any other SQLite VFS; getStats() and resetStats() are thread-safe.
+ */
+class CompressedVfs
+{
+public:
+    /// Default number of uncompressed pages cached for each open database file
+    static const int DEFAULT_CACHE_PAGES = 64;
+
+    /// Counters of the activity of the VFS, for all the database files opened through it
+    struct Stats
+    {
+        unsigned long long  mPagesRead;         ///< Number of pages decompressed from the container files
+        unsigned long long  mPagesWritten;      ///< Number of pages compressed to the container files
+        unsigned long long  mCacheHits;         ///< Number of page reads served by the caches of uncompressed pages
+        unsigned long long  mBytesWritten;      ///< Uncompressed size of the pages written
+        unsigned long long  mCompressedBytes;   ///< Compressed size of the pages written
+        unsigned long long  mCommits;           ///< Number of page maps committed
+        unsigned long long  mChecksumErrors;    ///< Number of pages or page maps which failed their checksum
+    };
+
+    /**
+     * @brief Register the VFS under a name, on top of the default VFS of SQLite.
+     *
+     * @param[in] aName             Name of the VFS, to open a Database with
+     * @param[in] aLevel            zlib compression level, from 1 (fastest) to 9 (smallest), or -1 for the default (6)
+     * @param[in] aCachePages       Number of uncompressed pages cached for each open database file, 0 to disable the cache
+     * @param[in] abMakeDefault     true to make the VFS the default one of SQLite, used by Databases opened without aVfs
+     *
+     * @throw SQLite::Exception if the name is already registered, or in case of error
+     */
+    explicit CompressedVfs(const std::string& aName = "zlib",
+                           const int aLevel = -1,
+                           const int aCachePages = DEFAULT_CACHE_PAGES,
+                           const bool abMakeDefault = false);
+
+    /**
+     * @brief Unregister the VFS.
+     *
+     *  The Database Connections opened through the VFS must be closed before.
+     */
+    ~CompressedVfs() noexcept; // nothrow
+
+    /// Return the name of the VFS, to use as the aVfs argument of a Database.
+    const std::string& getName() const noexcept // nothrow
+    {
+        return mName;
+    }
+
+    /// Return the zlib compression level of the pages.
+    int getLevel() const noexcept // nothrow
+    {
+        return mLevel;
+    }
+
+    /// Return the number of uncompressed pages cached for each open database file.
+    int getCachePages() const noexcept // nothrow
+    {
+        return mCachePages;
+    }
+
+    /// Return a snapshot of the counters of the activity of the VFS.
+    Stats getStats() const;
+
+    /// Reset the counters of the activity of the VFS.
+    void resetStats();
+
+    /// @cond
+    // Return the VFS on top of which the VFS is registered, used by the sqlite3_vfs methods
+    sqlite3_vfs* getBaseVfs() const noexcept // nothrow
+    {
+        return mpBaseVfs;
+    }
+    // Add the activity of one operation on a file to the counters, used by the sqlite3_io_methods of the VFS
+    void addStats(const Stats& aStats);
+    /// @endcond
+
+private:
+    /// @{ CompressedVfs must be non-copyable
+    CompressedVfs(const CompressedVfs&);
+    CompressedVfs& operator=(const CompressedVfs&);
+    /// @}
+
+private:
+    std::string         mName;          ///< Name of the VFS
+    int                 mLevel;         ///< zlib compression level
+    int                 mCachePages;    ///< Number of uncompressed pages cached for each open file
+    sqlite3_vfs*        mpVfs;          ///< Registered VFS, delegating to the default VFS
+    sqlite3_vfs*        mpBaseVfs;      ///< Default VFS of SQLite at the registration
+    mutable std::mutex  mMutex;         ///< Mutex protecting the counters
+    Stats               mStats;         ///< Counters of the activity of the VFS
+};
+
+
+}  // namespace SQLite
@@ -0,0 +1,223 @@
+/**
+ * @file    ConnectionPool.h
+ * @ingroup SQLiteCpp
+ * @brief   Thread-safe pool of Database Connections, with read-only readers and one writer in WAL mode.
+ *
+ * Copyright (c) 2012-2016 Sebastien Rombauts (sebastien.rombauts@gmail.com)
+ *
+ * Distributed under the MIT License (MIT) (See accompanying file LICENSE.txt
+ * or copy at http://opensource.org/licenses/MIT)
+ */
+#pragma once
+
+#include <SQLiteCpp/Database.h>
+#include <SQLiteCpp/Transaction.h>
+
+#include <string>
+#include <vector>
+#include <memory>
+#include <functional>
+#include <mutex>
+#include <condition_variable>
+
+
+namespace SQLite
+{
+
+
+/**
+ * @brief Thread-safe pool of SQLite Database Connections to one database file in WAL mode.
+ *
+ * The pool opens all its connections upfront: one read-write connection, the writer,
+ * which switches the database to the Write-Ahead Log journal mode, and N read-only connections, the readers.
+ * In WAL mode readers never block the writer nor each other, so read throughput scales with the number of readers,
+ * while all writes are serialized on the single writer, which avoids SQLITE_BUSY errors between writers.
+ *
+ * Each connection is set up once when opened, with its own statement cache and the optional setup function
+ * (pragmas, createFunction(), loadExtension()...), so schema parsing and statement preparation
+ * are paid once per connection and not once per request.
+ *
+ * A connection is checked out as a RAII ConnectionPool::Connection handle, and is given back to the pool
+ * when the handle is destroyed. A checked out connection is used by one thread at a time,
+ * so the connections are opened without the SQLite internal mutex.
+ *
+ * Thread-safety: the pool can be shared by multiple threads, but a Connection handle
+ * and the Database it refers to shall only be used by one thread at a time.
+ * The pool must outlive all its checked out connections.
+ */
+class ConnectionPool
+{
+public:
+    /// Function called once on each new connection, before it is first checked out
+    typedef std::function<void (Database&)> TSetup;
+
+    /**
+     * @brief RAII handle of a connection checked out of the pool.
+     *
+     *  The connection is given back to the pool when the handle is destroyed.
+     * The handle can be moved, but not copied.
+     */
+    class Connection
+    {
+    public:
+        /// Give the connection back to the pool
+        ~Connection() noexcept; // nothrow
+
+        /// Move the checked out connection to a new handle, leaving the source empty
+        Connection(Connection&& aOther) noexcept; // nothrow
+
+        /// Return the checked out Database Connection.
+        Database& getDatabase() const noexcept // nothrow
+        {
+            return *mpDatabase;
+        }
+        Database& operator*() const noexcept // nothrow
+        {
+            return *mpDatabase;
+        }
+        Database* operator->() const noexcept // nothrow
+        {
+            return mpDatabase;
+        }
+
+        /// Return true if this is the writer connection of the pool.
+        bool isWriter() const noexcept // nothrow
+        {
+            return mbWriter;
+        }
+
+    private:
+        friend class ConnectionPool;
+
+        Connection(ConnectionPool& aPool, Database& aDatabase, const bool abWriter) noexcept; // nothrow
+
+        /// @{ Connection must be non-copyable
+        Connection(const Connection&);
+        Connection& operator=(const Connection&);
+        /// @}
+
+    private:
+        ConnectionPool* mpPool;     ///< Pool to give the connection back to (NULL once moved from)
+        Database*       mpDatabase; ///< Checked out Database Connection
+        bool            mbWriter;   ///< True for the writer connection
+    };
+
+    /**
+     * @brief RAII write transaction on the writer connection of the pool.
+     *
+     *  Checks out the writer, begins a transaction on it, and rollbacks it if it has not been committed
+     * when destroyed, before giving the writer back to the pool.
+     */
+    class WriteTransaction
+    {
+    public:
+        /**
+         * @brief Check out the writer and begin a transaction.
+         *
+         * @param[in] aPool         The connection pool
+         * @param[in] aTimeoutMs    Maximum time to wait for the writer, negative to wait forever
+         *
+         * @throw SQLite::Exception in case of timeout or error
+         */
+        explicit WriteTransaction(ConnectionPool& aPool, const int aTimeoutMs = -1);
+
+        /// Return the writer Database Connection on which to execute the statements of the transaction.
+        Database& getDatabase() const noexcept // nothrow
+        {
+            return mWriter.getDatabase();
+        }
+
+        /// Commit the transaction.
+        void commit()
+        {
+            mTransaction.commit();
+        }
+
+    private:
+        /// @{ WriteTransaction must be non-copyable
+        WriteTransaction(const WriteTransaction&);
+        WriteTransaction& operator=(const WriteTransaction&);
+        /// @}
+
+    private:
+        Connection  mWriter;        ///< Checked out writer, given back after the end of the transaction
+        Transaction mTransaction;   ///< Transaction on the writer
+    };
+
+    /**
+     * @brief Open the writer and the readers, and set each of them up.
+     *
+     *  The database is created if it does not exist, and switched to the WAL journal mode.
+     *
+     * @param[in] aFilename                 UTF-8 path/uri to the database file ("filename" sqlite3 parameter)
+     * @param[in] aReaderCount              Number of read-only connections (at least 1)
+     * @param[in] aSetup                    Optional function called once on each connection, writer first
+     * @param[in] aStatementCacheCapacity   Capacity of the statement cache of each connection (0 to disable them)
+     * @param[in] aBusyTimeoutMs            Busy timeout of each connection, mostly for WAL checkpoints
+     *
+     * @throw SQLite::Exception in case of error, or if the database cannot use the WAL journal mode
+     */
+    ConnectionPool(const std::string& aFilename,
+                   const std::size_t  aReaderCount,
+                   const TSetup&      aSetup = TSetup(),
+                   const std::size_t  aStatementCacheCapacity = 16,
+                   const int          aBusyTimeoutMs = 5000);
+
+    /// Close all connections, which must all have been given back to the pool.
+    ~ConnectionPool() noexcept; // nothrow
+
+    /**
+     * @brief Check out an idle read-only connection, waiting for one if needed.
+     *
+     * @param[in] aTimeoutMs    Maximum time to wait, negative to wait forever
+     *
+     * @throw SQLite::Exception in case of timeout
+     */
+    Connection acquireReader(const int aTimeoutMs = -1);
+
+    /**
+     * @brief Check out the writer connection, waiting for it if needed.
+     *
+     * @param[in] aTimeoutMs    Maximum time to wait, negative to wait forever
+     *
+     * @throw SQLite::Exception in case of timeout
+     */
+    Connection acquireWriter(const int aTimeoutMs = -1);
+
+    /// Return the UTF-8 filename of the database.
+    const std::string& getFilename() const noexcept // nothrow
+    {
+        return mFilename;
+    }
+
+    /// Return the number of read-only connections.
+    std::size_t getReaderCount() const noexcept // nothrow
+    {
+        return mReaders.size();
+    }
+
+    /// Return the number of read-only connections currently idle.
+    std::size_t getIdleReaderCount() const;
+
+private:
+    /// @{ ConnectionPool must be non-copyable
+    ConnectionPool(const ConnectionPool&);
+    ConnectionPool& operator=(const ConnectionPool&);
+    /// @}
+
+    /// Give a connection back to the pool, and wake up a waiting thread
+    void release(Database& aDatabase, const bool abWriter) noexcept; // nothrow
+
+private:
+    std::string                             mFilename;      ///< UTF-8 filename of the database
+    std::unique_ptr<Database>               mWriter;        ///< The read-write connection
+    std::vector<std::unique_ptr<Database> > mReaders;       ///< All the read-only connections
+    std::vector<Database*>                  mIdleReaders;   ///< Read-only connections not checked out
+    bool                                    mbWriterIdle;   ///< True when the writer is not checked out
+    mutable std::mutex                      mMutex;         ///< Protect the idle connections
+    std::condition_variable                 mReaderIdle;    ///< Signaled when a reader is given back
+    std::condition_variable                 mWriterIdle;    ///< Signaled when the writer is given back
+};
+
+
+}  // namespace SQLite
@@ -11,6 +11,7 @@
 #pragma once
 
 #include <SQLiteCpp/Column.h>
+#include <SQLiteCpp/StatementCache.h>
 
 #include <string>
 
@@ -24,6 +25,9 @@ typedef struct Mem sqlite3_value;
 namespace SQLite
 {
 
+// Forward declaration
+class Profiler;
+
 // Those public constants enable most usages of SQLiteCpp without including <sqlite3.h> in the client application.
 
 /// The database is opened in read-only mode. If the database does not already exist, an error is returned.
@@ -36,6 +40,8 @@ extern const int OPEN_CREATE;       // SQLITE_OPEN_CREATE
 
 /// Enable URI filename interpretation, parsed according to RFC 3986 (ex. "file:data.db?mode=ro&cache=private")
 extern const int OPEN_URI;          // SQLITE_OPEN_URI
+/// The connection does not use the SQLite internal mutex: it shall only be used by one thread at a time.
+extern const int OPEN_NOMUTEX;      // SQLITE_OPEN_NOMUTEX
 
 extern const int OK;                ///< SQLITE_OK (used by inline check() bellow)
 
@@ -292,6 +298,46 @@ public:
         return mpSQLite;
     }
 
+    /**
+     * @brief Set the maximum number of idle prepared statements kept for reuse by this connection.
+     *
+     *  With a non-zero capacity, a Statement borrows an idle statement compiled from the same query
+     * instead of preparing it again, and gives it back, reset and with its bindings cleared, when
+     * it is destroyed. This also applies to the Statements used by execAndGet() and tableExists().
+     *  The cache is disabled by default (capacity 0); disabling it finalizes all idle statements.
+     *
+     * @param[in] aCapacity Maximum number of idle statements kept; 0 disables the cache
+     */
+    void setStatementCacheCapacity(const std::size_t aCapacity) noexcept // nothrow
+    {
+        mStatementCache.setCapacity(aCapacity);
+    }
+
+    /// Return the prepared statement cache of this connection, to read its hit and miss counters.
+    StatementCache& getStatementCache() noexcept // nothrow
+    {
+        return mStatementCache;
+    }
+
+    /**
+     * @brief Attach a Profiler to this connection, or detach it with NULL.
+     *
+     *  The Statements constructed afterward, and each call to exec(), report their executions to the Profiler,
+     * which must outlive them. Statements constructed before keep reporting to the previous Profiler, if any.
+     *
+     * @param[in] apProfiler    Profiler aggregating the executions of the statements, or NULL to disable profiling (default)
+     */
+    void setProfiler(Profiler* apProfiler) noexcept // nothrow
+    {
+        mpProfiler = apProfiler;
+    }
+
+    /// Return the Profiler attached to this connection, or NULL.
+    Profiler* getProfiler() const noexcept // nothrow
+    {
+        return mpProfiler;
+    }
+
     /**
      * @brief Create or redefine a SQL function or aggregate in the sqlite database. 
      *
@@ -352,6 +398,59 @@ public:
                               apApp, apFunc, apStep, apFinal, apDestroy);
     }
 
+#if (__cplusplus >= 201402L) || ( defined(_MSC_VER) && (_MSC_VER >= 1900) ) // c++14: Visual Studio 2015
+    /**
+     * @brief Create or redefine a SQL scalar function implemented by a C++ function object.
+     *
+     *  The number and the types of the arguments, and the type of the result, are deduced at compile time
+     * from the signature of the function object (a lambda, a function pointer, or a class with a non-template operator()),
+     * which is moved into the connection and destroyed with it.
+     * - arguments: int, long, long long, bool, double, const char* (NULL for a NULL argument), std::string,
+     *   std::string_view (c++17) viewing the bytes of a text or a blob without copy, std::optional<T> (c++17)
+     *   empty for a NULL argument, or the raw sqlite3_value*;
+     * - result: an integral type, double, const char*, std::string, std::string_view, std::optional<T>, nullptr or void for NULL.
+     *
+     *  An exception thrown by the function object fails the statement with its message.
+     * \code{.cpp}
+     * db.function("haversine", [](double aLat1, double aLon1, double aLat2, double aLon2) { ... });
+     * \endcode
+     *
+     * @note Defined in <SQLiteCpp/Function.h>, included at the end of this header.
+     *
+     * @param[in] apName            Name of the SQL function
+     * @param[in] aFunction         Function object implementing it
+     * @param[in] abDeterministic   True if the result only depends on the arguments (most functions),
+     *                              so SQLite can factor calls out and use the function in indexes
+     *
+     * @throw SQLite::Exception in case of error
+     */
+    template<typename Function>
+    void function(const char* apName, Function aFunction, const bool abDeterministic = true);
+
+    /**
+     * @brief Create or redefine a SQL aggregate implemented by a C++ class.
+     *
+     *  The class must be default constructible, with a "void step(Args...)" method called with each row of a group,
+     * its arguments deduced at compile time like those of function(), and a "R value()" method returning the result.
+     * An object is constructed in place, in the memory that SQLite allocates for each group, on the first row,
+     * and destroyed after its value() has been returned (or when the statement is aborted);
+     * an empty group returns the value() of a new object.
+     *
+     *  The class is ready for window functions: value() does not end the aggregate,
+     * and an optional "void inverse(Args...)" method removes a row from it. It is registered as a window function
+     * when the SQLite library supports them (3.25.0 and later), and as an aggregate otherwise.
+     *
+     * @note Defined in <SQLiteCpp/Function.h>, included at the end of this header.
+     *
+     * @param[in] apName            Name of the SQL aggregate
+     * @param[in] abDeterministic   True if the result only depends on the arguments
+     *
+     * @throw SQLite::Exception in case of error
+     */
+    template<typename Aggregate>
+    void aggregate(const char* apName, const bool abDeterministic = true);
+#endif
+
     /**
      * @brief Load a module into the current sqlite database instance. 
      *
@@ -375,6 +474,12 @@ private:
     Database& operator=(const Database&);
     /// @}
 
+    /// Return the statement cache to be used by a new Statement, or NULL if disabled
+    StatementCache* getStatementCachePtr() noexcept // nothrow
+    {
+        return (0 != mStatementCache.getCapacity()) ? &mStatementCache : NULL;
+    }
+
     /**
      * @brief Check if aRet equal SQLITE_OK, else throw a SQLite::Exception with the SQLite error message
      */
@@ -389,7 +494,12 @@ private:
 private:
     sqlite3*    mpSQLite;   ///< Pointer to SQLite Database Connection Handle
     std::string mFilename;  ///< UTF-8 filename used to open the database
+    StatementCache mStatementCache; ///< Idle prepared statements kept for reuse
+    Profiler*   mpProfiler; ///< Profiler of the executions of the statements, or NULL
 };
 
 
 }  // namespace SQLite
+
+// Definitions of the member templates Database::function() and Database::aggregate()
+#include <SQLiteCpp/Function.h>
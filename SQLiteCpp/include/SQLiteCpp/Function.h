@@ -0,0 +1,448 @@
+/**
+ * @file    Function.h
+ * @ingroup SQLiteCpp
+ * @brief   Typed registration of SQL scalar functions and aggregates, with Database::function() and Database::aggregate().
+ *
+ * Copyright (c) 2012-2016 Sebastien Rombauts (sebastien.rombauts@gmail.com)
+ *
+ * Distributed under the MIT License (MIT) (See accompanying file LICENSE.txt
+ * or copy at http://opensource.org/licenses/MIT)
+ */
+#pragma once
+
+#include <SQLiteCpp/Database.h>
+
+#if (__cplusplus >= 201402L) || ( defined(_MSC_VER) && (_MSC_VER >= 1900) ) // c++14: Visual Studio 2015
+
+#include <string>
+#include <tuple>
+#include <utility>
+#include <type_traits>
+#include <exception>
+#include <new>
+#if (__cplusplus >= 201703L) || (defined(_MSVC_LANG) && (_MSVC_LANG >= 201703L)) // c++17: Visual Studio 2017
+#include <string_view>
+#include <optional>
+#endif
+
+
+namespace SQLite
+{
+
+/// @cond
+namespace detail
+{
+
+// Access to the arguments and the results of a SQL function, implemented over <sqlite3.h> in Function.cpp
+
+/// Return the type of an argument: SQLite::INTEGER, SQLite::FLOAT, SQLite::TEXT, SQLite::BLOB or SQLite::Null
+int getArgumentType(sqlite3_value* apValue) noexcept; // nothrow
+/// Return an argument converted to an integer
+long long getArgumentInt64(sqlite3_value* apValue) noexcept; // nothrow
+/// Return an argument converted to a floating point value
+double getArgumentDouble(sqlite3_value* apValue) noexcept; // nothrow
+/// Return the bytes of a blob argument, or of an argument converted to text, never NULL but for a NULL argument
+const char* getArgumentBytes(sqlite3_value* apValue, std::size_t& aSize) noexcept; // nothrow
+/// Return an argument converted to a NUL-terminated UTF-8 text (even a blob), or NULL for a NULL argument
+const char* getArgumentText(sqlite3_value* apValue) noexcept; // nothrow
+
+void setResultNull(sqlite3_context* apContext) noexcept; // nothrow
+void setResultInt64(sqlite3_context* apContext, const long long aValue) noexcept; // nothrow
+void setResultDouble(sqlite3_context* apContext, const double aValue) noexcept; // nothrow
+/// Set a text result, copied by SQLite
+void setResultText(sqlite3_context* apContext, const char* apValue, const std::size_t aSize) noexcept; // nothrow
+/// Report the exception being handled as the error of the function
+void setResultException(sqlite3_context* apContext) noexcept; // nothrow
+
+/// Return the function object registered with the SQL function
+void* getUserData(sqlite3_context* apContext) noexcept; // nothrow
+/// Return the zero-initialized state of the current aggregate, allocated by SQLite on first call unless aSize is 0
+void* getAggregateContext(sqlite3_context* apContext, const std::size_t aSize) noexcept; // nothrow
+
+/// Register an aggregate, as a window function if it has an inverse and the SQLite library supports them
+void createAggregate(Database&  aDatabase,
+                     const char* apName,
+                     const int  aNbArg,
+                     const bool abDeterministic,
+                     void     (*apStep)(sqlite3_context*, int, sqlite3_value**),
+                     void     (*apFinal)(sqlite3_context*),
+                     void     (*apValue)(sqlite3_context*),
+                     void     (*apInverse)(sqlite3_context*, int, sqlite3_value**));
+
+
+/// Conversion of an argument to the type of the parameter of the C++ function
+template<typename T>
+struct Argument;
+
+template<>
+struct Argument<long long>
+{
+    static long long get(sqlite3_value* apValue) noexcept { return getArgumentInt64(apValue); }
+};
+template<>
+struct Argument<long>
+{
+    static long get(sqlite3_value* apValue) noexcept { return static_cast<long>(getArgumentInt64(apValue)); }
+};
+template<>
+struct Argument<int>
+{
+    static int get(sqlite3_value* apValue) noexcept { return static_cast<int>(getArgumentInt64(apValue)); }
+};
+template<>
+struct Argument<bool>
+{
+    static bool get(sqlite3_value* apValue) noexcept { return (0 != getArgumentInt64(apValue)); }
+};
+template<>
+struct Argument<double>
+{
+    static double get(sqlite3_value* apValue) noexcept { return getArgumentDouble(apValue); }
+};
+/// NUL-terminated text, valid until the function returns, or NULL for a NULL argument
+template<>
+struct Argument<const char*>
+{
+    static const char* get(sqlite3_value* apValue) noexcept { return getArgumentText(apValue); }
+};
+template<>
+struct Argument<std::string>
+{
+    static std::string get(sqlite3_value* apValue)
+    {
+        std::size_t size = 0;
+        const char* pBytes = getArgumentBytes(apValue, size);
+        return (NULL != pBytes) ? std::string(pBytes, size) : std::string();
+    }
+};
+/// Raw argument, for functions accepting any type
+template<>
+struct Argument<sqlite3_value*>
+{
+    static sqlite3_value* get(sqlite3_value* apValue) noexcept { return apValue; }
+};
+#if (__cplusplus >= 201703L) || (defined(_MSVC_LANG) && (_MSVC_LANG >= 201703L)) // c++17: Visual Studio 2017
+/// Bytes of a text or a blob, without copy, valid until the function returns
+template<>
+struct Argument<std::string_view>
+{
+    static std::string_view get(sqlite3_value* apValue) noexcept
+    {
+        std::size_t size = 0;
+        const char* pBytes = getArgumentBytes(apValue, size);
+        return (NULL != pBytes) ? std::string_view(pBytes, size) : std::string_view();
+    }
+};
+/// Empty for a NULL argument
+template<typename T>
+struct Argument<std::optional<T> >
+{
+    static std::optional<T> get(sqlite3_value* apValue)
+    {
+        return (SQLite::Null == getArgumentType(apValue)) ? std::optional<T>() : std::optional<T>(Argument<T>::get(apValue));
+    }
+};
+#endif
+
+
+/// Conversion of the value returned by the C++ function to the result of the SQL function
+template<typename T>
+struct Result
+{
+    static_assert(std::is_integral<T>::value, "Unsupported result type of a SQL function");
+    static void set(sqlite3_context* apContext, const T aValue) noexcept { setResultInt64(apContext, static_cast<long long>(aValue)); }
+};
+template<>
+struct Result<double>
+{
+    static void set(sqlite3_context* apContext, const double aValue) noexcept { setResultDouble(apContext, aValue); }
+};
+template<>
+struct Result<float>
+{
+    static void set(sqlite3_context* apContext, const float aValue) noexcept { setResultDouble(apContext, aValue); }
+};
+/// NULL for a NULL pointer
+template<>
+struct Result<const char*>
+{
+    static void set(sqlite3_context* apContext, const char* apValue) noexcept
+    {
+        if (NULL != apValue)
+        {
+            setResultText(apContext, apValue, std::char_traits<char>::length(apValue));
+        }
+        else
+        {
+            setResultNull(apContext);
+        }
+    }
+};
+template<>
+struct Result<std::string>
+{
+    static void set(sqlite3_context* apContext, const std::string& aValue) noexcept { setResultText(apContext, aValue.data(), aValue.size()); }
+};
+template<>
+struct Result<std::nullptr_t>
+{
+    static void set(sqlite3_context* apContext, std::nullptr_t) noexcept { setResultNull(apContext); }
+};
+#if (__cplusplus >= 201703L) || (defined(_MSVC_LANG) && (_MSVC_LANG >= 201703L)) // c++17: Visual Studio 2017
+template<>
+struct Result<std::string_view>
+{
+    static void set(sqlite3_context* apContext, const std::string_view aValue) noexcept { setResultText(apContext, aValue.data(), aValue.size()); }
+};
+/// NULL when empty
+template<typename T>
+struct Result<std::optional<T> >
+{
+    static void set(sqlite3_context* apContext, const std::optional<T>& aValue) noexcept
+    {
+        if (aValue)
+        {
+            Result<T>::set(apContext, *aValue);
+        }
+        else
+        {
+            setResultNull(apContext);
+        }
+    }
+};
+#endif
+
+
+/// Types of the result and of the parameters of a function, a function pointer, a lambda or a member function
+template<typename F>
+struct FunctionTraits : FunctionTraits<decltype(&F::operator())>
+{
+};
+template<typename R, typename... Args>
+struct FunctionTraits<R (Args...)>
+{
+    typedef typename std::decay<R>::type TResult;
+    typedef std::tuple<typename std::decay<Args>::type...> TArguments;
+    static constexpr int ARGUMENT_COUNT = sizeof...(Args);
+};
+template<typename R, typename... Args>
+struct FunctionTraits<R (*)(Args...)> : FunctionTraits<R (Args...)>
+{
+};
+template<typename C, typename R, typename... Args>
+struct FunctionTraits<R (C::*)(Args...)> : FunctionTraits<R (Args...)>
+{
+};
+template<typename C, typename R, typename... Args>
+struct FunctionTraits<R (C::*)(Args...) const> : FunctionTraits<R (Args...)>
+{
+};
+
+/// Call a function with the converted arguments, and set its result
+template<typename R>
+struct Call
+{
+    template<typename Arguments, typename F, std::size_t... I>
+    static void run(sqlite3_context* apContext, F&& aFunction, sqlite3_value** apArgs, std::index_sequence<I...>)
+    {
+        Result<R>::set(apContext, aFunction(Argument<typename std::tuple_element<I, Arguments>::type>::get(apArgs[I])...));
+    }
+};
+template<>
+struct Call<void>
+{
+    template<typename Arguments, typename F, std::size_t... I>
+    static void run(sqlite3_context* apContext, F&& aFunction, sqlite3_value** apArgs, std::index_sequence<I...>)
+    {
+        aFunction(Argument<typename std::tuple_element<I, Arguments>::type>::get(apArgs[I])...);
+        setResultNull(apContext);
+    }
+};
+
+/// Call a function with the converted arguments
+template<typename Arguments, typename F, std::size_t... I>
+void callWithArguments(F&& aFunction, sqlite3_value** apArgs, std::index_sequence<I...>)
+{
+    aFunction(Argument<typename std::tuple_element<I, Arguments>::type>::get(apArgs[I])...);
+}
+
+/// Implementation of a scalar SQL function by a function object
+template<typename Function>
+struct Scalar
+{
+    typedef FunctionTraits<Function> TTraits;
+
+    static void call(sqlite3_context* apContext, int /* aNbArgs */, sqlite3_value** apArgs) noexcept // nothrow
+    {
+        try
+        {
+            Function& function = *static_cast<Function*>(getUserData(apContext));
+            Call<typename TTraits::TResult>::template run<typename TTraits::TArguments>(
+                apContext, function, apArgs, std::make_index_sequence<TTraits::ARGUMENT_COUNT>());
+        }
+        catch (...)
+        {
+            setResultException(apContext);
+        }
+    }
+
+    static void destroy(void* apFunction) noexcept // nothrow
+    {
+        delete static_cast<Function*>(apFunction);
+    }
+};
+
+/// Detect the inverse() of a window aggregate
+template<typename T, typename = void>
+struct HasInverse : std::false_type
+{
+};
+template<typename T>
+struct HasInverse<T, decltype(void(&T::inverse))> : std::true_type
+{
+};
+
+/// Implementation of an aggregate by a class, with its state constructed in place in the aggregate context of SQLite
+template<typename Aggregate>
+struct AggregateFunction
+{
+    typedef FunctionTraits<decltype(&Aggregate::step)> TStepTraits;
+    typedef typename FunctionTraits<decltype(&Aggregate::value)>::TResult TResult;
+
+    /// State of an aggregate, zero-initialized by SQLite
+    struct State
+    {
+        bool                                                                        mbConstructed;
+        typename std::aligned_storage<sizeof(Aggregate), alignof(Aggregate)>::type  mStorage;
+    };
+    // The aggregate contexts of SQLite are aligned on 8 bytes
+    static_assert(alignof(State) <= 8, "The alignment of an aggregate class must not exceed 8 bytes");
+
+    /// Return the aggregate of the current group, constructed on first call
+    static Aggregate* getAggregate(sqlite3_context* apContext)
+    {
+        State* pState = static_cast<State*>(getAggregateContext(apContext, sizeof(State)));
+        if (NULL == pState)
+        {
+            throw std::bad_alloc();
+        }
+        if (false == pState->mbConstructed)
+        {
+            new (&pState->mStorage) Aggregate();
+            pState->mbConstructed = true;
+        }
+        return reinterpret_cast<Aggregate*>(&pState->mStorage);
+    }
+
+    static void step(sqlite3_context* apContext, int /* aNbArgs */, sqlite3_value** apArgs) noexcept // nothrow
+    {
+        try
+        {
+            Aggregate& aggregate = *getAggregate(apContext);
+            callWithArguments<typename TStepTraits::TArguments>([&aggregate](auto&&... aArgs)
+            {
+                aggregate.step(std::forward<decltype(aArgs)>(aArgs)...);
+            }, apArgs, std::make_index_sequence<TStepTraits::ARGUMENT_COUNT>());
+        }
+        catch (...)
+        {
+            setResultException(apContext);
+        }
+    }
+
+    static void inverse(sqlite3_context* apContext, int /* aNbArgs */, sqlite3_value** apArgs) noexcept // nothrow
+    {
+        callInverse(apContext, apArgs, HasInverse<Aggregate>());
+    }
+
+    static void callInverse(sqlite3_context* apContext, sqlite3_value** apArgs, std::true_type) noexcept // nothrow
+    {
+        try
+        {
+            Aggregate& aggregate = *getAggregate(apContext);
+            callWithArguments<typename TStepTraits::TArguments>([&aggregate](auto&&... aArgs)
+            {
+                aggregate.inverse(std::forward<decltype(aArgs)>(aArgs)...);
+            }, apArgs, std::make_index_sequence<TStepTraits::ARGUMENT_COUNT>());
+        }
+        catch (...)
+        {
+            setResultException(apContext);
+        }
+    }
+
+    static void callInverse(sqlite3_context*, sqlite3_value**, std::false_type) noexcept // nothrow
+    {
+    }
+
+    /// Current value of a window aggregate, which keeps its state
+    static void value(sqlite3_context* apContext) noexcept // nothrow
+    {
+        try
+        {
+            Result<TResult>::set(apContext, getAggregate(apContext)->value());
+        }
+        catch (...)
+        {
+            setResultException(apContext);
+        }
+    }
+
+    /// Final value of the aggregate, which is then destroyed (also called by SQLite for an aborted statement)
+    static void finalize(sqlite3_context* apContext) noexcept // nothrow
+    {
+        State* pState = static_cast<State*>(getAggregateContext(apContext, 0));
+        try
+        {
+            if ((NULL != pState) && pState->mbConstructed)
+            {
+                Result<TResult>::set(apContext, reinterpret_cast<Aggregate*>(&pState->mStorage)->value());
+            }
+            else
+            {
+                // No row in the group
+                Aggregate aggregate;
+                Result<TResult>::set(apContext, aggregate.value());
+            }
+        }
+        catch (...)
+        {
+            setResultException(apContext);
+        }
+        if ((NULL != pState) && pState->mbConstructed)
+        {
+            reinterpret_cast<Aggregate*>(&pState->mStorage)->~Aggregate();
+            pState->mbConstructed = false;
+        }
+    }
+};
+
+} // namespace detail
+/// @endcond
+
+
+// Register a function object as a SQL scalar function, with parameters and result types deduced at compile time
+template<typename Function>
+void Database::function(const char* apName, Function aFunction, const bool abDeterministic /* = true */)
+{
+    typedef detail::Scalar<typename std::decay<Function>::type> TScalar;
+    // On failure, SQLite calls the destructor of the function object
+    createFunction(apName, TScalar::TTraits::ARGUMENT_COUNT, abDeterministic,
+                   new typename std::decay<Function>::type(std::move(aFunction)),
+                   &TScalar::call, NULL, NULL, &TScalar::destroy);
+}
+
+// Register a class as a SQL aggregate, with parameters and result types deduced at compile time
+template<typename Aggregate>
+void Database::aggregate(const char* apName, const bool abDeterministic /* = true */)
+{
+    typedef detail::AggregateFunction<Aggregate> TAggregate;
+    detail::createAggregate(*this, apName, TAggregate::TStepTraits::ARGUMENT_COUNT, abDeterministic,
+                            &TAggregate::step, &TAggregate::finalize, &TAggregate::value,
+                            detail::HasInverse<Aggregate>::value ? &TAggregate::inverse : NULL);
+}
+
+
+}  // namespace SQLite
+
+#endif // c++14
@@ -0,0 +1,192 @@
+/**
+ * @file    Maintenance.h
+ * @ingroup SQLiteCpp
+ * @brief   Background maintenance of a WAL database: checkpoints triggered by the WAL size, incremental vacuum and optimize.
+ *
+ * Copyright (c) 2012-2016 Sebastien Rombauts (sebastien.rombauts@gmail.com)
+ *
+ * Distributed under the MIT License (MIT) (See accompanying file LICENSE.txt
+ * or copy at http://opensource.org/licenses/MIT)
+ */
+#pragma once
+
+#include <SQLiteCpp/Database.h>
+
+#include <string>
+#include <chrono>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+
+
+namespace SQLite
+{
+
+// Checkpoint modes of sqlite3_wal_checkpoint_v2(), from the least to the most intrusive
+
+/// Copy as many frames as possible without waiting for readers or writers.
+extern const int CHECKPOINT_PASSIVE;    // SQLITE_CHECKPOINT_PASSIVE
+/// Wait for the writers, then copy all the frames, waiting for the readers of old snapshots.
+extern const int CHECKPOINT_FULL;       // SQLITE_CHECKPOINT_FULL
+/// Like FULL, then wait for all readers to finish with the WAL, so that the next writer restarts it from the beginning.
+extern const int CHECKPOINT_RESTART;    // SQLITE_CHECKPOINT_RESTART
+/// Like RESTART, then truncate the WAL file to zero bytes.
+extern const int CHECKPOINT_TRUNCATE;   // SQLITE_CHECKPOINT_TRUNCATE
+
+
+/**
+ * @brief Maintenance service of a WAL database, running on its own thread and its own connection.
+ *
+ *  SQLite checkpoints the WAL automatically at the end of the commit which makes it larger than 1000 pages,
+ * in PASSIVE mode, on the writing connection: the writer pays for the checkpoint, and as long as readers
+ * use old snapshots the checkpoint cannot reach the end of the WAL, which then grows without limit,
+ * and every read gets slower because it searches the WAL index.
+ *
+ *  The Maintenance service moves checkpoints to a background connection. watch() replaces the automatic checkpoint
+ * of a writer connection by a WAL hook, which only records the size of the WAL after each commit, and wakes the service
+ * once it reaches a threshold. The service then runs a PASSIVE checkpoint, and escalates to RESTART or TRUNCATE
+ * when the WAL has grown past larger thresholds; those modes wait for the readers, up to the busy timeout.
+ * The service also checkpoints at a fixed interval, for the writes of other processes or of connections not watched.
+ *
+ *  The service optionally frees unused pages with "PRAGMA incremental_vacuum" (on a database created with
+ * "PRAGMA auto_vacuum=INCREMENTAL"), and refreshes the statistics of the query planner with "PRAGMA optimize",
+ * or with "ANALYZE" if the SQLite library predates "PRAGMA optimize" (3.18.0).
+ * The same operations can be run synchronously with checkpoint(), incrementalVacuum() and optimize().
+ *
+ *  Metrics (WAL size, checkpoint count, duration and frames copied...) are available with getMetrics().
+ *
+ * Thread-safety: all methods can be called from any thread. A watched connection must be unwatched,
+ * or closed, before the Maintenance service is destroyed.
+ */
+class Maintenance
+{
+public:
+    /// Metrics of the maintenance service
+    struct Metrics
+    {
+        int                 mWalFrames;             ///< Number of frames in the WAL, as of the most recent commit or checkpoint
+        long long           mWalBytes;              ///< Size of the WAL file in bytes, computed from the number of frames
+        unsigned long long  mCheckpointCount;       ///< Number of checkpoints run
+        unsigned long long  mBusyCheckpointCount;   ///< Number of RESTART/TRUNCATE checkpoints which could not complete
+        long long           mCheckpointedFrames;    ///< Total number of frames copied back to the database
+        double              mLastCheckpointMs;      ///< Duration of the most recent checkpoint
+        double              mMaxCheckpointMs;       ///< Duration of the longest checkpoint
+        double              mTotalCheckpointMs;     ///< Total duration of the checkpoints
+        long long           mVacuumedPages;         ///< Total number of pages freed by incremental vacuum
+        unsigned long long  mOptimizeCount;         ///< Number of optimize (or ANALYZE) runs
+        unsigned long long  mErrorCount;            ///< Number of background operations which failed
+    };
+
+    /**
+     * @brief Open the background connection to a WAL database, and start the maintenance thread.
+     *
+     * @param[in] aFilename         UTF-8 path/uri to the database file, which must already be in WAL mode
+     * @param[in] aBusyTimeoutMs    Busy timeout of the background connection, the longest a RESTART/TRUNCATE checkpoint waits
+     *
+     * @throw SQLite::Exception in case of error, or if the database is not in WAL mode
+     */
+    explicit Maintenance(const std::string& aFilename, const int aBusyTimeoutMs = 1000);
+
+    /// Stop the maintenance thread, and close the background connection.
+    ~Maintenance() noexcept; // nothrow
+
+    /**
+     * @brief Replace the automatic checkpoint of a connection by a WAL hook waking the maintenance service.
+     *
+     * @param[in] aDatabase     Connection writing to the database, which must be unwatched or closed before this service is destroyed
+     */
+    void watch(Database& aDatabase);
+
+    /// Restore the automatic checkpoint of a watched connection (every 1000 pages, the SQLite default).
+    void unwatch(Database& aDatabase);
+
+    /**
+     * @brief Set the WAL sizes, in frames (pages), triggering each checkpoint mode.
+     *
+     * @param[in] aPassiveFrames    A watched commit making the WAL larger wakes the service for a PASSIVE checkpoint (default 1000)
+     * @param[in] aRestartFrames    A checkpoint leaving a larger WAL escalates to RESTART (default 10000), 0 to never restart
+     * @param[in] aTruncateFrames   A checkpoint leaving a larger WAL escalates to TRUNCATE (default 100000), 0 to never truncate
+     */
+    void setCheckpointThresholds(const int aPassiveFrames, const int aRestartFrames, const int aTruncateFrames);
+
+    /// Set the interval between two checkpoints run without WAL hook (default 10 s), 0 to disable them.
+    void setCheckpointInterval(const int aIntervalMs);
+
+    /// Set the number of pages freed by each incremental vacuum step (0 for all), and the interval between the steps, 0 to disable them (default).
+    void setIncrementalVacuum(const int aPages, const int aIntervalMs);
+
+    /// Set the interval between two optimize (or ANALYZE) runs, 0 to disable them (default).
+    void setOptimizeInterval(const int aIntervalMs);
+
+    /**
+     * @brief Run a checkpoint on the background connection.
+     *
+     * @param[in] aMode     CHECKPOINT_PASSIVE/CHECKPOINT_FULL/CHECKPOINT_RESTART/CHECKPOINT_TRUNCATE
+     *
+     * @return false if the checkpoint could not complete because of other readers or writers (SQLITE_BUSY)
+     *
+     * @throw SQLite::Exception in case of error
+     */
+    bool checkpoint(const int aMode);
+
+    /**
+     * @brief Free unused pages of a database created with "PRAGMA auto_vacuum=INCREMENTAL".
+     *
+     * @param[in] aPages    Maximum number of pages to free, 0 for all
+     *
+     * @return the number of pages freed
+     *
+     * @throw SQLite::Exception in case of error
+     */
+    int incrementalVacuum(const int aPages);
+
+    /**
+     * @brief Refresh the statistics of the query planner, with "PRAGMA optimize" or "ANALYZE".
+     *
+     * @throw SQLite::Exception in case of error
+     */
+    void optimize();
+
+    /// Return the metrics of the maintenance service.
+    Metrics getMetrics() const;
+
+private:
+    /// @{ Maintenance must be non-copyable
+    Maintenance(const Maintenance&);
+    Maintenance& operator=(const Maintenance&);
+    /// @}
+
+    /// WAL hook of the watched connections
+    static int walHook(void* apMaintenance, sqlite3* apSQLite, const char* apDatabaseName, int aFrames);
+
+    /// Run a PASSIVE checkpoint, escalated to RESTART or TRUNCATE if the WAL is still too large
+    void checkpointByPolicy();
+
+    /// Loop of the maintenance thread
+    void loop() noexcept; // nothrow
+
+private:
+    Database                                mDatabase;              ///< Background connection
+    std::mutex                              mDatabaseMutex;         ///< Serialize the use of the background connection
+    long long                               mPageSize;              ///< Page size of the database, to compute the WAL size
+    mutable std::mutex                      mMutex;                 ///< Protect the state below
+    std::condition_variable                 mWakeUp;                ///< Signaled by the WAL hook, the setters, and on stop
+    bool                                    mbStopping;             ///< True when the maintenance thread must stop
+    bool                                    mbCheckpointRequested;  ///< True when the WAL hook has requested a checkpoint
+    bool                                    mbScheduleChanged;      ///< True when a setter has changed the next scheduled operations
+    int                                     mPassiveFrames;         ///< WAL size waking the service
+    int                                     mRestartFrames;         ///< WAL size escalating to RESTART
+    int                                     mTruncateFrames;        ///< WAL size escalating to TRUNCATE
+    int                                     mCheckpointIntervalMs;  ///< Interval between checkpoints without WAL hook
+    int                                     mVacuumPages;           ///< Pages freed by each incremental vacuum step
+    int                                     mVacuumIntervalMs;      ///< Interval between incremental vacuum steps
+    int                                     mOptimizeIntervalMs;    ///< Interval between optimize runs
+    std::chrono::steady_clock::time_point   mNextCheckpoint;        ///< Time of the next checkpoint without WAL hook
+    std::chrono::steady_clock::time_point   mNextVacuum;            ///< Time of the next incremental vacuum step
+    std::chrono::steady_clock::time_point   mNextOptimize;          ///< Time of the next optimize run
+    Metrics                                 mMetrics;               ///< Metrics of the service
+    std::thread                             mThread;                ///< Maintenance thread
+};
+
+
+}  // namespace SQLite
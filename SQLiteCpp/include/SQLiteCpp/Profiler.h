@@ -0,0 +1,160 @@
+/**
+ * @file    Profiler.h
+ * @ingroup SQLiteCpp
+ * @brief   Execution profile of the statements of one or more Database Connections, aggregated by normalized SQL query.
+ *
+ * Copyright (c) 2012-2016 Sebastien Rombauts (sebastien.rombauts@gmail.com)
+ *
+ * Distributed under the MIT License (MIT) (See accompanying file LICENSE.txt
+ * or copy at http://opensource.org/licenses/MIT)
+ */
+#pragma once
+
+#include <string>
+#include <vector>
+#include <ostream>
+#include <functional>
+#include <unordered_map>
+#include <mutex>
+
+
+namespace SQLite
+{
+
+
+/**
+ * @brief Execution profile of the statements of one or more Database Connections, aggregated by normalized SQL query.
+ *
+ *  Profiling is opt-in: Database::setProfiler() attaches a Profiler to a connection, and each Statement constructed
+ * afterward on this connection times its calls to sqlite3_step(), counts its rows, and reads the counters of
+ * sqlite3_stmt_status() (full scan steps, sorts, automatic indexes, virtual machine steps) at the end of each execution:
+ * when it is done, fails, is reset, or is destroyed. Database::exec() is profiled as a single execution,
+ * without statement counters.
+ *
+ *  Executions are aggregated by normalized SQL query: string, blob and numeric literals are replaced by "?",
+ * comments are removed and whitespace is collapsed, so that queries differing only by their literals share their
+ * statistics. A Statement normalizes its query once, when constructed.
+ * Statistics include the number of executions and errors, a histogram of the latencies, the number of rows,
+ * and the number of statements prepared, that is the statement cache misses (see Database::setStatementCacheCapacity()).
+ *
+ *  The latency of an execution is the time spent in sqlite3_step(), not including the time spent by the application
+ * between two rows. Each execution takes the lock of the Profiler once, to update its statistics.
+ *
+ * Thread-safety: a Profiler can be shared by connections used by different threads, and read with getStats() or dump()
+ * from any thread. It must outlive the Statements of the connections it is attached to.
+ */
+class Profiler
+{
+    friend class Statement; // Give Statement access to record() and recordPrepare()
+    friend class Database;  // Give Database access to record()
+
+public:
+    /// Number of buckets of the latency histogram: bucket 0 below 1 us, bucket N in [2^(N-1), 2^N[ us, and the last one above
+    static const int HISTOGRAM_BUCKETS = 24;
+
+    /// Statistics of a normalized SQL query
+    struct Stats
+    {
+        std::string         mQuery;                         ///< Normalized SQL query
+        unsigned long long  mExecutions;                    ///< Number of executions
+        unsigned long long  mErrors;                        ///< Number of executions ended by an error
+        unsigned long long  mPrepares;                      ///< Number of statements prepared (statement cache misses)
+        unsigned long long  mRows;                          ///< Number of rows returned
+        unsigned long long  mFullscanSteps;                 ///< Number of forward steps in a full table scan
+        unsigned long long  mSorts;                         ///< Number of sort operations
+        unsigned long long  mAutoIndexes;                   ///< Number of rows inserted into automatic indexes
+        unsigned long long  mVmSteps;                       ///< Number of virtual machine operations
+        long long           mTotalNs;                       ///< Total latency
+        long long           mMaxNs;                         ///< Longest latency
+        unsigned long long  mHistogram[HISTOGRAM_BUCKETS];  ///< Number of executions by latency
+
+        /**
+         * @brief Return an upper bound of a percentile of the latency, from the histogram.
+         *
+         * @param[in] aPercentile   Percentile in [0, 100], for instance 50 for the median, or 99
+         *
+         * @return the upper bound in nanoseconds of the histogram bucket of the percentile, at most the longest latency
+         */
+        long long getPercentileNs(const double aPercentile) const noexcept; // nothrow
+    };
+
+    /// Handler called the first time an execution of a normalized query builds an automatic index
+    typedef std::function<void (const std::string& aQuery)> TAutoIndexHandler;
+
+    /// Create an empty profile.
+    Profiler();
+
+    /**
+     * @brief Set a handler called, outside the lock of the Profiler, the first time a query builds an automatic index.
+     *
+     *  An automatic index means that the query planner found no usable index, and built a temporary one
+     * for the duration of the query: it is usually worth creating a permanent one.
+     */
+    void setAutoIndexHandler(const TAutoIndexHandler& aHandler);
+
+    /// Return the statistics of all queries, the largest total latency first.
+    std::vector<Stats> getStats() const;
+
+    /// Return the statistics of the queries which have built automatic indexes, the largest total latency first.
+    std::vector<Stats> getAutoIndexStats() const;
+
+    /**
+     * @brief Write the statistics of all queries as a table, the largest total latency first.
+     *
+     *  Queries which have built automatic indexes are flagged with "[autoindex]",
+     * and those which have scanned full tables with "[fullscan]".
+     */
+    void dump(std::ostream& aStream) const;
+
+    /// Clear all statistics.
+    void reset();
+
+    /**
+     * @brief Normalize a SQL query: replace its literals by "?", remove its comments and collapse its whitespace.
+     *
+     * \code{.cpp}
+     * normalize("SELECT * FROM t  WHERE id = 42 -- comment\n AND name='x'") == "SELECT * FROM t WHERE id = ? AND name=?"
+     * \endcode
+     */
+    static std::string normalize(const std::string& aQuery);
+
+private:
+    /// @{ Profiler must be non-copyable
+    Profiler(const Profiler&);
+    Profiler& operator=(const Profiler&);
+    /// @}
+
+    /// One execution of a statement
+    struct Execution
+    {
+        long long           mDurationNs;    ///< Time spent in sqlite3_step()
+        unsigned long long  mRows;          ///< Number of rows returned
+        int                 mFullscanSteps; ///< SQLITE_STMTSTATUS_FULLSCAN_STEP
+        int                 mSorts;         ///< SQLITE_STMTSTATUS_SORT
+        int                 mAutoIndexes;   ///< SQLITE_STMTSTATUS_AUTOINDEX
+        int                 mVmSteps;       ///< SQLITE_STMTSTATUS_VM_STEP
+        bool                mbError;        ///< true if the execution ended with an error
+    };
+
+    /// Add an execution to the statistics of a normalized query
+    void record(const std::string& aQuery, const Execution& aExecution) noexcept; // nothrow
+
+    /// Count a statement prepared for a normalized query
+    void recordPrepare(const std::string& aQuery) noexcept; // nothrow
+
+    /// Return the statistics of a normalized query, created empty if needed (the lock must be held)
+    Stats& getStatsLocked(const std::string& aQuery);
+
+    /// Return the statistics selected by a predicate, the largest total latency first
+    std::vector<Stats> getStatsIf(bool (*apPredicate)(const Stats&)) const;
+
+private:
+    typedef std::unordered_map<std::string, Stats> TStats;
+
+    mutable std::mutex  mMutex;             ///< Protect the statistics and the handler
+    TStats              mStats;             ///< Statistics by normalized query
+    TAutoIndexHandler   mAutoIndexHandler;  ///< Handler called the first time a query builds an automatic index
+};
+
+
+}  // namespace SQLite
@@ -0,0 +1,281 @@
+/**
+ * @file    Query.h
+ * @ingroup SQLiteCpp
+ * @brief   Typed query, with the types of its parameters and of its columns checked at compile time.
+ *
+ * Copyright (c) 2012-2016 Sebastien Rombauts (sebastien.rombauts@gmail.com)
+ *
+ * Distributed under the MIT License (MIT) (See accompanying file LICENSE.txt
+ * or copy at http://opensource.org/licenses/MIT)
+ */
+#pragma once
+
+#if (__cplusplus >= 201402L) || ( defined(_MSC_VER) && (_MSC_VER >= 1910) ) // c++14 relaxed constexpr: Visual Studio 2017
+
+#include <SQLiteCpp/Statement.h>
+#include <SQLiteCpp/Exception.h>
+
+#include <string>
+#include <tuple>
+#include <vector>
+#include <utility>
+#include <type_traits>
+#include <initializer_list>
+
+
+/**
+ * @brief Define a type holding a SQL query as a compile-time constant, to use as the first argument of SQLite::Query.
+ *
+ * \code{.cpp}
+ * SQLITECPP_SQL(SelectUsersOlderThan, "SELECT id, name FROM user WHERE age > ?");
+ * \endcode
+ */
+#define SQLITECPP_SQL(Name, Text)                                   \
+    struct Name                                                     \
+    {                                                               \
+        static constexpr const char* sql() { return Text; }         \
+    }
+
+
+namespace SQLite
+{
+
+
+/// List of the types of the columns of the rows of a Query, read with Statement::getColumns()
+template<typename... Columns>
+struct Row
+{
+};
+
+/// @cond
+namespace detail
+{
+
+/// Return true for the characters of a parameter name
+constexpr bool isNameChar(const char aChar)
+{
+    return ((aChar >= 'a') && (aChar <= 'z')) || ((aChar >= 'A') && (aChar <= 'Z'))
+        || ((aChar >= '0') && (aChar <= '9')) || (aChar == '_') || (static_cast<unsigned char>(aChar) >= 0x80);
+}
+
+/**
+ * @brief Return the index of the largest parameter of a SQL query, like sqlite3_bind_parameter_count().
+ *
+ *  Skips the string literals, the quoted identifiers and the comments.
+ * Each "?" has the index following the largest index so far, and each "?NNN" the index NNN.
+ * Each occurrence of a named parameter ":AAA", "@AAA" or "$AAA" is counted as a new parameter,
+ * so a name used twice counts twice at compile time; repeat a numbered "?NNN" instead.
+ */
+constexpr int countParameters(const char* apSql)
+{
+    int largest = 0;
+    char quote = '\0';
+    char previous = ' ';
+    for (std::size_t i = 0; apSql[i] != '\0'; previous = apSql[i], ++i)
+    {
+        const char c = apSql[i];
+        if (quote != '\0')
+        {
+            if (c == quote)
+            {
+                quote = '\0';
+            }
+        }
+        else if ((c == '\'') || (c == '"') || (c == '`'))
+        {
+            quote = c;
+        }
+        else if (c == '[')
+        {
+            quote = ']';
+        }
+        else if ((c == '-') && (apSql[i + 1] == '-'))
+        {
+            while ((apSql[i + 1] != '\0') && (apSql[i + 1] != '\n'))
+            {
+                ++i;
+            }
+        }
+        else if ((c == '/') && (apSql[i + 1] == '*'))
+        {
+            i += 2;
+            while ((apSql[i] != '\0') && ((apSql[i] != '*') || (apSql[i + 1] != '/')))
+            {
+                ++i;
+            }
+            if (apSql[i] == '\0')
+            {
+                break;
+            }
+            ++i;
+        }
+        else if (c == '?')
+        {
+            int number = 0;
+            while ((apSql[i + 1] >= '0') && (apSql[i + 1] <= '9'))
+            {
+                number = number * 10 + (apSql[++i] - '0');
+            }
+            largest = (number > 0) ? ((number > largest) ? number : largest) : (largest + 1);
+        }
+        else if (((c == ':') || (c == '@') || (c == '$')) && (false == isNameChar(previous)) && isNameChar(apSql[i + 1]))
+        {
+            ++largest;
+            while (isNameChar(apSql[i + 1]))
+            {
+                ++i;
+            }
+        }
+    }
+    return largest;
+}
+
+/// Types which can be bound by value with one of the Statement::bind() overloads
+template<typename T>
+struct IsBindable : std::integral_constant<bool,
+    std::is_same<T, int>::value || std::is_same<T, unsigned>::value || std::is_same<T, long long>::value
+    || std::is_same<T, double>::value || std::is_same<T, std::string>::value || std::is_same<T, const char*>::value>
+{
+};
+
+/// Logical and of a list of booleans
+template<bool... Values>
+struct All : std::is_same<All<Values...>, All<(Values || true)...> >
+{
+};
+
+} // namespace detail
+/// @endcond
+
+
+template<typename Sql, typename Params, typename Result = Row<> >
+class Query;
+
+/**
+ * @brief Typed query: a prepared Statement with the types of its parameters and columns fixed at compile time.
+ *
+ *  The SQL query is a compile-time constant (see SQLITECPP_SQL), and the number of its parameters is checked at compile time
+ * against the list of parameter types; each parameter type must match one of the Statement::bind() overloads exactly
+ * (int, unsigned, long long, double, std::string or const char*), and the column types must be supported by getColumns().
+ * The constructor also checks the number of parameters and of columns of the prepared statement.
+ *
+ *  The statement is prepared once, by the constructor, and reused by each call: keep the Query object for the life
+ * of the connection, or enable the statement cache of the Database (Database::setStatementCacheCapacity())
+ * to make short-lived Query objects cheap. Parameters are bound by the Statement::bind() overload selected at compile time.
+ * \code{.cpp}
+ * SQLITECPP_SQL(SelectUsersOlderThan, "SELECT id, name FROM user WHERE age > ?");
+ * SQLite::Query<SelectUsersOlderThan, std::tuple<int>, SQLite::Row<long long, std::string> > selectUsers(db);
+ * for (const auto& user : selectUsers(18))
+ * {
+ *     std::cout << std::get<0>(user) << ": " << std::get<1>(user) << "\n";
+ * }
+ * \endcode
+ *
+ * This feature requires a c++14 capable compiler (relaxed constexpr, std::index_sequence and Statement::getColumns()):
+ * Query is not declared under C++11. The CMake build selects C++14 when the compiler supports it.
+ */
+template<typename Sql, typename... Params, typename... Columns>
+class Query<Sql, std::tuple<Params...>, Row<Columns...> >
+{
+    static_assert(detail::countParameters(Sql::sql()) == static_cast<int>(sizeof...(Params)),
+                  "the number of parameter types does not match the number of parameters of the SQL query");
+    static_assert(detail::All<detail::IsBindable<Params>::value...>::value,
+                  "the parameter types must be int, unsigned, long long, double, std::string or const char*");
+
+public:
+    /// Type of the rows of the result
+    typedef std::tuple<Columns...> TRow;
+
+    /**
+     * @brief Prepare the query, or borrow it from the statement cache of the Database.
+     *
+     * @param[in] aDatabase the SQLite Database Connection
+     *
+     * @throw SQLite::Exception in case of error, or if the numbers of parameters or of columns do not match the types
+     */
+    explicit Query(Database& aDatabase) :
+        mStatement(aDatabase, Sql::sql())
+    {
+        if (mStatement.getBindParameterCount() != static_cast<int>(sizeof...(Params)))
+        {
+            throw SQLite::Exception("The number of parameter types does not match the query.");
+        }
+        if (mStatement.getColumnCount() != static_cast<int>(sizeof...(Columns)))
+        {
+            throw SQLite::Exception("The number of column types does not match the query.");
+        }
+    }
+
+    /**
+     * @brief Execute the query with new parameters, returning the range of its rows for a range-based for loop.
+     *
+     *  The range refers to the statement of this Query, which the next call resets.
+     */
+    Rows<Columns...> operator()(const Params&... aParams)
+    {
+        bindAll(std::index_sequence_for<Params...>(), aParams...);
+        return mStatement.rows<Columns...>();
+    }
+
+    /// Execute the query with new parameters, and return all the rows of its result.
+    std::vector<TRow> fetchAll(const Params&... aParams)
+    {
+        std::vector<TRow> rows;
+        bindAll(std::index_sequence_for<Params...>(), aParams...);
+        while (mStatement.executeStep())
+        {
+            rows.push_back(mStatement.getColumns<Columns...>());
+        }
+        return rows;
+    }
+
+    /**
+     * @brief Execute the query with new parameters, and return the first row of its result.
+     *
+     * @throw SQLite::Exception if the result is empty
+     */
+    TRow fetchOne(const Params&... aParams)
+    {
+        bindAll(std::index_sequence_for<Params...>(), aParams...);
+        if (false == mStatement.executeStep())
+        {
+            throw SQLite::Exception("The query returned no row.");
+        }
+        return mStatement.getColumns<Columns...>();
+    }
+
+    /**
+     * @brief Execute a statement without result with new parameters.
+     *
+     * @return number of rows modified by an INSERT, UPDATE or DELETE
+     */
+    int exec(const Params&... aParams)
+    {
+        static_assert(sizeof...(Columns) == 0, "use operator(), fetchAll() or fetchOne() for a query with a result");
+        bindAll(std::index_sequence_for<Params...>(), aParams...);
+        return mStatement.exec();
+    }
+
+    /// Return the underlying Statement.
+    Statement& getStatement() noexcept // nothrow
+    {
+        return mStatement;
+    }
+
+private:
+    /// Reset the statement, and bind each parameter with the overload of its type
+    template<std::size_t... Indexes>
+    void bindAll(std::index_sequence<Indexes...>, const Params&... aParams)
+    {
+        mStatement.reset();
+        (void)std::initializer_list<int>{ 0, (mStatement.bind(static_cast<int>(Indexes + 1), aParams), 0)... };
+    }
+
+private:
+    Statement mStatement;   ///< Prepared statement, reset by each call
+};
+
+
+}  // namespace SQLite
+
+#endif // c++14 relaxed constexpr
@@ -22,8 +22,22 @@
 #include <SQLiteCpp/Exception.h>
 #include <SQLiteCpp/Database.h>
 #include <SQLiteCpp/Statement.h>
+#include <SQLiteCpp/StatementCache.h>
 #include <SQLiteCpp/Column.h>
+#include <SQLiteCpp/ColumnView.h>
 #include <SQLiteCpp/Transaction.h>
+#include <SQLiteCpp/ConnectionPool.h>
+#include <SQLiteCpp/BulkInserter.h>
+#include <SQLiteCpp/AsyncExecutor.h>
+#include <SQLiteCpp/BackupDriver.h>
+#include <SQLiteCpp/Blob.h>
+#include <SQLiteCpp/Maintenance.h>
+#include <SQLiteCpp/Query.h>
+#include <SQLiteCpp/Profiler.h>
+#include <SQLiteCpp/VirtualTable.h>
+#include <SQLiteCpp/ChangeFeed.h>
+#include <SQLiteCpp/ShardSet.h>
+#include <SQLiteCpp/Function.h>
 
 
 /**
@@ -0,0 +1,349 @@
+/**
+ * @file    ShardSet.h
+ * @ingroup SQLiteCpp
+ * @brief   Set of database files sharing one schema, queried in parallel on a thread pool with merged results.
+ *
+ * Copyright (c) 2012-2016 Sebastien Rombauts (sebastien.rombauts@gmail.com)
+ *
+ * Distributed under the MIT License (MIT) (See accompanying file LICENSE.txt
+ * or copy at http://opensource.org/licenses/MIT)
+ */
+#pragma once
+
+#include <SQLiteCpp/Database.h>
+#include <SQLiteCpp/Statement.h>
+
+#include <string>
+#include <vector>
+#include <deque>
+#include <algorithm>
+#include <iterator>
+#include <memory>
+#include <functional>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <type_traits>
+#include <utility>
+
+
+namespace SQLite
+{
+
+
+/**
+ * @brief Set of database files sharing one schema (the shards), queried in parallel on a thread pool.
+ *
+ *  The ShardSet opens one Database Connection to each file, with its own statement cache, so the same query
+ * is prepared once per shard and then reused. A query is run on all the shards, or on a selection of them,
+ * by the threads of a fixed pool, and the rows read on each shard are merged:
+ * - concat() concatenates the rows of the shards, in the order of the shards,
+ * - merge() does a k-way merge of the rows of the shards, each sorted by the ORDER BY clause of the query,
+ * - aggregate() combines the partial aggregates COUNT, SUM, MIN and MAX of the shards, grouped by key columns.
+ * \code{.cpp}
+ * SQLite::ShardSet shards(filenames);
+ * std::vector<std::pair<long long, std::string> > recent = shards.merge(
+ *     "SELECT id, name FROM user ORDER BY id DESC LIMIT 10",
+ *     [](SQLite::Statement& aQuery) { return std::make_pair(aQuery.getColumn(0).getInt64(), aQuery.getColumn(1).getString()); },
+ *     [](const std::pair<long long, std::string>& aLeft, const std::pair<long long, std::string>& aRight) { return aLeft.first > aRight.first; },
+ *     10);
+ * \endcode
+ *
+ *  A query failing on a shard makes the whole call throw, once all the shards have completed:
+ * the exception of the first failing shard, in the order of the selection, is rethrown.
+ *
+ * Thread-safety: a ShardSet can be shared by multiple threads; the queries on one shard are serialized.
+ * The functions of the queries (row readers, binders, tasks of forEach()) are called on the threads of the pool,
+ * and must not themselves query the ShardSet.
+ */
+class ShardSet
+{
+public:
+    /// Function called once on each new shard connection (pragmas, createFunction()...)
+    typedef std::function<void (Database&)> TSetup;
+    /// Function binding the parameters of the query, called on each shard
+    typedef std::function<void (Statement&)> TBind;
+    /// Indexes of the shards to query; empty for all of them
+    typedef std::vector<std::size_t> TShards;
+
+    /// Combination of a column of the partial results of aggregate()
+    enum Aggregate
+    {
+        KEY,    ///< Column of the GROUP BY clause: rows of the shards with the same keys are combined
+        COUNT,  ///< count(): sum of the counts
+        SUM,    ///< sum(): sum of the sums, integer while all of them are integers, NULL if all of them are NULL
+        MIN,    ///< min(): smallest non-NULL value, in the SQLite order (numbers, then text, then blobs)
+        MAX     ///< max(): largest non-NULL value, in the SQLite order
+    };
+
+    /// Value of a column of a row returned by aggregate()
+    struct Value
+    {
+        int         mType;      ///< SQLite::INTEGER, SQLite::FLOAT, SQLite::TEXT, SQLite::BLOB or SQLite::Null
+        long long   mInteger;   ///< Value of an INTEGER
+        double      mFloat;     ///< Value of a FLOAT
+        std::string mText;      ///< Bytes of a TEXT or a BLOB
+    };
+    typedef std::vector<Value> TRow;
+
+    /// Type of the result of a function "R function(Statement&)" reading a row
+    template<typename Function>
+    struct Result
+    {
+        typedef typename std::decay<decltype(std::declval<Function&>()(std::declval<Statement&>()))>::type type;
+    };
+
+    /// Type of the result of a function "R function(Database&, std::size_t aShard)" called on a shard
+    template<typename Function>
+    struct ShardResult
+    {
+        typedef typename std::decay<decltype(std::declval<Function&>()(std::declval<Database&>(), std::declval<std::size_t>()))>::type type;
+    };
+
+    /**
+     * @brief Open all the shards, and start the thread pool.
+     *
+     * @param[in] aFilenames                UTF-8 path/uri to the database file of each shard
+     * @param[in] aFlags                    Open flags of the shards (SQLite::OPEN_READONLY by default)
+     * @param[in] aThreadCount              Number of threads of the pool, 0 for the number of cores (at most one per shard)
+     * @param[in] aSetup                    Optional function called once on each shard connection
+     * @param[in] aStatementCacheCapacity   Capacity of the statement cache of each shard connection
+     *
+     * @throw SQLite::Exception in case of error
+     */
+    explicit ShardSet(const std::vector<std::string>& aFilenames,
+                      const int                       aFlags = SQLite::OPEN_READONLY,
+                      const std::size_t               aThreadCount = 0,
+                      const TSetup&                   aSetup = TSetup(),
+                      const std::size_t               aStatementCacheCapacity = 16);
+
+    /// Stop the thread pool, and close all the shards.
+    ~ShardSet() noexcept; // nothrow
+
+    /// Return the number of shards.
+    std::size_t getShardCount() const noexcept // nothrow
+    {
+        return mShards.size();
+    }
+
+    /// Return the number of threads of the pool.
+    std::size_t getThreadCount() const noexcept // nothrow
+    {
+        return mThreads.size();
+    }
+
+    /// Return the UTF-8 filename of a shard.
+    const std::string& getFilename(const std::size_t aShard) const
+    {
+        return mShards.at(aShard)->mDatabase.getFilename();
+    }
+
+    /**
+     * @brief Call a function on each selected shard in parallel, and return its results in the order of the selection.
+     *
+     * @param[in] aFunction Function "R function(Database&, std::size_t aShard)", called with the lock of the shard
+     * @param[in] aShards   Indexes of the shards, or empty for all of them
+     *
+     * @throw the exception of the first failing shard
+     */
+    template<typename Function>
+    std::vector<typename ShardResult<Function>::type>
+    forEach(Function aFunction, const TShards& aShards = TShards())
+    {
+        typedef typename ShardResult<Function>::type R;
+        const TShards shards = select(aShards);
+        std::vector<std::unique_ptr<R> > results(shards.size());
+        run(shards, [&](const std::size_t aIndex, Database& aDatabase)
+        {
+            results[aIndex].reset(new R(aFunction(aDatabase, shards[aIndex])));
+        });
+        std::vector<R> values;
+        values.reserve(results.size());
+        for (std::size_t i = 0; i < results.size(); ++i)
+        {
+            values.push_back(std::move(*results[i]));
+        }
+        return values;
+    }
+
+    /**
+     * @brief Execute a query on each selected shard, and concatenate their rows in the order of the selection.
+     *
+     * @param[in] aQuery    SQL query
+     * @param[in] aRead     Function "Row function(Statement&)" reading the current row
+     * @param[in] aShards   Indexes of the shards, or empty for all of them
+     * @param[in] aBind     Optional function binding the parameters of the query
+     *
+     * @throw the exception of the first failing shard
+     */
+    template<typename Read>
+    std::vector<typename Result<Read>::type> concat(const std::string& aQuery, Read aRead,
+                                                    const TShards& aShards = TShards(), const TBind& aBind = TBind())
+    {
+        typedef typename Result<Read>::type Row;
+        std::vector<std::vector<Row> > parts = readAll(aQuery, aRead, 0, aShards, aBind);
+        std::size_t count = 0;
+        for (std::size_t i = 0; i < parts.size(); ++i)
+        {
+            count += parts[i].size();
+        }
+        std::vector<Row> rows;
+        rows.reserve(count);
+        for (std::size_t i = 0; i < parts.size(); ++i)
+        {
+            std::move(parts[i].begin(), parts[i].end(), std::back_inserter(rows));
+        }
+        return rows;
+    }
+
+    /**
+     * @brief Execute an ordered query on each selected shard, and merge their sorted rows.
+     *
+     *  The ORDER BY clause of the query must sort the rows of each shard as aLess does;
+     * rows comparing equal are taken from the shards in the order of the selection.
+     * A LIMIT clause should be given as aLimit too, to stop reading each shard and to truncate the merge.
+     *
+     * @param[in] aQuery    SQL query
+     * @param[in] aRead     Function "Row function(Statement&)" reading the current row
+     * @param[in] aLess     Function "bool function(const Row&, const Row&)", the order of the ORDER BY clause
+     * @param[in] aLimit    Maximum number of rows, or 0 for all
+     * @param[in] aShards   Indexes of the shards, or empty for all of them
+     * @param[in] aBind     Optional function binding the parameters of the query
+     *
+     * @throw the exception of the first failing shard
+     */
+    template<typename Read, typename Less>
+    std::vector<typename Result<Read>::type> merge(const std::string& aQuery, Read aRead, Less aLess,
+                                                   const std::size_t aLimit = 0,
+                                                   const TShards& aShards = TShards(), const TBind& aBind = TBind())
+    {
+        typedef typename Result<Read>::type Row;
+        std::vector<std::vector<Row> > parts = readAll(aQuery, aRead, aLimit, aShards, aBind);
+
+        // Binary min-heap of the shards, on their next row (ties broken by the order of the selection)
+        std::vector<std::size_t> next(parts.size(), 0);
+        std::vector<std::size_t> heap;
+        std::size_t count = 0;
+        for (std::size_t i = 0; i < parts.size(); ++i)
+        {
+            if (false == parts[i].empty())
+            {
+                heap.push_back(i);
+                count += parts[i].size();
+            }
+        }
+        const auto greater = [&](const std::size_t aLeft, const std::size_t aRight)
+        {
+            const Row& left = parts[aLeft][next[aLeft]];
+            const Row& right = parts[aRight][next[aRight]];
+            return aLess(right, left) || ((false == aLess(left, right)) && (aLeft > aRight));
+        };
+        std::make_heap(heap.begin(), heap.end(), greater);
+
+        std::vector<Row> rows;
+        rows.reserve(((0 != aLimit) && (aLimit < count)) ? aLimit : count);
+        while ((false == heap.empty()) && ((0 == aLimit) || (rows.size() < aLimit)))
+        {
+            std::pop_heap(heap.begin(), heap.end(), greater);
+            const std::size_t shard = heap.back();
+            rows.push_back(std::move(parts[shard][next[shard]]));
+            if (++next[shard] < parts[shard].size())
+            {
+                std::push_heap(heap.begin(), heap.end(), greater);
+            }
+            else
+            {
+                heap.pop_back();
+            }
+        }
+        return rows;
+    }
+
+    /**
+     * @brief Execute an aggregate query on each selected shard, and combine their partial results.
+     *
+     *  Each column of the query is described by an Aggregate: the KEY columns are those of the GROUP BY clause,
+     * and the rows of the shards with the same keys are combined into one, in the order of their keys.
+     * Only aggregates which combine exactly are supported: an average must be queried as a SUM and a COUNT.
+     * \code{.cpp}
+     * const SQLite::ShardSet::Aggregate columns[] = { SQLite::ShardSet::KEY, SQLite::ShardSet::COUNT, SQLite::ShardSet::MAX };
+     * std::vector<SQLite::ShardSet::TRow> rows = shards.aggregate("SELECT country, count(*), max(age) FROM user GROUP BY country",
+     *                                                             std::vector<SQLite::ShardSet::Aggregate>(columns, columns + 3));
+     * \endcode
+     *
+     * @param[in] aQuery    SQL query
+     * @param[in] aColumns  Combination of each column of the query
+     * @param[in] aShards   Indexes of the shards, or empty for all of them
+     * @param[in] aBind     Optional function binding the parameters of the query
+     *
+     * @return the combined rows, at most one without KEY columns
+     *
+     * @throw SQLite::Exception if the columns do not match the query or if a SUM overflows,
+     *        or the exception of the first failing shard
+     */
+    std::vector<TRow> aggregate(const std::string& aQuery, const std::vector<Aggregate>& aColumns,
+                                const TShards& aShards = TShards(), const TBind& aBind = TBind());
+
+private:
+    /// @{ ShardSet must be non-copyable
+    ShardSet(const ShardSet&);
+    ShardSet& operator=(const ShardSet&);
+    /// @}
+
+    /// Connection to a shard, with the lock serializing its queries
+    struct Shard
+    {
+        Shard(const std::string& aFilename, const int aFlags) :
+            mDatabase(aFilename, aFlags)
+        {
+        }
+        Database    mDatabase;  ///< Connection to the shard
+        std::mutex  mMutex;     ///< Serialize the queries on the shard
+    };
+
+    /// Task of the thread pool
+    typedef std::function<void ()> TTask;
+
+    /// Return the selected shards, or all of them, checking their indexes
+    TShards select(const TShards& aShards) const;
+
+    /// Call a function on each selected shard on the thread pool, wait for all, and rethrow the first exception
+    void run(const TShards& aShards, const std::function<void (std::size_t aIndex, Database& aDatabase)>& aFunction);
+
+    /// Execute a query on each selected shard, and read up to aLimit rows of each one (0 for all)
+    template<typename Read>
+    std::vector<std::vector<typename Result<Read>::type> > readAll(const std::string& aQuery, Read& aRead, const std::size_t aLimit,
+                                                                   const TShards& aShards, const TBind& aBind)
+    {
+        typedef typename Result<Read>::type Row;
+        const TShards shards = select(aShards);
+        std::vector<std::vector<Row> > parts(shards.size());
+        run(shards, [&](const std::size_t aIndex, Database& aDatabase)
+        {
+            Statement query(aDatabase, aQuery);
+            if (aBind)
+            {
+                aBind(query);
+            }
+            while (((0 == aLimit) || (parts[aIndex].size() < aLimit)) && query.executeStep())
+            {
+                parts[aIndex].push_back(aRead(query));
+            }
+        });
+        return parts;
+    }
+
+    /// Loop of the threads of the pool
+    void loop() noexcept; // nothrow
+
+private:
+    std::vector<std::unique_ptr<Shard> >    mShards;        ///< Connections to the shards
+    std::mutex                              mMutex;         ///< Protect the queue of the pool
+    std::condition_variable                 mTaskQueued;    ///< Signaled when a task is queued, or on stop
+    std::deque<TTask>                       mTasks;         ///< Queued tasks
+    bool                                    mbStopping;     ///< True when the threads must stop
+    std::vector<std::thread>                mThreads;       ///< Threads of the pool
+};
+
+
+}  // namespace SQLite
@@ -11,9 +11,18 @@
 #pragma once
 
 #include <SQLiteCpp/Exception.h>
+#include <SQLiteCpp/ColumnView.h>
+#include <SQLiteCpp/StatementCache.h>
 
 #include <string>
-#include <map>
+#include <vector>
+#include <utility>
+
+#if (__cplusplus >= 201402L) || ( defined(_MSC_VER) && (_MSC_VER >= 1900) ) // c++14: Visual Studio 2015
+#include <tuple>
+#include <iterator>
+#include <initializer_list>
+#endif
 
 // Forward declarations to avoid inclusion of <sqlite3.h> in a header
 struct sqlite3;
@@ -27,6 +36,11 @@ namespace SQLite
 // Forward declaration
 class Database;
 class Column;
+class Profiler;
+#if (__cplusplus >= 201402L) || ( defined(_MSC_VER) && (_MSC_VER >= 1900) ) // c++14: Visual Studio 2015
+template<typename... Types>
+class Rows;
+#endif
 
 extern const int OK; ///< SQLITE_OK
 
@@ -58,6 +72,10 @@ public:
      * @param[in] aDatabase the SQLite Database Connection
      * @param[in] apQuery   an UTF-8 encoded query string
      *
+     * If the statement cache of the Database is enabled (see Database::setStatementCacheCapacity()),
+     * an idle statement compiled from the same query is borrowed from it instead of being prepared,
+     * and it is given back to the cache instead of being finalized.
+     *
      * Exception is thrown in case of error, then the Statement object is NOT constructed.
      */
     Statement(Database& aDatabase, const char* apQuery);
@@ -68,6 +86,10 @@ public:
      * @param[in] aDatabase the SQLite Database Connection
      * @param[in] aQuery    an UTF-8 encoded query string
      *
+     * If the statement cache of the Database is enabled (see Database::setStatementCacheCapacity()),
+     * an idle statement compiled from the same query is borrowed from it instead of being prepared,
+     * and it is given back to the cache instead of being finalized.
+     *
      * Exception is thrown in case of error, then the Statement object is NOT constructed.
      */
     Statement(Database& aDatabase, const std::string& aQuery);
@@ -427,6 +449,147 @@ public:
      */
     Column  getColumn(const char* apName);
 
+    /**
+     * @brief Return a non-owning view of the column data specified by its index
+     *
+     *  Same as getColumn(), but the ColumnView does not share the ownership of the underlying sqlite3_stmt,
+     * which avoids the reference counting of a Column in tight loops.
+     *
+     *  Throw an exception if there is no row to return a ColumnView from, or if the index is out of range.
+     *
+     * @param[in] aIndex    Index of the column, starting at 0
+     *
+     * @warning The resulting ColumnView is only valid until the next executeStep() call.
+     */
+    inline ColumnView getColumnView(const int aIndex) const
+    {
+        checkRow();
+        checkIndex(aIndex);
+        return ColumnView(mStmtPtr, aIndex);
+    }
+
+    /**
+     * @brief Return a non-owning view of the column data specified by its column name
+     *
+     * @param[in] apName   Aliased name of the column, that is, the named specified in the query (not the original name)
+     *
+     * @note    Uses a sorted vector of column names, build on first call: no allocation per lookup.
+     *
+     * @warning The resulting ColumnView is only valid until the next executeStep() call.
+     */
+    inline ColumnView getColumnView(const char* apName) const
+    {
+        checkRow();
+        return ColumnView(mStmtPtr, getColumnIndex(apName));
+    }
+
+#if (__cplusplus >= 201402L) || ( defined(_MSC_VER) && (_MSC_VER >= 1900) ) // c++14: Visual Studio 2015
+    /**
+     * @brief Return the first columns of the current row as a tuple of the provided types.
+     *
+     *  The columns are bound to their index at compile time, and the row and column count are checked only once,
+     * so this is the cheapest way to read typed rows:
+     * \code{.cpp}
+     * while (query.executeStep())
+     * {
+     *     int id; std::string_view name; double weight;
+     *     std::tie(id, name, weight) = query.getColumns<int, std::string_view, double>();
+     * }
+     * \endcode
+     *
+     *  Supported types are int, unsigned, long, long long, double, const char*, std::string,
+     * std::string_view (c++17) and ColumnView.
+     *
+     * This feature requires a c++14 capable compiler.
+     *
+     * @warning const char*, std::string_view and ColumnView values are only valid until the next executeStep() call.
+     *
+     *  Throw an exception if there is no row, or if the row has fewer columns than the requested types.
+     */
+    template<typename... Types>
+    std::tuple<Types...> getColumns() const
+    {
+        static_assert(sizeof...(Types) > 0, "please invoke getColumns with one or more types");
+        checkRow();
+        if (static_cast<int>(sizeof...(Types)) > mColumnCount)
+        {
+            throw SQLite::Exception("Column index out of range.");
+        }
+        return getColumns<Types...>(std::index_sequence_for<Types...>());
+    }
+
+    /**
+     * @brief Return a range of the remaining rows of the result, typed as tuples, for a range-based for loop.
+     *
+     *  Each row is read with getColumns(), so the same types are supported:
+     * \code{.cpp}
+     * SQLite::Statement query(db, "SELECT id, name FROM test");
+     * for (auto [id, name] : query.rows<int, std::string>()) // c++17 structured bindings
+     * {
+     *     ...
+     * }
+     * \endcode
+     *
+     *  The first row is fetched by begin(): the statement must not have been stepped since its last reset().
+     *
+     * This feature requires a c++14 capable compiler.
+     */
+    template<typename... Types>
+    Rows<Types...> rows()
+    {
+        return Rows<Types...>(*this);
+    }
+
+    /**
+     * @brief Fetch up to aMaxRows rows of the result into one vector per column, for vectorized processing.
+     *
+     *  The vectors are cleared, then filled with the columns of the next rows, starting with the first columns
+     * of the result. Call it again to fetch the next rows, until it returns 0:
+     * \code{.cpp}
+     * std::vector<long long> ids;
+     * std::vector<double>    weights;
+     * while (query.fetchColumns(4096, ids, weights) > 0)
+     * {
+     *     total += std::accumulate(weights.begin(), weights.end(), 0.0);
+     * }
+     * \endcode
+     *
+     *  Supported types are the value types of getColumns(): int, unsigned, long, long long, double and std::string
+     * (const char*, std::string_view or ColumnView would not outlive their row).
+     *
+     * This feature requires a c++14 capable compiler.
+     *
+     * @param[in]  aMaxRows     Maximum number of rows to fetch by this call, or SIZE_MAX for all the remaining rows;
+     *                          the vectors are reserved for at most 4096 rows, and grow beyond
+     * @param[out] aColumns     One vector per column
+     *
+     * @return the number of rows fetched, 0 when the query has finished executing
+     *
+     *  Throw an exception in case of error, or if the result has fewer columns than the provided vectors.
+     */
+    template<typename... Types>
+    std::size_t fetchColumns(const std::size_t aMaxRows, std::vector<Types>&... aColumns)
+    {
+        static_assert(sizeof...(Types) > 0, "please invoke fetchColumns with one or more vectors");
+        if (static_cast<int>(sizeof...(Types)) > mColumnCount)
+        {
+            throw SQLite::Exception("Column index out of range.");
+        }
+        // A batch size is not a row count: do not allocate more than a typical batch up front
+        const std::size_t maxReserved = 4096;
+        const std::size_t reserved = (aMaxRows < maxReserved) ? aMaxRows : maxReserved;
+        std::initializer_list<int> { (aColumns.clear(), aColumns.reserve(reserved), 0)... };
+
+        std::size_t count = 0;
+        while ((count < aMaxRows) && (false == mbDone) && executeStep())
+        {
+            fetchRow(std::index_sequence_for<Types...>(), aColumns...);
+            ++count;
+        }
+        return count;
+    }
+#endif
+
     /**
      * @brief Test if the column value is NULL
      *
@@ -478,7 +641,7 @@ public:
      *
      * @param[in] apName    Aliased name of the column, that is, the named specified in the query (not the original name)
      *
-     * @note Uses a map of column names to indexes, build on first call.
+     * @note Uses a sorted vector of column names to indexes, build on first call: no allocation per lookup.
      *
      *  Throw an exception if the specified name is not known.
      */
@@ -496,6 +659,8 @@ public:
     {
         return mColumnCount;
     }
+    /// Return the index of the largest parameter of the prepared statement, usually the number of its parameters
+    int getBindParameterCount() const noexcept; // nothrow
     /// true when a row has been fetched with executeStep()
     inline bool isOk() const
     {
@@ -525,8 +690,8 @@ private:
     class Ptr
     {
     public:
-        // Prepare the statement and initialize its reference counter
-        Ptr(sqlite3* apSQLite, std::string& aQuery);
+        // Prepare the statement, or check it out of the cache, and initialize its reference counter
+        Ptr(sqlite3* apSQLite, std::string& aQuery, StatementCache* apCache = NULL);
         // Copy constructor increments the ref counter
         Ptr(const Ptr& aPtr);
         // Decrement the ref counter and finalize the sqlite3_stmt when it reaches 0
@@ -544,6 +709,12 @@ private:
             return mpStmt;
         }
 
+        /// Return true if the sqlite3_stmt was prepared by this Ptr, false if it was checked out of the cache
+        inline bool isPrepared() const
+        {
+            return mbPrepared;
+        }
+
     private:
         /// @{ Unused/forbidden copy/assignment operator
         Ptr& operator=(const Ptr& aPtr);
@@ -554,14 +725,46 @@ private:
         sqlite3_stmt*   mpStmt;      //!< Pointer to SQLite Statement Object
         unsigned int*   mpRefCount;  //!< Pointer to the heap allocated reference counter of the sqlite3_stmt
                                      //!< (to share it with Column objects)
+        StatementCache* mpCache;     //!< Cache to give the sqlite3_stmt back to instead of finalizing it (or NULL)
+        StatementCache::Checkout mCheckout; //!< Handle to give the sqlite3_stmt back to the cache, with the SQL text of the checkout
+        bool            mbPrepared;  //!< true if the sqlite3_stmt was prepared, false if checked out of the cache
     };
 
 private:
+#if (__cplusplus >= 201402L) || ( defined(_MSC_VER) && (_MSC_VER >= 1900) ) // c++14: Visual Studio 2015
+    /// implementation detail of getColumns()
+    template<typename... Types, std::size_t... Indexes>
+    std::tuple<Types...> getColumns(std::index_sequence<Indexes...>) const
+    {
+        sqlite3_stmt* pStmt = mStmtPtr;
+        return std::tuple<Types...>(detail::ColumnGetter<Types>::get(ColumnView(pStmt, static_cast<int>(Indexes)))...);
+    }
+
+    /// implementation detail of fetchColumns()
+    template<typename... Types, std::size_t... Indexes>
+    void fetchRow(std::index_sequence<Indexes...>, std::vector<Types>&... aColumns) const
+    {
+        sqlite3_stmt* pStmt = mStmtPtr;
+        std::initializer_list<int> {
+            (aColumns.push_back(detail::ColumnGetter<Types>::get(ColumnView(pStmt, static_cast<int>(Indexes)))), 0)...
+        };
+    }
+#endif
+
     /// @{ Statement must be non-copyable
     Statement(const Statement&);
     Statement& operator=(const Statement&);
     /// @}
 
+    /// Normalize the query and count the statement prepared, for the Profiler of the Database if any
+    void initProfile();
+
+    /// Step the statement, timing it and counting its rows if the Database has a Profiler
+    int step();
+
+    /// Report the current execution to the Profiler, if it has been stepped
+    void endProfile(const bool abError) noexcept; // nothrow
+
     /**
      * @brief Check if a return code equals SQLITE_OK, else throw a SQLite::Exception with the SQLite error message
      *
@@ -598,17 +801,102 @@ private:
     }
 
 private:
-    /// Map of columns index by name (mutable so getColumnIndex can be const)
-    typedef std::map<std::string, int> TColumnNames;
+    /// Columns index by name, sorted by name to be searched without building a std::string key
+    typedef std::vector<std::pair<std::string, int> > TColumnNames;
 
 private:
     std::string             mQuery;         //!< UTF-8 SQL Query
     Ptr                     mStmtPtr;       //!< Shared Pointer to the prepared SQLite Statement Object
     int                     mColumnCount;   //!< Number of columns in the result of the prepared statement
-    mutable TColumnNames    mColumnNames;   //!< Map of columns index by name (mutable so getColumnIndex can be const)
+    mutable TColumnNames    mColumnNames;   //!< Columns index by name (mutable so getColumnIndex can be const)
     bool                    mbOk;           //!< true when a row has been fetched with executeStep()
     bool                    mbDone;         //!< true when the last executeStep() had no more row to fetch
+    Profiler*               mpProfiler;     //!< Profiler of the Database when the statement was constructed, or NULL
+    std::string             mProfiledQuery; //!< SQL Query normalized by the Profiler
+    long long               mProfileNs;     //!< Time spent in sqlite3_step() by the current execution
+    unsigned long long      mProfileRows;   //!< Number of rows fetched by the current execution
+    bool                    mbProfiling;    //!< true when the current execution has been stepped and not yet reported
+};
+
+
+#if (__cplusplus >= 201402L) || ( defined(_MSC_VER) && (_MSC_VER >= 1900) ) // c++14: Visual Studio 2015
+/**
+ * @brief Range of the remaining rows of the result of a Statement, typed as tuples (see Statement::rows()).
+ *
+ *  A single pass input range: begin() fetches the first row, and incrementing an iterator fetches the next row.
+ */
+template<typename... Types>
+class Rows
+{
+public:
+    /// Input iterator over the rows of the Statement
+    class iterator
+    {
+    public:
+        typedef std::input_iterator_tag iterator_category;
+        typedef std::tuple<Types...>    value_type;
+        typedef std::ptrdiff_t          difference_type;
+        typedef const value_type*       pointer;
+        typedef value_type              reference;
+
+        explicit iterator(Statement* apStatement = NULL) noexcept : // nothrow
+            mpStatement(apStatement)
+        {
+        }
+
+        /// Return the current row
+        value_type operator*() const
+        {
+            return mpStatement->getColumns<Types...>();
+        }
+
+        /// Fetch the next row
+        iterator& operator++()
+        {
+            if (false == mpStatement->executeStep())
+            {
+                mpStatement = NULL;
+            }
+            return *this;
+        }
+
+        bool operator==(const iterator& aOther) const noexcept // nothrow
+        {
+            return (mpStatement == aOther.mpStatement);
+        }
+        bool operator!=(const iterator& aOther) const noexcept // nothrow
+        {
+            return (mpStatement != aOther.mpStatement);
+        }
+
+    private:
+        Statement*  mpStatement;    ///< Statement pointing to the current row, NULL at the end
+    };
+
+    explicit Rows(Statement& aStatement) noexcept : // nothrow
+        mStatement(aStatement)
+    {
+    }
+
+    /// Fetch the first row
+    iterator begin()
+    {
+        if (mStatement.isOk())
+        {
+            throw SQLite::Exception("Statement needs to be reseted.");
+        }
+        return mStatement.executeStep() ? iterator(&mStatement) : iterator();
+    }
+
+    iterator end() noexcept // nothrow
+    {
+        return iterator();
+    }
+
+private:
+    Statement&  mStatement; ///< Statement to fetch the rows from
 };
+#endif
 
 
 }  // namespace SQLite
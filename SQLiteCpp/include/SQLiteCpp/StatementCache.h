@@ -0,0 +1,170 @@
+/**
+ * @file    StatementCache.h
+ * @ingroup SQLiteCpp
+ * @brief   LRU cache of prepared SQLite Statements, owned by a Database Connection.
+ *
+ * Copyright (c) 2012-2016 Sebastien Rombauts (sebastien.rombauts@gmail.com)
+ *
+ * Distributed under the MIT License (MIT) (See accompanying file LICENSE.txt
+ * or copy at http://opensource.org/licenses/MIT)
+ */
+#pragma once
+
+#include <string>
+#include <list>
+#include <unordered_map>
+
+// Forward declarations to avoid inclusion of <sqlite3.h> in a header
+struct sqlite3;
+struct sqlite3_stmt;
+
+
+namespace SQLite
+{
+
+
+/**
+ * @brief LRU cache of idle prepared statements, keyed on their SQL text.
+ *
+ * A Statement constructed on a Database with a non-zero cache capacity checks out an idle sqlite3_stmt
+ * compiled from the same SQL text instead of calling sqlite3_prepare_v2(), and returns it to the cache
+ * instead of finalizing it when the last Statement or Column object referring to it is destroyed.
+ * Returned statements are reset and their bindings cleared, so a checked out statement is always
+ * in the same state as a freshly prepared one.
+ *
+ * The cache only holds idle statements: a statement in use is owned by its Statement objects,
+ * and the same SQL text used by two live Statement objects is prepared twice.
+ * The entry of a checked out statement, with its SQL text, is kept aside until it is given back,
+ * so neither the checkout nor the checkin of a cached statement allocates memory.
+ * When the capacity is exceeded, the least recently returned statement is finalized.
+ *
+ * A cache must only be used with the one Database Connection owning it.
+ * Thread-safety: same as the Database Connection owning it.
+ */
+class StatementCache
+{
+private:
+    /// Prepared statement, with the SQL text it was compiled from
+    struct Entry
+    {
+        std::string     mQuery;     //!< UTF-8 SQL Query
+        sqlite3_stmt*   mpStmt;     //!< Pointer to SQLite Statement Object
+        bool            mbIdle;     //!< true if kept in the cache, false if checked out
+    };
+    typedef std::list<Entry>                                        TEntries;
+    typedef std::unordered_multimap<std::string, TEntries::iterator> TIndex;
+
+public:
+    /// Handle of a checked out statement, to give back to checkin()
+    class Checkout
+    {
+    public:
+        Checkout() : mEntry() {}
+
+        /// Return the checked out statement
+        sqlite3_stmt* getStmt() const
+        {
+            return mEntry->mpStmt;
+        }
+
+    private:
+        friend class StatementCache;
+        explicit Checkout(const TEntries::iterator& aEntry) : mEntry(aEntry) {}
+
+        TEntries::iterator mEntry;  //!< Entry of the statement, kept aside by the cache while checked out
+    };
+
+    /**
+     * @brief Create an empty cache.
+     *
+     * @param[in] aCapacity Maximum number of idle statements kept; 0 disables the cache
+     */
+    explicit StatementCache(const std::size_t aCapacity = 0);
+
+    /// Finalize all idle statements.
+    ~StatementCache() noexcept; // nothrow
+
+    /**
+     * @brief Check out a statement compiled from the provided SQL text, preparing it on a miss.
+     *
+     * @param[in] apSQLite  The sqlite3 database connection owning the cache
+     * @param[in] aQuery    The SQL query string
+     *
+     * @return the handle of the checked out statement, which must be given back with checkin()
+     *
+     * @throw SQLite::Exception in case of error
+     */
+    Checkout checkout(sqlite3* apSQLite, const std::string& aQuery);
+
+    /**
+     * @brief Reset, clear the bindings, and keep the statement as the most recently used one.
+     *
+     *  The statement is finalized instead if the cache is disabled.
+     *
+     *  The statement is kept under the SQL text given to checkout(), and not under sqlite3_sql(),
+     *  which is only the first statement of the text (without any trailing whitespace, comment or statement).
+     *
+     * @param[in] aCheckout The handle returned by checkout()
+     */
+    void checkin(const Checkout& aCheckout) noexcept; // nothrow
+
+    /// Finalize all idle statements, for instance before closing the database connection.
+    void clear() noexcept; // nothrow
+
+    /// Set the maximum number of idle statements, finalizing the least recently used ones if needed; 0 disables the cache.
+    void setCapacity(const std::size_t aCapacity) noexcept; // nothrow
+
+    /// Maximum number of idle statements kept.
+    std::size_t getCapacity() const noexcept // nothrow
+    {
+        return mCapacity;
+    }
+
+    /// Number of idle statements currently kept.
+    std::size_t getSize() const noexcept // nothrow
+    {
+        return mStatements.size();
+    }
+
+    /// Number of checkouts served by an idle statement.
+    unsigned long long getHits() const noexcept // nothrow
+    {
+        return mHits;
+    }
+
+    /// Number of checkouts which had to prepare a statement.
+    unsigned long long getMisses() const noexcept // nothrow
+    {
+        return mMisses;
+    }
+
+    /// Reset the hit and miss counters.
+    void resetCounters() noexcept // nothrow
+    {
+        mHits = 0;
+        mMisses = 0;
+    }
+
+private:
+    /// @{ StatementCache must be non-copyable
+    StatementCache(const StatementCache&);
+    StatementCache& operator=(const StatementCache&);
+    /// @}
+
+    /// Finalize the least recently used statements above the provided count.
+    void evict(const std::size_t aCount) noexcept; // nothrow
+
+    /// Forget a statement, idle or checked out, and finalize it.
+    void erase(const TEntries::iterator& aEntry) noexcept; // nothrow
+
+private:
+    std::size_t         mCapacity;      //!< Maximum number of idle statements
+    TEntries            mStatements;    //!< Idle statements, most recently used first
+    TEntries            mCheckedOut;    //!< Checked out statements, set aside until they are given back
+    TIndex              mIndex;         //!< Idle and checked out statements by SQL text
+    unsigned long long  mHits;          //!< Number of checkouts served from the cache
+    unsigned long long  mMisses;        //!< Number of checkouts which had to prepare a statement
+};
+
+
+}  // namespace SQLite
@@ -0,0 +1,334 @@
+/**
+ * @file    VirtualTable.h
+ * @ingroup SQLiteCpp
+ * @brief   Read-only virtual table exposing a C++ container of structs to SQL queries, without copy.
+ *
+ * Copyright (c) 2012-2016 Sebastien Rombauts (sebastien.rombauts@gmail.com)
+ *
+ * Distributed under the MIT License (MIT) (See accompanying file LICENSE.txt
+ * or copy at http://opensource.org/licenses/MIT)
+ */
+#pragma once
+
+#include <SQLiteCpp/Database.h>
+#include <SQLiteCpp/Column.h>
+
+#include <string>
+#include <vector>
+#include <iterator>
+#include <functional>
+#include <type_traits>
+#include <utility>
+
+
+namespace SQLite
+{
+
+
+/**
+ * @brief Value of a cell of a VirtualTable, referring to the data of the container without copy.
+ *
+ *  A text or blob value points to the memory of the container, which SQLite reads without copying it:
+ * the container must not be modified while a statement reads the virtual table.
+ */
+class VirtualValue
+{
+public:
+    /// NULL value
+    VirtualValue() noexcept : // nothrow
+        mType(Null), mInteger(0), mFloat(0.0), mpData(NULL), mBytes(0)
+    {
+    }
+    /// @{ Integer value
+    VirtualValue(const int aValue) noexcept : // nothrow
+        mType(INTEGER), mInteger(aValue), mFloat(0.0), mpData(NULL), mBytes(0)
+    {
+    }
+    VirtualValue(const unsigned int aValue) noexcept : // nothrow
+        mType(INTEGER), mInteger(aValue), mFloat(0.0), mpData(NULL), mBytes(0)
+    {
+    }
+    VirtualValue(const long aValue) noexcept : // nothrow
+        mType(INTEGER), mInteger(aValue), mFloat(0.0), mpData(NULL), mBytes(0)
+    {
+    }
+    VirtualValue(const unsigned long aValue) noexcept : // nothrow
+        mType(INTEGER), mInteger(static_cast<long long>(aValue)), mFloat(0.0), mpData(NULL), mBytes(0)
+    {
+    }
+    VirtualValue(const long long aValue) noexcept : // nothrow
+        mType(INTEGER), mInteger(aValue), mFloat(0.0), mpData(NULL), mBytes(0)
+    {
+    }
+    VirtualValue(const unsigned long long aValue) noexcept : // nothrow
+        mType(INTEGER), mInteger(static_cast<long long>(aValue)), mFloat(0.0), mpData(NULL), mBytes(0)
+    {
+    }
+    /// @}
+    /// Floating point value
+    VirtualValue(const double aValue) noexcept : // nothrow
+        mType(FLOAT), mInteger(0), mFloat(aValue), mpData(NULL), mBytes(0)
+    {
+    }
+    /// UTF-8 text value, pointing to the content of the string
+    VirtualValue(const std::string& aValue) noexcept : // nothrow
+        mType(TEXT), mInteger(0), mFloat(0.0), mpData(aValue.data()), mBytes(static_cast<int>(aValue.size()))
+    {
+    }
+    /// UTF-8 text value, pointing to the string, or NULL value
+    VirtualValue(const char* apValue) noexcept; // nothrow
+
+    /// UTF-8 text value, pointing to the provided memory, not null-terminated
+    static VirtualValue text(const char* apText, const int aBytes) noexcept; // nothrow
+
+    /// Blob value, pointing to the provided memory
+    static VirtualValue blob(const void* apData, const int aBytes) noexcept; // nothrow
+
+    /// Return the type of the value: SQLite::INTEGER, FLOAT, TEXT, BLOB or Null
+    int getType() const noexcept // nothrow
+    {
+        return mType;
+    }
+    /// Return the integer value
+    long long getInt64() const noexcept // nothrow
+    {
+        return mInteger;
+    }
+    /// Return the floating point value
+    double getDouble() const noexcept // nothrow
+    {
+        return mFloat;
+    }
+    /// Return a pointer to the text or blob value, not null-terminated
+    const void* getData() const noexcept // nothrow
+    {
+        return mpData;
+    }
+    /// Return the size of the text or blob value, in bytes
+    int getBytes() const noexcept // nothrow
+    {
+        return mBytes;
+    }
+
+private:
+    int         mType;      ///< SQLite::INTEGER, FLOAT, TEXT, BLOB or Null
+    long long   mInteger;   ///< Integer value
+    double      mFloat;     ///< Floating point value
+    const void* mpData;     ///< Text or blob value, owned by the container
+    int         mBytes;     ///< Size of the text or blob value
+};
+
+
+/**
+ * @brief Column of a VirtualTable over a container of Row structs.
+ *
+ *  Declared with makeVirtualColumn() for a data member, or directly for a computed column:
+ * \code{.cpp}
+ * SQLite::VirtualColumn<Item> column = { "total", "REAL", false, [](const Item& aItem) { return SQLite::VirtualValue(aItem.price * aItem.quantity); } };
+ * \endcode
+ *
+ *  A text or blob value only points to its data: the getter must return a VirtualValue referring to memory owned
+ * by the row (a data member, or a reference returned by a member function), never to a temporary std::string.
+ */
+template<typename Row>
+struct VirtualColumn
+{
+    std::string                                 mName;      ///< Name of the column
+    std::string                                 mType;      ///< Declared type of the column: "INTEGER", "REAL", "TEXT" or "BLOB"
+    bool                                        mbKey;      ///< true if equality and range constraints on the column use an index
+    std::function<VirtualValue (const Row&)>    mGetter;    ///< Return the value of the column, referring to the row
+};
+
+/// @cond
+namespace detail
+{
+/// Declared type of a column of numeric type
+template<typename T>
+inline const char* getDeclaredType(const T*)
+{
+    return std::is_floating_point<T>::value ? "REAL" : "INTEGER";
+}
+/// Declared type of a column of string type
+inline const char* getDeclaredType(const std::string*)
+{
+    return "TEXT";
+}
+/// Declared type of a column of C string type
+inline const char* getDeclaredType(const char* const*)
+{
+    return "TEXT";
+}
+} // namespace detail
+/// @endcond
+
+/**
+ * @brief Declare a column of a VirtualTable reading a data member of the Row struct.
+ *
+ * @param[in] aName     Name of the column
+ * @param[in] apMember  Data member of integer, floating point, std::string or const char* type
+ * @param[in] abKey     true to index the column for the equality and range constraints of queries
+ */
+template<typename Row, typename T>
+VirtualColumn<Row> makeVirtualColumn(const std::string& aName, T Row::* apMember, const bool abKey = false)
+{
+    VirtualColumn<Row> column;
+    column.mName = aName;
+    column.mType = detail::getDeclaredType(static_cast<const T*>(NULL));
+    column.mbKey = abKey;
+    column.mGetter = [apMember](const Row& aRow) { return VirtualValue(aRow.*apMember); };
+    return column;
+}
+
+
+// Implementation of the sqlite3_module, defined in VirtualTable.cpp
+class VirtualTableModule;
+
+/**
+ * @brief Base of VirtualTable: registration of the virtual table, and indexes of its key columns.
+ *
+ *  The rows are accessed by their position in the container, from 0 to getRowCount() - 1.
+ */
+class VirtualTableBase
+{
+    friend class VirtualTableModule; // Give the sqlite3_module access to the rows and the indexes
+
+public:
+    /// Drop the virtual table.
+    virtual ~VirtualTableBase() noexcept; // nothrow
+
+    /**
+     * @brief Discard the indexes of the key columns, after the content of the container has changed.
+     *
+     *  Each index is rebuilt by the next query using it.
+     */
+    void invalidate() noexcept; // nothrow
+
+    /// Return the name of the virtual table.
+    const std::string& getName() const noexcept // nothrow
+    {
+        return mName;
+    }
+
+protected:
+    /// Declaration of a column, without its getter
+    struct ColumnInfo
+    {
+        std::string mName;  ///< Name of the column
+        std::string mType;  ///< Declared type of the column
+        bool        mbKey;  ///< true if the column is indexed
+    };
+
+    /// Initialize an unregistered virtual table
+    VirtualTableBase(Database& aDatabase, const std::string& aName);
+
+    /**
+     * @brief Register the virtual table with the module of the connection, and create it in the "temp" schema.
+     *
+     * @throw SQLite::Exception in case of error
+     */
+    void create(const std::vector<ColumnInfo>& aColumns);
+
+    /// Return the number of rows of the container
+    virtual std::size_t getRowCount() const = 0;
+
+    /// Return the value of a column of a row of the container
+    virtual VirtualValue getValue(const std::size_t aRow, const int aColumn) const = 0;
+
+private:
+    /// @{ VirtualTableBase must be non-copyable
+    VirtualTableBase(const VirtualTableBase&);
+    VirtualTableBase& operator=(const VirtualTableBase&);
+    /// @}
+
+    /// Return the positions of the rows sorted by the value of a key column, building the index if needed
+    const std::vector<std::size_t>& getIndex(const int aColumn);
+
+private:
+    Database&                               mDatabase;  ///< Connection owning the virtual table
+    std::string                             mName;      ///< Name of the virtual table
+    std::vector<ColumnInfo>                 mColumns;   ///< Declaration of the columns
+    std::vector<std::vector<std::size_t> >  mIndexes;   ///< Positions of the rows sorted by each key column (empty until used)
+    bool                                    mbCreated;  ///< true once the virtual table has been created
+};
+
+
+/**
+ * @brief Read-only virtual table exposing a C++ container of structs to SQL queries, without copy.
+ *
+ *  Queries can join the data of the container with on-disk tables without materializing it in a temporary table.
+ * Each column reads a member of the struct, or computes a value from it (see VirtualColumn); text and blob values
+ * point to the memory of the container, and SQLite reads them without copy.
+ *
+ *  Equality and range constraints (=, <, <=, >, >=) on key columns are pushed down to the virtual table:
+ * a query with such a constraint only reads the matching rows, found by a binary search in an index of the key column,
+ * which is built by the first query using it. Other constraints are evaluated by SQLite on each row.
+ * \code{.cpp}
+ * struct Item { long long id; std::string name; double price; };
+ * std::vector<Item> items = ...;
+ * SQLite::VirtualTable<std::vector<Item> > table(db, "items", items, {
+ *     SQLite::makeVirtualColumn("id", &Item::id, true),
+ *     SQLite::makeVirtualColumn("name", &Item::name),
+ *     SQLite::makeVirtualColumn("price", &Item::price) });
+ * SQLite::Statement query(db, "SELECT orders.id, items.name FROM orders JOIN items ON items.id = orders.item_id");
+ * \endcode
+ *
+ *  The container must provide random access iterators (std::vector, std::deque, std::array or a C array),
+ * and outlive the VirtualTable. Call invalidate() after modifying it; it must not be modified while a statement reads it.
+ * The virtual table is created in the "temp" schema, and dropped by the destructor, which must run after
+ * the statements using it are finalized.
+ *
+ * Thread-safety: same as the Database Connection.
+ */
+template<typename Range>
+class VirtualTable : public VirtualTableBase
+{
+public:
+    /// Type of the rows of the container
+    typedef typename std::decay<decltype(*std::begin(std::declval<const Range&>()))>::type Row;
+    /// Type of the columns of the virtual table
+    typedef VirtualColumn<Row> TColumn;
+
+    /**
+     * @brief Create a virtual table over a container.
+     *
+     * @param[in] aDatabase The SQLite Database Connection
+     * @param[in] aName     Name of the virtual table, created in the "temp" schema
+     * @param[in] aRange    Container of Row structs, with random access iterators, which must outlive the VirtualTable
+     * @param[in] aColumns  Columns of the virtual table
+     *
+     * @throw SQLite::Exception in case of error
+     */
+    VirtualTable(Database& aDatabase, const std::string& aName, const Range& aRange, const std::vector<TColumn>& aColumns) :
+        VirtualTableBase(aDatabase, aName),
+        mRange(aRange),
+        mColumns(aColumns)
+    {
+        std::vector<ColumnInfo> columns;
+        for (typename std::vector<TColumn>::const_iterator it = mColumns.begin(); it != mColumns.end(); ++it)
+        {
+            const ColumnInfo column = { it->mName, it->mType, it->mbKey };
+            columns.push_back(column);
+        }
+        create(columns);
+    }
+
+protected:
+    /// Return the number of rows of the container
+    virtual std::size_t getRowCount() const
+    {
+        return static_cast<std::size_t>(std::distance(std::begin(mRange), std::end(mRange)));
+    }
+
+    /// Return the value of a column of a row of the container
+    virtual VirtualValue getValue(const std::size_t aRow, const int aColumn) const
+    {
+        return mColumns[aColumn].mGetter(std::begin(mRange)[aRow]);
+    }
+
+private:
+    const Range&            mRange;     ///< Container of the rows
+    std::vector<TColumn>    mColumns;   ///< Columns of the virtual table
+};
+
+
+}  // namespace SQLite
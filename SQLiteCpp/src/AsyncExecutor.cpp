@@ -0,0 +1,289 @@
+/**
+ * @file    AsyncExecutor.cpp
+ * @ingroup SQLiteCpp
+ * @brief   Asynchronous execution of queries on dedicated reader threads and a single group-committing writer thread.
+ *
+ * Copyright (c) 2012-2016 Sebastien Rombauts (sebastien.rombauts@gmail.com)
+ *
+ * Distributed under the MIT License (MIT) (See accompanying file LICENSE.txt
+ * or copy at http://opensource.org/licenses/MIT)
+ */
+#include <SQLiteCpp/AsyncExecutor.h>
+
+#include <SQLiteCpp/Exception.h>
+
+#include <sqlite3.h>
+
+
+namespace SQLite
+{
+
+
+// Open the database and start the reader and writer threads
+AsyncExecutor::AsyncExecutor(const std::string&            aFilename,
+                             const std::size_t             aReaderCount /* = 2 */,
+                             const ConnectionPool::TSetup& aSetup /* = ConnectionPool::TSetup() */,
+                             const std::size_t             aMaxWritesPerCommit /* = 1000 */) :
+    mPool(aFilename, aReaderCount, aSetup),
+    mMaxWritesPerCommit(aMaxWritesPerCommit > 0 ? aMaxWritesPerCommit : 1),
+    mbStopping(false),
+    mWriteCount(0),
+    mCommitCount(0)
+{
+    // Each thread keeps its connection checked out for its whole life
+    mThreads.reserve(aReaderCount + 1);
+    try
+    {
+        for (std::size_t i = 0; i < aReaderCount; ++i)
+        {
+            ConnectionPool::Connection reader = mPool.acquireReader();
+            mThreads.push_back(std::thread(&AsyncExecutor::readLoop, this, std::move(reader)));
+        }
+        ConnectionPool::Connection writer = mPool.acquireWriter();
+        mThreads.push_back(std::thread(&AsyncExecutor::writeLoop, this, std::move(writer)));
+    }
+    catch (...)
+    {
+        {
+            std::lock_guard<std::mutex> lock(mMutex);
+            mbStopping = true;
+        }
+        mReadQueued.notify_all();
+        mWriteQueued.notify_all();
+        for (std::size_t i = 0; i < mThreads.size(); ++i)
+        {
+            mThreads[i].join();
+        }
+        throw;
+    }
+}
+
+// Execute all the queued queries, then stop the threads and close the database
+AsyncExecutor::~AsyncExecutor() noexcept // nothrow
+{
+    {
+        std::lock_guard<std::mutex> lock(mMutex);
+        mbStopping = true;
+    }
+    mReadQueued.notify_all();
+    mWriteQueued.notify_all();
+    for (std::size_t i = 0; i < mThreads.size(); ++i)
+    {
+        mThreads[i].join();
+    }
+}
+
+// Return the number of writes committed so far
+unsigned long long AsyncExecutor::getWriteCount() const
+{
+    std::lock_guard<std::mutex> lock(mMutex);
+    return mWriteCount;
+}
+
+// Return the number of transactions committed so far
+unsigned long long AsyncExecutor::getCommitCount() const
+{
+    std::lock_guard<std::mutex> lock(mMutex);
+    return mCommitCount;
+}
+
+// Queue a task for the readers or the writer
+void AsyncExecutor::enqueue(const bool abWrite, std::unique_ptr<Task>&& aTask)
+{
+    {
+        std::lock_guard<std::mutex> lock(mMutex);
+        if (mbStopping)
+        {
+            throw SQLite::Exception("AsyncExecutor is stopping.");
+        }
+        if (abWrite)
+        {
+            mWrites.push_back(std::move(aTask));
+        }
+        else
+        {
+            mReads.push_back(std::move(aTask));
+        }
+    }
+    if (abWrite)
+    {
+        mWriteQueued.notify_one();
+    }
+    else
+    {
+        mReadQueued.notify_one();
+    }
+}
+
+// Loop of the reader threads: execute the queued reads one at a time, until stopped with an empty queue
+void AsyncExecutor::readLoop(ConnectionPool::Connection aReader) noexcept // nothrow
+{
+    for (;;)
+    {
+        std::unique_ptr<Task> task;
+        {
+            std::unique_lock<std::mutex> lock(mMutex);
+            mReadQueued.wait(lock, [this] { return mbStopping || (false == mReads.empty()); });
+            if (mReads.empty())
+            {
+                return; // stopping
+            }
+            task = std::move(mReads.front());
+            mReads.pop_front();
+        }
+
+        try
+        {
+            task->run(*aReader);
+        }
+        catch (...)
+        {
+            task->fail(std::current_exception());
+            continue;
+        }
+        task->complete();
+    }
+}
+
+// Loop of the writer thread: group-commit all the queued writes, until stopped with an empty queue
+void AsyncExecutor::writeLoop(ConnectionPool::Connection aWriter) noexcept // nothrow
+{
+    TTasks writes;
+    for (;;)
+    {
+        {
+            std::unique_lock<std::mutex> lock(mMutex);
+            mWriteQueued.wait(lock, [this] { return mbStopping || (false == mWrites.empty()); });
+            if (mWrites.empty())
+            {
+                return; // stopping
+            }
+            // Take all the writes queued while the previous group was committing
+            while ((false == mWrites.empty()) && (writes.size() < mMaxWritesPerCommit))
+            {
+                writes.push_back(std::move(mWrites.front()));
+                mWrites.pop_front();
+            }
+        }
+
+        commitGroup(*aWriter, writes);
+        writes.clear();
+    }
+}
+
+// Execute a group of writes in one transaction, each in its own savepoint
+void AsyncExecutor::commitGroup(Database& aDatabase, TTasks& aWrites) noexcept // nothrow
+{
+    // One transaction per pass, until a write makes SQLite roll back the whole transaction
+    while (false == aWrites.empty())
+    {
+        try
+        {
+            aDatabase.exec("BEGIN IMMEDIATE");
+        }
+        catch (...)
+        {
+            const std::exception_ptr exception = std::current_exception();
+            for (TTasks::iterator iTask = aWrites.begin(); iTask != aWrites.end(); ++iTask)
+            {
+                (*iTask)->fail(exception);
+            }
+            aWrites.clear();
+            return;
+        }
+
+        // The writes which have run successfully are kept, until the commit
+        TTasks done;
+        bool bRolledBack = false;
+        while ((false == aWrites.empty()) && (false == bRolledBack))
+        {
+            std::unique_ptr<Task> task = std::move(aWrites.front());
+            aWrites.pop_front();
+            std::exception_ptr exception;
+            try
+            {
+                aDatabase.exec("SAVEPOINT write");
+                task->run(aDatabase);
+                aDatabase.exec("RELEASE write");
+                done.push_back(std::move(task));
+                continue;
+            }
+            catch (...)
+            {
+                exception = std::current_exception();
+            }
+
+            // SQLITE_FULL, SQLITE_IOERR, SQLITE_NOMEM, SQLITE_BUSY or RAISE(ROLLBACK) can roll back the whole transaction,
+            // and the savepoints with it: the next writes must not run in autocommit mode
+            bRolledBack = (0 != sqlite3_get_autocommit(aDatabase.getHandle()));
+            if (false == bRolledBack)
+            {
+                try
+                {
+                    // Undo this write only
+                    aDatabase.exec("ROLLBACK TO write");
+                    aDatabase.exec("RELEASE write");
+                }
+                catch (SQLite::Exception&)
+                {
+                    rollback(aDatabase);
+                    bRolledBack = true;
+                }
+            }
+            task->fail(exception);
+            if (bRolledBack)
+            {
+                // The previous writes of the transaction are undone too: they fail, and the next writes run in a new transaction
+                for (TTasks::iterator iTask = done.begin(); iTask != done.end(); ++iTask)
+                {
+                    (*iTask)->fail(exception);
+                }
+            }
+        }
+        if (bRolledBack)
+        {
+            continue;
+        }
+
+        try
+        {
+            aDatabase.exec("COMMIT");
+        }
+        catch (...)
+        {
+            const std::exception_ptr exception = std::current_exception();
+            rollback(aDatabase);
+            for (TTasks::iterator iTask = done.begin(); iTask != done.end(); ++iTask)
+            {
+                (*iTask)->fail(exception);
+            }
+            continue;
+        }
+
+        {
+            std::lock_guard<std::mutex> lock(mMutex);
+            mWriteCount += done.size();
+            ++mCommitCount;
+        }
+        for (TTasks::iterator iTask = done.begin(); iTask != done.end(); ++iTask)
+        {
+            (*iTask)->complete();
+        }
+    }
+}
+
+// Rollback the transaction, if SQLite has not already done it
+void AsyncExecutor::rollback(Database& aDatabase) noexcept // nothrow
+{
+    try
+    {
+        aDatabase.exec("ROLLBACK");
+    }
+    catch (SQLite::Exception&)
+    {
+        // Never mind: no transaction is active anymore if SQLite has already rolled it back
+    }
+}
+
+
+}  // namespace SQLite
@@ -0,0 +1,295 @@
+/**
+ * @file    BackupDriver.cpp
+ * @ingroup SQLiteCpp
+ * @brief   Incremental online backup, throttled to a target I/O rate, optionally on a background thread.
+ *
+ * Copyright (c) 2012-2016 Sebastien Rombauts (sebastien.rombauts@gmail.com)
+ *
+ * Distributed under the MIT License (MIT) (See accompanying file LICENSE.txt
+ * or copy at http://opensource.org/licenses/MIT)
+ */
+#include <SQLiteCpp/BackupDriver.h>
+
+#include <SQLiteCpp/Backup.h>
+#include <SQLiteCpp/Exception.h>
+
+#include <sqlite3.h>
+
+
+namespace SQLite
+{
+
+
+// Open the source and destination databases
+BackupDriver::BackupDriver(const std::string& aDestFilename,
+                           const std::string& aSrcFilename) :
+    mpOwnedDest(new Database(aDestFilename, OPEN_READWRITE|OPEN_CREATE)),
+    mpOwnedSrc(new Database(aSrcFilename, OPEN_READONLY)),
+    mDest(*mpOwnedDest),
+    mSrc(*mpOwnedSrc),
+    mPagesPerStep(100),
+    mMaxBytesPerSecond(0),
+    mMaxRestarts(3),
+    mBusyRetryMs(100),
+    mbRunning(false),
+    mbCancelled(false),
+    mbCompleted(false),
+    mProgress()
+{
+}
+
+// Use the given source and destination connections
+BackupDriver::BackupDriver(Database& aDestDatabase,
+                           Database& aSrcDatabase) :
+    mDest(aDestDatabase),
+    mSrc(aSrcDatabase),
+    mPagesPerStep(100),
+    mMaxBytesPerSecond(0),
+    mMaxRestarts(3),
+    mBusyRetryMs(100),
+    mbRunning(false),
+    mbCancelled(false),
+    mbCompleted(false),
+    mProgress()
+{
+}
+
+// Cancel the backup thread and wait for it
+BackupDriver::~BackupDriver() noexcept // nothrow
+{
+    cancel();
+    if (mThread.joinable())
+    {
+        mThread.join();
+    }
+}
+
+// Set the number of source pages copied by each step
+void BackupDriver::setPagesPerStep(const int aPagesPerStep)
+{
+    mPagesPerStep = (aPagesPerStep > 0) ? aPagesPerStep : 1;
+}
+
+// Set the target I/O rate in bytes per second
+void BackupDriver::setMaxBytesPerSecond(const long long aMaxBytesPerSecond)
+{
+    mMaxBytesPerSecond = (aMaxBytesPerSecond > 0) ? aMaxBytesPerSecond : 0;
+}
+
+// Set the number of restarts after which all the remaining pages are copied in one step
+void BackupDriver::setMaxRestarts(const int aMaxRestarts)
+{
+    mMaxRestarts = aMaxRestarts;
+}
+
+// Set the time to wait before retrying a busy step
+void BackupDriver::setBusyRetryMs(const int aBusyRetryMs)
+{
+    mBusyRetryMs = (aBusyRetryMs > 0) ? aBusyRetryMs : 0;
+}
+
+// Set the function called after each step
+void BackupDriver::setProgressHandler(const TProgressHandler& aProgressHandler)
+{
+    mProgressHandler = aProgressHandler;
+}
+
+// Execute the whole backup on the calling thread
+bool BackupDriver::run()
+{
+    {
+        std::lock_guard<std::mutex> lock(mMutex);
+        if (mbRunning)
+        {
+            throw SQLite::Exception("Backup is already running.");
+        }
+        mbRunning = true;
+        mbCancelled = false;
+    }
+
+    bool bCompleted = false;
+    try
+    {
+        bCompleted = execute();
+    }
+    catch (...)
+    {
+        std::lock_guard<std::mutex> lock(mMutex);
+        mbRunning = false;
+        throw;
+    }
+
+    std::lock_guard<std::mutex> lock(mMutex);
+    mbRunning = false;
+    return bCompleted;
+}
+
+// Start the backup on a background thread
+void BackupDriver::start()
+{
+    std::lock_guard<std::mutex> lock(mMutex);
+    if (mbRunning)
+    {
+        throw SQLite::Exception("Backup is already running.");
+    }
+    if (mThread.joinable())
+    {
+        mThread.join(); // the previous thread has finished, but has not been waited for
+    }
+    mbRunning = true;
+    mbCancelled = false;
+    mbCompleted = false;
+    mException = std::exception_ptr();
+
+    mThread = std::thread([this]
+    {
+        bool bCompleted = false;
+        std::exception_ptr exception;
+        try
+        {
+            bCompleted = execute();
+        }
+        catch (...)
+        {
+            exception = std::current_exception();
+        }
+        std::lock_guard<std::mutex> threadLock(mMutex);
+        mbCompleted = bCompleted;
+        mException = exception;
+        mbRunning = false;
+    });
+}
+
+// Wait for the backup thread to finish
+bool BackupDriver::wait()
+{
+    if (mThread.joinable())
+    {
+        mThread.join();
+    }
+
+    std::lock_guard<std::mutex> lock(mMutex);
+    if (mException)
+    {
+        std::exception_ptr exception;
+        std::swap(exception, mException);
+        std::rethrow_exception(exception);
+    }
+    return mbCompleted;
+}
+
+// Ask the running backup to stop
+void BackupDriver::cancel()
+{
+    {
+        std::lock_guard<std::mutex> lock(mMutex);
+        if (false == mbRunning)
+        {
+            return;
+        }
+        mbCancelled = true;
+    }
+    mCancelled.notify_all();
+}
+
+// Return true while the backup runs
+bool BackupDriver::isRunning() const
+{
+    std::lock_guard<std::mutex> lock(mMutex);
+    return mbRunning;
+}
+
+// Return the progress of the backup
+BackupDriver::Progress BackupDriver::getProgress() const
+{
+    std::lock_guard<std::mutex> lock(mMutex);
+    return mProgress;
+}
+
+// Copy the database step by step, pacing the steps to the target I/O rate
+bool BackupDriver::execute()
+{
+    const long long pageSize = mSrc.execAndGet("PRAGMA page_size").getInt64();
+    Backup backup(mDest, mSrc);
+
+    Progress progress = Progress();
+    int copiedPages = 0; // pages copied since the last restart
+    const std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+    {
+        std::lock_guard<std::mutex> lock(mMutex);
+        mProgress = progress;
+    }
+
+    for (;;)
+    {
+        // Once the backup has restarted too often, copy all the rest at once, read-locking the source until done
+        const bool bLastStep = (mMaxRestarts >= 0) && (progress.mRestartCount >= static_cast<unsigned>(mMaxRestarts));
+        const int res = backup.executeStep(bLastStep ? -1 : mPagesPerStep);
+        if ((SQLITE_BUSY == res) || (SQLITE_LOCKED == res))
+        {
+            if (false == pauseUntil(std::chrono::steady_clock::now() + std::chrono::milliseconds(mBusyRetryMs)))
+            {
+                return false;
+            }
+            continue;
+        }
+
+        // A modification of the source by another connection makes the step start over from the first page
+        progress.mTotalPages = backup.getTotalPageCount();
+        progress.mRemainingPages = backup.getRemainingPageCount();
+        const int donePages = progress.mTotalPages - progress.mRemainingPages;
+        if ((copiedPages > 0) && (donePages <= copiedPages))
+        {
+            ++progress.mRestartCount;
+            progress.mCopiedBytes += donePages * pageSize;
+        }
+        else
+        {
+            progress.mCopiedBytes += (donePages - copiedPages) * pageSize;
+        }
+        copiedPages = donePages;
+
+        {
+            std::lock_guard<std::mutex> lock(mMutex);
+            mProgress = progress;
+        }
+        if (mProgressHandler)
+        {
+            mProgressHandler(progress);
+        }
+
+        if (SQLITE_DONE == res)
+        {
+            return true;
+        }
+
+        // Pause until the average rate falls back to the target, or just let the other threads run
+        if (mMaxBytesPerSecond > 0)
+        {
+            const std::chrono::duration<double> expected(static_cast<double>(progress.mCopiedBytes) / mMaxBytesPerSecond);
+            if (false == pauseUntil(start + std::chrono::duration_cast<std::chrono::steady_clock::duration>(expected)))
+            {
+                return false;
+            }
+        }
+        else
+        {
+            std::this_thread::yield();
+            std::lock_guard<std::mutex> lock(mMutex);
+            if (mbCancelled)
+            {
+                return false;
+            }
+        }
+    }
+}
+
+// Pause until the given time, unless cancelled
+bool BackupDriver::pauseUntil(const std::chrono::steady_clock::time_point& aTime)
+{
+    std::unique_lock<std::mutex> lock(mMutex);
+    return (false == mCancelled.wait_until(lock, aTime, [this] { return mbCancelled; }));
+}
+
+
+}  // namespace SQLite
@@ -0,0 +1,249 @@
+/**
+ * @file    Blob.cpp
+ * @ingroup SQLiteCpp
+ * @brief   Incremental I/O on a BLOB value, streamed by chunks instead of held in memory.
+ *
+ * Copyright (c) 2012-2016 Sebastien Rombauts (sebastien.rombauts@gmail.com)
+ *
+ * Distributed under the MIT License (MIT) (See accompanying file LICENSE.txt
+ * or copy at http://opensource.org/licenses/MIT)
+ */
+#include <SQLiteCpp/Blob.h>
+
+#include <SQLiteCpp/Assertion.h>
+#include <SQLiteCpp/Exception.h>
+
+#include <sqlite3.h>
+
+#include <algorithm>
+#include <cstring>
+
+
+namespace SQLite
+{
+
+
+// Open the BLOB value of a column of a row
+Blob::Blob(Database&          aDatabase,
+           const std::string& aTable,
+           const std::string& aColumn,
+           const long long    aRowid,
+           const bool         abReadWrite /* = false */,
+           const std::string& aDatabaseName /* = "main" */) :
+    mpSQLite(aDatabase.getHandle()),
+    mpBlob(NULL),
+    mRowid(aRowid),
+    mbReadWrite(abReadWrite)
+{
+    const int ret = sqlite3_blob_open(mpSQLite, aDatabaseName.c_str(), aTable.c_str(), aColumn.c_str(),
+                                      aRowid, abReadWrite ? 1 : 0, &mpBlob);
+    if (SQLITE_OK != ret)
+    {
+        // A handle may be returned even on error, and must be closed
+        sqlite3_blob_close(mpBlob);
+        throw SQLite::Exception(mpSQLite, ret);
+    }
+}
+
+// Close the BLOB handle
+Blob::~Blob() noexcept // nothrow
+{
+    const int ret = sqlite3_blob_close(mpBlob);
+
+    // An expired handle reports SQLITE_ABORT, but is closed anyway
+    // Never throw an exception in a destructor :
+    const bool bClosed = (SQLITE_OK == ret) || (SQLITE_ABORT == ret);
+    SQLITECPP_ASSERT(bClosed, sqlite3_errstr(ret));  // See SQLITECPP_ENABLE_ASSERT_HANDLER
+}
+
+// Read a chunk of the BLOB
+void Blob::read(void* apBuffer, const int aSize, const int aOffset)
+{
+    const int ret = sqlite3_blob_read(mpBlob, apBuffer, aSize, aOffset);
+    if (SQLITE_OK != ret)
+    {
+        throw SQLite::Exception(mpSQLite, ret);
+    }
+}
+
+// Write a chunk of the BLOB
+void Blob::write(const void* apBuffer, const int aSize, const int aOffset)
+{
+    const int ret = sqlite3_blob_write(mpBlob, apBuffer, aSize, aOffset);
+    if (SQLITE_OK != ret)
+    {
+        throw SQLite::Exception(mpSQLite, ret);
+    }
+}
+
+// Move the handle to the same column of another row
+void Blob::reopen(const long long aRowid)
+{
+    const int ret = sqlite3_blob_reopen(mpBlob, aRowid);
+    if (SQLITE_OK != ret)
+    {
+        throw SQLite::Exception(mpSQLite, ret);
+    }
+    mRowid = aRowid;
+}
+
+// Return the size of the BLOB in bytes
+int Blob::getBytes() const noexcept // nothrow
+{
+    return sqlite3_blob_bytes(mpBlob);
+}
+
+
+// Set up a buffer over an opened Blob
+BlobStreamBuf::BlobStreamBuf(Blob& aBlob, const std::size_t aBufferSize /* = 16 * 1024 */) :
+    mBlob(aBlob),
+    mBuffer(aBufferSize > 0 ? aBufferSize : 1),
+    mOffset(0)
+{
+}
+
+// Write the pending output to the Blob
+BlobStreamBuf::~BlobStreamBuf() noexcept // nothrow
+{
+    try
+    {
+        flush();
+    }
+    catch (SQLite::Exception&)
+    {
+        // Never throw an exception in a destructor
+    }
+}
+
+// Read the next chunk of the BLOB into the get area
+BlobStreamBuf::int_type BlobStreamBuf::underflow()
+{
+    flush();
+    const int remaining = mBlob.getBytes() - mOffset;
+    if (remaining <= 0)
+    {
+        return traits_type::eof();
+    }
+    const int size = std::min(remaining, static_cast<int>(mBuffer.size()));
+    mBlob.read(&mBuffer[0], size, mOffset);
+    setg(&mBuffer[0], &mBuffer[0], &mBuffer[0] + size);
+    return traits_type::to_int_type(mBuffer[0]);
+}
+
+// Write the put area to the BLOB, and start a new one at the current position
+BlobStreamBuf::int_type BlobStreamBuf::overflow(int_type aChar)
+{
+    flush();
+    const int remaining = mBlob.getBytes() - mOffset;
+    if ((false == mBlob.isReadWrite()) || (remaining <= 0))
+    {
+        return traits_type::eof(); // a BLOB cannot grow
+    }
+    const int size = std::min(remaining, static_cast<int>(mBuffer.size()));
+    setp(&mBuffer[0], &mBuffer[0] + size);
+    if (false == traits_type::eq_int_type(aChar, traits_type::eof()))
+    {
+        *pptr() = traits_type::to_char_type(aChar);
+        pbump(1);
+    }
+    return traits_type::not_eof(aChar);
+}
+
+// Write the pending output to the BLOB
+int BlobStreamBuf::sync()
+{
+    flush();
+    return 0;
+}
+
+// Return the number of bytes left to read
+std::streamsize BlobStreamBuf::showmanyc()
+{
+    const int remaining = mBlob.getBytes() - getPosition();
+    return (remaining > 0) ? remaining : -1;
+}
+
+// Read a large chunk directly into the destination buffer, skipping the get area
+std::streamsize BlobStreamBuf::xsgetn(char_type* apBuffer, std::streamsize aCount)
+{
+    std::streamsize count = 0;
+    if (gptr() < egptr())
+    {
+        count = std::min(aCount, static_cast<std::streamsize>(egptr() - gptr()));
+        std::memcpy(apBuffer, gptr(), static_cast<std::size_t>(count));
+        gbump(static_cast<int>(count));
+    }
+    if (aCount - count < static_cast<std::streamsize>(mBuffer.size()))
+    {
+        // Small reads go through the get area
+        return count + std::streambuf::xsgetn(apBuffer + count, aCount - count);
+    }
+
+    flush();
+    const int remaining = mBlob.getBytes() - mOffset;
+    const int size = static_cast<int>(std::min(aCount - count, static_cast<std::streamsize>(std::max(remaining, 0))));
+    if (size > 0)
+    {
+        mBlob.read(apBuffer + count, size, mOffset);
+        mOffset += size;
+    }
+    return count + size;
+}
+
+// Seek relatively to the beginning, the current position, or the end of the BLOB
+BlobStreamBuf::pos_type BlobStreamBuf::seekoff(off_type aOffset, std::ios_base::seekdir aDirection, std::ios_base::openmode aMode)
+{
+    off_type base = 0;
+    if (std::ios_base::cur == aDirection)
+    {
+        base = getPosition();
+    }
+    else if (std::ios_base::end == aDirection)
+    {
+        base = mBlob.getBytes();
+    }
+    return seekpos(pos_type(base + aOffset), aMode);
+}
+
+// Seek to a position in the BLOB, the same for input and output
+BlobStreamBuf::pos_type BlobStreamBuf::seekpos(pos_type aPosition, std::ios_base::openmode /* aMode */)
+{
+    const off_type position = aPosition;
+    if ((position < 0) || (position > mBlob.getBytes()))
+    {
+        return pos_type(off_type(-1));
+    }
+    flush();
+    mOffset = static_cast<int>(position);
+    return aPosition;
+}
+
+// Return the current position in the BLOB
+int BlobStreamBuf::getPosition() const
+{
+    if (NULL != pbase())
+    {
+        return mOffset + static_cast<int>(pptr() - pbase());
+    }
+    if (NULL != eback())
+    {
+        return mOffset + static_cast<int>(gptr() - eback());
+    }
+    return mOffset;
+}
+
+// Write the pending output, and empty the get and put areas
+void BlobStreamBuf::flush()
+{
+    const int position = getPosition();
+    if ((NULL != pbase()) && (pptr() > pbase()))
+    {
+        mBlob.write(pbase(), static_cast<int>(pptr() - pbase()), mOffset);
+    }
+    setg(NULL, NULL, NULL);
+    setp(NULL, NULL);
+    mOffset = position;
+}
+
+
+}  // namespace SQLite
@@ -0,0 +1,358 @@
+/**
+ * @file    BulkInserter.cpp
+ * @ingroup SQLiteCpp
+ * @brief   Fast loading of many rows into a table, with multi-row INSERT statements and chunked transactions.
+ *
+ * Copyright (c) 2012-2016 Sebastien Rombauts (sebastien.rombauts@gmail.com)
+ *
+ * Distributed under the MIT License (MIT) (See accompanying file LICENSE.txt
+ * or copy at http://opensource.org/licenses/MIT)
+ */
+#include <SQLiteCpp/BulkInserter.h>
+
+#include <SQLiteCpp/Database.h>
+#include <SQLiteCpp/Statement.h>
+#include <SQLiteCpp/Column.h>
+
+#include <sqlite3.h>
+
+#include <sstream>
+
+
+namespace SQLite
+{
+
+
+// Prepare the insertion of rows into the provided columns of a table
+BulkInserter::BulkInserter(Database&                       aDatabase,
+                           const std::string&              aTable,
+                           const std::vector<std::string>& aColumns,
+                           const std::size_t               aRowsPerCommit /* = 100000 */,
+                           const bool                      abFastLoad /* = false */) :
+    mDatabase(aDatabase),
+    mTable(aTable),
+    mColumns(aColumns),
+    mRowsPerCommit(aRowsPerCommit > 0 ? aRowsPerCommit : 1),
+    mRowsPerStatement(1),
+    mPendingRows(0),
+    mValueCount(0),
+    mUncommittedRows(0),
+    mRowCount(0),
+    mCommittedRowCount(0),
+    mbInTransaction(false),
+    mbFastLoad(false),
+    mSynchronous(0)
+{
+    if (mColumns.empty())
+    {
+        throw SQLite::Exception("BulkInserter needs at least one column.");
+    }
+
+    // As many rows per statement as the limit on the number of host parameters allows
+    const int maxVariables = sqlite3_limit(mDatabase.getHandle(), SQLITE_LIMIT_VARIABLE_NUMBER, -1);
+    if (maxVariables > 0 && static_cast<std::size_t>(maxVariables) > mColumns.size())
+    {
+        mRowsPerStatement = static_cast<std::size_t>(maxVariables) / mColumns.size();
+    }
+    if (mRowsPerStatement > mRowsPerCommit)
+    {
+        mRowsPerStatement = mRowsPerCommit;
+    }
+    mStatement.reset(new Statement(mDatabase, buildQuery(mRowsPerStatement)));
+    mValues.resize(mRowsPerStatement * mColumns.size());
+
+    if (abFastLoad)
+    {
+        mSynchronous = mDatabase.execAndGet("PRAGMA synchronous").getInt();
+        const std::string journalMode = mDatabase.execAndGet("PRAGMA journal_mode").getString();
+        mDatabase.exec("PRAGMA synchronous=OFF");
+        mbFastLoad = true;
+        try
+        {
+            // WAL is already fast for bulk loads, and leaving it requires an exclusive access to the database;
+            // the journal mode of a database cannot change inside a transaction of the caller
+            if (("wal" != journalMode) && ("memory" != journalMode) && ("off" != journalMode)
+             && (0 != sqlite3_get_autocommit(mDatabase.getHandle())))
+            {
+                mDatabase.exec("PRAGMA journal_mode=MEMORY");
+                mJournalMode = journalMode;
+            }
+        }
+        catch (...)
+        {
+            // No destructor runs if the constructor throws
+            restoreSettings();
+            throw;
+        }
+    }
+}
+
+// Rollback the rows inserted since the last commit, and restore the settings changed by the fast load
+BulkInserter::~BulkInserter() noexcept // nothrow
+{
+    // Never throw an exception in a destructor: errors are of no consequence on the committed rows
+    try
+    {
+        // The statement must be finalized (or given back to the cache) before restoring the journal mode
+        mStatement.reset();
+        if (mbInTransaction)
+        {
+            // Leave the transaction of the caller, if any, as it was before the savepoint
+            mDatabase.exec("ROLLBACK TO bulk_inserter");
+            mDatabase.exec("RELEASE bulk_inserter");
+        }
+        restoreSettings();
+    }
+    catch (std::exception&)
+    {
+    }
+}
+
+// Restore the settings changed by the fast load
+void BulkInserter::restoreSettings()
+{
+    if (mbFastLoad)
+    {
+        mbFastLoad = false;
+        if (false == mJournalMode.empty())
+        {
+            mDatabase.exec("PRAGMA journal_mode=" + mJournalMode);
+        }
+        std::ostringstream synchronous;
+        synchronous << "PRAGMA synchronous=" << mSynchronous;
+        mDatabase.exec(synchronous.str());
+    }
+}
+
+// Insert the pending rows and release the current savepoint, committing it outside of a transaction
+void BulkInserter::flush()
+{
+    if (mValueCount > 0)
+    {
+        throw SQLite::Exception("BulkInserter row is incomplete.");
+    }
+    if (mPendingRows > 0)
+    {
+        // The last rows do not fill a statement: prepare one for them only
+        Statement tail(mDatabase, buildQuery(mPendingRows));
+        execute(tail);
+    }
+    if (mbInTransaction)
+    {
+        mDatabase.exec("RELEASE bulk_inserter");
+        mbInTransaction = false;
+        mUncommittedRows = 0;
+        mCommittedRowCount = mRowCount;
+        mLastCommit = std::chrono::steady_clock::now();
+    }
+}
+
+// Return the number of rows committed per second, from the first row to the last commit
+double BulkInserter::getRowsPerSecond() const noexcept // nothrow
+{
+    const double seconds = std::chrono::duration<double>(mLastCommit - mStart).count();
+    return (seconds > 0.0) ? (static_cast<double>(mCommittedRowCount) / seconds) : 0.0;
+}
+
+// Throw if the provided number of values does not match the number of columns
+void BulkInserter::checkValueCount(const std::size_t aCount) const
+{
+    if (aCount != mColumns.size())
+    {
+        throw SQLite::Exception("BulkInserter row does not have one value per column.");
+    }
+}
+
+// Return the next value of the current row
+BulkInserter::Value& BulkInserter::nextValue()
+{
+    if (0 == mValueCount && 0 == mPendingRows && false == mbInTransaction)
+    {
+        if (0 == mRowCount)
+        {
+            mStart = std::chrono::steady_clock::now();
+        }
+        // A savepoint starts a transaction, or nests inside the one of the caller
+        mDatabase.exec("SAVEPOINT bulk_inserter");
+        mbInTransaction = true;
+    }
+    return mValues[mPendingRows * mColumns.size() + mValueCount++];
+}
+
+void BulkInserter::add(const int aValue)
+{
+    Value& value = nextValue();
+    value.mType = SQLite::INTEGER;
+    value.mInteger = aValue;
+}
+
+void BulkInserter::add(const unsigned aValue)
+{
+    Value& value = nextValue();
+    value.mType = SQLite::INTEGER;
+    value.mInteger = aValue;
+}
+
+void BulkInserter::add(const long aValue)
+{
+    Value& value = nextValue();
+    value.mType = SQLite::INTEGER;
+    value.mInteger = aValue;
+}
+
+void BulkInserter::add(const unsigned long aValue)
+{
+    Value& value = nextValue();
+    value.mType = SQLite::INTEGER;
+    value.mInteger = static_cast<long long>(aValue);
+}
+
+void BulkInserter::add(const long long aValue)
+{
+    Value& value = nextValue();
+    value.mType = SQLite::INTEGER;
+    value.mInteger = aValue;
+}
+
+void BulkInserter::add(const unsigned long long aValue)
+{
+    Value& value = nextValue();
+    value.mType = SQLite::INTEGER;
+    value.mInteger = static_cast<long long>(aValue);
+}
+
+void BulkInserter::add(const double aValue)
+{
+    Value& value = nextValue();
+    value.mType = SQLite::FLOAT;
+    value.mFloat = aValue;
+}
+
+void BulkInserter::add(const std::string& aValue)
+{
+    Value& value = nextValue();
+    value.mType = SQLite::TEXT;
+    value.mText.assign(aValue);
+}
+
+void BulkInserter::add(const char* apValue)
+{
+    Value& value = nextValue();
+    if (NULL != apValue)
+    {
+        value.mType = SQLite::TEXT;
+        value.mText.assign(apValue);
+    }
+    else
+    {
+        value.mType = SQLite::Null;
+    }
+}
+
+void BulkInserter::add(std::nullptr_t)
+{
+    Value& value = nextValue();
+    value.mType = SQLite::Null;
+}
+
+// End the current row, executing the multi-row statement and committing when needed
+void BulkInserter::endRow()
+{
+    mValueCount = 0;
+    ++mPendingRows;
+    ++mUncommittedRows;
+    ++mRowCount;
+    if (mUncommittedRows >= mRowsPerCommit)
+    {
+        flush();
+    }
+    else if (mPendingRows == mRowsPerStatement)
+    {
+        execute(*mStatement);
+    }
+}
+
+// Bind the pending rows to the provided statement, and execute it
+void BulkInserter::execute(Statement& aStatement)
+{
+    const std::size_t count = mPendingRows * mColumns.size();
+    try
+    {
+        for (std::size_t i = 0; i < count; ++i)
+        {
+            const int index = static_cast<int>(i + 1);
+            const Value& value = mValues[i];
+            if (SQLite::INTEGER == value.mType)
+            {
+                aStatement.bind(index, value.mInteger);
+            }
+            else if (SQLite::FLOAT == value.mType)
+            {
+                aStatement.bind(index, value.mFloat);
+            }
+            else if (SQLite::TEXT == value.mType)
+            {
+                // The text stays untouched until the statement has been executed
+                aStatement.bindNoCopy(index, value.mText);
+            }
+            else
+            {
+                aStatement.bind(index);
+            }
+        }
+        aStatement.exec();
+    }
+    catch (...)
+    {
+        // Executing the same rows again would fail the same way: discard them, the rows inserted before stay
+        mUncommittedRows -= mPendingRows;
+        mRowCount -= mPendingRows;
+        mPendingRows = 0;
+        // sqlite3_reset() only repeats the error of the step
+        try
+        {
+            aStatement.reset();
+        }
+        catch (SQLite::Exception&)
+        {
+        }
+        throw;
+    }
+    aStatement.reset();
+    mPendingRows = 0;
+}
+
+// Build the INSERT query for the provided number of rows
+std::string BulkInserter::buildQuery(const std::size_t aRowCount) const
+{
+    std::string row = "(?";
+    for (std::size_t column = 1; column < mColumns.size(); ++column)
+    {
+        row += ",?";
+    }
+    row += ')';
+
+    std::string query = "INSERT INTO " + mTable + " (";
+    for (std::size_t column = 0; column < mColumns.size(); ++column)
+    {
+        if (column > 0)
+        {
+            query += ',';
+        }
+        query += mColumns[column];
+    }
+    query += ") VALUES ";
+    query.reserve(query.size() + aRowCount * (row.size() + 1));
+    for (std::size_t i = 0; i < aRowCount; ++i)
+    {
+        if (i > 0)
+        {
+            query += ',';
+        }
+        query += row;
+    }
+    return query;
+}
+
+
+}  // namespace SQLite
@@ -0,0 +1,284 @@
+/**
+ * @file    ChangeFeed.cpp
+ * @ingroup SQLiteCpp
+ * @brief   Change-data-capture of a Database Connection: committed row changes published to subscribers.
+ *
+ * Copyright (c) 2012-2016 Sebastien Rombauts (sebastien.rombauts@gmail.com)
+ *
+ * Distributed under the MIT License (MIT) (See accompanying file LICENSE.txt
+ * or copy at http://opensource.org/licenses/MIT)
+ */
+#include <SQLiteCpp/ChangeFeed.h>
+
+#include <sqlite3.h>
+
+#include <algorithm>
+#include <new>
+
+
+namespace SQLite
+{
+
+const int CHANGE_INSERT = SQLITE_INSERT;
+const int CHANGE_UPDATE = SQLITE_UPDATE;
+const int CHANGE_DELETE = SQLITE_DELETE;
+
+
+// Register the hooks of the connection, and start the dispatcher thread
+ChangeFeed::ChangeFeed(Database& aDatabase, const std::size_t aQueueCapacity /* = 1024 */) :
+    mDatabase(aDatabase),
+    mbCommitting(false),
+    mSequence(0),
+    mbOverflow(false),
+    mQueue(std::max(aQueueCapacity, static_cast<std::size_t>(1)) + 1, static_cast<ChangeBatch*>(NULL)),
+    mQueueHead(0),
+    mQueueTail(0),
+    mbWaiting(false),
+    mQueued(0),
+    mCommittedBatches(0),
+    mRolledBackBatches(0),
+    mDroppedBatches(0),
+    mChanges(0),
+    mbStopping(false),
+    mDeliveredSequence(0),
+    mSubscriptions(std::make_shared<const TSubscriptions>()),
+    mNextSubscription(1)
+{
+    mThread = std::thread(&ChangeFeed::loop, this);
+
+    sqlite3* pSQLite = mDatabase.getHandle();
+    sqlite3_update_hook(pSQLite, &ChangeFeed::updateHook, this);
+    sqlite3_commit_hook(pSQLite, &ChangeFeed::commitHook, this);
+    sqlite3_rollback_hook(pSQLite, &ChangeFeed::rollbackHook, this);
+    sqlite3_profile(pSQLite, &ChangeFeed::profileHook, this);
+}
+
+// Unregister the hooks, deliver the batches still in the queue, and stop the dispatcher thread
+ChangeFeed::~ChangeFeed() noexcept // nothrow
+{
+    sqlite3* pSQLite = mDatabase.getHandle();
+    sqlite3_update_hook(pSQLite, NULL, NULL);
+    sqlite3_commit_hook(pSQLite, NULL, NULL);
+    sqlite3_rollback_hook(pSQLite, NULL, NULL);
+    sqlite3_profile(pSQLite, NULL, NULL);
+
+    {
+        std::lock_guard<std::mutex> lock(mMutex);
+        mbStopping = true;
+    }
+    mWakeUp.notify_all();
+    mThread.join();
+}
+
+// Subscribe to the committed batches, of all tables or of one table
+int ChangeFeed::subscribe(const TSubscriber& aSubscriber, const std::string& aTable /* = "" */)
+{
+    std::lock_guard<std::mutex> lock(mMutex);
+    const Subscription subscription = { mNextSubscription++, aTable, aSubscriber };
+    std::shared_ptr<TSubscriptions> subscriptions = std::make_shared<TSubscriptions>(*mSubscriptions);
+    subscriptions->push_back(subscription);
+    mSubscriptions = subscriptions;
+    return subscription.mId;
+}
+
+// Cancel a subscription
+bool ChangeFeed::unsubscribe(const int aSubscription)
+{
+    std::lock_guard<std::mutex> lock(mMutex);
+    std::shared_ptr<TSubscriptions> subscriptions = std::make_shared<TSubscriptions>(*mSubscriptions);
+    for (TSubscriptions::iterator it = subscriptions->begin(); it != subscriptions->end(); ++it)
+    {
+        if (it->mId == aSubscription)
+        {
+            subscriptions->erase(it);
+            mSubscriptions = subscriptions;
+            return true;
+        }
+    }
+    return false;
+}
+
+// Wait for the delivery of all the batches published so far
+void ChangeFeed::flush()
+{
+    const unsigned long long queued = mQueued.load();
+    std::unique_lock<std::mutex> lock(mMutex);
+    while (mDeliveredSequence < queued)
+    {
+        mDelivered.wait(lock);
+    }
+}
+
+// Return the counters of the change feed
+ChangeFeed::Stats ChangeFeed::getStats() const
+{
+    Stats stats;
+    stats.mCommittedBatches = mCommittedBatches.load(std::memory_order_relaxed);
+    stats.mRolledBackBatches = mRolledBackBatches.load(std::memory_order_relaxed);
+    stats.mDroppedBatches = mDroppedBatches.load(std::memory_order_relaxed);
+    stats.mChanges = mChanges.load(std::memory_order_relaxed);
+    return stats;
+}
+
+// Update hook: buffer the change in the current transaction
+void ChangeFeed::updateHook(void* apFeed, int aOperation, const char* apDatabase, const char* apTable, long long aRowId)
+{
+    ChangeFeed& feed = *static_cast<ChangeFeed*>(apFeed);
+    try
+    {
+        feed.mPending.push_back(Change());
+        Change& change = feed.mPending.back();
+        change.mDatabase = apDatabase;
+        change.mTable = apTable;
+        change.mOperation = aOperation;
+        change.mRowId = aRowId;
+    }
+    catch (std::bad_alloc&)
+    {
+        // Out of memory: the change is lost, and the batch is flagged as after a full queue
+        feed.mbOverflow = true;
+    }
+}
+
+// Commit hook: the transaction commits, unless the commit fails (SQLITE_BUSY) or is rolled back
+int ChangeFeed::commitHook(void* apFeed)
+{
+    static_cast<ChangeFeed*>(apFeed)->mbCommitting = true;
+    return 0; // Let the commit proceed
+}
+
+// Rollback hook: discard the changes of the transaction
+void ChangeFeed::rollbackHook(void* apFeed)
+{
+    ChangeFeed& feed = *static_cast<ChangeFeed*>(apFeed);
+    if (false == feed.mPending.empty())
+    {
+        feed.mRolledBackBatches.fetch_add(1, std::memory_order_relaxed);
+        feed.mPending.clear();
+    }
+    feed.mbCommitting = false;
+}
+
+// Profile callback, called at the end of each statement: publish the changes once the commit is complete
+void ChangeFeed::profileHook(void* apFeed, const char* /* apQuery */, unsigned long long /* aDurationNs */)
+{
+    ChangeFeed& feed = *static_cast<ChangeFeed*>(apFeed);
+    if (feed.mbCommitting && (0 != sqlite3_get_autocommit(feed.mDatabase.getHandle())))
+    {
+        feed.mbCommitting = false;
+        feed.publish();
+    }
+}
+
+// Push the changes of the committed transaction to the queue, and wake the dispatcher thread if it waits
+void ChangeFeed::publish()
+{
+    if (mPending.empty())
+    {
+        return;
+    }
+    ChangeBatch* pBatch = new (std::nothrow) ChangeBatch;
+    const unsigned long long sequence = ++mSequence;
+    const std::size_t tail = mQueueTail.load(std::memory_order_relaxed);
+    const std::size_t next = (tail + 1) % mQueue.size();
+    if ((NULL == pBatch) || (next == mQueueHead.load(std::memory_order_acquire)))
+    {
+        // Queue full: the next batch queued is flagged, and the gap in the sequence numbers reveals the dropped batch
+        delete pBatch;
+        mPending.clear();
+        mbOverflow = true;
+        mDroppedBatches.fetch_add(1, std::memory_order_relaxed);
+        return;
+    }
+    pBatch->mSequence = sequence;
+    pBatch->mbOverflow = mbOverflow;
+    mbOverflow = false;
+    pBatch->mChanges.swap(mPending);
+    mCommittedBatches.fetch_add(1, std::memory_order_relaxed);
+    mChanges.fetch_add(pBatch->mChanges.size(), std::memory_order_relaxed);
+    mQueue[tail] = pBatch;
+    mQueued.store(sequence);
+    mQueueTail.store(next); // sequentially consistent with the load of mbWaiting below
+
+    if (mbWaiting.load())
+    {
+        std::lock_guard<std::mutex> lock(mMutex);
+        mWakeUp.notify_one();
+    }
+}
+
+// Deliver a batch to the subscribers, filtered by table
+void ChangeFeed::deliver(const ChangeBatch& aBatch)
+{
+    std::shared_ptr<const TSubscriptions> subscriptions;
+    {
+        std::lock_guard<std::mutex> lock(mMutex);
+        subscriptions = mSubscriptions;
+    }
+    for (TSubscriptions::const_iterator it = subscriptions->begin(); it != subscriptions->end(); ++it)
+    {
+        try
+        {
+            if (it->mTable.empty())
+            {
+                it->mSubscriber(aBatch);
+                continue;
+            }
+            ChangeBatch filtered;
+            filtered.mSequence = aBatch.mSequence;
+            filtered.mbOverflow = aBatch.mbOverflow;
+            for (std::vector<Change>::const_iterator change = aBatch.mChanges.begin(); change != aBatch.mChanges.end(); ++change)
+            {
+                if (change->mTable == it->mTable)
+                {
+                    filtered.mChanges.push_back(*change);
+                }
+            }
+            if ((false == filtered.mChanges.empty()) || filtered.mbOverflow)
+            {
+                it->mSubscriber(filtered);
+            }
+        }
+        catch (...)
+        {
+            // A failing subscriber does not prevent the delivery to the others
+        }
+    }
+}
+
+// Loop of the dispatcher thread: pop and deliver the batches, and wait when the queue is empty
+void ChangeFeed::loop() noexcept // nothrow
+{
+    for (;;)
+    {
+        const std::size_t head = mQueueHead.load(std::memory_order_relaxed);
+        if (head != mQueueTail.load(std::memory_order_acquire))
+        {
+            ChangeBatch* pBatch = mQueue[head];
+            mQueueHead.store((head + 1) % mQueue.size(), std::memory_order_release);
+            deliver(*pBatch);
+            {
+                std::lock_guard<std::mutex> lock(mMutex);
+                mDeliveredSequence = pBatch->mSequence;
+            }
+            mDelivered.notify_all();
+            delete pBatch;
+            continue;
+        }
+
+        std::unique_lock<std::mutex> lock(mMutex);
+        if (mbStopping)
+        {
+            break; // The queue is empty, and the hooks are unregistered
+        }
+        mbWaiting.store(true);
+        if (head == mQueueTail.load()) // sequentially consistent with the store of mbWaiting above
+        {
+            mWakeUp.wait(lock);
+        }
+        mbWaiting.store(false);
+    }
+}
+
+
+}  // namespace SQLite
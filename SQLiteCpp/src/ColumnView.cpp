@@ -0,0 +1,90 @@
+/**
+ * @file    ColumnView.cpp
+ * @ingroup SQLiteCpp
+ * @brief   Non-owning view of a Column of the current row of a Statement, for allocation-free access.
+ *
+ * Copyright (c) 2012-2016 Sebastien Rombauts (sebastien.rombauts@gmail.com)
+ *
+ * Distributed under the MIT License (MIT) (See accompanying file LICENSE.txt
+ * or copy at http://opensource.org/licenses/MIT)
+ */
+#include <SQLiteCpp/ColumnView.h>
+
+#include <sqlite3.h>
+
+
+namespace SQLite
+{
+
+
+// Return the named assigned to this result column (potentially aliased)
+const char* ColumnView::getName() const noexcept // nothrow
+{
+    return sqlite3_column_name(mpStmt, mIndex);
+}
+
+// Return the integer value of the column
+int ColumnView::getInt() const noexcept // nothrow
+{
+    return sqlite3_column_int(mpStmt, mIndex);
+}
+
+// Return the unsigned integer value of the column
+unsigned ColumnView::getUInt() const noexcept // nothrow
+{
+    return static_cast<unsigned>(getInt64());
+}
+
+// Return the 64bits integer value of the column
+long long ColumnView::getInt64() const noexcept // nothrow
+{
+    return sqlite3_column_int64(mpStmt, mIndex);
+}
+
+// Return the double value of the column
+double ColumnView::getDouble() const noexcept // nothrow
+{
+    return sqlite3_column_double(mpStmt, mIndex);
+}
+
+// Return a pointer to the text value (NULL terminated string) of the column
+const char* ColumnView::getText(const char* apDefaultValue /* = "" */) const noexcept // nothrow
+{
+    const char* pText = reinterpret_cast<const char*>(sqlite3_column_text(mpStmt, mIndex));
+    return (pText?pText:apDefaultValue);
+}
+
+// Return a pointer to the blob value (*not* NULL terminated) of the column
+const void* ColumnView::getBlob() const noexcept // nothrow
+{
+    return sqlite3_column_blob(mpStmt, mIndex);
+}
+
+// Return a std::string copy of a TEXT or BLOB column
+std::string ColumnView::getString() const
+{
+    // Note: using sqlite3_column_blob and not sqlite3_column_text, then the bytes length, as in Column::getString()
+    const char* pData = static_cast<const char*>(sqlite3_column_blob(mpStmt, mIndex));
+    return std::string(pData, sqlite3_column_bytes(mpStmt, mIndex));
+}
+
+// Return the type of the value of the column
+int ColumnView::getType() const noexcept // nothrow
+{
+    return sqlite3_column_type(mpStmt, mIndex);
+}
+
+// Test if the column is NULL
+bool ColumnView::isNull() const noexcept // nothrow
+{
+    return (SQLITE_NULL == sqlite3_column_type(mpStmt, mIndex));
+}
+
+// Return the number of bytes used by the text value of the column
+int ColumnView::getBytes() const noexcept // nothrow
+{
+    return sqlite3_column_bytes(mpStmt, mIndex);
+}
+
+
+}  // namespace SQLite
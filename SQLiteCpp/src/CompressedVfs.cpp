@@ -0,0 +1,1286 @@
+/**
+ * @file    CompressedVfs.cpp
+ * @ingroup SQLiteCpp
+ * @brief   Optional SQLite VFS storing the pages of the database files compressed with zlib.
+ *
+ * Copyright (c) 2012-2016 Sebastien Rombauts (sebastien.rombauts@gmail.com)
+ *
+ * Distributed under the MIT License (MIT) (See accompanying file LICENSE.txt
+ * or copy at http://opensource.org/licenses/MIT)
+ */
+#include <SQLiteCpp/CompressedVfs.h>
+
+#include <SQLiteCpp/Assertion.h>
+#include <SQLiteCpp/Exception.h>
+
+#include <sqlite3.h>
+#include <zlib.h>
+
+#include <algorithm>
+#include <cstring>
+#include <list>
+#include <map>
+#include <new>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+
+namespace SQLite
+{
+
+const int CompressedVfs::DEFAULT_CACHE_PAGES;
+
+
+/// Size of each of the two alternate headers at the start of a container file
+static const int HEADER_SIZE = 512;
+/// Offset of the first extent of a container file, after its two headers
+static const sqlite3_int64 DATA_START = 2 * HEADER_SIZE;
+/// Magic string identifying a container file
+static const char HEADER_MAGIC[16] = { 'S', 'Q', 'L', 'i', 't', 'e', 'C', 'p', 'p', ' ', 'z', 'l', 'i', 'b', ' ', '1' };
+/// Number of bytes of a header covered by its CRC-32, which follows them
+static const int HEADER_CRC_OFFSET = 56;
+/// Size of an entry of a serialized page map: offset (8 bytes), size (4 bytes) and CRC-32 (4 bytes)
+static const int MAP_ENTRY_SIZE = 16;
+/// Page size used when the first write to a file is not a page of SQLite
+static const int DEFAULT_PAGE_SIZE = 4096;
+
+
+/// Write a 32 bits integer in little endian
+static void put32(unsigned char* apBuffer, const sqlite3_uint64 aValue)
+{
+    for (int i = 0; i < 4; ++i)
+    {
+        apBuffer[i] = static_cast<unsigned char>(aValue >> (8 * i));
+    }
+}
+
+/// Write a 64 bits integer in little endian
+static void put64(unsigned char* apBuffer, const sqlite3_uint64 aValue)
+{
+    for (int i = 0; i < 8; ++i)
+    {
+        apBuffer[i] = static_cast<unsigned char>(aValue >> (8 * i));
+    }
+}
+
+/// Read a 32 bits integer in little endian
+static sqlite3_uint64 get32(const unsigned char* apBuffer)
+{
+    sqlite3_uint64 value = 0;
+    for (int i = 3; i >= 0; --i)
+    {
+        value = (value << 8) | apBuffer[i];
+    }
+    return value;
+}
+
+/// Read a 64 bits integer in little endian
+static sqlite3_uint64 get64(const unsigned char* apBuffer)
+{
+    sqlite3_uint64 value = 0;
+    for (int i = 7; i >= 0; --i)
+    {
+        value = (value << 8) | apBuffer[i];
+    }
+    return value;
+}
+
+/// Return the CRC-32 of a buffer
+static unsigned int getCrc(const void* apBuffer, const std::size_t aSize)
+{
+    return static_cast<unsigned int>(crc32(0L, static_cast<const Bytef*>(apBuffer), static_cast<uInt>(aSize)));
+}
+
+
+/**
+ * @brief Container file of a main database, opened through a CompressedVfs.
+ *
+ *  Implement the sqlite3_io_methods of the logical database file over the container file opened by the default VFS.
+ * All offsets are in bytes; the logical file is made of pages of mPageSize bytes, each stored in its own extent.
+ */
+class CompressedFile
+{
+public:
+    /// Wrap a container file opened by the default VFS, which is closed and freed with the CompressedFile
+    CompressedFile(CompressedVfs& aVfs, sqlite3_file* apReal);
+    /// Release the zlib streams
+    ~CompressedFile();
+
+    /// Initialize the zlib streams, and read the header and the page map of the container
+    int open();
+    /// Commit the pending changes, and close the container file
+    int close();
+
+    /// @{ sqlite3_io_methods of the logical database file
+    int read(void* apBuffer, const int aAmount, const sqlite3_int64 aOffset);
+    int write(const void* apBuffer, const int aAmount, const sqlite3_int64 aOffset);
+    int truncate(const sqlite3_int64 aSize);
+    int sync(const int aFlags);
+    int lock(const int aLevel);
+    int unlock(const int aLevel);
+    int fileControl(const int aOperation, void* apArg);
+    sqlite3_int64 getFileSize() const
+    {
+        return mFileSize;
+    }
+    sqlite3_file* getReal() const
+    {
+        return mpReal;
+    }
+    /// @}
+
+    /// Add the counters of the last operations to those of the VFS
+    void reportStats();
+
+private:
+    /// Location of a page in the container
+    struct Entry
+    {
+        sqlite3_int64   mOffset;        ///< Offset of the extent of the page, 0 for a page of zeros
+        unsigned int    mSize;          ///< Size of the extent: equal to the page size for a page stored uncompressed
+        unsigned int    mCrc;           ///< CRC-32 of the uncompressed content of the page
+        bool            mbCommitted;    ///< true if the extent is referenced by the committed page map
+    };
+
+    /// Content of a header of the container
+    struct Header
+    {
+        sqlite3_uint64  mSequence;      ///< Number of commits of the container, 0 for an empty file
+        int             mPageSize;      ///< Size of the pages, 0 if unknown
+        sqlite3_int64   mFileSize;      ///< Size of the logical database file
+        sqlite3_int64   mMapOffset;     ///< Offset of the extent of the page map
+        unsigned int    mMapSize;       ///< Size of the compressed page map
+        unsigned int    mMapCrc;        ///< CRC-32 of the uncompressed page map
+    };
+
+    /// Uncompressed page of the cache, and its page number
+    typedef std::pair<int, std::vector<unsigned char> > TCachedPage;
+
+    /// @{ CompressedFile must be non-copyable
+    CompressedFile(const CompressedFile&);
+    CompressedFile& operator=(const CompressedFile&);
+    /// @}
+
+    int readHeader(Header& aHeader);
+    int load();
+    int commit(const bool abSync);
+    int readPage(const int aPage, unsigned char* apBuffer);
+    int writePage(const int aPage, const unsigned char* apBuffer);
+    int inflateExtent(const sqlite3_int64 aOffset, const unsigned int aSize, unsigned char* apBuffer, const std::size_t aBytes);
+    int deflateBuffer(const unsigned char* apBuffer, const std::size_t aBytes);
+    void resize(const sqlite3_int64 aFileSize);
+    sqlite3_int64 allocate(const sqlite3_int64 aSize);
+    void release(const Entry& aEntry);
+    void addFree(sqlite3_int64 aOffset, sqlite3_int64 aSize);
+    const unsigned char* findCached(const int aPage);
+    void putCached(const int aPage, const unsigned char* apBuffer);
+
+private:
+    CompressedVfs&                  mVfs;           ///< VFS owning the file
+    sqlite3_file*                   mpReal;         ///< Container file, opened by the default VFS
+    z_stream                        mDeflate;       ///< zlib stream compressing the pages
+    z_stream                        mInflate;       ///< zlib stream decompressing the pages
+    bool                            mbDeflate;      ///< true once mDeflate is initialized
+    bool                            mbInflate;      ///< true once mInflate is initialized
+    int                             mLockLevel;     ///< SQLITE_LOCK_xxx level held on the container file
+    sqlite3_uint64                  mSequence;      ///< Sequence number of the committed header
+    int                             mPageSize;      ///< Size of the pages, 0 until the first write
+    sqlite3_int64                   mFileSize;      ///< Size of the logical database file
+    sqlite3_int64                   mMapOffset;     ///< Offset of the extent of the committed page map, 0 if none
+    unsigned int                    mMapSize;       ///< Size of the extent of the committed page map
+    sqlite3_int64                   mFileEnd;       ///< End of the last extent of the container file
+    std::vector<Entry>              mEntries;       ///< Location of each page of the logical file
+    std::map<sqlite3_int64, sqlite3_int64>  mFree;  ///< Free extents by offset, with their size
+    std::vector<std::pair<sqlite3_int64, sqlite3_int64> > mPendingFree; ///< Extents of the committed page map to free after the next commit
+    bool                            mbDirty;        ///< true if the page map has changed since the last commit
+    std::vector<unsigned char>      mBuffer;        ///< Compressed extent being read or written
+    std::vector<unsigned char>      mPage;          ///< Page being read or modified
+    std::list<TCachedPage>          mCache;         ///< Uncompressed pages, the most recently used first
+    std::unordered_map<int, std::list<TCachedPage>::iterator>  mCacheIndex; ///< Position of the cached pages in mCache
+    CompressedVfs::Stats            mStats;         ///< Counters of the current operation
+};
+
+
+// Wrap a container file opened by the default VFS
+CompressedFile::CompressedFile(CompressedVfs& aVfs, sqlite3_file* apReal) :
+    mVfs(aVfs),
+    mpReal(apReal),
+    mbDeflate(false),
+    mbInflate(false),
+    mLockLevel(SQLITE_LOCK_NONE),
+    mSequence(0),
+    mPageSize(0),
+    mFileSize(0),
+    mMapOffset(0),
+    mMapSize(0),
+    mFileEnd(DATA_START),
+    mbDirty(false)
+{
+    std::memset(&mDeflate, 0, sizeof(mDeflate));
+    std::memset(&mInflate, 0, sizeof(mInflate));
+    std::memset(&mStats, 0, sizeof(mStats));
+}
+
+// Release the zlib streams
+CompressedFile::~CompressedFile()
+{
+    if (mbDeflate)
+    {
+        deflateEnd(&mDeflate);
+    }
+    if (mbInflate)
+    {
+        inflateEnd(&mInflate);
+    }
+    sqlite3_free(mpReal);
+}
+
+// Initialize the zlib streams, and read the header and the page map of the container
+int CompressedFile::open()
+{
+    mbDeflate = (Z_OK == deflateInit(&mDeflate, mVfs.getLevel()));
+    mbInflate = (Z_OK == inflateInit(&mInflate));
+    if ((false == mbDeflate) || (false == mbInflate))
+    {
+        return SQLITE_NOMEM;
+    }
+    return load();
+}
+
+// Add the counters of the last operations to those of the VFS
+void CompressedFile::reportStats()
+{
+    if ((0 != mStats.mPagesRead) || (0 != mStats.mPagesWritten) || (0 != mStats.mCacheHits)
+     || (0 != mStats.mCommits) || (0 != mStats.mChecksumErrors))
+    {
+        mVfs.addStats(mStats);
+        std::memset(&mStats, 0, sizeof(mStats));
+    }
+}
+
+// Commit the pending changes, and close the container file
+int CompressedFile::close()
+{
+    int ret = SQLITE_OK;
+    if (mbDirty)
+    {
+        ret = commit(false);
+    }
+    if (NULL != mpReal->pMethods)
+    {
+        const int closed = mpReal->pMethods->xClose(mpReal);
+        if (SQLITE_OK == ret)
+        {
+            ret = closed;
+        }
+    }
+    return ret;
+}
+
+// Read the valid header with the largest sequence number, or an empty header for an empty file
+int CompressedFile::readHeader(Header& aHeader)
+{
+    std::memset(&aHeader, 0, sizeof(aHeader));
+    sqlite3_int64 size = 0;
+    int ret = mpReal->pMethods->xFileSize(mpReal, &size);
+    if ((SQLITE_OK != ret) || (0 == size))
+    {
+        return ret;
+    }
+
+    unsigned char headers[DATA_START];
+    ret = mpReal->pMethods->xRead(mpReal, headers, static_cast<int>(DATA_START), 0);
+    if ((SQLITE_OK != ret) && (SQLITE_IOERR_SHORT_READ != ret))
+    {
+        return ret;
+    }
+    bool bFound = false;
+    for (int slot = 0; slot < 2; ++slot)
+    {
+        const unsigned char* pHeader = headers + slot * HEADER_SIZE;
+        if ((0 != std::memcmp(pHeader, HEADER_MAGIC, sizeof(HEADER_MAGIC)))
+         || (get32(pHeader + HEADER_CRC_OFFSET) != getCrc(pHeader, HEADER_CRC_OFFSET)))
+        {
+            continue; // Never written, or torn write
+        }
+        const sqlite3_uint64 sequence = get64(pHeader + 16);
+        if ((false == bFound) || (sequence > aHeader.mSequence))
+        {
+            aHeader.mSequence = sequence;
+            aHeader.mPageSize = static_cast<int>(get32(pHeader + 24));
+            aHeader.mFileSize = static_cast<sqlite3_int64>(get64(pHeader + 32));
+            aHeader.mMapOffset = static_cast<sqlite3_int64>(get64(pHeader + 40));
+            aHeader.mMapSize = static_cast<unsigned int>(get32(pHeader + 48));
+            aHeader.mMapCrc = static_cast<unsigned int>(get32(pHeader + 52));
+            bFound = true;
+        }
+    }
+    return bFound ? SQLITE_OK : SQLITE_NOTADB;
+}
+
+// Read the committed page map, and rebuild the list of free extents
+int CompressedFile::load()
+{
+    Header header;
+    int ret = readHeader(header);
+    if (SQLITE_OK != ret)
+    {
+        return ret;
+    }
+
+    mSequence = header.mSequence;
+    mPageSize = header.mPageSize;
+    mFileSize = header.mFileSize;
+    mMapOffset = header.mMapOffset;
+    mMapSize = header.mMapSize;
+    mEntries.clear();
+    mFree.clear();
+    mPendingFree.clear();
+    mCache.clear();
+    mCacheIndex.clear();
+    mbDirty = false;
+
+    sqlite3_int64 size = 0;
+    ret = mpReal->pMethods->xFileSize(mpReal, &size);
+    if (SQLITE_OK != ret)
+    {
+        return ret;
+    }
+    mFileEnd = std::max(size, DATA_START);
+    if ((0 == mSequence) || (0 == mPageSize))
+    {
+        return SQLITE_OK; // Empty file
+    }
+
+    const std::size_t count = static_cast<std::size_t>((mFileSize + mPageSize - 1) / mPageSize);
+    std::vector<unsigned char> map(count * MAP_ENTRY_SIZE);
+    if (false == map.empty())
+    {
+        ret = inflateExtent(mMapOffset, mMapSize, &map[0], map.size());
+        if ((SQLITE_OK == ret) && (getCrc(&map[0], map.size()) != header.mMapCrc))
+        {
+            ++mStats.mChecksumErrors;
+            ret = SQLITE_CORRUPT;
+        }
+        if (SQLITE_OK != ret)
+        {
+            return ret;
+        }
+    }
+
+    // The free extents are the gaps between the extents of the pages and of the page map
+    std::vector<std::pair<sqlite3_int64, sqlite3_int64> > used;
+    used.reserve(count + 1);
+    mEntries.resize(count);
+    for (std::size_t page = 0; page < count; ++page)
+    {
+        const unsigned char* pEntry = &map[page * MAP_ENTRY_SIZE];
+        Entry& entry = mEntries[page];
+        entry.mOffset = static_cast<sqlite3_int64>(get64(pEntry));
+        entry.mSize = static_cast<unsigned int>(get32(pEntry + 8));
+        entry.mCrc = static_cast<unsigned int>(get32(pEntry + 12));
+        entry.mbCommitted = true;
+        if (0 != entry.mOffset)
+        {
+            used.push_back(std::make_pair(entry.mOffset, static_cast<sqlite3_int64>(entry.mSize)));
+        }
+    }
+    if (0 != mMapOffset)
+    {
+        used.push_back(std::make_pair(mMapOffset, static_cast<sqlite3_int64>(mMapSize)));
+    }
+    std::sort(used.begin(), used.end());
+    sqlite3_int64 end = DATA_START;
+    for (std::vector<std::pair<sqlite3_int64, sqlite3_int64> >::const_iterator it = used.begin(); it != used.end(); ++it)
+    {
+        if (it->first > end)
+        {
+            addFree(end, it->first - end);
+        }
+        end = std::max(end, it->first + it->second);
+    }
+    if (mFileEnd > end)
+    {
+        addFree(end, mFileEnd - end);
+    }
+    return SQLITE_OK;
+}
+
+// Write the page map in a new extent, then the next header, and free the extents it no longer references
+int CompressedFile::commit(const bool abSync)
+{
+    std::vector<unsigned char> map(mEntries.size() * MAP_ENTRY_SIZE);
+    for (std::size_t page = 0; page < mEntries.size(); ++page)
+    {
+        unsigned char* pEntry = &map[page * MAP_ENTRY_SIZE];
+        put64(pEntry, static_cast<sqlite3_uint64>(mEntries[page].mOffset));
+        put32(pEntry + 8, mEntries[page].mSize);
+        put32(pEntry + 12, mEntries[page].mCrc);
+    }
+
+    sqlite3_int64 mapOffset = 0;
+    unsigned int mapSize = 0;
+    const unsigned int mapCrc = map.empty() ? 0 : getCrc(&map[0], map.size());
+    if (false == map.empty())
+    {
+        int ret = deflateBuffer(&map[0], map.size());
+        if (SQLITE_OK != ret)
+        {
+            return ret;
+        }
+        mapSize = static_cast<unsigned int>(mBuffer.size());
+        mapOffset = allocate(mapSize);
+        ret = mpReal->pMethods->xWrite(mpReal, &mBuffer[0], static_cast<int>(mapSize), mapOffset);
+        if (SQLITE_OK != ret)
+        {
+            addFree(mapOffset, mapSize);
+            return ret;
+        }
+    }
+    // The page map must be durable before the header referencing it
+    if (abSync)
+    {
+        const int ret = mpReal->pMethods->xSync(mpReal, SQLITE_SYNC_NORMAL);
+        if (SQLITE_OK != ret)
+        {
+            return ret;
+        }
+    }
+
+    const sqlite3_uint64 sequence = mSequence + 1;
+    unsigned char header[HEADER_SIZE];
+    std::memset(header, 0, sizeof(header));
+    std::memcpy(header, HEADER_MAGIC, sizeof(HEADER_MAGIC));
+    put64(header + 16, sequence);
+    put32(header + 24, static_cast<sqlite3_uint64>(mPageSize));
+    put64(header + 32, static_cast<sqlite3_uint64>(mFileSize));
+    put64(header + 40, static_cast<sqlite3_uint64>(mapOffset));
+    put32(header + 48, mapSize);
+    put32(header + 52, mapCrc);
+    put32(header + HEADER_CRC_OFFSET, getCrc(header, HEADER_CRC_OFFSET));
+    int ret = mpReal->pMethods->xWrite(mpReal, header, HEADER_SIZE, static_cast<sqlite3_int64>(sequence % 2) * HEADER_SIZE);
+    if ((SQLITE_OK == ret) && abSync)
+    {
+        ret = mpReal->pMethods->xSync(mpReal, SQLITE_SYNC_NORMAL);
+    }
+    if (SQLITE_OK != ret)
+    {
+        return ret;
+    }
+
+    // Committed: the extents of the previous page map, and of the pages it referenced, can be reused
+    if (0 != mMapOffset)
+    {
+        mPendingFree.push_back(std::make_pair(mMapOffset, static_cast<sqlite3_int64>(mMapSize)));
+    }
+    for (std::size_t i = 0; i < mPendingFree.size(); ++i)
+    {
+        addFree(mPendingFree[i].first, mPendingFree[i].second);
+    }
+    mPendingFree.clear();
+    for (std::vector<Entry>::iterator it = mEntries.begin(); it != mEntries.end(); ++it)
+    {
+        it->mbCommitted = true;
+    }
+    mSequence = sequence;
+    mMapOffset = mapOffset;
+    mMapSize = mapSize;
+    mbDirty = false;
+    ++mStats.mCommits;
+
+    // Give the free space at the end of the container back to the file system
+    if (false == mFree.empty())
+    {
+        const std::map<sqlite3_int64, sqlite3_int64>::iterator last = --mFree.end();
+        if (last->first + last->second == mFileEnd)
+        {
+            mFileEnd = last->first;
+            mFree.erase(last);
+            ret = mpReal->pMethods->xTruncate(mpReal, mFileEnd);
+        }
+    }
+    return ret;
+}
+
+// Read the uncompressed content of a page of the logical file, verifying its checksum
+int CompressedFile::readPage(const int aPage, unsigned char* apBuffer)
+{
+    const unsigned char* pCached = findCached(aPage);
+    if (NULL != pCached)
+    {
+        std::memcpy(apBuffer, pCached, mPageSize);
+        ++mStats.mCacheHits;
+        return SQLITE_OK;
+    }
+
+    const Entry& entry = mEntries[aPage];
+    if (0 == entry.mOffset)
+    {
+        std::memset(apBuffer, 0, mPageSize);
+        return SQLITE_OK; // Page never written
+    }
+    int ret = SQLITE_OK;
+    if (static_cast<int>(entry.mSize) == mPageSize)
+    {
+        ret = mpReal->pMethods->xRead(mpReal, apBuffer, mPageSize, entry.mOffset);
+        if (SQLITE_IOERR_SHORT_READ == ret)
+        {
+            ret = SQLITE_CORRUPT;
+        }
+    }
+    else
+    {
+        ret = inflateExtent(entry.mOffset, entry.mSize, apBuffer, mPageSize);
+    }
+    if ((SQLITE_OK == ret) && (getCrc(apBuffer, mPageSize) != entry.mCrc))
+    {
+        ++mStats.mChecksumErrors;
+        ret = SQLITE_CORRUPT;
+    }
+    if (SQLITE_OK == ret)
+    {
+        ++mStats.mPagesRead;
+        putCached(aPage, apBuffer);
+    }
+    return ret;
+}
+
+// Compress a page of the logical file in a new extent
+int CompressedFile::writePage(const int aPage, const unsigned char* apBuffer)
+{
+    Entry entry;
+    entry.mCrc = getCrc(apBuffer, mPageSize);
+    entry.mbCommitted = false;
+    int ret = deflateBuffer(apBuffer, mPageSize);
+    if (SQLITE_OK != ret)
+    {
+        return ret;
+    }
+    const unsigned char* pData = &mBuffer[0];
+    entry.mSize = static_cast<unsigned int>(mBuffer.size());
+    if (static_cast<int>(entry.mSize) >= mPageSize)
+    {
+        // Not compressible: stored as is
+        pData = apBuffer;
+        entry.mSize = static_cast<unsigned int>(mPageSize);
+    }
+    entry.mOffset = allocate(entry.mSize);
+    ret = mpReal->pMethods->xWrite(mpReal, pData, static_cast<int>(entry.mSize), entry.mOffset);
+    if (SQLITE_OK != ret)
+    {
+        addFree(entry.mOffset, entry.mSize);
+        return ret;
+    }
+
+    release(mEntries[aPage]);
+    mEntries[aPage] = entry;
+    mbDirty = true;
+    ++mStats.mPagesWritten;
+    mStats.mBytesWritten += mPageSize;
+    mStats.mCompressedBytes += entry.mSize;
+    putCached(aPage, apBuffer);
+    return SQLITE_OK;
+}
+
+// Read and decompress an extent of the container, which must fill the buffer exactly
+int CompressedFile::inflateExtent(const sqlite3_int64 aOffset, const unsigned int aSize,
+                                  unsigned char* apBuffer, const std::size_t aBytes)
+{
+    mBuffer.resize(aSize);
+    int ret = mpReal->pMethods->xRead(mpReal, &mBuffer[0], static_cast<int>(aSize), aOffset);
+    if (SQLITE_IOERR_SHORT_READ == ret)
+    {
+        return SQLITE_CORRUPT;
+    }
+    else if (SQLITE_OK != ret)
+    {
+        return ret;
+    }
+
+    inflateReset(&mInflate);
+    mInflate.next_in = &mBuffer[0];
+    mInflate.avail_in = static_cast<uInt>(aSize);
+    mInflate.next_out = apBuffer;
+    mInflate.avail_out = static_cast<uInt>(aBytes);
+    if ((Z_STREAM_END != inflate(&mInflate, Z_FINISH)) || (0 != mInflate.avail_out))
+    {
+        ++mStats.mChecksumErrors;
+        return SQLITE_CORRUPT;
+    }
+    return SQLITE_OK;
+}
+
+// Compress a buffer into mBuffer
+int CompressedFile::deflateBuffer(const unsigned char* apBuffer, const std::size_t aBytes)
+{
+    deflateReset(&mDeflate);
+    mBuffer.resize(deflateBound(&mDeflate, static_cast<uLong>(aBytes)));
+    mDeflate.next_in = const_cast<Bytef*>(apBuffer);
+    mDeflate.avail_in = static_cast<uInt>(aBytes);
+    mDeflate.next_out = &mBuffer[0];
+    mDeflate.avail_out = static_cast<uInt>(mBuffer.size());
+    if (Z_STREAM_END != deflate(&mDeflate, Z_FINISH))
+    {
+        return SQLITE_IOERR_WRITE;
+    }
+    mBuffer.resize(mBuffer.size() - mDeflate.avail_out);
+    return SQLITE_OK;
+}
+
+// Read from the logical database file
+int CompressedFile::read(void* apBuffer, const int aAmount, const sqlite3_int64 aOffset)
+{
+    unsigned char* pBuffer = static_cast<unsigned char*>(apBuffer);
+    const sqlite3_int64 available = (aOffset < mFileSize) ? std::min(static_cast<sqlite3_int64>(aAmount), mFileSize - aOffset) : 0;
+    sqlite3_int64 done = 0;
+    while (done < available)
+    {
+        const sqlite3_int64 offset = aOffset + done;
+        const int page = static_cast<int>(offset / mPageSize);
+        const int inPage = static_cast<int>(offset % mPageSize);
+        const int bytes = static_cast<int>(std::min(static_cast<sqlite3_int64>(mPageSize - inPage), available - done));
+        int ret = SQLITE_OK;
+        if (bytes == mPageSize)
+        {
+            ret = readPage(page, pBuffer + done);
+        }
+        else
+        {
+            mPage.resize(mPageSize);
+            ret = readPage(page, &mPage[0]);
+            std::memcpy(pBuffer + done, &mPage[inPage], bytes);
+        }
+        if (SQLITE_OK != ret)
+        {
+            return ret;
+        }
+        done += bytes;
+    }
+    if (available < aAmount)
+    {
+        // Past the end of the file: SQLite expects the missing bytes to be zeros
+        std::memset(pBuffer + available, 0, static_cast<std::size_t>(aAmount - available));
+        return SQLITE_IOERR_SHORT_READ;
+    }
+    return SQLITE_OK;
+}
+
+// Write to the logical database file, page by page
+int CompressedFile::write(const void* apBuffer, const int aAmount, const sqlite3_int64 aOffset)
+{
+    if (0 == mPageSize)
+    {
+        // The first write to a database is its first page: its size is the page size of the database
+        const bool bPageSize = (aAmount >= 512) && (aAmount <= 65536) && (0 == (aAmount & (aAmount - 1)));
+        mPageSize = bPageSize ? aAmount : DEFAULT_PAGE_SIZE;
+    }
+    resize(std::max(mFileSize, aOffset + aAmount));
+
+    const unsigned char* pBuffer = static_cast<const unsigned char*>(apBuffer);
+    sqlite3_int64 done = 0;
+    while (done < aAmount)
+    {
+        const sqlite3_int64 offset = aOffset + done;
+        const int page = static_cast<int>(offset / mPageSize);
+        const int inPage = static_cast<int>(offset % mPageSize);
+        const int bytes = static_cast<int>(std::min(static_cast<sqlite3_int64>(mPageSize - inPage), aAmount - done));
+        int ret = SQLITE_OK;
+        if (bytes == mPageSize)
+        {
+            ret = writePage(page, pBuffer + done);
+        }
+        else
+        {
+            // Partial write of a page, by a backup from a database of another page size for instance
+            mPage.resize(mPageSize);
+            ret = readPage(page, &mPage[0]);
+            if (SQLITE_OK == ret)
+            {
+                std::memcpy(&mPage[inPage], pBuffer + done, bytes);
+                ret = writePage(page, &mPage[0]);
+            }
+        }
+        if (SQLITE_OK != ret)
+        {
+            return ret;
+        }
+        done += bytes;
+    }
+    return SQLITE_OK;
+}
+
+// Truncate or extend the logical database file
+int CompressedFile::truncate(const sqlite3_int64 aSize)
+{
+    if ((0 != mPageSize) && (aSize < mFileSize) && (0 != (aSize % mPageSize)))
+    {
+        // Zero the end of the new last page, as a file system would for a later extension of the file
+        const int page = static_cast<int>(aSize / mPageSize);
+        mPage.resize(mPageSize);
+        int ret = readPage(page, &mPage[0]);
+        if (SQLITE_OK == ret)
+        {
+            std::memset(&mPage[aSize % mPageSize], 0, static_cast<std::size_t>(mPageSize - aSize % mPageSize));
+            ret = writePage(page, &mPage[0]);
+        }
+        if (SQLITE_OK != ret)
+        {
+            return ret;
+        }
+    }
+    if (aSize != mFileSize)
+    {
+        resize(aSize);
+        if (mEntries.empty())
+        {
+            mPageSize = 0; // An empty database can change its page size
+        }
+    }
+    return SQLITE_OK;
+}
+
+// Commit the page map, durably
+int CompressedFile::sync(const int aFlags)
+{
+    if (mbDirty)
+    {
+        return commit(true);
+    }
+    return mpReal->pMethods->xSync(mpReal, aFlags);
+}
+
+// Lock the container file, reloading the page map if another connection has committed since the last lock
+int CompressedFile::lock(const int aLevel)
+{
+    int ret = mpReal->pMethods->xLock(mpReal, aLevel);
+    if ((SQLITE_OK == ret) && (SQLITE_LOCK_NONE == mLockLevel))
+    {
+        Header header;
+        ret = readHeader(header);
+        if ((SQLITE_OK == ret) && (header.mSequence != mSequence))
+        {
+            ret = load();
+        }
+        if (SQLITE_OK != ret)
+        {
+            mpReal->pMethods->xUnlock(mpReal, SQLITE_LOCK_NONE);
+            return ret;
+        }
+    }
+    if (SQLITE_OK == ret)
+    {
+        mLockLevel = std::max(mLockLevel, aLevel);
+    }
+    return ret;
+}
+
+// Commit the page map before giving the write lock up, then unlock the container file
+int CompressedFile::unlock(const int aLevel)
+{
+    if (mbDirty && (aLevel <= SQLITE_LOCK_SHARED))
+    {
+        const int ret = commit(false);
+        if (SQLITE_OK != ret)
+        {
+            return ret;
+        }
+    }
+    const int ret = mpReal->pMethods->xUnlock(mpReal, aLevel);
+    if (SQLITE_OK == ret)
+    {
+        mLockLevel = aLevel;
+    }
+    return ret;
+}
+
+// Commit the page map at the end of each transaction, even when SQLite does not sync the file, and forward the other operations
+int CompressedFile::fileControl(const int aOperation, void* apArg)
+{
+    if ((SQLITE_FCNTL_COMMIT_PHASETWO == aOperation) && mbDirty)
+    {
+        const int ret = commit(false);
+        if (SQLITE_OK != ret)
+        {
+            return ret;
+        }
+    }
+
+    // The other operations (and the commit hint) are those of the container file
+    const int ret = mpReal->pMethods->xFileControl(mpReal, aOperation, apArg);
+    if ((SQLITE_FCNTL_VFSNAME == aOperation) && (SQLITE_OK == ret))
+    {
+        // Name of the stack of VFS, this one over the default one
+        char* pRealName = *static_cast<char**>(apArg);
+        *static_cast<char**>(apArg) = sqlite3_mprintf("%s/%s", mVfs.getName().c_str(), pRealName);
+        sqlite3_free(pRealName);
+    }
+    return ret;
+}
+
+// Change the size of the logical file, freeing the extents of the pages past its end
+void CompressedFile::resize(const sqlite3_int64 aFileSize)
+{
+    const std::size_t count = (0 == mPageSize) ? 0 : static_cast<std::size_t>((aFileSize + mPageSize - 1) / mPageSize);
+    for (std::size_t page = count; page < mEntries.size(); ++page)
+    {
+        release(mEntries[page]);
+        const std::unordered_map<int, std::list<TCachedPage>::iterator>::iterator cached = mCacheIndex.find(static_cast<int>(page));
+        if (mCacheIndex.end() != cached)
+        {
+            mCache.erase(cached->second);
+            mCacheIndex.erase(cached);
+        }
+    }
+    const Entry empty = { 0, 0, 0, false };
+    mEntries.resize(count, empty);
+    mFileSize = aFileSize;
+    mbDirty = true;
+}
+
+// Allocate an extent, in the first free extent large enough, or at the end of the container
+sqlite3_int64 CompressedFile::allocate(const sqlite3_int64 aSize)
+{
+    // Address-ordered first fit: the extents gather at the start of the container, and its end becomes free
+    for (std::map<sqlite3_int64, sqlite3_int64>::iterator it = mFree.begin(); it != mFree.end(); ++it)
+    {
+        if (it->second >= aSize)
+        {
+            const sqlite3_int64 offset = it->first;
+            const sqlite3_int64 size = it->second;
+            mFree.erase(it);
+            if (size > aSize)
+            {
+                mFree.insert(std::make_pair(offset + aSize, size - aSize));
+            }
+            return offset;
+        }
+    }
+    const sqlite3_int64 offset = mFileEnd;
+    mFileEnd += aSize;
+    return offset;
+}
+
+// Free the extent of a page: after the next commit if the committed page map references it
+void CompressedFile::release(const Entry& aEntry)
+{
+    if (0 == aEntry.mOffset)
+    {
+        return;
+    }
+    if (aEntry.mbCommitted)
+    {
+        mPendingFree.push_back(std::make_pair(aEntry.mOffset, static_cast<sqlite3_int64>(aEntry.mSize)));
+    }
+    else
+    {
+        addFree(aEntry.mOffset, aEntry.mSize);
+    }
+}
+
+// Add a free extent, merged with the adjacent free extents
+void CompressedFile::addFree(sqlite3_int64 aOffset, sqlite3_int64 aSize)
+{
+    std::map<sqlite3_int64, sqlite3_int64>::iterator next = mFree.lower_bound(aOffset);
+    if ((mFree.end() != next) && (next->first == aOffset + aSize))
+    {
+        aSize += next->second;
+        next = mFree.erase(next);
+    }
+    if (mFree.begin() != next)
+    {
+        std::map<sqlite3_int64, sqlite3_int64>::iterator previous = next;
+        --previous;
+        if (previous->first + previous->second == aOffset)
+        {
+            previous->second += aSize;
+            return;
+        }
+    }
+    mFree.insert(next, std::make_pair(aOffset, aSize));
+}
+
+// Return the cached content of a page, marked as the most recently used, or NULL
+const unsigned char* CompressedFile::findCached(const int aPage)
+{
+    const std::unordered_map<int, std::list<TCachedPage>::iterator>::iterator found = mCacheIndex.find(aPage);
+    if (mCacheIndex.end() == found)
+    {
+        return NULL;
+    }
+    mCache.splice(mCache.begin(), mCache, found->second);
+    return &found->second->second[0];
+}
+
+// Put the content of a page in the cache, evicting the least recently used page if full
+void CompressedFile::putCached(const int aPage, const unsigned char* apBuffer)
+{
+    if (mVfs.getCachePages() <= 0)
+    {
+        return;
+    }
+    const std::unordered_map<int, std::list<TCachedPage>::iterator>::iterator found = mCacheIndex.find(aPage);
+    if (mCacheIndex.end() != found)
+    {
+        mCache.splice(mCache.begin(), mCache, found->second);
+    }
+    else if (static_cast<int>(mCache.size()) >= mVfs.getCachePages())
+    {
+        // Reuse the buffer of the least recently used page
+        mCache.splice(mCache.begin(), mCache, --mCache.end());
+        mCacheIndex.erase(mCache.front().first);
+        mCache.front().first = aPage;
+        mCacheIndex[aPage] = mCache.begin();
+    }
+    else
+    {
+        mCache.push_front(TCachedPage(aPage, std::vector<unsigned char>()));
+        mCacheIndex[aPage] = mCache.begin();
+    }
+    mCache.front().second.assign(apBuffer, apBuffer + mPageSize);
+}
+
+
+/// sqlite3_file of a main database file opened through a CompressedVfs
+struct CompressedFileHandle
+{
+    sqlite3_file    mBase;  ///< sqlite3_file "base class", pointing to sCompressedFileMethods
+    CompressedFile* mpFile; ///< Container file
+};
+
+/// Return the container file of a sqlite3_file opened through a CompressedVfs
+static CompressedFile& getFile(sqlite3_file* apFile)
+{
+    return *reinterpret_cast<CompressedFileHandle*>(apFile)->mpFile;
+}
+
+/// Return the VFS on top of which a CompressedVfs is registered
+static sqlite3_vfs* getBase(sqlite3_vfs* apVfs)
+{
+    return static_cast<CompressedVfs*>(apVfs->pAppData)->getBaseVfs();
+}
+
+/// Call a method of the container file, converting an out of memory error, and report its counters to the VFS
+template<typename Operation>
+static int call(sqlite3_file* apFile, Operation aOperation)
+{
+    CompressedFile& file = getFile(apFile);
+    int ret = SQLITE_OK;
+    try
+    {
+        ret = aOperation(file);
+    }
+    catch (std::bad_alloc&)
+    {
+        ret = SQLITE_IOERR_NOMEM;
+    }
+    file.reportStats();
+    return ret;
+}
+
+/// @{ sqlite3_io_methods of a main database file
+static int fileClose(sqlite3_file* apFile)
+{
+    const int ret = call(apFile, [](CompressedFile& aFile) { return aFile.close(); });
+    delete &getFile(apFile);
+    return ret;
+}
+static int fileRead(sqlite3_file* apFile, void* apBuffer, int aAmount, sqlite3_int64 aOffset)
+{
+    return call(apFile, [=](CompressedFile& aFile) { return aFile.read(apBuffer, aAmount, aOffset); });
+}
+static int fileWrite(sqlite3_file* apFile, const void* apBuffer, int aAmount, sqlite3_int64 aOffset)
+{
+    return call(apFile, [=](CompressedFile& aFile) { return aFile.write(apBuffer, aAmount, aOffset); });
+}
+static int fileTruncate(sqlite3_file* apFile, sqlite3_int64 aSize)
+{
+    return call(apFile, [=](CompressedFile& aFile) { return aFile.truncate(aSize); });
+}
+static int fileSync(sqlite3_file* apFile, int aFlags)
+{
+    return call(apFile, [=](CompressedFile& aFile) { return aFile.sync(aFlags); });
+}
+static int fileSize(sqlite3_file* apFile, sqlite3_int64* apSize)
+{
+    *apSize = getFile(apFile).getFileSize();
+    return SQLITE_OK;
+}
+static int fileLock(sqlite3_file* apFile, int aLevel)
+{
+    return call(apFile, [=](CompressedFile& aFile) { return aFile.lock(aLevel); });
+}
+static int fileUnlock(sqlite3_file* apFile, int aLevel)
+{
+    return call(apFile, [=](CompressedFile& aFile) { return aFile.unlock(aLevel); });
+}
+static int fileCheckReservedLock(sqlite3_file* apFile, int* apResult)
+{
+    sqlite3_file* pReal = getFile(apFile).getReal();
+    return pReal->pMethods->xCheckReservedLock(pReal, apResult);
+}
+static int fileControl(sqlite3_file* apFile, int aOperation, void* apArg)
+{
+    return call(apFile, [=](CompressedFile& aFile) { return aFile.fileControl(aOperation, apArg); });
+}
+static int fileSectorSize(sqlite3_file* apFile)
+{
+    sqlite3_file* pReal = getFile(apFile).getReal();
+    return pReal->pMethods->xSectorSize(pReal);
+}
+static int fileDeviceCharacteristics(sqlite3_file* /* apFile */)
+{
+    // No atomic or safe-append write: the pages are not written in place
+    return 0;
+}
+/// @}
+
+/// sqlite3_io_methods of a main database file: version 1, without the shared-memory methods needed by WAL
+static const sqlite3_io_methods sCompressedFileMethods =
+{
+    1,
+    &fileClose,
+    &fileRead,
+    &fileWrite,
+    &fileTruncate,
+    &fileSync,
+    &fileSize,
+    &fileLock,
+    &fileUnlock,
+    &fileCheckReservedLock,
+    &fileControl,
+    &fileSectorSize,
+    &fileDeviceCharacteristics,
+    NULL,
+    NULL,
+    NULL,
+    NULL,
+    NULL,
+    NULL
+};
+
+/// Open a main database file as a container, and any other file with the base VFS
+static int vfsOpen(sqlite3_vfs* apVfs, const char* apName, sqlite3_file* apFile, int aFlags, int* apOutFlags)
+{
+    sqlite3_vfs* pBase = getBase(apVfs);
+    if (0 == (aFlags & SQLITE_OPEN_MAIN_DB))
+    {
+        return pBase->xOpen(pBase, apName, apFile, aFlags, apOutFlags);
+    }
+
+    CompressedFileHandle* pHandle = reinterpret_cast<CompressedFileHandle*>(apFile);
+    pHandle->mBase.pMethods = NULL;
+    pHandle->mpFile = NULL;
+    sqlite3_file* pReal = static_cast<sqlite3_file*>(sqlite3_malloc(pBase->szOsFile));
+    if (NULL == pReal)
+    {
+        return SQLITE_NOMEM;
+    }
+    std::memset(pReal, 0, pBase->szOsFile);
+    int ret = pBase->xOpen(pBase, apName, pReal, aFlags, apOutFlags);
+    if (SQLITE_OK != ret)
+    {
+        if (NULL != pReal->pMethods)
+        {
+            pReal->pMethods->xClose(pReal);
+        }
+        sqlite3_free(pReal);
+        return ret;
+    }
+
+    CompressedVfs& vfs = *static_cast<CompressedVfs*>(apVfs->pAppData);
+    CompressedFile* pFile = new (std::nothrow) CompressedFile(vfs, pReal);
+    if (NULL == pFile)
+    {
+        pReal->pMethods->xClose(pReal);
+        sqlite3_free(pReal);
+        return SQLITE_NOMEM;
+    }
+    try
+    {
+        ret = pFile->open();
+    }
+    catch (std::bad_alloc&)
+    {
+        ret = SQLITE_NOMEM;
+    }
+    pFile->reportStats();
+    if (SQLITE_OK != ret)
+    {
+        pReal->pMethods->xClose(pReal);
+        delete pFile;
+        return ret;
+    }
+    pHandle->mpFile = pFile;
+    pHandle->mBase.pMethods = &sCompressedFileMethods;
+    return SQLITE_OK;
+}
+
+/// @{ Other methods of the VFS, delegated to the base VFS
+static int vfsDelete(sqlite3_vfs* apVfs, const char* apName, int abSyncDir)
+{
+    sqlite3_vfs* pBase = getBase(apVfs);
+    return pBase->xDelete(pBase, apName, abSyncDir);
+}
+static int vfsAccess(sqlite3_vfs* apVfs, const char* apName, int aFlags, int* apResult)
+{
+    sqlite3_vfs* pBase = getBase(apVfs);
+    return pBase->xAccess(pBase, apName, aFlags, apResult);
+}
+static int vfsFullPathname(sqlite3_vfs* apVfs, const char* apName, int aSize, char* apOut)
+{
+    sqlite3_vfs* pBase = getBase(apVfs);
+    return pBase->xFullPathname(pBase, apName, aSize, apOut);
+}
+static void* vfsDlOpen(sqlite3_vfs* apVfs, const char* apName)
+{
+    sqlite3_vfs* pBase = getBase(apVfs);
+    return pBase->xDlOpen(pBase, apName);
+}
+static void vfsDlError(sqlite3_vfs* apVfs, int aSize, char* apError)
+{
+    sqlite3_vfs* pBase = getBase(apVfs);
+    pBase->xDlError(pBase, aSize, apError);
+}
+static void (*vfsDlSym(sqlite3_vfs* apVfs, void* apHandle, const char* apSymbol))(void)
+{
+    sqlite3_vfs* pBase = getBase(apVfs);
+    return pBase->xDlSym(pBase, apHandle, apSymbol);
+}
+static void vfsDlClose(sqlite3_vfs* apVfs, void* apHandle)
+{
+    sqlite3_vfs* pBase = getBase(apVfs);
+    pBase->xDlClose(pBase, apHandle);
+}
+static int vfsRandomness(sqlite3_vfs* apVfs, int aSize, char* apOut)
+{
+    sqlite3_vfs* pBase = getBase(apVfs);
+    return pBase->xRandomness(pBase, aSize, apOut);
+}
+static int vfsSleep(sqlite3_vfs* apVfs, int aMicroseconds)
+{
+    sqlite3_vfs* pBase = getBase(apVfs);
+    return pBase->xSleep(pBase, aMicroseconds);
+}
+static int vfsCurrentTime(sqlite3_vfs* apVfs, double* apTime)
+{
+    sqlite3_vfs* pBase = getBase(apVfs);
+    return pBase->xCurrentTime(pBase, apTime);
+}
+static int vfsGetLastError(sqlite3_vfs* apVfs, int aSize, char* apOut)
+{
+    sqlite3_vfs* pBase = getBase(apVfs);
+    return pBase->xGetLastError(pBase, aSize, apOut);
+}
+static int vfsCurrentTimeInt64(sqlite3_vfs* apVfs, sqlite3_int64* apTime)
+{
+    sqlite3_vfs* pBase = getBase(apVfs);
+    if ((pBase->iVersion >= 2) && (NULL != pBase->xCurrentTimeInt64))
+    {
+        return pBase->xCurrentTimeInt64(pBase, apTime);
+    }
+    double time = 0.0;
+    const int ret = pBase->xCurrentTime(pBase, &time);
+    *apTime = static_cast<sqlite3_int64>(time * 86400000.0);
+    return ret;
+}
+/// @}
+
+
+// Register the VFS under a name, on top of the default VFS of SQLite
+CompressedVfs::CompressedVfs(const std::string& aName,
+                             const int aLevel /* = -1 */,
+                             const int aCachePages /* = DEFAULT_CACHE_PAGES */,
+                             const bool abMakeDefault /* = false */) :
+    mName(aName),
+    mLevel(aLevel),
+    mCachePages(aCachePages),
+    mpVfs(NULL),
+    mpBaseVfs(NULL)
+{
+    std::memset(&mStats, 0, sizeof(mStats));
+    if ((mLevel < Z_DEFAULT_COMPRESSION) || (mLevel > Z_BEST_COMPRESSION))
+    {
+        throw SQLite::Exception("invalid zlib compression level");
+    }
+    if (NULL != sqlite3_vfs_find(mName.c_str()))
+    {
+        throw SQLite::Exception("a VFS named \"" + mName + "\" is already registered");
+    }
+    mpBaseVfs = sqlite3_vfs_find(NULL);
+    if (NULL == mpBaseVfs)
+    {
+        throw SQLite::Exception("no default VFS");
+    }
+
+    mpVfs = new sqlite3_vfs;
+    std::memset(mpVfs, 0, sizeof(sqlite3_vfs));
+    mpVfs->iVersion = 2;
+    mpVfs->szOsFile = std::max(mpBaseVfs->szOsFile, static_cast<int>(sizeof(CompressedFileHandle)));
+    mpVfs->mxPathname = mpBaseVfs->mxPathname;
+    mpVfs->zName = mName.c_str();
+    mpVfs->pAppData = this;
+    mpVfs->xOpen = &vfsOpen;
+    mpVfs->xDelete = &vfsDelete;
+    mpVfs->xAccess = &vfsAccess;
+    mpVfs->xFullPathname = &vfsFullPathname;
+    mpVfs->xDlOpen = &vfsDlOpen;
+    mpVfs->xDlError = &vfsDlError;
+    mpVfs->xDlSym = &vfsDlSym;
+    mpVfs->xDlClose = &vfsDlClose;
+    mpVfs->xRandomness = &vfsRandomness;
+    mpVfs->xSleep = &vfsSleep;
+    mpVfs->xCurrentTime = &vfsCurrentTime;
+    mpVfs->xGetLastError = &vfsGetLastError;
+    mpVfs->xCurrentTimeInt64 = &vfsCurrentTimeInt64;
+
+    const int ret = sqlite3_vfs_register(mpVfs, abMakeDefault ? 1 : 0);
+    if (SQLITE_OK != ret)
+    {
+        delete mpVfs;
+        throw SQLite::Exception("unable to register the VFS \"" + mName + "\"", ret);
+    }
+}
+
+// Unregister the VFS
+CompressedVfs::~CompressedVfs() noexcept // nothrow
+{
+    const int ret = sqlite3_vfs_unregister(mpVfs);
+    const bool bUnregistered = (SQLITE_OK == ret);
+    // Avoid unreferenced variable warning when build in release mode
+    (void) bUnregistered;
+
+    // Only case of error is SQLITE_MISUSE: a NULL VFS
+    SQLITECPP_ASSERT(bUnregistered, "sqlite3_vfs_unregister failed");
+    delete mpVfs;
+}
+
+// Return a snapshot of the counters of the activity of the VFS
+CompressedVfs::Stats CompressedVfs::getStats() const
+{
+    std::lock_guard<std::mutex> lock(mMutex);
+    return mStats;
+}
+
+// Reset the counters of the activity of the VFS
+void CompressedVfs::resetStats()
+{
+    std::lock_guard<std::mutex> lock(mMutex);
+    std::memset(&mStats, 0, sizeof(mStats));
+}
+
+// Add the activity of one operation on a file to the counters
+void CompressedVfs::addStats(const Stats& aStats)
+{
+    std::lock_guard<std::mutex> lock(mMutex);
+    mStats.mPagesRead += aStats.mPagesRead;
+    mStats.mPagesWritten += aStats.mPagesWritten;
+    mStats.mCacheHits += aStats.mCacheHits;
+    mStats.mBytesWritten += aStats.mBytesWritten;
+    mStats.mCompressedBytes += aStats.mCompressedBytes;
+    mStats.mCommits += aStats.mCommits;
+    mStats.mChecksumErrors += aStats.mChecksumErrors;
+}
+
+
+}  // namespace SQLite
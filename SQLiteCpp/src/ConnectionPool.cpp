@@ -0,0 +1,182 @@
+/**
+ * @file    ConnectionPool.cpp
+ * @ingroup SQLiteCpp
+ * @brief   Thread-safe pool of Database Connections, with read-only readers and one writer in WAL mode.
+ *
+ * Copyright (c) 2012-2016 Sebastien Rombauts (sebastien.rombauts@gmail.com)
+ *
+ * Distributed under the MIT License (MIT) (See accompanying file LICENSE.txt
+ * or copy at http://opensource.org/licenses/MIT)
+ */
+#include <SQLiteCpp/ConnectionPool.h>
+
+#include <SQLiteCpp/Assertion.h>
+#include <SQLiteCpp/Exception.h>
+
+#include <chrono>
+
+
+namespace SQLite
+{
+
+
+// Checked out connection handle, only made by the pool
+ConnectionPool::Connection::Connection(ConnectionPool& aPool, Database& aDatabase, const bool abWriter) noexcept : // nothrow
+    mpPool(&aPool),
+    mpDatabase(&aDatabase),
+    mbWriter(abWriter)
+{
+}
+
+// Move the checked out connection to a new handle, leaving the source empty
+ConnectionPool::Connection::Connection(Connection&& aOther) noexcept : // nothrow
+    mpPool(aOther.mpPool),
+    mpDatabase(aOther.mpDatabase),
+    mbWriter(aOther.mbWriter)
+{
+    aOther.mpPool = NULL;
+}
+
+// Give the connection back to the pool
+ConnectionPool::Connection::~Connection() noexcept // nothrow
+{
+    if (NULL != mpPool)
+    {
+        mpPool->release(*mpDatabase, mbWriter);
+    }
+}
+
+// Check out the writer and begin a transaction
+ConnectionPool::WriteTransaction::WriteTransaction(ConnectionPool& aPool, const int aTimeoutMs /* = -1 */) :
+    mWriter(aPool.acquireWriter(aTimeoutMs)),
+    mTransaction(mWriter.getDatabase())
+{
+}
+
+
+// Open the writer and the readers, and set each of them up
+ConnectionPool::ConnectionPool(const std::string& aFilename,
+                               const std::size_t  aReaderCount,
+                               const TSetup&      aSetup /* = TSetup() */,
+                               const std::size_t  aStatementCacheCapacity /* = 16 */,
+                               const int          aBusyTimeoutMs /* = 5000 */) :
+    mFilename(aFilename),
+    mbWriterIdle(true)
+{
+    if (0 == aReaderCount)
+    {
+        throw SQLite::Exception("ConnectionPool needs at least one reader.");
+    }
+
+    // The writer first creates the database and switches it to WAL, which is persistent in the database file
+    mWriter.reset(new Database(aFilename, OPEN_READWRITE|OPEN_CREATE|OPEN_NOMUTEX, aBusyTimeoutMs));
+    const std::string journalMode = mWriter->execAndGet("PRAGMA journal_mode=WAL").getString();
+    if ("wal" != journalMode)
+    {
+        throw SQLite::Exception("ConnectionPool cannot use the WAL journal mode (" + journalMode + ").");
+    }
+    mWriter->setStatementCacheCapacity(aStatementCacheCapacity);
+    if (aSetup)
+    {
+        aSetup(*mWriter);
+    }
+
+    mReaders.reserve(aReaderCount);
+    mIdleReaders.reserve(aReaderCount);
+    for (std::size_t i = 0; i < aReaderCount; ++i)
+    {
+        mReaders.push_back(std::unique_ptr<Database>(
+            new Database(aFilename, OPEN_READONLY|OPEN_NOMUTEX, aBusyTimeoutMs)));
+        Database& reader = *mReaders.back();
+        reader.setStatementCacheCapacity(aStatementCacheCapacity);
+        if (aSetup)
+        {
+            aSetup(reader);
+        }
+        mIdleReaders.push_back(&reader);
+    }
+}
+
+// Close all connections, which must all have been given back to the pool
+ConnectionPool::~ConnectionPool() noexcept // nothrow
+{
+    // Never throw an exception in a destructor :
+    SQLITECPP_ASSERT(mbWriterIdle && (mIdleReaders.size() == mReaders.size()),
+                     "connections still checked out");  // See SQLITECPP_ENABLE_ASSERT_HANDLER
+
+    // Close the readers first, so that the writer, closing last, can checkpoint and remove the WAL
+    mReaders.clear();
+    mWriter.reset();
+}
+
+// Check out an idle read-only connection, waiting for one if needed
+ConnectionPool::Connection ConnectionPool::acquireReader(const int aTimeoutMs /* = -1 */)
+{
+    std::unique_lock<std::mutex> lock(mMutex);
+    if (aTimeoutMs < 0)
+    {
+        mReaderIdle.wait(lock, [this] { return false == mIdleReaders.empty(); });
+    }
+    else if (false == mReaderIdle.wait_for(lock, std::chrono::milliseconds(aTimeoutMs),
+                                           [this] { return false == mIdleReaders.empty(); }))
+    {
+        throw SQLite::Exception("Timeout waiting for a reader connection.");
+    }
+
+    Database* pReader = mIdleReaders.back();
+    mIdleReaders.pop_back();
+    return Connection(*this, *pReader, false);
+}
+
+// Check out the writer connection, waiting for it if needed
+ConnectionPool::Connection ConnectionPool::acquireWriter(const int aTimeoutMs /* = -1 */)
+{
+    std::unique_lock<std::mutex> lock(mMutex);
+    if (aTimeoutMs < 0)
+    {
+        mWriterIdle.wait(lock, [this] { return mbWriterIdle; });
+    }
+    else if (false == mWriterIdle.wait_for(lock, std::chrono::milliseconds(aTimeoutMs),
+                                           [this] { return mbWriterIdle; }))
+    {
+        throw SQLite::Exception("Timeout waiting for the writer connection.");
+    }
+
+    mbWriterIdle = false;
+    return Connection(*this, *mWriter, true);
+}
+
+// Return the number of read-only connections currently idle
+std::size_t ConnectionPool::getIdleReaderCount() const
+{
+    std::lock_guard<std::mutex> lock(mMutex);
+    return mIdleReaders.size();
+}
+
+// Give a connection back to the pool, and wake up a waiting thread
+void ConnectionPool::release(Database& aDatabase, const bool abWriter) noexcept // nothrow
+{
+    {
+        std::lock_guard<std::mutex> lock(mMutex);
+        if (abWriter)
+        {
+            mbWriterIdle = true;
+        }
+        else
+        {
+            // Cannot throw: capacity was reserved for all the readers
+            mIdleReaders.push_back(&aDatabase);
+        }
+    }
+    if (abWriter)
+    {
+        mWriterIdle.notify_one();
+    }
+    else
+    {
+        mReaderIdle.notify_one();
+    }
+}
+
+
+}  // namespace SQLite
@@ -11,11 +11,14 @@
 #include <SQLiteCpp/Database.h>
 
 #include <SQLiteCpp/Statement.h>
+#include <SQLiteCpp/Profiler.h>
 #include <SQLiteCpp/Assertion.h>
 #include <SQLiteCpp/Exception.h>
 
 #include <sqlite3.h>
 
+#include <chrono>
+
 #ifndef SQLITE_DETERMINISTIC
 #define SQLITE_DETERMINISTIC 0x800
 #endif // SQLITE_DETERMINISTIC
@@ -29,6 +32,7 @@ const int   OPEN_READWRITE  = SQLITE_OPEN_READWRITE;
 const int   OPEN_CREATE     = SQLITE_OPEN_CREATE;
 const int   OPEN_URI        = SQLITE_OPEN_URI;
 const int   OPEN_MEMORY     = SQLITE_OPEN_MEMORY;
+const int   OPEN_NOMUTEX    = SQLITE_OPEN_NOMUTEX;
 
 const int   OK              = SQLITE_OK;
 
@@ -54,7 +58,8 @@ Database::Database(const char* apFilename,
                    const int   aBusyTimeoutMs /* = 0 */,
                    const char* apVfs          /* = NULL*/) :
     mpSQLite(NULL),
-    mFilename(apFilename)
+    mFilename(apFilename),
+    mpProfiler(NULL)
 {
     const int ret = sqlite3_open_v2(apFilename, &mpSQLite, aFlags, apVfs);
     if (SQLITE_OK != ret)
@@ -76,7 +81,8 @@ Database::Database(const std::string& aFilename,
                    const int          aBusyTimeoutMs /* = 0 */,
                    const std::string& aVfs           /* = "" */) :
     mpSQLite(NULL),
-    mFilename(aFilename)
+    mFilename(aFilename),
+    mpProfiler(NULL)
 {
     const int ret = sqlite3_open_v2(aFilename.c_str(), &mpSQLite, aFlags, aVfs.empty() ? NULL : aVfs.c_str());
     if (SQLITE_OK != ret)
@@ -95,6 +101,9 @@ Database::Database(const std::string& aFilename,
 // Close the SQLite database connection.
 Database::~Database() noexcept // nothrow
 {
+    // Idle cached statements would keep the connection busy
+    mStatementCache.clear();
+
     const int ret = sqlite3_close(mpSQLite);
 
     // Avoid unreferenced variable warning when build in release mode
@@ -127,7 +136,20 @@ void Database::setBusyTimeout(const int aBusyTimeoutMs) noexcept // nothrow
 // Shortcut to execute one or multiple SQL statements without results (UPDATE, INSERT, ALTER, COMMIT, CREATE...).
 int Database::exec(const char* apQueries)
 {
+    std::chrono::steady_clock::time_point start;
+    if (NULL != mpProfiler)
+    {
+        start = std::chrono::steady_clock::now();
+    }
     const int ret = sqlite3_exec(mpSQLite, apQueries, NULL, NULL, NULL);
+    if (NULL != mpProfiler)
+    {
+        // Profiled as a single execution, without the counters of the statements run by sqlite3_exec()
+        Profiler::Execution execution = Profiler::Execution();
+        execution.mDurationNs = std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - start).count();
+        execution.mbError = (SQLITE_OK != ret);
+        mpProfiler->record(Profiler::normalize(apQueries), execution);
+    }
     check(ret);
 
     // Return the number of rows modified by those SQL statements (INSERT, UPDATE or DELETE only)
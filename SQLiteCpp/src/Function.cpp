@@ -0,0 +1,161 @@
+/**
+ * @file    Function.cpp
+ * @ingroup SQLiteCpp
+ * @brief   Typed registration of SQL scalar functions and aggregates, with Database::function() and Database::aggregate().
+ *
+ * Copyright (c) 2012-2016 Sebastien Rombauts (sebastien.rombauts@gmail.com)
+ *
+ * Distributed under the MIT License (MIT) (See accompanying file LICENSE.txt
+ * or copy at http://opensource.org/licenses/MIT)
+ */
+#include <SQLiteCpp/Function.h>
+
+#if (__cplusplus >= 201402L) || ( defined(_MSC_VER) && (_MSC_VER >= 1900) ) // c++14: Visual Studio 2015
+
+#include <SQLiteCpp/Exception.h>
+
+#include <sqlite3.h>
+
+#include <exception>
+#include <new>
+
+
+namespace SQLite
+{
+namespace detail
+{
+
+
+// Return the type of an argument
+int getArgumentType(sqlite3_value* apValue) noexcept // nothrow
+{
+    return sqlite3_value_type(apValue);
+}
+
+// Return an argument converted to an integer
+long long getArgumentInt64(sqlite3_value* apValue) noexcept // nothrow
+{
+    return sqlite3_value_int64(apValue);
+}
+
+// Return an argument converted to a floating point value
+double getArgumentDouble(sqlite3_value* apValue) noexcept // nothrow
+{
+    return sqlite3_value_double(apValue);
+}
+
+// Return the bytes of a blob argument, or of an argument converted to text
+const char* getArgumentBytes(sqlite3_value* apValue, std::size_t& aSize) noexcept // nothrow
+{
+    const int type = sqlite3_value_type(apValue);
+    if (SQLITE_NULL == type)
+    {
+        aSize = 0;
+        return NULL;
+    }
+    // The bytes must be read before their size, which would otherwise be the size of another representation
+    const char* pBytes = (SQLITE_BLOB == type) ? static_cast<const char*>(sqlite3_value_blob(apValue))
+                                               : reinterpret_cast<const char*>(sqlite3_value_text(apValue));
+    aSize = static_cast<std::size_t>(sqlite3_value_bytes(apValue));
+    return (NULL != pBytes) ? pBytes : ""; // An empty blob has no bytes
+}
+
+// Return an argument converted to a NUL-terminated text, or NULL for a NULL argument
+const char* getArgumentText(sqlite3_value* apValue) noexcept // nothrow
+{
+    // Unlike sqlite3_value_blob(), sqlite3_value_text() converts a blob to a text terminated by a NUL character
+    return reinterpret_cast<const char*>(sqlite3_value_text(apValue));
+}
+
+// Set a NULL result
+void setResultNull(sqlite3_context* apContext) noexcept // nothrow
+{
+    sqlite3_result_null(apContext);
+}
+
+// Set an integer result
+void setResultInt64(sqlite3_context* apContext, const long long aValue) noexcept // nothrow
+{
+    sqlite3_result_int64(apContext, aValue);
+}
+
+// Set a floating point result
+void setResultDouble(sqlite3_context* apContext, const double aValue) noexcept // nothrow
+{
+    sqlite3_result_double(apContext, aValue);
+}
+
+// Set a text result, copied by SQLite
+void setResultText(sqlite3_context* apContext, const char* apValue, const std::size_t aSize) noexcept // nothrow
+{
+    sqlite3_result_text64(apContext, apValue, static_cast<sqlite3_uint64>(aSize), SQLITE_TRANSIENT, SQLITE_UTF8);
+}
+
+// Report the exception being handled as the error of the function
+void setResultException(sqlite3_context* apContext) noexcept // nothrow
+{
+    try
+    {
+        throw;
+    }
+    catch (std::bad_alloc&)
+    {
+        sqlite3_result_error_nomem(apContext);
+    }
+    catch (std::exception& e)
+    {
+        sqlite3_result_error(apContext, e.what(), -1);
+    }
+    catch (...)
+    {
+        sqlite3_result_error(apContext, "unknown exception in a SQL function", -1);
+    }
+}
+
+// Return the function object registered with the SQL function
+void* getUserData(sqlite3_context* apContext) noexcept // nothrow
+{
+    return sqlite3_user_data(apContext);
+}
+
+// Return the zero-initialized state of the current aggregate
+void* getAggregateContext(sqlite3_context* apContext, const std::size_t aSize) noexcept // nothrow
+{
+    return sqlite3_aggregate_context(apContext, static_cast<int>(aSize));
+}
+
+// Register an aggregate, as a window function if it has an inverse and the SQLite library supports them
+void createAggregate(Database&  aDatabase,
+                     const char* apName,
+                     const int  aNbArg,
+                     const bool abDeterministic,
+                     void     (*apStep)(sqlite3_context*, int, sqlite3_value**),
+                     void     (*apFinal)(sqlite3_context*),
+                     void     (*apValue)(sqlite3_context*),
+                     void     (*apInverse)(sqlite3_context*, int, sqlite3_value**))
+{
+#if SQLITE_VERSION_NUMBER >= 3025000
+    if (NULL != apInverse)
+    {
+        const int flags = abDeterministic ? (SQLITE_UTF8|SQLITE_DETERMINISTIC) : SQLITE_UTF8;
+        const int ret = sqlite3_create_window_function(aDatabase.getHandle(), apName, aNbArg, flags, NULL,
+                                                       apStep, apFinal, apValue, apInverse, NULL);
+        if (SQLITE_OK != ret)
+        {
+            throw SQLite::Exception(aDatabase.getHandle(), ret);
+        }
+        return;
+    }
+#else
+    // Window functions are not supported by this version of SQLite
+    (void)apValue;
+    (void)apInverse;
+#endif
+    aDatabase.createFunction(apName, aNbArg, abDeterministic, NULL, NULL, apStep, apFinal, NULL);
+}
+
+
+}  // namespace detail
+}  // namespace SQLite
+
+#endif // c++14
@@ -0,0 +1,337 @@
+/**
+ * @file    Maintenance.cpp
+ * @ingroup SQLiteCpp
+ * @brief   Background maintenance of a WAL database: checkpoints triggered by the WAL size, incremental vacuum and optimize.
+ *
+ * Copyright (c) 2012-2016 Sebastien Rombauts (sebastien.rombauts@gmail.com)
+ *
+ * Distributed under the MIT License (MIT) (See accompanying file LICENSE.txt
+ * or copy at http://opensource.org/licenses/MIT)
+ */
+#include <SQLiteCpp/Maintenance.h>
+
+#include <SQLiteCpp/Exception.h>
+
+#include <sqlite3.h>
+
+#include <algorithm>
+
+
+namespace SQLite
+{
+
+const int CHECKPOINT_PASSIVE    = SQLITE_CHECKPOINT_PASSIVE;
+const int CHECKPOINT_FULL       = SQLITE_CHECKPOINT_FULL;
+const int CHECKPOINT_RESTART    = SQLITE_CHECKPOINT_RESTART;
+const int CHECKPOINT_TRUNCATE   = SQLITE_CHECKPOINT_TRUNCATE;
+
+
+// Open the background connection, and start the maintenance thread
+Maintenance::Maintenance(const std::string& aFilename, const int aBusyTimeoutMs /* = 1000 */) :
+    mDatabase(aFilename, OPEN_READWRITE, aBusyTimeoutMs),
+    mPageSize(0),
+    mbStopping(false),
+    mbCheckpointRequested(false),
+    mbScheduleChanged(false),
+    mPassiveFrames(1000),
+    mRestartFrames(10000),
+    mTruncateFrames(100000),
+    mCheckpointIntervalMs(10000),
+    mVacuumPages(0),
+    mVacuumIntervalMs(0),
+    mOptimizeIntervalMs(0),
+    mMetrics()
+{
+    if (mDatabase.execAndGet("PRAGMA journal_mode").getString() != "wal")
+    {
+        throw SQLite::Exception("Maintenance requires a database in WAL mode.");
+    }
+    mPageSize = mDatabase.execAndGet("PRAGMA page_size").getInt64();
+
+    mNextCheckpoint = std::chrono::steady_clock::now() + std::chrono::milliseconds(mCheckpointIntervalMs);
+    mThread = std::thread(&Maintenance::loop, this);
+}
+
+// Stop the maintenance thread
+Maintenance::~Maintenance() noexcept // nothrow
+{
+    {
+        std::lock_guard<std::mutex> lock(mMutex);
+        mbStopping = true;
+    }
+    mWakeUp.notify_all();
+    mThread.join();
+}
+
+// Replace the automatic checkpoint of a connection by the WAL hook
+void Maintenance::watch(Database& aDatabase)
+{
+    sqlite3_wal_hook(aDatabase.getHandle(), &Maintenance::walHook, this);
+}
+
+// Restore the automatic checkpoint of a connection
+void Maintenance::unwatch(Database& aDatabase)
+{
+    sqlite3_wal_autocheckpoint(aDatabase.getHandle(), 1000); // SQLITE_DEFAULT_WAL_AUTOCHECKPOINT is private to sqlite3.c
+}
+
+// Set the WAL sizes triggering each checkpoint mode
+void Maintenance::setCheckpointThresholds(const int aPassiveFrames, const int aRestartFrames, const int aTruncateFrames)
+{
+    std::lock_guard<std::mutex> lock(mMutex);
+    mPassiveFrames = std::max(aPassiveFrames, 1);
+    mRestartFrames = std::max(aRestartFrames, 0);
+    mTruncateFrames = std::max(aTruncateFrames, 0);
+}
+
+// Set the interval between two checkpoints run without WAL hook
+void Maintenance::setCheckpointInterval(const int aIntervalMs)
+{
+    {
+        std::lock_guard<std::mutex> lock(mMutex);
+        mCheckpointIntervalMs = std::max(aIntervalMs, 0);
+        mNextCheckpoint = std::chrono::steady_clock::now() + std::chrono::milliseconds(mCheckpointIntervalMs);
+        mbScheduleChanged = true;
+    }
+    mWakeUp.notify_all();
+}
+
+// Set the incremental vacuum steps
+void Maintenance::setIncrementalVacuum(const int aPages, const int aIntervalMs)
+{
+    {
+        std::lock_guard<std::mutex> lock(mMutex);
+        mVacuumPages = std::max(aPages, 0);
+        mVacuumIntervalMs = std::max(aIntervalMs, 0);
+        mNextVacuum = std::chrono::steady_clock::now() + std::chrono::milliseconds(mVacuumIntervalMs);
+        mbScheduleChanged = true;
+    }
+    mWakeUp.notify_all();
+}
+
+// Set the interval between two optimize runs
+void Maintenance::setOptimizeInterval(const int aIntervalMs)
+{
+    {
+        std::lock_guard<std::mutex> lock(mMutex);
+        mOptimizeIntervalMs = std::max(aIntervalMs, 0);
+        mNextOptimize = std::chrono::steady_clock::now() + std::chrono::milliseconds(mOptimizeIntervalMs);
+        mbScheduleChanged = true;
+    }
+    mWakeUp.notify_all();
+}
+
+// Run a checkpoint on the background connection
+bool Maintenance::checkpoint(const int aMode)
+{
+    int walFrames = 0;
+    int checkpointedFrames = 0;
+    std::lock_guard<std::mutex> databaseLock(mDatabaseMutex);
+    const std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+    const int ret = sqlite3_wal_checkpoint_v2(mDatabase.getHandle(), NULL, aMode, &walFrames, &checkpointedFrames);
+    const double durationMs = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+    if ((SQLITE_OK != ret) && (SQLITE_BUSY != ret))
+    {
+        throw SQLite::Exception(mDatabase.getHandle(), ret);
+    }
+
+    std::lock_guard<std::mutex> lock(mMutex);
+    if (SQLITE_BUSY == ret)
+    {
+        ++mMetrics.mBusyCheckpointCount;
+    }
+    if (walFrames >= 0) // -1 if the connection is not in WAL mode
+    {
+        mMetrics.mWalFrames = walFrames;
+        mMetrics.mWalBytes = (walFrames > 0) ? (32 + walFrames * (24 + mPageSize)) : 0; // WAL header, then frames of a header and a page
+    }
+    if (checkpointedFrames > 0)
+    {
+        mMetrics.mCheckpointedFrames += checkpointedFrames;
+    }
+    ++mMetrics.mCheckpointCount;
+    mMetrics.mLastCheckpointMs = durationMs;
+    mMetrics.mMaxCheckpointMs = std::max(mMetrics.mMaxCheckpointMs, durationMs);
+    mMetrics.mTotalCheckpointMs += durationMs;
+    return (SQLITE_OK == ret);
+}
+
+// Free unused pages
+int Maintenance::incrementalVacuum(const int aPages)
+{
+    std::lock_guard<std::mutex> databaseLock(mDatabaseMutex);
+    const int freePages = mDatabase.execAndGet("PRAGMA freelist_count").getInt();
+    if (freePages > 0)
+    {
+        // A zero or negative number of pages frees all of them
+        mDatabase.exec("PRAGMA incremental_vacuum(" + std::to_string(aPages) + ")");
+    }
+    const int vacuumedPages = freePages - mDatabase.execAndGet("PRAGMA freelist_count").getInt();
+
+    std::lock_guard<std::mutex> lock(mMutex);
+    mMetrics.mVacuumedPages += vacuumedPages;
+    return vacuumedPages;
+}
+
+// Refresh the statistics of the query planner
+void Maintenance::optimize()
+{
+    {
+        std::lock_guard<std::mutex> databaseLock(mDatabaseMutex);
+        if (getLibVersionNumber() >= 3018000)
+        {
+            mDatabase.exec("PRAGMA optimize");
+        }
+        else
+        {
+            mDatabase.exec("ANALYZE");
+        }
+    }
+
+    std::lock_guard<std::mutex> lock(mMutex);
+    ++mMetrics.mOptimizeCount;
+}
+
+// Return the metrics of the maintenance service
+Maintenance::Metrics Maintenance::getMetrics() const
+{
+    std::lock_guard<std::mutex> lock(mMutex);
+    return mMetrics;
+}
+
+// WAL hook of the watched connections, called after each commit with the size of the WAL
+int Maintenance::walHook(void* apMaintenance, sqlite3* /* apSQLite */, const char* /* apDatabaseName */, int aFrames)
+{
+    Maintenance& maintenance = *static_cast<Maintenance*>(apMaintenance);
+    bool bWakeUp = false;
+    {
+        std::lock_guard<std::mutex> lock(maintenance.mMutex);
+        maintenance.mMetrics.mWalFrames = aFrames;
+        maintenance.mMetrics.mWalBytes = 32 + aFrames * (24 + maintenance.mPageSize);
+        if ((aFrames >= maintenance.mPassiveFrames) && (false == maintenance.mbCheckpointRequested))
+        {
+            maintenance.mbCheckpointRequested = true;
+            bWakeUp = true;
+        }
+    }
+    if (bWakeUp)
+    {
+        maintenance.mWakeUp.notify_all();
+    }
+    return SQLITE_OK;
+}
+
+// Run a PASSIVE checkpoint, escalated to RESTART or TRUNCATE if the WAL is still too large
+void Maintenance::checkpointByPolicy()
+{
+    checkpoint(CHECKPOINT_PASSIVE);
+
+    int walFrames = 0;
+    int restartFrames = 0;
+    int truncateFrames = 0;
+    {
+        std::lock_guard<std::mutex> lock(mMutex);
+        walFrames = mMetrics.mWalFrames;
+        restartFrames = mRestartFrames;
+        truncateFrames = mTruncateFrames;
+    }
+    if ((truncateFrames > 0) && (walFrames >= truncateFrames))
+    {
+        checkpoint(CHECKPOINT_TRUNCATE);
+    }
+    else if ((restartFrames > 0) && (walFrames >= restartFrames))
+    {
+        checkpoint(CHECKPOINT_RESTART);
+    }
+}
+
+// Loop of the maintenance thread: wait for the WAL hook or the next scheduled operation
+void Maintenance::loop() noexcept // nothrow
+{
+    std::unique_lock<std::mutex> lock(mMutex);
+    while (false == mbStopping)
+    {
+        // Wait for the earliest scheduled operation, or for at most a minute
+        std::chrono::steady_clock::time_point wakeUp = std::chrono::steady_clock::now() + std::chrono::minutes(1);
+        if (mCheckpointIntervalMs > 0)
+        {
+            wakeUp = std::min(wakeUp, mNextCheckpoint);
+        }
+        if (mVacuumIntervalMs > 0)
+        {
+            wakeUp = std::min(wakeUp, mNextVacuum);
+        }
+        if (mOptimizeIntervalMs > 0)
+        {
+            wakeUp = std::min(wakeUp, mNextOptimize);
+        }
+        // The predicate catches the requests made while the operations were running without the lock
+        mWakeUp.wait_until(lock, wakeUp, [this] { return mbStopping || mbCheckpointRequested || mbScheduleChanged; });
+        if (mbStopping)
+        {
+            break;
+        }
+        mbScheduleChanged = false;
+
+        const std::chrono::steady_clock::time_point now = std::chrono::steady_clock::now();
+        const bool bCheckpoint = mbCheckpointRequested || ((mCheckpointIntervalMs > 0) && (now >= mNextCheckpoint));
+        const bool bVacuum = (mVacuumIntervalMs > 0) && (now >= mNextVacuum);
+        const bool bOptimize = (mOptimizeIntervalMs > 0) && (now >= mNextOptimize);
+        const int vacuumPages = mVacuumPages;
+        mbCheckpointRequested = false;
+        if (bCheckpoint)
+        {
+            mNextCheckpoint = now + std::chrono::milliseconds(mCheckpointIntervalMs);
+        }
+        if (bVacuum)
+        {
+            mNextVacuum = now + std::chrono::milliseconds(mVacuumIntervalMs);
+        }
+        if (bOptimize)
+        {
+            mNextOptimize = now + std::chrono::milliseconds(mOptimizeIntervalMs);
+        }
+
+        // Run the operations without holding the lock, so that the WAL hook never waits for them
+        lock.unlock();
+        unsigned int errors = 0;
+        if (bCheckpoint)
+        {
+            try
+            {
+                checkpointByPolicy();
+            }
+            catch (SQLite::Exception&)
+            {
+                ++errors;
+            }
+        }
+        if (bVacuum)
+        {
+            try
+            {
+                incrementalVacuum(vacuumPages);
+            }
+            catch (SQLite::Exception&)
+            {
+                ++errors;
+            }
+        }
+        if (bOptimize)
+        {
+            try
+            {
+                optimize();
+            }
+            catch (SQLite::Exception&)
+            {
+                ++errors;
+            }
+        }
+        lock.lock();
+        mMetrics.mErrorCount += errors;
+    }
+}
+
+
+}  // namespace SQLite
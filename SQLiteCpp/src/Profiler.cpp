@@ -0,0 +1,371 @@
+/**
+ * @file    Profiler.cpp
+ * @ingroup SQLiteCpp
+ * @brief   Execution profile of the statements of one or more Database Connections, aggregated by normalized SQL query.
+ *
+ * Copyright (c) 2012-2016 Sebastien Rombauts (sebastien.rombauts@gmail.com)
+ *
+ * Distributed under the MIT License (MIT) (See accompanying file LICENSE.txt
+ * or copy at http://opensource.org/licenses/MIT)
+ */
+#include <SQLiteCpp/Profiler.h>
+
+#include <algorithm>
+#include <cstring>
+#include <iomanip>
+
+
+namespace SQLite
+{
+
+const int Profiler::HISTOGRAM_BUCKETS;
+
+
+/// Return true for the characters of an identifier or of a keyword
+static bool isNameChar(const char aChar)
+{
+    return ((aChar >= 'a') && (aChar <= 'z')) || ((aChar >= 'A') && (aChar <= 'Z'))
+        || ((aChar >= '0') && (aChar <= '9')) || (aChar == '_') || (static_cast<unsigned char>(aChar) >= 0x80);
+}
+
+/// Return true for a decimal digit
+static bool isDigit(const char aChar)
+{
+    return (aChar >= '0') && (aChar <= '9');
+}
+
+/// Return the index of the histogram bucket of a latency
+static int getBucket(const long long aDurationNs)
+{
+    long long us = aDurationNs / 1000;
+    int bucket = 0;
+    while ((us > 0) && (bucket < Profiler::HISTOGRAM_BUCKETS - 1))
+    {
+        us >>= 1;
+        ++bucket;
+    }
+    return bucket;
+}
+
+/// Order the statistics by decreasing total latency
+static bool isSlower(const Profiler::Stats& aLeft, const Profiler::Stats& aRight)
+{
+    return aLeft.mTotalNs > aRight.mTotalNs;
+}
+
+/// Select all the statistics
+static bool isAny(const Profiler::Stats& /* aStats */)
+{
+    return true;
+}
+
+/// Select the statistics of the queries which have built automatic indexes
+static bool hasAutoIndexes(const Profiler::Stats& aStats)
+{
+    return aStats.mAutoIndexes > 0;
+}
+
+
+// Return an upper bound of a percentile of the latency, from the histogram
+long long Profiler::Stats::getPercentileNs(const double aPercentile) const noexcept // nothrow
+{
+    const double rank = static_cast<double>(mExecutions) * std::min(std::max(aPercentile, 0.0), 100.0) / 100.0;
+    unsigned long long count = 0;
+    for (int bucket = 0; bucket < HISTOGRAM_BUCKETS - 1; ++bucket)
+    {
+        count += mHistogram[bucket];
+        if ((count > 0) && (static_cast<double>(count) >= rank))
+        {
+            return std::min((1LL << bucket) * 1000, mMaxNs);
+        }
+    }
+    return mMaxNs;
+}
+
+
+// Create an empty profile
+Profiler::Profiler()
+{
+}
+
+// Set a handler called the first time a query builds an automatic index
+void Profiler::setAutoIndexHandler(const TAutoIndexHandler& aHandler)
+{
+    std::lock_guard<std::mutex> lock(mMutex);
+    mAutoIndexHandler = aHandler;
+}
+
+// Return the statistics of all queries, the largest total latency first
+std::vector<Profiler::Stats> Profiler::getStats() const
+{
+    return getStatsIf(&isAny);
+}
+
+// Return the statistics of the queries which have built automatic indexes, the largest total latency first
+std::vector<Profiler::Stats> Profiler::getAutoIndexStats() const
+{
+    return getStatsIf(&hasAutoIndexes);
+}
+
+// Write the statistics of all queries as a table, the largest total latency first
+void Profiler::dump(std::ostream& aStream) const
+{
+    const std::vector<Stats> stats = getStats();
+
+    const std::ios_base::fmtflags flags = aStream.flags();
+    const std::streamsize precision = aStream.precision();
+    aStream << std::fixed << std::setprecision(3)
+            << std::setw(10) << "calls" << std::setw(12) << "total_ms" << std::setw(10) << "avg_ms"
+            << std::setw(10) << "p50_ms" << std::setw(10) << "p99_ms" << std::setw(10) << "max_ms"
+            << std::setw(12) << "rows" << std::setw(10) << "prepares" << std::setw(8) << "errors" << "  query\n";
+    for (std::vector<Stats>::const_iterator it = stats.begin(); it != stats.end(); ++it)
+    {
+        const double avgNs = (it->mExecutions > 0) ? (static_cast<double>(it->mTotalNs) / it->mExecutions) : 0.0;
+        aStream << std::setw(10) << it->mExecutions
+                << std::setw(12) << (it->mTotalNs / 1e6)
+                << std::setw(10) << (avgNs / 1e6)
+                << std::setw(10) << (it->getPercentileNs(50) / 1e6)
+                << std::setw(10) << (it->getPercentileNs(99) / 1e6)
+                << std::setw(10) << (it->mMaxNs / 1e6)
+                << std::setw(12) << it->mRows
+                << std::setw(10) << it->mPrepares
+                << std::setw(8) << it->mErrors
+                << "  " << it->mQuery;
+        if (it->mAutoIndexes > 0)
+        {
+            aStream << " [autoindex]";
+        }
+        if (it->mFullscanSteps > 0)
+        {
+            aStream << " [fullscan]";
+        }
+        aStream << "\n";
+    }
+    aStream.flags(flags);
+    aStream.precision(precision);
+}
+
+// Clear all statistics
+void Profiler::reset()
+{
+    std::lock_guard<std::mutex> lock(mMutex);
+    mStats.clear();
+}
+
+// Normalize a SQL query: replace its literals by "?", remove its comments and collapse its whitespace
+std::string Profiler::normalize(const std::string& aQuery)
+{
+    const std::size_t size = aQuery.size();
+    std::string normalized;
+    normalized.reserve(size);
+
+    bool bSpace = false; // whitespace or comment to collapse into a single space before the next token
+    std::size_t i = 0;
+    while (i < size)
+    {
+        const char c = aQuery[i];
+        const char next = (i + 1 < size) ? aQuery[i + 1] : '\0';
+        if ((c == ' ') || (c == '\t') || (c == '\n') || (c == '\r') || (c == '\f') || (c == '\v'))
+        {
+            bSpace = true;
+            ++i;
+            continue;
+        }
+        if ((c == '-') && (next == '-'))
+        {
+            while ((i < size) && (aQuery[i] != '\n'))
+            {
+                ++i;
+            }
+            bSpace = true;
+            continue;
+        }
+        if ((c == '/') && (next == '*'))
+        {
+            const std::size_t end = aQuery.find("*/", i + 2);
+            i = (std::string::npos == end) ? size : (end + 2);
+            bSpace = true;
+            continue;
+        }
+        if (bSpace && (false == normalized.empty()))
+        {
+            normalized += ' ';
+        }
+        bSpace = false;
+
+        const char previous = normalized.empty() ? ' ' : normalized[normalized.size() - 1];
+        if ((c == '\'') || (((c == 'x') || (c == 'X')) && (next == '\'')))
+        {
+            // String or blob literal, with '' as an escaped quote
+            i += (c == '\'') ? 1 : 2;
+            while (i < size)
+            {
+                if (aQuery[i] == '\'')
+                {
+                    if ((i + 1 < size) && (aQuery[i + 1] == '\''))
+                    {
+                        i += 2;
+                        continue;
+                    }
+                    ++i;
+                    break;
+                }
+                ++i;
+            }
+            normalized += '?';
+        }
+        else if ((c == '"') || (c == '`') || (c == '['))
+        {
+            // Quoted identifier, kept as is
+            const char quote = (c == '[') ? ']' : c;
+            const std::size_t end = aQuery.find(quote, i + 1);
+            const std::size_t stop = (std::string::npos == end) ? size : (end + 1);
+            normalized.append(aQuery, i, stop - i);
+            i = stop;
+        }
+        else if ((isDigit(c) || ((c == '.') && isDigit(next)))
+              && (false == isNameChar(previous)) && (previous != '?') && (previous != ':')
+              && (previous != '@') && (previous != '$'))
+        {
+            // Numeric literal: decimal, real with exponent, or hexadecimal
+            const bool bHex = (c == '0') && ((next == 'x') || (next == 'X'));
+            ++i;
+            while (i < size)
+            {
+                const char d = aQuery[i];
+                const char e = aQuery[i - 1];
+                if (isNameChar(d) || (d == '.')
+                 || (((d == '+') || (d == '-')) && (false == bHex) && ((e == 'e') || (e == 'E'))))
+                {
+                    ++i;
+                }
+                else
+                {
+                    break;
+                }
+            }
+            normalized += '?';
+        }
+        else if (isNameChar(c))
+        {
+            // Identifier, keyword or parameter name, kept as is, including its digits
+            const std::size_t start = i;
+            while ((i < size) && isNameChar(aQuery[i]))
+            {
+                ++i;
+            }
+            normalized.append(aQuery, start, i - start);
+        }
+        else
+        {
+            normalized += c;
+            ++i;
+        }
+    }
+    return normalized;
+}
+
+// Add an execution to the statistics of a normalized query
+void Profiler::record(const std::string& aQuery, const Execution& aExecution) noexcept // nothrow
+{
+    TAutoIndexHandler handler;
+    try
+    {
+        std::lock_guard<std::mutex> lock(mMutex);
+        Stats& stats = getStatsLocked(aQuery);
+        if ((aExecution.mAutoIndexes > 0) && (0 == stats.mAutoIndexes))
+        {
+            handler = mAutoIndexHandler;
+        }
+        ++stats.mExecutions;
+        if (aExecution.mbError)
+        {
+            ++stats.mErrors;
+        }
+        stats.mRows += aExecution.mRows;
+        stats.mFullscanSteps += aExecution.mFullscanSteps;
+        stats.mSorts += aExecution.mSorts;
+        stats.mAutoIndexes += aExecution.mAutoIndexes;
+        stats.mVmSteps += aExecution.mVmSteps;
+        stats.mTotalNs += aExecution.mDurationNs;
+        stats.mMaxNs = std::max(stats.mMaxNs, aExecution.mDurationNs);
+        ++stats.mHistogram[getBucket(aExecution.mDurationNs)];
+    }
+    catch (...)
+    {
+        // Out of memory: do not profile this execution
+    }
+
+    if (handler)
+    {
+        try
+        {
+            handler(aQuery);
+        }
+        catch (...)
+        {
+            // The statement reporting this execution cannot throw
+        }
+    }
+}
+
+// Count a statement prepared for a normalized query
+void Profiler::recordPrepare(const std::string& aQuery) noexcept // nothrow
+{
+    try
+    {
+        std::lock_guard<std::mutex> lock(mMutex);
+        ++getStatsLocked(aQuery).mPrepares;
+    }
+    catch (...)
+    {
+        // Out of memory: do not profile this statement
+    }
+}
+
+// Return the statistics of a normalized query, created empty if needed
+Profiler::Stats& Profiler::getStatsLocked(const std::string& aQuery)
+{
+    const TStats::iterator found = mStats.find(aQuery);
+    if (mStats.end() != found)
+    {
+        return found->second;
+    }
+
+    Stats stats;
+    std::memset(stats.mHistogram, 0, sizeof(stats.mHistogram));
+    stats.mQuery = aQuery;
+    stats.mExecutions = 0;
+    stats.mErrors = 0;
+    stats.mPrepares = 0;
+    stats.mRows = 0;
+    stats.mFullscanSteps = 0;
+    stats.mSorts = 0;
+    stats.mAutoIndexes = 0;
+    stats.mVmSteps = 0;
+    stats.mTotalNs = 0;
+    stats.mMaxNs = 0;
+    return mStats.insert(TStats::value_type(aQuery, stats)).first->second;
+}
+
+// Return the statistics selected by a predicate, the largest total latency first
+std::vector<Profiler::Stats> Profiler::getStatsIf(bool (*apPredicate)(const Stats&)) const
+{
+    std::vector<Stats> stats;
+    {
+        std::lock_guard<std::mutex> lock(mMutex);
+        stats.reserve(mStats.size());
+        for (TStats::const_iterator it = mStats.begin(); it != mStats.end(); ++it)
+        {
+            if (apPredicate(it->second))
+            {
+                stats.push_back(it->second);
+            }
+        }
+    }
+    std::sort(stats.begin(), stats.end(), &isSlower);
+    return stats;
+}
+
+
+}  // namespace SQLite
@@ -0,0 +1,353 @@
+/**
+ * @file    ShardSet.cpp
+ * @ingroup SQLiteCpp
+ * @brief   Set of database files sharing one schema, queried in parallel on a thread pool with merged results.
+ *
+ * Copyright (c) 2012-2016 Sebastien Rombauts (sebastien.rombauts@gmail.com)
+ *
+ * Distributed under the MIT License (MIT) (See accompanying file LICENSE.txt
+ * or copy at http://opensource.org/licenses/MIT)
+ */
+#include <SQLiteCpp/ShardSet.h>
+
+#include <SQLiteCpp/Exception.h>
+
+#include <exception>
+#include <limits>
+#include <map>
+
+
+namespace SQLite
+{
+
+
+// Return the rank of the type of a value in the SQLite order: NULL, numbers, text, blobs
+static int getTypeRank(const ShardSet::Value& aValue)
+{
+    if (SQLite::Null == aValue.mType)
+    {
+        return 0;
+    }
+    else if ((SQLite::INTEGER == aValue.mType) || (SQLite::FLOAT == aValue.mType))
+    {
+        return 1;
+    }
+    else if (SQLite::TEXT == aValue.mType)
+    {
+        return 2;
+    }
+    return 3;
+}
+
+// Compare two values in the SQLite order, with the BINARY collation for text
+static int compare(const ShardSet::Value& aLeft, const ShardSet::Value& aRight)
+{
+    const int leftRank = getTypeRank(aLeft);
+    const int rightRank = getTypeRank(aRight);
+    if (leftRank != rightRank)
+    {
+        return (leftRank < rightRank) ? -1 : 1;
+    }
+    if (1 == leftRank)
+    {
+        if ((SQLite::INTEGER == aLeft.mType) && (SQLite::INTEGER == aRight.mType))
+        {
+            return (aLeft.mInteger < aRight.mInteger) ? -1 : ((aLeft.mInteger > aRight.mInteger) ? 1 : 0);
+        }
+        const double left = (SQLite::INTEGER == aLeft.mType) ? static_cast<double>(aLeft.mInteger) : aLeft.mFloat;
+        const double right = (SQLite::INTEGER == aRight.mType) ? static_cast<double>(aRight.mInteger) : aRight.mFloat;
+        return (left < right) ? -1 : ((left > right) ? 1 : 0);
+    }
+    if (0 == leftRank)
+    {
+        return 0;
+    }
+    return aLeft.mText.compare(aRight.mText); // char_traits<char> compares bytes as unsigned char, like memcmp()
+}
+
+// Order of the keys of the groups of aggregate()
+struct KeyLess
+{
+    bool operator()(const ShardSet::TRow& aLeft, const ShardSet::TRow& aRight) const
+    {
+        for (std::size_t i = 0; i < aLeft.size(); ++i)
+        {
+            const int comparison = compare(aLeft[i], aRight[i]);
+            if (0 != comparison)
+            {
+                return (comparison < 0);
+            }
+        }
+        return false;
+    }
+};
+
+// Combine the partial result of a shard into the result of the other shards
+static void combine(ShardSet::Value& aResult, const ShardSet::Value& aPartial, const ShardSet::Aggregate aAggregate)
+{
+    if ((ShardSet::KEY == aAggregate) || (SQLite::Null == aPartial.mType))
+    {
+        return;
+    }
+    if (SQLite::Null == aResult.mType)
+    {
+        aResult = aPartial;
+    }
+    else if ((ShardSet::COUNT == aAggregate) || (ShardSet::SUM == aAggregate))
+    {
+        if ((SQLite::INTEGER == aResult.mType) && (SQLite::INTEGER == aPartial.mType))
+        {
+            if (((aPartial.mInteger > 0) && (aResult.mInteger > std::numeric_limits<long long>::max() - aPartial.mInteger))
+             || ((aPartial.mInteger < 0) && (aResult.mInteger < std::numeric_limits<long long>::min() - aPartial.mInteger)))
+            {
+                throw SQLite::Exception("integer overflow");
+            }
+            aResult.mInteger += aPartial.mInteger;
+        }
+        else
+        {
+            // Like sum(), a sum with a non-integer value is a floating point value
+            const double result = (SQLite::INTEGER == aResult.mType) ? static_cast<double>(aResult.mInteger) : aResult.mFloat;
+            const double partial = (SQLite::INTEGER == aPartial.mType) ? static_cast<double>(aPartial.mInteger) : aPartial.mFloat;
+            aResult.mType = SQLite::FLOAT;
+            aResult.mFloat = result + partial;
+        }
+    }
+    else
+    {
+        const int comparison = compare(aPartial, aResult);
+        if (((ShardSet::MIN == aAggregate) && (comparison < 0)) || ((ShardSet::MAX == aAggregate) && (comparison > 0)))
+        {
+            aResult = aPartial;
+        }
+    }
+}
+
+
+// Open all the shards, and start the thread pool
+ShardSet::ShardSet(const std::vector<std::string>& aFilenames,
+                   const int                       aFlags /* = SQLite::OPEN_READONLY */,
+                   const std::size_t               aThreadCount /* = 0 */,
+                   const TSetup&                   aSetup /* = TSetup() */,
+                   const std::size_t               aStatementCacheCapacity /* = 16 */) :
+    mbStopping(false)
+{
+    if (aFilenames.empty())
+    {
+        throw SQLite::Exception("ShardSet needs at least one shard.");
+    }
+    mShards.reserve(aFilenames.size());
+    for (std::size_t i = 0; i < aFilenames.size(); ++i)
+    {
+        mShards.push_back(std::unique_ptr<Shard>(new Shard(aFilenames[i], aFlags)));
+        Database& database = mShards.back()->mDatabase;
+        database.setStatementCacheCapacity(aStatementCacheCapacity);
+        if (aSetup)
+        {
+            aSetup(database);
+        }
+    }
+
+    std::size_t threadCount = (0 != aThreadCount) ? aThreadCount : std::thread::hardware_concurrency();
+    threadCount = std::max(static_cast<std::size_t>(1), std::min(threadCount, mShards.size()));
+    mThreads.reserve(threadCount);
+    try
+    {
+        for (std::size_t i = 0; i < threadCount; ++i)
+        {
+            mThreads.push_back(std::thread(&ShardSet::loop, this));
+        }
+    }
+    catch (...)
+    {
+        {
+            std::lock_guard<std::mutex> lock(mMutex);
+            mbStopping = true;
+        }
+        mTaskQueued.notify_all();
+        for (std::size_t i = 0; i < mThreads.size(); ++i)
+        {
+            mThreads[i].join();
+        }
+        throw;
+    }
+}
+
+// Stop the thread pool, and close all the shards
+ShardSet::~ShardSet() noexcept // nothrow
+{
+    {
+        std::lock_guard<std::mutex> lock(mMutex);
+        mbStopping = true;
+    }
+    mTaskQueued.notify_all();
+    for (std::size_t i = 0; i < mThreads.size(); ++i)
+    {
+        mThreads[i].join();
+    }
+}
+
+// Execute an aggregate query on each selected shard, and combine their partial results
+std::vector<ShardSet::TRow> ShardSet::aggregate(const std::string& aQuery, const std::vector<Aggregate>& aColumns,
+                                                const TShards& aShards /* = TShards() */, const TBind& aBind /* = TBind() */)
+{
+    const auto read = [&aColumns](Statement& aStatement)
+    {
+        if (static_cast<std::size_t>(aStatement.getColumnCount()) != aColumns.size())
+        {
+            throw SQLite::Exception("The aggregate columns do not match the columns of the query.");
+        }
+        TRow row(aColumns.size());
+        for (std::size_t i = 0; i < row.size(); ++i)
+        {
+            const Column column = aStatement.getColumn(static_cast<int>(i));
+            Value& value = row[i];
+            value.mType = column.getType();
+            value.mInteger = 0;
+            value.mFloat = 0.0;
+            if (SQLite::INTEGER == value.mType)
+            {
+                value.mInteger = column.getInt64();
+            }
+            else if (SQLite::FLOAT == value.mType)
+            {
+                value.mFloat = column.getDouble();
+            }
+            else if (SQLite::Null != value.mType)
+            {
+                value.mText = column.getString();
+            }
+        }
+        return row;
+    };
+    const std::vector<std::vector<TRow> > parts = readAll(aQuery, read, 0, aShards, aBind);
+
+    // Combine the rows of the shards by their keys, in the order of the keys
+    typedef std::map<TRow, TRow, KeyLess> TGroups;
+    TGroups groups;
+    for (std::size_t shard = 0; shard < parts.size(); ++shard)
+    {
+        for (std::size_t r = 0; r < parts[shard].size(); ++r)
+        {
+            const TRow& row = parts[shard][r];
+            TRow key;
+            for (std::size_t i = 0; i < aColumns.size(); ++i)
+            {
+                if (KEY == aColumns[i])
+                {
+                    key.push_back(row[i]);
+                }
+            }
+            const std::pair<TGroups::iterator, bool> inserted = groups.insert(std::make_pair(key, row));
+            if (false == inserted.second)
+            {
+                TRow& result = inserted.first->second;
+                for (std::size_t i = 0; i < aColumns.size(); ++i)
+                {
+                    combine(result[i], row[i], aColumns[i]);
+                }
+            }
+        }
+    }
+
+    std::vector<TRow> rows;
+    rows.reserve(groups.size());
+    for (TGroups::iterator it = groups.begin(); it != groups.end(); ++it)
+    {
+        rows.push_back(std::move(it->second));
+    }
+    return rows;
+}
+
+// Return the selected shards, or all of them, checking their indexes
+ShardSet::TShards ShardSet::select(const TShards& aShards) const
+{
+    if (aShards.empty())
+    {
+        TShards shards(mShards.size());
+        for (std::size_t i = 0; i < shards.size(); ++i)
+        {
+            shards[i] = i;
+        }
+        return shards;
+    }
+    for (std::size_t i = 0; i < aShards.size(); ++i)
+    {
+        if (aShards[i] >= mShards.size())
+        {
+            throw SQLite::Exception("Shard index out of range.");
+        }
+    }
+    return aShards;
+}
+
+// Call a function on each selected shard on the thread pool, wait for all, and rethrow the first exception
+void ShardSet::run(const TShards& aShards, const std::function<void (std::size_t aIndex, Database& aDatabase)>& aFunction)
+{
+    // State of the call, shared by its tasks: the call waits for all of them, as they refer to its arguments
+    std::mutex mutex;
+    std::condition_variable completed;
+    std::size_t remaining = aShards.size();
+    std::vector<std::exception_ptr> exceptions(aShards.size());
+
+    {
+        std::lock_guard<std::mutex> lock(mMutex);
+        for (std::size_t i = 0; i < aShards.size(); ++i)
+        {
+            Shard& shard = *mShards[aShards[i]];
+            mTasks.push_back([&, i]()
+            {
+                try
+                {
+                    std::lock_guard<std::mutex> shardLock(shard.mMutex);
+                    aFunction(i, shard.mDatabase);
+                }
+                catch (...)
+                {
+                    exceptions[i] = std::current_exception();
+                }
+                std::lock_guard<std::mutex> callLock(mutex);
+                if (0 == --remaining)
+                {
+                    completed.notify_one();
+                }
+            });
+        }
+    }
+    mTaskQueued.notify_all();
+
+    {
+        std::unique_lock<std::mutex> lock(mutex);
+        completed.wait(lock, [&remaining] { return (0 == remaining); });
+    }
+    for (std::size_t i = 0; i < exceptions.size(); ++i)
+    {
+        if (exceptions[i])
+        {
+            std::rethrow_exception(exceptions[i]);
+        }
+    }
+}
+
+// Loop of the threads of the pool: execute the queued tasks, until stopped
+void ShardSet::loop() noexcept // nothrow
+{
+    for (;;)
+    {
+        TTask task;
+        {
+            std::unique_lock<std::mutex> lock(mMutex);
+            mTaskQueued.wait(lock, [this] { return mbStopping || (false == mTasks.empty()); });
+            if (mbStopping)
+            {
+                return; // No call waits for the queued tasks once the ShardSet is destroyed
+            }
+            task = std::move(mTasks.front());
+            mTasks.pop_front();
+        }
+        task(); // catches the exceptions of the query
+    }
+}
+
+
+}  // namespace SQLite
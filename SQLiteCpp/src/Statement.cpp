@@ -12,46 +12,63 @@
 
 #include <SQLiteCpp/Database.h>
 #include <SQLiteCpp/Column.h>
+#include <SQLiteCpp/StatementCache.h>
+#include <SQLiteCpp/Profiler.h>
 #include <SQLiteCpp/Assertion.h>
 #include <SQLiteCpp/Exception.h>
 
 #include <sqlite3.h>
 
+#include <algorithm>
+#include <chrono>
+
 namespace SQLite
 {
 
 // Compile and register the SQL query for the provided SQLite Database Connection
 Statement::Statement(Database &aDatabase, const char* apQuery) :
     mQuery(apQuery),
-    mStmtPtr(aDatabase.mpSQLite, mQuery), // prepare the SQL query, and ref count (needs Database friendship)
+    mStmtPtr(aDatabase.mpSQLite, mQuery, aDatabase.getStatementCachePtr()), // prepare the SQL query, and ref count (needs Database friendship)
     mColumnCount(0),
     mbOk(false),
-    mbDone(false)
+    mbDone(false),
+    mpProfiler(aDatabase.mpProfiler),
+    mProfileNs(0),
+    mProfileRows(0),
+    mbProfiling(false)
 {
     mColumnCount = sqlite3_column_count(mStmtPtr);
+    initProfile();
 }
 
 // Compile and register the SQL query for the provided SQLite Database Connection
 Statement::Statement(Database &aDatabase, const std::string& aQuery) :
     mQuery(aQuery),
-    mStmtPtr(aDatabase.mpSQLite, mQuery), // prepare the SQL query, and ref count (needs Database friendship)
+    mStmtPtr(aDatabase.mpSQLite, mQuery, aDatabase.getStatementCachePtr()), // prepare the SQL query, and ref count (needs Database friendship)
     mColumnCount(0),
     mbOk(false),
-    mbDone(false)
+    mbDone(false),
+    mpProfiler(aDatabase.mpProfiler),
+    mProfileNs(0),
+    mProfileRows(0),
+    mbProfiling(false)
 {
     mColumnCount = sqlite3_column_count(mStmtPtr);
+    initProfile();
 }
 
 
 // Finalize and unregister the SQL query from the SQLite Database Connection.
 Statement::~Statement() noexcept // nothrow
 {
+    endProfile(false);
     // the finalization will be done by the destructor of the last shared pointer
 }
 
 // Reset the statement to make it ready for a new execution (see also #clearBindings() bellow)
 void Statement::reset()
 {
+    endProfile(false);
     mbOk = false;
     mbDone = false;
     const int ret = sqlite3_reset(mStmtPtr);
@@ -241,7 +258,7 @@ bool Statement::executeStep()
 {
     if (false == mbDone)
     {
-        const int ret = sqlite3_step(mStmtPtr);
+        const int ret = step();
         if (SQLITE_ROW == ret) // one row is ready : call getColumn(N) to access it
         {
             mbOk = true;
@@ -271,7 +288,7 @@ int Statement::exec()
 {
     if (false == mbDone)
     {
-        const int ret = sqlite3_step(mStmtPtr);
+        const int ret = step();
         if (SQLITE_DONE == ret) // the statement has finished executing successfully
         {
             mbOk = false;
@@ -352,21 +369,38 @@ const char* Statement::getColumnOriginName(const int aIndex) const
 }
 #endif
 
+/// Compare a column name entry to a name, to search the sorted vector of column names
+static bool lessColumnName(const std::pair<std::string, int>& aEntry, const char* apName)
+{
+    return (aEntry.first.compare(apName) < 0);
+}
+
+/// Order the column names, keeping the last index of duplicated names first
+static bool lessColumnEntry(const std::pair<std::string, int>& aLeft, const std::pair<std::string, int>& aRight)
+{
+    const int compare = aLeft.first.compare(aRight.first);
+    return (compare < 0) || ((0 == compare) && (aLeft.second > aRight.second));
+}
+
 // Return the index of the specified (potentially aliased) column name
 int Statement::getColumnIndex(const char* apName) const
 {
-    // Build the map of column index by name on first call
+    // Build the sorted vector of column index by name on first call
     if (mColumnNames.empty())
     {
+        mColumnNames.reserve(mColumnCount);
         for (int i = 0; i < mColumnCount; ++i)
         {
             const char* pName = sqlite3_column_name(mStmtPtr, i);
-            mColumnNames[pName] = i;
+            mColumnNames.push_back(std::make_pair(std::string(pName), i));
         }
+        std::sort(mColumnNames.begin(), mColumnNames.end(), lessColumnEntry);
     }
 
-    const TColumnNames::const_iterator iIndex = mColumnNames.find(apName);
-    if (iIndex == mColumnNames.end())
+    // Binary search comparing directly to apName: no std::string is built
+    const TColumnNames::const_iterator iIndex =
+        std::lower_bound(mColumnNames.begin(), mColumnNames.end(), apName, lessColumnName);
+    if ((iIndex == mColumnNames.end()) || (0 != (*iIndex).first.compare(apName)))
     {
         throw SQLite::Exception("Unknown column name.");
     }
@@ -374,6 +408,74 @@ int Statement::getColumnIndex(const char* apName) const
     return (*iIndex).second;
 }
 
+// Return the index of the largest parameter of the prepared statement
+int Statement::getBindParameterCount() const noexcept // nothrow
+{
+    return sqlite3_bind_parameter_count(mStmtPtr);
+}
+
+// Normalize the query and count the statement prepared, for the Profiler of the Database if any
+void Statement::initProfile()
+{
+    if (NULL != mpProfiler)
+    {
+        mProfiledQuery = Profiler::normalize(mQuery);
+        if (mStmtPtr.isPrepared())
+        {
+            mpProfiler->recordPrepare(mProfiledQuery);
+        }
+        // Clear the counters left by the previous executions of a statement checked out of the cache
+        (void)sqlite3_stmt_status(mStmtPtr, SQLITE_STMTSTATUS_FULLSCAN_STEP, 1);
+        (void)sqlite3_stmt_status(mStmtPtr, SQLITE_STMTSTATUS_SORT, 1);
+        (void)sqlite3_stmt_status(mStmtPtr, SQLITE_STMTSTATUS_AUTOINDEX, 1);
+        (void)sqlite3_stmt_status(mStmtPtr, SQLITE_STMTSTATUS_VM_STEP, 1);
+    }
+}
+
+// Step the statement, timing it and counting its rows if the Database has a Profiler
+int Statement::step()
+{
+    if (NULL == mpProfiler)
+    {
+        return sqlite3_step(mStmtPtr);
+    }
+
+    const std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+    const int ret = sqlite3_step(mStmtPtr);
+    mProfileNs += std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - start).count();
+    mbProfiling = true;
+    if (SQLITE_ROW == ret)
+    {
+        ++mProfileRows;
+    }
+    else
+    {
+        endProfile(SQLITE_DONE != ret);
+    }
+    return ret;
+}
+
+// Report the current execution to the Profiler, with the counters of the statement, if it has been stepped
+void Statement::endProfile(const bool abError) noexcept // nothrow
+{
+    if (mbProfiling)
+    {
+        Profiler::Execution execution;
+        execution.mDurationNs = mProfileNs;
+        execution.mRows = mProfileRows;
+        execution.mFullscanSteps = sqlite3_stmt_status(mStmtPtr, SQLITE_STMTSTATUS_FULLSCAN_STEP, 1);
+        execution.mSorts = sqlite3_stmt_status(mStmtPtr, SQLITE_STMTSTATUS_SORT, 1);
+        execution.mAutoIndexes = sqlite3_stmt_status(mStmtPtr, SQLITE_STMTSTATUS_AUTOINDEX, 1);
+        execution.mVmSteps = sqlite3_stmt_status(mStmtPtr, SQLITE_STMTSTATUS_VM_STEP, 1);
+        execution.mbError = abError;
+        mpProfiler->record(mProfiledQuery, execution);
+
+        mProfileNs = 0;
+        mProfileRows = 0;
+        mbProfiling = false;
+    }
+}
+
 // Return the numeric result code for the most recent failed API call (if any).
 int Statement::getErrorCode() const noexcept // nothrow
 {
@@ -395,25 +497,49 @@ const char* Statement::getErrorMsg() const noexcept // nothrow
 ////////////////////////////////////////////////////////////////////////////////
 
 /**
- * @brief Prepare the statement and initialize its reference counter
+ * @brief Prepare the statement, or check it out of the cache, and initialize its reference counter
  *
  * @param[in] apSQLite  The sqlite3 database connexion
  * @param[in] aQuery    The SQL query string to prepare
+ * @param[in] apCache   The statement cache of the database connexion, or NULL to prepare a private statement
  */
-Statement::Ptr::Ptr(sqlite3* apSQLite, std::string& aQuery) :
+Statement::Ptr::Ptr(sqlite3* apSQLite, std::string& aQuery, StatementCache* apCache /* = NULL */) :
     mpSQLite(apSQLite),
     mpStmt(NULL),
-    mpRefCount(NULL)
+    mpRefCount(NULL),
+    mpCache(apCache),
+    mCheckout(),
+    mbPrepared(true)
 {
-    const int ret = sqlite3_prepare_v2(apSQLite, aQuery.c_str(), static_cast<int>(aQuery.size()), &mpStmt, NULL);
-    if (SQLITE_OK != ret)
-    {
-        throw SQLite::Exception(apSQLite, ret);
-    }
     // Initialize the reference counter of the sqlite3_stmt :
     // used to share the mStmtPtr between Statement and Column objects;
     // This is needed to enable Column objects to live longer than the Statement objet it refers to.
+    // It is allocated first, so that a failure cannot leak the sqlite3_stmt.
     mpRefCount = new unsigned int(1);  // NOLINT(readability/casting)
+    try
+    {
+        if (NULL != mpCache)
+        {
+            // The cache keeps the SQL text of the checkout, as sqlite3_sql() may differ from it
+            const unsigned long long misses = mpCache->getMisses();
+            mCheckout = mpCache->checkout(apSQLite, aQuery);
+            mpStmt = mCheckout.getStmt();
+            mbPrepared = (mpCache->getMisses() != misses);
+        }
+        else
+        {
+            const int ret = sqlite3_prepare_v2(apSQLite, aQuery.c_str(), static_cast<int>(aQuery.size()), &mpStmt, NULL);
+            if (SQLITE_OK != ret)
+            {
+                throw SQLite::Exception(apSQLite, ret);
+            }
+        }
+    }
+    catch (...)
+    {
+        delete mpRefCount;
+        throw;
+    }
 }
 
 /**
@@ -424,7 +550,10 @@ Statement::Ptr::Ptr(sqlite3* apSQLite, std::string& aQuery) :
 Statement::Ptr::Ptr(const Statement::Ptr& aPtr) :
     mpSQLite(aPtr.mpSQLite),
     mpStmt(aPtr.mpStmt),
-    mpRefCount(aPtr.mpRefCount)
+    mpRefCount(aPtr.mpRefCount),
+    mpCache(aPtr.mpCache),
+    mCheckout(aPtr.mCheckout),
+    mbPrepared(aPtr.mbPrepared)
 {
     assert(NULL != mpRefCount);
     assert(0 != *mpRefCount);
@@ -446,9 +575,17 @@ Statement::Ptr::~Ptr() noexcept // nothrow
     --(*mpRefCount);
     if (0 == *mpRefCount)
     {
-        // If count reaches zero, finalize the sqlite3_stmt, as no Statement nor Column objet use it anymore.
+        // If count reaches zero, finalize the sqlite3_stmt, as no Statement nor Column objet use it anymore,
+        // or give it back to the statement cache it was checked out from.
         // No need to check the return code, as it is the same as the last statement evaluation.
-        sqlite3_finalize(mpStmt);
+        if (NULL != mpCache)
+        {
+            mpCache->checkin(mCheckout);
+        }
+        else
+        {
+            sqlite3_finalize(mpStmt);
+        }
 
         // and delete the reference counter
         delete mpRefCount;
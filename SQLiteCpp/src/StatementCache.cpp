@@ -0,0 +1,146 @@
+/**
+ * @file    StatementCache.cpp
+ * @ingroup SQLiteCpp
+ * @brief   LRU cache of prepared SQLite Statements, owned by a Database Connection.
+ *
+ * Copyright (c) 2012-2016 Sebastien Rombauts (sebastien.rombauts@gmail.com)
+ *
+ * Distributed under the MIT License (MIT) (See accompanying file LICENSE.txt
+ * or copy at http://opensource.org/licenses/MIT)
+ */
+#include <SQLiteCpp/StatementCache.h>
+
+#include <SQLiteCpp/Exception.h>
+
+#include <sqlite3.h>
+
+namespace SQLite
+{
+
+// Create an empty cache
+StatementCache::StatementCache(const std::size_t aCapacity /* = 0 */) :
+    mCapacity(aCapacity),
+    mHits(0),
+    mMisses(0)
+{
+}
+
+// Finalize all idle statements
+StatementCache::~StatementCache() noexcept // nothrow
+{
+    clear();
+}
+
+// Check out a statement compiled from the provided SQL text, preparing it on a miss
+StatementCache::Checkout StatementCache::checkout(sqlite3* apSQLite, const std::string& aQuery)
+{
+    std::pair<TIndex::iterator, TIndex::iterator> range = mIndex.equal_range(aQuery);
+    for (TIndex::iterator it = range.first; it != range.second; ++it)
+    {
+        if (it->second->mbIdle)
+        {
+            ++mHits;
+            // The entry, with its SQL text, is set aside without any allocation
+            it->second->mbIdle = false;
+            mCheckedOut.splice(mCheckedOut.begin(), mStatements, it->second);
+            return Checkout(it->second);
+        }
+    }
+
+    ++mMisses;
+    sqlite3_stmt* pStmt = NULL;
+    const int ret = sqlite3_prepare_v2(apSQLite, aQuery.c_str(), static_cast<int>(aQuery.size()), &pStmt, NULL);
+    if (SQLITE_OK != ret)
+    {
+        throw SQLite::Exception(apSQLite, ret);
+    }
+    try
+    {
+        const Entry entry = { aQuery, pStmt, false };
+        mCheckedOut.push_front(entry);
+    }
+    catch (...)
+    {
+        sqlite3_finalize(pStmt);
+        throw;
+    }
+    try
+    {
+        mIndex.insert(TIndex::value_type(aQuery, mCheckedOut.begin()));
+    }
+    catch (...)
+    {
+        mCheckedOut.pop_front();
+        sqlite3_finalize(pStmt);
+        throw;
+    }
+    return Checkout(mCheckedOut.begin());
+}
+
+// Reset, clear the bindings, and keep the statement as the most recently used one
+void StatementCache::checkin(const Checkout& aCheckout) noexcept // nothrow
+{
+    const TEntries::iterator entry = aCheckout.mEntry;
+    if (0 == mCapacity)
+    {
+        erase(entry);
+        return;
+    }
+
+    // The return code of reset is the one of the last evaluation, which is of no concern to the next user
+    (void)sqlite3_reset(entry->mpStmt);
+    (void)sqlite3_clear_bindings(entry->mpStmt);
+
+    entry->mbIdle = true;
+    mStatements.splice(mStatements.begin(), mCheckedOut, entry);
+
+    evict(mCapacity);
+}
+
+// Finalize all idle statements
+void StatementCache::clear() noexcept // nothrow
+{
+    evict(0);
+}
+
+// Set the maximum number of idle statements, finalizing the least recently used ones if needed
+void StatementCache::setCapacity(const std::size_t aCapacity) noexcept // nothrow
+{
+    mCapacity = aCapacity;
+    evict(mCapacity);
+}
+
+// Finalize the least recently used statements above the provided count
+void StatementCache::evict(const std::size_t aCount) noexcept // nothrow
+{
+    while (mStatements.size() > aCount)
+    {
+        erase(--mStatements.end());
+    }
+}
+
+// Forget a statement, idle or checked out, and finalize it
+void StatementCache::erase(const TEntries::iterator& aEntry) noexcept // nothrow
+{
+    std::pair<TIndex::iterator, TIndex::iterator> range = mIndex.equal_range(aEntry->mQuery);
+    for (TIndex::iterator it = range.first; it != range.second; ++it)
+    {
+        if (it->second == aEntry)
+        {
+            mIndex.erase(it);
+            break;
+        }
+    }
+    sqlite3_finalize(aEntry->mpStmt);
+    if (aEntry->mbIdle)
+    {
+        mStatements.erase(aEntry);
+    }
+    else
+    {
+        mCheckedOut.erase(aEntry);
+    }
+}
+
+
+}  // namespace SQLite
@@ -0,0 +1,721 @@
+/**
+ * @file    VirtualTable.cpp
+ * @ingroup SQLiteCpp
+ * @brief   Read-only virtual table exposing a C++ container of structs to SQL queries, without copy.
+ *
+ * Copyright (c) 2012-2016 Sebastien Rombauts (sebastien.rombauts@gmail.com)
+ *
+ * Distributed under the MIT License (MIT) (See accompanying file LICENSE.txt
+ * or copy at http://opensource.org/licenses/MIT)
+ */
+#include <SQLiteCpp/VirtualTable.h>
+
+#include <SQLiteCpp/Assertion.h>
+#include <SQLiteCpp/Exception.h>
+
+#include <sqlite3.h>
+
+#include <algorithm>
+#include <cctype>
+#include <cmath>
+#include <cstring>
+#include <map>
+#include <mutex>
+
+
+namespace SQLite
+{
+
+
+/// Return a SQL identifier between double quotes
+static std::string quote(const std::string& aName)
+{
+    std::string quoted = "\"";
+    for (std::string::const_iterator it = aName.begin(); it != aName.end(); ++it)
+    {
+        quoted += *it;
+        if ('"' == *it)
+        {
+            quoted += '"';
+        }
+    }
+    return quoted + "\"";
+}
+
+/// Return true if the declared type of a column contains the provided upper case string, ignoring case
+static bool containsType(const std::string& aDeclaredType, const char* apType)
+{
+    std::string upper = aDeclaredType;
+    std::transform(upper.begin(), upper.end(), upper.begin(), ::toupper);
+    return std::string::npos != upper.find(apType);
+}
+
+/// Return the affinity of a declared type, following the rules of SQLite: SQLITE_INTEGER, SQLITE_FLOAT, SQLITE_TEXT or SQLITE_BLOB (none)
+static int getAffinity(const std::string& aDeclaredType)
+{
+    if (containsType(aDeclaredType, "INT"))
+    {
+        return SQLITE_INTEGER;
+    }
+    else if (containsType(aDeclaredType, "CHAR") || containsType(aDeclaredType, "CLOB") || containsType(aDeclaredType, "TEXT"))
+    {
+        return SQLITE_TEXT;
+    }
+    else if (containsType(aDeclaredType, "BLOB") || aDeclaredType.empty())
+    {
+        return SQLITE_BLOB;
+    }
+    return SQLITE_FLOAT; // REAL, or NUMERIC
+}
+
+/// Rank of the storage classes in the SQLite sort order: NULL, then numbers, then text, then blobs
+static int getTypeRank(const int aType)
+{
+    if (SQLITE_NULL == aType)
+    {
+        return 0;
+    }
+    else if ((SQLITE_INTEGER == aType) || (SQLITE_FLOAT == aType))
+    {
+        return 1;
+    }
+    return (SQLITE_TEXT == aType) ? 2 : 3;
+}
+
+/// Compare two values like SQLite does with the BINARY collation: negative, zero or positive
+static int compareValues(const VirtualValue& aLeft, const VirtualValue& aRight)
+{
+    const int leftRank = getTypeRank(aLeft.getType());
+    const int rightRank = getTypeRank(aRight.getType());
+    if (leftRank != rightRank)
+    {
+        return leftRank - rightRank;
+    }
+    if (1 == leftRank)
+    {
+        if ((SQLITE_INTEGER == aLeft.getType()) && (SQLITE_INTEGER == aRight.getType()))
+        {
+            return (aLeft.getInt64() < aRight.getInt64()) ? -1 : ((aLeft.getInt64() > aRight.getInt64()) ? 1 : 0);
+        }
+        const double left = (SQLITE_INTEGER == aLeft.getType()) ? static_cast<double>(aLeft.getInt64()) : aLeft.getDouble();
+        const double right = (SQLITE_INTEGER == aRight.getType()) ? static_cast<double>(aRight.getInt64()) : aRight.getDouble();
+        return (left < right) ? -1 : ((left > right) ? 1 : 0);
+    }
+    if (leftRank > 1)
+    {
+        const int bytes = std::min(aLeft.getBytes(), aRight.getBytes());
+        const int ret = (bytes > 0) ? std::memcmp(aLeft.getData(), aRight.getData(), bytes) : 0;
+        return (0 != ret) ? ret : (aLeft.getBytes() - aRight.getBytes());
+    }
+    return 0;
+}
+
+
+// UTF-8 text value, pointing to the string, or NULL value
+VirtualValue::VirtualValue(const char* apValue) noexcept : // nothrow
+    mType((NULL != apValue) ? TEXT : Null),
+    mInteger(0),
+    mFloat(0.0),
+    mpData(apValue),
+    mBytes((NULL != apValue) ? static_cast<int>(std::strlen(apValue)) : 0)
+{
+}
+
+// UTF-8 text value, pointing to the provided memory
+VirtualValue VirtualValue::text(const char* apText, const int aBytes) noexcept // nothrow
+{
+    VirtualValue value;
+    value.mType = TEXT;
+    value.mpData = apText;
+    value.mBytes = aBytes;
+    return value;
+}
+
+// Blob value, pointing to the provided memory
+VirtualValue VirtualValue::blob(const void* apData, const int aBytes) noexcept // nothrow
+{
+    VirtualValue value;
+    value.mType = BLOB;
+    value.mpData = apData;
+    value.mBytes = aBytes;
+    return value;
+}
+
+
+/**
+ * @brief Implementation of the sqlite3_module of the virtual tables.
+ *
+ *  The plan chosen by xBestIndex() is encoded in idxNum: the key column in the low 16 bits,
+ * then flags for an equality constraint, or for a lower and/or an upper bound, strict or not.
+ * Their values are given to xFilter() in this order: the equality, or the lower then the upper bound.
+ */
+class VirtualTableModule
+{
+public:
+    static const int COLUMN_MASK    = 0xFFFF;
+    static const int EQUAL          = 1 << 16;
+    static const int LOWER          = 1 << 17;
+    static const int LOWER_STRICT   = 1 << 18;
+    static const int UPPER          = 1 << 19;
+    static const int UPPER_STRICT   = 1 << 20;
+
+    /// Name of the module, registered once on each connection
+    static const char* NAME;
+
+    /// Virtual tables of a connection, by name, given to its module
+    struct Registry
+    {
+        std::map<std::string, VirtualTableBase*> mTables; ///< Virtual tables created and not yet dropped
+    };
+
+    /// Virtual table instance
+    struct Table
+    {
+        sqlite3_vtab        mBase;      ///< Base class, must be first
+        VirtualTableBase*   mpTable;    ///< Virtual table of the container
+    };
+
+    /// Cursor over the rows of the container, or over a slice of the index of a key column
+    struct Cursor
+    {
+        sqlite3_vtab_cursor                 mBase;      ///< Base class, must be first
+        VirtualTableBase*                   mpTable;    ///< Virtual table of the container
+        const std::vector<std::size_t>*     mpIndex;    ///< Positions of the rows sorted by a key column, or NULL for a full scan
+        std::size_t                         mPosition;  ///< Current row, in the container or in the index
+        std::size_t                         mEnd;       ///< End of the rows to scan
+    };
+
+    /// Return the sqlite3_module, common to all virtual tables
+    static const sqlite3_module* getModule()
+    {
+        static const sqlite3_module module = {
+            0,              // iVersion
+            &connect,       // xCreate
+            &connect,       // xConnect
+            &bestIndex,     // xBestIndex
+            &disconnect,    // xDisconnect
+            &disconnect,    // xDestroy
+            &open,          // xOpen
+            &close,         // xClose
+            &filter,        // xFilter
+            &next,          // xNext
+            &eof,           // xEof
+            &column,        // xColumn
+            &rowid,         // xRowid
+            NULL,           // xUpdate: read-only
+            NULL,           // xBegin
+            NULL,           // xSync
+            NULL,           // xCommit
+            NULL,           // xRollback
+            NULL,           // xFindFunction
+            NULL,           // xRename
+            NULL,           // xSavepoint
+            NULL,           // xRelease
+            NULL            // xRollbackTo
+        };
+        return &module;
+    }
+
+    /// Return the registry of a connection, registering the module on its first virtual table
+    static Registry& getRegistry(sqlite3* apSQLite)
+    {
+        {
+            std::lock_guard<std::mutex> lock(getMutex());
+            std::map<sqlite3*, Registry*>& registries = getRegistries();
+            std::map<sqlite3*, Registry*>::const_iterator found = registries.find(apSQLite);
+            if (registries.end() != found)
+            {
+                return *found->second;
+            }
+        }
+        // Register the module without the lock: sqlite3_create_module_v2() takes the mutex of the connection,
+        // and calls destroyRegistry() on error, which would take the lock again.
+        Registry* pRegistry = new Registry();
+        // The registry is destroyed by SQLite with the module, when the connection is closed
+        const int ret = sqlite3_create_module_v2(apSQLite, NAME, getModule(), pRegistry, &destroyRegistry);
+        if (SQLITE_OK != ret)
+        {
+            // sqlite3_create_module_v2() has already destroyed it
+            throw SQLite::Exception(apSQLite, ret);
+        }
+        std::lock_guard<std::mutex> lock(getMutex());
+        getRegistries()[apSQLite] = pRegistry;
+        return *pRegistry;
+    }
+
+    /// Forget a virtual table being dropped
+    static void unregister(sqlite3* apSQLite, const std::string& aName) noexcept // nothrow
+    {
+        std::lock_guard<std::mutex> lock(getMutex());
+        std::map<sqlite3*, Registry*>& registries = getRegistries();
+        std::map<sqlite3*, Registry*>::const_iterator found = registries.find(apSQLite);
+        if (registries.end() != found)
+        {
+            found->second->mTables.erase(aName);
+        }
+    }
+
+private:
+    /// Protect the registries of the connections, which can be opened and closed by different threads
+    static std::mutex& getMutex()
+    {
+        static std::mutex mutex;
+        return mutex;
+    }
+
+    /// Registries of the connections with the module registered
+    static std::map<sqlite3*, Registry*>& getRegistries()
+    {
+        static std::map<sqlite3*, Registry*> registries;
+        return registries;
+    }
+
+    /// Forget the registry of a connection being closed, and destroy it
+    static void destroyRegistry(void* apRegistry)
+    {
+        std::lock_guard<std::mutex> lock(getMutex());
+        std::map<sqlite3*, Registry*>& registries = getRegistries();
+        for (std::map<sqlite3*, Registry*>::iterator it = registries.begin(); it != registries.end(); ++it)
+        {
+            if (it->second == apRegistry)
+            {
+                registries.erase(it);
+                break;
+            }
+        }
+        delete static_cast<Registry*>(apRegistry);
+    }
+
+    /// Declare the columns of the virtual table, and allocate its instance
+    static int connect(sqlite3* apSQLite, void* apAux, int aArgc, const char* const* apArgv,
+                       sqlite3_vtab** appVTab, char** apErrMsg)
+    {
+        // The third argument is the name of the virtual table: only the ones created by a VirtualTable are known
+        const Registry& registry = *static_cast<Registry*>(apAux);
+        std::map<std::string, VirtualTableBase*>::const_iterator found = registry.mTables.end();
+        if (aArgc > 2)
+        {
+            found = registry.mTables.find(apArgv[2]);
+        }
+        if (registry.mTables.end() == found)
+        {
+            *apErrMsg = sqlite3_mprintf("%s can only be used by a SQLite::VirtualTable", NAME);
+            return SQLITE_ERROR;
+        }
+        VirtualTableBase* pTable = found->second;
+        std::string declaration = "CREATE TABLE x(";
+        for (std::size_t i = 0; i < pTable->mColumns.size(); ++i)
+        {
+            declaration += (i > 0) ? ", " : "";
+            declaration += quote(pTable->mColumns[i].mName) + " " + pTable->mColumns[i].mType;
+        }
+        declaration += ")";
+        const int ret = sqlite3_declare_vtab(apSQLite, declaration.c_str());
+        if (SQLITE_OK != ret)
+        {
+            return ret;
+        }
+
+        Table* pVTab = static_cast<Table*>(sqlite3_malloc(sizeof(Table)));
+        if (NULL == pVTab)
+        {
+            return SQLITE_NOMEM;
+        }
+        std::memset(pVTab, 0, sizeof(Table));
+        pVTab->mpTable = pTable;
+        *appVTab = &pVTab->mBase;
+        return SQLITE_OK;
+    }
+
+    /// Free the instance of the virtual table
+    static int disconnect(sqlite3_vtab* apVTab)
+    {
+        sqlite3_free(apVTab);
+        return SQLITE_OK;
+    }
+
+    /// Choose the key column with the most selective equality or range constraints
+    static int bestIndex(sqlite3_vtab* apVTab, sqlite3_index_info* apInfo)
+    {
+        const VirtualTableBase& table = *reinterpret_cast<Table*>(apVTab)->mpTable;
+        const double rows = static_cast<double>(std::max(table.getRowCount(), static_cast<std::size_t>(1)));
+        const double searchCost = std::log(rows) / std::log(2.0) + 1.0;
+
+        int bestPlan = 0;
+        double bestCost = rows;
+        double bestRows = rows;
+        int bestConstraints[3] = { -1, -1, -1 }; // equality, lower bound, upper bound
+        for (std::size_t column = 0; column < table.mColumns.size(); ++column)
+        {
+            if (false == table.mColumns[column].mbKey)
+            {
+                continue;
+            }
+            int plan = static_cast<int>(column);
+            int constraints[3] = { -1, -1, -1 };
+            for (int i = 0; i < apInfo->nConstraint; ++i)
+            {
+                const sqlite3_index_info::sqlite3_index_constraint& constraint = apInfo->aConstraint[i];
+                if ((false == constraint.usable) || (constraint.iColumn != static_cast<int>(column)))
+                {
+                    continue;
+                }
+                switch (constraint.op)
+                {
+                case SQLITE_INDEX_CONSTRAINT_EQ:
+                    constraints[0] = i;
+                    plan |= EQUAL;
+                    break;
+                case SQLITE_INDEX_CONSTRAINT_GT:
+                case SQLITE_INDEX_CONSTRAINT_GE:
+                    constraints[1] = i;
+                    plan = (plan & ~LOWER_STRICT) | LOWER | ((SQLITE_INDEX_CONSTRAINT_GT == constraint.op) ? LOWER_STRICT : 0);
+                    break;
+                case SQLITE_INDEX_CONSTRAINT_LT:
+                case SQLITE_INDEX_CONSTRAINT_LE:
+                    constraints[2] = i;
+                    plan = (plan & ~UPPER_STRICT) | UPPER | ((SQLITE_INDEX_CONSTRAINT_LT == constraint.op) ? UPPER_STRICT : 0);
+                    break;
+                default:
+                    break;
+                }
+            }
+
+            // An equality is the most selective, then a range with two bounds, then with one bound
+            double estimatedRows = rows;
+            if (plan & EQUAL)
+            {
+                plan &= ~(LOWER | LOWER_STRICT | UPPER | UPPER_STRICT);
+                constraints[1] = constraints[2] = -1;
+                estimatedRows = std::min(rows, 10.0);
+            }
+            else if ((plan & LOWER) && (plan & UPPER))
+            {
+                estimatedRows = rows / 16.0;
+            }
+            else if (plan & (LOWER | UPPER))
+            {
+                estimatedRows = rows / 4.0;
+            }
+            else
+            {
+                continue;
+            }
+            const double cost = searchCost + estimatedRows;
+            if (cost < bestCost)
+            {
+                bestPlan = plan;
+                bestCost = cost;
+                bestRows = estimatedRows;
+                std::copy(constraints, constraints + 3, bestConstraints);
+            }
+        }
+
+        // Constraints are given to xFilter(), which returns a superset of the matching rows: SQLite checks them again
+        int argvIndex = 0;
+        for (int i = 0; i < 3; ++i)
+        {
+            if (bestConstraints[i] >= 0)
+            {
+                apInfo->aConstraintUsage[bestConstraints[i]].argvIndex = ++argvIndex;
+                apInfo->aConstraintUsage[bestConstraints[i]].omit = 0;
+            }
+        }
+        apInfo->idxNum = bestPlan;
+        if (0 != bestPlan)
+        {
+            const char* pOp = (bestPlan & EQUAL) ? "=" : (((bestPlan & LOWER) && (bestPlan & UPPER)) ? "<>" : ((bestPlan & LOWER) ? ">" : "<"));
+            apInfo->idxStr = sqlite3_mprintf("%s%s", table.mColumns[bestPlan & COLUMN_MASK].mName.c_str(), pOp);
+            apInfo->needToFreeIdxStr = 1;
+        }
+        apInfo->estimatedCost = bestCost;
+        apInfo->estimatedRows = static_cast<sqlite3_int64>(bestRows);
+        return SQLITE_OK;
+    }
+
+    /// Allocate a cursor
+    static int open(sqlite3_vtab* apVTab, sqlite3_vtab_cursor** appCursor)
+    {
+        Cursor* pCursor = static_cast<Cursor*>(sqlite3_malloc(sizeof(Cursor)));
+        if (NULL == pCursor)
+        {
+            return SQLITE_NOMEM;
+        }
+        std::memset(pCursor, 0, sizeof(Cursor));
+        pCursor->mpTable = reinterpret_cast<Table*>(apVTab)->mpTable;
+        *appCursor = &pCursor->mBase;
+        return SQLITE_OK;
+    }
+
+    /// Free a cursor
+    static int close(sqlite3_vtab_cursor* apCursor)
+    {
+        sqlite3_free(apCursor);
+        return SQLITE_OK;
+    }
+
+    /// Convert the value of a constraint with the affinity of the column, like SQLite does before comparing them
+    static VirtualValue toValue(sqlite3_value* apValue, const int aAffinity)
+    {
+        if ((SQLITE_INTEGER == aAffinity) || (SQLITE_FLOAT == aAffinity))
+        {
+            (void)sqlite3_value_numeric_type(apValue); // converts a text looking like a number
+        }
+        const int type = sqlite3_value_type(apValue);
+        if ((SQLITE_TEXT == type) || ((SQLITE_TEXT == aAffinity) && ((SQLITE_INTEGER == type) || (SQLITE_FLOAT == type))))
+        {
+            const char* pText = reinterpret_cast<const char*>(sqlite3_value_text(apValue));
+            return VirtualValue::text(pText, sqlite3_value_bytes(apValue));
+        }
+        switch (type)
+        {
+        case SQLITE_INTEGER:
+            return VirtualValue(static_cast<long long>(sqlite3_value_int64(apValue)));
+        case SQLITE_FLOAT:
+            return VirtualValue(sqlite3_value_double(apValue));
+        case SQLITE_BLOB:
+            return VirtualValue::blob(sqlite3_value_blob(apValue), sqlite3_value_bytes(apValue));
+        default:
+            return VirtualValue();
+        }
+    }
+
+    /// Position the cursor on the first row matching the constraints of the plan
+    static int filter(sqlite3_vtab_cursor* apCursor, int aIdxNum, const char* /* apIdxStr */, int aArgc, sqlite3_value** apArgv)
+    {
+        Cursor& cursor = *reinterpret_cast<Cursor*>(apCursor);
+        VirtualTableBase& table = *cursor.mpTable;
+        cursor.mpIndex = NULL;
+        cursor.mPosition = 0;
+        cursor.mEnd = table.getRowCount();
+        if (0 == aIdxNum)
+        {
+            return SQLITE_OK;
+        }
+
+        try
+        {
+            const int column = aIdxNum & COLUMN_MASK;
+            const int affinity = getAffinity(table.mColumns[column].mType);
+            const std::vector<std::size_t>& index = table.getIndex(column);
+            cursor.mpIndex = &index;
+
+            // Binary search of the bounds in the index
+            int arg = 0;
+            std::size_t first = 0;
+            std::size_t last = index.size();
+            for (int bound = 0; bound < 2; ++bound)
+            {
+                const bool bLower = (0 == bound) && (aIdxNum & (EQUAL | LOWER));
+                const bool bUpper = (aIdxNum & EQUAL) ? (0 == bound) : ((1 == bound) && (aIdxNum & UPPER));
+                if ((false == bLower) && (false == bUpper))
+                {
+                    continue;
+                }
+                if (arg >= aArgc)
+                {
+                    return SQLITE_ERROR;
+                }
+                const VirtualValue value = toValue(apArgv[arg++], affinity);
+                if (SQLITE_NULL == value.getType())
+                {
+                    // No row matches a comparison with NULL
+                    first = last = 0;
+                    break;
+                }
+                if (bLower)
+                {
+                    const bool bStrict = (0 != (aIdxNum & LOWER_STRICT));
+                    first = std::max(first, search(table, index, column, value, bStrict));
+                }
+                if (bUpper)
+                {
+                    const bool bStrict = (0 != (aIdxNum & UPPER_STRICT));
+                    last = std::min(last, search(table, index, column, value, false == bStrict));
+                }
+            }
+            cursor.mPosition = first;
+            cursor.mEnd = std::max(first, last);
+        }
+        catch (std::exception& e)
+        {
+            sqlite3_free(apCursor->pVtab->zErrMsg);
+            apCursor->pVtab->zErrMsg = sqlite3_mprintf("%s", e.what());
+            return SQLITE_ERROR;
+        }
+        return SQLITE_OK;
+    }
+
+    /**
+     * @brief Return the position in the index of the first row greater than the value, or greater or equal.
+     *
+     * @param[in] abAfter   true for the first row greater than the value (upper bound), false for greater or equal (lower bound)
+     */
+    static std::size_t search(const VirtualTableBase& aTable, const std::vector<std::size_t>& aIndex,
+                              const int aColumn, const VirtualValue& aValue, const bool abAfter)
+    {
+        std::size_t first = 0;
+        std::size_t count = aIndex.size();
+        while (count > 0)
+        {
+            const std::size_t half = count / 2;
+            const int cmp = compareValues(aTable.getValue(aIndex[first + half], aColumn), aValue);
+            if ((cmp < 0) || (abAfter && (0 == cmp)))
+            {
+                first += half + 1;
+                count -= half + 1;
+            }
+            else
+            {
+                count = half;
+            }
+        }
+        return first;
+    }
+
+    /// Move to the next row
+    static int next(sqlite3_vtab_cursor* apCursor)
+    {
+        ++reinterpret_cast<Cursor*>(apCursor)->mPosition;
+        return SQLITE_OK;
+    }
+
+    /// Return true after the last row
+    static int eof(sqlite3_vtab_cursor* apCursor)
+    {
+        const Cursor& cursor = *reinterpret_cast<Cursor*>(apCursor);
+        return (cursor.mPosition >= cursor.mEnd) ? 1 : 0;
+    }
+
+    /// Return the position of the current row in the container
+    static std::size_t getRow(const Cursor& aCursor)
+    {
+        return (NULL != aCursor.mpIndex) ? (*aCursor.mpIndex)[aCursor.mPosition] : aCursor.mPosition;
+    }
+
+    /// Return the value of a column of the current row, pointing to the memory of the container for a text or a blob
+    static int column(sqlite3_vtab_cursor* apCursor, sqlite3_context* apContext, int aColumn)
+    {
+        const Cursor& cursor = *reinterpret_cast<Cursor*>(apCursor);
+        try
+        {
+            const VirtualValue value = cursor.mpTable->getValue(getRow(cursor), aColumn);
+            switch (value.getType())
+            {
+            case SQLITE_INTEGER:
+                sqlite3_result_int64(apContext, value.getInt64());
+                break;
+            case SQLITE_FLOAT:
+                sqlite3_result_double(apContext, value.getDouble());
+                break;
+            case SQLITE_TEXT:
+                sqlite3_result_text(apContext, static_cast<const char*>(value.getData()), value.getBytes(), SQLITE_STATIC);
+                break;
+            case SQLITE_BLOB:
+                sqlite3_result_blob(apContext, value.getData(), value.getBytes(), SQLITE_STATIC);
+                break;
+            default:
+                sqlite3_result_null(apContext);
+                break;
+            }
+        }
+        catch (std::exception& e)
+        {
+            sqlite3_result_error(apContext, e.what(), -1);
+        }
+        return SQLITE_OK;
+    }
+
+    /// Return the position of the current row in the container as its rowid
+    static int rowid(sqlite3_vtab_cursor* apCursor, sqlite3_int64* apRowid)
+    {
+        *apRowid = static_cast<sqlite3_int64>(getRow(*reinterpret_cast<Cursor*>(apCursor)));
+        return SQLITE_OK;
+    }
+};
+
+const char* VirtualTableModule::NAME = "sqlitecpp_vtab";
+
+
+// Initialize an unregistered virtual table
+VirtualTableBase::VirtualTableBase(Database& aDatabase, const std::string& aName) :
+    mDatabase(aDatabase),
+    mName(aName),
+    mbCreated(false)
+{
+}
+
+// Drop the virtual table
+VirtualTableBase::~VirtualTableBase() noexcept // nothrow
+{
+    if (mbCreated)
+    {
+        const std::string drop = "DROP TABLE temp." + quote(mName);
+        const int ret = sqlite3_exec(mDatabase.getHandle(), drop.c_str(), NULL, NULL, NULL);
+
+        // Avoid unreferenced variable warning when build in release mode
+        (void) ret;
+
+        // Only case of error is SQLITE_LOCKED: a statement is still reading the virtual table
+        const bool bDropped = (SQLITE_OK == ret);
+        SQLITECPP_ASSERT(bDropped, sqlite3_errmsg(mDatabase.getHandle())); // See SQLITECPP_ENABLE_ASSERT_HANDLER
+
+        // Never reconnect a virtual table to this object once destroyed
+        VirtualTableModule::unregister(mDatabase.getHandle(), mName);
+    }
+}
+
+// Discard the indexes of the key columns
+void VirtualTableBase::invalidate() noexcept // nothrow
+{
+    for (std::size_t i = 0; i < mIndexes.size(); ++i)
+    {
+        std::vector<std::size_t>().swap(mIndexes[i]);
+    }
+}
+
+// Register the virtual table with the module of the connection, and create it in the "temp" schema
+void VirtualTableBase::create(const std::vector<ColumnInfo>& aColumns)
+{
+    mColumns = aColumns;
+    mIndexes.resize(mColumns.size());
+
+    // A module cannot be unregistered before SQLite 3.30: one module per connection finds its virtual tables by name
+    VirtualTableModule::Registry& registry = VirtualTableModule::getRegistry(mDatabase.getHandle());
+    if (false == registry.mTables.insert(std::make_pair(mName, this)).second)
+    {
+        throw SQLite::Exception("VirtualTable name already used on this connection.");
+    }
+    try
+    {
+        mDatabase.exec("CREATE VIRTUAL TABLE temp." + quote(mName) + " USING " + VirtualTableModule::NAME);
+    }
+    catch (...)
+    {
+        registry.mTables.erase(mName);
+        throw;
+    }
+    mbCreated = true;
+}
+
+// Return the positions of the rows sorted by the value of a key column, building the index if needed
+const std::vector<std::size_t>& VirtualTableBase::getIndex(const int aColumn)
+{
+    std::vector<std::size_t>& index = mIndexes[aColumn];
+    const std::size_t rowCount = getRowCount();
+    if (index.size() != rowCount)
+    {
+        index.resize(rowCount);
+        for (std::size_t i = 0; i < rowCount; ++i)
+        {
+            index[i] = i;
+        }
+        std::stable_sort(index.begin(), index.end(), [this, aColumn](const std::size_t aLeft, const std::size_t aRight) {
+            return compareValues(getValue(aLeft, aColumn), getValue(aRight, aColumn)) < 0;
+        });
+    }
+    return index;
+}
+
+
+}  // namespace SQLite
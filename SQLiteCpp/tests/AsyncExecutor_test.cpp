@@ -0,0 +1,179 @@
+/**
+ * @file    AsyncExecutor_test.cpp
+ * @ingroup tests
+ * @brief   Test of a SQLiteCpp AsyncExecutor.
+ *
+ * Copyright (c) 2012-2016 Sebastien Rombauts (sebastien.rombauts@gmail.com)
+ *
+ * Distributed under the MIT License (MIT) (See accompanying file LICENSE.txt
+ * or copy at http://opensource.org/licenses/MIT)
+ */
+
+#include <SQLiteCpp/AsyncExecutor.h>
+#include <SQLiteCpp/Statement.h>
+#include <SQLiteCpp/Exception.h>
+
+#include <gtest/gtest.h>
+
+#include <cstdio>
+#include <future>
+#include <string>
+#include <vector>
+
+
+TEST(AsyncExecutor, readWrite) {
+    remove("async_test.db3");
+    {
+        SQLite::AsyncExecutor executor("async_test.db3", 2);
+
+        std::future<void> created = executor.write([](SQLite::Database& aDatabase) {
+            aDatabase.exec("CREATE TABLE test (id INTEGER PRIMARY KEY, value TEXT)");
+        });
+        created.get();
+
+        std::future<long long> inserted = executor.write([](SQLite::Database& aDatabase) {
+            aDatabase.exec("INSERT INTO test VALUES (NULL, \"first\")");
+            return aDatabase.getLastInsertRowid();
+        });
+        EXPECT_EQ(1, inserted.get());
+
+        std::future<std::string> value = executor.read([](SQLite::Database& aDatabase) {
+            return aDatabase.execAndGet("SELECT value FROM test WHERE id=1").getString();
+        });
+        EXPECT_EQ("first", value.get());
+
+        // Errors are delivered through the future
+        std::future<int> failed = executor.read([](SQLite::Database& aDatabase) {
+            return aDatabase.exec("INSERT INTO test VALUES (NULL, \"read-only\")");
+        });
+        EXPECT_THROW(failed.get(), SQLite::Exception);
+    }
+    remove("async_test.db3");
+}
+
+TEST(AsyncExecutor, groupCommit) {
+    remove("async_test.db3");
+    {
+        SQLite::AsyncExecutor executor("async_test.db3", 1);
+        executor.write([](SQLite::Database& aDatabase) {
+            aDatabase.exec("CREATE TABLE test (id INTEGER PRIMARY KEY, value INTEGER UNIQUE)");
+        }).get();
+        const unsigned long long commits = executor.getCommitCount();
+
+        // Hold the writer busy, so that the next writes queue up behind it
+        std::promise<void> release;
+        std::shared_future<void> released(release.get_future());
+        std::future<void> blocker = executor.write([released](SQLite::Database&) {
+            released.wait();
+        });
+
+        std::vector<std::future<void> > writes;
+        for (int i = 0; i < 100; ++i)
+        {
+            writes.push_back(executor.write([i](SQLite::Database& aDatabase) {
+                SQLite::Statement insert(aDatabase, "INSERT INTO test VALUES (NULL, ?)");
+                insert.bind(1, i % 50); // half of them break the UNIQUE constraint
+                insert.exec();
+            }));
+        }
+        release.set_value();
+        blocker.get();
+
+        int failures = 0;
+        for (std::size_t i = 0; i < writes.size(); ++i)
+        {
+            try
+            {
+                writes[i].get();
+            }
+            catch (SQLite::Exception&)
+            {
+                ++failures;
+            }
+        }
+        EXPECT_EQ(50, failures);
+
+        // The failed writes were rolled back alone, and the others were committed together
+        EXPECT_EQ(50, executor.read([](SQLite::Database& aDatabase) {
+            return aDatabase.execAndGet("SELECT count(*) FROM test").getInt();
+        }).get());
+        EXPECT_EQ(52u, executor.getWriteCount()); // CREATE TABLE, the blocker, and the 50 successful inserts
+        EXPECT_LE(executor.getCommitCount() - commits, 2u);
+    }
+    remove("async_test.db3");
+}
+
+TEST(AsyncExecutor, transactionRolledBack) {
+    remove("async_test.db3");
+    {
+        SQLite::AsyncExecutor executor("async_test.db3", 1);
+        executor.write([](SQLite::Database& aDatabase) {
+            aDatabase.exec("CREATE TABLE test (id INTEGER PRIMARY KEY, value INTEGER)");
+            // Like SQLITE_FULL or SQLITE_IOERR, RAISE(ROLLBACK) rolls back the whole transaction, not only the statement
+            aDatabase.exec("CREATE TRIGGER abort BEFORE INSERT ON test WHEN NEW.value < 0 BEGIN SELECT RAISE(ROLLBACK, 'aborted'); END");
+        }).get();
+
+        // The blocker must run in its own group, not in the one rolled back
+        std::promise<void> start;
+        std::future<void> started = start.get_future();
+        std::promise<void> release;
+        std::shared_future<void> released(release.get_future());
+        std::future<void> blocker = executor.write([&start, released](SQLite::Database&) {
+            start.set_value();
+            released.wait();
+        });
+        started.wait();
+        std::vector<std::future<void> > writes;
+        const int values[] = { 1, 2, -1, 3, 4 };
+        for (std::size_t i = 0; i < 5; ++i)
+        {
+            const int value = values[i];
+            writes.push_back(executor.write([value](SQLite::Database& aDatabase) {
+                SQLite::Statement insert(aDatabase, "INSERT INTO test VALUES (NULL, ?)");
+                insert.bind(1, value);
+                insert.exec();
+            }));
+        }
+        release.set_value();
+
+        blocker.get();
+
+        // The writes before the rollback are undone with it, and fail with its exception
+        EXPECT_THROW(writes[0].get(), SQLite::Exception);
+        EXPECT_THROW(writes[1].get(), SQLite::Exception);
+        EXPECT_THROW(writes[2].get(), SQLite::Exception);
+        // The next writes are committed in a new transaction
+        EXPECT_NO_THROW(writes[3].get());
+        EXPECT_NO_THROW(writes[4].get());
+        EXPECT_EQ("3,4", executor.read([](SQLite::Database& aDatabase) {
+            return aDatabase.execAndGet("SELECT group_concat(value) FROM test").getString();
+        }).get());
+    }
+    remove("async_test.db3");
+}
+
+TEST(AsyncExecutor, drainOnDestruction) {
+    remove("async_test.db3");
+    std::vector<std::future<void> > writes;
+    {
+        SQLite::AsyncExecutor executor("async_test.db3", 1, SQLite::ConnectionPool::TSetup(), 10);
+        executor.write([](SQLite::Database& aDatabase) {
+            aDatabase.exec("CREATE TABLE test (id INTEGER PRIMARY KEY)");
+        });
+        for (int i = 0; i < 35; ++i)
+        {
+            writes.push_back(executor.write([](SQLite::Database& aDatabase) {
+                aDatabase.exec("INSERT INTO test VALUES (NULL)");
+            }));
+        }
+    }
+    for (std::size_t i = 0; i < writes.size(); ++i)
+    {
+        EXPECT_NO_THROW(writes[i].get());
+    }
+    {
+        SQLite::Database db("async_test.db3");
+        EXPECT_EQ(35, db.execAndGet("SELECT count(*) FROM test").getInt());
+    }
+    remove("async_test.db3");
+}
@@ -0,0 +1,163 @@
+/**
+ * @file    BackupDriver_test.cpp
+ * @ingroup tests
+ * @brief   Test of a SQLiteCpp BackupDriver.
+ *
+ * Copyright (c) 2012-2016 Sebastien Rombauts (sebastien.rombauts@gmail.com)
+ *
+ * Distributed under the MIT License (MIT) (See accompanying file LICENSE.txt
+ * or copy at http://opensource.org/licenses/MIT)
+ */
+
+#include <SQLiteCpp/BackupDriver.h>
+#include <SQLiteCpp/Database.h>
+#include <SQLiteCpp/Statement.h>
+#include <SQLiteCpp/Transaction.h>
+#include <SQLiteCpp/Exception.h>
+
+#include <gtest/gtest.h>
+
+#include <chrono>
+#include <cstdio>
+#include <string>
+
+
+/// Fill the source database with about 400 pages of 1024 bytes
+static void fill(SQLite::Database& aDatabase)
+{
+    aDatabase.exec("PRAGMA page_size=1024");
+    aDatabase.exec("CREATE TABLE test (id INTEGER PRIMARY KEY, value TEXT)");
+    SQLite::Transaction transaction(aDatabase);
+    SQLite::Statement insert(aDatabase, "INSERT INTO test VALUES (NULL, ?)");
+    const std::string value(300, 'x');
+    for (int i = 0; i < 1000; ++i)
+    {
+        insert.bind(1, value);
+        insert.exec();
+        insert.reset();
+    }
+    transaction.commit();
+}
+
+TEST(BackupDriver, run) {
+    remove("backup_driver_test.db3");
+    remove("backup_driver_test.db3.backup");
+    {
+        SQLite::Database srcDB("backup_driver_test.db3", SQLite::OPEN_READWRITE|SQLite::OPEN_CREATE);
+        fill(srcDB);
+
+        SQLite::BackupDriver driver("backup_driver_test.db3.backup", "backup_driver_test.db3");
+        driver.setPagesPerStep(50);
+        int steps = 0;
+        int lastRemaining = -1;
+        driver.setProgressHandler([&](const SQLite::BackupDriver::Progress& aProgress) {
+            ++steps;
+            EXPECT_GT(aProgress.mTotalPages, 300);
+            lastRemaining = aProgress.mRemainingPages;
+        });
+        EXPECT_FALSE(driver.isRunning());
+        EXPECT_TRUE(driver.run());
+        EXPECT_FALSE(driver.isRunning());
+        EXPECT_GT(steps, 6);
+        EXPECT_EQ(0, lastRemaining);
+
+        const SQLite::BackupDriver::Progress progress = driver.getProgress();
+        EXPECT_EQ(0, progress.mRemainingPages);
+        EXPECT_EQ(0u, progress.mRestartCount);
+        EXPECT_EQ(progress.mTotalPages * 1024LL, progress.mCopiedBytes);
+
+        SQLite::Database destDB("backup_driver_test.db3.backup");
+        EXPECT_EQ(1000, destDB.execAndGet("SELECT count(*) FROM test").getInt());
+    }
+    remove("backup_driver_test.db3");
+    remove("backup_driver_test.db3.backup");
+}
+
+TEST(BackupDriver, restart) {
+    remove("backup_driver_test.db3");
+    remove("backup_driver_test.db3.backup");
+    {
+        SQLite::Database srcDB("backup_driver_test.db3", SQLite::OPEN_READWRITE|SQLite::OPEN_CREATE);
+        fill(srcDB);
+
+        // Modify the source through another connection in the middle of the backup
+        SQLite::Database srcDB2("backup_driver_test.db3", SQLite::OPEN_READWRITE);
+        SQLite::Database destDB("backup_driver_test.db3.backup", SQLite::OPEN_READWRITE|SQLite::OPEN_CREATE);
+        SQLite::BackupDriver driver(destDB, srcDB);
+        driver.setPagesPerStep(50);
+        driver.setMaxRestarts(1);
+        int steps = 0;
+        driver.setProgressHandler([&](const SQLite::BackupDriver::Progress&) {
+            if (3 == ++steps)
+            {
+                srcDB2.exec("INSERT INTO test VALUES (NULL, \"last\")");
+            }
+        });
+        EXPECT_TRUE(driver.run());
+
+        // After the restart, the rest has been copied at once
+        const SQLite::BackupDriver::Progress progress = driver.getProgress();
+        EXPECT_EQ(1u, progress.mRestartCount);
+        EXPECT_EQ(5, steps); // 3 steps, the step which restarted, and the last step
+        EXPECT_GT(progress.mCopiedBytes, progress.mTotalPages * 1024LL);
+        EXPECT_EQ(1001, destDB.execAndGet("SELECT count(*) FROM test").getInt());
+    }
+    remove("backup_driver_test.db3");
+    remove("backup_driver_test.db3.backup");
+}
+
+TEST(BackupDriver, throttle) {
+    remove("backup_driver_test.db3");
+    remove("backup_driver_test.db3.backup");
+    {
+        SQLite::Database srcDB("backup_driver_test.db3", SQLite::OPEN_READWRITE|SQLite::OPEN_CREATE);
+        fill(srcDB);
+
+        // About 400 KB at 2 MB/s take at least 150 ms
+        SQLite::BackupDriver driver("backup_driver_test.db3.backup", "backup_driver_test.db3");
+        driver.setPagesPerStep(20);
+        driver.setMaxBytesPerSecond(2 * 1024 * 1024);
+        const std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+        driver.start();
+        EXPECT_THROW(driver.start(), SQLite::Exception);
+        EXPECT_TRUE(driver.wait());
+        const std::chrono::steady_clock::duration elapsed = std::chrono::steady_clock::now() - start;
+        EXPECT_GE(elapsed, std::chrono::milliseconds(150));
+        EXPECT_FALSE(driver.isRunning());
+        EXPECT_EQ(0, driver.getProgress().mRemainingPages);
+    }
+    remove("backup_driver_test.db3");
+    remove("backup_driver_test.db3.backup");
+}
+
+TEST(BackupDriver, cancel) {
+    remove("backup_driver_test.db3");
+    remove("backup_driver_test.db3.backup");
+    {
+        SQLite::Database srcDB("backup_driver_test.db3", SQLite::OPEN_READWRITE|SQLite::OPEN_CREATE);
+        fill(srcDB);
+
+        // At 1 KB/s the backup would take minutes, but the pause is interrupted
+        SQLite::BackupDriver driver("backup_driver_test.db3.backup", "backup_driver_test.db3");
+        driver.setPagesPerStep(1);
+        driver.setMaxBytesPerSecond(1024);
+        driver.start();
+        while (0 == driver.getProgress().mCopiedBytes)
+        {
+            std::this_thread::yield();
+        }
+        driver.cancel();
+        EXPECT_FALSE(driver.wait());
+        EXPECT_GT(driver.getProgress().mRemainingPages, 0);
+
+        // The driver can be started again, and its errors are delivered by wait()
+        driver.setMaxBytesPerSecond(0);
+        driver.setProgressHandler([](const SQLite::BackupDriver::Progress&) {
+            throw SQLite::Exception("progress handler failure");
+        });
+        driver.start();
+        EXPECT_THROW(driver.wait(), SQLite::Exception);
+    }
+    remove("backup_driver_test.db3");
+    remove("backup_driver_test.db3.backup");
+}
@@ -0,0 +1,121 @@
+/**
+ * @file    Blob_test.cpp
+ * @ingroup tests
+ * @brief   Test of a SQLiteCpp Blob and BlobStreamBuf.
+ *
+ * Copyright (c) 2012-2016 Sebastien Rombauts (sebastien.rombauts@gmail.com)
+ *
+ * Distributed under the MIT License (MIT) (See accompanying file LICENSE.txt
+ * or copy at http://opensource.org/licenses/MIT)
+ */
+
+#include <SQLiteCpp/Blob.h>
+#include <SQLiteCpp/Database.h>
+#include <SQLiteCpp/Statement.h>
+#include <SQLiteCpp/Exception.h>
+
+#include <gtest/gtest.h>
+
+#include <istream>
+#include <ostream>
+#include <sstream>
+#include <string>
+
+
+TEST(Blob, readWrite) {
+    SQLite::Database db(":memory:", SQLite::OPEN_READWRITE);
+    db.exec("CREATE TABLE test (id INTEGER PRIMARY KEY, data BLOB)");
+    db.exec("INSERT INTO test VALUES (1, zeroblob(10))");
+    db.exec("INSERT INTO test VALUES (2, x'0102030405')");
+
+    EXPECT_THROW(SQLite::Blob(db, "test", "data", 3), SQLite::Exception);
+    EXPECT_THROW(SQLite::Blob(db, "test", "unknown", 1), SQLite::Exception);
+    {
+        SQLite::Blob blob(db, "test", "data", 1, true);
+        EXPECT_EQ(10, blob.getBytes());
+        EXPECT_EQ(1, blob.getRowid());
+        EXPECT_TRUE(blob.isReadWrite());
+        blob.write("abc", 3, 0);
+        blob.write("xyz", 3, 7);
+        EXPECT_THROW(blob.write("past", 4, 8), SQLite::Exception); // a BLOB cannot grow
+
+        char buffer[10];
+        blob.read(buffer, 10, 0);
+        EXPECT_EQ(std::string("abc\0\0\0\0xyz", 10), std::string(buffer, 10));
+        EXPECT_THROW(blob.read(buffer, 10, 1), SQLite::Exception);
+
+        // Move to another row
+        blob.reopen(2);
+        EXPECT_EQ(2, blob.getRowid());
+        EXPECT_EQ(5, blob.getBytes());
+        blob.read(buffer, 2, 3);
+        EXPECT_EQ(4, buffer[0]);
+        EXPECT_EQ(5, buffer[1]);
+    }
+    {
+        SQLite::Blob blob(db, "test", "data", 1);
+        EXPECT_FALSE(blob.isReadWrite());
+        EXPECT_THROW(blob.write("abc", 3, 0), SQLite::Exception);
+
+        // The handle expires when the row is modified
+        db.exec("UPDATE test SET data=x'00' WHERE id=1");
+        char buffer[1];
+        EXPECT_THROW(blob.read(buffer, 1, 0), SQLite::Exception);
+    }
+}
+
+TEST(Blob, streamBuf) {
+    SQLite::Database db(":memory:", SQLite::OPEN_READWRITE);
+    db.exec("CREATE TABLE test (id INTEGER PRIMARY KEY, data BLOB)");
+    db.exec("INSERT INTO test VALUES (1, zeroblob(100000))");
+
+    std::string content;
+    for (int i = 0; i < 100000; ++i)
+    {
+        content.push_back(static_cast<char>('a' + i % 26));
+    }
+    {
+        SQLite::Blob blob(db, "test", "data", 1, true);
+        SQLite::BlobStreamBuf buffer(blob, 4096);
+        std::ostream output(&buffer);
+        output << content;
+        EXPECT_TRUE(output.good());
+        output << 'x'; // a BLOB cannot grow
+        EXPECT_TRUE(output.bad());
+    }
+    {
+        SQLite::Blob blob(db, "test", "data", 1);
+        SQLite::BlobStreamBuf buffer(blob, 4096);
+        std::istream input(&buffer);
+        std::ostringstream copy;
+        copy << input.rdbuf();
+        EXPECT_EQ(content, copy.str());
+
+        // Seek and read small and large chunks
+        input.clear();
+        input.seekg(26 * 1000 + 3);
+        EXPECT_EQ('d', input.get());
+        std::string chunk(10000, '\0');
+        input.read(&chunk[0], 10000);
+        EXPECT_EQ(content.substr(26 * 1000 + 4, 10000), chunk);
+        EXPECT_EQ(26 * 1000 + 4 + 10000, input.tellg());
+        input.seekg(-2, std::ios_base::end);
+        EXPECT_EQ(content[99998], input.get());
+        EXPECT_EQ(content[99999], input.get());
+        EXPECT_EQ(std::char_traits<char>::eof(), input.get());
+    }
+    {
+        // Overwrite the middle of the BLOB, then read it back through the same buffer
+        SQLite::Blob blob(db, "test", "data", 1, true);
+        SQLite::BlobStreamBuf buffer(blob, 16);
+        std::iostream stream(&buffer);
+        stream.seekp(50000);
+        stream << "0123456789";
+        stream.seekg(49999);
+        char chunk[12];
+        stream.read(chunk, 12);
+        EXPECT_EQ(content[49999], chunk[0]);
+        EXPECT_EQ(std::string("0123456789"), std::string(chunk + 1, 10));
+        EXPECT_EQ(content[50010], chunk[11]);
+    }
+}
@@ -0,0 +1,268 @@
+/**
+ * @file    BulkInserter_test.cpp
+ * @ingroup tests
+ * @brief   Test of a SQLiteCpp BulkInserter.
+ *
+ * Copyright (c) 2012-2016 Sebastien Rombauts (sebastien.rombauts@gmail.com)
+ *
+ * Distributed under the MIT License (MIT) (See accompanying file LICENSE.txt
+ * or copy at http://opensource.org/licenses/MIT)
+ */
+
+#include <SQLiteCpp/BulkInserter.h>
+#include <SQLiteCpp/Database.h>
+#include <SQLiteCpp/Statement.h>
+#include <SQLiteCpp/Transaction.h>
+#include <SQLiteCpp/Exception.h>
+
+#include <sqlite3.h>
+#include <gtest/gtest.h>
+
+#include <cstdio>
+#include <cstring>
+#include <cstdint>
+#include <string>
+#include <tuple>
+#include <vector>
+
+
+TEST(BulkInserter, insert) {
+    SQLite::Database db(":memory:", SQLite::OPEN_READWRITE|SQLite::OPEN_CREATE);
+    db.exec("CREATE TABLE test (id INTEGER PRIMARY KEY, value TEXT, weight REAL)");
+
+    std::vector<std::string> columns;
+    columns.push_back("id");
+    columns.push_back("value");
+    columns.push_back("weight");
+    {
+        SQLite::BulkInserter inserter(db, "test", columns);
+        EXPECT_EQ(333u, inserter.getRowsPerStatement()); // 999 host parameters by default
+
+        for (int i = 1; i <= 1000; ++i)
+        {
+            inserter.insert(i, std::string("value") + std::to_string(i), i * 0.5);
+        }
+        inserter.insert(std::make_tuple(1001, "tuple", 2.5));
+        inserter.insert(1002, nullptr, nullptr);
+
+        EXPECT_THROW(inserter.insert(1003, "missing weight"), SQLite::Exception);
+
+        EXPECT_EQ(1002u, inserter.getRowCount());
+        inserter.flush();
+        EXPECT_GE(inserter.getRowsPerSecond(), 0.0);
+    }
+
+    EXPECT_EQ(1002, db.execAndGet("SELECT count(*) FROM test").getInt());
+    EXPECT_EQ("value500", db.execAndGet("SELECT value FROM test WHERE id=500").getString());
+    EXPECT_EQ(250.0, db.execAndGet("SELECT weight FROM test WHERE id=500").getDouble());
+    EXPECT_EQ("tuple", db.execAndGet("SELECT value FROM test WHERE id=1001").getString());
+    EXPECT_TRUE(db.execAndGet("SELECT value FROM test WHERE id=1002").isNull());
+}
+
+TEST(BulkInserter, insertColumns) {
+    SQLite::Database db(":memory:", SQLite::OPEN_READWRITE|SQLite::OPEN_CREATE);
+    db.exec("CREATE TABLE test (id INTEGER, name TEXT)");
+
+    std::vector<long long> ids;
+    std::vector<std::string> names;
+    for (int i = 0; i < 2000; ++i)
+    {
+        ids.push_back(i);
+        names.push_back("name" + std::to_string(i));
+    }
+
+    std::vector<std::string> columns;
+    columns.push_back("id");
+    columns.push_back("name");
+    {
+        SQLite::BulkInserter inserter(db, "test", columns);
+        inserter.insertColumns(ids, names);
+        ids.pop_back();
+        EXPECT_THROW(inserter.insertColumns(ids, names), SQLite::Exception);
+        inserter.flush();
+    }
+    EXPECT_EQ(2000, db.execAndGet("SELECT count(*) FROM test").getInt());
+    EXPECT_EQ(1999000, db.execAndGet("SELECT sum(id) FROM test").getInt());
+    EXPECT_EQ("name1234", db.execAndGet("SELECT name FROM test WHERE id=1234").getString());
+}
+
+TEST(BulkInserter, chunkedCommits) {
+    SQLite::Database db(":memory:", SQLite::OPEN_READWRITE|SQLite::OPEN_CREATE);
+    db.exec("CREATE TABLE test (id INTEGER)");
+
+    const std::vector<std::string> columns(1, "id");
+    {
+        SQLite::BulkInserter inserter(db, "test", columns, 10);
+        EXPECT_EQ(10u, inserter.getRowsPerStatement());
+        for (int i = 0; i < 25; ++i)
+        {
+            inserter.insert(i);
+        }
+        // The last 5 rows are not committed, and are rollbacked
+    }
+    EXPECT_EQ(20, db.execAndGet("SELECT count(*) FROM test").getInt());
+
+    EXPECT_THROW(SQLite::BulkInserter(db, "test", std::vector<std::string>()), SQLite::Exception);
+    EXPECT_THROW(SQLite::BulkInserter(db, "missing", columns), SQLite::Exception);
+}
+
+TEST(BulkInserter, integralTypes) {
+    SQLite::Database db(":memory:", SQLite::OPEN_READWRITE|SQLite::OPEN_CREATE);
+    db.exec("CREATE TABLE test (a INTEGER, b INTEGER, c INTEGER, d INTEGER)");
+
+    std::vector<std::string> columns;
+    columns.push_back("a");
+    columns.push_back("b");
+    columns.push_back("c");
+    columns.push_back("d");
+    {
+        SQLite::BulkInserter inserter(db, "test", columns);
+        const long l = -3000000000L;
+        const std::int64_t i64 = INT64_C(9000000000);
+        const std::size_t size = 42;
+        const unsigned long long ull = 7;
+        inserter.insert(l, i64, size, ull);
+        inserter.insert(std::make_tuple(std::int64_t(1), std::uint32_t(2), std::size_t(3), 4L));
+        inserter.insertColumns(std::vector<std::int64_t>(1, 5), std::vector<std::size_t>(1, 6),
+                               std::vector<long>(1, 7), std::vector<unsigned long>(1, 8));
+        inserter.flush();
+    }
+    EXPECT_EQ(3, db.execAndGet("SELECT count(*) FROM test").getInt());
+    EXPECT_EQ(-3000000000LL, db.execAndGet("SELECT a FROM test WHERE d=7").getInt64());
+    EXPECT_EQ(9000000000LL, db.execAndGet("SELECT b FROM test WHERE d=7").getInt64());
+    EXPECT_EQ(42, db.execAndGet("SELECT c FROM test WHERE d=7").getInt());
+    EXPECT_EQ(36, db.execAndGet("SELECT sum(a+b+c+d) FROM test WHERE d<>7").getInt());
+}
+
+TEST(BulkInserter, insideTransaction) {
+    SQLite::Database db(":memory:", SQLite::OPEN_READWRITE|SQLite::OPEN_CREATE);
+    db.exec("CREATE TABLE test (id INTEGER)");
+
+    const std::vector<std::string> columns(1, "id");
+    {
+        // The savepoints of the BulkInserter nest inside the transaction of the caller
+        SQLite::Transaction transaction(db);
+        db.exec("INSERT INTO test VALUES (-1)");
+        {
+            SQLite::BulkInserter inserter(db, "test", columns, 10);
+            for (int i = 0; i < 25; ++i)
+            {
+                inserter.insert(i);
+            }
+            // The last 5 rows are rollbacked, but not the transaction of the caller
+        }
+        EXPECT_EQ(21, db.execAndGet("SELECT count(*) FROM test").getInt());
+        transaction.commit();
+    }
+    EXPECT_EQ(21, db.execAndGet("SELECT count(*) FROM test").getInt());
+
+    {
+        // The rows released by the BulkInserter are rollbacked with the transaction of the caller
+        SQLite::Transaction transaction(db);
+        SQLite::BulkInserter inserter(db, "test", columns, 10);
+        for (int i = 0; i < 30; ++i)
+        {
+            inserter.insert(i);
+        }
+        inserter.flush();
+    }
+    EXPECT_EQ(21, db.execAndGet("SELECT count(*) FROM test").getInt());
+}
+
+TEST(BulkInserter, fastLoad) {
+    remove("bulk_test.db3");
+    {
+        SQLite::Database db("bulk_test.db3", SQLite::OPEN_READWRITE|SQLite::OPEN_CREATE);
+        db.exec("CREATE TABLE test (id INTEGER)");
+        db.exec("PRAGMA synchronous=FULL");
+        EXPECT_EQ("delete", db.execAndGet("PRAGMA journal_mode").getString());
+
+        const std::vector<std::string> columns(1, "id");
+        {
+            SQLite::BulkInserter inserter(db, "test", columns, 1000, true);
+            EXPECT_EQ(0, db.execAndGet("PRAGMA synchronous").getInt());
+            EXPECT_EQ("memory", db.execAndGet("PRAGMA journal_mode").getString());
+            for (int i = 0; i < 5000; ++i)
+            {
+                inserter.insert(i);
+            }
+            inserter.flush();
+        }
+        EXPECT_EQ(2, db.execAndGet("PRAGMA synchronous").getInt());
+        EXPECT_EQ("delete", db.execAndGet("PRAGMA journal_mode").getString());
+        EXPECT_EQ(5000, db.execAndGet("SELECT count(*) FROM test").getInt());
+    }
+    remove("bulk_test.db3");
+}
+
+TEST(BulkInserter, failedStatement) {
+    SQLite::Database db(":memory:", SQLite::OPEN_READWRITE|SQLite::OPEN_CREATE);
+    db.exec("CREATE TABLE test (id INTEGER PRIMARY KEY, value TEXT)");
+    db.exec("INSERT INTO test VALUES (3, \"duplicate\")");
+
+    // Two rows per statement
+    sqlite3_limit(db.getHandle(), SQLITE_LIMIT_VARIABLE_NUMBER, 4);
+    SQLite::BulkInserter inserter(db, "test", std::vector<std::string>{"id", "value"});
+    inserter.insert(1, "a");
+    inserter.insert(2, "b");
+    inserter.insert(3, "c");
+    EXPECT_THROW(inserter.insert(4, "d"), SQLite::Exception);
+
+    // The rows of the failed statement are discarded, and the statement has been reset
+    EXPECT_EQ(2u, inserter.getRowCount());
+    inserter.insert(5, "e");
+    inserter.flush();
+    EXPECT_EQ("a,b,duplicate,e", db.execAndGet("SELECT group_concat(value) FROM (SELECT value FROM test ORDER BY id)").getString());
+}
+
+TEST(BulkInserter, uniqueViolation) {
+    SQLite::Database db(":memory:", SQLite::OPEN_READWRITE|SQLite::OPEN_CREATE);
+    db.exec("CREATE TABLE test (id INTEGER PRIMARY KEY, value TEXT UNIQUE)");
+
+    // Two rows per statement
+    sqlite3_limit(db.getHandle(), SQLITE_LIMIT_VARIABLE_NUMBER, 4);
+    SQLite::BulkInserter inserter(db, "test", std::vector<std::string>{"id", "value"});
+    inserter.insert(1, "a");
+    inserter.insert(2, "b");
+    inserter.insert(3, "c");
+    EXPECT_THROW(inserter.insert(4, "a"), SQLite::Exception);
+
+    // The next rows are inserted, by full statements and by the tail of flush()
+    inserter.insert(5, "e");
+    inserter.insert(6, "f");
+    inserter.insert(7, "g");
+    inserter.flush();
+    EXPECT_EQ(5u, inserter.getRowCount());
+
+    // A failure of the tail of flush() does not prevent the next flush()
+    inserter.insert(8, "b");
+    EXPECT_THROW(inserter.flush(), SQLite::Exception);
+    inserter.insert(9, "i");
+    inserter.flush();
+    EXPECT_EQ(6u, inserter.getRowCount());
+    EXPECT_EQ("a,b,e,f,g,i", db.execAndGet("SELECT group_concat(value) FROM (SELECT value FROM test ORDER BY id)").getString());
+}
+
+/// Deny any change of the journal mode
+static int denyJournalMode(void*, int aAction, const char* apArg1, const char* apArg2, const char*, const char*)
+{
+    return ((SQLITE_PRAGMA == aAction) && (0 == strcmp(apArg1, "journal_mode")) && (NULL != apArg2)) ? SQLITE_DENY : SQLITE_OK;
+}
+
+TEST(BulkInserter, fastLoadFailure) {
+    remove("bulk_test.db3");
+    {
+        SQLite::Database db("bulk_test.db3", SQLite::OPEN_READWRITE|SQLite::OPEN_CREATE);
+        db.exec("CREATE TABLE test (id INTEGER)");
+        db.exec("PRAGMA synchronous=FULL");
+
+        // The synchronous setting is restored when the constructor throws after changing it
+        sqlite3_set_authorizer(db.getHandle(), &denyJournalMode, NULL);
+        const std::vector<std::string> columns(1, "id");
+        EXPECT_THROW(SQLite::BulkInserter inserter(db, "test", columns, 1000, true), SQLite::Exception);
+        sqlite3_set_authorizer(db.getHandle(), NULL, NULL);
+        EXPECT_EQ(2, db.execAndGet("PRAGMA synchronous").getInt());
+        EXPECT_EQ("delete", db.execAndGet("PRAGMA journal_mode").getString());
+    }
+    remove("bulk_test.db3");
+}
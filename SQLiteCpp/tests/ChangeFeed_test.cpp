@@ -0,0 +1,202 @@
+/**
+ * @file    ChangeFeed_test.cpp
+ * @ingroup tests
+ * @brief   Test of a SQLiteCpp ChangeFeed.
+ *
+ * Copyright (c) 2012-2016 Sebastien Rombauts (sebastien.rombauts@gmail.com)
+ *
+ * Distributed under the MIT License (MIT) (See accompanying file LICENSE.txt
+ * or copy at http://opensource.org/licenses/MIT)
+ */
+
+#include <SQLiteCpp/ChangeFeed.h>
+#include <SQLiteCpp/Database.h>
+#include <SQLiteCpp/Statement.h>
+#include <SQLiteCpp/Transaction.h>
+#include <SQLiteCpp/Exception.h>
+
+#include <gtest/gtest.h>
+
+#include <cstdio>
+#include <functional>
+#include <future>
+#include <mutex>
+#include <vector>
+
+
+/// Subscriber recording the batches it receives
+struct Recorder
+{
+    std::mutex                      mMutex;
+    std::vector<SQLite::ChangeBatch> mBatches;
+
+    void operator()(const SQLite::ChangeBatch& aBatch)
+    {
+        std::lock_guard<std::mutex> lock(mMutex);
+        mBatches.push_back(aBatch);
+    }
+};
+
+TEST(ChangeFeed, transactions) {
+    SQLite::Database db(":memory:", SQLite::OPEN_READWRITE);
+    db.exec("CREATE TABLE users (id INTEGER PRIMARY KEY, name TEXT)");
+    db.exec("CREATE TABLE orders (id INTEGER PRIMARY KEY, user_id INTEGER)");
+
+    SQLite::ChangeFeed feed(db);
+    Recorder all;
+    Recorder users;
+    feed.subscribe(std::ref(all));
+    const int subscription = feed.subscribe(std::ref(users), "users");
+
+    // A statement in autocommit mode
+    db.exec("INSERT INTO users VALUES (1, 'first')");
+
+    // A transaction of several statements is published as one batch, in the order of the changes
+    {
+        SQLite::Transaction transaction(db);
+        db.exec("INSERT INTO users VALUES (2, 'second')");
+        db.exec("INSERT INTO orders VALUES (10, 2)");
+        db.exec("UPDATE users SET name = 'changed' WHERE id = 1");
+        db.exec("DELETE FROM users WHERE id = 2");
+        feed.flush();
+        {
+            std::lock_guard<std::mutex> lock(all.mMutex);
+            EXPECT_EQ(1u, all.mBatches.size()); // Not published before the commit
+        }
+        transaction.commit();
+    }
+    // A rolled back transaction is not published
+    {
+        SQLite::Transaction transaction(db);
+        db.exec("INSERT INTO users VALUES (3, 'third')");
+    }
+    {
+        SQLite::Transaction transaction(db);
+        db.exec("INSERT INTO users VALUES (3, 'third')");
+        db.exec("INSERT INTO orders VALUES (11, 1)");
+        transaction.commit();
+    }
+    feed.flush();
+
+    ASSERT_EQ(3u, all.mBatches.size());
+    EXPECT_EQ(1u, all.mBatches[0].mSequence);
+    EXPECT_FALSE(all.mBatches[0].mbOverflow);
+    ASSERT_EQ(1u, all.mBatches[0].mChanges.size());
+    EXPECT_EQ("main", all.mBatches[0].mChanges[0].mDatabase);
+    EXPECT_EQ("users", all.mBatches[0].mChanges[0].mTable);
+    EXPECT_EQ(SQLite::CHANGE_INSERT, all.mBatches[0].mChanges[0].mOperation);
+    EXPECT_EQ(1, all.mBatches[0].mChanges[0].mRowId);
+    EXPECT_EQ(2u, all.mBatches[1].mSequence);
+    ASSERT_EQ(4u, all.mBatches[1].mChanges.size());
+    EXPECT_EQ("orders", all.mBatches[1].mChanges[1].mTable);
+    EXPECT_EQ(SQLite::CHANGE_UPDATE, all.mBatches[1].mChanges[2].mOperation);
+    EXPECT_EQ(1, all.mBatches[1].mChanges[2].mRowId);
+    EXPECT_EQ(SQLite::CHANGE_DELETE, all.mBatches[1].mChanges[3].mOperation);
+    EXPECT_EQ(2, all.mBatches[1].mChanges[3].mRowId);
+    ASSERT_EQ(2u, all.mBatches[2].mChanges.size());
+    EXPECT_EQ(3, all.mBatches[2].mChanges[0].mRowId);
+
+    // The subscription to a table only receives its changes
+    ASSERT_EQ(3u, users.mBatches.size());
+    EXPECT_EQ(3u, users.mBatches[1].mChanges.size());
+    EXPECT_EQ(1u, users.mBatches[2].mChanges.size());
+
+    const SQLite::ChangeFeed::Stats stats = feed.getStats();
+    EXPECT_EQ(3u, stats.mCommittedBatches);
+    EXPECT_EQ(1u, stats.mRolledBackBatches);
+    EXPECT_EQ(0u, stats.mDroppedBatches);
+    EXPECT_EQ(7u, stats.mChanges);
+
+    EXPECT_TRUE(feed.unsubscribe(subscription));
+    EXPECT_FALSE(feed.unsubscribe(subscription));
+    db.exec("UPDATE users SET name = 'again'");
+    feed.flush();
+    EXPECT_EQ(4u, all.mBatches.size());
+    EXPECT_EQ(3u, users.mBatches.size());
+}
+
+TEST(ChangeFeed, busyCommit) {
+    remove("test_changefeed.db3");
+    SQLite::Database db("test_changefeed.db3", SQLite::OPEN_READWRITE|SQLite::OPEN_CREATE);
+    db.exec("CREATE TABLE users (id INTEGER PRIMARY KEY, name TEXT)");
+    db.exec("INSERT INTO users VALUES (1, 'first'), (2, 'second')");
+
+    SQLite::ChangeFeed feed(db);
+    Recorder all;
+    feed.subscribe(std::ref(all));
+
+    // A reader in the middle of a query prevents the commit of the rollback journal
+    SQLite::Database reader("test_changefeed.db3", SQLite::OPEN_READONLY);
+    SQLite::Statement query(reader, "SELECT * FROM users");
+    ASSERT_TRUE(query.executeStep());
+
+    db.exec("BEGIN");
+    db.exec("INSERT INTO users VALUES (3, 'third')");
+    EXPECT_THROW(db.exec("COMMIT"), SQLite::Exception);
+    feed.flush();
+    EXPECT_TRUE(all.mBatches.empty());
+
+    // Published once the retry succeeds
+    query.reset();
+    db.exec("COMMIT");
+    feed.flush();
+    ASSERT_EQ(1u, all.mBatches.size());
+    ASSERT_EQ(1u, all.mBatches[0].mChanges.size());
+    EXPECT_EQ(3, all.mBatches[0].mChanges[0].mRowId);
+    remove("test_changefeed.db3");
+}
+
+TEST(ChangeFeed, fullQueue) {
+    SQLite::Database db(":memory:", SQLite::OPEN_READWRITE);
+    db.exec("CREATE TABLE users (id INTEGER PRIMARY KEY, name TEXT)");
+
+    // A slow subscriber, blocked on the first batch
+    std::promise<void> entered;
+    std::promise<void> release;
+    std::shared_future<void> released = release.get_future().share();
+    std::vector<unsigned long long> sequences;
+    std::vector<bool> overflows;
+    SQLite::ChangeFeed feed(db, 2);
+    feed.subscribe([&](const SQLite::ChangeBatch& aBatch) {
+        sequences.push_back(aBatch.mSequence);
+        overflows.push_back(aBatch.mbOverflow);
+        if (1u == aBatch.mSequence)
+        {
+            entered.set_value();
+            released.wait();
+        }
+    });
+    // A subscriber of another table receives only the batch flagged by the overflow, without changes
+    Recorder other;
+    feed.subscribe(std::ref(other), "groups");
+
+    db.exec("INSERT INTO users VALUES (1, 'first')");
+    entered.get_future().wait();
+    for (int i = 2; i <= 5; ++i)
+    {
+        db.exec("INSERT INTO users VALUES (" + std::to_string(i) + ", 'next')");
+    }
+    release.set_value();
+    feed.flush();
+    db.exec("INSERT INTO users VALUES (6, 'last')");
+    feed.flush();
+
+    // Batches 4 and 5 were dropped, revealed by the gap before the batch 6
+    const unsigned long long expected[] = { 1, 2, 3, 6 };
+    EXPECT_EQ(std::vector<unsigned long long>(expected, expected + 4), sequences);
+    const bool expectedOverflows[] = { false, false, false, true };
+    EXPECT_EQ(std::vector<bool>(expectedOverflows, expectedOverflows + 4), overflows);
+    EXPECT_EQ(2u, feed.getStats().mDroppedBatches);
+    EXPECT_EQ(4u, feed.getStats().mCommittedBatches);
+
+    ASSERT_EQ(1u, other.mBatches.size());
+    EXPECT_EQ(6u, other.mBatches[0].mSequence);
+    EXPECT_TRUE(other.mBatches[0].mbOverflow);
+    EXPECT_TRUE(other.mBatches[0].mChanges.empty());
+
+    // The flag is cleared by the batch carrying it
+    db.exec("INSERT INTO users VALUES (7, 'after')");
+    feed.flush();
+    ASSERT_EQ(5u, overflows.size());
+    EXPECT_FALSE(overflows[4]);
+}
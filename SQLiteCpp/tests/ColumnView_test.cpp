@@ -0,0 +1,126 @@
+/**
+ * @file    ColumnView_test.cpp
+ * @ingroup tests
+ * @brief   Test of the non-owning ColumnView and of the typed Statement::getColumns().
+ *
+ * Copyright (c) 2012-2016 Sebastien Rombauts (sebastien.rombauts@gmail.com)
+ *
+ * Distributed under the MIT License (MIT) (See accompanying file LICENSE.txt
+ * or copy at http://opensource.org/licenses/MIT)
+ */
+
+#include <SQLiteCpp/Database.h>
+#include <SQLiteCpp/Statement.h>
+#include <SQLiteCpp/Column.h>
+#include <SQLiteCpp/ColumnView.h>
+
+#include <gtest/gtest.h>
+
+#include <string>
+
+
+TEST(ColumnView, basis) {
+    SQLite::Database db(":memory:", SQLite::OPEN_READWRITE|SQLite::OPEN_CREATE);
+    EXPECT_EQ(0, db.exec("CREATE TABLE test (id INTEGER PRIMARY KEY, msg TEXT, int INTEGER, double REAL, binary BLOB)"));
+    EXPECT_EQ(1, db.exec("INSERT INTO test VALUES (NULL, \"first\", -123, 0.123, x'00016100')"));
+    EXPECT_EQ(1, db.exec("INSERT INTO test VALUES (NULL, NULL, 4294967295, NULL, NULL)"));
+
+    SQLite::Statement query(db, "SELECT * FROM test ORDER BY id");
+    EXPECT_THROW(query.getColumnView(0), SQLite::Exception);
+
+    EXPECT_TRUE(query.executeStep());
+    {
+        const SQLite::ColumnView id = query.getColumnView(0);
+        EXPECT_EQ(0, id.getIndex());
+        EXPECT_STREQ("id", id.getName());
+        EXPECT_EQ(SQLite::INTEGER, id.getType());
+        EXPECT_EQ(1, id.getInt());
+        EXPECT_EQ(1LL, id.getInt64());
+
+        EXPECT_STREQ("first", query.getColumnView("msg").getText());
+        EXPECT_EQ(std::string("first"), query.getColumnView(1).getString());
+        EXPECT_EQ(5, query.getColumnView(1).getBytes());
+        EXPECT_EQ(-123, query.getColumnView("int").getInt());
+        EXPECT_DOUBLE_EQ(0.123, query.getColumnView("double").getDouble());
+
+        const SQLite::ColumnView binary = query.getColumnView(4);
+        EXPECT_EQ(SQLite::BLOB, binary.getType());
+        EXPECT_EQ(std::string("\x00\x01\x61\x00", 4), binary.getString());
+        EXPECT_EQ(4, binary.getBytes());
+    }
+    EXPECT_THROW(query.getColumnView(5), SQLite::Exception);
+    EXPECT_THROW(query.getColumnView(-1), SQLite::Exception);
+    EXPECT_THROW(query.getColumnView("unknown"), SQLite::Exception);
+
+    EXPECT_TRUE(query.executeStep());
+    EXPECT_TRUE(query.getColumnView(1).isNull());
+    EXPECT_STREQ("default", query.getColumnView(1).getText("default"));
+    EXPECT_EQ(4294967295u, query.getColumnView(2).getUInt());
+
+#if (__cplusplus >= 201703L) || (defined(_MSVC_LANG) && (_MSVC_LANG >= 201703L))
+    EXPECT_TRUE(query.getColumnView(4).getStringView().empty());
+    EXPECT_TRUE(query.getColumn(4).getStringView().empty());
+    query.reset();
+    EXPECT_TRUE(query.executeStep());
+    EXPECT_EQ(std::string_view("first"), query.getColumnView(1).getStringView());
+    EXPECT_EQ(std::string_view("\x00\x01\x61\x00", 4), query.getColumn(4).getStringView());
+#endif
+
+    EXPECT_FALSE(query.executeStep() && query.executeStep());
+    EXPECT_THROW(query.getColumnView(0), SQLite::Exception);
+}
+
+TEST(ColumnView, columnNames) {
+    SQLite::Database db(":memory:", SQLite::OPEN_READWRITE|SQLite::OPEN_CREATE);
+
+    // With duplicated names, the last column wins
+    SQLite::Statement query(db, "SELECT 1 AS b, 2 AS a, 3 AS c, 4 AS a");
+    EXPECT_EQ(0, query.getColumnIndex("b"));
+    EXPECT_EQ(3, query.getColumnIndex("a"));
+    EXPECT_EQ(2, query.getColumnIndex("c"));
+    EXPECT_THROW(query.getColumnIndex("aa"), SQLite::Exception);
+    EXPECT_THROW(query.getColumnIndex(""), SQLite::Exception);
+    EXPECT_THROW(query.getColumnIndex("d"), SQLite::Exception);
+
+    EXPECT_TRUE(query.executeStep());
+    EXPECT_EQ(4, query.getColumnView("a").getInt());
+    EXPECT_EQ(4, query.getColumn("a").getInt());
+}
+
+#if (__cplusplus >= 201402L) || ( defined(_MSC_VER) && (_MSC_VER >= 1900) ) // c++14: Visual Studio 2015
+TEST(ColumnView, getColumns) {
+    SQLite::Database db(":memory:", SQLite::OPEN_READWRITE|SQLite::OPEN_CREATE);
+    EXPECT_EQ(0, db.exec("CREATE TABLE test (id INTEGER PRIMARY KEY, msg TEXT, weight REAL)"));
+    EXPECT_EQ(1, db.exec("INSERT INTO test VALUES (1, \"first\", 0.5)"));
+    EXPECT_EQ(1, db.exec("INSERT INTO test VALUES (2, \"second\", 1.5)"));
+
+    SQLite::Statement query(db, "SELECT id, msg, weight FROM test ORDER BY id");
+    EXPECT_THROW(query.getColumns<int>(), SQLite::Exception);
+
+    EXPECT_TRUE(query.executeStep());
+    int id = 0;
+    std::string msg;
+    double weight = 0.0;
+    std::tie(id, msg, weight) = query.getColumns<int, std::string, double>();
+    EXPECT_EQ(1, id);
+    EXPECT_EQ("first", msg);
+    EXPECT_EQ(0.5, weight);
+
+    // Fewer types than columns is fine, more is an error
+    EXPECT_EQ(1LL, std::get<0>(query.getColumns<long long>()));
+    EXPECT_THROW((query.getColumns<int, int, int, int>()), SQLite::Exception);
+
+    EXPECT_TRUE(query.executeStep());
+    const std::tuple<unsigned, const char*, SQLite::ColumnView> row =
+        query.getColumns<unsigned, const char*, SQLite::ColumnView>();
+    EXPECT_EQ(2u, std::get<0>(row));
+    EXPECT_STREQ("second", std::get<1>(row));
+    EXPECT_EQ(1.5, std::get<2>(row).getDouble());
+
+#if (__cplusplus >= 201703L) || (defined(_MSVC_LANG) && (_MSVC_LANG >= 201703L))
+    const auto [rowId, rowMsg] = query.getColumns<int, std::string_view>();
+    EXPECT_EQ(2, rowId);
+    EXPECT_EQ("second", rowMsg);
+#endif
+}
+#endif // c++14
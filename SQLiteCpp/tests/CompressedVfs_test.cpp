@@ -0,0 +1,197 @@
+/**
+ * @file    CompressedVfs_test.cpp
+ * @ingroup tests
+ * @brief   Test of the SQLiteCpp CompressedVfs.
+ *
+ * Copyright (c) 2012-2016 Sebastien Rombauts (sebastien.rombauts@gmail.com)
+ *
+ * Distributed under the MIT License (MIT) (See accompanying file LICENSE.txt
+ * or copy at http://opensource.org/licenses/MIT)
+ */
+
+#include <SQLiteCpp/CompressedVfs.h>
+#include <SQLiteCpp/Database.h>
+#include <SQLiteCpp/Statement.h>
+#include <SQLiteCpp/Transaction.h>
+#include <SQLiteCpp/Exception.h>
+
+#include <sqlite3.h> // for sqlite3_file_control()
+
+#include <gtest/gtest.h>
+
+#include <cstdio>
+#include <fstream>
+#include <string>
+
+
+/// Return the size of a file, in bytes
+static long long getFileSize(const char* apFilename)
+{
+    std::ifstream file(apFilename, std::ios::binary | std::ios::ate);
+    return static_cast<long long>(file.tellg());
+}
+
+/// Insert compressible JSON documents in a table
+static void insertDocuments(SQLite::Database& aDatabase, const int aCount)
+{
+    SQLite::Transaction transaction(aDatabase);
+    SQLite::Statement insert(aDatabase, "INSERT INTO docs (doc) VALUES (?)");
+    for (int i = 0; i < aCount; ++i)
+    {
+        const std::string id = std::to_string(i);
+        insert.bind(1, "{\"id\":" + id + ",\"name\":\"user " + id + "\",\"email\":\"user" + id
+                     + "@example.com\",\"tags\":[\"alpha\",\"beta\",\"gamma\"],\"active\":true}");
+        insert.exec();
+        insert.reset();
+    }
+    transaction.commit();
+}
+
+TEST(CompressedVfs, roundTrip) {
+    remove("test_plain.db3");
+    remove("test_compressed.db3");
+    SQLite::CompressedVfs vfs("zlib_test");
+    EXPECT_EQ("zlib_test", vfs.getName());
+    {
+        SQLite::Database plain("test_plain.db3", SQLite::OPEN_READWRITE|SQLite::OPEN_CREATE);
+        plain.exec("CREATE TABLE docs (id INTEGER PRIMARY KEY, doc TEXT)");
+        insertDocuments(plain, 5000);
+
+        SQLite::Database db("test_compressed.db3", SQLite::OPEN_READWRITE|SQLite::OPEN_CREATE, 0, vfs.getName());
+        db.exec("CREATE TABLE docs (id INTEGER PRIMARY KEY, doc TEXT)");
+        insertDocuments(db, 5000);
+        EXPECT_EQ(5000, db.execAndGet("SELECT count(*) FROM docs").getInt());
+    }
+    EXPECT_LT(getFileSize("test_compressed.db3") * 2, getFileSize("test_plain.db3"));
+
+    SQLite::CompressedVfs::Stats stats = vfs.getStats();
+    EXPECT_LT(0u, stats.mPagesWritten);
+    EXPECT_LT(stats.mCompressedBytes * 2, stats.mBytesWritten);
+    EXPECT_LE(2u, stats.mCommits);
+    EXPECT_EQ(0u, stats.mChecksumErrors);
+    vfs.resetStats();
+
+    // Reopened: the pages are decompressed and their checksums verified
+    {
+        SQLite::Database db("test_compressed.db3", SQLite::OPEN_READWRITE, 0, vfs.getName());
+        EXPECT_EQ("ok", db.execAndGet("PRAGMA integrity_check").getString());
+        EXPECT_EQ("{\"id\":4321,\"name\":\"user 4321\",\"email\":\"user4321@example.com\",\"tags\":[\"alpha\",\"beta\",\"gamma\"],\"active\":true}",
+                  db.execAndGet("SELECT doc FROM docs WHERE id = 4322").getString());
+
+        // A rolled back transaction leaves the database unchanged
+        {
+            SQLite::Transaction transaction(db);
+            db.exec("DELETE FROM docs WHERE id > 100");
+            EXPECT_EQ(100, db.execAndGet("SELECT count(*) FROM docs").getInt());
+        }
+        EXPECT_EQ(5000, db.execAndGet("SELECT count(*) FROM docs").getInt());
+
+        // The free space of the container is reused, and its end truncated
+        const long long size = getFileSize("test_compressed.db3");
+        db.exec("DELETE FROM docs WHERE id > 100");
+        db.exec("VACUUM");
+        EXPECT_LT(getFileSize("test_compressed.db3") * 4, size);
+        EXPECT_EQ(100, db.execAndGet("SELECT count(*) FROM docs").getInt());
+        EXPECT_EQ("ok", db.execAndGet("PRAGMA integrity_check").getString());
+    }
+    stats = vfs.getStats();
+    EXPECT_LT(0u, stats.mPagesRead);
+    EXPECT_EQ(0u, stats.mChecksumErrors);
+
+    // A database of the default VFS is not a container
+    EXPECT_THROW(SQLite::Database("test_plain.db3", SQLite::OPEN_READWRITE, 0, vfs.getName()), SQLite::Exception);
+    // The name of a VFS is unique
+    EXPECT_THROW(SQLite::CompressedVfs("zlib_test"), SQLite::Exception);
+
+    remove("test_plain.db3");
+    remove("test_compressed.db3");
+}
+
+TEST(CompressedVfs, connections) {
+    remove("test_compressed.db3");
+    SQLite::CompressedVfs vfs("zlib_test", 1, 0);
+    SQLite::Database writer("test_compressed.db3", SQLite::OPEN_READWRITE|SQLite::OPEN_CREATE, 0, vfs.getName());
+    writer.exec("PRAGMA synchronous=OFF");
+    writer.exec("CREATE TABLE docs (id INTEGER PRIMARY KEY, doc TEXT)");
+    SQLite::Database reader("test_compressed.db3", SQLite::OPEN_READONLY, 0, vfs.getName());
+    EXPECT_EQ(0, reader.execAndGet("SELECT count(*) FROM docs").getInt());
+
+    // The page map committed by a connection is reloaded by the others, even without sync
+    insertDocuments(writer, 1000);
+    EXPECT_EQ(1000, reader.execAndGet("SELECT count(*) FROM docs").getInt());
+    writer.exec("DELETE FROM docs WHERE id % 2 = 0");
+    EXPECT_EQ(500, reader.execAndGet("SELECT count(*) FROM docs").getInt());
+    EXPECT_EQ("ok", reader.execAndGet("PRAGMA integrity_check").getString());
+    EXPECT_EQ(0u, vfs.getStats().mCacheHits);
+
+    // The WAL journal mode requires the exclusive locking mode
+    EXPECT_EQ("delete", writer.execAndGet("PRAGMA journal_mode=WAL").getString());
+
+    remove("test_compressed.db3");
+}
+
+TEST(CompressedVfs, checksum) {
+    remove("test_compressed.db3");
+    SQLite::CompressedVfs vfs("zlib_test");
+    {
+        SQLite::Database db("test_compressed.db3", SQLite::OPEN_READWRITE|SQLite::OPEN_CREATE, 0, vfs.getName());
+        db.exec("CREATE TABLE docs (id INTEGER PRIMARY KEY, doc TEXT)");
+        insertDocuments(db, 1000);
+    }
+
+    // Corrupt one byte in each kilobyte of the content of the container, after its headers
+    {
+        std::fstream file("test_compressed.db3", std::ios::in | std::ios::out | std::ios::binary);
+        file.seekg(0, std::ios::end);
+        const long long size = static_cast<long long>(file.tellg());
+        for (long long offset = 1024 + 100; offset < size; offset += 1024)
+        {
+            char byte = 0;
+            file.seekg(offset);
+            file.get(byte);
+            file.seekp(offset);
+            file.put(static_cast<char>(byte ^ 0x5a));
+        }
+    }
+    EXPECT_THROW({
+        SQLite::Database db("test_compressed.db3", SQLite::OPEN_READONLY, 0, vfs.getName());
+        db.execAndGet("SELECT count(*), sum(length(doc)) FROM docs");
+    }, SQLite::Exception);
+    EXPECT_LT(0u, vfs.getStats().mChecksumErrors);
+
+    remove("test_compressed.db3");
+}
+
+TEST(CompressedVfs, fileControl) {
+    remove("test_compressed.db3");
+    SQLite::CompressedVfs vfs("zlib_test");
+    {
+        SQLite::Database db("test_compressed.db3", SQLite::OPEN_READWRITE|SQLite::OPEN_CREATE, 0, vfs.getName());
+        db.exec("CREATE TABLE docs (id INTEGER PRIMARY KEY, doc TEXT)");
+
+        // The file controls not handled by the VFS are those of the container file
+        char* pName = NULL;
+        EXPECT_EQ(SQLITE_OK, sqlite3_file_control(db.getHandle(), "main", SQLITE_FCNTL_VFSNAME, &pName));
+        ASSERT_TRUE(NULL != pName);
+        EXPECT_EQ(0, std::string(pName).find("zlib_test/"));
+        sqlite3_free(pName);
+
+        int persist = 1;
+        EXPECT_EQ(SQLITE_OK, sqlite3_file_control(db.getHandle(), "main", SQLITE_FCNTL_PERSIST_WAL, &persist));
+        persist = -1;
+        EXPECT_EQ(SQLITE_OK, sqlite3_file_control(db.getHandle(), "main", SQLITE_FCNTL_PERSIST_WAL, &persist));
+        EXPECT_EQ(1, persist);
+
+        sqlite3_int64 hint = 1024 * 1024;
+        EXPECT_EQ(SQLITE_OK, sqlite3_file_control(db.getHandle(), "main", SQLITE_FCNTL_SIZE_HINT, &hint));
+
+        // The commit hint still commits the page map
+        insertDocuments(db, 100);
+        EXPECT_EQ("ok", db.execAndGet("PRAGMA integrity_check").getString());
+    }
+    {
+        SQLite::Database db("test_compressed.db3", SQLite::OPEN_READONLY, 0, vfs.getName());
+        EXPECT_EQ(100, db.execAndGet("SELECT count(*) FROM docs").getInt());
+    }
+    remove("test_compressed.db3");
+}
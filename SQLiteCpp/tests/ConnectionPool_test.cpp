@@ -0,0 +1,166 @@
+/**
+ * @file    ConnectionPool_test.cpp
+ * @ingroup tests
+ * @brief   Test of a SQLiteCpp ConnectionPool.
+ *
+ * Copyright (c) 2012-2016 Sebastien Rombauts (sebastien.rombauts@gmail.com)
+ *
+ * Distributed under the MIT License (MIT) (See accompanying file LICENSE.txt
+ * or copy at http://opensource.org/licenses/MIT)
+ */
+
+#include <SQLiteCpp/ConnectionPool.h>
+#include <SQLiteCpp/Statement.h>
+#include <SQLiteCpp/Exception.h>
+
+#include <gtest/gtest.h>
+
+#include <cstdio>
+#include <atomic>
+#include <thread>
+#include <vector>
+
+
+TEST(ConnectionPool, setup) {
+    remove("pool_test.db3");
+    {
+        int setupCount = 0;
+        SQLite::ConnectionPool pool("pool_test.db3", 3, [&setupCount](SQLite::Database& aDatabase) {
+            ++setupCount;
+            aDatabase.exec("PRAGMA cache_size=100");
+        });
+        EXPECT_EQ(4, setupCount);
+        EXPECT_EQ(3u, pool.getReaderCount());
+        EXPECT_EQ(3u, pool.getIdleReaderCount());
+
+        SQLite::ConnectionPool::Connection writer = pool.acquireWriter();
+        EXPECT_TRUE(writer.isWriter());
+        EXPECT_EQ("wal", writer->execAndGet("PRAGMA journal_mode").getString());
+        EXPECT_EQ(100, writer->execAndGet("PRAGMA cache_size").getInt());
+        EXPECT_EQ(16u, writer->getStatementCache().getCapacity());
+
+        SQLite::ConnectionPool::Connection reader = pool.acquireReader();
+        EXPECT_FALSE(reader.isWriter());
+        EXPECT_EQ(100, reader->execAndGet("PRAGMA cache_size").getInt());
+        EXPECT_EQ(2u, pool.getIdleReaderCount());
+    }
+    remove("pool_test.db3");
+
+    // An in-memory database cannot use WAL
+    EXPECT_THROW(SQLite::ConnectionPool(":memory:", 1), SQLite::Exception);
+    EXPECT_THROW(SQLite::ConnectionPool("pool_test.db3", 0), SQLite::Exception);
+    remove("pool_test.db3");
+}
+
+TEST(ConnectionPool, writeTransaction) {
+    remove("pool_test.db3");
+    {
+        SQLite::ConnectionPool pool("pool_test.db3", 2);
+        {
+            SQLite::ConnectionPool::WriteTransaction transaction(pool);
+            transaction.getDatabase().exec("CREATE TABLE test (id INTEGER PRIMARY KEY, value TEXT)");
+            transaction.getDatabase().exec("INSERT INTO test VALUES (1, \"first\")");
+
+            // The writer is checked out for the duration of the transaction
+            EXPECT_THROW(pool.acquireWriter(0), SQLite::Exception);
+
+            // Readers do not see uncommitted changes
+            SQLite::ConnectionPool::Connection reader = pool.acquireReader();
+            EXPECT_FALSE(reader->tableExists("test"));
+
+            transaction.commit();
+        }
+        {
+            // Rollbacked when not committed
+            SQLite::ConnectionPool::WriteTransaction transaction(pool, 0);
+            transaction.getDatabase().exec("INSERT INTO test VALUES (2, \"second\")");
+        }
+
+        SQLite::ConnectionPool::Connection reader = pool.acquireReader();
+        EXPECT_EQ(1, reader->execAndGet("SELECT count(*) FROM test").getInt());
+
+        // Readers are read-only
+        EXPECT_THROW(reader->exec("INSERT INTO test VALUES (3, \"third\")"), SQLite::Exception);
+    }
+    remove("pool_test.db3");
+}
+
+TEST(ConnectionPool, timeout) {
+    remove("pool_test.db3");
+    {
+        SQLite::ConnectionPool pool("pool_test.db3", 1);
+        {
+            SQLite::ConnectionPool::Connection reader = pool.acquireReader();
+            EXPECT_EQ(0u, pool.getIdleReaderCount());
+            EXPECT_THROW(pool.acquireReader(10), SQLite::Exception);
+
+            // Moving the handle does not give the connection back
+            SQLite::ConnectionPool::Connection moved(std::move(reader));
+            EXPECT_EQ(0u, pool.getIdleReaderCount());
+        }
+        EXPECT_EQ(1u, pool.getIdleReaderCount());
+
+        // A waiting thread gets the connection as soon as it is given back
+        SQLite::ConnectionPool::Connection* pReader = new SQLite::ConnectionPool::Connection(pool.acquireReader());
+        std::thread releaser([pReader] {
+            std::this_thread::sleep_for(std::chrono::milliseconds(20));
+            delete pReader;
+        });
+        SQLite::ConnectionPool::Connection reader = pool.acquireReader(10000);
+        releaser.join();
+    }
+    remove("pool_test.db3");
+}
+
+TEST(ConnectionPool, concurrentReaders) {
+    remove("pool_test.db3");
+    {
+        SQLite::ConnectionPool pool("pool_test.db3", 4);
+        {
+            SQLite::ConnectionPool::WriteTransaction transaction(pool);
+            transaction.getDatabase().exec("CREATE TABLE test (id INTEGER PRIMARY KEY, value INTEGER)");
+            SQLite::Statement insert(transaction.getDatabase(), "INSERT INTO test VALUES (NULL, ?)");
+            for (int i = 1; i <= 100; ++i)
+            {
+                insert.bind(1, i);
+                EXPECT_EQ(1, insert.exec());
+                insert.reset();
+            }
+            transaction.commit();
+        }
+
+        std::atomic<int> failures(0);
+        std::vector<std::thread> threads;
+        for (int t = 0; t < 8; ++t)
+        {
+            threads.push_back(std::thread([&pool, &failures] {
+                for (int i = 0; i < 50; ++i)
+                {
+                    SQLite::ConnectionPool::Connection reader = pool.acquireReader();
+                    if (5050 != reader->execAndGet("SELECT sum(value) FROM test").getInt())
+                    {
+                        ++failures;
+                    }
+                }
+            }));
+        }
+        // Writes go on while reading
+        for (int i = 0; i < 10; ++i)
+        {
+            SQLite::ConnectionPool::WriteTransaction transaction(pool);
+            transaction.getDatabase().exec("UPDATE test SET value = value WHERE id = 1");
+            transaction.commit();
+        }
+        for (std::size_t t = 0; t < threads.size(); ++t)
+        {
+            threads[t].join();
+        }
+        EXPECT_EQ(0, failures.load());
+        EXPECT_EQ(4u, pool.getIdleReaderCount());
+
+        // Each reader prepared the query once, then reused it
+        SQLite::ConnectionPool::Connection reader = pool.acquireReader();
+        EXPECT_EQ(1u, reader->getStatementCache().getSize());
+    }
+    remove("pool_test.db3");
+}
@@ -0,0 +1,212 @@
+/**
+ * @file    Function_test.cpp
+ * @ingroup tests
+ * @brief   Test of the typed registration of SQL functions and aggregates.
+ *
+ * Copyright (c) 2012-2016 Sebastien Rombauts (sebastien.rombauts@gmail.com)
+ *
+ * Distributed under the MIT License (MIT) (See accompanying file LICENSE.txt
+ * or copy at http://opensource.org/licenses/MIT)
+ */
+
+#include <SQLiteCpp/Database.h>
+#include <SQLiteCpp/Statement.h>
+#include <SQLiteCpp/Exception.h>
+
+#include <gtest/gtest.h>
+
+#include <cmath>
+#include <stdexcept>
+#include <string>
+#include <vector>
+#include <algorithm>
+
+#if (__cplusplus >= 201402L) || ( defined(_MSC_VER) && (_MSC_VER >= 1900) ) // c++14: Visual Studio 2015
+
+/// Distance in kilometers between two points on Earth
+static double haversine(double aLat1, double aLon1, double aLat2, double aLon2)
+{
+    const double toRadians = 3.14159265358979323846 / 180.0;
+    const double dLat = (aLat2 - aLat1) * toRadians;
+    const double dLon = (aLon2 - aLon1) * toRadians;
+    const double a = std::sin(dLat / 2) * std::sin(dLat / 2)
+                   + std::cos(aLat1 * toRadians) * std::cos(aLat2 * toRadians) * std::sin(dLon / 2) * std::sin(dLon / 2);
+    return 6371.0 * 2 * std::atan2(std::sqrt(a), std::sqrt(1 - a));
+}
+
+TEST(Function, scalar) {
+    SQLite::Database db(":memory:", SQLite::OPEN_READWRITE);
+
+    // Function pointer and lambdas, with arguments and result types deduced at compile time
+    db.function("haversine", &haversine);
+    EXPECT_NEAR(343.5, db.execAndGet("SELECT haversine(48.8566, 2.3522, 51.5074, -0.1278)").getDouble(), 1.0);
+
+    int calls = 0;
+    db.function("twice", [&calls](long long aValue) { ++calls; return 2 * aValue; });
+    EXPECT_EQ(84, db.execAndGet("SELECT twice(42)").getInt64());
+    EXPECT_EQ(84, db.execAndGet("SELECT twice('42')").getInt64());
+    EXPECT_EQ(2, calls);
+
+    db.function("greet", [](const std::string& aName, const bool abPolite)
+    {
+        return (abPolite ? "Hello " : "Hi ") + aName;
+    });
+    EXPECT_EQ("Hello Bob", db.execAndGet("SELECT greet('Bob', 1)").getString());
+    EXPECT_EQ("Hi 12", db.execAndGet("SELECT greet(12, 0)").getString());
+
+    // const char* is NULL for a NULL argument, and a NULL result
+    db.function("echo", [](const char* apText) { return apText; });
+    EXPECT_TRUE(db.execAndGet("SELECT echo(NULL)").isNull());
+    EXPECT_EQ("text", db.execAndGet("SELECT echo('text')").getString());
+    // A blob, which has no terminating NUL character, is converted to text
+    db.function("length_c", [](const char* apText) { return static_cast<int>(std::char_traits<char>::length(apText)); });
+    EXPECT_EQ(3, db.execAndGet("SELECT length_c(x'616263')").getInt());
+    EXPECT_EQ(3, db.execAndGet("SELECT length_c(substr(x'61626364', 1, 3))").getInt());
+    EXPECT_EQ(0, db.execAndGet("SELECT length_c(x'')").getInt());
+
+    // void and nullptr are NULL
+    db.function("nothing", [](int) {});
+    EXPECT_TRUE(db.execAndGet("SELECT nothing(1)").isNull());
+
+    // The number of arguments is checked by SQLite
+    EXPECT_THROW(db.execAndGet("SELECT twice(1, 2)"), SQLite::Exception);
+
+    // An exception fails the statement with its message
+    db.function("fail", [](int aValue) -> int { throw std::runtime_error("fail " + std::to_string(aValue)); });
+    try
+    {
+        db.execAndGet("SELECT fail(7)");
+        FAIL();
+    }
+    catch (SQLite::Exception& e)
+    {
+        EXPECT_STREQ("fail 7", e.what());
+    }
+
+    // Only deterministic functions can be used in the expressions of an index
+    db.exec("CREATE TABLE user (name TEXT)");
+    db.exec("INSERT INTO user VALUES ('Alice'), ('Bob')");
+    db.function("lower_det", [](std::string aText) { std::transform(aText.begin(), aText.end(), aText.begin(), ::tolower); return aText; });
+    db.function("lower_nondet", [](std::string aText) { return aText; }, false);
+    db.exec("CREATE INDEX user_lower ON user (lower_det(name))");
+    EXPECT_THROW(db.exec("CREATE INDEX user_nondet ON user (lower_nondet(name))"), SQLite::Exception);
+    EXPECT_EQ(1, db.execAndGet("SELECT count(*) FROM user WHERE lower_det(name) = 'bob'").getInt());
+
+    // Redefined, the previous function object is destroyed
+    std::shared_ptr<int> counter = std::make_shared<int>(0);
+    db.function("count_calls", [counter]() { return ++*counter; });
+    EXPECT_EQ(2, counter.use_count());
+    db.function("count_calls", []() { return 0; });
+    EXPECT_EQ(1, counter.use_count());
+}
+
+#if (__cplusplus >= 201703L) || (defined(_MSVC_LANG) && (_MSVC_LANG >= 201703L)) // c++17: Visual Studio 2017
+TEST(Function, stringView) {
+    SQLite::Database db(":memory:", SQLite::OPEN_READWRITE);
+
+    // Text and blob arguments viewed without copy
+    db.function("size", [](std::string_view aBytes) { return aBytes.size(); });
+    EXPECT_EQ(5, db.execAndGet("SELECT size('hello')").getInt());
+    EXPECT_EQ(3, db.execAndGet("SELECT size(x'000102')").getInt());
+    EXPECT_EQ(0, db.execAndGet("SELECT size(x'')").getInt());
+    EXPECT_EQ(0, db.execAndGet("SELECT size(NULL)").getInt());
+
+    db.function("prefix", [](std::string_view aText, int aSize) { return aText.substr(0, static_cast<std::size_t>(aSize)); });
+    EXPECT_EQ("hel", db.execAndGet("SELECT prefix('hello', 3)").getString());
+
+    // std::optional for NULL arguments and results
+    db.function("half", [](std::optional<double> aValue) -> std::optional<double>
+    {
+        return aValue ? std::optional<double>(*aValue / 2) : std::nullopt;
+    });
+    EXPECT_DOUBLE_EQ(1.5, db.execAndGet("SELECT half(3)").getDouble());
+    EXPECT_TRUE(db.execAndGet("SELECT half(NULL)").isNull());
+}
+#endif
+
+/// Number of live Median objects
+static int sMedianCount = 0;
+
+/// Median of the values of a group, ready for window functions
+class Median
+{
+public:
+    Median() { ++sMedianCount; }
+    ~Median() { --sMedianCount; }
+
+    void step(double aValue)
+    {
+        if (aValue < 0)
+        {
+            throw std::invalid_argument("negative value");
+        }
+        mValues.push_back(aValue);
+    }
+    void inverse(double aValue)
+    {
+        mValues.erase(std::find(mValues.begin(), mValues.end(), aValue));
+    }
+    double value()
+    {
+        if (mValues.empty())
+        {
+            return 0.0;
+        }
+        std::vector<double> values(mValues);
+        std::nth_element(values.begin(), values.begin() + values.size() / 2, values.end());
+        return values[values.size() / 2];
+    }
+
+private:
+    std::vector<double> mValues;
+};
+
+/// Concatenation of the texts of a group
+struct Concat
+{
+    void step(const std::string& aText, const std::string& aSeparator)
+    {
+        mResult += (mResult.empty() ? "" : aSeparator) + aText;
+    }
+    std::string value() const
+    {
+        return mResult;
+    }
+    std::string mResult;
+};
+
+TEST(Function, aggregate) {
+    SQLite::Database db(":memory:", SQLite::OPEN_READWRITE);
+    db.aggregate<Median>("median");
+    db.aggregate<Concat>("concat");
+    db.exec("CREATE TABLE measure (sensor TEXT, value REAL)");
+    db.exec("INSERT INTO measure VALUES ('a', 3), ('a', 1), ('a', 2), ('b', 10), ('b', 30), ('b', 20), ('b', 40)");
+
+    SQLite::Statement query(db, "SELECT sensor, median(value), concat(value, ',') FROM measure GROUP BY sensor ORDER BY sensor");
+    ASSERT_TRUE(query.executeStep());
+    EXPECT_EQ("a", query.getColumn(0).getString());
+    EXPECT_DOUBLE_EQ(2.0, query.getColumn(1).getDouble());
+    EXPECT_EQ("3.0,1.0,2.0", query.getColumn(2).getString());
+    ASSERT_TRUE(query.executeStep());
+    EXPECT_DOUBLE_EQ(30.0, query.getColumn(1).getDouble());
+    EXPECT_FALSE(query.executeStep());
+    EXPECT_EQ(0, sMedianCount);
+
+    // An empty group returns the value of a new object
+    EXPECT_DOUBLE_EQ(0.0, db.execAndGet("SELECT median(value) FROM measure WHERE value > 100").getDouble());
+    EXPECT_EQ(0, sMedianCount);
+
+    // An exception fails the statement, and the state is destroyed
+    db.exec("INSERT INTO measure VALUES ('c', -1)");
+    EXPECT_THROW(db.execAndGet("SELECT median(value) FROM measure"), SQLite::Exception);
+    EXPECT_EQ(0, sMedianCount);
+
+    // A statement reset before the end of its groups destroys their states
+    {
+        SQLite::Statement partial(db, "SELECT sensor, median(value) FROM measure WHERE value >= 0 GROUP BY sensor");
+        ASSERT_TRUE(partial.executeStep());
+    }
+    EXPECT_EQ(0, sMedianCount);
+}
+
+#endif // c++14
@@ -0,0 +1,187 @@
+/**
+ * @file    Maintenance_test.cpp
+ * @ingroup tests
+ * @brief   Test of a SQLiteCpp Maintenance service.
+ *
+ * Copyright (c) 2012-2016 Sebastien Rombauts (sebastien.rombauts@gmail.com)
+ *
+ * Distributed under the MIT License (MIT) (See accompanying file LICENSE.txt
+ * or copy at http://opensource.org/licenses/MIT)
+ */
+
+#include <SQLiteCpp/Maintenance.h>
+#include <SQLiteCpp/Database.h>
+#include <SQLiteCpp/Statement.h>
+#include <SQLiteCpp/Exception.h>
+
+#include <gtest/gtest.h>
+
+#include <chrono>
+#include <cstdio>
+#include <fstream>
+#include <string>
+#include <thread>
+
+
+/// Return the size of a file, or -1 if it does not exist
+static long long getFileSize(const char* apFilename)
+{
+    std::ifstream file(apFilename, std::ios_base::binary | std::ios_base::ate);
+    return file ? static_cast<long long>(file.tellg()) : -1;
+}
+
+TEST(Maintenance, notWal) {
+    remove("maintenance_test.db3");
+    {
+        SQLite::Database db("maintenance_test.db3", SQLite::OPEN_READWRITE|SQLite::OPEN_CREATE);
+        db.exec("CREATE TABLE test (id INTEGER PRIMARY KEY)");
+        EXPECT_THROW(SQLite::Maintenance maintenance("maintenance_test.db3"), SQLite::Exception);
+    }
+    remove("maintenance_test.db3");
+}
+
+TEST(Maintenance, checkpoint) {
+    remove("maintenance_test.db3");
+    {
+        SQLite::Database db("maintenance_test.db3", SQLite::OPEN_READWRITE|SQLite::OPEN_CREATE);
+        db.exec("PRAGMA journal_mode=WAL");
+        db.exec("CREATE TABLE test (id INTEGER PRIMARY KEY, value TEXT)");
+
+        SQLite::Maintenance maintenance("maintenance_test.db3");
+        maintenance.setCheckpointThresholds(20, 0, 0);
+        maintenance.watch(db);
+
+        // Each commit appends at least one frame to the WAL, and wakes the service past 20 frames
+        SQLite::Statement insert(db, "INSERT INTO test VALUES (NULL, ?)");
+        for (int i = 0; i < 30; ++i)
+        {
+            insert.bind(1, std::string(1000, 'x'));
+            insert.exec();
+            insert.reset();
+        }
+        for (int i = 0; (i < 500) && (0 == maintenance.getMetrics().mCheckpointCount); ++i)
+        {
+            std::this_thread::sleep_for(std::chrono::milliseconds(10));
+        }
+        SQLite::Maintenance::Metrics metrics = maintenance.getMetrics();
+        EXPECT_LE(1u, metrics.mCheckpointCount);
+        EXPECT_LE(20, metrics.mCheckpointedFrames);
+        EXPECT_EQ(0u, metrics.mErrorCount);
+        EXPECT_GE(metrics.mTotalCheckpointMs, metrics.mLastCheckpointMs);
+
+        // A TRUNCATE checkpoint empties the WAL file
+        EXPECT_LT(0, getFileSize("maintenance_test.db3-wal"));
+        EXPECT_TRUE(maintenance.checkpoint(SQLite::CHECKPOINT_TRUNCATE));
+        metrics = maintenance.getMetrics();
+        EXPECT_EQ(0, metrics.mWalFrames);
+        EXPECT_EQ(0, metrics.mWalBytes);
+        EXPECT_EQ(0, getFileSize("maintenance_test.db3-wal"));
+
+        // A reader of an old snapshot makes a TRUNCATE checkpoint busy
+        maintenance.setCheckpointThresholds(1000000, 0, 0);
+        SQLite::Database reader("maintenance_test.db3", SQLite::OPEN_READONLY);
+        db.exec("INSERT INTO test VALUES (NULL, \"before\")");
+        SQLite::Statement query(reader, "SELECT * FROM test");
+        EXPECT_TRUE(query.executeStep());
+        db.exec("INSERT INTO test VALUES (NULL, \"after\")");
+        SQLite::Maintenance busy("maintenance_test.db3", 0);
+        EXPECT_FALSE(busy.checkpoint(SQLite::CHECKPOINT_TRUNCATE));
+        EXPECT_EQ(1u, busy.getMetrics().mBusyCheckpointCount);
+        query.reset();
+        EXPECT_TRUE(busy.checkpoint(SQLite::CHECKPOINT_TRUNCATE));
+
+        maintenance.unwatch(db);
+    }
+    remove("maintenance_test.db3");
+    remove("maintenance_test.db3-wal");
+    remove("maintenance_test.db3-shm");
+}
+
+TEST(Maintenance, requestDuringCheckpoint) {
+    remove("maintenance_test.db3");
+    {
+        SQLite::Database db("maintenance_test.db3", SQLite::OPEN_READWRITE|SQLite::OPEN_CREATE);
+        db.exec("PRAGMA journal_mode=WAL");
+        db.exec("CREATE TABLE test (id INTEGER PRIMARY KEY, value TEXT)");
+
+        // Only the WAL hook wakes the service
+        SQLite::Maintenance maintenance("maintenance_test.db3");
+        maintenance.setCheckpointInterval(0);
+        maintenance.setCheckpointThresholds(5, 0, 0);
+        maintenance.watch(db);
+
+        // Commits requesting checkpoints while the previous one runs without the lock
+        SQLite::Statement insert(db, "INSERT INTO test VALUES (NULL, ?)");
+        for (int i = 0; i < 2000; ++i)
+        {
+            insert.bind(1, std::string(100, 'x'));
+            insert.exec();
+            insert.reset();
+        }
+
+        // None of those requests is lost: the next ones are still served without delay
+        for (int round = 0; round < 3; ++round)
+        {
+            for (int i = 0; (i < 100) && (0 != maintenance.getMetrics().mWalFrames); ++i)
+            {
+                std::this_thread::sleep_for(std::chrono::milliseconds(10));
+            }
+            const unsigned long long checkpoints = maintenance.getMetrics().mCheckpointCount;
+            for (int i = 0; i < 10; ++i)
+            {
+                insert.bind(1, std::string(100, 'y'));
+                insert.exec();
+                insert.reset();
+            }
+            for (int i = 0; (i < 300) && (checkpoints == maintenance.getMetrics().mCheckpointCount); ++i)
+            {
+                std::this_thread::sleep_for(std::chrono::milliseconds(10));
+            }
+            EXPECT_LT(checkpoints, maintenance.getMetrics().mCheckpointCount);
+        }
+        EXPECT_EQ(0u, maintenance.getMetrics().mErrorCount);
+
+        maintenance.unwatch(db);
+    }
+    remove("maintenance_test.db3");
+    remove("maintenance_test.db3-wal");
+    remove("maintenance_test.db3-shm");
+}
+
+TEST(Maintenance, vacuumAndOptimize) {
+    remove("maintenance_test.db3");
+    {
+        SQLite::Database db("maintenance_test.db3", SQLite::OPEN_READWRITE|SQLite::OPEN_CREATE);
+        db.exec("PRAGMA auto_vacuum=INCREMENTAL");
+        db.exec("PRAGMA journal_mode=WAL");
+        db.exec("CREATE TABLE test (id INTEGER PRIMARY KEY, value TEXT)");
+        db.exec("CREATE INDEX test_value ON test (value)");
+        db.exec("WITH RECURSIVE n(i) AS (SELECT 1 UNION ALL SELECT i+1 FROM n WHERE i < 200)"
+                " INSERT INTO test SELECT NULL, hex(randomblob(500)) FROM n");
+        db.exec("DELETE FROM test");
+        const int freePages = db.execAndGet("PRAGMA freelist_count").getInt();
+        EXPECT_LT(50, freePages);
+
+        SQLite::Maintenance maintenance("maintenance_test.db3");
+        EXPECT_EQ(10, maintenance.incrementalVacuum(10));
+        EXPECT_EQ(freePages - 10, maintenance.incrementalVacuum(0));
+        EXPECT_EQ(0, maintenance.incrementalVacuum(0));
+        EXPECT_EQ(freePages, maintenance.getMetrics().mVacuumedPages);
+        EXPECT_EQ(0, db.execAndGet("PRAGMA freelist_count").getInt());
+
+        EXPECT_NO_THROW(maintenance.optimize());
+        EXPECT_EQ(1u, maintenance.getMetrics().mOptimizeCount);
+
+        // Scheduled operations
+        maintenance.setOptimizeInterval(10);
+        for (int i = 0; (i < 500) && (maintenance.getMetrics().mOptimizeCount < 3); ++i)
+        {
+            std::this_thread::sleep_for(std::chrono::milliseconds(10));
+        }
+        EXPECT_LE(3u, maintenance.getMetrics().mOptimizeCount);
+        EXPECT_EQ(0u, maintenance.getMetrics().mErrorCount);
+    }
+    remove("maintenance_test.db3");
+    remove("maintenance_test.db3-wal");
+    remove("maintenance_test.db3-shm");
+}
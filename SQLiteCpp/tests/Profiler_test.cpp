@@ -0,0 +1,165 @@
+/**
+ * @file    Profiler_test.cpp
+ * @ingroup tests
+ * @brief   Test of a SQLiteCpp Profiler.
+ *
+ * Copyright (c) 2012-2016 Sebastien Rombauts (sebastien.rombauts@gmail.com)
+ *
+ * Distributed under the MIT License (MIT) (See accompanying file LICENSE.txt
+ * or copy at http://opensource.org/licenses/MIT)
+ */
+
+#include <SQLiteCpp/Profiler.h>
+#include <SQLiteCpp/Database.h>
+#include <SQLiteCpp/Statement.h>
+#include <SQLiteCpp/Exception.h>
+
+#include <gtest/gtest.h>
+
+#include <sstream>
+#include <string>
+#include <vector>
+
+
+/// Return the statistics of a normalized query, or NULL
+static const SQLite::Profiler::Stats* findStats(const std::vector<SQLite::Profiler::Stats>& aStats, const std::string& aQuery)
+{
+    for (std::vector<SQLite::Profiler::Stats>::const_iterator it = aStats.begin(); it != aStats.end(); ++it)
+    {
+        if (it->mQuery == aQuery)
+        {
+            return &(*it);
+        }
+    }
+    return NULL;
+}
+
+TEST(Profiler, normalize) {
+    EXPECT_EQ("SELECT * FROM t WHERE id = ? AND name=?",
+              SQLite::Profiler::normalize("  SELECT *\n FROM t  WHERE id = 42 -- comment\n AND name='it''s' "));
+    EXPECT_EQ("INSERT INTO t1 VALUES (?, ?, ?, ?, -?)",
+              SQLite::Profiler::normalize("INSERT INTO t1 VALUES (1.5e+3, 0x1F, X'00ff', .5, -7)"));
+    EXPECT_EQ("SELECT \"col 1\", [col 2] FROM t WHERE a = ?1 AND b = :b2 AND c = ?",
+              SQLite::Profiler::normalize("SELECT \"col 1\", [col 2] /* comment */ FROM t WHERE a = ?1 AND b = :b2 AND c = ?"));
+}
+
+TEST(Profiler, executions) {
+    SQLite::Profiler profiler;
+    SQLite::Database db(":memory:", SQLite::OPEN_READWRITE);
+    db.setProfiler(&profiler);
+    EXPECT_EQ(&profiler, db.getProfiler());
+    db.exec("CREATE TABLE test (id INTEGER PRIMARY KEY, value INTEGER)");
+
+    SQLite::Statement insert(db, "INSERT INTO test VALUES (NULL, ?)");
+    for (int i = 0; i < 10; ++i)
+    {
+        insert.bind(1, i);
+        EXPECT_EQ(1, insert.exec());
+        insert.reset();
+    }
+
+    // Literals are normalized: both queries share their statistics
+    {
+        SQLite::Statement query(db, "SELECT * FROM test WHERE value > 4 ORDER BY value DESC");
+        int rows = 0;
+        while (query.executeStep())
+        {
+            ++rows;
+        }
+        EXPECT_EQ(5, rows);
+    }
+    {
+        // An execution not fetching all its rows ends when its statement is destroyed
+        SQLite::Statement query(db, "SELECT * FROM test WHERE value > 1 ORDER BY value DESC");
+        EXPECT_TRUE(query.executeStep());
+        EXPECT_TRUE(query.executeStep());
+    }
+    EXPECT_THROW(db.exec("INSERT INTO test VALUES (1, 1)"), SQLite::Exception);
+
+    const std::vector<SQLite::Profiler::Stats> stats = profiler.getStats();
+    const SQLite::Profiler::Stats* pInsert = findStats(stats, "INSERT INTO test VALUES (NULL, ?)");
+    ASSERT_TRUE(NULL != pInsert);
+    EXPECT_EQ(10u, pInsert->mExecutions);
+    EXPECT_EQ(1u, pInsert->mPrepares);
+    EXPECT_EQ(0u, pInsert->mRows);
+    EXPECT_EQ(0u, pInsert->mErrors);
+    EXPECT_LT(0u, pInsert->mVmSteps);
+    EXPECT_LT(0, pInsert->mTotalNs);
+    EXPECT_LE(pInsert->mMaxNs, pInsert->mTotalNs);
+    unsigned long long histogramCount = 0;
+    for (int i = 0; i < SQLite::Profiler::HISTOGRAM_BUCKETS; ++i)
+    {
+        histogramCount += pInsert->mHistogram[i];
+    }
+    EXPECT_EQ(10u, histogramCount);
+    EXPECT_LE(pInsert->getPercentileNs(50), pInsert->getPercentileNs(99));
+    EXPECT_LE(pInsert->getPercentileNs(99), pInsert->mMaxNs);
+
+    const SQLite::Profiler::Stats* pSelect = findStats(stats, "SELECT * FROM test WHERE value > ? ORDER BY value DESC");
+    ASSERT_TRUE(NULL != pSelect);
+    EXPECT_EQ(2u, pSelect->mExecutions);
+    EXPECT_EQ(2u, pSelect->mPrepares);
+    EXPECT_EQ(7u, pSelect->mRows);
+    EXPECT_EQ(2u, pSelect->mSorts);
+    EXPECT_LT(0u, pSelect->mFullscanSteps);
+
+    const SQLite::Profiler::Stats* pExec = findStats(stats, "INSERT INTO test VALUES (?, ?)");
+    ASSERT_TRUE(NULL != pExec);
+    EXPECT_EQ(1u, pExec->mExecutions);
+    EXPECT_EQ(1u, pExec->mErrors);
+
+    profiler.reset();
+    EXPECT_TRUE(profiler.getStats().empty());
+
+    // Detached: the statements constructed afterward are not profiled
+    db.setProfiler(NULL);
+    EXPECT_EQ(10, db.execAndGet("SELECT count(*) FROM test").getInt());
+    EXPECT_TRUE(profiler.getStats().empty());
+}
+
+TEST(Profiler, statementCache) {
+    SQLite::Profiler profiler;
+    SQLite::Database db(":memory:", SQLite::OPEN_READWRITE);
+    db.setStatementCacheCapacity(4);
+    db.setProfiler(&profiler);
+
+    for (int i = 0; i < 5; ++i)
+    {
+        EXPECT_EQ(1, db.execAndGet("SELECT 1").getInt());
+    }
+    const std::vector<SQLite::Profiler::Stats> stats = profiler.getStats();
+    const SQLite::Profiler::Stats* pSelect = findStats(stats, "SELECT ?");
+    ASSERT_TRUE(NULL != pSelect);
+    EXPECT_EQ(5u, pSelect->mExecutions);
+    EXPECT_EQ(1u, pSelect->mPrepares);
+    EXPECT_EQ(5u, pSelect->mRows);
+}
+
+TEST(Profiler, autoIndex) {
+    SQLite::Profiler profiler;
+    std::vector<std::string> flagged;
+    profiler.setAutoIndexHandler([&flagged](const std::string& aQuery) { flagged.push_back(aQuery); });
+
+    SQLite::Database db(":memory:", SQLite::OPEN_READWRITE);
+    db.exec("CREATE TABLE a (x INTEGER); CREATE TABLE b (x INTEGER)");
+    db.exec("WITH RECURSIVE n(i) AS (SELECT 1 UNION ALL SELECT i+1 FROM n WHERE i < 100) INSERT INTO a SELECT i FROM n");
+    db.exec("INSERT INTO b SELECT x FROM a");
+    db.setProfiler(&profiler);
+
+    // Without index on b.x, the query planner builds an automatic index for the join
+    for (int i = 0; i < 2; ++i)
+    {
+        EXPECT_EQ(100, db.execAndGet("SELECT count(*) FROM a JOIN b ON a.x = b.x").getInt());
+    }
+    ASSERT_EQ(1u, flagged.size());
+    EXPECT_EQ("SELECT count(*) FROM a JOIN b ON a.x = b.x", flagged[0]);
+
+    const std::vector<SQLite::Profiler::Stats> stats = profiler.getAutoIndexStats();
+    ASSERT_EQ(1u, stats.size());
+    EXPECT_EQ(2u, stats[0].mExecutions);
+    EXPECT_LT(100u, stats[0].mAutoIndexes);
+
+    std::ostringstream dump;
+    profiler.dump(dump);
+    EXPECT_NE(std::string::npos, dump.str().find("SELECT count(*) FROM a JOIN b ON a.x = b.x [autoindex] [fullscan]"));
+}
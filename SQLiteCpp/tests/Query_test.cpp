@@ -0,0 +1,90 @@
+/**
+ * @file    Query_test.cpp
+ * @ingroup tests
+ * @brief   Test of a SQLiteCpp typed Query.
+ *
+ * Copyright (c) 2012-2016 Sebastien Rombauts (sebastien.rombauts@gmail.com)
+ *
+ * Distributed under the MIT License (MIT) (See accompanying file LICENSE.txt
+ * or copy at http://opensource.org/licenses/MIT)
+ */
+
+#include <SQLiteCpp/Query.h>
+#include <SQLiteCpp/Database.h>
+#include <SQLiteCpp/StatementCache.h>
+#include <SQLiteCpp/Exception.h>
+
+#include <gtest/gtest.h>
+
+#include <string>
+#include <tuple>
+#include <vector>
+
+#if (__cplusplus >= 201402L) || ( defined(_MSC_VER) && (_MSC_VER >= 1910) ) // c++14 relaxed constexpr: Visual Studio 2017
+
+// The parameters are counted at compile time
+static_assert(SQLite::detail::countParameters("SELECT 1") == 0, "no parameter");
+static_assert(SQLite::detail::countParameters("SELECT ?, ?") == 2, "anonymous parameters");
+static_assert(SQLite::detail::countParameters("SELECT ?2, ?1, ?") == 3, "numbered parameters");
+static_assert(SQLite::detail::countParameters("SELECT :a, @b, $c FROM t WHERE x$y") == 3, "named parameters");
+static_assert(SQLite::detail::countParameters("SELECT '?', \"?\", [?], `?` -- ?\n /* ? */ , ?") == 1, "quotes and comments");
+static_assert(SQLite::detail::countParameters("SELECT 'it''s', ?") == 1, "escaped quote");
+
+SQLITECPP_SQL(CreateTest, "CREATE TABLE test (id INTEGER PRIMARY KEY, name TEXT, weight REAL)");
+SQLITECPP_SQL(InsertTest, "INSERT INTO test VALUES (NULL, ?, ?)");
+SQLITECPP_SQL(SelectTest, "SELECT id, name, weight FROM test WHERE weight > ? ORDER BY id");
+SQLITECPP_SQL(SelectName, "SELECT name FROM test WHERE id = ?");
+SQLITECPP_SQL(SelectWrongCount, "SELECT id, name FROM test WHERE id = ?");
+
+TEST(Query, typed) {
+    SQLite::Database db(":memory:", SQLite::OPEN_READWRITE);
+    SQLite::Query<CreateTest, std::tuple<> >(db).exec();
+
+    SQLite::Query<InsertTest, std::tuple<std::string, double> > insert(db);
+    EXPECT_EQ(1, insert.exec("first", 0.5));
+    EXPECT_EQ(1, insert.exec("second", 1.5));
+    EXPECT_EQ(1, insert.exec("third", 2.5));
+
+    SQLite::Query<SelectTest, std::tuple<double>, SQLite::Row<long long, std::string, double> > select(db);
+    std::vector<std::string> names;
+    for (const std::tuple<long long, std::string, double>& row : select(1.0))
+    {
+        names.push_back(std::get<1>(row));
+    }
+    ASSERT_EQ(2u, names.size());
+    EXPECT_EQ("second", names[0]);
+    EXPECT_EQ("third", names[1]);
+
+    // The statement is reused for each call
+    const std::vector<std::tuple<long long, std::string, double> > rows = select.fetchAll(0.0);
+    ASSERT_EQ(3u, rows.size());
+    EXPECT_EQ(1, std::get<0>(rows[0]));
+    EXPECT_EQ(2.5, std::get<2>(rows[2]));
+    EXPECT_TRUE(select.fetchAll(10.0).empty());
+
+    SQLite::Query<SelectName, std::tuple<int>, SQLite::Row<std::string> > selectName(db);
+    EXPECT_EQ("second", std::get<0>(selectName.fetchOne(2)));
+    EXPECT_THROW(selectName.fetchOne(4), SQLite::Exception);
+
+    // The number of columns is checked when the query is prepared
+    typedef SQLite::Query<SelectWrongCount, std::tuple<int>, SQLite::Row<int> > WrongCount;
+    EXPECT_THROW(WrongCount wrongCount(db), SQLite::Exception);
+}
+
+TEST(Query, statementCache) {
+    SQLite::Database db(":memory:", SQLite::OPEN_READWRITE);
+    db.setStatementCacheCapacity(4);
+    SQLite::Query<CreateTest, std::tuple<> >(db).exec();
+    const unsigned long long misses = db.getStatementCache().getMisses();
+
+    // Short-lived Query objects borrow the same prepared statement from the cache
+    for (int i = 0; i < 10; ++i)
+    {
+        SQLite::Query<InsertTest, std::tuple<std::string, double> > insert(db);
+        insert.exec("name", i);
+    }
+    EXPECT_EQ(misses + 1, db.getStatementCache().getMisses());
+    EXPECT_EQ(10, db.execAndGet("SELECT count(*) FROM test").getInt());
+}
+
+#endif // c++14 relaxed constexpr
@@ -0,0 +1,208 @@
+/**
+ * @file    ShardSet_test.cpp
+ * @ingroup tests
+ * @brief   Test of a SQLiteCpp ShardSet.
+ *
+ * Copyright (c) 2012-2016 Sebastien Rombauts (sebastien.rombauts@gmail.com)
+ *
+ * Distributed under the MIT License (MIT) (See accompanying file LICENSE.txt
+ * or copy at http://opensource.org/licenses/MIT)
+ */
+
+#include <SQLiteCpp/ShardSet.h>
+#include <SQLiteCpp/Database.h>
+#include <SQLiteCpp/Statement.h>
+#include <SQLiteCpp/Transaction.h>
+#include <SQLiteCpp/Exception.h>
+
+#include <gtest/gtest.h>
+
+#include <cstdio>
+#include <string>
+#include <utility>
+#include <vector>
+
+
+/// Create 4 shards of 100 users each, distributed by id modulo 4
+static std::vector<std::string> createShards()
+{
+    std::vector<std::string> filenames;
+    for (int shard = 0; shard < 4; ++shard)
+    {
+        const std::string filename = "test_shard" + std::to_string(shard) + ".db3";
+        remove(filename.c_str());
+        SQLite::Database db(filename, SQLite::OPEN_READWRITE|SQLite::OPEN_CREATE);
+        db.exec("CREATE TABLE user (id INTEGER PRIMARY KEY, country TEXT, age INTEGER, score REAL)");
+        SQLite::Transaction transaction(db);
+        SQLite::Statement insert(db, "INSERT INTO user VALUES (?, ?, ?, ?)");
+        for (int id = shard; id < 400; id += 4)
+        {
+            insert.bind(1, id);
+            insert.bind(2, (id % 3 == 0) ? "fr" : ((id % 3 == 1) ? "de" : "it"));
+            insert.bind(3, 18 + id % 50);
+            insert.bind(4, id / 2.0);
+            insert.exec();
+            insert.reset();
+        }
+        transaction.commit();
+        filenames.push_back(filename);
+    }
+    return filenames;
+}
+
+/// Remove the shards
+static void removeShards(const std::vector<std::string>& aFilenames)
+{
+    for (std::size_t i = 0; i < aFilenames.size(); ++i)
+    {
+        remove(aFilenames[i].c_str());
+    }
+}
+
+typedef std::pair<long long, int> TUser;
+
+static TUser readUser(SQLite::Statement& aQuery)
+{
+    return TUser(aQuery.getColumn(0).getInt64(), aQuery.getColumn(1).getInt());
+}
+
+TEST(ShardSet, concatAndMerge) {
+    const std::vector<std::string> filenames = createShards();
+    {
+        SQLite::ShardSet shards(filenames, SQLite::OPEN_READONLY, 2);
+        EXPECT_EQ(4u, shards.getShardCount());
+        EXPECT_EQ(2u, shards.getThreadCount());
+        EXPECT_EQ("test_shard2.db3", shards.getFilename(2));
+
+        // Concatenation, in the order of the shards
+        std::vector<TUser> users = shards.concat("SELECT id, age FROM user WHERE age > ?", &readUser,
+                                                 SQLite::ShardSet::TShards(), [](SQLite::Statement& aQuery) { aQuery.bind(1, 60); });
+        ASSERT_EQ(56u, users.size());
+        EXPECT_EQ(44, users.front().first);
+        EXPECT_EQ(0, users.front().first % 4);
+        EXPECT_EQ(3, users.back().first % 4);
+
+        // Selection of shards
+        const std::size_t selection[] = { 3, 1 };
+        users = shards.concat("SELECT id, age FROM user", &readUser, SQLite::ShardSet::TShards(selection, selection + 2));
+        ASSERT_EQ(200u, users.size());
+        EXPECT_EQ(3, users.front().first);
+        EXPECT_EQ(1, users.back().first % 4);
+
+        // k-way merge of the sorted rows of the shards, truncated to the limit
+        users = shards.merge("SELECT id, age FROM user ORDER BY age DESC, id LIMIT 10", &readUser,
+                             [](const TUser& aLeft, const TUser& aRight)
+                             {
+                                 return (aLeft.second > aRight.second) || ((aLeft.second == aRight.second) && (aLeft.first < aRight.first));
+                             }, 10);
+        ASSERT_EQ(10u, users.size());
+        const long long expected[] = { 49, 99, 149, 199, 249, 299, 349, 399, 48, 98 };
+        for (std::size_t i = 0; i < users.size(); ++i)
+        {
+            EXPECT_EQ(expected[i], users[i].first);
+        }
+        users = shards.merge("SELECT id, age FROM user ORDER BY id", &readUser,
+                             [](const TUser& aLeft, const TUser& aRight) { return aLeft.first < aRight.first; });
+        ASSERT_EQ(400u, users.size());
+        for (std::size_t i = 0; i < users.size(); ++i)
+        {
+            EXPECT_EQ(static_cast<long long>(i), users[i].first);
+        }
+
+        // Any function on each shard
+        const std::vector<int> counts = shards.forEach([](SQLite::Database& aDatabase, const std::size_t aShard)
+        {
+            return aDatabase.execAndGet("SELECT count(*) FROM user WHERE id % 4 = " + std::to_string(aShard)).getInt();
+        });
+        EXPECT_EQ(std::vector<int>(4, 100), counts);
+
+        // The same query is prepared once per shard
+        users = shards.concat("SELECT id, age FROM user WHERE age > ?", &readUser,
+                              SQLite::ShardSet::TShards(), [](SQLite::Statement& aQuery) { aQuery.bind(1, 60); });
+        EXPECT_EQ(56u, users.size());
+        const std::vector<unsigned long long> hits = shards.forEach([](SQLite::Database& aDatabase, std::size_t)
+        {
+            return aDatabase.getStatementCache().getHits();
+        });
+        EXPECT_EQ(std::vector<unsigned long long>(4, 1), hits);
+
+        // The exception of the first failing shard is rethrown
+        EXPECT_THROW(shards.concat("SELECT id, age FROM missing", &readUser), SQLite::Exception);
+        EXPECT_THROW(shards.forEach([](SQLite::Database&, const std::size_t aShard)
+        {
+            if (aShard >= 2)
+            {
+                throw SQLite::Exception("shard " + std::to_string(aShard));
+            }
+            return aShard;
+        }), SQLite::Exception);
+        const std::size_t outOfRange[] = { 4 };
+        EXPECT_THROW(shards.concat("SELECT id, age FROM user", &readUser, SQLite::ShardSet::TShards(outOfRange, outOfRange + 1)),
+                     SQLite::Exception);
+    }
+    EXPECT_THROW(SQLite::ShardSet(std::vector<std::string>()), SQLite::Exception);
+    removeShards(filenames);
+}
+
+TEST(ShardSet, aggregate) {
+    const std::vector<std::string> filenames = createShards();
+    {
+        SQLite::ShardSet shards(filenames);
+        SQLite::Database reference(":memory:", SQLite::OPEN_READWRITE);
+        for (std::size_t i = 0; i < filenames.size(); ++i)
+        {
+            reference.exec("ATTACH '" + filenames[i] + "' AS s" + std::to_string(i));
+        }
+        const std::string all = "(SELECT * FROM s0.user UNION ALL SELECT * FROM s1.user UNION ALL SELECT * FROM s2.user UNION ALL SELECT * FROM s3.user)";
+
+        // Without GROUP BY: one row
+        const SQLite::ShardSet::Aggregate columns[] = { SQLite::ShardSet::COUNT, SQLite::ShardSet::SUM, SQLite::ShardSet::SUM,
+                                                        SQLite::ShardSet::MIN, SQLite::ShardSet::MAX };
+        std::vector<SQLite::ShardSet::TRow> rows = shards.aggregate("SELECT count(*), sum(age), sum(score), min(country), max(age) FROM user",
+                                                                    std::vector<SQLite::ShardSet::Aggregate>(columns, columns + 5));
+        ASSERT_EQ(1u, rows.size());
+        SQLite::Statement query(reference, "SELECT count(*), sum(age), sum(score), min(country), max(age) FROM " + all);
+        ASSERT_TRUE(query.executeStep());
+        EXPECT_EQ(SQLite::INTEGER, rows[0][0].mType);
+        EXPECT_EQ(query.getColumn(0).getInt64(), rows[0][0].mInteger);
+        EXPECT_EQ(SQLite::INTEGER, rows[0][1].mType);
+        EXPECT_EQ(query.getColumn(1).getInt64(), rows[0][1].mInteger);
+        EXPECT_EQ(SQLite::FLOAT, rows[0][2].mType);
+        EXPECT_DOUBLE_EQ(query.getColumn(2).getDouble(), rows[0][2].mFloat);
+        EXPECT_EQ(SQLite::TEXT, rows[0][3].mType);
+        EXPECT_EQ("de", rows[0][3].mText);
+        EXPECT_EQ(query.getColumn(4).getInt64(), rows[0][4].mInteger);
+
+        // GROUP BY: the groups of the shards combined, in the order of their keys
+        const SQLite::ShardSet::Aggregate grouped[] = { SQLite::ShardSet::KEY, SQLite::ShardSet::COUNT, SQLite::ShardSet::MIN, SQLite::ShardSet::SUM };
+        rows = shards.aggregate("SELECT country, count(*), min(age), sum(age) FROM user WHERE id < ? GROUP BY country",
+                                std::vector<SQLite::ShardSet::Aggregate>(grouped, grouped + 4),
+                                SQLite::ShardSet::TShards(), [](SQLite::Statement& aQuery) { aQuery.bind(1, 300); });
+        SQLite::Statement groupQuery(reference, "SELECT country, count(*), min(age), sum(age) FROM " + all + " WHERE id < 300 GROUP BY country ORDER BY country");
+        for (std::size_t i = 0; i < 3; ++i)
+        {
+            ASSERT_TRUE(groupQuery.executeStep());
+            ASSERT_LT(i, rows.size());
+            EXPECT_EQ(groupQuery.getColumn(0).getString(), rows[i][0].mText);
+            EXPECT_EQ(groupQuery.getColumn(1).getInt64(), rows[i][1].mInteger);
+            EXPECT_EQ(groupQuery.getColumn(2).getInt64(), rows[i][2].mInteger);
+            EXPECT_EQ(groupQuery.getColumn(3).getInt64(), rows[i][3].mInteger);
+        }
+        EXPECT_EQ(3u, rows.size());
+
+        // An empty selection of rows: sum() and max() are NULL
+        rows = shards.aggregate("SELECT count(*), sum(age), sum(score), min(country), max(age) FROM user WHERE id < 0",
+                                std::vector<SQLite::ShardSet::Aggregate>(columns, columns + 5));
+        ASSERT_EQ(1u, rows.size());
+        EXPECT_EQ(0, rows[0][0].mInteger);
+        EXPECT_EQ(SQLite::Null, rows[0][1].mType);
+        EXPECT_EQ(SQLite::Null, rows[0][4].mType);
+
+        // Integer overflow of a sum
+        const SQLite::ShardSet::Aggregate sum[] = { SQLite::ShardSet::SUM };
+        EXPECT_THROW(shards.aggregate("SELECT 9223372036854775807", std::vector<SQLite::ShardSet::Aggregate>(sum, sum + 1)), SQLite::Exception);
+        // Columns not matching the query
+        EXPECT_THROW(shards.aggregate("SELECT count(*), 1 FROM user", std::vector<SQLite::ShardSet::Aggregate>(sum, sum + 1)), SQLite::Exception);
+    }
+    removeShards(filenames);
+}
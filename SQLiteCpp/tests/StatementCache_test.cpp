@@ -0,0 +1,198 @@
+/**
+ * @file    StatementCache_test.cpp
+ * @ingroup tests
+ * @brief   Test of the SQLiteCpp prepared statement cache.
+ *
+ * Copyright (c) 2012-2016 Sebastien Rombauts (sebastien.rombauts@gmail.com)
+ *
+ * Distributed under the MIT License (MIT) (See accompanying file LICENSE.txt
+ * or copy at http://opensource.org/licenses/MIT)
+ */
+
+#include <SQLiteCpp/Database.h>
+#include <SQLiteCpp/Statement.h>
+#include <SQLiteCpp/StatementCache.h>
+
+#include <gtest/gtest.h>
+
+#include <string>
+
+
+TEST(StatementCache, disabled) {
+    SQLite::Database db(":memory:", SQLite::OPEN_READWRITE|SQLite::OPEN_CREATE);
+    EXPECT_EQ(0u, db.getStatementCache().getCapacity());
+
+    EXPECT_EQ(0, db.exec("CREATE TABLE test (id INTEGER PRIMARY KEY, value TEXT)"));
+    {
+        SQLite::Statement query(db, "SELECT * FROM test");
+    }
+    {
+        SQLite::Statement query(db, "SELECT * FROM test");
+    }
+    EXPECT_EQ(0u, db.getStatementCache().getSize());
+    EXPECT_EQ(0u, db.getStatementCache().getHits());
+    EXPECT_EQ(0u, db.getStatementCache().getMisses());
+}
+
+TEST(StatementCache, hitsAndMisses) {
+    SQLite::Database db(":memory:", SQLite::OPEN_READWRITE|SQLite::OPEN_CREATE);
+    db.setStatementCacheCapacity(8);
+    EXPECT_EQ(0, db.exec("CREATE TABLE test (id INTEGER PRIMARY KEY, value TEXT)"));
+    EXPECT_EQ(1, db.exec("INSERT INTO test VALUES (1, \"first\")"));
+
+    for (int i = 0; i < 3; ++i)
+    {
+        EXPECT_EQ("first", db.execAndGet("SELECT value FROM test WHERE id=1").getString());
+        EXPECT_TRUE(db.tableExists("test"));
+    }
+    // execAndGet() and tableExists() each prepared their query once
+    EXPECT_EQ(2u, db.getStatementCache().getMisses());
+    EXPECT_EQ(4u, db.getStatementCache().getHits());
+    EXPECT_EQ(2u, db.getStatementCache().getSize());
+
+    // The same query used by two live Statements is prepared twice, then both are kept
+    {
+        SQLite::Statement query1(db, "SELECT value FROM test WHERE id=1");
+        SQLite::Statement query2(db, "SELECT value FROM test WHERE id=1");
+        EXPECT_EQ(1u, db.getStatementCache().getSize());
+        EXPECT_EQ(3u, db.getStatementCache().getMisses());
+    }
+    EXPECT_EQ(3u, db.getStatementCache().getSize());
+
+    db.getStatementCache().resetCounters();
+    EXPECT_EQ(0u, db.getStatementCache().getHits());
+    EXPECT_EQ(0u, db.getStatementCache().getMisses());
+}
+
+TEST(StatementCache, resetOnReturn) {
+    SQLite::Database db(":memory:", SQLite::OPEN_READWRITE|SQLite::OPEN_CREATE);
+    db.setStatementCacheCapacity(4);
+    EXPECT_EQ(0, db.exec("CREATE TABLE test (id INTEGER PRIMARY KEY, value TEXT)"));
+    EXPECT_EQ(1, db.exec("INSERT INTO test VALUES (1, \"first\")"));
+    EXPECT_EQ(1, db.exec("INSERT INTO test VALUES (2, \"second\")"));
+
+    {
+        // Leave the statement in the middle of its results, with a bound parameter
+        SQLite::Statement query(db, "SELECT id FROM test WHERE id >= ?");
+        query.bind(1, 2);
+        EXPECT_TRUE(query.executeStep());
+        EXPECT_EQ(2, query.getColumn(0).getInt());
+    }
+    {
+        // The borrowed statement starts over, with a NULL parameter
+        SQLite::Statement query(db, "SELECT id FROM test WHERE id >= ?");
+        EXPECT_EQ(1u, db.getStatementCache().getHits());
+        EXPECT_FALSE(query.executeStep());
+        query.reset();
+        query.bind(1, 1);
+        EXPECT_TRUE(query.executeStep());
+        EXPECT_EQ(1, query.getColumn(0).getInt());
+    }
+}
+
+TEST(StatementCache, columnKeepsStatement) {
+    SQLite::Database db(":memory:", SQLite::OPEN_READWRITE|SQLite::OPEN_CREATE);
+    db.setStatementCacheCapacity(4);
+    EXPECT_EQ(0, db.exec("CREATE TABLE test (id INTEGER PRIMARY KEY, value TEXT)"));
+    EXPECT_EQ(1, db.exec("INSERT INTO test VALUES (1, \"first\")"));
+
+    // The Column returned by execAndGet() keeps the statement checked out until it is destroyed
+    {
+        SQLite::Column value = db.execAndGet("SELECT value FROM test");
+        EXPECT_EQ(0u, db.getStatementCache().getSize());
+        EXPECT_EQ("first", value.getString());
+    }
+    EXPECT_EQ(1u, db.getStatementCache().getSize());
+}
+
+TEST(StatementCache, eviction) {
+    SQLite::Database db(":memory:", SQLite::OPEN_READWRITE|SQLite::OPEN_CREATE);
+    db.setStatementCacheCapacity(2);
+
+    SQLite::Statement(db, "SELECT 1");
+    SQLite::Statement(db, "SELECT 2");
+    SQLite::Statement(db, "SELECT 1"); // "SELECT 2" is now the least recently used
+    SQLite::Statement(db, "SELECT 3"); // evicts "SELECT 2"
+    EXPECT_EQ(2u, db.getStatementCache().getSize());
+    EXPECT_EQ(3u, db.getStatementCache().getMisses());
+    EXPECT_EQ(1u, db.getStatementCache().getHits());
+
+    SQLite::Statement(db, "SELECT 1");
+    SQLite::Statement(db, "SELECT 3");
+    EXPECT_EQ(3u, db.getStatementCache().getHits());
+    SQLite::Statement(db, "SELECT 2");
+    EXPECT_EQ(4u, db.getStatementCache().getMisses());
+
+    // Shrinking finalizes the least recently used statements, and 0 disables the cache
+    db.setStatementCacheCapacity(1);
+    EXPECT_EQ(1u, db.getStatementCache().getSize());
+    db.setStatementCacheCapacity(0);
+    EXPECT_EQ(0u, db.getStatementCache().getSize());
+    SQLite::Statement(db, "SELECT 1");
+    EXPECT_EQ(0u, db.getStatementCache().getSize());
+}
+
+TEST(StatementCache, invalidQuery) {
+    SQLite::Database db(":memory:", SQLite::OPEN_READWRITE|SQLite::OPEN_CREATE);
+    db.setStatementCacheCapacity(2);
+    EXPECT_THROW(SQLite::Statement(db, "SELECT * FROM test"), SQLite::Exception);
+    EXPECT_EQ(0u, db.getStatementCache().getSize());
+}
+
+TEST(StatementCache, trailingText) {
+    SQLite::Database db(":memory:", SQLite::OPEN_READWRITE|SQLite::OPEN_CREATE);
+    db.setStatementCacheCapacity(4);
+
+    // sqlite3_sql() is only "SELECT 1;": the statement must be kept under the text of the checkout
+    const std::string text = "SELECT 1;  -- trailing comment\n";
+    {
+        SQLite::Statement query(db, text);
+        EXPECT_TRUE(query.executeStep());
+    }
+    {
+        SQLite::Statement query(db, text);
+        EXPECT_TRUE(query.executeStep());
+        EXPECT_EQ(1, query.getColumn(0).getInt());
+    }
+    EXPECT_EQ(1u, db.getStatementCache().getMisses());
+    EXPECT_EQ(1u, db.getStatementCache().getHits());
+    EXPECT_EQ(1u, db.getStatementCache().getSize());
+
+    // The Column keeps the text of the checkout after the Statement is destroyed
+    {
+        SQLite::Column value = db.execAndGet(text);
+        EXPECT_EQ(2u, db.getStatementCache().getHits());
+        EXPECT_EQ(1, value.getInt());
+    }
+    SQLite::Statement(db, text);
+    EXPECT_EQ(3u, db.getStatementCache().getHits());
+    EXPECT_EQ(1u, db.getStatementCache().getSize());
+}
+
+TEST(StatementCache, checkedOut) {
+    SQLite::Database db(":memory:", SQLite::OPEN_READWRITE|SQLite::OPEN_CREATE);
+    db.setStatementCacheCapacity(4);
+
+    // The same SQL text used by two live statements is prepared twice, and both are kept when given back
+    {
+        SQLite::Statement first(db, "SELECT 1");
+        SQLite::Statement second(db, "SELECT 1");
+        EXPECT_EQ(2u, db.getStatementCache().getMisses());
+        EXPECT_EQ(0u, db.getStatementCache().getSize());
+    }
+    EXPECT_EQ(2u, db.getStatementCache().getSize());
+    {
+        SQLite::Statement first(db, "SELECT 1");
+        SQLite::Statement second(db, "SELECT 1");
+        EXPECT_EQ(2u, db.getStatementCache().getHits());
+        EXPECT_EQ(0u, db.getStatementCache().getSize());
+
+        // A statement checked out when the cache is disabled is finalized when given back
+        db.setStatementCacheCapacity(0);
+    }
+    EXPECT_EQ(0u, db.getStatementCache().getSize());
+    db.setStatementCacheCapacity(4);
+    SQLite::Statement(db, "SELECT 1");
+    EXPECT_EQ(3u, db.getStatementCache().getMisses());
+    EXPECT_EQ(1u, db.getStatementCache().getSize());
+}
@@ -18,6 +18,8 @@
 
 #include <cstdio>
 #include <stdint.h>
+#include <string>
+#include <vector>
 
 
 TEST(Statement, invalid) {
@@ -651,3 +653,90 @@ TEST(Statement, getName) {
     EXPECT_EQ("msg", oname1);
 #endif
 }
+
+#if (__cplusplus >= 201402L) || ( defined(_MSC_VER) && (_MSC_VER >= 1900) ) // c++14: Visual Studio 2015
+TEST(Statement, rows) {
+    // Create a new database
+    SQLite::Database db(":memory:", SQLite::OPEN_READWRITE|SQLite::OPEN_CREATE);
+    EXPECT_EQ(0, db.exec("CREATE TABLE test (id INTEGER PRIMARY KEY, msg TEXT)"));
+    EXPECT_EQ(1, db.exec("INSERT INTO test VALUES (1, \"first\")"));
+    EXPECT_EQ(1, db.exec("INSERT INTO test VALUES (2, \"second\")"));
+    EXPECT_EQ(1, db.exec("INSERT INTO test VALUES (3, \"third\")"));
+
+    SQLite::Statement query(db, "SELECT id, msg FROM test ORDER BY id");
+    int count = 0;
+    for (const std::tuple<int, std::string>& row : query.rows<int, std::string>())
+    {
+        ++count;
+        EXPECT_EQ(count, std::get<0>(row));
+    }
+    EXPECT_EQ(3, count);
+    EXPECT_TRUE(query.isDone());
+
+    // The statement must be reset to iterate again
+    EXPECT_THROW(query.rows<int>().begin(), SQLite::Exception);
+    query.reset();
+    query.executeStep();
+    EXPECT_THROW(query.rows<int>().begin(), SQLite::Exception);
+    query.reset();
+
+#if (__cplusplus >= 201703L) || (defined(_MSVC_LANG) && (_MSVC_LANG >= 201703L))
+    std::string msgs;
+    for (auto [id, msg] : query.rows<long long, std::string_view>())
+    {
+        msgs += std::to_string(id);
+        msgs += msg;
+    }
+    EXPECT_EQ("1first2second3third", msgs);
+#endif
+
+    // An empty result gives an empty range
+    SQLite::Statement empty(db, "SELECT id FROM test WHERE id > 3");
+    SQLite::Rows<int> rows = empty.rows<int>();
+    EXPECT_TRUE(rows.begin() == rows.end());
+}
+
+TEST(Statement, fetchColumns) {
+    // Create a new database
+    SQLite::Database db(":memory:", SQLite::OPEN_READWRITE|SQLite::OPEN_CREATE);
+    EXPECT_EQ(0, db.exec("CREATE TABLE test (id INTEGER PRIMARY KEY, msg TEXT, weight REAL)"));
+    for (int i = 1; i <= 10; ++i)
+    {
+        EXPECT_EQ(1, db.exec("INSERT INTO test VALUES (" + std::to_string(i) + ", \"msg\", " + std::to_string(i) + ".5)"));
+    }
+
+    SQLite::Statement query(db, "SELECT id, weight, msg FROM test ORDER BY id");
+    std::vector<long long> ids;
+    std::vector<double> weights;
+    std::vector<std::string> msgs;
+
+    EXPECT_EQ(4u, query.fetchColumns(4, ids, weights, msgs));
+    ASSERT_EQ(4u, ids.size());
+    ASSERT_EQ(4u, weights.size());
+    ASSERT_EQ(4u, msgs.size());
+    EXPECT_EQ(1, ids[0]);
+    EXPECT_EQ(4, ids[3]);
+    EXPECT_EQ(4.5, weights[3]);
+    EXPECT_EQ("msg", msgs[3]);
+
+    // Fewer vectors than columns is fine
+    EXPECT_EQ(4u, query.fetchColumns(4, ids));
+    EXPECT_EQ(5, ids[0]);
+    EXPECT_EQ(2u, query.fetchColumns(4, ids, weights));
+    EXPECT_EQ(10, ids[1]);
+    EXPECT_EQ(10.5, weights[1]);
+    EXPECT_EQ(0u, query.fetchColumns(4, ids, weights));
+    EXPECT_TRUE(ids.empty());
+
+    query.reset();
+    std::vector<int> a, b, c, d;
+    EXPECT_THROW(query.fetchColumns(4, a, b, c, d), SQLite::Exception);
+    EXPECT_EQ(10u, query.fetchColumns(100, a));
+
+    // A batch size larger than any result does not allocate up front
+    query.reset();
+    EXPECT_EQ(10u, query.fetchColumns(SIZE_MAX, ids, weights));
+    EXPECT_EQ(10u, ids.size());
+    EXPECT_EQ(10.5, weights[9]);
+}
+#endif // c++14
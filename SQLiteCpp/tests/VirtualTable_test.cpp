@@ -0,0 +1,192 @@
+/**
+ * @file    VirtualTable_test.cpp
+ * @ingroup tests
+ * @brief   Test of a SQLiteCpp VirtualTable.
+ *
+ * Copyright (c) 2012-2016 Sebastien Rombauts (sebastien.rombauts@gmail.com)
+ *
+ * Distributed under the MIT License (MIT) (See accompanying file LICENSE.txt
+ * or copy at http://opensource.org/licenses/MIT)
+ */
+
+#include <SQLiteCpp/VirtualTable.h>
+#include <SQLiteCpp/Database.h>
+#include <SQLiteCpp/Statement.h>
+#include <SQLiteCpp/Exception.h>
+
+#include <sqlite3.h>
+
+#include <gtest/gtest.h>
+
+#include <string>
+#include <vector>
+
+
+struct Item
+{
+    long long   id;
+    std::string name;
+    double      price;
+};
+
+/// Return the plan of a query, as reported by EXPLAIN QUERY PLAN
+static std::string getPlan(SQLite::Database& aDatabase, const std::string& aQuery)
+{
+    SQLite::Statement explain(aDatabase, "EXPLAIN QUERY PLAN " + aQuery);
+    std::string plan;
+    while (explain.executeStep())
+    {
+        plan += explain.getColumn(3).getText();
+        plan += "\n";
+    }
+    return plan;
+}
+
+TEST(VirtualTable, scan) {
+    SQLite::Database db(":memory:", SQLite::OPEN_READWRITE);
+    std::vector<Item> items;
+    for (long long i = 0; i < 100; ++i)
+    {
+        const Item item = { 100 - i, "item " + std::to_string(100 - i), 0.5 * i };
+        items.push_back(item);
+    }
+
+    SQLite::VirtualTable<std::vector<Item> > table(db, "items", items, {
+        SQLite::makeVirtualColumn("id", &Item::id, true),
+        SQLite::makeVirtualColumn("name", &Item::name, true),
+        SQLite::makeVirtualColumn("price", &Item::price) });
+    EXPECT_EQ("items", table.getName());
+
+    EXPECT_EQ(100, db.execAndGet("SELECT count(*) FROM items").getInt());
+    EXPECT_EQ(2475.0, db.execAndGet("SELECT sum(price) FROM items").getDouble());
+    EXPECT_EQ("item 42", db.execAndGet("SELECT name FROM items WHERE id = 42").getString());
+    EXPECT_EQ("item 42", db.execAndGet("SELECT name FROM items WHERE id = '42'").getString());
+    EXPECT_EQ(42, db.execAndGet("SELECT id FROM items WHERE name = 'item 42'").getInt());
+    EXPECT_EQ(0, db.execAndGet("SELECT count(*) FROM items WHERE id = 1000").getInt());
+    EXPECT_EQ(0, db.execAndGet("SELECT count(*) FROM items WHERE id = NULL").getInt());
+
+    // Ranges on a key column
+    EXPECT_EQ(10, db.execAndGet("SELECT count(*) FROM items WHERE id > 90").getInt());
+    EXPECT_EQ(11, db.execAndGet("SELECT count(*) FROM items WHERE id >= 90").getInt());
+    EXPECT_EQ(9, db.execAndGet("SELECT count(*) FROM items WHERE id < 10").getInt());
+    EXPECT_EQ(10, db.execAndGet("SELECT count(*) FROM items WHERE id <= 10").getInt());
+    EXPECT_EQ(5, db.execAndGet("SELECT count(*) FROM items WHERE id > 10 AND id <= 15").getInt());
+    EXPECT_EQ(0, db.execAndGet("SELECT count(*) FROM items WHERE id > 15 AND id < 10").getInt());
+    EXPECT_EQ(5, db.execAndGet("SELECT count(*) FROM items WHERE id BETWEEN 10.5 AND 15").getInt());
+
+    // Constraints are pushed down to the index of the key column
+    EXPECT_NE(std::string::npos, getPlan(db, "SELECT * FROM items WHERE id = 42").find("id="));
+    EXPECT_NE(std::string::npos, getPlan(db, "SELECT * FROM items WHERE id > 10 AND id < 20").find("id<>"));
+    EXPECT_NE(std::string::npos, getPlan(db, "SELECT * FROM items WHERE price = 1").find("INDEX 0:"));
+}
+
+TEST(VirtualTable, join) {
+    SQLite::Database db(":memory:", SQLite::OPEN_READWRITE);
+    db.exec("CREATE TABLE orders (id INTEGER PRIMARY KEY, item_id INTEGER, quantity INTEGER)");
+    db.exec("INSERT INTO orders VALUES (1, 3, 2), (2, 1, 5), (3, 3, 1), (4, 7, 1)");
+
+    // Items of odd ids, but 7 so that the order 4 has no match
+    std::vector<Item> items;
+    for (long long i = 1; i < 100; i += 2)
+    {
+        const Item item = { i, "item " + std::to_string(i), 0.25 * i };
+        items.push_back(item);
+    }
+    items.erase(items.begin() + 3);
+    SQLite::VirtualTable<std::vector<Item> > table(db, "items", items, {
+        SQLite::makeVirtualColumn("id", &Item::id, true),
+        SQLite::makeVirtualColumn("name", &Item::name),
+        SQLite::makeVirtualColumn("price", &Item::price) });
+
+    const std::string query = "SELECT orders.id, items.name, orders.quantity * items.price FROM orders"
+                              " JOIN items ON items.id = orders.item_id ORDER BY orders.id";
+    EXPECT_NE(std::string::npos, getPlan(db, query).find("id="));
+    SQLite::Statement join(db, query);
+    ASSERT_TRUE(join.executeStep());
+    EXPECT_EQ(1, join.getColumn(0).getInt());
+    EXPECT_EQ("item 3", join.getColumn(1).getString());
+    EXPECT_EQ(1.5, join.getColumn(2).getDouble());
+    ASSERT_TRUE(join.executeStep());
+    EXPECT_EQ(2, join.getColumn(0).getInt());
+    EXPECT_EQ("item 1", join.getColumn(1).getString());
+    ASSERT_TRUE(join.executeStep());
+    EXPECT_EQ(3, join.getColumn(0).getInt());
+    EXPECT_FALSE(join.executeStep());
+    join.reset();
+
+    // The content of the container is read by each query, and the indexes are rebuilt after invalidate()
+    const Item seven = { 7, "plum", 1.0 };
+    items.push_back(seven);
+    items[0].id = 2;
+    table.invalidate();
+    int count = 0;
+    while (join.executeStep())
+    {
+        ++count;
+    }
+    EXPECT_EQ(3, count);
+    EXPECT_EQ("plum", db.execAndGet("SELECT name FROM items WHERE id = 7").getString());
+    EXPECT_EQ(0, db.execAndGet("SELECT count(*) FROM items WHERE id = 1").getInt());
+}
+
+TEST(VirtualTable, lifetime) {
+    SQLite::Database db(":memory:", SQLite::OPEN_READWRITE);
+    const Item items[] = { { 1, "one", 1.0 }, { 2, "two", 2.0 } };
+    {
+        // A computed column
+        const SQLite::VirtualColumn<Item> initial = { "initial", "TEXT", false,
+                                                      [](const Item& aItem) { return SQLite::VirtualValue::text(aItem.name.data(), 1); } };
+        SQLite::VirtualTable<Item[2]> table(db, "items", items, { SQLite::makeVirtualColumn("id", &Item::id, true), initial });
+        EXPECT_EQ("t", db.execAndGet("SELECT initial FROM items WHERE id = 2").getString());
+        EXPECT_EQ(1, db.execAndGet("SELECT count(*) FROM sqlite_temp_master WHERE name = 'items'").getInt());
+
+        // The same name cannot be used twice
+        EXPECT_THROW(SQLite::VirtualTable<Item[2]>(db, "items", items, { SQLite::makeVirtualColumn("id", &Item::id) }),
+                     SQLite::Exception);
+    }
+    // Dropped by the destructor: the name can be reused
+    EXPECT_EQ(0, db.execAndGet("SELECT count(*) FROM sqlite_temp_master WHERE name = 'items'").getInt());
+    SQLite::VirtualTable<Item[2]> table(db, "items", items, { SQLite::makeVirtualColumn("id", &Item::id) });
+    EXPECT_EQ(3, db.execAndGet("SELECT sum(id) FROM items").getInt());
+}
+
+TEST(VirtualTable, modulePerConnection) {
+    const Item items[] = { { 1, "one", 1.0 }, { 2, "two", 2.0 } };
+    for (int i = 0; i < 3; ++i)
+    {
+        SQLite::Database db(":memory:", SQLite::OPEN_READWRITE);
+
+        // All the virtual tables of a connection share its module, whatever their number
+        for (int j = 0; j < 100; ++j)
+        {
+            SQLite::VirtualTable<Item[2]> table(db, "items", items, { SQLite::makeVirtualColumn("id", &Item::id) });
+            SQLite::VirtualTable<Item[2]> other(db, "other", items, { SQLite::makeVirtualColumn("price", &Item::price) });
+            EXPECT_EQ(3, db.execAndGet("SELECT sum(id) FROM items").getInt());
+            EXPECT_EQ(3.0, db.execAndGet("SELECT sum(price) FROM other").getDouble());
+        }
+
+        // The module only connects the virtual tables created by a VirtualTable
+        EXPECT_THROW(db.exec("CREATE VIRTUAL TABLE temp.items USING sqlitecpp_vtab"), SQLite::Exception);
+        EXPECT_EQ(0, db.execAndGet("SELECT count(*) FROM sqlite_temp_master").getInt());
+    }
+}
+
+TEST(VirtualTable, moduleNameTaken) {
+    const Item items[] = { { 1, "one", 1.0 }, { 2, "two", 2.0 } };
+    {
+        SQLite::Database db(":memory:", SQLite::OPEN_READWRITE);
+
+        // Another module already registered under the name: the registry of the connection is never published
+        static const sqlite3_module other = sqlite3_module();
+        EXPECT_EQ(SQLITE_OK, sqlite3_create_module(db.getHandle(), "sqlitecpp_vtab", &other, NULL));
+        for (int i = 0; i < 2; ++i)
+        {
+            EXPECT_THROW(SQLite::VirtualTable<Item[2]>(db, "items", items, { SQLite::makeVirtualColumn("id", &Item::id) }),
+                         SQLite::Exception);
+        }
+    }
+    // Other connections are not affected
+    SQLite::Database db(":memory:", SQLite::OPEN_READWRITE);
+    SQLite::VirtualTable<Item[2]> table(db, "items", items, { SQLite::makeVirtualColumn("id", &Item::id) });
+    EXPECT_EQ(3, db.execAndGet("SELECT sum(id) FROM items").getInt());
+}
@@ -0,0 +1,146 @@
+﻿//---------------------------------------------------------------------
+// <copyright file="odata_multipart_reader_test.cpp" company="Microsoft">
+//      Copyright (C) Microsoft Corporation. All rights reserved. See License.txt in the project root for license information.
+// </copyright>
+//---------------------------------------------------------------------
+
+#include "../odata_tests.h"
+#include "odata/core/odata_multipart_reader.h"
+#include "cpprest/containerstream.h"
+#include "cpprest/producerconsumerstream.h"
+
+using namespace ::odata::core;
+
+namespace tests { namespace functional { namespace _odata {
+
+class multipart_event_recorder : public odata_multipart_handler
+{
+public:
+	void on_part_begin(const odata_multipart_headers& headers, int depth)
+	{
+		m_events += "begin(" + std::to_string(depth);
+		for (auto header = headers.cbegin(); header != headers.cend(); ++header)
+		{
+			m_events += "," + header->first + "=" + header->second;
+		}
+		m_events += ")";
+	}
+
+	void on_part_data(const char* data, size_t size)
+	{
+		m_events.append(data, size);
+	}
+
+	void on_part_end()
+	{
+		m_events += "|end;";
+	}
+
+	void on_changeset_begin(const odata_multipart_headers&, const std::string& boundary)
+	{
+		m_events += "changeset(" + boundary + ");";
+	}
+
+	void on_changeset_end()
+	{
+		m_events += "changeset_end;";
+	}
+
+	void on_end()
+	{
+		m_events += "done";
+	}
+
+	std::string m_events;
+};
+
+static const std::string batch_payload =
+	"--batch_1\r\n"
+	"Content-Type: application/http\r\n"
+	"\r\n"
+	"GET People HTTP/1.1\r\n"
+	"\r\n"
+	"\r\n"
+	"--batch_1\r\n"
+	"Content-Type: multipart/mixed; boundary=changeset_1\r\n"
+	"\r\n"
+	"--changeset_1\r\n"
+	"Content-ID: 1\r\n"
+	"\r\n"
+	"body\r\n--batch\r\n"
+	"--changeset_1--\r\n"
+	"--batch_1--\r\n";
+
+static const std::string batch_events =
+	"begin(0,Content-Type=application/http)GET People HTTP/1.1\r\n\r\n|end;"
+	"changeset(changeset_1);"
+	"begin(1,Content-ID=1)body\r\n--batch|end;"
+	"changeset_end;"
+	"done";
+
+// writes the payload to a producer/consumer stream buffer in chunks, while read_async() consumes it
+static std::string read_multipart_async(const std::string& payload, size_t write_size, size_t chunk_size)
+{
+	Concurrency::streams::producer_consumer_buffer<uint8_t> buffer;
+	multipart_event_recorder recorder;
+	auto reader = std::make_shared<odata_multipart_reader>("batch_1", recorder);
+	auto task = odata_multipart_reader::read_async(buffer.create_istream(), reader, chunk_size);
+
+	for (size_t pos = 0; pos < payload.size(); pos += write_size)
+	{
+		const size_t size = std::min(write_size, payload.size() - pos);
+		buffer.putn_nocopy(reinterpret_cast<const uint8_t*>(payload.data() + pos), size).wait();
+	}
+	buffer.close(std::ios_base::out).wait();
+	task.get();
+
+	return recorder.m_events;
+}
+
+SUITE(odata_multipart_reader_test_cases)
+{
+
+TEST(read_async_container_stream)
+{
+	// the container buffer holds the whole payload, which is parsed in place through acquire()
+	multipart_event_recorder recorder;
+	auto reader = std::make_shared<odata_multipart_reader>("batch_1", recorder);
+	odata_multipart_reader::read_async(Concurrency::streams::bytestream::open_istream(batch_payload), reader).get();
+	VERIFY_ARE_EQUAL(recorder.m_events, batch_events);
+	VERIFY_ARE_EQUAL(reader->is_done(), true);
+}
+
+TEST(read_async_producer_consumer_stream)
+{
+	// an empty producer/consumer buffer makes read_async() wait in getn(), and the blocks written meanwhile are acquire()d;
+	// the writes and the chunks of getn() split the delimiters at different offsets
+	for (size_t write_size = 1; write_size < 24; write_size += 5)
+	{
+		for (size_t chunk_size = 1; chunk_size < 24; chunk_size += 3)
+		{
+			VERIFY_ARE_EQUAL(read_multipart_async(batch_payload, write_size, chunk_size), batch_events);
+		}
+	}
+	VERIFY_ARE_EQUAL(read_multipart_async(batch_payload, batch_payload.size(), 64 * 1024), batch_events);
+}
+
+TEST(read_async_stops_at_close_delimiter)
+{
+	// the epilogue is ignored, even when it looks like a delimiter
+	multipart_event_recorder recorder;
+	auto reader = std::make_shared<odata_multipart_reader>("batch_1", recorder);
+	odata_multipart_reader::read_async(Concurrency::streams::bytestream::open_istream(batch_payload + "epilogue\r\n--batch_1\r\n"), reader, 8).get();
+	VERIFY_ARE_EQUAL(recorder.m_events, batch_events);
+}
+
+TEST(read_async_truncated_stream)
+{
+	multipart_event_recorder recorder;
+	auto reader = std::make_shared<odata_multipart_reader>("batch_1", recorder);
+	auto task = odata_multipart_reader::read_async(Concurrency::streams::bytestream::open_istream(batch_payload.substr(0, batch_payload.size() - 6)), reader);
+	VERIFY_THROWS(task.get(), std::runtime_error);
+}
+
+}
+
+}}}
@@ -14,7 +14,7 @@ namespace odata { namespace core
 class odata_batch_part_value
 {
 public:
-    odata_batch_part_value():m_status_code(200), m_status_message(U("OK"))
+    odata_batch_part_value():m_status_code(200), m_status_message(U("OK")), m_changeset_index(-1)
     {
     }
 
@@ -48,6 +48,39 @@ public:
         m_status_message = status_message;
     }
 
+    /// <summary>Method of the request line of a request part, empty for a response part.</summary>
+    ::odata::utility::string_t get_method()
+    {
+        return m_method;
+    }
+
+    void set_method(::odata::utility::string_t method)
+    {
+        m_method = method;
+    }
+
+    /// <summary>Url of the request line of a request part as written, which may be relative to the service root.</summary>
+    ::odata::utility::string_t get_url()
+    {
+        return m_url;
+    }
+
+    void set_url(::odata::utility::string_t url)
+    {
+        m_url = url;
+    }
+
+    /// <summary>Index of the changeset of the part in its odata_batch_value, or -1 for a top level part.</summary>
+    int get_changeset_index()
+    {
+        return m_changeset_index;
+    }
+
+    void set_changeset_index(int changeset_index)
+    {
+        m_changeset_index = changeset_index;
+    }
+
     void set_header(::odata::utility::string_t name, ::odata::utility::string_t value)
     {
         m_headers[name] = value;
@@ -67,6 +100,9 @@ private:
     std::shared_ptr<::odata::core::odata_value> m_value;
     int16_t m_status_code;
     ::odata::utility::string_t m_status_message;
+    ::odata::utility::string_t m_method;
+    ::odata::utility::string_t m_url;
+    int m_changeset_index;
     std::unordered_map<::odata::utility::string_t, ::odata::utility::string_t> m_headers;
 };
 }}
\ No newline at end of file
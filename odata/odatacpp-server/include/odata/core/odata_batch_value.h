@@ -39,8 +39,26 @@ class odata_batch_value
         m_parts.push_back(batch_part_value);
 	}
 
+    /// <summary>Starts a changeset with the given boundary and returns its index, to set on its parts.</summary>
+    int add_changeset(::odata::utility::string_t boundary)
+    {
+        m_changeset_boundaries.push_back(boundary);
+        return (int)m_changeset_boundaries.size() - 1;
+    }
+
+    size_t get_changeset_count() const
+    {
+        return m_changeset_boundaries.size();
+    }
+
+    ::odata::utility::string_t get_changeset_boundary(int changeset_index) const
+    {
+        return m_changeset_boundaries.at(changeset_index);
+    }
+
     private:
     ::odata::utility::string_t m_boundary;
     std::vector<std::shared_ptr<odata_batch_part_value>> m_parts;
+    std::vector<::odata::utility::string_t> m_changeset_boundaries;
 };
 }}
\ No newline at end of file
@@ -16,7 +16,7 @@ namespace odata { namespace core
 class odata_collection_value : public odata_value
 {
 public:
-    odata_collection_value(std::shared_ptr<::odata::edm::edm_named_type> type) : odata_value(type)
+    odata_collection_value(std::shared_ptr<::odata::edm::edm_named_type> type) : odata_value(std::move(type))
     {
     }
 
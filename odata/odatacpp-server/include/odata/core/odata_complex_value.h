@@ -16,7 +16,7 @@ namespace odata { namespace core
 class odata_complex_value : public odata_structured_value
 {
 public:
-	odata_complex_value(std::shared_ptr<::odata::edm::edm_named_type> type) : odata_structured_value(type)
+	odata_complex_value(std::shared_ptr<::odata::edm::edm_named_type> type) : odata_structured_value(std::move(type))
     {
     }
 };
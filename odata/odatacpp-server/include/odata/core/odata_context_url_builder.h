@@ -34,38 +34,64 @@ public:
 
     ::odata::utility::uri get_context_uri_for_collection_of_entities(std::shared_ptr<::odata::edm::edm_entity_set> entity_set)
     {
-        ::odata::utility::uri_builder builder(m_metadata_url);
-        return builder.append_path(entity_set->get_name()).to_uri();
+        return get_cached_context_uri(entity_set->get_name(), U(""), false);
     }
 
     ::odata::utility::uri get_context_uri_for_entity(std::shared_ptr<::odata::edm::edm_entity_set> entity_set)
     {
-        ::odata::utility::uri_builder builder(m_metadata_url);
-        return builder.append_path(entity_set->get_name()).append_path(U("$entity")).to_uri();
+        return get_cached_context_uri(entity_set->get_name(), U(""), true);
     }
 
     ::odata::utility::uri get_context_uri_for_singleton(std::shared_ptr<::odata::edm::edm_singleton> singleton)
     {
-        ::odata::utility::uri_builder builder(m_metadata_url);
-        return builder.append_path(singleton->get_name()).to_uri();
+        return get_cached_context_uri(singleton->get_name(), U(""), false);
     }
 
     ::odata::utility::uri get_context_uri_for_collection_of_dervied_entities(std::shared_ptr<::odata::edm::edm_entity_set> entity_set, std::shared_ptr<::odata::edm::edm_entity_type> entity_type)
     {
-        ::odata::utility::uri_builder builder(m_metadata_url);
-        return builder.append_path(entity_set->get_name()).append_path(entity_type->get_full_name()).to_uri();
+        return get_cached_context_uri(entity_set->get_name(), entity_type->get_full_name(), false);
     }
 
     ::odata::utility::uri get_context_uri_for_derived_entity(std::shared_ptr<::odata::edm::edm_entity_set> entity_set, std::shared_ptr<::odata::edm::edm_entity_type> entity_type)
     {
-        ::odata::utility::uri_builder builder(m_metadata_url);
-        return builder.append_path(entity_set->get_name()).append_path(entity_type->get_full_name()).append_path(U("$entity")).to_uri();
+        return get_cached_context_uri(entity_set->get_name(), entity_type->get_full_name(), true);
     }
 
 private:
+    // Context urls only depend on the navigation source and the type cast, so each one is built once per builder
+    // instead of once per response.
+    ::odata::utility::uri get_cached_context_uri(const ::odata::utility::string_t& navigation_source, const ::odata::utility::string_t& type_name, bool is_single_entity)
+    {
+        m_cache_key.assign(navigation_source);
+        m_cache_key += U('/');
+        m_cache_key += type_name;
+        m_cache_key += is_single_entity ? U('1') : U('*');
+
+        auto iter = m_context_uris.find(m_cache_key);
+        if (iter != m_context_uris.end())
+        {
+            return iter->second;
+        }
+
+        ::odata::utility::uri_builder builder(m_metadata_url);
+        builder.append_path(navigation_source);
+        if (!type_name.empty())
+        {
+            builder.append_path(type_name);
+        }
+        if (is_single_entity)
+        {
+            builder.append_path(U("$entity"));
+        }
+
+        return m_context_uris[m_cache_key] = builder.to_uri();
+    }
+
 	std::shared_ptr<::odata::edm::edm_model> m_model;
 	::odata::utility::uri m_metadata_url;
     ::odata::utility::uri_builder m_builder;
+    std::unordered_map<::odata::utility::string_t, ::odata::utility::uri> m_context_uris;
+    ::odata::utility::string_t m_cache_key;
 };
 
 }}
\ No newline at end of file
@@ -16,3 +16,4 @@
 #include "odata/core/odata_entity_model_builder.h"
 #include "odata/core/odata_parameter.h"
 #include "odata/core/odata_exception.h"
+#include "odata/core/odata_value_arena.h"
@@ -0,0 +1,60 @@
+﻿//---------------------------------------------------------------------
+// <copyright file="odata_entity_link_template.h" company="Microsoft">
+//      Copyright (C) Microsoft Corporation. All rights reserved. See License.txt in the project root for license information.
+// </copyright>
+//---------------------------------------------------------------------
+
+#pragma once
+
+#include "odata/common/utility.h"
+#include "odata/edm/odata_edm.h"
+
+namespace odata { namespace core
+{
+class odata_entity_value;
+
+/// <summary>
+/// Precompiled @odata.id / @odata.editLink template for one navigation source and key shape.
+/// The navigation source prefix and the key property names are resolved once, so the link of an
+/// entity is produced by appending its formatted key to a reusable buffer.
+/// </summary>
+class odata_entity_link_template
+{
+public:
+	/// <param name="navigation_source">Absolute url of the entity set, singleton or navigation property, e.g. http://host/service/People</param>
+	/// <param name="entity_type">The declared entity type of the navigation source, also used to resolve the key properties.</param>
+	/// <param name="append_key">False for singletons and single-valued navigation properties, which are addressed without a key.</param>
+	/// <param name="expected_type_name">Only for payloads read with minimal metadata: the short type name derived entities are detected against.
+	/// Derived entities then get the type cast segment of their @odata.type annotation, if any, instead of the full name of their value type.</param>
+	ODATACPP_API odata_entity_link_template(const ::odata::utility::string_t& navigation_source, const std::shared_ptr<::odata::edm::edm_entity_type>& entity_type, 
+		bool append_key = true, const ::odata::utility::string_t& expected_type_name = ::odata::utility::string_t());
+
+	const ::odata::utility::string_t& get_navigation_source() const
+	{
+		return m_navigation_source;
+	}
+
+	bool append_key() const
+	{
+		return m_append_key;
+	}
+
+	/// <summary>Appends the canonical id of the entity, navigation source followed by the key segment, to the buffer.</summary>
+	ODATACPP_API void append_id(odata_entity_value& entity_value, ::odata::utility::string_t& buffer) const;
+
+	/// <summary>Appends the edit link of the entity to the buffer; derived entities get the type cast segment appended.</summary>
+	ODATACPP_API void append_edit_link(odata_entity_value& entity_value, ::odata::utility::string_t& buffer) const;
+
+	/// <summary>Appends the key segment, "(1)" or "(A=1,B=2)", built from the precompiled key property names.</summary>
+	ODATACPP_API void append_key_string(odata_entity_value& entity_value, ::odata::utility::string_t& buffer) const;
+
+private:
+	::odata::utility::string_t m_navigation_source;
+	::odata::utility::string_t m_type_name;
+	::odata::utility::string_t m_type_full_name;
+	std::vector<::odata::utility::string_t> m_key_names;
+	bool m_append_key;
+	bool m_use_type_annotation;
+};
+
+}}
@@ -9,6 +9,7 @@
 #include "odata/edm/odata_edm.h"
 #include "odata/core/odata_value.h"
 #include "odata/core/odata_structured_value.h"
+#include "odata/core/odata_entity_link_template.h"
 
 namespace odata { namespace core
 {
@@ -16,7 +17,7 @@ namespace odata { namespace core
 class odata_entity_value : public odata_structured_value
 {
 public:
-	odata_entity_value(std::shared_ptr<::odata::edm::edm_entity_type> type) : odata_structured_value(type)
+	odata_entity_value(std::shared_ptr<::odata::edm::edm_entity_type> type) : odata_structured_value(std::move(type))
 	{}
 
     odata_entity_value(odata_property_map properties, std::shared_ptr<::odata::edm::edm_entity_type> type) : odata_structured_value(type, properties)
@@ -42,14 +43,25 @@ public:
         m_id = id;
     }
 
-    ::odata::utility::uri get_edit_link()
+    /// <summary>Returns the edit link, materializing it from the link template on first access if one was attached.</summary>
+    ODATACPP_API ::odata::utility::uri get_edit_link();
+
+    /// <summary>Tells whether an edit link is set or can be computed, without materializing it.</summary>
+    bool has_edit_link() const
     {
-        return m_edit_link;
+        return m_link_template || !m_edit_link.is_empty();
     }
 
     void set_edit_link(::odata::utility::uri edit_link)
     {
         m_edit_link = edit_link;
+        m_link_template.reset();
+    }
+
+    /// <summary>Defers the edit link computation to the shared template of the navigation source.</summary>
+    void set_link_template(std::shared_ptr<odata_entity_link_template> link_template)
+    {
+        m_link_template = std::move(link_template);
     }
 
     ::odata::utility::uri get_read_link()
@@ -64,12 +76,15 @@ public:
 
 	ODATACPP_API ::odata::utility::string_t get_entity_key_string();
 
+	ODATACPP_API void append_entity_key_string(::odata::utility::string_t& buffer);
+
 private:
     ::odata::utility::string_t m_etag;
 
     ::odata::utility::uri m_id;
     ::odata::utility::uri m_edit_link;
     ::odata::utility::uri m_read_link;
+    std::shared_ptr<odata_entity_link_template> m_link_template;
 };
 
 }}
\ No newline at end of file
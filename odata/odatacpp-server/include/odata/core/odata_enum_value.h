@@ -15,7 +15,7 @@ namespace odata { namespace core
 class odata_enum_value : public odata_value
 {
 public:
-    odata_enum_value(std::shared_ptr<::odata::edm::edm_named_type>type, const ::odata::utility::string_t& stringRep) : odata_value(type), m_string_rep(stringRep)
+    odata_enum_value(std::shared_ptr<::odata::edm::edm_named_type>type, const ::odata::utility::string_t& stringRep) : odata_value(std::move(type)), m_string_rep(stringRep)
     {
     }
 
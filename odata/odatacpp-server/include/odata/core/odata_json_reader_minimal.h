@@ -9,6 +9,7 @@
 #include "odata/common/json.h"
 #include "odata/common/utility.h"
 #include "odata/core/odata_core.h"
+#include "odata/core/odata_value_arena.h"
 #include "odata/edm/odata_edm.h"
 
 namespace odata { namespace core
@@ -18,9 +19,27 @@ class odata_json_reader_minimal
 {
 public:
 	odata_json_reader_minimal(std::shared_ptr<::odata::edm::edm_model> model, const ::odata::utility::string_t& service_root_url, bool is_reading_response = true) 
-		: m_model(model), m_service_root_url(service_root_url), m_is_reading_response(is_reading_response)
+		: m_model(model), m_service_root_url(service_root_url), m_is_reading_response(is_reading_response), m_lazy_edit_links(false)
 	{
 	};
+
+	/// <summary>
+	/// When set, entities read from a response get a shared link template instead of a materialized edit link;
+	/// the edit link is only formatted if odata_entity_value::get_edit_link() is called.
+	/// </summary>
+	void set_lazy_edit_links(bool lazy_edit_links)
+	{
+		m_lazy_edit_links = lazy_edit_links;
+	}
+
+	/// <summary>
+	/// When set, the values read are made inside the arena and refer to the edm types of the model without owning them,
+	/// so the model must outlive the values. Pass nullptr to return to individually allocated values.
+	/// </summary>
+	void set_value_arena(std::shared_ptr<odata_value_arena> value_arena)
+	{
+		m_value_arena = std::move(value_arena);
+	}
 	
 	ODATACPP_API std::shared_ptr<odata_value> deserilize(const odata::utility::json::value& content);
 
@@ -38,13 +57,42 @@ private:
 	std::shared_ptr<odata_value> handle_extract_navigation_property(const ::odata::utility::json::value& value, std::shared_ptr<::odata::edm::edm_navigation_type> navigation_type);
 	::odata::utility::string_t get_navigation_source_from_context_url(const ::odata::utility::string_t& context_url);
 	void set_edit_link_for_entity_value(const std::shared_ptr<odata_entity_value>& entity_value, const ::odata::utility::string_t& expect_type_name, const ::odata::utility::string_t& navigation_source);
+	bool is_navigation_source_keyed(const ::odata::utility::string_t& navigation_source);
+	std::shared_ptr<odata_entity_link_template> get_link_template(const std::shared_ptr<odata_entity_value>& entity_value, const ::odata::utility::string_t& expect_type_name, const ::odata::utility::string_t& navigation_source, bool is_collection_member);
+	void apply_link_template(const std::shared_ptr<odata_entity_value>& entity_value, const std::shared_ptr<odata_entity_link_template>& link_template);
 	void set_edit_link_for_entity_collection_value(const std::shared_ptr<odata_collection_value>& entity_collection_value, const ::odata::utility::string_t& expect_type_name, const ::odata::utility::string_t& navigation_source);
 	std::shared_ptr<::odata::edm::edm_named_type> prepare_for_reading(const odata::utility::json::value& content, std::shared_ptr<::odata::edm::edm_named_type> edm_type);
+	std::shared_ptr<odata_primitive_value> make_annotation_value(const ::odata::utility::string_t& annotation, const ::odata::utility::string_t& value);
+
+	// only for types owned by the model, types made while reading must stay owned by the values
+	template<typename T>
+	std::shared_ptr<T> model_type(const std::shared_ptr<T>& type) const
+	{
+		return m_value_arena ? odata_value_arena::borrow_type(type) : type;
+	}
+
+	template<typename T, typename A1>
+	std::shared_ptr<T> make_value(A1&& a1)
+	{
+		return m_value_arena ? m_value_arena->make<T>(std::forward<A1>(a1)) : std::make_shared<T>(std::forward<A1>(a1));
+	}
+
+	template<typename T, typename A1, typename A2>
+	std::shared_ptr<T> make_value(A1&& a1, A2&& a2)
+	{
+		return m_value_arena ? m_value_arena->make<T>(std::forward<A1>(a1), std::forward<A2>(a2)) : std::make_shared<T>(std::forward<A1>(a1), std::forward<A2>(a2));
+	}
 
 	std::shared_ptr<::odata::edm::edm_model> m_model;
 	::odata::utility::string_t m_service_root_url; 
     std::shared_ptr<::odata::edm::edm_entity_set> m_entity_set;
 	bool m_is_reading_response;
+	bool m_lazy_edit_links;
+	std::unordered_map<::odata::utility::string_t, std::shared_ptr<odata_entity_link_template>> m_link_templates;
+	::odata::utility::string_t m_link_template_key;
+	::odata::utility::string_t m_link_buffer;
+	std::shared_ptr<odata_value_arena> m_value_arena;
+	std::unordered_map<::odata::utility::string_t, std::shared_ptr<::odata::edm::edm_payload_annotation_type>> m_annotation_types;
 };
 
 }}
\ No newline at end of file
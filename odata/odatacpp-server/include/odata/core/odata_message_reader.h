@@ -9,11 +9,15 @@
 #include "odata/common/utility.h"
 #include "odata/edm/odata_edm.h"
 #include "odata/core/odata_value.h"
+#include "odata/core/odata_batch_value.h"
+#include "odata/core/odata_value_arena.h"
 #include "odata/common/json.h"
 #include "odata/common/uri.h"
 
 namespace odata { namespace core
 {
+class odata_json_reader_minimal;
+
 class odata_message_reader
 {
 public:
@@ -22,6 +26,12 @@ public:
 	{
 	}
 
+	/// <summary>Makes the values read inside the arena, see odata_json_reader_minimal::set_value_arena.</summary>
+	void set_value_arena(std::shared_ptr<odata_value_arena> value_arena)
+	{
+		m_value_arena = std::move(value_arena);
+	}
+
 	ODATACPP_API std::shared_ptr<::odata::core::odata_value> read_odata_value();
 
 	ODATACPP_API std::shared_ptr<::odata::core::odata_entity_value> read_entity_value(std::shared_ptr<::odata::edm::edm_entity_type> edm_type);
@@ -33,13 +43,22 @@ public:
 	ODATACPP_API std::shared_ptr<::odata::core::odata_value> read_property(std::shared_ptr<::odata::edm::edm_named_type> edm_type);
 	ODATACPP_API std::shared_ptr<::odata::core::odata_value> read_property();
 
-	//ODATACPP_API std::shared_ptr<::odata::core::odata_batch_value> read_batch_value();
+	/// <summary>
+	/// Reads a multipart/mixed $batch message with the given boundary. Parts are added to the batch value in wire order,
+	/// the parts of a changeset with the index of the changeset; the request line of a request part, or the status line
+	/// of a response part, is kept on the part. Part bodies which carry an @odata.context are deserialized into the
+	/// part's odata value. Parts are parsed in place from the message body, without copying them.
+	/// </summary>
+	ODATACPP_API std::shared_ptr<::odata::core::odata_batch_value> read_batch_value(const ::odata::utility::string_t& boundary);
 
 private:
+	std::shared_ptr<::odata::core::odata_batch_part_value> read_batch_part(const char* message, size_t size, const std::shared_ptr<odata_json_reader_minimal>& json_reader);
+
 	std::shared_ptr<::odata::edm::edm_model> m_model;
 	::odata::utility::uri m_base_uri;
 	bool m_is_response_message;
 	::odata::utility::string_t m_message_body;
+	std::shared_ptr<odata_value_arena> m_value_arena;
 };
 
 }}
\ No newline at end of file
@@ -10,6 +10,7 @@
 #include "odata/edm/odata_edm.h"
 #include "odata/edm/edm_model_writer.h"
 #include "odata/core/odata_value.h"
+#include "odata/core/odata_entity_value.h"
 #include "odata/core/odata_json_writer.h"
 #include "odata/core/odata_service_document.h"
 #include "odata/common/json.h"
@@ -27,8 +28,9 @@ public:
 
     ::odata::utility::uri get_entity_id(std::shared_ptr<::odata::core::odata_entity_value> entity_value, std::shared_ptr<::odata::edm::edm_entity_set> entity_set)
     {
-        ::odata::utility::uri_builder builder(m_service_root);
-        return builder.append_path(entity_set->get_name() + entity_value->get_entity_key_string()).to_uri();
+        m_link_buffer.clear();
+        get_entity_link_template(entity_set)->append_id(*entity_value, m_link_buffer);
+        return m_link_buffer;
     }
 
     ::odata::utility::uri get_read_link(std::shared_ptr<::odata::core::odata_entity_value> entity_value, std::shared_ptr<::odata::edm::edm_entity_set> entity_set)
@@ -38,20 +40,35 @@ public:
 
     ::odata::utility::uri get_edit_link(std::shared_ptr<::odata::core::odata_entity_value> entity_value, std::shared_ptr<::odata::edm::edm_entity_set> entity_set)
     {
-        ::odata::utility::uri_builder builder(m_service_root);
-        builder.append_path(entity_set->get_name() + entity_value->get_entity_key_string());
-        if (entity_value->get_value_type()->get_full_name() != entity_set->get_entity_type()->get_full_name())
+        m_link_buffer.clear();
+        get_entity_link_template(entity_set)->append_edit_link(*entity_value, m_link_buffer);
+        return m_link_buffer;
+    }
+
+    /// <summary>
+    /// Returns the link template of an entity set, compiled on first use. Entities of a feed can share it
+    /// through odata_entity_value::set_link_template() so that their links are only formatted when written.
+    /// </summary>
+    std::shared_ptr<::odata::core::odata_entity_link_template> get_entity_link_template(std::shared_ptr<::odata::edm::edm_entity_set> entity_set)
+    {
+        auto iter = m_link_templates.find(entity_set->get_name());
+        if (iter != m_link_templates.end())
         {
-            builder.append_path(entity_value->get_value_type()->get_full_name());
+            return iter->second;
         }
 
-        return builder.to_uri();
-    }
+        ::odata::utility::uri_builder builder(m_service_root);
+        builder.append_path(entity_set->get_name());
+        auto link_template = std::make_shared<::odata::core::odata_entity_link_template>(builder.to_string(), entity_set->get_entity_type());
 
+        return m_link_templates[entity_set->get_name()] = link_template;
+    }
 
 private:
 	std::shared_ptr<::odata::edm::edm_model> m_model;
 	::odata::utility::uri m_service_root;
+    std::unordered_map<::odata::utility::string_t, std::shared_ptr<::odata::core::odata_entity_link_template>> m_link_templates;
+    ::odata::utility::string_t m_link_buffer;
 };
 
 }}
\ No newline at end of file
@@ -0,0 +1,118 @@
+﻿//---------------------------------------------------------------------
+// <copyright file="odata_multipart_reader.h" company="Microsoft">
+//      Copyright (C) Microsoft Corporation. All rights reserved. See License.txt in the project root for license information.
+// </copyright>
+//---------------------------------------------------------------------
+
+#pragma once
+
+#include "odata/common/utility.h"
+
+namespace odata { namespace core
+{
+
+/// <summary>
+/// Header fields of a multipart body part in wire order, names and values as raw octets.
+/// </summary>
+typedef std::vector<std::pair<std::string, std::string>> odata_multipart_headers;
+
+/// <summary>
+/// Receives the events of an odata_multipart_reader. Part bodies are delivered as spans into the
+/// buffers handed to feed(), so a part is seen as a sequence of chunks that must be consumed or
+/// copied before the call to feed() returns.
+/// </summary>
+class odata_multipart_handler
+{
+public:
+	virtual ~odata_multipart_handler() {}
+
+	/// <summary>A body part starts; depth is 0 for top level parts and 1 for parts inside a changeset.</summary>
+	virtual void on_part_begin(const odata_multipart_headers& headers, int depth) {}
+	virtual void on_part_data(const char* data, size_t size) {}
+	virtual void on_part_end() {}
+
+	/// <summary>A body part of type multipart/mixed starts, its parts follow until on_changeset_end.</summary>
+	virtual void on_changeset_begin(const odata_multipart_headers& headers, const std::string& boundary) {}
+	virtual void on_changeset_end() {}
+
+	/// <summary>The close delimiter of the outermost multipart entity was read.</summary>
+	virtual void on_end() {}
+};
+
+/// <summary>
+/// Incremental multipart/mixed reader as used by $batch requests and responses. Input is pushed in
+/// arbitrarily split chunks; delimiters are located with a Boyer-Moore-Horspool scan, and a delimiter
+/// split across two chunks is resolved without buffering body octets. Nested multipart/mixed parts
+/// (changesets) are reported through the changeset events of the handler.
+/// Both CRLF and bare LF line breaks are accepted.
+/// </summary>
+class odata_multipart_reader
+{
+public:
+	ODATACPP_API odata_multipart_reader(const std::string& boundary, odata_multipart_handler& handler);
+
+	/// <summary>Parses the next chunk of the multipart entity; throws std::runtime_error on malformed input.</summary>
+	ODATACPP_API void feed(const char* data, size_t size);
+
+	/// <summary>Signals the end of input; throws std::runtime_error if the close delimiter was not seen.</summary>
+	ODATACPP_API void finish();
+
+	bool is_done() const
+	{
+		return m_state == state::done;
+	}
+
+	/// <summary>Limits the size of the header section of a single part, 64 KB by default.</summary>
+	void set_max_header_size(size_t max_header_size)
+	{
+		m_max_header_size = max_header_size;
+	}
+
+	/// <summary>Returns the boundary parameter of a multipart/mixed content type, or an empty string.</summary>
+	ODATACPP_API static std::string get_boundary(const std::string& content_type);
+
+	/// <summary>Case insensitive lookup of a header field, returns nullptr if absent.</summary>
+	ODATACPP_API static const std::string* find_header(const odata_multipart_headers& headers, const std::string& name);
+
+private:
+	enum class state
+	{
+		skip,
+		delimiter_tail,
+		delimiter_dash,
+		delimiter_line,
+		headers,
+		body,
+		done
+	};
+
+	struct level
+	{
+		std::string delimiter;
+		size_t skip_table[256];
+	};
+
+	void push_level(const std::string& boundary);
+	size_t find_delimiter(const level& current, const char* data, size_t size) const;
+	void emit(const char* data, size_t size);
+	void close_level();
+	size_t scan(const char* data, size_t size, bool is_body, bool& found);
+	size_t read_headers(const char* data, size_t size);
+	void parse_header_line(std::string::size_type begin, std::string::size_type end);
+	void end_headers();
+
+	odata_multipart_handler& m_handler;
+	std::vector<level> m_levels;
+	state m_state;
+	// count of delimiter octets matched at the end of the previous chunk
+	size_t m_matched;
+	// the leading line break of the delimiter is implied at the start of the entity and after the header section
+	bool m_implied_line_break;
+	bool m_held_cr;
+	std::string m_header_buffer;
+	std::string::size_type m_header_line_begin;
+	odata_multipart_headers m_headers;
+	size_t m_max_header_size;
+};
+
+}}
@@ -20,7 +20,7 @@ class odata_enum_value;
 class odata_structured_value : public odata_value
 {
 public:
-	odata_structured_value(std::shared_ptr<::odata::edm::edm_named_type>type) : odata_value(type)
+	odata_structured_value(std::shared_ptr<::odata::edm::edm_named_type>type) : odata_value(std::move(type))
 	{
 	}
 
@@ -22,17 +22,17 @@ public:
     odata_value() : m_property_type(std::make_shared<::odata::edm::edm_named_type>()), m_is_null_value(), m_is_top_level(){}
 
     odata_value(std::shared_ptr<::odata::edm::edm_named_type>type, bool is_null_value = false) 
-		: m_property_type(type), m_is_null_value(is_null_value), m_is_top_level()
+		: m_property_type(std::move(type)), m_is_null_value(is_null_value), m_is_top_level()
 	{
 	}
 
     virtual ~odata_value(){};
 
-    std::shared_ptr<::odata::edm::edm_named_type> get_value_type() const { return m_property_type; }
+    const std::shared_ptr<::odata::edm::edm_named_type>& get_value_type() const { return m_property_type; }
 
 	void set_value_type(std::shared_ptr<::odata::edm::edm_named_type> property_type)
 	{
-		m_property_type = property_type;
+		m_property_type = std::move(property_type);
 	}
 
     void set_is_top_level(bool is_top_level)
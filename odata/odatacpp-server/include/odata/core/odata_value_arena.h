@@ -0,0 +1,165 @@
+﻿//---------------------------------------------------------------------
+// <copyright file="odata_value_arena.h" company="Microsoft">
+//      Copyright (C) Microsoft Corporation. All rights reserved. See License.txt in the project root for license information.
+// </copyright>
+//---------------------------------------------------------------------
+
+#pragma once
+
+#include "odata/common/utility.h"
+#include "odata/edm/odata_edm.h"
+
+namespace odata { namespace core
+{
+
+/// <summary>
+/// Request scoped bump allocator for odata value graphs. Values made by the arena keep their shared_ptr interface,
+/// but the value and its control block are carved out of large blocks, and releasing a value does not free memory:
+/// the blocks are released together once the arena and the last value made by it are gone.
+/// An arena is not thread safe; it is meant to be filled by the one thread reading or building a response.
+/// </summary>
+class odata_value_arena : public std::enable_shared_from_this<odata_value_arena>
+{
+public:
+	/// <param name="block_size">Size of the blocks values are carved from; larger requests get a block of their own.</param>
+	static std::shared_ptr<odata_value_arena> create(size_t block_size = 64 * 1024)
+	{
+		return std::shared_ptr<odata_value_arena>(new odata_value_arena(block_size));
+	}
+
+	ODATACPP_API ~odata_value_arena();
+
+	void* allocate(size_t size, size_t alignment)
+	{
+		size_t offset = (m_offset + alignment - 1) & ~(alignment - 1);
+		if (m_current == nullptr || offset + size > m_current_size)
+		{
+			return allocate_slow(size, alignment);
+		}
+
+		m_offset = offset + size;
+		m_allocated_bytes += size;
+		return m_current + offset;
+	}
+
+	/// <summary>Makes a value of type T inside the arena, e.g. arena->make<odata_entity_value>(type).</summary>
+	template<typename T, typename A1>
+	std::shared_ptr<T> make(A1&& a1);
+
+	template<typename T, typename A1, typename A2>
+	std::shared_ptr<T> make(A1&& a1, A2&& a2);
+
+	/// <summary>
+	/// Returns a pointer to an edm type that does not share its ownership. Copies of it never touch the reference count
+	/// of the type, which is shared by all threads serving the model; the model must outlive the values holding it.
+	/// </summary>
+	template<typename T>
+	static std::shared_ptr<T> borrow_type(const std::shared_ptr<T>& type)
+	{
+		return std::shared_ptr<T>(std::shared_ptr<T>(), type.get());
+	}
+
+	size_t get_allocated_bytes() const
+	{
+		return m_allocated_bytes;
+	}
+
+	size_t get_block_count() const
+	{
+		return m_blocks.size();
+	}
+
+private:
+	odata_value_arena(size_t block_size)
+		: m_block_size(block_size), m_current(nullptr), m_current_size(0), m_offset(0), m_allocated_bytes(0)
+	{
+	}
+
+	odata_value_arena(const odata_value_arena&);
+	odata_value_arena& operator=(const odata_value_arena&);
+
+	ODATACPP_API void* allocate_slow(size_t size, size_t alignment);
+
+	std::vector<char*> m_blocks;
+	size_t m_block_size;
+	char* m_current;
+	size_t m_current_size;
+	size_t m_offset;
+	size_t m_allocated_bytes;
+};
+
+/// <summary>
+/// Allocator handing out memory of an odata_value_arena, used with std::allocate_shared. Each control block keeps
+/// the arena alive, so values may safely outlive the request that made them.
+/// </summary>
+template<typename T>
+class odata_arena_allocator
+{
+public:
+	typedef T value_type;
+	typedef T* pointer;
+	typedef const T* const_pointer;
+	typedef T& reference;
+	typedef const T& const_reference;
+	typedef size_t size_type;
+	typedef ptrdiff_t difference_type;
+
+	template<typename U>
+	struct rebind
+	{
+		typedef odata_arena_allocator<U> other;
+	};
+
+	odata_arena_allocator(std::shared_ptr<odata_value_arena> arena) : m_arena(std::move(arena))
+	{
+	}
+
+	template<typename U>
+	odata_arena_allocator(const odata_arena_allocator<U>& other) : m_arena(other.get_arena())
+	{
+	}
+
+	T* allocate(size_t count)
+	{
+		return static_cast<T*>(m_arena->allocate(count * sizeof(T), std::alignment_of<T>::value));
+	}
+
+	void deallocate(T*, size_t)
+	{
+		// released in bulk with the arena
+	}
+
+	const std::shared_ptr<odata_value_arena>& get_arena() const
+	{
+		return m_arena;
+	}
+
+	template<typename U>
+	bool operator==(const odata_arena_allocator<U>& other) const
+	{
+		return m_arena == other.get_arena();
+	}
+
+	template<typename U>
+	bool operator!=(const odata_arena_allocator<U>& other) const
+	{
+		return m_arena != other.get_arena();
+	}
+
+private:
+	std::shared_ptr<odata_value_arena> m_arena;
+};
+
+template<typename T, typename A1>
+std::shared_ptr<T> odata_value_arena::make(A1&& a1)
+{
+	return std::allocate_shared<T>(odata_arena_allocator<T>(shared_from_this()), std::forward<A1>(a1));
+}
+
+template<typename T, typename A1, typename A2>
+std::shared_ptr<T> odata_value_arena::make(A1&& a1, A2&& a2)
+{
+	return std::allocate_shared<T>(odata_arena_allocator<T>(shared_from_this()), std::forward<A1>(a1), std::forward<A2>(a2));
+}
+
+}}
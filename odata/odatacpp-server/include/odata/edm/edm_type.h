@@ -271,7 +271,7 @@ public:
         return m_is_nullable;
     }
 
-	std::shared_ptr<edm_named_type> get_property_type()
+	const std::shared_ptr<edm_named_type>& get_property_type() const
 	{
 		return m_type;
 	}
@@ -0,0 +1,101 @@
+﻿//---------------------------------------------------------------------
+// <copyright file="odata_entity_link_template.cpp" company="Microsoft">
+//      Copyright (C) Microsoft Corporation. All rights reserved. See License.txt in the project root for license information.
+// </copyright>
+//---------------------------------------------------------------------
+
+#include "odata/core/odata_entity_link_template.h"
+#include "odata/core/odata_entity_value.h"
+
+using namespace ::odata::edm;
+using namespace ::odata::utility;
+
+namespace odata { namespace core
+{
+
+odata_entity_link_template::odata_entity_link_template(const ::odata::utility::string_t& navigation_source, const std::shared_ptr<edm_entity_type>& entity_type, 
+	bool append_key, const ::odata::utility::string_t& expected_type_name)
+	: m_navigation_source(navigation_source), m_type_name(expected_type_name), m_append_key(append_key), m_use_type_annotation(!expected_type_name.empty())
+{
+	if (entity_type)
+	{
+		m_type_full_name = entity_type->get_full_name();
+		m_key_names = entity_type->get_key_with_parents();
+	}
+}
+
+void odata_entity_link_template::append_key_string(odata_entity_value& entity_value, ::odata::utility::string_t& buffer) const
+{
+	buffer += U("(");
+
+	for (size_t i = 0; i < m_key_names.size(); i++)
+	{
+		std::shared_ptr<odata_value> property_value;
+		if (!entity_value.get_property_value(m_key_names[i], property_value) || !property_value)
+		{
+			continue;
+		}
+
+		auto property_type = property_value->get_value_type();
+		if (!property_type || property_type->get_type_kind() != edm_type_kind_t::Primitive)
+		{
+			throw std::runtime_error("entity key type error!");
+		}
+
+		if (i != 0)
+		{
+			buffer += U(",");
+		}
+
+		auto primitive_property_value = std::static_pointer_cast<odata_primitive_value>(property_value);
+		if (m_key_names.size() != 1)
+		{
+			buffer += m_key_names[i];
+			buffer += U("=");
+		}
+		buffer += primitive_property_value->to_string();
+	}
+
+	buffer += U(")");
+}
+
+void odata_entity_link_template::append_id(odata_entity_value& entity_value, ::odata::utility::string_t& buffer) const
+{
+	buffer += m_navigation_source;
+	if (m_append_key)
+	{
+		append_key_string(entity_value, buffer);
+	}
+}
+
+void odata_entity_link_template::append_edit_link(odata_entity_value& entity_value, ::odata::utility::string_t& buffer) const
+{
+	append_id(entity_value, buffer);
+
+	// derived entities are addressed through a type cast segment
+	auto value_type = entity_value.get_value_type();
+	if (!value_type)
+	{
+		return;
+	}
+
+	if (!m_use_type_annotation)
+	{
+		if (!m_type_full_name.empty() && value_type->get_full_name() != m_type_full_name)
+		{
+			buffer += U("/");
+			buffer += value_type->get_full_name();
+		}
+		return;
+	}
+
+	// payloads read with minimal metadata carry the derived type in their @odata.type annotation
+	::odata::utility::string_t derived_type;
+	if (value_type->get_name() != m_type_name && entity_value.try_get(PAYLOAD_ANNOTATION_TYPE, derived_type) && !derived_type.empty())
+	{
+		buffer += U("/");
+		buffer.append(derived_type, derived_type[0] == U('#') ? 1 : 0, ::odata::utility::string_t::npos);
+	}
+}
+
+}}
@@ -48,58 +48,8 @@ enum RET_NAVI_ENTITY_TYPE
 	return ret;
 }
 
-void odata_json_reader_minimal::set_edit_link_for_entity_collection_value(const std::shared_ptr<odata_collection_value>& entity_collection_value, const ::odata::utility::string_t& expect_type_name, 
-									const ::odata::utility::string_t& navigation_source)
-{
-	if (!entity_collection_value)
-	{
-		return ;
-	}
-
-	auto collection_type = std::dynamic_pointer_cast<edm_collection_type>(entity_collection_value->get_value_type());
-	if (!collection_type || collection_type->get_element_type()->get_type_kind() != edm_type_kind_t::Entity)
-	{
-		return;
-	}
-
-	for (auto iter = entity_collection_value->get_collection_values().cbegin(); iter != entity_collection_value->get_collection_values().cend(); iter++)
-	{
-		auto entity_value = std::dynamic_pointer_cast<odata_entity_value>(*iter);
-		if (!entity_value || !entity_value->get_edit_link().is_empty())
-		{
-			continue;
-		}
-
-		auto key_string = entity_value->get_entity_key_string();
-		entity_value->set_edit_link(navigation_source + key_string);
-
-		// check to see if it is an derived type
-		if (expect_type_name != entity_value->get_value_type()->get_name())
-		{
-			::odata::utility::string_t derived_edit_link = navigation_source + key_string;
-			derived_edit_link += U("/");
-			if (entity_value->has_property(PAYLOAD_ANNOTATION_TYPE))
-			{
-				::odata::utility::string_t derived_type;
-				entity_value->try_get(PAYLOAD_ANNOTATION_TYPE, derived_type);
-				if (!derived_type.empty() && derived_type[0] == U('#'))
-					derived_type = derived_type.substr(1, derived_type.length() - 1);
-				derived_edit_link += derived_type;
-				entity_value->set_edit_link(derived_edit_link);
-			}
-		}
-	}
-}
-
-
-void odata_json_reader_minimal::set_edit_link_for_entity_value(const std::shared_ptr<odata_entity_value>& entity_value, const ::odata::utility::string_t& expect_type_name, 
-									const ::odata::utility::string_t& navigation_source)
+bool odata_json_reader_minimal::is_navigation_source_keyed(const ::odata::utility::string_t& navigation_source)
 {
-	if (!entity_value || !entity_value->get_edit_link().is_empty())
-	{
-		return ;
-	}
-
 	auto path_parser = std::make_shared<odata_uri_parser>(m_model);
 	::odata::utility::string_t relative_path = navigation_source;
 	if (relative_path.find(m_service_root_url) == 0)
@@ -141,26 +91,101 @@ void odata_json_reader_minimal::set_edit_link_for_entity_value(const std::shared
 		}
 	}
 
-	auto key_string = is_collection ? entity_value->get_entity_key_string() : U("");
-	entity_value->set_edit_link(navigation_source + key_string);
+	return is_collection;
+}
+
+std::shared_ptr<odata_entity_link_template> odata_json_reader_minimal::get_link_template(const std::shared_ptr<odata_entity_value>& entity_value, const ::odata::utility::string_t& expect_type_name, 
+									const ::odata::utility::string_t& navigation_source, bool is_collection_member)
+{
+	// the template key is built in a reusable buffer so that a cache hit does not allocate
+	m_link_template_key.assign(navigation_source);
+	m_link_template_key += U('|');
+	m_link_template_key += expect_type_name;
+	m_link_template_key += is_collection_member ? U('*') : U('1');
+
+	auto iter = m_link_templates.find(m_link_template_key);
+	if (iter != m_link_templates.end())
+	{
+		return iter->second;
+	}
+
+	// key properties are inherited, so the first entity of the navigation source resolves them for all its entities
+	auto entity_type = std::dynamic_pointer_cast<edm_entity_type>(entity_value->get_value_type());
+	bool append_key = is_collection_member || is_navigation_source_keyed(navigation_source);
+	auto link_template = std::make_shared<odata_entity_link_template>(navigation_source, entity_type, append_key, expect_type_name);
+	m_link_templates[m_link_template_key] = link_template;
+
+	return link_template;
+}
+
+std::shared_ptr<odata_primitive_value> odata_json_reader_minimal::make_annotation_value(const ::odata::utility::string_t& annotation, const ::odata::utility::string_t& value)
+{
+	// annotation types are shared by all values read, they are owned by the reader rather than the model
+	auto& annotation_type = m_annotation_types[annotation];
+	if (!annotation_type)
+	{
+		annotation_type = std::make_shared<edm_payload_annotation_type>(annotation);
+	}
+
+	return make_value<odata_primitive_value>(annotation_type, value);
+}
+
+void odata_json_reader_minimal::apply_link_template(const std::shared_ptr<odata_entity_value>& entity_value, const std::shared_ptr<odata_entity_link_template>& link_template)
+{
+	if (m_lazy_edit_links)
+	{
+		entity_value->set_link_template(link_template);
+		return;
+	}
+
+	m_link_buffer.clear();
+	link_template->append_edit_link(*entity_value, m_link_buffer);
+	entity_value->set_edit_link(m_link_buffer);
+}
+
+void odata_json_reader_minimal::set_edit_link_for_entity_collection_value(const std::shared_ptr<odata_collection_value>& entity_collection_value, const ::odata::utility::string_t& expect_type_name, 
+									const ::odata::utility::string_t& navigation_source)
+{
+	if (!entity_collection_value)
+	{
+		return ;
+	}
+
+	auto collection_type = std::dynamic_pointer_cast<edm_collection_type>(entity_collection_value->get_value_type());
+	if (!collection_type || collection_type->get_element_type()->get_type_kind() != edm_type_kind_t::Entity)
+	{
+		return;
+	}
 
-	// check to see if it is an derived type
-	if (expect_type_name != entity_value->get_value_type()->get_name())
+	std::shared_ptr<odata_entity_link_template> link_template;
+	for (auto iter = entity_collection_value->get_collection_values().cbegin(); iter != entity_collection_value->get_collection_values().cend(); iter++)
 	{
-		::odata::utility::string_t derived_edit_link = navigation_source + key_string;
-		derived_edit_link += U("/");
-		if (entity_value->has_property(PAYLOAD_ANNOTATION_TYPE))
+		auto entity_value = std::dynamic_pointer_cast<odata_entity_value>(*iter);
+		if (!entity_value || entity_value->has_edit_link())
+		{
+			continue;
+		}
+
+		if (!link_template)
 		{
-			::odata::utility::string_t derived_type;
-			entity_value->try_get(PAYLOAD_ANNOTATION_TYPE, derived_type);
-			if (!derived_type.empty() && derived_type[0] == U('#'))
-				derived_type = derived_type.substr(1, derived_type.length() - 1);
-			derived_edit_link += derived_type;
-			entity_value->set_edit_link(derived_edit_link);
+			link_template = get_link_template(entity_value, expect_type_name, navigation_source, true);
 		}
+		apply_link_template(entity_value, link_template);
 	}
 }
 
+
+void odata_json_reader_minimal::set_edit_link_for_entity_value(const std::shared_ptr<odata_entity_value>& entity_value, const ::odata::utility::string_t& expect_type_name, 
+									const ::odata::utility::string_t& navigation_source)
+{
+	if (!entity_value || entity_value->has_edit_link())
+	{
+		return ;
+	}
+
+	apply_link_template(entity_value, get_link_template(entity_value, expect_type_name, navigation_source, false));
+}
+
 std::shared_ptr<edm_named_type> odata_json_reader_minimal::prepare_for_reading(const odata::utility::json::value& content, std::shared_ptr<edm_named_type> expected_type = nullptr)
 {
 	::odata::utility::string_t context_url;
@@ -478,20 +503,20 @@ std::shared_ptr<odata_entity_value> odata_json_reader_minimal::handle_extract_en
 		return nullptr;
 	}
 
-	auto ret_value = std::make_shared<odata_entity_value>(entity_type);
+	auto ret_value = make_value<odata_entity_value>(model_type(entity_type));
 
 	// find odata.type and check odata.type to see if it is a derived type
 	if (value.has_field(PAYLOAD_ANNOTATION_TYPE))
 	{
 		auto annotation_type = 	value.at(PAYLOAD_ANNOTATION_TYPE);
 		auto annotation_value = annotation_type.as_string();
-		ret_value->set_value(PAYLOAD_ANNOTATION_TYPE, std::make_shared<odata_primitive_value>(std::make_shared<edm_payload_annotation_type>(PAYLOAD_ANNOTATION_TYPE), annotation_value));
+		ret_value->set_value(PAYLOAD_ANNOTATION_TYPE, make_annotation_value(PAYLOAD_ANNOTATION_TYPE, annotation_value));
 		annotation_value = annotation_value.substr(1, annotation_value.length() - 1);
 		auto ret_entity_type = m_model->find_entity_type(annotation_value);
 		if (ret_entity_type)
 		{
 			entity_type = ret_entity_type;
-			ret_value->set_value_type(entity_type);
+			ret_value->set_value_type(model_type(entity_type));
 		}
 	}
 
@@ -629,11 +654,11 @@ std::shared_ptr<odata_entity_value> odata_json_reader_minimal::handle_extract_en
 
 						if (primitive_prop->get_property_type()->get_type_kind() == Enum)
 						{
-							ret_value->set_value(name, std::make_shared<odata_enum_value>(primitive_prop->get_property_type(), strip_string(value.serialize())));
+							ret_value->set_value(name, make_value<odata_enum_value>(model_type(primitive_prop->get_property_type()), strip_string(value.serialize())));
 						}
 						else
 						{
-							ret_value->set_value(name, std::make_shared<odata_primitive_value>(primitive_prop->get_property_type(), strip_string(value.serialize())));
+							ret_value->set_value(name, make_value<odata_primitive_value>(model_type(primitive_prop->get_property_type()), strip_string(value.serialize())));
 						}
 					}
 					break;
@@ -652,7 +677,7 @@ std::shared_ptr<odata_entity_value> odata_json_reader_minimal::handle_extract_en
 					continue;
 				}
 
-				ret_value->set_value(name, std::make_shared<odata_primitive_value>(navigation_prop->get_property_type(), strip_string(value.serialize())));
+				ret_value->set_value(name, make_value<odata_primitive_value>(model_type(navigation_prop->get_property_type()), strip_string(value.serialize())));
             }
 			else
 			{
@@ -663,11 +688,11 @@ std::shared_ptr<odata_entity_value> odata_json_reader_minimal::handle_extract_en
 
 					if (annotation == PAYLOAD_ANNOTATION_READLINK)
 					{
-						ret_value->set_value(PAYLOAD_ANNOTATION_READLINK, std::make_shared<odata_primitive_value>(std::make_shared<edm_payload_annotation_type>(PAYLOAD_ANNOTATION_READLINK), annotation_value));
+						ret_value->set_value(PAYLOAD_ANNOTATION_READLINK, make_annotation_value(PAYLOAD_ANNOTATION_READLINK, annotation_value));
 					}
 					else if (annotation == PAYLOAD_ANNOTATION_ID)
 					{
-						ret_value->set_value(PAYLOAD_ANNOTATION_ID, std::make_shared<odata_primitive_value>(std::make_shared<edm_payload_annotation_type>(PAYLOAD_ANNOTATION_ID), annotation_value));
+						ret_value->set_value(PAYLOAD_ANNOTATION_ID, make_annotation_value(PAYLOAD_ANNOTATION_ID, annotation_value));
 					}
 				}
 			}
@@ -684,20 +709,20 @@ std::shared_ptr<odata_complex_value> odata_json_reader_minimal::handle_extract_c
 		return nullptr;
 	}
 
-	auto ret_value = std::make_shared<odata_complex_value>(edm_complex_type);
+	auto ret_value = make_value<odata_complex_value>(model_type(edm_complex_type));
 
 	// find odata.type and check odata.type to see if it is a derived type
 	if (value.has_field(PAYLOAD_ANNOTATION_TYPE))
 	{
 		auto annotation_type = 	value.at(PAYLOAD_ANNOTATION_TYPE);
 		auto annotation_value = annotation_type.as_string();
-		ret_value->set_value(PAYLOAD_ANNOTATION_TYPE, std::make_shared<odata_primitive_value>(std::make_shared<edm_payload_annotation_type>(PAYLOAD_ANNOTATION_TYPE), annotation_value));
+		ret_value->set_value(PAYLOAD_ANNOTATION_TYPE, make_annotation_value(PAYLOAD_ANNOTATION_TYPE, annotation_value));
 		annotation_value = annotation_value.substr(1, annotation_value.length() - 1);
 		auto ret_complex_type = m_model->find_complex_type(annotation_value);
 		if (ret_complex_type)
 		{
 			edm_complex_type = ret_complex_type;
-			ret_value->set_value_type(edm_complex_type);
+			ret_value->set_value_type(model_type(edm_complex_type));
 		}
 	}
 
@@ -763,11 +788,11 @@ std::shared_ptr<odata_complex_value> odata_json_reader_minimal::handle_extract_c
 
 						if (primitive_prop->get_property_type()->get_type_kind() == Enum)
 						{
-							ret_value->set_value(name, std::make_shared<odata_enum_value>(primitive_prop->get_property_type(), strip_string(value.serialize())));
+							ret_value->set_value(name, make_value<odata_enum_value>(model_type(primitive_prop->get_property_type()), strip_string(value.serialize())));
 						}
 						else
 						{
-							ret_value->set_value(name, std::make_shared<odata_primitive_value>(primitive_prop->get_property_type(), strip_string(value.serialize())));
+							ret_value->set_value(name, make_value<odata_primitive_value>(model_type(primitive_prop->get_property_type()), strip_string(value.serialize())));
 						}
                 }
                 break;
@@ -782,11 +807,11 @@ std::shared_ptr<odata_complex_value> odata_json_reader_minimal::handle_extract_c
 
 				if (annotation == PAYLOAD_ANNOTATION_READLINK)
 				{
-					ret_value->set_value(PAYLOAD_ANNOTATION_READLINK, std::make_shared<odata_primitive_value>(std::make_shared<edm_payload_annotation_type>(PAYLOAD_ANNOTATION_READLINK), annotation_value));
+					ret_value->set_value(PAYLOAD_ANNOTATION_READLINK, make_annotation_value(PAYLOAD_ANNOTATION_READLINK, annotation_value));
 				}
 				else if (annotation == PAYLOAD_ANNOTATION_ID)
 				{
-					ret_value->set_value(PAYLOAD_ANNOTATION_ID, std::make_shared<odata_primitive_value>(std::make_shared<edm_payload_annotation_type>(PAYLOAD_ANNOTATION_ID), annotation_value));
+					ret_value->set_value(PAYLOAD_ANNOTATION_ID, make_annotation_value(PAYLOAD_ANNOTATION_ID, annotation_value));
 				}
 			}
 			
@@ -816,7 +841,7 @@ std::shared_ptr<odata_collection_value> odata_json_reader_minimal::handle_extrac
 		return nullptr;
 	}
 	
-	auto p_collection_property = std::make_shared<odata_collection_value>(type);
+	auto p_collection_property = make_value<odata_collection_value>(type);
 
 	for (auto iter = value.as_array().begin(); iter != value.as_array().end(); iter++)
 	{
@@ -824,7 +849,7 @@ std::shared_ptr<odata_collection_value> odata_json_reader_minimal::handle_extrac
 
 		if (element_type->get_type_kind() == edm_type_kind_t::Primitive)
 		{
-			p_collection_property->add_collection_value(std::make_shared<odata_primitive_value>(element_type, strip_string(element_value.serialize())));
+			p_collection_property->add_collection_value(make_value<odata_primitive_value>(model_type(element_type), strip_string(element_value.serialize())));
 		}
 		else if (element_type->get_type_kind() == edm_type_kind_t::Complex)
 		{
@@ -842,7 +867,7 @@ std::shared_ptr<odata_collection_value> odata_json_reader_minimal::handle_extrac
 		}
 		else if (element_type->get_type_kind() == edm_type_kind_t::Enum)
 		{
-			p_collection_property->add_collection_value(std::make_shared<odata_enum_value>(element_type, strip_string(element_value.serialize())));
+			p_collection_property->add_collection_value(make_value<odata_enum_value>(model_type(element_type), strip_string(element_value.serialize())));
 		}
 		else
 		{
@@ -857,15 +882,15 @@ void odata_json_reader_minimal::handle_extract_entity_annotation(const ::odata::
 {
 	if (annotation == PAYLOAD_ANNOTATION_READLINK)
 	{
-		entity_value->set_value(PAYLOAD_ANNOTATION_READLINK, std::make_shared<odata_primitive_value>(std::make_shared<edm_payload_annotation_type>(PAYLOAD_ANNOTATION_READLINK), value));
+		entity_value->set_value(PAYLOAD_ANNOTATION_READLINK, make_annotation_value(PAYLOAD_ANNOTATION_READLINK, value));
 	}
 	else if (annotation == PAYLOAD_ANNOTATION_ID)
 	{
-		entity_value->set_value(PAYLOAD_ANNOTATION_ID, std::make_shared<odata_primitive_value>(std::make_shared<edm_payload_annotation_type>(PAYLOAD_ANNOTATION_ID), value));
+		entity_value->set_value(PAYLOAD_ANNOTATION_ID, make_annotation_value(PAYLOAD_ANNOTATION_ID, value));
 	}
 	else if (annotation == PAYLOAD_ANNOTATION_TYPE)
 	{
-		entity_value->set_value(PAYLOAD_ANNOTATION_TYPE, std::make_shared<odata_primitive_value>(std::make_shared<edm_payload_annotation_type>(PAYLOAD_ANNOTATION_TYPE), value));
+		entity_value->set_value(PAYLOAD_ANNOTATION_TYPE, make_annotation_value(PAYLOAD_ANNOTATION_TYPE, value));
 	}
 }
 
@@ -6,20 +6,133 @@
 
 #include "odata/core/odata_message_reader.h"
 #include "odata/core/odata_json_reader_minimal.h"
+#include "odata/core/odata_multipart_reader.h"
 
 using namespace ::odata::core;
 
 namespace odata { namespace core
 {
+	namespace
+	{
+		// span of a part body inside the message; parts split by the reader are copied into the spill buffer
+		struct batch_message
+		{
+			batch_message(int changeset_index) : m_data(nullptr), m_size(0), m_changeset_index(changeset_index)
+			{
+			}
+
+			const char* data() const
+			{
+				return m_spill.empty() ? m_data : m_spill.data();
+			}
+
+			size_t size() const
+			{
+				return m_spill.empty() ? m_size : m_spill.size();
+			}
+
+			const char* m_data;
+			size_t m_size;
+			std::string m_spill;
+			int m_changeset_index;
+		};
+
+		// collects the application/http messages of all parts as spans of the message body, with their changeset
+		class batch_message_collector : public odata_multipart_handler
+		{
+		public:
+			batch_message_collector(odata_batch_value& batch_value) : m_batch_value(batch_value), m_changeset_index(-1)
+			{
+			}
+
+			void on_part_begin(const odata_multipart_headers& headers, int depth)
+			{
+				m_messages.push_back(batch_message(m_changeset_index));
+			}
+
+			void on_part_data(const char* data, size_t size)
+			{
+				batch_message& message = m_messages.back();
+				if (!message.m_spill.empty())
+				{
+					message.m_spill.append(data, size);
+				}
+				else if (!message.m_data)
+				{
+					message.m_data = data;
+					message.m_size = size;
+				}
+				else if (message.m_data + message.m_size == data)
+				{
+					message.m_size += size;
+				}
+				else
+				{
+					// the reader only splits a body which starts like a delimiter
+					message.m_spill.assign(message.m_data, message.m_size);
+					message.m_spill.append(data, size);
+				}
+			}
+
+			void on_changeset_begin(const odata_multipart_headers& headers, const std::string& boundary)
+			{
+				m_changeset_index = m_batch_value.add_changeset(::odata::utility::conversions::to_string_t(boundary));
+			}
+
+			void on_changeset_end()
+			{
+				m_changeset_index = -1;
+			}
+
+			std::vector<batch_message> m_messages;
+
+		private:
+			odata_batch_value& m_batch_value;
+			int m_changeset_index;
+		};
+
+		// read only stream buffer over a part body, so that JSON is parsed without a copy
+		class span_streambuf : public std::streambuf
+		{
+		public:
+			span_streambuf(const char* data, size_t size)
+			{
+				char* begin = const_cast<char*>(data);
+				setg(begin, begin, begin + size);
+			}
+		};
+
+		size_t read_line(const char* message, size_t size, size_t& pos)
+		{
+			const char* end = (const char*)::memchr(message + pos, '\n', size - pos);
+			size_t line_end = end ? end - message : size;
+			pos = end ? line_end + 1 : size;
+			return line_end > 0 && message[line_end - 1] == '\r' ? line_end - 1 : line_end;
+		}
+
+		size_t find(const char* message, size_t begin, size_t end, char c)
+		{
+			const char* found = (const char*)::memchr(message + begin, c, end - begin);
+			return found ? found - message : end;
+		}
+
+		::odata::utility::string_t to_string_t(const char* message, size_t begin, size_t end)
+		{
+			return ::odata::utility::conversions::to_string_t(std::string(message + begin, end - begin));
+		}
+	}
+
 	std::shared_ptr<odata_value> odata_message_reader::read_odata_value()
 	{
 		auto json_reader = std::make_shared<odata_json_reader_minimal>(m_model, m_base_uri.to_string(), m_is_response_message);
+		json_reader->set_value_arena(m_value_arena);
 		return json_reader->deserilize(::odata::utility::json::value::parse(m_message_body));
 	}
 
 	std::shared_ptr<odata_entity_value> odata_message_reader::read_entity_value(std::shared_ptr<::odata::edm::edm_entity_type> edm_type)
 	{
 		auto json_reader = std::make_shared<odata_json_reader_minimal>(m_model, m_base_uri.to_string(), m_is_response_message);
+		json_reader->set_value_arena(m_value_arena);
 		return json_reader->deserilize_entity_value(::odata::utility::json::value::parse(m_message_body), edm_type);
 	}
 
@@ -31,6 +144,7 @@ namespace odata { namespace core
 	std::shared_ptr<odata_collection_value> odata_message_reader::read_entity_collection(std::shared_ptr<::odata::edm::edm_entity_set> entity_set)
 	{
 		auto json_reader = std::make_shared<odata_json_reader_minimal>(m_model, m_base_uri.to_string(), m_is_response_message);
+		json_reader->set_value_arena(m_value_arena);
 		return json_reader->deserilize_entity_collection(::odata::utility::json::value::parse(m_message_body), entity_set);
 	}
 
@@ -42,6 +156,7 @@ namespace odata { namespace core
 	std::shared_ptr<odata_value> odata_message_reader::read_property(std::shared_ptr<::odata::edm::edm_named_type> edm_type)
 	{
 		auto json_reader = std::make_shared<odata_json_reader_minimal>(m_model, m_base_uri.to_string(), m_is_response_message);
+		json_reader->set_value_arena(m_value_arena);
 		return json_reader->deserilize_property(::odata::utility::json::value::parse(m_message_body), edm_type);
 	}
 
@@ -49,4 +164,111 @@ namespace odata { namespace core
 	{
 		return read_property(nullptr);
 	}
+
+	std::shared_ptr<odata_batch_value> odata_message_reader::read_batch_value(const ::odata::utility::string_t& boundary)
+	{
+		auto batch_value = std::make_shared<odata_batch_value>();
+		batch_value->set_boundary(boundary);
+
+		// the parts refer to the body until they are parsed
+#ifdef _UTF16_STRINGS
+		std::string body = ::odata::utility::conversions::to_utf8string(m_message_body);
+#else
+		const std::string& body = m_message_body;
+#endif
+		batch_message_collector collector(*batch_value);
+		odata_multipart_reader multipart_reader(::odata::utility::conversions::to_utf8string(boundary), collector);
+		multipart_reader.feed(body.data(), body.size());
+		multipart_reader.finish();
+
+		auto json_reader = std::make_shared<odata_json_reader_minimal>(m_model, m_base_uri.to_string(), m_is_response_message);
+		json_reader->set_value_arena(m_value_arena);
+		for (auto message = collector.m_messages.cbegin(); message != collector.m_messages.cend(); ++message)
+		{
+			auto part_value = read_batch_part(message->data(), message->size(), json_reader);
+			part_value->set_changeset_index(message->m_changeset_index);
+			batch_value->add_part(part_value);
+		}
+
+		return batch_value;
+	}
+
+	std::shared_ptr<odata_batch_part_value> odata_message_reader::read_batch_part(const char* message, size_t size, const std::shared_ptr<odata_json_reader_minimal>& json_reader)
+	{
+		auto part_value = std::make_shared<odata_batch_part_value>();
+
+		// status line of a response, or the request line of a request
+		size_t pos = 0;
+		size_t end = read_line(message, size, pos);
+		if (end >= 5 && ::memcmp(message, "HTTP/", 5) == 0)
+		{
+			size_t code_begin = find(message, 0, end, ' ');
+			if (code_begin == end)
+			{
+				throw std::runtime_error("invalid batch response status line");
+			}
+
+			size_t code_end = find(message, code_begin + 1, end, ' ');
+			part_value->set_status_code((int16_t)::atoi(std::string(message + code_begin + 1, code_end - code_begin - 1).c_str()));
+			part_value->set_status_message(code_end < end ? to_string_t(message, code_end + 1, end) : ::odata::utility::string_t());
+		}
+		else
+		{
+			// method, url as written, and the HTTP version
+			size_t method_end = find(message, 0, end, ' ');
+			if (method_end == 0 || method_end == end)
+			{
+				throw std::runtime_error("invalid batch request line");
+			}
+
+			size_t url_end = find(message, method_end + 1, end, ' ');
+			if (url_end == method_end + 1)
+			{
+				throw std::runtime_error("invalid batch request line");
+			}
+
+			part_value->set_method(to_string_t(message, 0, method_end));
+			part_value->set_url(to_string_t(message, method_end + 1, url_end));
+		}
+
+		while (pos < size)
+		{
+			size_t begin = pos;
+			end = read_line(message, size, pos);
+			if (end == begin)
+			{
+				break;
+			}
+
+			size_t colon = find(message, begin, end, ':');
+			if (colon == end)
+			{
+				throw std::runtime_error("invalid batch part header");
+			}
+
+			size_t value_begin = colon + 1;
+			while (value_begin < end && (message[value_begin] == ' ' || message[value_begin] == '\t'))
+			{
+				value_begin++;
+			}
+			part_value->set_header(to_string_t(message, begin, colon), to_string_t(message, value_begin, end));
+		}
+
+		while (pos < size && (message[pos] == ' ' || message[pos] == '\t' || message[pos] == '\r' || message[pos] == '\n'))
+		{
+			pos++;
+		}
+		if (pos < size && (message[pos] == '{' || message[pos] == '['))
+		{
+			span_streambuf content_buffer(message + pos, size - pos);
+			std::istream content_stream(&content_buffer);
+			auto content = ::odata::utility::json::value::parse(content_stream);
+			if (content.is_object() && content.has_field(U("@odata.context")))
+			{
+				part_value->set_odata_value(json_reader->deserilize(content));
+			}
+		}
+
+		return part_value;
+	}
 }}
\ No newline at end of file
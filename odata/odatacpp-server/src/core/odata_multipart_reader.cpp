@@ -0,0 +1,452 @@
+﻿//---------------------------------------------------------------------
+// <copyright file="odata_multipart_reader.cpp" company="Microsoft">
+//      Copyright (C) Microsoft Corporation. All rights reserved. See License.txt in the project root for license information.
+// </copyright>
+//---------------------------------------------------------------------
+
+#include "odata/core/odata_multipart_reader.h"
+
+namespace odata { namespace core
+{
+
+namespace
+{
+	const size_t max_boundary_length = 70;
+
+	bool is_space(char c)
+	{
+		return c == ' ' || c == '\t' || c == '\r' || c == '\n';
+	}
+
+	bool equals_ignore_case(const char* left, const char* right, size_t size)
+	{
+		for (size_t i = 0; i < size; i++)
+		{
+			if (::tolower((unsigned char)left[i]) != ::tolower((unsigned char)right[i]))
+			{
+				return false;
+			}
+		}
+
+		return true;
+	}
+
+	std::string trim(const std::string& str, std::string::size_type begin, std::string::size_type end)
+	{
+		while (begin < end && is_space(str[begin]))
+		{
+			begin++;
+		}
+
+		while (end > begin && is_space(str[end - 1]))
+		{
+			end--;
+		}
+
+		return str.substr(begin, end - begin);
+	}
+}
+
+odata_multipart_reader::odata_multipart_reader(const std::string& boundary, odata_multipart_handler& handler)
+	: m_handler(handler), m_state(state::skip), m_matched(1), m_implied_line_break(true), m_held_cr(false),
+	m_header_line_begin(0), m_max_header_size(64 * 1024)
+{
+	push_level(boundary);
+}
+
+void odata_multipart_reader::push_level(const std::string& boundary)
+{
+	if (boundary.empty() || boundary.size() > max_boundary_length)
+	{
+		throw std::runtime_error("invalid multipart boundary");
+	}
+
+	m_levels.push_back(level());
+	level& current = m_levels.back();
+	current.delimiter = "\n--" + boundary;
+
+	// Horspool bad character shifts, taken from all but the last octet of the delimiter
+	const size_t length = current.delimiter.size();
+	for (size_t i = 0; i < 256; i++)
+	{
+		current.skip_table[i] = length;
+	}
+	for (size_t i = 0; i + 1 < length; i++)
+	{
+		current.skip_table[(unsigned char)current.delimiter[i]] = length - 1 - i;
+	}
+}
+
+size_t odata_multipart_reader::find_delimiter(const level& current, const char* data, size_t size) const
+{
+	const char* pattern = current.delimiter.data();
+	const size_t length = current.delimiter.size();
+	if (size < length)
+	{
+		return std::string::npos;
+	}
+
+	const char last = pattern[length - 1];
+	size_t i = 0;
+	while (i <= size - length)
+	{
+		const char c = data[i + length - 1];
+		if (c == last && ::memcmp(data + i, pattern, length - 1) == 0)
+		{
+			return i;
+		}
+
+		i += current.skip_table[(unsigned char)c];
+	}
+
+	return std::string::npos;
+}
+
+void odata_multipart_reader::emit(const char* data, size_t size)
+{
+	if (m_held_cr)
+	{
+		m_held_cr = false;
+		m_handler.on_part_data("\r", 1);
+	}
+
+	if (size > 0)
+	{
+		m_handler.on_part_data(data, size);
+	}
+}
+
+size_t odata_multipart_reader::scan(const char* data, size_t size, bool is_body, bool& found)
+{
+	const level& current = m_levels.back();
+	const std::string& delimiter = current.delimiter;
+	const size_t length = delimiter.size();
+	size_t pos = 0;
+	found = false;
+
+	// continue a delimiter which started at the end of the previous chunk
+	if (m_matched > 0)
+	{
+		while (pos < size && m_matched < length && data[pos] == delimiter[m_matched])
+		{
+			pos++;
+			m_matched++;
+		}
+
+		if (m_matched == length)
+		{
+			m_matched = 0;
+			m_held_cr = false;
+			m_implied_line_break = false;
+			found = true;
+			return pos;
+		}
+
+		if (pos == size)
+		{
+			return pos;
+		}
+
+		// not a delimiter after all, the held octets are part of the body and are taken from the delimiter itself
+		size_t offset = m_implied_line_break ? 1 : 0;
+		if (is_body && m_matched > offset)
+		{
+			emit(delimiter.data() + offset, m_matched - offset);
+		}
+
+		m_matched = 0;
+		m_held_cr = false;
+		m_implied_line_break = false;
+	}
+
+	size_t index = find_delimiter(current, data + pos, size - pos);
+	if (index != std::string::npos)
+	{
+		size_t end = pos + index;
+		if (is_body && end > pos)
+		{
+			// the CR of a CRLF line break belongs to the delimiter
+			emit(data + pos, data[end - 1] == '\r' ? end - pos - 1 : end - pos);
+		}
+
+		m_held_cr = false;
+		found = true;
+		return end + length;
+	}
+
+	// hold back a trailing prefix of the delimiter; the delimiter starts with the only LF in it,
+	// so the last LF of the chunk is the only candidate
+	size_t hold = size;
+	size_t window = std::min(size - pos, length - 1);
+	for (size_t i = size; i > size - window; i--)
+	{
+		if (data[i - 1] == '\n')
+		{
+			if (::memcmp(data + i - 1, delimiter.data(), size - i + 1) == 0)
+			{
+				hold = i - 1;
+			}
+			break;
+		}
+	}
+
+	if (hold > pos)
+	{
+		// a CR right before the held octets may still turn out to start the line break of a delimiter
+		bool held_cr = data[hold - 1] == '\r';
+		if (is_body)
+		{
+			emit(data + pos, held_cr ? hold - pos - 1 : hold - pos);
+		}
+		m_held_cr = held_cr;
+	}
+
+	m_matched = size - hold;
+	return size;
+}
+
+size_t odata_multipart_reader::read_headers(const char* data, size_t size)
+{
+	size_t pos = 0;
+	while (pos < size)
+	{
+		const char* line_end = (const char*)::memchr(data + pos, '\n', size - pos);
+		size_t count = line_end ? line_end - (data + pos) + 1 : size - pos;
+		if (m_header_buffer.size() + count > m_max_header_size)
+		{
+			throw std::runtime_error("multipart header section exceeds the size limit");
+		}
+
+		m_header_buffer.append(data + pos, count);
+		pos += count;
+		if (!line_end)
+		{
+			break;
+		}
+
+		std::string::size_type end = m_header_buffer.size() - 1;
+		if (end > m_header_line_begin && m_header_buffer[end - 1] == '\r')
+		{
+			end--;
+		}
+
+		if (end == m_header_line_begin)
+		{
+			end_headers();
+			break;
+		}
+
+		parse_header_line(m_header_line_begin, end);
+		m_header_line_begin = m_header_buffer.size();
+	}
+
+	return pos;
+}
+
+void odata_multipart_reader::parse_header_line(std::string::size_type begin, std::string::size_type end)
+{
+	if (m_header_buffer[begin] == ' ' || m_header_buffer[begin] == '\t')
+	{
+		if (m_headers.empty())
+		{
+			throw std::runtime_error("invalid multipart header line");
+		}
+
+		// folded header value
+		m_headers.back().second += ' ';
+		m_headers.back().second += trim(m_header_buffer, begin, end);
+		return;
+	}
+
+	std::string::size_type colon = m_header_buffer.find(':', begin);
+	if (colon == std::string::npos || colon >= end)
+	{
+		throw std::runtime_error("invalid multipart header line");
+	}
+
+	m_headers.push_back(std::make_pair(trim(m_header_buffer, begin, colon), trim(m_header_buffer, colon + 1, end)));
+}
+
+void odata_multipart_reader::end_headers()
+{
+	const std::string* content_type = find_header(m_headers, "Content-Type");
+	std::string boundary = content_type ? get_boundary(*content_type) : std::string();
+
+	if (!boundary.empty())
+	{
+		m_handler.on_changeset_begin(m_headers, boundary);
+		push_level(boundary);
+		m_state = state::skip;
+	}
+	else
+	{
+		m_handler.on_part_begin(m_headers, (int)m_levels.size() - 1);
+		m_state = state::body;
+	}
+
+	m_matched = 1;
+	m_implied_line_break = true;
+	m_held_cr = false;
+	m_headers.clear();
+	m_header_buffer.clear();
+	m_header_line_begin = 0;
+}
+
+void odata_multipart_reader::close_level()
+{
+	m_levels.pop_back();
+	if (m_levels.empty())
+	{
+		m_state = state::done;
+		m_handler.on_end();
+		return;
+	}
+
+	// the epilogue of the changeset is skipped up to the next delimiter of the enclosing entity
+	m_handler.on_changeset_end();
+	m_state = state::skip;
+	m_matched = 0;
+	m_implied_line_break = false;
+	m_held_cr = false;
+}
+
+void odata_multipart_reader::feed(const char* data, size_t size)
+{
+	size_t pos = 0;
+	while (pos < size && m_state != state::done)
+	{
+		switch (m_state)
+		{
+		case state::skip:
+		case state::body:
+		{
+			bool is_body = m_state == state::body;
+			bool found = false;
+			pos += scan(data + pos, size - pos, is_body, found);
+			if (found)
+			{
+				if (is_body)
+				{
+					m_handler.on_part_end();
+				}
+				m_state = state::delimiter_tail;
+			}
+			break;
+		}
+		case state::delimiter_tail:
+			if (data[pos] == '-')
+			{
+				pos++;
+				m_state = state::delimiter_dash;
+			}
+			else
+			{
+				m_state = state::delimiter_line;
+			}
+			break;
+		case state::delimiter_dash:
+			if (data[pos] == '-')
+			{
+				pos++;
+				close_level();
+			}
+			else
+			{
+				m_state = state::delimiter_line;
+			}
+			break;
+		case state::delimiter_line:
+		{
+			// transport padding up to the end of the delimiter line
+			const char* line_end = (const char*)::memchr(data + pos, '\n', size - pos);
+			if (line_end)
+			{
+				pos = line_end - data + 1;
+				m_state = state::headers;
+			}
+			else
+			{
+				pos = size;
+			}
+			break;
+		}
+		case state::headers:
+			pos += read_headers(data + pos, size - pos);
+			break;
+		default:
+			break;
+		}
+	}
+}
+
+void odata_multipart_reader::finish()
+{
+	if (m_state != state::done)
+	{
+		throw std::runtime_error("unexpected end of multipart body");
+	}
+}
+
+std::string odata_multipart_reader::get_boundary(const std::string& content_type)
+{
+	static const char multipart[] = "multipart/";
+	static const char boundary[] = "boundary=";
+	const size_t multipart_length = sizeof(multipart) - 1;
+	const size_t boundary_length = sizeof(boundary) - 1;
+
+	std::string::size_type pos = 0;
+	while (pos < content_type.size() && is_space(content_type[pos]))
+	{
+		pos++;
+	}
+
+	if (content_type.size() - pos < multipart_length || !equals_ignore_case(content_type.data() + pos, multipart, multipart_length))
+	{
+		return std::string();
+	}
+
+	for (pos = content_type.find(';', pos); pos != std::string::npos; pos = content_type.find(';', pos))
+	{
+		pos++;
+		while (pos < content_type.size() && is_space(content_type[pos]))
+		{
+			pos++;
+		}
+
+		if (content_type.size() - pos < boundary_length || !equals_ignore_case(content_type.data() + pos, boundary, boundary_length))
+		{
+			continue;
+		}
+
+		pos += boundary_length;
+		if (pos < content_type.size() && content_type[pos] == '"')
+		{
+			std::string::size_type end = content_type.find('"', pos + 1);
+			return content_type.substr(pos + 1, end == std::string::npos ? std::string::npos : end - pos - 1);
+		}
+
+		std::string::size_type end = pos;
+		while (end < content_type.size() && content_type[end] != ';' && !is_space(content_type[end]))
+		{
+			end++;
+		}
+		return content_type.substr(pos, end - pos);
+	}
+
+	return std::string();
+}
+
+const std::string* odata_multipart_reader::find_header(const odata_multipart_headers& headers, const std::string& name)
+{
+	for (auto header = headers.cbegin(); header != headers.cend(); ++header)
+	{
+		if (header->first.size() == name.size() && equals_ignore_case(header->first.data(), name.data(), name.size()))
+		{
+			return &header->second;
+		}
+	}
+
+	return nullptr;
+}
+
+}}
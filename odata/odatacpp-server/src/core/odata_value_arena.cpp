@@ -0,0 +1,45 @@
+﻿//---------------------------------------------------------------------
+// <copyright file="odata_value_arena.cpp" company="Microsoft">
+//      Copyright (C) Microsoft Corporation. All rights reserved. See License.txt in the project root for license information.
+// </copyright>
+//---------------------------------------------------------------------
+
+#include "odata/core/odata_value_arena.h"
+
+namespace odata { namespace core
+{
+
+odata_value_arena::~odata_value_arena()
+{
+	for (auto block = m_blocks.begin(); block != m_blocks.end(); ++block)
+	{
+		delete[] *block;
+	}
+}
+
+void* odata_value_arena::allocate_slow(size_t size, size_t alignment)
+{
+	// blocks from operator new[] are aligned for any fundamental type
+	if (m_blocks.size() == m_blocks.capacity())
+	{
+		m_blocks.reserve(m_blocks.size() * 2 + 8);
+	}
+
+	if (size + alignment > m_block_size / 4)
+	{
+		// a large request gets a block of its own, the current block keeps serving small ones
+		char* block = new char[size];
+		m_blocks.push_back(block);
+		m_allocated_bytes += size;
+		return block;
+	}
+
+	m_current = new char[m_block_size];
+	m_blocks.push_back(m_current);
+	m_current_size = m_block_size;
+	m_offset = size;
+	m_allocated_bytes += size;
+	return m_current;
+}
+
+}}
@@ -0,0 +1,111 @@
+﻿//---------------------------------------------------------------------
+// <copyright file="odata_multipart_reader_benchmark.cpp" company="Microsoft">
+//      Copyright (C) Microsoft Corporation. All rights reserved. See License.txt in the project root for license information.
+// </copyright>
+//---------------------------------------------------------------------
+
+#include "odata/core/odata_multipart_reader.h"
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <string>
+
+using namespace ::odata::core;
+
+// Usage: odata-multipart-benchmark [total MB] [part KB] [chunk KB] [rounds]
+// Parses a multipart/mixed entity of total MB, made of parts of part KB, fed in chunks of chunk KB,
+// and prints the best throughput of the rounds. The defaults are 64 MB of 1 MB parts in 64 KB chunks.
+
+namespace
+{
+	class byte_counter : public odata_multipart_handler
+	{
+	public:
+		byte_counter() : m_parts(0), m_bytes(0) {}
+
+		void on_part_begin(const odata_multipart_headers&, int)
+		{
+			m_parts++;
+		}
+
+		void on_part_data(const char*, size_t size)
+		{
+			m_bytes += size;
+		}
+
+		size_t m_parts;
+		size_t m_bytes;
+	};
+
+	size_t get_argument(int argc, char* argv[], int index, size_t default_value)
+	{
+		return index < argc ? (size_t)strtoul(argv[index], nullptr, 10) : default_value;
+	}
+}
+
+int main(int argc, char* argv[])
+{
+	const size_t total_size = get_argument(argc, argv, 1, 64) * 1024 * 1024;
+	const size_t part_size = get_argument(argc, argv, 2, 1024) * 1024;
+	const size_t chunk_size = get_argument(argc, argv, 3, 64) * 1024;
+	const size_t rounds = get_argument(argc, argv, 4, 5);
+	if (part_size == 0 || chunk_size == 0 || rounds == 0)
+	{
+		fprintf(stderr, "usage: %s [total MB] [part KB] [chunk KB] [rounds]\n", argv[0]);
+		return 1;
+	}
+
+	// bodies of binary-like octets, with line breaks and partial delimiters for the scan to skip
+	std::string body(part_size, 'x');
+	for (size_t i = 0; i < part_size; i++)
+	{
+		body[i] = (char)('A' + (i * 7) % 26);
+	}
+	for (size_t i = 0; i + 16 < part_size; i += 4096)
+	{
+		body.replace(i, 16, "\r\n--batch_benc\r\n");
+	}
+
+	const std::string boundary = "batch_bench";
+	std::string payload;
+	payload.reserve(total_size + part_size);
+	size_t part_count = 0;
+	while (payload.size() < total_size)
+	{
+		payload += "--" + boundary + "\r\nContent-Type: application/http\r\nContent-Transfer-Encoding: binary\r\n\r\n";
+		payload += body;
+		payload += "\r\n";
+		part_count++;
+	}
+	payload += "--" + boundary + "--\r\n";
+
+	double best_seconds = 0;
+	for (size_t round = 0; round < rounds; round++)
+	{
+		byte_counter counter;
+		odata_multipart_reader reader(boundary, counter);
+		const auto start = std::chrono::high_resolution_clock::now();
+		for (size_t pos = 0; pos < payload.size(); pos += chunk_size)
+		{
+			reader.feed(payload.data() + pos, std::min(chunk_size, payload.size() - pos));
+		}
+		reader.finish();
+		const double seconds = std::chrono::duration<double>(std::chrono::high_resolution_clock::now() - start).count();
+
+		if (counter.m_parts != part_count || counter.m_bytes != part_count * part_size)
+		{
+			fprintf(stderr, "error: read %u parts of %u bytes, expected %u parts of %u bytes\n",
+				(unsigned)counter.m_parts, (unsigned)counter.m_bytes, (unsigned)part_count, (unsigned)(part_count * part_size));
+			return 1;
+		}
+		if (round == 0 || seconds < best_seconds)
+		{
+			best_seconds = seconds;
+		}
+	}
+
+	printf("%u parts, %u MB in %u KB chunks: %.3f ms, %.2f GB/s\n", (unsigned)part_count, (unsigned)(payload.size() >> 20),
+		(unsigned)(chunk_size >> 10), best_seconds * 1000, (double)payload.size() / best_seconds / 1e9);
+	return 0;
+}
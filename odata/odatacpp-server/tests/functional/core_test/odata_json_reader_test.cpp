@@ -101,6 +101,51 @@ TEST(entities_test)
 	VERIFY_ARE_EQUAL(id, 2);
 }
 
+TEST(entities_in_value_arena_test)
+{
+	auto json_reader = get_json_reader();
+	VERIFY_IS_NOT_NULL(json_reader);
+	auto arena = odata_value_arena::create();
+	json_reader->set_value_arena(arena);
+
+    ::odata::utility::string_t _entity_payload = U(
+	   "{\"@odata.context\":\"http://odatae2etest.azurewebsites.net/cpptest/DefaultService/$metadata#Departments\", \
+		\"value\":[{\"@odata.id\":\"http://odatae2etest.azurewebsites.net/cpptest/DefaultService/Departments(1)\", \
+		\"DepartmentID\":1,\"Name\":\"D1\"},{\"@odata.id\":\"http://odatae2etest.azurewebsites.net/cpptest/DefaultService/Departments(2)\", \
+		\"DepartmentID\":2,\"Name\":\"D2\"}]}"
+		);
+
+	auto return_value = json_reader->deserilize(odata::utility::json::value::parse(_entity_payload));
+	VERIFY_IS_NOT_NULL(return_value);
+	VERIFY_IS_TRUE(arena->get_allocated_bytes() > 0);
+	VERIFY_ARE_EQUAL(arena->get_block_count(), 1);
+
+	// the graph keeps the arena alive after the reader and the caller let go of it
+	json_reader.reset();
+	arena.reset();
+
+	auto collection_value = std::dynamic_pointer_cast<odata_collection_value>(return_value);
+	VERIFY_IS_NOT_NULL(collection_value);
+	auto collection_type = std::dynamic_pointer_cast<edm_collection_type>(collection_value->get_value_type());
+	VERIFY_IS_NOT_NULL(collection_type);
+	VERIFY_ARE_EQUAL(edm_type_kind_t::Entity, collection_type->get_element_type()->get_type_kind());
+
+	auto& entity_values = collection_value->get_collection_values();
+	VERIFY_ARE_EQUAL(entity_values.size(), 2);
+	auto entity_value = std::dynamic_pointer_cast<odata_entity_value>(entity_values[1]);
+	VERIFY_IS_NOT_NULL(entity_value);
+
+	// entity and property types are borrowed from the model, copies of them do not share ownership
+	VERIFY_ARE_EQUAL(entity_value->get_value_type()->get_name(), U("Department"));
+	VERIFY_ARE_EQUAL(entity_value->get_value_type().use_count(), 0);
+	::odata::utility::string_t name;
+	VERIFY_ARE_EQUAL(entity_value->try_get(U("Name"), name), true);
+	VERIFY_ARE_EQUAL(name, U("D2"));
+	int32_t id;
+	VERIFY_ARE_EQUAL(entity_value->try_get(U("DepartmentID"), id), true);
+	VERIFY_ARE_EQUAL(id, 2);
+}
+
 TEST(derived_entity_test)
 {
 	auto json_reader = get_json_reader();
@@ -961,6 +1006,32 @@ TEST(edit_link_entity_set)
 	VERIFY_ARE_EQUAL(entity_value->get_edit_link().to_string(), U("http://odatae2etest.azurewebsites.net/cpptest/DefaultService/Products(2)"));
 }
 
+TEST(edit_link_entity_set_lazy)
+{
+	auto json_reader = get_json_reader();
+	VERIFY_IS_NOT_NULL(json_reader);
+	json_reader->set_lazy_edit_links(true);
+
+	::odata::utility::string_t _entity_payload = U("{\"@odata.context\":\"http://odatae2etest.azurewebsites.net/cpptest/DefaultService/$metadata#Products(ProductID)\", \
+		\"value\":[{\"ProductID\":1},{\"ProductID\":2}]}");
+
+    ::odata::utility::json::value json_payload = odata::utility::json::value::parse(_entity_payload);
+	auto return_values = json_reader->deserilize(json_payload);
+
+	auto collection_value = std::dynamic_pointer_cast<odata_collection_value>(return_values);
+	VERIFY_IS_NOT_NULL(collection_value);
+	auto& entity_values = collection_value->get_collection_values();
+	VERIFY_ARE_EQUAL(entity_values.size(), 2);
+
+	auto entity_value = std::dynamic_pointer_cast<odata_entity_value>(entity_values[0]);
+	VERIFY_ARE_EQUAL(entity_value->has_edit_link(), true);
+	VERIFY_ARE_EQUAL(entity_value->get_edit_link().to_string(), U("http://odatae2etest.azurewebsites.net/cpptest/DefaultService/Products(1)"));
+
+	entity_value = std::dynamic_pointer_cast<odata_entity_value>(entity_values[1]);
+	VERIFY_ARE_EQUAL(entity_value->has_edit_link(), true);
+	VERIFY_ARE_EQUAL(entity_value->get_edit_link().to_string(), U("http://odatae2etest.azurewebsites.net/cpptest/DefaultService/Products(2)"));
+}
+
 TEST(edit_link_entity_relative_path)
 {
 	::odata::utility::string_t _entity_payload = U(
@@ -0,0 +1,266 @@
+﻿//---------------------------------------------------------------------
+// <copyright file="odata_multipart_reader_test.cpp" company="Microsoft">
+//      Copyright (C) Microsoft Corporation. All rights reserved. See License.txt in the project root for license information.
+// </copyright>
+//---------------------------------------------------------------------
+
+#include "../odata_tests.h"
+#include "odata/core/odata_core.h"
+#include "odata/core/odata_multipart_reader.h"
+#include "odata/core/odata_message_reader.h"
+
+using namespace ::odata::core;
+using namespace ::odata::edm;
+
+namespace tests { namespace functional { namespace _odata {
+
+class multipart_event_recorder : public odata_multipart_handler
+{
+public:
+	void on_part_begin(const odata_multipart_headers& headers, int depth)
+	{
+		m_events += "begin(" + std::to_string(depth);
+		for (auto header = headers.cbegin(); header != headers.cend(); ++header)
+		{
+			m_events += "," + header->first + "=" + header->second;
+		}
+		m_events += ")";
+	}
+
+	void on_part_data(const char* data, size_t size)
+	{
+		m_events.append(data, size);
+	}
+
+	void on_part_end()
+	{
+		m_events += "|end;";
+	}
+
+	void on_changeset_begin(const odata_multipart_headers& headers, const std::string& boundary)
+	{
+		m_events += "changeset(" + boundary + ");";
+	}
+
+	void on_changeset_end()
+	{
+		m_events += "changeset_end;";
+	}
+
+	void on_end()
+	{
+		m_events += "done";
+	}
+
+	std::string m_events;
+};
+
+static std::string read_multipart(const std::string& boundary, const std::string& payload, size_t chunk_size)
+{
+	multipart_event_recorder recorder;
+	odata_multipart_reader reader(boundary, recorder);
+	for (size_t pos = 0; pos < payload.size(); pos += chunk_size)
+	{
+		reader.feed(payload.data() + pos, std::min(chunk_size, payload.size() - pos));
+	}
+	reader.finish();
+
+	return recorder.m_events;
+}
+
+static const std::string batch_payload =
+	"preamble\r\n"
+	"--batch_1\r\n"
+	"Content-Type: application/http\r\n"
+	"Content-Transfer-Encoding: binary\r\n"
+	"\r\n"
+	"GET People HTTP/1.1\r\n"
+	"\r\n"
+	"\r\n"
+	"--batch_1\r\n"
+	"Content-Type: multipart/mixed; boundary=\"changeset_1\"\r\n"
+	"\r\n"
+	"--changeset_1\r\n"
+	"Content-ID: 1\r\n"
+	"\r\n"
+	"body\r\r\n--changeset\r\n"
+	"--changeset_1\r\n"
+	"\r\n"
+	"\r\n"
+	"--changeset_1--\r\n"
+	"--batch_1\n"
+	"X-Folded: a\n"
+	" b\n"
+	"\n"
+	"lf only\n"
+	"--batch_1--\r\n"
+	"epilogue";
+
+static const std::string batch_events =
+	"begin(0,Content-Type=application/http,Content-Transfer-Encoding=binary)GET People HTTP/1.1\r\n\r\n|end;"
+	"changeset(changeset_1);"
+	"begin(1,Content-ID=1)body\r\r\n--changeset|end;"
+	"begin(1)|end;"
+	"changeset_end;"
+	"begin(0,X-Folded=a b)lf only|end;"
+	"done";
+
+SUITE(odata_multipart_reader_test_cases)
+{
+
+TEST(multipart_single_chunk)
+{
+	VERIFY_ARE_EQUAL(read_multipart("batch_1", batch_payload, batch_payload.size()), batch_events);
+}
+
+TEST(multipart_split_chunks)
+{
+	// every chunk size splits delimiters, line breaks and headers at different offsets
+	for (size_t chunk_size = 1; chunk_size < batch_payload.size(); chunk_size++)
+	{
+		VERIFY_ARE_EQUAL(read_multipart("batch_1", batch_payload, chunk_size), batch_events);
+	}
+}
+
+TEST(multipart_missing_close_delimiter)
+{
+	multipart_event_recorder recorder;
+	odata_multipart_reader reader("batch_1", recorder);
+	std::string payload = "--batch_1\r\n\r\nbody";
+	reader.feed(payload.data(), payload.size());
+	VERIFY_THROWS(reader.finish(), std::runtime_error);
+}
+
+TEST(multipart_get_boundary)
+{
+	VERIFY_ARE_EQUAL(odata_multipart_reader::get_boundary("multipart/mixed; boundary=batch_1"), "batch_1");
+	VERIFY_ARE_EQUAL(odata_multipart_reader::get_boundary("Multipart/Mixed;charset=utf-8; Boundary=\"b 1\""), "b 1");
+	VERIFY_ARE_EQUAL(odata_multipart_reader::get_boundary("application/http"), "");
+}
+
+TEST(read_batch_response)
+{
+	std::string payload =
+		"--batchresponse_1\r\n"
+		"Content-Type: application/http\r\n"
+		"\r\n"
+		"HTTP/1.1 200 OK\r\n"
+		"Content-Type: application/json;odata.metadata=minimal\r\n"
+		"\r\n"
+		"{\"@odata.context\":\"http://odatae2etest.azurewebsites.net/cpptest/DefaultService/$metadata#Accounts(101)/AccountInfo\",\"FirstName\":\"Alex\",\"LastName\":\"Green\"}\r\n"
+		"--batchresponse_1\r\n"
+		"Content-Type: multipart/mixed; boundary=changesetresponse_1\r\n"
+		"\r\n"
+		"--changesetresponse_1\r\n"
+		"Content-Type: application/http\r\n"
+		"\r\n"
+		"HTTP/1.1 204 No Content\r\n"
+		"Content-ID: 1\r\n"
+		"\r\n"
+		"\r\n"
+		"--changesetresponse_1--\r\n"
+		"--batchresponse_1--\r\n";
+
+	odata_message_reader reader(get_test_model(), g_service_root_url, ::odata::utility::conversions::to_string_t(payload), true);
+	auto batch_value = reader.read_batch_value(U("batchresponse_1"));
+	VERIFY_IS_NOT_NULL(batch_value);
+	VERIFY_ARE_EQUAL(batch_value->get_boundary(), U("batchresponse_1"));
+
+	std::vector<std::shared_ptr<odata_batch_part_value>> parts(batch_value->cbegin(), batch_value->cend());
+	VERIFY_ARE_EQUAL(parts.size(), 2);
+
+	VERIFY_ARE_EQUAL(batch_value->get_changeset_count(), 1);
+	VERIFY_ARE_EQUAL(batch_value->get_changeset_boundary(0), U("changesetresponse_1"));
+
+	VERIFY_ARE_EQUAL(parts[0]->get_changeset_index(), -1);
+	VERIFY_ARE_EQUAL(parts[0]->get_method(), U(""));
+	VERIFY_ARE_EQUAL(parts[0]->get_status_code(), 200);
+	VERIFY_ARE_EQUAL(parts[0]->get_status_message(), U("OK"));
+	VERIFY_ARE_EQUAL(parts[0]->get_header(U("Content-Type")), U("application/json;odata.metadata=minimal"));
+	auto complex_value = std::dynamic_pointer_cast<odata_complex_value>(parts[0]->get_odata_value());
+	VERIFY_IS_NOT_NULL(complex_value);
+	::odata::utility::string_t first_name;
+	VERIFY_ARE_EQUAL(complex_value->try_get(U("FirstName"), first_name), true);
+	VERIFY_ARE_EQUAL(first_name, U("Alex"));
+
+	VERIFY_ARE_EQUAL(parts[1]->get_changeset_index(), 0);
+	VERIFY_ARE_EQUAL(parts[1]->get_status_code(), 204);
+	VERIFY_ARE_EQUAL(parts[1]->get_status_message(), U("No Content"));
+	VERIFY_ARE_EQUAL(parts[1]->get_header(U("Content-ID")), U("1"));
+	VERIFY_IS_NULL(parts[1]->get_odata_value());
+}
+
+TEST(read_batch_request)
+{
+	std::string payload =
+		"--batch_1\r\n"
+		"Content-Type: application/http\r\n"
+		"Content-Transfer-Encoding: binary\r\n"
+		"\r\n"
+		"GET Accounts(101)/AccountInfo HTTP/1.1\r\n"
+		"Accept: application/json\r\n"
+		"\r\n"
+		"\r\n"
+		"--batch_1\r\n"
+		"Content-Type: multipart/mixed; boundary=changeset_1\r\n"
+		"\r\n"
+		"--changeset_1\r\n"
+		"Content-Type: application/http\r\n"
+		"Content-ID: 1\r\n"
+		"\r\n"
+		"PATCH Accounts(101) HTTP/1.1\r\n"
+		"Content-Type: application/json\r\n"
+		"\r\n"
+		"{\"CountryRegion\":\"CN\"}\r\n"
+		"--changeset_1\r\n"
+		"Content-Type: application/http\r\n"
+		"Content-ID: 2\r\n"
+		"\r\n"
+		"DELETE $1/MyGiftCard HTTP/1.1\r\n"
+		"\r\n"
+		"\r\n"
+		"--changeset_1--\r\n"
+		"--batch_1--\r\n";
+
+	odata_message_reader reader(get_test_model(), g_service_root_url, ::odata::utility::conversions::to_string_t(payload), false);
+	auto batch_value = reader.read_batch_value(U("batch_1"));
+	VERIFY_IS_NOT_NULL(batch_value);
+	VERIFY_ARE_EQUAL(batch_value->get_changeset_count(), 1);
+	VERIFY_ARE_EQUAL(batch_value->get_changeset_boundary(0), U("changeset_1"));
+
+	std::vector<std::shared_ptr<odata_batch_part_value>> parts(batch_value->cbegin(), batch_value->cend());
+	VERIFY_ARE_EQUAL(parts.size(), 3);
+
+	VERIFY_ARE_EQUAL(parts[0]->get_changeset_index(), -1);
+	VERIFY_ARE_EQUAL(parts[0]->get_method(), U("GET"));
+	VERIFY_ARE_EQUAL(parts[0]->get_url(), U("Accounts(101)/AccountInfo"));
+	VERIFY_ARE_EQUAL(parts[0]->get_header(U("Accept")), U("application/json"));
+
+	VERIFY_ARE_EQUAL(parts[1]->get_changeset_index(), 0);
+	VERIFY_ARE_EQUAL(parts[1]->get_method(), U("PATCH"));
+	VERIFY_ARE_EQUAL(parts[1]->get_url(), U("Accounts(101)"));
+	VERIFY_ARE_EQUAL(parts[1]->get_header(U("Content-Type")), U("application/json"));
+	VERIFY_IS_NULL(parts[1]->get_odata_value());
+
+	VERIFY_ARE_EQUAL(parts[2]->get_changeset_index(), 0);
+	VERIFY_ARE_EQUAL(parts[2]->get_method(), U("DELETE"));
+	VERIFY_ARE_EQUAL(parts[2]->get_url(), U("$1/MyGiftCard"));
+}
+
+TEST(read_batch_invalid_request_line)
+{
+	std::string payload =
+		"--batch_1\r\n"
+		"Content-Type: application/http\r\n"
+		"\r\n"
+		"GET\r\n"
+		"\r\n"
+		"--batch_1--\r\n";
+
+	odata_message_reader reader(get_test_model(), g_service_root_url, ::odata::utility::conversions::to_string_t(payload), false);
+	VERIFY_THROWS(reader.read_batch_value(U("batch_1")), std::runtime_error);
+}
+
+}
+
+}}}
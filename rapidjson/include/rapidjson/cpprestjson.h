@@ -0,0 +1,242 @@
+// Tencent is pleased to support the open source community by making RapidJSON available.
+//
+// Copyright (C) 2015 THL A29 Limited, a Tencent company, and Milo Yip. All rights reserved.
+//
+// Licensed under the MIT License (the "License"); you may not use this file except
+// in compliance with the License. You may obtain a copy of the License at
+//
+// http://opensource.org/licenses/MIT
+//
+// Unless required by applicable law or agreed to in writing, software distributed
+// under the License is distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR
+// CONDITIONS OF ANY KIND, either express or implied. See the License for the
+// specific language governing permissions and limitations under the License.
+
+#ifndef RAPIDJSON_CPPRESTJSON_H_
+#define RAPIDJSON_CPPRESTJSON_H_
+
+/*! \file cpprestjson.h
+    \brief Conversions between GenericValue and the \c web::json::value of the C++ REST SDK (cpprestsdk).
+
+    The conversions walk one tree and build the other with SAX events, without
+    serializing the JSON text and parsing it again.
+*/
+
+#include "document.h"
+#include <cpprest/json.h>
+#include <string>
+#include <utility>
+#include <vector>
+
+RAPIDJSON_NAMESPACE_BEGIN
+
+namespace internal {
+
+//! Platform string of cpprestsdk from an UTF-8 string.
+inline utility::string_t ToCppRestString(const char* str, SizeType length) {
+#ifdef _UTF16_STRINGS
+    return utility::conversions::to_string_t(std::string(str, length));
+#else
+    return utility::string_t(str, length);
+#endif
+}
+
+//! UTF-8 string from a platform string of cpprestsdk.
+#ifdef _UTF16_STRINGS
+inline std::string FromCppRestString(const utility::string_t& str) {
+    return utility::conversions::to_utf8string(str);
+}
+#else
+inline const std::string& FromCppRestString(const utility::string_t& str) {
+    return str;
+}
+#endif
+
+} // namespace internal
+
+//! Handler building a \c web::json::value from SAX events.
+/*! The strings are expected in UTF-8.
+
+    \code
+    rapidjson::CppRestValueHandler handler;
+    rapidjson::Reader reader;
+    rapidjson::StringStream is(json);
+    if (reader.Parse(is, handler))
+        web::json::value v = handler.GetValue();
+    \endcode
+
+    \note implements Handler concept
+*/
+class CppRestValueHandler {
+public:
+    typedef char Ch;
+
+    //! Constructor.
+    /*! \param keepOrder Whether the objects keep the order of their members, instead of sorting them by name
+            (see \c web::json::value::object()).
+    */
+    explicit CppRestValueHandler(bool keepOrder = false) : root_(), stack_(), keepOrder_(keepOrder) {}
+
+    bool Null() { return Add(web::json::value::null()); }
+    bool Bool(bool b) { return Add(web::json::value::boolean(b)); }
+    bool Int(int i) { return Add(web::json::value(static_cast<int32_t>(i))); }
+    bool Uint(unsigned u) { return Add(web::json::value(static_cast<uint32_t>(u))); }
+    bool Int64(int64_t i) { return Add(web::json::value(i)); }
+    bool Uint64(uint64_t u) { return Add(web::json::value(u)); }
+    bool Double(double d) { return Add(web::json::value(d)); }
+    bool String(const Ch* str, SizeType length, bool) { return Add(web::json::value::string(internal::ToCppRestString(str, length))); }
+
+    bool StartObject() { stack_.push_back(Frame(true)); return true; }
+    bool Key(const Ch* str, SizeType length, bool) { stack_.back().key = internal::ToCppRestString(str, length); return true; }
+    bool EndObject(SizeType) {
+        web::json::value v = web::json::value::object(std::move(stack_.back().fields), keepOrder_);
+        stack_.pop_back();
+        return Add(std::move(v));
+    }
+
+    bool StartArray() { stack_.push_back(Frame(false)); return true; }
+    bool EndArray(SizeType) {
+        web::json::value v = web::json::value::array(std::move(stack_.back().elements));
+        stack_.pop_back();
+        return Add(std::move(v));
+    }
+
+    //! Get the value built from the events of a complete JSON text.
+    web::json::value& GetValue() { return root_; }
+    const web::json::value& GetValue() const { return root_; }
+
+private:
+    // Prohibit copy constructor & assignment operator.
+    CppRestValueHandler(const CppRestValueHandler&);
+    CppRestValueHandler& operator=(const CppRestValueHandler&);
+
+    //! Object or array being built.
+    struct Frame {
+        explicit Frame(bool isObject) : object(isObject), key(), fields(), elements() {}
+        bool object;
+        utility::string_t key;  //!< Name of the next member of an object.
+        std::vector<std::pair<utility::string_t, web::json::value> > fields;
+        std::vector<web::json::value> elements;
+    };
+
+    bool Add(web::json::value&& v) {
+        if (stack_.empty())
+            root_ = std::move(v);
+        else if (stack_.back().object)
+            stack_.back().fields.push_back(std::make_pair(std::move(stack_.back().key), std::move(v)));
+        else
+            stack_.back().elements.push_back(std::move(v));
+        return true;
+    }
+
+    web::json::value root_;
+    std::vector<Frame> stack_;
+    bool keepOrder_;
+};
+
+//! Send the SAX events of a \c web::json::value to a handler.
+/*! The strings are sent in UTF-8, always as copies (\c copy is \c true).
+    The numbers are sent as the reader does: \c Uint or \c Uint64 for
+    non-negative integers, \c Int or \c Int64 for negative ones, and \c Double
+    for the others.
+
+    \tparam Handler Type of handler, implementing Handler concept with \c char characters.
+    \param v The value to walk.
+    \param handler The handler to receive the events.
+    \return Whether the handler accepted all the events.
+*/
+template <typename Handler>
+bool AcceptCppRestValue(const web::json::value& v, Handler& handler) {
+    switch (v.type()) {
+    case web::json::value::Null:
+        return handler.Null();
+
+    case web::json::value::Boolean:
+        return handler.Bool(v.as_bool());
+
+    case web::json::value::Number: {
+            const web::json::number& n = v.as_number();
+            if (!n.is_integral())
+                return handler.Double(n.to_double());
+            if (n.is_uint32())
+                return handler.Uint(n.to_uint32());
+            if (n.is_int32())
+                return handler.Int(n.to_int32());
+            if (n.is_uint64())
+                return handler.Uint64(n.to_uint64());
+            return handler.Int64(n.to_int64());
+        }
+
+    case web::json::value::String: {
+            const std::string& s = internal::FromCppRestString(v.as_string());
+            return handler.String(s.data(), static_cast<SizeType>(s.size()), true);
+        }
+
+    case web::json::value::Object: {
+            const web::json::object& o = v.as_object();
+            if (!handler.StartObject())
+                return false;
+            for (web::json::object::const_iterator itr = o.begin(); itr != o.end(); ++itr) {
+                const std::string& name = internal::FromCppRestString(itr->first);
+                if (!handler.Key(name.data(), static_cast<SizeType>(name.size()), true))
+                    return false;
+                if (!AcceptCppRestValue(itr->second, handler))
+                    return false;
+            }
+            return handler.EndObject(static_cast<SizeType>(o.size()));
+        }
+
+    default:
+        RAPIDJSON_ASSERT(v.type() == web::json::value::Array);
+        {
+            const web::json::array& a = v.as_array();
+            if (!handler.StartArray())
+                return false;
+            for (web::json::array::const_iterator itr = a.begin(); itr != a.end(); ++itr)
+                if (!AcceptCppRestValue(*itr, handler))
+                    return false;
+            return handler.EndArray(static_cast<SizeType>(a.size()));
+        }
+    }
+}
+
+//! Generator sending the SAX events of a \c web::json::value, for GenericDocument::Populate().
+class CppRestValueGenerator {
+public:
+    explicit CppRestValueGenerator(const web::json::value& v) : v_(v) {}
+
+    template <typename Handler>
+    bool operator()(Handler& handler) const { return AcceptCppRestValue(v_, handler); }
+
+private:
+    // Prohibit assignment
+    CppRestValueGenerator& operator=(const CppRestValueGenerator&);
+
+    const web::json::value& v_;
+};
+
+//! Convert a value to a \c web::json::value.
+/*! \param value Value with UTF-8 strings.
+    \param keepOrder Whether the objects keep the order of their members, instead of sorting them by name.
+*/
+template <typename Encoding, typename Allocator>
+web::json::value ToCppRestValue(const GenericValue<Encoding, Allocator>& value, bool keepOrder = false) {
+    CppRestValueHandler handler(keepOrder);
+    value.Accept(handler);
+    return std::move(handler.GetValue());
+}
+
+//! Convert a \c web::json::value to a document.
+/*! \param v The value to convert.
+    \param document Document with UTF-8 strings receiving the converted value.
+    \return The document.
+*/
+template <typename Encoding, typename Allocator, typename StackAllocator>
+GenericDocument<Encoding, Allocator, StackAllocator>& FromCppRestValue(const web::json::value& v, GenericDocument<Encoding, Allocator, StackAllocator>& document) {
+    CppRestValueGenerator generator(v);
+    return document.Populate(generator);
+}
+
+RAPIDJSON_NAMESPACE_END
+
+#endif // RAPIDJSON_CPPRESTJSON_H_
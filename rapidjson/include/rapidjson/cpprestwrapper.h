@@ -0,0 +1,237 @@
+// Tencent is pleased to support the open source community by making RapidJSON available.
+//
+// Copyright (C) 2015 THL A29 Limited, a Tencent company, and Milo Yip. All rights reserved.
+//
+// Licensed under the MIT License (the "License"); you may not use this file except
+// in compliance with the License. You may obtain a copy of the License at
+//
+// http://opensource.org/licenses/MIT
+//
+// Unless required by applicable law or agreed to in writing, software distributed
+// under the License is distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR
+// CONDITIONS OF ANY KIND, either express or implied. See the License for the
+// specific language governing permissions and limitations under the License.
+
+#ifndef RAPIDJSON_CPPRESTWRAPPER_H_
+#define RAPIDJSON_CPPRESTWRAPPER_H_
+
+/*! \file cpprestwrapper.h
+    \brief Streams reading and writing the stream buffers of the C++ REST SDK (cpprestsdk).
+*/
+
+#include "rapidjson.h"
+#include <cpprest/streams.h>
+
+RAPIDJSON_NAMESPACE_BEGIN
+
+//! Input byte stream reading a cpprestsdk stream buffer.
+/*! The blocks of the stream buffer are read in place when it supports
+    \c acquire() (e.g. container and producer/consumer buffers), without
+    copying them. Otherwise they are copied with \c getn() into the
+    user-supplied buffer.
+
+    \code
+    concurrency::streams::istream body = response.body(); // web::http::http_response
+    char buffer[4096];
+    rapidjson::CppRestReadStream is(body.streambuf(), buffer, sizeof(buffer));
+    rapidjson::Document d;
+    d.ParseStream(is);
+    \endcode
+
+    \tparam CharType Character type of the stream buffer, of one byte.
+    \note implements Stream concept
+    \note The reads wait for the data of the stream buffer (\c getn().get()):
+        do not use this stream on a thread of the PPL scheduler, but parse the
+        chunks of the stream buffer as they arrive with GenericPushReader.
+    \note The characters left by the parser in an acquired block are left in the
+        stream buffer when the stream is destroyed, but not those copied in the
+        user-supplied buffer.
+*/
+template <typename CharType>
+class BasicCppRestReadStream {
+public:
+    typedef char Ch;    //!< Character type (byte).
+    typedef concurrency::streams::streambuf<CharType> StreamBufferType;
+
+    //! Constructor.
+    /*!
+        \param streambuf Stream buffer opened for read.
+        \param buffer user-supplied buffer, used when the stream buffer does not support \c acquire().
+        \param bufferSize size of buffer in bytes. Must >=4 bytes.
+    */
+    BasicCppRestReadStream(StreamBufferType streambuf, char* buffer, size_t bufferSize) :
+        streambuf_(streambuf), buffer_(buffer), bufferSize_(bufferSize), bufferLast_(0), current_(0), begin_(0), acquired_(0), count_(0), eof_(false), eofChar_('\0')
+    {
+        RAPIDJSON_STATIC_ASSERT(sizeof(CharType) == 1);
+        RAPIDJSON_ASSERT(bufferSize >= 4);
+        Read();
+    }
+
+    //! Destructor, releasing the acquired block.
+    ~BasicCppRestReadStream() {
+        if (acquired_)
+            streambuf_.release(acquired_, static_cast<size_t>(current_ - begin_));
+    }
+
+    Ch Peek() const { return *current_; }
+    Ch Take() { Ch c = *current_; Read(); return c; }
+    size_t Tell() const { return count_ + static_cast<size_t>(current_ - begin_); }
+
+    // Not implemented
+    void Put(Ch) { RAPIDJSON_ASSERT(false); }
+    void Flush() { RAPIDJSON_ASSERT(false); }
+    Ch* PutBegin() { RAPIDJSON_ASSERT(false); return 0; }
+    size_t PutEnd(Ch*) { RAPIDJSON_ASSERT(false); return 0; }
+
+    // For encoding detection only.
+    const Ch* Peek4() const {
+        return (current_ + 4 <= bufferLast_ + 1) ? current_ : 0;
+    }
+
+private:
+    // Prohibit copy constructor & assignment operator.
+    BasicCppRestReadStream(const BasicCppRestReadStream&);
+    BasicCppRestReadStream& operator=(const BasicCppRestReadStream&);
+
+    void Read() {
+        if (current_ < bufferLast_)
+            ++current_;
+        else if (!eof_) {
+            // Done with the current block
+            if (begin_)
+                count_ += static_cast<size_t>(bufferLast_ + 1 - begin_);
+            if (acquired_) {
+                streambuf_.release(acquired_, static_cast<size_t>(bufferLast_ + 1 - begin_));
+                acquired_ = 0;
+            }
+
+            CharType* block;
+            size_t blockSize;
+            if (streambuf_.acquire(block, blockSize)) {
+                if (blockSize > 0) {
+                    acquired_ = block;
+                    begin_ = reinterpret_cast<Ch*>(block);
+                }
+            }
+            else {
+                // Not supported, or no block available without waiting
+                blockSize = streambuf_.getn(reinterpret_cast<CharType*>(buffer_), bufferSize_).get();
+                begin_ = buffer_;
+            }
+
+            if (blockSize == 0) {
+                // End of stream: the null character stays in a block of its own
+                begin_ = &eofChar_;
+                blockSize = 1;
+                eof_ = true;
+            }
+            current_ = begin_;
+            bufferLast_ = begin_ + blockSize - 1;
+        }
+    }
+
+    StreamBufferType streambuf_;
+    Ch *buffer_;
+    size_t bufferSize_;
+    const Ch *bufferLast_;  //!< Last character of the current block.
+    const Ch *current_;
+    const Ch *begin_;       //!< Beginning of the current block.
+    CharType *acquired_;    //!< Current block if acquired from the stream buffer, to be released.
+    size_t count_;          //!< Number of characters before the current block.
+    bool eof_;
+    Ch eofChar_;
+};
+
+//! Input byte stream reading a cpprestsdk stream buffer of \c uint8_t, as the bodies of HTTP messages.
+typedef BasicCppRestReadStream<uint8_t> CppRestReadStream;
+
+//! Output byte stream writing a cpprestsdk stream buffer.
+/*! The characters are put in the user-supplied buffer, whose content is
+    written to the stream buffer with \c putn_nocopy() when it is full, or
+    by Flush().
+
+    \code
+    concurrency::streams::container_buffer<std::string> body;
+    char buffer[4096];
+    rapidjson::CppRestWriteStream os(body, buffer, sizeof(buffer));
+    rapidjson::Writer<rapidjson::CppRestWriteStream> writer(os);
+    d.Accept(writer);
+    os.Flush();
+    \endcode
+
+    \tparam CharType Character type of the stream buffer, of one byte.
+    \note implements Stream concept
+    \note The writes wait for the stream buffer (\c putn_nocopy().wait()), which may
+        read the buffer until then.
+*/
+template <typename CharType>
+class BasicCppRestWriteStream {
+public:
+    typedef char Ch;    //!< Character type. Only support char.
+    typedef concurrency::streams::streambuf<CharType> StreamBufferType;
+
+    BasicCppRestWriteStream(StreamBufferType streambuf, char* buffer, size_t bufferSize) : streambuf_(streambuf), buffer_(buffer), bufferEnd_(buffer + bufferSize), current_(buffer_) {
+        RAPIDJSON_STATIC_ASSERT(sizeof(CharType) == 1);
+        RAPIDJSON_ASSERT(bufferSize > 0);
+    }
+
+    void Put(char c) {
+        if (current_ >= bufferEnd_)
+            Flush();
+
+        *current_++ = c;
+    }
+
+    void PutN(char c, size_t n) {
+        size_t avail = static_cast<size_t>(bufferEnd_ - current_);
+        while (n > avail) {
+            std::memset(current_, c, avail);
+            current_ += avail;
+            Flush();
+            n -= avail;
+            avail = static_cast<size_t>(bufferEnd_ - current_);
+        }
+
+        if (n > 0) {
+            std::memset(current_, c, n);
+            current_ += n;
+        }
+    }
+
+    void Flush() {
+        if (current_ != buffer_) {
+            streambuf_.putn_nocopy(reinterpret_cast<const CharType*>(buffer_), static_cast<size_t>(current_ - buffer_)).wait();
+            current_ = buffer_;
+        }
+    }
+
+    // Not implemented
+    char Peek() const { RAPIDJSON_ASSERT(false); return 0; }
+    char Take() { RAPIDJSON_ASSERT(false); return 0; }
+    size_t Tell() const { RAPIDJSON_ASSERT(false); return 0; }
+    char* PutBegin() { RAPIDJSON_ASSERT(false); return 0; }
+    size_t PutEnd(char*) { RAPIDJSON_ASSERT(false); return 0; }
+
+private:
+    // Prohibit copy constructor & assignment operator.
+    BasicCppRestWriteStream(const BasicCppRestWriteStream&);
+    BasicCppRestWriteStream& operator=(const BasicCppRestWriteStream&);
+
+    StreamBufferType streambuf_;
+    char *buffer_;
+    char *bufferEnd_;
+    char *current_;
+};
+
+//! Output byte stream writing a cpprestsdk stream buffer of \c uint8_t, as the bodies of HTTP messages.
+typedef BasicCppRestWriteStream<uint8_t> CppRestWriteStream;
+
+//! Implement specialized version of PutN() with memset() for better performance.
+template<typename CharType>
+inline void PutN(BasicCppRestWriteStream<CharType>& stream, char c, size_t n) {
+    stream.PutN(c, n);
+}
+
+RAPIDJSON_NAMESPACE_END
+
+#endif // RAPIDJSON_CPPRESTWRAPPER_H_
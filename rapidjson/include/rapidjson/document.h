@@ -55,6 +55,43 @@ RAPIDJSON_DIAG_OFF(effc++)
 #include <string>
 #endif // RAPIDJSON_HAS_STDSTRING
 
+///////////////////////////////////////////////////////////////////////////////
+// RAPIDJSON_MEMBER_INDEX
+
+#ifndef RAPIDJSON_MEMBER_INDEX
+#define RAPIDJSON_MEMBER_INDEX 0 // linear member lookup by default
+/*! \def RAPIDJSON_MEMBER_INDEX
+    \ingroup RAPIDJSON_CONFIG
+    \brief Enable the hashed member index of large objects
+
+    By defining this preprocessor symbol to \c 1, an object whose capacity
+    reaches \ref RAPIDJSON_MEMBER_INDEX_THRESHOLD members gets an open
+    addressing hash table of its member names, allocated by its allocator
+    right after its members. The table is built by the first lookup
+    (FindMember(), HasMember(), operator[], RemoveMember() by name), then kept
+    up to date by AddMember() and RemoveMember(), which makes lookups constant
+    time on average. Smaller objects are not changed.
+
+    \note Member names must not be modified through member iterators while
+        the index is enabled.
+    \note The first lookup in a large object builds its index, so concurrent
+        lookups in a shared document are only safe once each object has been
+        looked up.
+
+    \hideinitializer
+*/
+#endif // !defined(RAPIDJSON_MEMBER_INDEX)
+
+#ifndef RAPIDJSON_MEMBER_INDEX_THRESHOLD
+/*! \def RAPIDJSON_MEMBER_INDEX_THRESHOLD
+    \ingroup RAPIDJSON_CONFIG
+    \brief Capacity from which an object has a member index (at least 1)
+
+    \see RAPIDJSON_MEMBER_INDEX
+*/
+#define RAPIDJSON_MEMBER_INDEX_THRESHOLD 32
+#endif
+
 #ifndef RAPIDJSON_NOMEMBERITERATORCLASS
 #include <iterator> // std::iterator, std::random_access_iterator_tag
 #endif
@@ -907,7 +944,7 @@ public:
         \note Earlier versions of Rapidjson returned a \c NULL pointer, in case
             the requested member doesn't exist. For consistency with e.g.
             \c std::map, this has been changed to MemberEnd() now.
-        \note Linear time complexity.
+        \note Linear time complexity, constant on average for objects indexed with \ref RAPIDJSON_MEMBER_INDEX.
     */
     MemberIterator FindMember(const Ch* name) {
         GenericValue n(StringRef(name));
@@ -927,12 +964,16 @@ public:
         \note Earlier versions of Rapidjson returned a \c NULL pointer, in case
             the requested member doesn't exist. For consistency with e.g.
             \c std::map, this has been changed to MemberEnd() now.
-        \note Linear time complexity.
+        \note Linear time complexity, constant on average for objects indexed with \ref RAPIDJSON_MEMBER_INDEX.
     */
     template <typename SourceAllocator>
     MemberIterator FindMember(const GenericValue<Encoding, SourceAllocator>& name) {
         RAPIDJSON_ASSERT(IsObject());
         RAPIDJSON_ASSERT(name.IsString());
+#if RAPIDJSON_MEMBER_INDEX
+        if (SizeType* index = GetMemberIndex())
+            return FindIndexedMember(index, name);
+#endif
         MemberIterator member = MemberBegin();
         for ( ; member != MemberEnd(); ++member)
             if (name.StringEqual(member->name))
@@ -971,17 +1012,25 @@ public:
         if (o.size >= o.capacity) {
             if (o.capacity == 0) {
                 o.capacity = kDefaultObjectCapacity;
-                o.members = reinterpret_cast<Member*>(allocator.Malloc(o.capacity * sizeof(Member)));
+                o.members = reinterpret_cast<Member*>(allocator.Malloc(GetMembersSize(o.capacity)));
             }
             else {
                 SizeType oldCapacity = o.capacity;
                 o.capacity += (oldCapacity + 1) / 2; // grow by factor 1.5
-                o.members = reinterpret_cast<Member*>(allocator.Realloc(o.members, oldCapacity * sizeof(Member), o.capacity * sizeof(Member)));
+                o.members = reinterpret_cast<Member*>(allocator.Realloc(o.members, GetMembersSize(oldCapacity), GetMembersSize(o.capacity)));
             }
+#if RAPIDJSON_MEMBER_INDEX
+            ResetMemberIndex(); // built again by the next lookup
+#endif
         }
         o.members[o.size].name.RawAssign(name);
         o.members[o.size].value.RawAssign(value);
         o.size++;
+#if RAPIDJSON_MEMBER_INDEX
+        if (SizeType* index = GetMemberIndex())
+            if (index[0] != 0)
+                InsertMemberIndex(index, o.size - 1);
+#endif
         return *this;
     }
 
@@ -1118,6 +1167,9 @@ public:
         for (MemberIterator m = MemberBegin(); m != MemberEnd(); ++m)
             m->~Member();
         data_.o.size = 0;
+#if RAPIDJSON_MEMBER_INDEX
+        ResetMemberIndex();
+#endif
     }
 
     //! Remove a member in object by its name.
@@ -1163,6 +1215,15 @@ public:
         RAPIDJSON_ASSERT(m >= MemberBegin() && m < MemberEnd());
 
         MemberIterator last(data_.o.members + (data_.o.size - 1));
+#if RAPIDJSON_MEMBER_INDEX
+        if (SizeType* index = GetMemberIndex()) {
+            if (index[0] != 0) {
+                RemoveMemberIndex(index, static_cast<SizeType>(m - MemberBegin()));
+                if (m != last) // The last member moves to the removed one
+                    index[1 + FindMemberIndexBucket(index, data_.o.size - 1)] = static_cast<SizeType>(m - MemberBegin()) + 1;
+            }
+        }
+#endif
         if (data_.o.size > 1 && m != last) {
             // Move the last one to this place
             *m = *last;
@@ -1210,6 +1271,9 @@ public:
             itr->~Member();
         std::memmove(&*pos, &*last, (MemberEnd() - last) * sizeof(Member));
         data_.o.size -= (last - first);
+#if RAPIDJSON_MEMBER_INDEX
+        ResetMemberIndex(); // built again by the next lookup
+#endif
         return pos;
     }
 
@@ -1643,14 +1707,116 @@ private:
     void SetObjectRaw(Member* members, SizeType count, Allocator& allocator) {
         flags_ = kObjectFlag;
         if (count) {
-            data_.o.members = (Member*)allocator.Malloc(count * sizeof(Member));
+            data_.o.members = (Member*)allocator.Malloc(GetMembersSize(count));
             std::memcpy(data_.o.members, members, count * sizeof(Member));
         }
         else
             data_.o.members = NULL;
         data_.o.size = data_.o.capacity = count;
+#if RAPIDJSON_MEMBER_INDEX
+        ResetMemberIndex(); // built by the first lookup
+#endif
+    }
+
+    //! Size of the memory block of the members of an object, followed by its member index with \ref RAPIDJSON_MEMBER_INDEX.
+    static size_t GetMembersSize(SizeType capacity) {
+#if RAPIDJSON_MEMBER_INDEX
+        if (capacity >= RAPIDJSON_MEMBER_INDEX_THRESHOLD)
+            return capacity * sizeof(Member) + (GetMemberIndexBuckets(capacity) + 1) * sizeof(SizeType);
+#endif
+        return capacity * sizeof(Member);
     }
 
+#if RAPIDJSON_MEMBER_INDEX
+    // Member index: a SizeType header holding the number of buckets (0 until
+    // built), then the buckets, each one holding 1 + the position of a member,
+    // or 0 if empty. Collisions are resolved by linear probing.
+
+    //! Number of buckets of the member index, a power of two keeping the load factor at most 0.5.
+    static SizeType GetMemberIndexBuckets(SizeType capacity) {
+        SizeType buckets = 1;
+        while (buckets < 2 * capacity)
+            buckets <<= 1;
+        return buckets;
+    }
+
+    //! Member index of this object, or NULL if its capacity is below the threshold.
+    SizeType* GetMemberIndex() const {
+        return data_.o.capacity >= RAPIDJSON_MEMBER_INDEX_THRESHOLD ? reinterpret_cast<SizeType*>(data_.o.members + data_.o.capacity) : 0;
+    }
+
+    //! Mark the member index as not built, after a reallocation or a change of the order of the members.
+    void ResetMemberIndex() {
+        if (SizeType* index = GetMemberIndex())
+            index[0] = 0;
+    }
+
+    //! FNV-1a hash of a member name.
+    template <typename SourceAllocator>
+    static SizeType HashMemberName(const GenericValue<Encoding, SourceAllocator>& name) {
+        const unsigned char* p = reinterpret_cast<const unsigned char*>(name.GetString());
+        const unsigned char* const end = p + name.GetStringLength() * sizeof(Ch);
+        SizeType h = static_cast<SizeType>(2166136261u);
+        for (; p != end; ++p)
+            h = (h ^ *p) * static_cast<SizeType>(16777619u);
+        return h;
+    }
+
+    void BuildMemberIndex(SizeType* index) {
+        const SizeType buckets = GetMemberIndexBuckets(data_.o.capacity);
+        std::memset(index + 1, 0, buckets * sizeof(SizeType));
+        index[0] = buckets;
+        for (SizeType i = 0; i < data_.o.size; ++i)
+            InsertMemberIndex(index, i);
+    }
+
+    void InsertMemberIndex(SizeType* index, SizeType i) {
+        const SizeType mask = index[0] - 1;
+        SizeType b = HashMemberName(data_.o.members[i].name) & mask;
+        while (index[1 + b] != 0)
+            b = (b + 1) & mask;
+        index[1 + b] = i + 1;
+    }
+
+    //! Bucket of the member at position i, which must be in the index.
+    SizeType FindMemberIndexBucket(const SizeType* index, SizeType i) const {
+        const SizeType mask = index[0] - 1;
+        SizeType b = HashMemberName(data_.o.members[i].name) & mask;
+        while (index[1 + b] != i + 1)
+            b = (b + 1) & mask;
+        return b;
+    }
+
+    //! Remove the member at position i from the index, shifting back the following entries of its cluster.
+    void RemoveMemberIndex(SizeType* index, SizeType i) {
+        const SizeType mask = index[0] - 1;
+        SizeType* buckets = index + 1;
+        SizeType hole = FindMemberIndexBucket(index, i);
+        for (SizeType b = (hole + 1) & mask; buckets[b] != 0; b = (b + 1) & mask) {
+            // An entry can fill the hole if the hole lies between its home bucket and its bucket
+            const SizeType home = HashMemberName(data_.o.members[buckets[b] - 1].name) & mask;
+            if (((b - home) & mask) >= ((b - hole) & mask)) {
+                buckets[hole] = buckets[b];
+                hole = b;
+            }
+        }
+        buckets[hole] = 0;
+    }
+
+    template <typename SourceAllocator>
+    MemberIterator FindIndexedMember(SizeType* index, const GenericValue<Encoding, SourceAllocator>& name) {
+        if (index[0] == 0)
+            BuildMemberIndex(index);
+        const SizeType mask = index[0] - 1;
+        for (SizeType b = HashMemberName(name) & mask; index[1 + b] != 0; b = (b + 1) & mask) {
+            Member* m = data_.o.members + (index[1 + b] - 1);
+            if (name.StringEqual(m->name))
+                return MemberIterator(m);
+        }
+        return MemberEnd();
+    }
+#endif // RAPIDJSON_MEMBER_INDEX
+
     //! Initialize this value as constant string, without calling destructor.
     void SetStringRaw(StringRefType s) RAPIDJSON_NOEXCEPT {
         flags_ = kConstStringFlag;
@@ -1778,6 +1944,22 @@ public:
     }
 #endif
 
+    //! Populate this document by a generator which produces SAX events.
+    /*! \tparam Generator A functor with <tt>bool f(Handler)</tt> prototype.
+        \param g Generator functor which sends SAX events to the parameter.
+        \return The document itself for fluent API.
+    */
+    template <typename Generator>
+    GenericDocument& Populate(Generator& g) {
+        ValueType::SetNull(); // Remove existing root if exist
+        ClearStackOnExit scope(*this);
+        if (g(*this)) {
+            RAPIDJSON_ASSERT(stack_.GetSize() == sizeof(ValueType)); // Got one and only one root object
+            this->RawAssign(*stack_.template Pop<ValueType>(1));    // Add this-> to prevent issue 13.
+        }
+        return *this;
+    }
+
     //!@name Parse from stream
     //!@{
 
@@ -1909,10 +2091,9 @@ private:
         GenericDocument& d_;
     };
 
-    // callers of the following private Handler functions
-    template <typename,typename,typename> friend class GenericReader; // for parsing
     template <typename, typename> friend class GenericValue; // for deep copying
 
+public:
     // Implementation of Handler
     bool Null() { new (stack_.template Push<ValueType>()) ValueType(); return true; }
     bool Bool(bool b) { new (stack_.template Push<ValueType>()) ValueType(b); return true; }
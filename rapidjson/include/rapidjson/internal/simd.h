@@ -0,0 +1,134 @@
+// Tencent is pleased to support the open source community by making RapidJSON available.
+//
+// Copyright (C) 2015 THL A29 Limited, a Tencent company, and Milo Yip. All rights reserved.
+//
+// Licensed under the MIT License (the "License"); you may not use this file except
+// in compliance with the License. You may obtain a copy of the License at
+//
+// http://opensource.org/licenses/MIT
+//
+// Unless required by applicable law or agreed to in writing, software distributed
+// under the License is distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR
+// CONDITIONS OF ANY KIND, either express or implied. See the License for the
+// specific language governing permissions and limitations under the License.
+
+#ifndef RAPIDJSON_INTERNAL_SIMD_H_
+#define RAPIDJSON_INTERNAL_SIMD_H_
+
+#include "../rapidjson.h"
+
+#ifdef RAPIDJSON_SIMD
+
+#ifdef _MSC_VER
+#include <intrin.h>
+#pragma intrinsic(_BitScanForward)
+#endif
+#ifdef RAPIDJSON_AVX2
+#include <immintrin.h>
+#elif defined(RAPIDJSON_SSE42)
+#include <nmmintrin.h>
+#else
+#include <emmintrin.h>
+#endif
+
+RAPIDJSON_NAMESPACE_BEGIN
+namespace internal {
+
+//! Number of characters tested at once by ScanStringBlock().
+#ifdef RAPIDJSON_AVX2
+static const size_t kStringBlockSize = 32;
+#else
+static const size_t kStringBlockSize = 16;
+#endif
+
+//! Test whether a character must be escaped in a JSON string: quotation mark, reverse solidus or control character.
+inline bool IsStringSpecial(char c) {
+    return c == '\"' || c == '\\' || static_cast<unsigned char>(c) < 0x20;
+}
+
+//! Index of the lowest bit set in a non-zero mask.
+inline unsigned LowestBitIndex(unsigned mask) {
+    RAPIDJSON_ASSERT(mask != 0);
+#ifdef _MSC_VER
+    unsigned long offset;
+    _BitScanForward(&offset, mask);
+    return static_cast<unsigned>(offset);
+#else
+    return static_cast<unsigned>(__builtin_ctz(mask));
+#endif
+}
+
+//! Test a block of kStringBlockSize characters, aligned on its size, for characters to escape.
+/*! \return Mask with the bit i set if p[i] is a quotation mark, a reverse solidus or a control character.
+    \note An aligned load never crosses a page boundary, so it can read past the end of a string safely.
+*/
+inline unsigned ScanStringBlock(const char* p) {
+#ifdef RAPIDJSON_AVX2
+    const __m256i s = _mm256_load_si256(reinterpret_cast<const __m256i*>(p));
+    const __m256i dq = _mm256_set1_epi8('\"');
+    const __m256i bs = _mm256_set1_epi8('\\');
+    const __m256i sp = _mm256_set1_epi8(0x1F);
+    const __m256i t1 = _mm256_cmpeq_epi8(s, dq);
+    const __m256i t2 = _mm256_cmpeq_epi8(s, bs);
+    const __m256i t3 = _mm256_cmpeq_epi8(_mm256_max_epu8(s, sp), sp); // s < 0x20 <=> max(s, 0x1F) == 0x1F
+    return static_cast<unsigned>(_mm256_movemask_epi8(_mm256_or_si256(_mm256_or_si256(t1, t2), t3)));
+#else
+    const __m128i s = _mm_load_si128(reinterpret_cast<const __m128i*>(p));
+    const __m128i dq = _mm_set1_epi8('\"');
+    const __m128i bs = _mm_set1_epi8('\\');
+    const __m128i sp = _mm_set1_epi8(0x1F);
+    const __m128i t1 = _mm_cmpeq_epi8(s, dq);
+    const __m128i t2 = _mm_cmpeq_epi8(s, bs);
+    const __m128i t3 = _mm_cmpeq_epi8(_mm_max_epu8(s, sp), sp); // s < 0x20 <=> max(s, 0x1F) == 0x1F
+    return static_cast<unsigned>(_mm_movemask_epi8(_mm_or_si128(_mm_or_si128(t1, t2), t3)));
+#endif
+}
+
+//! Find the first character to escape in a string, testing kStringBlockSize characters at once.
+/*! \param p Beginning of the string, which must contain a character to escape (e.g. its null terminator).
+    \return Pointer to the first quotation mark, reverse solidus or control character.
+*/
+inline const char* ScanUnescapedString(const char* p) {
+    // Test one by one until alignment
+    const char* nextAligned = reinterpret_cast<const char*>((reinterpret_cast<size_t>(p) + (kStringBlockSize - 1)) & ~(kStringBlockSize - 1));
+    for (; p != nextAligned; ++p)
+        if (IsStringSpecial(*p))
+            return p;
+
+    // The rest of string using SIMD
+    for (;; p += kStringBlockSize) {
+        const unsigned r = ScanStringBlock(p);
+        if (r != 0)
+            return p + LowestBitIndex(r);
+    }
+}
+
+//! Find the first character to escape in a string of known length, testing kStringBlockSize characters at once.
+/*! \param p Beginning of the string.
+    \param end End of the string, which does not need to be null-terminated.
+    \return Pointer to the first quotation mark, reverse solidus or control character, or end.
+*/
+inline const char* ScanUnescapedString(const char* p, const char* end) {
+    // Test one by one until alignment
+    const char* nextAligned = reinterpret_cast<const char*>((reinterpret_cast<size_t>(p) + (kStringBlockSize - 1)) & ~(kStringBlockSize - 1));
+    for (; p != nextAligned; ++p)
+        if (p == end || IsStringSpecial(*p))
+            return p;
+
+    // The rest of string using SIMD
+    for (; p < end; p += kStringBlockSize) {
+        const unsigned r = ScanStringBlock(p);
+        if (r != 0) {
+            const char* q = p + LowestBitIndex(r);
+            return q < end ? q : end;
+        }
+    }
+    return end;
+}
+
+} // namespace internal
+RAPIDJSON_NAMESPACE_END
+
+#endif // RAPIDJSON_SIMD
+
+#endif // RAPIDJSON_INTERNAL_SIMD_H_
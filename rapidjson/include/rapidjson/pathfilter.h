@@ -0,0 +1,283 @@
+// Tencent is pleased to support the open source community by making RapidJSON available.
+//
+// Copyright (C) 2015 THL A29 Limited, a Tencent company, and Milo Yip. All rights reserved.
+//
+// Licensed under the MIT License (the "License"); you may not use this file except
+// in compliance with the License. You may obtain a copy of the License at
+//
+// http://opensource.org/licenses/MIT
+//
+// Unless required by applicable law or agreed to in writing, software distributed
+// under the License is distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR
+// CONDITIONS OF ANY KIND, either express or implied. See the License for the
+// specific language governing permissions and limitations under the License.
+
+#ifndef RAPIDJSON_PATHFILTER_H_
+#define RAPIDJSON_PATHFILTER_H_
+
+/*! \file pathfilter.h
+    \brief SAX handler selecting the values of JSON pointers during parsing.
+*/
+
+#include "pointer.h"
+#include "internal/stack.h"
+
+RAPIDJSON_NAMESPACE_BEGIN
+
+//! SAX handler forwarding only the values located by a list of JSON pointers.
+/*! GenericPathFilter receives the events of a whole JSON text, e.g. from
+    GenericReader, and forwards to the output handler only the events of the
+    values located by its pointers, without building a DOM. The subtrees which
+    contain no selected value are skipped by counting their depth only.
+
+    Before the events of a selected value, the output handler receives
+    <tt>bool StartPath(SizeType index)</tt> with the index of the pointer in the
+    list, and after them <tt>bool EndPath(SizeType index)</tt>. A value located
+    by several pointers, or inside another selected value, receives these calls
+    for each of them, nested.
+
+    \code
+    struct Fields : BaseReaderHandler<UTF8<>, Fields> {
+        bool StartPath(SizeType index) { current = index; return true; }
+        bool EndPath(SizeType) { return true; }
+        bool String(const char* str, SizeType length, bool) { values[current].assign(str, length); return true; }
+        bool Default() { return true; }
+        SizeType current;
+        std::string values[2];
+    };
+
+    const Pointer paths[] = { Pointer("/request/method"), Pointer("/request/uri") };
+    Fields fields;
+    GenericPathFilter<Fields> filter(paths, 2, fields);
+    Reader reader;
+    StringStream is(line);
+    reader.Parse(is, filter);
+    \endcode
+
+    \tparam OutputHandler Type of output handler, implementing Handler concept with StartPath() and EndPath().
+    \tparam PointerType Type of the pointers, GenericPointer.
+    \tparam StackAllocator Allocator type of the stacks of the candidate pointers.
+    \note implements Handler concept
+*/
+template <typename OutputHandler, typename PointerType = Pointer, typename StackAllocator = CrtAllocator>
+class GenericPathFilter {
+public:
+    typedef typename PointerType::Ch Ch;
+    typedef typename PointerType::Token Token;
+
+    //! Constructor.
+    /*! \param paths Array of valid pointers, which must outlive the filter.
+        \param pathCount Number of pointers.
+        \param handler Handler receiving the events of the selected values.
+        \param stackAllocator Optional allocator for allocating the stacks.
+        \param stackCapacity Initial capacity in bytes of the stacks.
+    */
+    GenericPathFilter(const PointerType* paths, SizeType pathCount, OutputHandler& handler, StackAllocator* stackAllocator = 0, size_t stackCapacity = kDefaultStackCapacity) :
+        paths_(paths), pathCount_(pathCount), handler_(handler),
+        frames_(stackAllocator, stackCapacity), candidates_(stackAllocator, stackCapacity), selections_(stackAllocator, stackCapacity),
+        depth_(0), skip_(0)
+    {
+        Reset();
+    }
+
+    //! Prepare the filter for a new JSON text, e.g. after an error.
+    void Reset() {
+        frames_.Clear();
+        candidates_.Clear();
+        selections_.Clear();
+        depth_ = 0;
+        skip_ = 0;
+        for (SizeType i = 0; i < pathCount_; i++) {
+            RAPIDJSON_ASSERT(paths_[i].IsValid());
+            *candidates_.template Push<SizeType>() = i;
+        }
+    }
+
+    bool Null()                 { return BeginValue() && (!IsSelecting() || handler_.Null()) && EndValue(); }
+    bool Bool(bool b)           { return BeginValue() && (!IsSelecting() || handler_.Bool(b)) && EndValue(); }
+    bool Int(int i)             { return BeginValue() && (!IsSelecting() || handler_.Int(i)) && EndValue(); }
+    bool Uint(unsigned u)       { return BeginValue() && (!IsSelecting() || handler_.Uint(u)) && EndValue(); }
+    bool Int64(int64_t i)       { return BeginValue() && (!IsSelecting() || handler_.Int64(i)) && EndValue(); }
+    bool Uint64(uint64_t u)     { return BeginValue() && (!IsSelecting() || handler_.Uint64(u)) && EndValue(); }
+    bool Double(double d)       { return BeginValue() && (!IsSelecting() || handler_.Double(d)) && EndValue(); }
+    bool String(const Ch* str, SizeType length, bool copy) {
+        return BeginValue() && (!IsSelecting() || handler_.String(str, length, copy)) && EndValue();
+    }
+
+    bool StartObject() {
+        if (!BeginValue() || (IsSelecting() && !handler_.StartObject()))
+            return false;
+        PushFrame(true);
+        return true;
+    }
+
+    bool Key(const Ch* str, SizeType length, bool copy) {
+        if (IsSelecting() && !handler_.Key(str, length, copy))
+            return false;
+        if (skip_ == 0) {
+            // Candidates for the value of this member
+            const Frame& frame = *frames_.template Top<Frame>();
+            ClearChildCandidates(frame);
+            for (SizeType i = frame.begin; i < frame.begin + frame.count; i++) {
+                const SizeType c = candidates_.template Bottom<SizeType>()[i];
+                const Token& t = paths_[c].GetTokens()[depth_ - 1];
+                if (t.length == length && std::memcmp(t.name, str, length * sizeof(Ch)) == 0)
+                    *candidates_.template Push<SizeType>() = c;
+            }
+        }
+        return true;
+    }
+
+    bool EndObject(SizeType memberCount) {
+        if (IsSelecting() && !handler_.EndObject(memberCount))
+            return false;
+        PopFrame();
+        return EndValue();
+    }
+
+    bool StartArray() {
+        if (!BeginValue() || (IsSelecting() && !handler_.StartArray()))
+            return false;
+        PushFrame(false);
+        return true;
+    }
+
+    bool EndArray(SizeType elementCount) {
+        if (IsSelecting() && !handler_.EndArray(elementCount))
+            return false;
+        PopFrame();
+        return EndValue();
+    }
+
+private:
+    // Prohibit copy constructor & assignment operator.
+    GenericPathFilter(const GenericPathFilter&);
+    GenericPathFilter& operator=(const GenericPathFilter&);
+
+    //! Object or array containing candidate pointers.
+    /*! The candidates of the frame are followed in candidates_ by those of its current child value.
+    */
+    struct Frame {
+        SizeType begin;     //!< Offset in candidates_ of the pointers continuing in this value.
+        SizeType count;     //!< Number of pointers continuing in this value.
+        SizeType index;     //!< Index of the next element of an array.
+        bool object;
+    };
+
+    //! Selection of a value by a pointer.
+    struct Selection {
+        SizeType path;      //!< Index of the pointer.
+        size_t depth;       //!< Depth of the value.
+    };
+
+    bool IsSelecting() const { return !selections_.Empty(); }
+
+    SizeType CandidateCount() const { return static_cast<SizeType>(candidates_.GetSize() / sizeof(SizeType)); }
+
+    //! Offset in candidates_ of the candidates of the current value: all the pointers for the root.
+    SizeType CurrentCandidates() {
+        if (depth_ == 0)
+            return 0;
+        const Frame& frame = *frames_.template Top<Frame>();
+        return frame.begin + frame.count;
+    }
+
+    void ClearChildCandidates(const Frame& frame) {
+        candidates_.template Pop<SizeType>(CandidateCount() - (frame.begin + frame.count));
+    }
+
+    //! Find the candidates of the value starting, and select it for those ending on it.
+    bool BeginValue() {
+        if (skip_ > 0)
+            return true;
+
+        if (depth_ > 0) {
+            Frame& frame = *frames_.template Top<Frame>();
+            if (!frame.object) {
+                // Candidates for this element
+                ClearChildCandidates(frame);
+                for (SizeType i = frame.begin; i < frame.begin + frame.count; i++) {
+                    const SizeType c = candidates_.template Bottom<SizeType>()[i];
+                    if (paths_[c].GetTokens()[depth_ - 1].index == frame.index)
+                        *candidates_.template Push<SizeType>() = c;
+                }
+                frame.index++;
+            }
+        }
+
+        for (SizeType i = CurrentCandidates(); i < CandidateCount(); i++) {
+            const SizeType c = candidates_.template Bottom<SizeType>()[i];
+            if (paths_[c].GetTokenCount() == depth_) {
+                Selection* s = selections_.template Push<Selection>();
+                s->path = c;
+                s->depth = depth_;
+                if (!handler_.StartPath(c))
+                    return false;
+            }
+        }
+        return true;
+    }
+
+    //! End the selections of the value ended.
+    bool EndValue() {
+        while (!selections_.Empty() && selections_.template Top<Selection>()->depth == depth_) {
+            const SizeType path = selections_.template Pop<Selection>(1)->path;
+            if (!handler_.EndPath(path))
+                return false;
+        }
+        return true;
+    }
+
+    //! Enter an object or an array, skipped if none of its candidates continues in it.
+    void PushFrame(bool object) {
+        if (skip_ > 0) {
+            ++depth_;
+            ++skip_;
+            return;
+        }
+
+        const SizeType first = CurrentCandidates();
+        const SizeType begin = CandidateCount();
+        ++depth_;
+        for (SizeType i = first; i < begin; i++) {
+            const SizeType c = candidates_.template Bottom<SizeType>()[i]; // Read before Push(), which may move the stack
+            if (paths_[c].GetTokenCount() >= depth_)
+                *candidates_.template Push<SizeType>() = c;
+        }
+
+        const SizeType count = CandidateCount() - begin;
+        if (count == 0) {
+            skip_ = 1;
+            return;
+        }
+        Frame* frame = frames_.template Push<Frame>();
+        frame->begin = begin;
+        frame->count = count;
+        frame->index = 0;
+        frame->object = object;
+    }
+
+    void PopFrame() {
+        if (skip_ > 0)
+            --skip_;
+        else {
+            const SizeType begin = frames_.template Pop<Frame>(1)->begin;
+            candidates_.template Pop<SizeType>(CandidateCount() - begin);
+        }
+        --depth_;
+    }
+
+    static const size_t kDefaultStackCapacity = 256;    //!< Default capacity in bytes of the stacks.
+    const PointerType* paths_;
+    SizeType pathCount_;
+    OutputHandler& handler_;
+    internal::Stack<StackAllocator> frames_;        //!< Objects and arrays in which candidate pointers continue.
+    internal::Stack<StackAllocator> candidates_;    //!< Indices of the pointers matching the location of the frames and of the current value.
+    internal::Stack<StackAllocator> selections_;    //!< Selections of the values being forwarded.
+    size_t depth_;                                  //!< Number of objects and arrays containing the current event.
+    size_t skip_;                                   //!< Number of objects and arrays skipped, with no candidate inside.
+};
+
+RAPIDJSON_NAMESPACE_END
+
+#endif // RAPIDJSON_PATHFILTER_H_
@@ -0,0 +1,277 @@
+// Tencent is pleased to support the open source community by making RapidJSON available.
+//
+// Copyright (C) 2015 THL A29 Limited, a Tencent company, and Milo Yip. All rights reserved.
+//
+// Licensed under the MIT License (the "License"); you may not use this file except
+// in compliance with the License. You may obtain a copy of the License at
+//
+// http://opensource.org/licenses/MIT
+//
+// Unless required by applicable law or agreed to in writing, software distributed
+// under the License is distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR
+// CONDITIONS OF ANY KIND, either express or implied. See the License for the
+// specific language governing permissions and limitations under the License.
+
+#ifndef RAPIDJSON_PUSHREADER_H_
+#define RAPIDJSON_PUSHREADER_H_
+
+/*! \file pushreader.h */
+
+#include "reader.h"
+
+RAPIDJSON_NAMESPACE_BEGIN
+
+//! SAX-style JSON parser fed with the chunks of a JSON text as they arrive.
+/*! GenericPushReader parses a JSON text received in chunks of any size, e.g.
+    the buffers of a network stream, without waiting for the whole text.
+    Each call to Feed() sends the events of the tokens completed by the chunk
+    to the handler, and keeps the incomplete token at the end of the chunk
+    (a string, a number or a literal split across chunks) until the next one.
+
+    The parsing is made by the state table of \ref kParseIterativeFlag
+    (see GenericReader::IterativeParseNext()), so the depth of the JSON text
+    does not use the call stack, and only the incomplete token is buffered.
+
+    \code
+    rapidjson::PushReader reader;
+    MyHandler handler;
+    concurrency::streams::istream body = response.body(); // web::http::http_response
+    char buffer[4096];
+    size_t length;
+    while ((length = body.streambuf().getn(reinterpret_cast<uint8_t*>(buffer), sizeof(buffer)).get()) > 0)
+        if (!reader.Feed<rapidjson::kParseDefaultFlags>(buffer, length, handler))
+            break;
+    if (!reader.Finish<rapidjson::kParseDefaultFlags>(handler))
+        std::cerr << GetParseError_En(reader.GetParseErrorCode()) << " at " << reader.GetErrorOffset();
+    \endcode
+
+    \tparam SourceEncoding Encoding of the chunks.
+    \tparam TargetEncoding Encoding of the parse output.
+    \tparam StackAllocator Allocator type for the parsing stack and the buffer of the incomplete token.
+    \note The strings sent to the handler are always copies (\c copy is \c true):
+        \ref kParseInsituFlag is not supported.
+*/
+template <typename SourceEncoding, typename TargetEncoding, typename StackAllocator = CrtAllocator>
+class GenericPushReader {
+public:
+    typedef typename SourceEncoding::Ch Ch; //!< SourceEncoding character type
+
+    //! Constructor.
+    /*! \param stackAllocator Optional allocator for allocating stack memory.
+        \param stackCapacity Initial capacity in bytes of the parsing stack and of the buffer of the incomplete token.
+    */
+    GenericPushReader(StackAllocator* stackAllocator = 0, size_t stackCapacity = kDefaultStackCapacity) :
+        reader_(stackAllocator, stackCapacity), buffer_(stackAllocator, stackCapacity), parseResult_(), offset_(0), resume_(0), done_(false)
+    {
+        Reset();
+    }
+
+    //! Start the parsing of a new JSON text.
+    void Reset() {
+        reader_.IterativeParseInit();
+        buffer_.Clear();
+        *buffer_.template Push<Ch>() = '\0';
+        parseResult_.Clear();
+        offset_ = 0;
+        resume_ = 0;
+        done_ = false;
+    }
+
+    //! Parse the next chunk of the JSON text.
+    /*! \tparam parseFlags Combination of \ref ParseFlag (must not contain \ref kParseInsituFlag).
+        \tparam Handler Type of handler, implementing Handler concept.
+        \param chunk Characters of the chunk, which does not need to be null-terminated.
+        \param length Number of characters of the chunk.
+        \param handler The handler to receive the events of the tokens completed by the chunk.
+        \return Whether the JSON text is valid so far.
+    */
+    template <unsigned parseFlags, typename Handler>
+    bool Feed(const Ch* chunk, size_t length, Handler& handler) {
+        RAPIDJSON_ASSERT(!(parseFlags & kParseInsituFlag));
+        if (parseResult_.IsError())
+            return false;
+        if (done_)
+            return true;    // Rest of the text after the root with kParseStopWhenDoneFlag
+
+        // Append the chunk to the incomplete token, before the null terminator
+        buffer_.template Pop<Ch>(1);
+        std::memcpy(buffer_.template Push<Ch>(length), chunk, length * sizeof(Ch));
+        *buffer_.template Push<Ch>() = '\0';
+        return ParseBuffer<parseFlags>(handler, false);
+    }
+
+    //! Parse the next chunk of the JSON text (with \ref kParseDefaultFlags)
+    template <typename Handler>
+    bool Feed(const Ch* chunk, size_t length, Handler& handler) {
+        return Feed<kParseDefaultFlags>(chunk, length, handler);
+    }
+
+    //! End the JSON text, parsing its last token.
+    /*! \tparam parseFlags Combination of \ref ParseFlag, the same as for Feed().
+        \tparam Handler Type of handler, implementing Handler concept.
+        \param handler The handler to receive the events of the last token.
+        \return Whether the JSON text is valid and complete.
+    */
+    template <unsigned parseFlags, typename Handler>
+    bool Finish(Handler& handler) {
+        if (parseResult_.IsError())
+            return false;
+        if (done_)
+            return true;
+        return ParseBuffer<parseFlags>(handler, true);
+    }
+
+    //! End the JSON text (with \ref kParseDefaultFlags)
+    template <typename Handler>
+    bool Finish(Handler& handler) {
+        return Finish<kParseDefaultFlags>(handler);
+    }
+
+    //! Whether a complete JSON root has been parsed.
+    bool IsComplete() const { return reader_.IterativeParseComplete(); }
+
+    //! Whether a parse error has occured.
+    bool HasParseError() const { return parseResult_.IsError(); }
+
+    //! Get the \ref ParseErrorCode of the parse error.
+    ParseErrorCode GetParseErrorCode() const { return parseResult_.Code(); }
+
+    //! Get the position of the parse error in the whole JSON text, 0 otherwise.
+    size_t GetErrorOffset() const { return parseResult_.Offset(); }
+
+private:
+    // Prohibit copy constructor & assignment operator.
+    GenericPushReader(const GenericPushReader&);
+    GenericPushReader& operator=(const GenericPushReader&);
+
+    // Parse the complete tokens of the buffer, then keep only its incomplete token.
+    template <unsigned parseFlags, typename Handler>
+    bool ParseBuffer(Handler& handler, bool last) {
+        Ch* const begin = buffer_.template Bottom<Ch>();
+        const Ch* const end = buffer_.template Top<Ch>();   // Null terminator
+        GenericStringStream<SourceEncoding> is(begin);
+
+        for (;;) {
+            SkipWhitespace(is);
+            const Ch* p = begin + is.Tell();
+            if (p == end)
+                break;
+
+            if (reader_.IterativeParseComplete()) {
+                if (parseFlags & kParseStopWhenDoneFlag) {
+                    done_ = true;
+                    break;
+                }
+                parseResult_.Set(kParseErrorDocumentRootNotSingular, offset_ + is.Tell());
+                return false;
+            }
+
+            // At the end of the text, the null terminator ends the last token
+            if (!last && !IsTokenComplete(p, end))
+                break;
+            resume_ = 0;
+
+            if (!reader_.template IterativeParseNext<parseFlags>(is, handler)) {
+                parseResult_.Set(reader_.GetParseErrorCode(), offset_ + reader_.GetErrorOffset());
+                return false;
+            }
+        }
+
+        // Handle the end of file.
+        if (last && !done_ && !reader_.template IterativeParseNext<parseFlags>(is, handler)) {
+            parseResult_.Set(reader_.GetParseErrorCode(), offset_ + reader_.GetErrorOffset());
+            return false;
+        }
+
+        // Drop the parsed characters, keeping the incomplete token and the null terminator
+        const size_t parsed = is.Tell();
+        if (parsed != 0) {
+            const size_t remaining = static_cast<size_t>(end - (begin + parsed));
+            std::memmove(begin, begin + parsed, (remaining + 1) * sizeof(Ch));
+            buffer_.template Pop<Ch>(parsed);
+            offset_ += parsed;
+        }
+        return true;
+    }
+
+    // Whether the buffer holds the whole token starting at p, or enough of it for the parser to report an error.
+    bool IsTokenComplete(const Ch* p, const Ch* end) {
+        switch (p[0]) {
+        case '{':
+        case '}':
+        case '[':
+        case ']':
+        case ',':
+        case ':':  return true;
+        case '"':  return IsStringComplete(p, end);
+        case 't':  return IsLiteralComplete(p, end, "true");
+        case 'f':  return IsLiteralComplete(p, end, "false");
+        case 'n':  return IsLiteralComplete(p, end, "null");
+        default:
+            // A number needs the character after it, unlike an invalid character
+            if (p[0] != '-' && (p[0] < '0' || p[0] > '9'))
+                return true;
+            for (++p; p != end; ++p)
+                if (!((*p >= '0' && *p <= '9') || *p == '.' || *p == 'e' || *p == 'E' || *p == '+' || *p == '-'))
+                    return true;
+            return false;
+        }
+    }
+
+    // A string is complete with its closing quotation mark, or a control character.
+    // The incomplete string at the bottom of the buffer is scanned again from where the previous chunk ended.
+    bool IsStringComplete(const Ch* begin, const Ch* end) {
+        const Ch* p = begin + (begin == buffer_.template Bottom<Ch>() && resume_ > 1 ? resume_ : 1);
+        for (; p != end; ++p) {
+            p = SkipUnescapedString(p);
+            if (p == end)
+                break;
+            if (*p == '\\') {
+                if (p + 1 == end)
+                    break;  // Escaped character in the next chunk
+                ++p;
+            }
+            else if (*p == '"' || static_cast<unsigned>(*p) < 0x20)
+                return true;
+        }
+        resume_ = static_cast<size_t>(p - begin);
+        return false;
+    }
+
+    // Skip the characters which need no escaping. The buffer is null-terminated.
+    template <typename T>
+    static const T* SkipUnescapedString(const T* p) {
+        return p;
+    }
+
+#ifdef RAPIDJSON_SIMD
+    static const char* SkipUnescapedString(const char* p) {
+        return internal::ScanUnescapedString(p);
+    }
+#endif
+
+    static bool IsLiteralComplete(const Ch* p, const Ch* end, const char* literal) {
+        for (; *literal != '\0'; ++p, ++literal) {
+            if (p == end)
+                return false;
+            if (*p != static_cast<Ch>(*literal))
+                return true;    // Invalid value
+        }
+        return true;
+    }
+
+    static const size_t kDefaultStackCapacity = 256;    //!< Default capacity in bytes of the stacks.
+    GenericReader<SourceEncoding, TargetEncoding, StackAllocator> reader_;  //!< Parser keeping the state between the chunks.
+    internal::Stack<StackAllocator> buffer_;    //!< Incomplete token followed by the current chunk, null-terminated.
+    ParseResult parseResult_;   //!< Parse error, with its offset in the whole text.
+    size_t offset_;             //!< Offset in the whole text of the bottom of the buffer.
+    size_t resume_;             //!< Offset of the end of the scan of the incomplete string at the bottom of the buffer.
+    bool done_;                 //!< Whether the rest of the text is ignored, with kParseStopWhenDoneFlag.
+};
+
+//! Push reader with UTF8 encoding and default allocator.
+typedef GenericPushReader<UTF8<>, UTF8<> > PushReader;
+
+RAPIDJSON_NAMESPACE_END
+
+#endif // RAPIDJSON_PUSHREADER_H_
@@ -262,30 +262,42 @@
 #endif
 
 ///////////////////////////////////////////////////////////////////////////////
-// RAPIDJSON_SSE2/RAPIDJSON_SSE42/RAPIDJSON_SIMD
+// RAPIDJSON_SSE2/RAPIDJSON_SSE42/RAPIDJSON_AVX2/RAPIDJSON_SIMD
 
 /*! \def RAPIDJSON_SIMD
     \ingroup RAPIDJSON_CONFIG
-    \brief Enable SSE2/SSE4.2 optimization.
+    \brief Enable SSE2/SSE4.2/AVX2 optimization.
 
-    RapidJSON supports optimized implementations for some parsing operations
-    based on the SSE2 or SSE4.2 SIMD extensions on modern Intel-compatible
-    processors.
+    RapidJSON supports optimized implementations for some parsing and
+    generating operations based on the SSE2, SSE4.2 or AVX2 SIMD extensions
+    on modern Intel-compatible processors: skipping whitespace, and scanning
+    the unescaped characters of strings in Reader (in-situ and copying
+    parsing of \ref StringStream) and in Writer (to a \ref StringBuffer).
 
-    To enable these optimizations, two different symbols can be defined;
+    To enable these optimizations, three different symbols can be defined;
     \code
     // Enable SSE2 optimization.
     #define RAPIDJSON_SSE2
 
     // Enable SSE4.2 optimization.
     #define RAPIDJSON_SSE42
+
+    // Enable AVX2 optimization (also enables SSE4.2).
+    #define RAPIDJSON_AVX2
     \endcode
 
-    \c RAPIDJSON_SSE42 takes precedence, if both are defined.
+    \c RAPIDJSON_AVX2 takes precedence over \c RAPIDJSON_SSE42, which takes
+    precedence over \c RAPIDJSON_SSE2. The instruction set is selected at
+    compile time: the code must be compiled for a target supporting it
+    (e.g. \c -msse4.2 or \c -mavx2 with GCC and Clang).
 
     If any of these symbols is defined, RapidJSON defines the macro
     \c RAPIDJSON_SIMD to indicate the availability of the optimized code.
 */
+#if defined(RAPIDJSON_AVX2) && !defined(RAPIDJSON_SSE42)
+#define RAPIDJSON_SSE42
+#endif
+
 #if defined(RAPIDJSON_SSE2) || defined(RAPIDJSON_SSE42) \
     || defined(RAPIDJSON_DOXYGEN_RUNNING)
 #define RAPIDJSON_SIMD
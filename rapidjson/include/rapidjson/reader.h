@@ -22,6 +22,7 @@
 #include "internal/meta.h"
 #include "internal/stack.h"
 #include "internal/strtod.h"
+#include "internal/simd.h"
 
 #if defined(RAPIDJSON_SIMD) && defined(_MSC_VER)
 #include <intrin.h>
@@ -379,7 +380,7 @@ public:
     /*! \param stackAllocator Optional allocator for allocating stack memory. (Only use for non-destructive parsing)
         \param stackCapacity stack capacity in bytes for storing a single decoded string.  (Only use for non-destructive parsing)
     */
-    GenericReader(StackAllocator* stackAllocator = 0, size_t stackCapacity = kDefaultStackCapacity) : stack_(stackAllocator, stackCapacity), parseResult_() {}
+    GenericReader(StackAllocator* stackAllocator = 0, size_t stackCapacity = kDefaultStackCapacity) : stack_(stackAllocator, stackCapacity), parseResult_(), state_(IterativeParsingStartState) {}
 
     //! Parse JSON text.
     /*! \tparam parseFlags Combination of \ref ParseFlag.
@@ -433,6 +434,55 @@ public:
         return Parse<kParseDefaultFlags>(is, handler);
     }
 
+    //! Initialize the parsing of a JSON text token by token with IterativeParseNext().
+    void IterativeParseInit() {
+        parseResult_.Clear();
+        stack_.Clear();
+        state_ = IterativeParsingStartState;
+    }
+
+    //! Parse the next token of a JSON text, with the state table of \ref kParseIterativeFlag.
+    /*! The state of the parsing is kept between calls, so the stream can be a
+        different one for each token, e.g. a new buffer of a network stream,
+        as long as it contains the whole token.
+        \tparam parseFlags Combination of \ref ParseFlag.
+        \tparam InputStream Type of input stream, implementing Stream concept.
+        \tparam Handler Type of handler, implementing Handler concept.
+        \param is Input stream starting with the token, or with whitespaces before it.
+            The end of the stream (a null character) is the end of the JSON text.
+        \param handler The handler to receive the event of the token, if any.
+        \return Whether the token is valid, or at the end of the stream, whether the JSON text is complete.
+        \note IterativeParseInit() must be called first.
+    */
+    template <unsigned parseFlags, typename InputStream, typename Handler>
+    bool IterativeParseNext(InputStream& is, Handler& handler) {
+        if (HasParseError())
+            return false;
+
+        SkipWhitespace(is);
+        if (is.Peek() == '\0') {
+            // Handle the end of file.
+            if (state_ != IterativeParsingFinishState) {
+                HandleError(state_, is);
+                return false;
+            }
+            return true;
+        }
+
+        Token t = Tokenize(is.Peek());
+        IterativeParsingState n = Predict(state_, t);
+        IterativeParsingState d = Transit<parseFlags>(state_, t, n, is, handler);
+        if (d == IterativeParsingErrorState) {
+            HandleError(state_, is);
+            return false;
+        }
+        state_ = d;
+        return true;
+    }
+
+    //! Whether IterativeParseNext() has parsed a complete JSON root.
+    bool IterativeParseComplete() const { return state_ == IterativeParsingFinishState; }
+
     //! Whether a parse error has occured in the last parsing.
     bool HasParseError() const { return parseResult_.IsError(); }
     
@@ -619,6 +669,10 @@ private:
             *stack_.template Push<Ch>() = c;
             ++length_;
         }
+        RAPIDJSON_FORCEINLINE Ch* Push(SizeType count) {
+            length_ += count;
+            return stack_.template Push<Ch>(count);
+        }
         size_t Length() const { return length_; }
         Ch* Pop() {
             return stack_.template Pop<Ch>(length_);
@@ -680,6 +734,10 @@ private:
         is.Take();  // Skip '\"'
 
         for (;;) {
+            // Copy the run of unescaped characters at once when they need neither validation nor transcoding
+            if (!(parseFlags & kParseValidateEncodingFlag) && internal::IsSame<SEncoding, TEncoding>::Value)
+                ScanCopyUnescapedString(is, os);
+
             Ch c = is.Peek();
             if (c == '\\') {    // Escape
                 is.Take();
@@ -723,6 +781,38 @@ private:
         }
     }
 
+    //! Copy the characters which need no escaping from the input to the output stream.
+    /*! The generic version copies nothing, leaving each character to the loop of ParseStringToStream().
+        \note This function has SSE2/SSE4.2/AVX2 overloads for StringStream and InsituStringStream.
+    */
+    template<typename InputStream, typename OutputStream>
+    static RAPIDJSON_FORCEINLINE void ScanCopyUnescapedString(InputStream&, OutputStream&) {
+    }
+
+#ifdef RAPIDJSON_SIMD
+    static RAPIDJSON_FORCEINLINE void ScanCopyUnescapedString(StringStream& is, StackStream<char>& os) {
+        const char* p = is.src_;
+        const char* q = internal::ScanUnescapedString(p);
+        const SizeType n = static_cast<SizeType>(q - p);
+        if (n != 0) {
+            std::memcpy(os.Push(n), p, n);
+            is.src_ = q;
+        }
+    }
+
+    static RAPIDJSON_FORCEINLINE void ScanCopyUnescapedString(InsituStringStream& is, InsituStringStream& os) {
+        char* p = is.src_;
+        char* q = const_cast<char*>(internal::ScanUnescapedString(p));
+        const size_t n = static_cast<size_t>(q - p);
+        if (n != 0) {
+            if (os.dst_ != p) // No escape before, the string is already in place
+                std::memmove(os.dst_, p, n);
+            os.dst_ += n;
+            is.src_ = q;
+        }
+    }
+#endif // RAPIDJSON_SIMD
+
     template<typename InputStream, bool backup>
     class NumberStream;
 
@@ -1434,6 +1524,7 @@ private:
     static const size_t kDefaultStackCapacity = 256;    //!< Default stack capacity in bytes for storing a single decoded string.
     internal::Stack<StackAllocator> stack_;  //!< A stack for storing decoded string temporarily during non-destructive parsing.
     ParseResult parseResult_;
+    IterativeParsingState state_;           //!< State of the token by token parsing.
 }; // class GenericReader
 
 //! Reader with UTF8 encoding and default allocator.
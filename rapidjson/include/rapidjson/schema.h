@@ -0,0 +1,1902 @@
+// Tencent is pleased to support the open source community by making RapidJSON available.
+//
+// Copyright (C) 2015 THL A29 Limited, a Tencent company, and Milo Yip. All rights reserved.
+//
+// Licensed under the MIT License (the "License"); you may not use this file except
+// in compliance with the License. You may obtain a copy of the License at
+//
+// http://opensource.org/licenses/MIT
+//
+// Unless required by applicable law or agreed to in writing, software distributed
+// under the License is distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR
+// CONDITIONS OF ANY KIND, either express or implied. See the License for the
+// specific language governing permissions and limitations under the License.
+
+#ifndef RAPIDJSON_SCHEMA_H_
+#define RAPIDJSON_SCHEMA_H_
+
+/*! \file schema.h
+    \brief JSON Schema (draft-04) validation while parsing.
+*/
+
+#include "document.h"
+#include "pointer.h"
+#include "reader.h"
+#include "internal/itoa.h"
+#include <cmath> // abs, floor
+
+///////////////////////////////////////////////////////////////////////////////
+// RAPIDJSON_SCHEMA_USE_STDREGEX
+
+#ifndef RAPIDJSON_SCHEMA_USE_STDREGEX
+#if __cplusplus >= 201103L || (defined(_MSC_VER) && _MSC_VER >= 1800)
+#define RAPIDJSON_SCHEMA_USE_STDREGEX 1 // std::regex of C++11
+#else
+#define RAPIDJSON_SCHEMA_USE_STDREGEX 0
+#endif
+/*! \def RAPIDJSON_SCHEMA_USE_STDREGEX
+    \ingroup RAPIDJSON_CONFIG
+    \brief Enable the "pattern" and "patternProperties" keywords of JSON Schema with \c std::regex.
+
+    By default, it is enabled when the compiler supports C++11. Otherwise
+    these keywords are ignored, as the unknown keywords.
+*/
+#endif // !defined(RAPIDJSON_SCHEMA_USE_STDREGEX)
+
+#if RAPIDJSON_SCHEMA_USE_STDREGEX
+#include <regex>
+#endif
+
+RAPIDJSON_NAMESPACE_BEGIN
+
+template <typename ValueT, typename Allocator>
+class GenericSchemaDocument;
+
+template <typename SchemaDocumentType, typename OutputHandler, typename StateAllocator>
+class GenericSchemaValidator;
+
+namespace internal {
+
+//! Record the failed keyword in the context of the value and return false.
+#define RAPIDJSON_INVALID_KEYWORD_RETURN(keyword)\
+RAPIDJSON_MULTILINEMACRO_BEGIN\
+    context.invalidKeyword = keyword;\
+    return false;\
+RAPIDJSON_MULTILINEMACRO_END
+
+///////////////////////////////////////////////////////////////////////////////
+// Hasher
+
+//! SAX handler computing a hash of a JSON value.
+/*! Equal values have the same hash: the members of objects are hashed in any
+    order, and the numbers by their value (e.g. 1 and 1.0 are equal).
+    Different values may have the same hash too: the 64-bit FNV-1a hash is not
+    collision resistant, and values can be crafted to collide.
+*/
+template <typename Encoding, typename Allocator>
+class Hasher {
+public:
+    typedef typename Encoding::Ch Ch;
+
+    Hasher(Allocator* allocator = 0, size_t stackCapacity = kDefaultSize) : stack_(allocator, stackCapacity) {}
+
+    bool Null() { return WriteType(kNullType); }
+    bool Bool(bool b) { return WriteType(b ? kTrueType : kFalseType); }
+    bool Int(int i) { return Int64(i); }
+    bool Uint(unsigned u) { return Uint64(u); }
+    bool Int64(int64_t i) { return i >= 0 ? Uint64(static_cast<uint64_t>(i)) : WriteNumber(kNegativeTag, static_cast<uint64_t>(i)); }
+    bool Uint64(uint64_t u) { return WriteNumber(kNumberType, u); }
+    bool Double(double d) {
+        // Integral values are hashed as the integers
+        if (d >= 0.0 && d < 18446744073709551616.0 && d == std::floor(d))
+            return Uint64(static_cast<uint64_t>(d));
+        if (d < 0.0 && d >= -9223372036854775808.0 && d == std::floor(d))
+            return Int64(static_cast<int64_t>(d));
+        uint64_t bits;
+        std::memcpy(&bits, &d, sizeof(bits));
+        return WriteNumber(kDoubleTag, bits);
+    }
+    bool String(const Ch* str, SizeType len, bool) { return WriteBuffer(kStringType, str, len * sizeof(Ch)); }
+    bool StartObject() { return true; }
+    bool Key(const Ch* str, SizeType len, bool copy) { return String(str, len, copy); }
+    bool EndObject(SizeType memberCount) {
+        uint64_t h = Hash(0, kObjectType);
+        uint64_t* kv = stack_.template Pop<uint64_t>(memberCount * 2);
+        for (SizeType i = 0; i < memberCount; i++)
+            h += Hash(Hash(0, kv[i * 2]), kv[i * 2 + 1]);  // Use sum to achieve member order insensitive, name and value order sensitive; unlike xor, duplicate members do not cancel out
+        *stack_.template Push<uint64_t>() = h;
+        return true;
+    }
+    bool StartArray() { return true; }
+    bool EndArray(SizeType elementCount) {
+        uint64_t h = Hash(0, kArrayType);
+        uint64_t* e = stack_.template Pop<uint64_t>(elementCount);
+        for (SizeType i = 0; i < elementCount; i++)
+            h = Hash(h, e[i]); // Use hash to achieve element order sensitive
+        *stack_.template Push<uint64_t>() = h;
+        return true;
+    }
+
+    //! Prepare the hasher for a new value.
+    void Reset() { stack_.Clear(); }
+
+    //! Whether a complete value has been hashed.
+    bool IsValid() const { return stack_.GetSize() == sizeof(uint64_t); }
+
+    uint64_t GetHashCode() {
+        RAPIDJSON_ASSERT(IsValid());
+        return *stack_.template Top<uint64_t>();
+    }
+
+private:
+    static const size_t kDefaultSize = 256;
+    static const unsigned kNegativeTag = kNumberType + 1;   //!< Tag of negative integers, after the \ref Type values.
+    static const unsigned kDoubleTag = kNumberType + 2;     //!< Tag of non-integral numbers.
+
+    bool WriteType(unsigned type) { return WriteBuffer(type, 0, 0); }
+
+    bool WriteNumber(unsigned tag, uint64_t n) { return WriteBuffer(tag, &n, sizeof(n)); }
+
+    bool WriteBuffer(unsigned type, const void* data, size_t len) {
+        // FNV-1a from http://isthe.com/chongo/tech/comp/fnv/
+        uint64_t h = Hash(RAPIDJSON_UINT64_C2(0x84222325, 0xcbf29ce4), type);
+        const unsigned char* d = static_cast<const unsigned char*>(data);
+        for (size_t i = 0; i < len; i++)
+            h = Hash(h, d[i]);
+        *stack_.template Push<uint64_t>() = h;
+        return true;
+    }
+
+    static uint64_t Hash(uint64_t h, uint64_t d) {
+        static const uint64_t kPrime = RAPIDJSON_UINT64_C2(0x00000100, 0x000001b3);
+        h ^= d;
+        h *= kPrime;
+        return h;
+    }
+
+    Stack<Allocator> stack_;
+};
+
+///////////////////////////////////////////////////////////////////////////////
+// Schema
+
+//! Types of JSON Schema, as bits of Schema::type_.
+enum SchemaValueType {
+    kNullSchemaType,
+    kBooleanSchemaType,
+    kObjectSchemaType,
+    kArraySchemaType,
+    kStringSchemaType,
+    kNumberSchemaType,
+    kIntegerSchemaType,
+    kTotalSchemaType
+};
+
+//! Validation state of a value, on the stack of the validator.
+template <typename SchemaType, typename ValidatorType, typename HasherType>
+struct SchemaValidationContext {
+    SchemaValidationContext(const SchemaType* s) :
+        schema(s), valueSchema(), invalidKeyword(), hasher(), validators(), validatorCount(), patternSchemas(), patternSchemaCount(),
+        propertyExist(), arrayElementHashes(), arrayElementHashCount(), arrayElementIndex(), documentPathSize(), inArray(), arrayUniqueness(), valueUniqueness() {}
+
+    const SchemaType* schema;           //!< Schema of this value.
+    const SchemaType* valueSchema;      //!< Schema of the value of the current member of an object.
+    const char* invalidKeyword;         //!< Keyword of the failed validation.
+    HasherType* hasher;                 //!< Hash of this value, for "enum" or the "uniqueItems" of its array.
+    ValidatorType** validators;         //!< Validators of the subschemas of this value, then of its matching "patternProperties".
+    SizeType validatorCount;
+    const SchemaType** patternSchemas;  //!< Schemas of "patternProperties" matching the name of the current member.
+    SizeType patternSchemaCount;
+    bool* propertyExist;                //!< Whether each property of the schema is a member of this object.
+    uint64_t* arrayElementHashes;       //!< Hashes of the elements of this array, for "uniqueItems".
+    SizeType arrayElementHashCount;
+    SizeType arrayElementIndex;         //!< Index of the next element of this array.
+    size_t documentPathSize;            //!< Size of the names of the members containing this value, in the validator.
+    bool inArray;                       //!< Whether this value is an array, whose children are elements.
+    bool arrayUniqueness;               //!< Whether the elements of this array must be unique.
+    bool valueUniqueness;               //!< Whether this value is an element of an array with unique elements.
+};
+
+//! Compiled JSON Schema of a value, with its subschemas resolved.
+template <typename SchemaDocumentType>
+class Schema {
+public:
+    typedef typename SchemaDocumentType::ValueType ValueType;
+    typedef typename SchemaDocumentType::AllocatorType AllocatorType;
+    typedef typename SchemaDocumentType::PointerType PointerType;
+    typedef typename ValueType::EncodingType EncodingType;
+    typedef typename EncodingType::Ch Ch;
+    typedef Schema<SchemaDocumentType> SchemaType;
+    typedef GenericValue<EncodingType, AllocatorType> SValue;
+
+    Schema(SchemaDocumentType* document, const ValueType& value, AllocatorType* allocator) :
+        allocator_(allocator),
+        typeless_(document->GetTypeless() ? document->GetTypeless() : this), // The typeless schema is the first one
+        pointer_(),
+        pointerLength_(),
+        type_((1 << kTotalSchemaType) - 1), // typeless
+        enum_(),
+        enumCount_(),
+        const_(),
+        validatorSchemas_(),
+        validatorCount_(),
+        allOf_(),
+        anyOf_(),
+        oneOf_(),
+        notIndex_(kNoValidator),
+        properties_(),
+        propertyCount_(),
+        additionalPropertiesSchema_(),
+        hasRequired_(),
+        hasDependencies_(),
+        additionalProperties_(true),
+#if RAPIDJSON_SCHEMA_USE_STDREGEX
+        patternProperties_(),
+        patternPropertyCount_(),
+        pattern_(),
+#endif
+        minProperties_(),
+        maxProperties_(SizeType(~0)),
+        itemsList_(),
+        itemsTuple_(),
+        itemsTupleCount_(),
+        additionalItemsSchema_(),
+        additionalItems_(true),
+        uniqueItems_(false),
+        minItems_(),
+        maxItems_(SizeType(~0)),
+        minLength_(0),
+        maxLength_(SizeType(~0)),
+        minimum_(),
+        maximum_(),
+        multipleOf_(),
+        hasMinimum_(),
+        hasMaximum_(),
+        exclusiveMinimum_(),
+        exclusiveMaximum_(),
+        hasMultipleOf_(),
+        integralMultipleOf_()
+    {
+        // JSON pointer of the schema, for error reports
+        pointerLength_ = document->GetPathLength();
+        pointer_ = static_cast<Ch*>(allocator_->Malloc((pointerLength_ + 1) * sizeof(Ch)));
+        if (pointerLength_ > 0)
+            std::memcpy(pointer_, document->GetPath(), pointerLength_ * sizeof(Ch));
+        pointer_[pointerLength_] = '\0';
+
+        // Boolean schemas of later drafts: true accepts any value, false none
+        if (value.IsBool()) {
+            if (!value.GetBool())
+                type_ = 0;
+            return;
+        }
+        if (!value.IsObject())
+            return;
+
+        if (const ValueType* v = GetMember(value, "type")) {
+            type_ = 0;
+            if (v->IsString())
+                AddType(*v);
+            else if (v->IsArray())
+                for (typename ValueType::ConstValueIterator itr = v->Begin(); itr != v->End(); ++itr)
+                    AddType(*itr);
+        }
+
+        // The values of "enum" and "const" are kept as their hashes only (see Hasher about the collisions)
+        if (const ValueType* v = GetMember(value, "enum"))
+            if (v->IsArray() && v->Size() > 0) {
+                enum_ = static_cast<uint64_t*>(allocator_->Malloc(sizeof(uint64_t) * v->Size()));
+                for (typename ValueType::ConstValueIterator itr = v->Begin(); itr != v->End(); ++itr)
+                    enum_[enumCount_++] = HashValue(*itr);
+            }
+        if (const ValueType* v = GetMember(value, "const")) {
+            allocator_->Free(enum_);
+            enum_ = static_cast<uint64_t*>(allocator_->Malloc(sizeof(uint64_t)));
+            enum_[0] = HashValue(*v);
+            enumCount_ = 1;
+            const_ = true;
+        }
+
+        // Subschemas validated in parallel: allOf, anyOf, oneOf, not, then the schemas of dependencies
+        const ValueType* allOf = GetMember(value, "allOf");
+        const ValueType* anyOf = GetMember(value, "anyOf");
+        const ValueType* oneOf = GetMember(value, "oneOf");
+        const ValueType* notSchema = GetMember(value, "not");
+        const ValueType* dependencies = GetMember(value, "dependencies");
+        SizeType validatorCount = 0;
+        if (allOf && allOf->IsArray()) validatorCount += allOf->Size();
+        if (anyOf && anyOf->IsArray()) validatorCount += anyOf->Size();
+        if (oneOf && oneOf->IsArray()) validatorCount += oneOf->Size();
+        if (notSchema) validatorCount++;
+        if (dependencies && dependencies->IsObject())
+            validatorCount += dependencies->MemberCount();
+        if (validatorCount > 0)
+            validatorSchemas_ = static_cast<const SchemaType**>(allocator_->Malloc(sizeof(const SchemaType*) * validatorCount));
+
+        AssignIfExist(allOf_, document, allOf, "allOf");
+        AssignIfExist(anyOf_, document, anyOf, "anyOf");
+        AssignIfExist(oneOf_, document, oneOf, "oneOf");
+        if (notSchema) {
+            notIndex_ = validatorCount_;
+            validatorSchemas_[validatorCount_++] = document->CreateSchema(*notSchema, "not");
+        }
+
+        // Object
+        const ValueType* properties = GetMember(value, "properties");
+        const ValueType* required = GetMember(value, "required");
+
+        // Collect the names of properties, required and dependencies
+        SizeType nameCount = 0;
+        if (properties && properties->IsObject())
+            nameCount += properties->MemberCount();
+        if (required && required->IsArray())
+            nameCount += required->Size();
+        if (dependencies && dependencies->IsObject())
+            for (typename ValueType::ConstMemberIterator itr = dependencies->MemberBegin(); itr != dependencies->MemberEnd(); ++itr) {
+                nameCount++;
+                if (itr->value.IsArray())
+                    nameCount += itr->value.Size();
+            }
+
+        if (nameCount > 0) {
+            properties_ = static_cast<Property*>(allocator_->Malloc(sizeof(Property) * nameCount));
+            if (properties && properties->IsObject())
+                for (typename ValueType::ConstMemberIterator itr = properties->MemberBegin(); itr != properties->MemberEnd(); ++itr)
+                    AddProperty(itr->name);
+            if (required && required->IsArray())
+                for (typename ValueType::ConstValueIterator itr = required->Begin(); itr != required->End(); ++itr)
+                    if (itr->IsString())
+                        AddProperty(*itr);
+            if (dependencies && dependencies->IsObject())
+                for (typename ValueType::ConstMemberIterator itr = dependencies->MemberBegin(); itr != dependencies->MemberEnd(); ++itr) {
+                    AddProperty(itr->name);
+                    if (itr->value.IsArray())
+                        for (typename ValueType::ConstValueIterator i = itr->value.Begin(); i != itr->value.End(); ++i)
+                            if (i->IsString())
+                                AddProperty(*i);
+                }
+        }
+
+        if (properties && properties->IsObject())
+            for (typename ValueType::ConstMemberIterator itr = properties->MemberBegin(); itr != properties->MemberEnd(); ++itr) {
+                const SizeType index = FindPropertyIndex(itr->name.GetString(), itr->name.GetStringLength());
+                properties_[index].schema = document->CreateSchema(itr->value, "properties", itr->name.GetString(), itr->name.GetStringLength());
+            }
+
+        if (required && required->IsArray())
+            for (typename ValueType::ConstValueIterator itr = required->Begin(); itr != required->End(); ++itr)
+                if (itr->IsString()) {
+                    properties_[FindPropertyIndex(itr->GetString(), itr->GetStringLength())].required = true;
+                    hasRequired_ = true;
+                }
+
+        if (dependencies && dependencies->IsObject())
+            for (typename ValueType::ConstMemberIterator itr = dependencies->MemberBegin(); itr != dependencies->MemberEnd(); ++itr) {
+                Property& p = properties_[FindPropertyIndex(itr->name.GetString(), itr->name.GetStringLength())];
+                if (itr->value.IsArray()) {
+                    p.dependencies = static_cast<SizeType*>(allocator_->Malloc(sizeof(SizeType) * itr->value.Size()));
+                    for (typename ValueType::ConstValueIterator i = itr->value.Begin(); i != itr->value.End(); ++i)
+                        if (i->IsString())
+                            p.dependencies[p.dependencyCount++] = FindPropertyIndex(i->GetString(), i->GetStringLength());
+                    hasDependencies_ = true;
+                }
+                else if (itr->value.IsObject() || itr->value.IsBool()) {
+                    p.dependenciesValidatorIndex = validatorCount_;
+                    validatorSchemas_[validatorCount_++] = document->CreateSchema(itr->value, "dependencies", itr->name.GetString(), itr->name.GetStringLength());
+                    hasDependencies_ = true;
+                }
+            }
+
+        if (const ValueType* v = GetMember(value, "additionalProperties")) {
+            if (v->IsBool())
+                additionalProperties_ = v->GetBool();
+            else if (v->IsObject())
+                additionalPropertiesSchema_ = document->CreateSchema(*v, "additionalProperties");
+        }
+
+#if RAPIDJSON_SCHEMA_USE_STDREGEX
+        if (const ValueType* v = GetMember(value, "patternProperties"))
+            if (v->IsObject() && v->MemberCount() > 0) {
+                patternProperties_ = static_cast<PatternProperty*>(allocator_->Malloc(sizeof(PatternProperty) * v->MemberCount()));
+                for (typename ValueType::ConstMemberIterator itr = v->MemberBegin(); itr != v->MemberEnd(); ++itr) {
+                    PatternProperty& p = patternProperties_[patternPropertyCount_];
+                    p.pattern = CreatePattern(itr->name);
+                    if (!p.pattern)
+                        continue;   // Invalid regular expression, ignored
+                    p.schema = document->CreateSchema(itr->value, "patternProperties", itr->name.GetString(), itr->name.GetStringLength());
+                    patternPropertyCount_++;
+                }
+            }
+#endif
+
+        AssignIfExist(minProperties_, value, "minProperties");
+        AssignIfExist(maxProperties_, value, "maxProperties");
+
+        // Array
+        if (const ValueType* v = GetMember(value, "items")) {
+            if (v->IsObject() || v->IsBool())
+                itemsList_ = document->CreateSchema(*v, "items");
+            else if (v->IsArray()) {
+                itemsTuple_ = static_cast<const SchemaType**>(allocator_->Malloc(sizeof(const SchemaType*) * v->Size()));
+                for (typename ValueType::ConstValueIterator itr = v->Begin(); itr != v->End(); ++itr, itemsTupleCount_++)
+                    itemsTuple_[itemsTupleCount_] = document->CreateSchema(*itr, "items", itemsTupleCount_);
+            }
+        }
+
+        if (const ValueType* v = GetMember(value, "additionalItems")) {
+            if (v->IsBool())
+                additionalItems_ = v->GetBool();
+            else if (v->IsObject())
+                additionalItemsSchema_ = document->CreateSchema(*v, "additionalItems");
+        }
+
+        AssignIfExist(minItems_, value, "minItems");
+        AssignIfExist(maxItems_, value, "maxItems");
+        AssignIfExist(uniqueItems_, value, "uniqueItems");
+
+        // String
+        AssignIfExist(minLength_, value, "minLength");
+        AssignIfExist(maxLength_, value, "maxLength");
+
+#if RAPIDJSON_SCHEMA_USE_STDREGEX
+        if (const ValueType* v = GetMember(value, "pattern"))
+            if (v->IsString())
+                pattern_ = CreatePattern(*v);
+#endif
+
+        // Number
+        if (const ValueType* v = GetMember(value, "minimum"))
+            if (v->IsNumber()) {
+                minimum_ = v->GetDouble();
+                hasMinimum_ = true;
+            }
+        if (const ValueType* v = GetMember(value, "maximum"))
+            if (v->IsNumber()) {
+                maximum_ = v->GetDouble();
+                hasMaximum_ = true;
+            }
+        if (const ValueType* v = GetMember(value, "exclusiveMinimum")) {
+            if (v->IsBool())
+                exclusiveMinimum_ = v->GetBool();
+            else if (v->IsNumber() && (!hasMinimum_ || v->GetDouble() >= minimum_)) {
+                // Number of later drafts
+                minimum_ = v->GetDouble();
+                hasMinimum_ = exclusiveMinimum_ = true;
+            }
+        }
+        if (const ValueType* v = GetMember(value, "exclusiveMaximum")) {
+            if (v->IsBool())
+                exclusiveMaximum_ = v->GetBool();
+            else if (v->IsNumber() && (!hasMaximum_ || v->GetDouble() <= maximum_)) {
+                maximum_ = v->GetDouble();
+                hasMaximum_ = exclusiveMaximum_ = true;
+            }
+        }
+        if (const ValueType* v = GetMember(value, "multipleOf"))
+            if (v->IsNumber() && v->GetDouble() > 0.0) {
+                multipleOf_ = v->GetDouble();
+                hasMultipleOf_ = true;
+                if (v->IsUint64())
+                    integralMultipleOf_ = v->GetUint64();
+            }
+    }
+
+    ~Schema() {
+        allocator_->Free(pointer_);
+        allocator_->Free(enum_);
+        allocator_->Free(validatorSchemas_);
+        if (properties_) {
+            for (SizeType i = 0; i < propertyCount_; i++)
+                properties_[i].~Property();
+            allocator_->Free(properties_);
+        }
+#if RAPIDJSON_SCHEMA_USE_STDREGEX
+        if (patternProperties_) {
+            for (SizeType i = 0; i < patternPropertyCount_; i++)
+                DestroyPattern(patternProperties_[i].pattern);
+            allocator_->Free(patternProperties_);
+        }
+        DestroyPattern(pattern_);
+#endif
+        allocator_->Free(itemsTuple_);
+    }
+
+    //! JSON pointer of the schema in its document.
+    PointerType GetPointer() const { return PointerType(pointer_, pointerLength_); }
+
+    //!@name Subschemas validated in parallel
+    //!@{
+    SizeType GetValidatorCount() const { return validatorCount_; }
+    const SchemaType* GetValidatorSchema(SizeType i) const { return validatorSchemas_[i]; }
+    //!@}
+
+    //! Whether the schema accepts any value.
+    bool IsTypeless() const { return this == typeless_; }
+
+    //! Whether the value must be hashed, for "enum".
+    bool IsEnum() const { return enum_ != 0; }
+
+    //! Whether the value needs a hash or sub-validators, receiving its events in parallel.
+    bool IsParallel() const { return enum_ != 0 || validatorCount_ > 0; }
+
+    //! Whether an object must record its properties, for "required" and "dependencies".
+    bool IsPropertyTracked() const { return hasRequired_ || hasDependencies_; }
+    SizeType GetPropertyCount() const { return propertyCount_; }
+
+#if RAPIDJSON_SCHEMA_USE_STDREGEX
+    SizeType GetPatternPropertyCount() const { return patternPropertyCount_; }
+#else
+    SizeType GetPatternPropertyCount() const { return 0; }
+#endif
+
+    //! Schema of the next element of an array.
+    template <typename Context>
+    bool GetElementSchema(Context& context, const SchemaType*& schema) const {
+        const SizeType index = context.arrayElementIndex++;
+        if (itemsList_)
+            schema = itemsList_;
+        else if (!itemsTuple_)
+            schema = typeless_;     // "additionalItems" applies only after the tuple of "items"
+        else if (index < itemsTupleCount_)
+            schema = itemsTuple_[index];
+        else if (additionalItemsSchema_)
+            schema = additionalItemsSchema_;
+        else if (additionalItems_)
+            schema = typeless_;
+        else
+            RAPIDJSON_INVALID_KEYWORD_RETURN("additionalItems");
+        return true;
+    }
+
+    template <typename Context>
+    bool EndValue(Context& context) const {
+#if RAPIDJSON_SCHEMA_USE_STDREGEX
+        for (SizeType i = validatorCount_; i < context.validatorCount; i++)
+            if (!context.validators[i]->IsValid())
+                RAPIDJSON_INVALID_KEYWORD_RETURN("patternProperties");
+#endif
+
+        if (enum_) {
+            // Only the hashes are compared, as the value is not stored: a value colliding with one
+            // of the enum is accepted (about 2^-64 for a random value, but a collision can be crafted).
+            const uint64_t h = context.hasher->GetHashCode();
+            SizeType i = 0;
+            while (i < enumCount_ && enum_[i] != h)
+                i++;
+            if (i == enumCount_)
+                RAPIDJSON_INVALID_KEYWORD_RETURN(const_ ? "const" : "enum");
+        }
+
+        for (SizeType i = allOf_.begin; i < allOf_.begin + allOf_.count; i++)
+            if (!context.validators[i]->IsValid())
+                RAPIDJSON_INVALID_KEYWORD_RETURN("allOf");
+
+        if (anyOf_.count > 0) {
+            SizeType i = anyOf_.begin;
+            while (i < anyOf_.begin + anyOf_.count && !context.validators[i]->IsValid())
+                i++;
+            if (i == anyOf_.begin + anyOf_.count)
+                RAPIDJSON_INVALID_KEYWORD_RETURN("anyOf");
+        }
+
+        if (oneOf_.count > 0) {
+            SizeType validCount = 0;
+            for (SizeType i = oneOf_.begin; i < oneOf_.begin + oneOf_.count; i++)
+                if (context.validators[i]->IsValid())
+                    validCount++;
+            if (validCount != 1)
+                RAPIDJSON_INVALID_KEYWORD_RETURN("oneOf");
+        }
+
+        if (notIndex_ != kNoValidator && context.validators[notIndex_]->IsValid())
+            RAPIDJSON_INVALID_KEYWORD_RETURN("not");
+
+        return true;
+    }
+
+    template <typename Context>
+    bool Null(Context& context) const {
+        if (!(type_ & (1 << kNullSchemaType)))
+            RAPIDJSON_INVALID_KEYWORD_RETURN("type");
+        return true;
+    }
+
+    template <typename Context>
+    bool Bool(Context& context, bool) const {
+        if (!(type_ & (1 << kBooleanSchemaType)))
+            RAPIDJSON_INVALID_KEYWORD_RETURN("type");
+        return true;
+    }
+
+    template <typename Context>
+    bool Int(Context& context, int i) const {
+        return CheckInteger(context, static_cast<double>(i), static_cast<uint64_t>(i < 0 ? -static_cast<int64_t>(i) : i));
+    }
+
+    template <typename Context>
+    bool Uint(Context& context, unsigned u) const {
+        return CheckInteger(context, static_cast<double>(u), u);
+    }
+
+    template <typename Context>
+    bool Int64(Context& context, int64_t i) const {
+        return CheckInteger(context, static_cast<double>(i), i < 0 ? ~static_cast<uint64_t>(i) + 1 : static_cast<uint64_t>(i));
+    }
+
+    template <typename Context>
+    bool Uint64(Context& context, uint64_t u) const {
+        return CheckInteger(context, static_cast<double>(u), u);
+    }
+
+    template <typename Context>
+    bool Double(Context& context, double d) const {
+        if (!(type_ & (1 << kNumberSchemaType)))
+            RAPIDJSON_INVALID_KEYWORD_RETURN("type");
+        if (!CheckBounds(context, d))
+            return false;
+        if (hasMultipleOf_) {
+            const double a = std::abs(d);
+            const double q = std::floor(a / multipleOf_);
+            if (a - q * multipleOf_ > 0.0)
+                RAPIDJSON_INVALID_KEYWORD_RETURN("multipleOf");
+        }
+        return true;
+    }
+
+    template <typename Context>
+    bool String(Context& context, const Ch* str, SizeType length, bool) const {
+        if (!(type_ & (1 << kStringSchemaType)))
+            RAPIDJSON_INVALID_KEYWORD_RETURN("type");
+
+        if (minLength_ != 0 || maxLength_ != SizeType(~0)) {
+            SizeType count;
+            if (CountStringCodePoint(str, length, &count)) {
+                if (count < minLength_)
+                    RAPIDJSON_INVALID_KEYWORD_RETURN("minLength");
+                if (count > maxLength_)
+                    RAPIDJSON_INVALID_KEYWORD_RETURN("maxLength");
+            }
+        }
+
+#if RAPIDJSON_SCHEMA_USE_STDREGEX
+        if (pattern_ && !IsPatternMatch(pattern_, str, length))
+            RAPIDJSON_INVALID_KEYWORD_RETURN("pattern");
+#endif
+        return true;
+    }
+
+    template <typename Context>
+    bool StartObject(Context& context) const {
+        if (!(type_ & (1 << kObjectSchemaType)))
+            RAPIDJSON_INVALID_KEYWORD_RETURN("type");
+        return true;
+    }
+
+    template <typename Context>
+    bool Key(Context& context, const Ch* str, SizeType len) const {
+#if RAPIDJSON_SCHEMA_USE_STDREGEX
+        context.patternSchemaCount = 0;
+        for (SizeType i = 0; i < patternPropertyCount_; i++)
+            if (IsPatternMatch(patternProperties_[i].pattern, str, len))
+                context.patternSchemas[context.patternSchemaCount++] = patternProperties_[i].schema;
+        const bool patternMatch = context.patternSchemaCount > 0;
+#else
+        const bool patternMatch = false;
+#endif
+
+        const SizeType index = FindPropertyIndex(str, len);
+        if (index != kNoProperty) {
+            if (context.propertyExist)
+                context.propertyExist[index] = true;
+            if (properties_[index].schema) {
+                context.valueSchema = properties_[index].schema;
+                return true;
+            }
+        }
+
+        if (patternMatch)
+            context.valueSchema = typeless_;
+        else if (additionalPropertiesSchema_)
+            context.valueSchema = additionalPropertiesSchema_;
+        else if (additionalProperties_)
+            context.valueSchema = typeless_;
+        else
+            RAPIDJSON_INVALID_KEYWORD_RETURN("additionalProperties");
+        return true;
+    }
+
+    template <typename Context>
+    bool EndObject(Context& context, SizeType memberCount) const {
+        if (hasRequired_)
+            for (SizeType index = 0; index < propertyCount_; index++)
+                if (properties_[index].required && !context.propertyExist[index])
+                    RAPIDJSON_INVALID_KEYWORD_RETURN("required");
+
+        if (memberCount < minProperties_)
+            RAPIDJSON_INVALID_KEYWORD_RETURN("minProperties");
+
+        if (memberCount > maxProperties_)
+            RAPIDJSON_INVALID_KEYWORD_RETURN("maxProperties");
+
+        if (hasDependencies_) {
+            for (SizeType index = 0; index < propertyCount_; index++) {
+                const Property& p = properties_[index];
+                if (!context.propertyExist[index])
+                    continue;
+                for (SizeType i = 0; i < p.dependencyCount; i++)
+                    if (!context.propertyExist[p.dependencies[i]])
+                        RAPIDJSON_INVALID_KEYWORD_RETURN("dependencies");
+                if (p.dependenciesValidatorIndex != kNoValidator && !context.validators[p.dependenciesValidatorIndex]->IsValid())
+                    RAPIDJSON_INVALID_KEYWORD_RETURN("dependencies");
+            }
+        }
+
+        return true;
+    }
+
+    template <typename Context>
+    bool StartArray(Context& context) const {
+        if (!(type_ & (1 << kArraySchemaType)))
+            RAPIDJSON_INVALID_KEYWORD_RETURN("type");
+        context.inArray = true;
+        context.arrayUniqueness = uniqueItems_;
+        return true;
+    }
+
+    template <typename Context>
+    bool EndArray(Context& context, SizeType elementCount) const {
+        if (elementCount < minItems_)
+            RAPIDJSON_INVALID_KEYWORD_RETURN("minItems");
+
+        if (elementCount > maxItems_)
+            RAPIDJSON_INVALID_KEYWORD_RETURN("maxItems");
+
+        return true;
+    }
+
+private:
+    // Prohibit copy constructor & assignment operator.
+    Schema(const Schema&);
+    Schema& operator=(const Schema&);
+
+    static const SizeType kNoValidator = ~SizeType(0);
+    static const SizeType kNoProperty = ~SizeType(0);
+
+    //! Range of the validators of a keyword in the validators of the context.
+    struct SchemaArray {
+        SchemaArray() : begin(), count() {}
+        SizeType begin;
+        SizeType count;
+    };
+
+    struct Property {
+        Property(const ValueType& n, AllocatorType& allocator) : name(n.GetString(), n.GetStringLength(), allocator), schema(), dependencies(), dependencyCount(), dependenciesValidatorIndex(kNoValidator), required(false) {}
+        ~Property() { AllocatorType::Free(dependencies); }
+
+        SValue name;
+        const SchemaType* schema;               //!< Schema of the value in "properties", or null for a name only in "required" or "dependencies".
+        SizeType* dependencies;                 //!< Indices of the properties required by this one.
+        SizeType dependencyCount;
+        SizeType dependenciesValidatorIndex;    //!< Validator of the schema dependency of this property.
+        bool required;
+    };
+
+#if RAPIDJSON_SCHEMA_USE_STDREGEX
+    typedef std::basic_regex<Ch> RegexType;
+
+    struct PatternProperty {
+        RegexType* pattern;
+        const SchemaType* schema;
+    };
+
+    RegexType* CreatePattern(const ValueType& value) {
+        if (!value.IsString())
+            return 0;
+        RegexType* r = static_cast<RegexType*>(allocator_->Malloc(sizeof(RegexType)));
+        try {
+            return new (r) RegexType(value.GetString(), std::size_t(value.GetStringLength()), std::regex_constants::ECMAScript);
+        }
+        catch (const std::regex_error&) {
+            allocator_->Free(r);
+            return 0;
+        }
+    }
+
+    void DestroyPattern(RegexType* pattern) {
+        if (pattern) {
+            pattern->~RegexType();
+            allocator_->Free(pattern);
+        }
+    }
+
+    static bool IsPatternMatch(const RegexType* pattern, const Ch* str, SizeType length) {
+        std::match_results<const Ch*> r;
+        return std::regex_search(str, str + length, r, *pattern);
+    }
+#endif
+
+    //! Find a keyword in a schema object.
+    static const ValueType* GetMember(const ValueType& value, const char* keyword) {
+        for (typename ValueType::ConstMemberIterator itr = value.MemberBegin(); itr != value.MemberEnd(); ++itr) {
+            if (!itr->name.IsString())
+                continue;
+            const Ch* name = itr->name.GetString();
+            const SizeType length = itr->name.GetStringLength();
+            SizeType i = 0;
+            while (i < length && keyword[i] != '\0' && name[i] == static_cast<Ch>(keyword[i]))
+                i++;
+            if (i == length && keyword[i] == '\0')
+                return &itr->value;
+        }
+        return 0;
+    }
+
+    static void AssignIfExist(bool& out, const ValueType& value, const char* keyword) {
+        if (const ValueType* v = GetMember(value, keyword))
+            if (v->IsBool())
+                out = v->GetBool();
+    }
+
+    static void AssignIfExist(SizeType& out, const ValueType& value, const char* keyword) {
+        if (const ValueType* v = GetMember(value, keyword))
+            if (v->IsUint64() && v->GetUint64() <= SizeType(~0))
+                out = static_cast<SizeType>(v->GetUint64());
+    }
+
+    void AssignIfExist(SchemaArray& out, SchemaDocumentType* document, const ValueType* v, const char* keyword) {
+        if (v && v->IsArray()) {
+            out.begin = validatorCount_;
+            out.count = v->Size();
+            for (SizeType i = 0; i < out.count; i++)
+                validatorSchemas_[validatorCount_++] = document->CreateSchema((*v)[i], keyword, i);
+        }
+    }
+
+    void AddType(const ValueType& type) {
+        if (!type.IsString())
+            return;
+        static const char* const kTypeNames[kTotalSchemaType] = { "null", "boolean", "object", "array", "string", "number", "integer" };
+        for (unsigned t = 0; t < kTotalSchemaType; t++) {
+            const char* name = kTypeNames[t];
+            SizeType i = 0;
+            while (i < type.GetStringLength() && name[i] != '\0' && type.GetString()[i] == static_cast<Ch>(name[i]))
+                i++;
+            if (i == type.GetStringLength() && name[i] == '\0') {
+                type_ |= 1 << t;
+                if (t == kNumberSchemaType)
+                    type_ |= 1 << kIntegerSchemaType;   // Integers are numbers
+            }
+        }
+    }
+
+    uint64_t HashValue(const ValueType& value) {
+        Hasher<EncodingType, AllocatorType> hasher(allocator_);
+        value.Accept(hasher);
+        return hasher.GetHashCode();
+    }
+
+    void AddProperty(const ValueType& name) {
+        if (FindPropertyIndex(name.GetString(), name.GetStringLength()) == kNoProperty)
+            new (&properties_[propertyCount_++]) Property(name, *allocator_);
+    }
+
+    SizeType FindPropertyIndex(const Ch* str, SizeType length) const {
+        for (SizeType index = 0; index < propertyCount_; index++) {
+            const SValue& name = properties_[index].name;
+            if (name.GetStringLength() == length && std::memcmp(name.GetString(), str, sizeof(Ch) * length) == 0)
+                return index;
+        }
+        return kNoProperty;
+    }
+
+    template <typename Context>
+    bool CheckInteger(Context& context, double d, uint64_t magnitude) const {
+        if (!(type_ & (1 << kIntegerSchemaType)))
+            RAPIDJSON_INVALID_KEYWORD_RETURN("type");
+        if (!CheckBounds(context, d))
+            return false;
+        if (hasMultipleOf_) {
+            if (integralMultipleOf_ != 0) {
+                if (magnitude % integralMultipleOf_ != 0)
+                    RAPIDJSON_INVALID_KEYWORD_RETURN("multipleOf");
+            }
+            else {
+                const double a = static_cast<double>(magnitude);
+                if (a - std::floor(a / multipleOf_) * multipleOf_ > 0.0)
+                    RAPIDJSON_INVALID_KEYWORD_RETURN("multipleOf");
+            }
+        }
+        return true;
+    }
+
+    template <typename Context>
+    bool CheckBounds(Context& context, double d) const {
+        if (hasMinimum_ && (exclusiveMinimum_ ? d <= minimum_ : d < minimum_))
+            RAPIDJSON_INVALID_KEYWORD_RETURN("minimum");
+        if (hasMaximum_ && (exclusiveMaximum_ ? d >= maximum_ : d > maximum_))
+            RAPIDJSON_INVALID_KEYWORD_RETURN("maximum");
+        return true;
+    }
+
+    //! Count the code points of a string, returning false if the encoding is invalid.
+    static bool CountStringCodePoint(const Ch* str, SizeType length, SizeType* outCount) {
+        GenericStringStream<EncodingType> is(str);
+        const Ch* end = str + length;
+        SizeType count = 0;
+        while (is.src_ < end) {
+            unsigned codepoint;
+            if (!EncodingType::Decode(is, &codepoint))
+                return false;
+            count++;
+        }
+        *outCount = count;
+        return true;
+    }
+
+    AllocatorType* allocator_;
+    const SchemaType* typeless_;    //!< Schema accepting any value.
+    Ch* pointer_;                   //!< JSON pointer of the schema in its document.
+    SizeType pointerLength_;
+    unsigned type_;                 //!< Bits of the allowed SchemaValueType.
+    uint64_t* enum_;                //!< Hashes of the values of "enum" or "const", compared without the values themselves.
+    SizeType enumCount_;
+    bool const_;                    //!< Whether enum_ is the value of "const".
+
+    const SchemaType** validatorSchemas_;   //!< Subschemas validated in parallel: allOf, anyOf, oneOf, not, dependencies.
+    SizeType validatorCount_;
+    SchemaArray allOf_;
+    SchemaArray anyOf_;
+    SchemaArray oneOf_;
+    SizeType notIndex_;
+
+    Property* properties_;
+    SizeType propertyCount_;
+    const SchemaType* additionalPropertiesSchema_;
+    bool hasRequired_;
+    bool hasDependencies_;
+    bool additionalProperties_;
+#if RAPIDJSON_SCHEMA_USE_STDREGEX
+    PatternProperty* patternProperties_;
+    SizeType patternPropertyCount_;
+    RegexType* pattern_;
+#endif
+    SizeType minProperties_;
+    SizeType maxProperties_;
+
+    const SchemaType* itemsList_;
+    const SchemaType** itemsTuple_;
+    SizeType itemsTupleCount_;
+    const SchemaType* additionalItemsSchema_;
+    bool additionalItems_;
+    bool uniqueItems_;
+    SizeType minItems_;
+    SizeType maxItems_;
+
+    SizeType minLength_;
+    SizeType maxLength_;
+
+    double minimum_;
+    double maximum_;
+    double multipleOf_;
+    bool hasMinimum_;
+    bool hasMaximum_;
+    bool exclusiveMinimum_;
+    bool exclusiveMaximum_;
+    bool hasMultipleOf_;
+    uint64_t integralMultipleOf_;   //!< "multipleOf" if it is a positive integer, for exact tests of integers.
+};
+
+} // namespace internal
+
+///////////////////////////////////////////////////////////////////////////////
+// GenericSchemaDocument
+
+//! JSON Schema compiled for validating JSON texts.
+/*! The schema document compiles a JSON Schema (draft-04) once, with its
+    subschemas and local references resolved, for GenericSchemaValidator.
+    It is immutable after construction: a schema document can be shared by
+    the validators of any number of threads.
+
+    \code
+    Document sd;
+    sd.Parse(schemaJson);
+    SchemaDocument schema(sd); // sd is no longer needed
+    if (!schema.IsValid())
+        ... // schema.GetInvalidReference(), schema.GetInvalidReferencePointer()
+
+    SchemaValidator validator(schema);
+    Reader reader;
+    StringStream is(json);
+    if (!reader.Parse(is, validator) && !validator.IsValid())
+        ... // validator.GetInvalidSchemaKeyword(), validator.GetInvalidDocumentPointer()
+    \endcode
+
+    The keywords of validation of draft-04 are supported, with \c "const",
+    boolean schemas and numeric \c "exclusiveMinimum" and \c "exclusiveMaximum"
+    of later drafts. The other keywords are ignored, including \c "format".
+    \c "pattern" and \c "patternProperties" need \ref RAPIDJSON_SCHEMA_USE_STDREGEX.
+
+    \c "$ref" can be a JSON pointer in the schema document (e.g.
+    <tt>"#/definitions/address"</tt>), including recursive references. Other
+    references, like remote ones, or references to a missing value or to
+    themselves, are not resolved: IsValid() returns false, and the schemas
+    with them accept any value.
+
+    \tparam ValueT Type of the value of the JSON Schema, e.g. Value.
+    \tparam Allocator Allocator type of the compiled schemas.
+    \note The values of \c "enum" and \c "const", and the elements of an array
+    with \c "uniqueItems", are compared by their 64-bit hashes only: a value
+    crafted to collide passes \c "enum" or fails \c "uniqueItems".
+*/
+template <typename ValueT, typename Allocator = CrtAllocator>
+class GenericSchemaDocument {
+public:
+    typedef ValueT ValueType;
+    typedef Allocator AllocatorType;
+    typedef typename ValueType::EncodingType EncodingType;
+    typedef typename EncodingType::Ch Ch;
+    typedef internal::Schema<GenericSchemaDocument> SchemaType;
+    typedef GenericPointer<ValueType, Allocator> PointerType;
+    friend class internal::Schema<GenericSchemaDocument>;
+
+    //! Constructor.
+    /*! \param document The JSON Schema, which is not used after the construction.
+        \param allocator Allocator of the compiled schemas. If it is null, a self-owned one is created.
+    */
+    explicit GenericSchemaDocument(const ValueType& document, Allocator* allocator = 0) :
+        allocator_(allocator), ownAllocator_(), document_(&document), schemas_(allocator, kInitialSchemaCapacity), path_(allocator, kInitialPathCapacity), pathBegin_(), typeless_(), root_(), invalidRef_(), invalidRefPointer_(), invalidRefPointerLength_()
+    {
+        if (!allocator_)
+            ownAllocator_ = allocator_ = RAPIDJSON_NEW(Allocator());
+
+        // Schema of no value of the document, for the values without constraint
+        const ValueType any;
+        SchemaType* typeless = static_cast<SchemaType*>(allocator_->Malloc(sizeof(SchemaType)));
+        SchemaEntry* e = schemas_.template Push<SchemaEntry>();
+        e->value = 0;
+        e->schema = typeless;
+        typeless_ = new (typeless) SchemaType(this, any, allocator_);
+
+        root_ = CompileSchema(document, 0);
+        document_ = 0;
+        path_.ShrinkToFit();
+    }
+
+    //! Destructor.
+    ~GenericSchemaDocument() {
+        while (!schemas_.Empty()) {
+            SchemaType* s = schemas_.template Pop<SchemaEntry>(1)->schema;
+            s->~SchemaType();
+            allocator_->Free(s);
+        }
+        schemas_.ShrinkToFit();
+        allocator_->Free(invalidRef_);
+        allocator_->Free(invalidRefPointer_);
+        RAPIDJSON_DELETE(ownAllocator_);
+    }
+
+    //! Get the root schema.
+    const SchemaType& GetRoot() const { return *root_; }
+
+    //! Whether all the references of the JSON Schema were resolved.
+    bool IsValid() const { return invalidRef_ == 0; }
+
+    //! First \c "$ref" which could not be resolved, or null if the schema document is valid.
+    const Ch* GetInvalidReference() const { return invalidRef_; }
+
+    //! JSON pointer of the schema of the first unresolved \c "$ref", in the JSON Schema.
+    PointerType GetInvalidReferencePointer() const {
+        return invalidRef_ ? PointerType(invalidRefPointer_, invalidRefPointerLength_) : PointerType();
+    }
+
+private:
+    // Prohibit copy constructor & assignment operator.
+    GenericSchemaDocument(const GenericSchemaDocument&);
+    GenericSchemaDocument& operator=(const GenericSchemaDocument&);
+
+    //! Compiled schema of a value of the schema document.
+    struct SchemaEntry {
+        const ValueType* value;
+        SchemaType* schema;
+    };
+
+    static const size_t kInitialSchemaCapacity = 64 * sizeof(SchemaEntry);
+    static const size_t kInitialPathCapacity = 256;
+    static const unsigned kMaxRefDepth = 64;    //!< Maximum length of a chain of references, to stop cycles.
+
+    const Ch* GetPath() { return reinterpret_cast<const Ch*>(path_.template Bottom<char>() + pathBegin_); }
+    SizeType GetPathLength() const { return static_cast<SizeType>((path_.GetSize() - pathBegin_) / sizeof(Ch)); }
+    const SchemaType* GetTypeless() const { return typeless_; }
+
+    //! Compile the subschema of a keyword.
+    const SchemaType* CreateSchema(const ValueType& value, const char* keyword) {
+        const size_t size = path_.GetSize();
+        AppendToken(keyword);
+        const SchemaType* s = CompileSchema(value, 0);
+        path_.template Pop<char>(path_.GetSize() - size);
+        return s;
+    }
+
+    //! Compile the subschema of a name in a keyword, e.g. in "properties".
+    const SchemaType* CreateSchema(const ValueType& value, const char* keyword, const Ch* name, SizeType length) {
+        const size_t size = path_.GetSize();
+        AppendToken(keyword);
+        *path_.template Push<Ch>() = '/';
+        for (SizeType i = 0; i < length; i++) {
+            if (name[i] == '~' || name[i] == '/') {
+                *path_.template Push<Ch>() = '~';
+                *path_.template Push<Ch>() = name[i] == '~' ? '0' : '1';
+            }
+            else
+                *path_.template Push<Ch>() = name[i];
+        }
+        const SchemaType* s = CompileSchema(value, 0);
+        path_.template Pop<char>(path_.GetSize() - size);
+        return s;
+    }
+
+    //! Compile the subschema of an index in a keyword, e.g. in "allOf".
+    const SchemaType* CreateSchema(const ValueType& value, const char* keyword, SizeType index) {
+        const size_t size = path_.GetSize();
+        AppendToken(keyword);
+        char buffer[11];
+        buffer[0] = '/';
+        const char* end = internal::u32toa(index, buffer + 1);
+        for (const char* p = buffer; p != end; ++p)
+            *path_.template Push<Ch>() = static_cast<Ch>(*p);
+        const SchemaType* s = CompileSchema(value, 0);
+        path_.template Pop<char>(path_.GetSize() - size);
+        return s;
+    }
+
+    //! Compile the schema of a value, once for each value, following the references.
+    const SchemaType* CompileSchema(const ValueType& value, unsigned refDepth) {
+        for (const SchemaEntry* e = schemas_.template Bottom<SchemaEntry>(); e != schemas_.template Bottom<SchemaEntry>() + schemas_.GetSize() / sizeof(SchemaEntry); ++e)
+            if (e->value == &value)
+                return e->schema;
+        if ((value.IsObject() && value.ObjectEmpty()) || (value.IsBool() && value.GetBool()))
+            return typeless_; // Any value
+
+        if (value.IsObject()) {
+            typename ValueType::ConstMemberIterator ref = value.MemberBegin();
+            for (; ref != value.MemberEnd(); ++ref)
+                if (ref->name.GetStringLength() == 4 && ref->name.GetString()[0] == '$' && ref->name.GetString()[1] == 'r' && ref->name.GetString()[2] == 'e' && ref->name.GetString()[3] == 'f')
+                    break;
+            if (ref != value.MemberEnd() && ref->value.IsString()) {
+                // Local reference: a JSON pointer in the fragment of the URI
+                const Ch* s = ref->value.GetString();
+                const SizeType length = ref->value.GetStringLength();
+                if (length > 0 && s[0] == '#' && refDepth < kMaxRefDepth) {
+                    PointerType pointer(s + 1, length - 1, allocator_);
+                    if (pointer.IsValid())
+                        if (const ValueType* target = pointer.Get(*document_)) {
+                            // The path of the target is the pointer itself
+                            const size_t pathBegin = pathBegin_;
+                            pathBegin_ = path_.GetSize();
+                            std::memcpy(path_.template Push<Ch>(length - 1), s + 1, (length - 1) * sizeof(Ch));
+                            const SchemaType* result = CompileSchema(*target, refDepth + 1);
+                            path_.template Pop<char>(path_.GetSize() - pathBegin_);
+                            pathBegin_ = pathBegin;
+                            return result;
+                        }
+                }
+                // Unresolved reference: any value, and the first one is reported
+                if (!invalidRef_) {
+                    invalidRef_ = CopyString(s, length);
+                    invalidRefPointerLength_ = GetPathLength();
+                    invalidRefPointer_ = CopyString(GetPath(), invalidRefPointerLength_);
+                }
+                return typeless_;
+            }
+        }
+
+        SchemaType* schema = static_cast<SchemaType*>(allocator_->Malloc(sizeof(SchemaType)));
+        SchemaEntry* e = schemas_.template Push<SchemaEntry>();
+        e->value = &value;
+        e->schema = schema;
+        new (schema) SchemaType(this, value, allocator_);
+        return schema;
+    }
+
+    Ch* CopyString(const Ch* str, SizeType length) {
+        Ch* copy = static_cast<Ch*>(allocator_->Malloc((length + 1) * sizeof(Ch)));
+        if (length > 0)
+            std::memcpy(copy, str, length * sizeof(Ch));
+        copy[length] = '\0';
+        return copy;
+    }
+
+    void AppendToken(const char* keyword) {
+        *path_.template Push<Ch>() = '/';
+        for (; *keyword != '\0'; ++keyword)
+            *path_.template Push<Ch>() = static_cast<Ch>(*keyword);
+    }
+
+    Allocator* allocator_;
+    Allocator* ownAllocator_;
+    const ValueType* document_;             //!< JSON Schema being compiled, for resolving the references.
+    internal::Stack<Allocator> schemas_;    //!< Compiled schemas, with their values during the construction.
+    internal::Stack<Allocator> path_;       //!< JSON pointer of the schema being compiled, after the one of the references followed.
+    size_t pathBegin_;                      //!< Offset in path_ of the JSON pointer of the schema being compiled.
+    const SchemaType* typeless_;            //!< Schema accepting any value.
+    const SchemaType* root_;
+    Ch* invalidRef_;                        //!< First unresolved reference, or null.
+    Ch* invalidRefPointer_;                 //!< JSON pointer of the schema of invalidRef_.
+    SizeType invalidRefPointerLength_;
+};
+
+//! GenericSchemaDocument using Value type.
+typedef GenericSchemaDocument<Value> SchemaDocument;
+
+///////////////////////////////////////////////////////////////////////////////
+// GenericSchemaValidator
+
+//! SAX handler validating the events of a JSON text against a compiled JSON Schema.
+/*! The validator checks each event as it arrives and forwards it to the
+    output handler, e.g. a GenericDocument or a Writer. It fails at the first
+    event violating the schema, so that GenericReader stops parsing with
+    kParseErrorTermination, before the rest of an invalid text is read or
+    stored. The subschemas of \c "allOf", \c "anyOf", \c "oneOf", \c "not",
+    schema \c "dependencies" and \c "patternProperties" are validated in
+    parallel by sub-validators receiving the events of their value.
+
+    \code
+    SchemaValidator validator(schema);              // SchemaDocument schema
+    Reader reader;
+    StringStream is(json);
+    if (!reader.Parse(is, validator)) {
+        if (!validator.IsValid()) {
+            StringBuffer sb;
+            validator.GetInvalidDocumentPointer().Stringify(sb);
+            printf("Invalid %s at %s\n", validator.GetInvalidSchemaKeyword(), sb.GetString());
+        }
+    }
+    \endcode
+
+    \tparam SchemaDocumentType Type of the schema document, GenericSchemaDocument.
+    \tparam OutputHandler Type of output handler, implementing Handler concept.
+    \tparam StateAllocator Allocator type of the validation state.
+    \note implements Handler concept
+    \note A validator is not thread-safe, but the validators of several threads can share a schema document.
+*/
+template <
+    typename SchemaDocumentType,
+    typename OutputHandler = BaseReaderHandler<typename SchemaDocumentType::EncodingType>,
+    typename StateAllocator = CrtAllocator>
+class GenericSchemaValidator {
+public:
+    typedef typename SchemaDocumentType::SchemaType SchemaType;
+    typedef typename SchemaDocumentType::PointerType PointerType;
+    typedef typename SchemaType::EncodingType EncodingType;
+    typedef typename EncodingType::Ch Ch;
+    template <typename, typename, typename> friend class GenericSchemaValidator;
+
+    //! Constructor without output handler.
+    /*! \param schemaDocument The schema document, which must outlive the validator.
+        \param allocator Optional allocator of the validation state.
+        \param schemaStackCapacity Initial capacity in bytes of the stack of the values being validated.
+        \param documentStackCapacity Initial capacity in bytes of the JSON pointer of the current value.
+    */
+    explicit GenericSchemaValidator(
+        const SchemaDocumentType& schemaDocument,
+        StateAllocator* allocator = 0,
+        size_t schemaStackCapacity = kDefaultSchemaStackCapacity,
+        size_t documentStackCapacity = kDefaultDocumentStackCapacity)
+        :
+        schemaDocument_(&schemaDocument),
+        root_(&schemaDocument.GetRoot()),
+        outputHandler_(0),
+        stateAllocator_(allocator),
+        ownStateAllocator_(0),
+        schemaStack_(allocator, schemaStackCapacity),
+        documentStack_(allocator, documentStackCapacity),
+        stateStack_(allocator, kDefaultStateStackCapacity),
+        hasherPool_(allocator, kDefaultPoolCapacity),
+        validatorPool_(allocator, kDefaultPoolCapacity),
+        invalidSchema_(0),
+        invalidKeyword_(0),
+        parallelCount_(0),
+        skip_(0),
+        valid_(true),
+        trackPath_(true)
+    {
+    }
+
+    //! Constructor with output handler.
+    /*! \param schemaDocument The schema document, which must outlive the validator.
+        \param outputHandler Handler receiving the events of valid values.
+        \param allocator Optional allocator of the validation state.
+        \param schemaStackCapacity Initial capacity in bytes of the stack of the values being validated.
+        \param documentStackCapacity Initial capacity in bytes of the JSON pointer of the current value.
+    */
+    GenericSchemaValidator(
+        const SchemaDocumentType& schemaDocument,
+        OutputHandler& outputHandler,
+        StateAllocator* allocator = 0,
+        size_t schemaStackCapacity = kDefaultSchemaStackCapacity,
+        size_t documentStackCapacity = kDefaultDocumentStackCapacity)
+        :
+        schemaDocument_(&schemaDocument),
+        root_(&schemaDocument.GetRoot()),
+        outputHandler_(&outputHandler),
+        stateAllocator_(allocator),
+        ownStateAllocator_(0),
+        schemaStack_(allocator, schemaStackCapacity),
+        documentStack_(allocator, documentStackCapacity),
+        stateStack_(allocator, kDefaultStateStackCapacity),
+        hasherPool_(allocator, kDefaultPoolCapacity),
+        validatorPool_(allocator, kDefaultPoolCapacity),
+        invalidSchema_(0),
+        invalidKeyword_(0),
+        parallelCount_(0),
+        skip_(0),
+        valid_(true),
+        trackPath_(true)
+    {
+    }
+
+    //! Destructor.
+    ~GenericSchemaValidator() {
+        Reset();
+        while (!hasherPool_.Empty()) {
+            HasherType* h = *hasherPool_.template Pop<HasherType*>(1);
+            h->~HasherType();
+            StateAllocator::Free(h);
+        }
+        while (!validatorPool_.Empty()) {
+            SubValidatorType* v = *validatorPool_.template Pop<SubValidatorType*>(1);
+            v->~SubValidatorType();
+            StateAllocator::Free(v);
+        }
+        RAPIDJSON_DELETE(ownStateAllocator_);
+    }
+
+    //! Prepare the validator for a new JSON text, e.g. after an error.
+    void Reset() {
+        while (!schemaStack_.Empty())
+            PopSchema();
+        documentStack_.Clear();
+        stateStack_.Clear();
+        skip_ = 0;
+        invalidSchema_ = 0;
+        invalidKeyword_ = 0;
+        valid_ = true;
+    }
+
+    //! Whether the events received so far are valid.
+    bool IsValid() const { return valid_; }
+
+    //! JSON pointer of the schema whose validation failed, in the schema document.
+    PointerType GetInvalidSchemaPointer() const {
+        return invalidSchema_ ? invalidSchema_->GetPointer() : PointerType();
+    }
+
+    //! Keyword of the schema whose validation failed, or null if the events are valid.
+    const char* GetInvalidSchemaKeyword() const { return invalidKeyword_; }
+
+    //! JSON pointer of the value whose validation failed, in the validated document.
+    PointerType GetInvalidDocumentPointer() const {
+        if (valid_ || documentStack_.Empty())
+            return PointerType();
+        return PointerType(const_cast<internal::Stack<StateAllocator>&>(documentStack_).template Bottom<Ch>(), documentStack_.GetSize() / sizeof(Ch));
+    }
+
+#define RAPIDJSON_SCHEMA_HANDLE_PARALLEL_(method, arg2)\
+    if (parallelCount_ > 0)\
+        for (Context* parallel = schemaStack_.template Bottom<Context>(); parallel != schemaStack_.template Bottom<Context>() + ContextCount(); parallel++) {\
+            if (parallel->hasher)\
+                parallel->hasher->method arg2;\
+            for (SizeType validatorIndex = 0; validatorIndex < parallel->validatorCount; validatorIndex++)\
+                parallel->validators[validatorIndex]->method arg2;\
+        }
+
+#define RAPIDJSON_SCHEMA_HANDLE_END_(method, arg2)\
+    return (outputHandler_ == 0 || outputHandler_->method arg2)
+
+#define RAPIDJSON_SCHEMA_HANDLE_VALUE_(method, arg1, arg2)\
+    if (!valid_) return false;\
+    if (skip_ > 0) RAPIDJSON_SCHEMA_HANDLE_END_(method, arg2);\
+    const SchemaType* scalarSchema;\
+    if (!BeginValue(scalarSchema, false)) return false;\
+    if (scalarSchema) {\
+        Context context(scalarSchema); /* Not pushed */\
+        if (!scalarSchema->method arg1) return Fail(context, true);\
+        RAPIDJSON_SCHEMA_HANDLE_PARALLEL_(method, arg2);\
+    }\
+    else {\
+        Context& context = CurrentContext();\
+        if (!context.schema->method arg1) return Fail(context, false);\
+        RAPIDJSON_SCHEMA_HANDLE_PARALLEL_(method, arg2);\
+        if (!EndValue()) return false;\
+    }\
+    RAPIDJSON_SCHEMA_HANDLE_END_(method, arg2)
+
+    bool Null()             { RAPIDJSON_SCHEMA_HANDLE_VALUE_(Null,   (context   ), ( )); }
+    bool Bool(bool b)       { RAPIDJSON_SCHEMA_HANDLE_VALUE_(Bool,   (context, b), (b)); }
+    bool Int(int i)         { RAPIDJSON_SCHEMA_HANDLE_VALUE_(Int,    (context, i), (i)); }
+    bool Uint(unsigned u)   { RAPIDJSON_SCHEMA_HANDLE_VALUE_(Uint,   (context, u), (u)); }
+    bool Int64(int64_t i)   { RAPIDJSON_SCHEMA_HANDLE_VALUE_(Int64,  (context, i), (i)); }
+    bool Uint64(uint64_t u) { RAPIDJSON_SCHEMA_HANDLE_VALUE_(Uint64, (context, u), (u)); }
+    bool Double(double d)   { RAPIDJSON_SCHEMA_HANDLE_VALUE_(Double, (context, d), (d)); }
+    bool String(const Ch* str, SizeType length, bool copy)
+                            { RAPIDJSON_SCHEMA_HANDLE_VALUE_(String, (context, str, length, copy), (str, length, copy)); }
+
+    bool StartObject() {
+        if (!valid_) return false;
+        if (skip_ > 0) {
+            ++skip_;
+            RAPIDJSON_SCHEMA_HANDLE_END_(StartObject, ());
+        }
+        const SchemaType* scalarSchema;
+        if (!BeginValue(scalarSchema, true)) return false;
+        if (skip_ > 0)
+            RAPIDJSON_SCHEMA_HANDLE_END_(StartObject, ());
+        Context& context = CurrentContext();
+        const SchemaType& schema = *context.schema;
+        if (!schema.StartObject(context))
+            return Fail(context, false);
+        if (schema.IsPropertyTracked()) {
+            const size_t size = sizeof(bool) * schema.GetPropertyCount();
+            bool* propertyExist = static_cast<bool*>(PushState(size));
+            std::memset(propertyExist, 0, size);
+            CurrentContext().propertyExist = propertyExist;
+        }
+        if (schema.GetPatternPropertyCount() > 0) {
+            const SchemaType** patternSchemas = static_cast<const SchemaType**>(PushState(sizeof(const SchemaType*) * schema.GetPatternPropertyCount()));
+            CurrentContext().patternSchemas = patternSchemas;
+        }
+        RAPIDJSON_SCHEMA_HANDLE_PARALLEL_(StartObject, ());
+        RAPIDJSON_SCHEMA_HANDLE_END_(StartObject, ());
+    }
+
+    bool Key(const Ch* str, SizeType len, bool copy) {
+        if (!valid_) return false;
+        if (skip_ > 0) RAPIDJSON_SCHEMA_HANDLE_END_(Key, (str, len, copy));
+        Context& context = CurrentContext();
+        if (trackPath_) {
+            // Name of the member, escaped only if the validation fails
+            documentStack_.template Pop<char>(documentStack_.GetSize() - context.documentPathSize);
+            std::memcpy(documentStack_.template Push<Ch>(len), str, sizeof(Ch) * len);
+        }
+        if (!context.schema->Key(context, str, len))
+            return Fail(context, true);
+        RAPIDJSON_SCHEMA_HANDLE_PARALLEL_(Key, (str, len, copy));
+        RAPIDJSON_SCHEMA_HANDLE_END_(Key, (str, len, copy));
+    }
+
+    bool EndObject(SizeType memberCount) {
+        if (!valid_) return false;
+        if (skip_ > 0) {
+            --skip_;
+            RAPIDJSON_SCHEMA_HANDLE_END_(EndObject, (memberCount));
+        }
+        RAPIDJSON_SCHEMA_HANDLE_PARALLEL_(EndObject, (memberCount));
+        Context& context = CurrentContext();
+        if (!context.schema->EndObject(context, memberCount))
+            return Fail(context, false);
+        if (!EndValue()) return false;
+        RAPIDJSON_SCHEMA_HANDLE_END_(EndObject, (memberCount));
+    }
+
+    bool StartArray() {
+        if (!valid_) return false;
+        if (skip_ > 0) {
+            ++skip_;
+            RAPIDJSON_SCHEMA_HANDLE_END_(StartArray, ());
+        }
+        const SchemaType* scalarSchema;
+        if (!BeginValue(scalarSchema, true)) return false;
+        if (skip_ > 0)
+            RAPIDJSON_SCHEMA_HANDLE_END_(StartArray, ());
+        Context& context = CurrentContext();
+        if (!context.schema->StartArray(context))
+            return Fail(context, false);
+        RAPIDJSON_SCHEMA_HANDLE_PARALLEL_(StartArray, ());
+        RAPIDJSON_SCHEMA_HANDLE_END_(StartArray, ());
+    }
+
+    bool EndArray(SizeType elementCount) {
+        if (!valid_) return false;
+        if (skip_ > 0) {
+            --skip_;
+            RAPIDJSON_SCHEMA_HANDLE_END_(EndArray, (elementCount));
+        }
+        RAPIDJSON_SCHEMA_HANDLE_PARALLEL_(EndArray, (elementCount));
+        Context& context = CurrentContext();
+        if (!context.schema->EndArray(context, elementCount))
+            return Fail(context, false);
+        if (!EndValue()) return false;
+        RAPIDJSON_SCHEMA_HANDLE_END_(EndArray, (elementCount));
+    }
+
+#undef RAPIDJSON_SCHEMA_HANDLE_PARALLEL_
+#undef RAPIDJSON_SCHEMA_HANDLE_END_
+#undef RAPIDJSON_SCHEMA_HANDLE_VALUE_
+
+private:
+    // Prohibit copy constructor & assignment operator.
+    GenericSchemaValidator(const GenericSchemaValidator&);
+    GenericSchemaValidator& operator=(const GenericSchemaValidator&);
+
+    typedef GenericSchemaValidator<SchemaDocumentType, BaseReaderHandler<EncodingType>, StateAllocator> SubValidatorType;
+    typedef internal::Hasher<EncodingType, StateAllocator> HasherType;
+    typedef internal::SchemaValidationContext<SchemaType, SubValidatorType, HasherType> Context;
+
+    static const size_t kDefaultSchemaStackCapacity = 64 * sizeof(Context);
+    static const size_t kDefaultDocumentStackCapacity = 256;
+    static const size_t kDefaultStateStackCapacity = 256;
+    static const size_t kDefaultPoolCapacity = 8 * sizeof(void*);
+
+    //! Constructor of a sub-validator, validating a value against a subschema.
+    GenericSchemaValidator(const SchemaDocumentType& schemaDocument, const SchemaType& root, StateAllocator* allocator) :
+        schemaDocument_(&schemaDocument),
+        root_(&root),
+        outputHandler_(0),
+        stateAllocator_(allocator),
+        ownStateAllocator_(0),
+        schemaStack_(allocator, kDefaultSchemaStackCapacity),
+        documentStack_(allocator, kDefaultDocumentStackCapacity),
+        stateStack_(allocator, kDefaultStateStackCapacity),
+        hasherPool_(allocator, kDefaultPoolCapacity),
+        validatorPool_(allocator, kDefaultPoolCapacity),
+        invalidSchema_(0),
+        invalidKeyword_(0),
+        parallelCount_(0),
+        skip_(0),
+        valid_(true),
+        trackPath_(false)
+    {
+    }
+
+    StateAllocator& GetStateAllocator() {
+        if (!stateAllocator_)
+            stateAllocator_ = ownStateAllocator_ = RAPIDJSON_NEW(StateAllocator());
+        return *stateAllocator_;
+    }
+
+    Context& CurrentContext() { return *schemaStack_.template Top<Context>(); }
+    const SchemaType& CurrentSchema() { return *CurrentContext().schema; }
+    SizeType ContextCount() const { return static_cast<SizeType>(schemaStack_.GetSize() / sizeof(Context)); }
+
+    //! Find the schema of the value starting, given by its parent, and push the context of the value if it needs one.
+    /*! \param scalarSchema Schema of a scalar checked without context, or null if the context is pushed.
+        \param container Whether the value is an object or an array, which has a context unless its events are skipped.
+    */
+    bool BeginValue(const SchemaType*& scalarSchema, bool container) {
+        const SchemaType* schema;
+        SizeType patternSchemaCount = 0;
+        bool uniqueness = false;
+        if (schemaStack_.Empty())
+            schema = root_;
+        else {
+            Context& parent = CurrentContext();
+            if (parent.inArray) {
+                if (!parent.schema->GetElementSchema(parent, schema))
+                    return Fail(parent, true);
+                uniqueness = parent.arrayUniqueness;
+            }
+            else {
+                schema = parent.valueSchema;
+                patternSchemaCount = parent.patternSchemaCount;
+            }
+        }
+
+        if (!uniqueness && patternSchemaCount == 0 && !schema->IsParallel()) {
+            if (!container) {
+                scalarSchema = schema;
+                return true;
+            }
+            if (schema->IsTypeless() && parallelCount_ == 0) {
+                // No check and no hash in this value: skip its events
+                skip_ = 1;
+                return true;
+            }
+        }
+        scalarSchema = 0;
+        PushSchema(*schema, patternSchemaCount, uniqueness);
+        return true;
+    }
+
+    //! Check the value ended, pop its context and check its uniqueness in the parent array.
+    bool EndValue() {
+        Context& context = CurrentContext();
+        if (!context.schema->EndValue(context))
+            return Fail(context, false);
+
+        const bool unique = context.valueUniqueness;
+        const uint64_t h = unique ? context.hasher->GetHashCode() : 0;
+        PopSchema();
+
+        if (unique) {
+            // Only the hashes of the elements are kept: two different elements with colliding hashes are
+            // rejected as duplicates (about n^2 * 2^-65 for n random elements, but a collision can be crafted).
+            Context& parent = CurrentContext();
+            for (SizeType i = 0; i < parent.arrayElementHashCount; i++)
+                if (parent.arrayElementHashes[i] == h) {
+                    parent.invalidKeyword = "uniqueItems";
+                    return Fail(parent, false);
+                }
+            // The hashes of the array are on the top of stateStack_, after those of its elements are popped
+            uint64_t* hash = static_cast<uint64_t*>(PushState(sizeof(uint64_t)));
+            *hash = h;
+            Context& array = CurrentContext();
+            if (!array.arrayElementHashes)
+                array.arrayElementHashes = hash;
+            array.arrayElementHashCount++;
+        }
+        return true;
+    }
+
+    //! Push the context of a value.
+    /*! \param schema Schema of the value.
+        \param patternSchemaCount Number of the schemas of "patternProperties" of the parent object matching the name of the value.
+        \param uniqueness Whether the value is an element of an array with unique elements.
+    */
+    void PushSchema(const SchemaType& schema, SizeType patternSchemaCount, bool uniqueness) {
+        new (schemaStack_.template Push<Context>()) Context(&schema);
+        const SizeType count = schema.GetValidatorCount() + patternSchemaCount;
+        SubValidatorType** validators = count > 0 ? static_cast<SubValidatorType**>(PushState(sizeof(SubValidatorType*) * count)) : 0;
+
+        Context& context = CurrentContext();
+        context.documentPathSize = documentStack_.GetSize();
+        context.valueUniqueness = uniqueness;
+
+        if (schema.IsEnum() || uniqueness)
+            context.hasher = CreateHasher();
+
+        if (count > 0) {
+            context.validators = validators;
+            for (SizeType i = 0; i < schema.GetValidatorCount(); i++)
+                context.validators[context.validatorCount++] = CreateSubValidator(*schema.GetValidatorSchema(i));
+            if (patternSchemaCount > 0) {
+                const SchemaType* const* patternSchemas = (&context - 1)->patternSchemas; // Read after PushState(), which may move them
+                for (SizeType i = 0; i < patternSchemaCount; i++)
+                    context.validators[context.validatorCount++] = CreateSubValidator(*patternSchemas[i]);
+            }
+        }
+
+        if (context.hasher || context.validatorCount > 0)
+            parallelCount_++;
+    }
+
+    void PopSchema() {
+        Context* context = schemaStack_.template Pop<Context>(1);
+        if (trackPath_)
+            documentStack_.template Pop<char>(documentStack_.GetSize() - context->documentPathSize);
+        if (context->hasher || context->validatorCount > 0)
+            parallelCount_--;
+        if (context->hasher) {
+            context->hasher->Reset();
+            *hasherPool_.template Push<HasherType*>() = context->hasher;
+        }
+
+        // Arrays on stateStack_, in the reverse order of their allocation
+        if (context->arrayElementHashes)
+            PopState(sizeof(uint64_t) * context->arrayElementHashCount);
+        if (context->patternSchemas)
+            PopState(sizeof(const SchemaType*) * context->schema->GetPatternPropertyCount());
+        if (context->propertyExist)
+            PopState(sizeof(bool) * context->schema->GetPropertyCount());
+        if (context->validators) {
+            for (SizeType i = 0; i < context->validatorCount; i++) {
+                context->validators[i]->Reset();
+                *validatorPool_.template Push<SubValidatorType*>() = context->validators[i];
+            }
+            PopState(sizeof(SubValidatorType*) * context->validatorCount);
+        }
+    }
+
+    //! Allocate an array of the top context on stateStack_, moving the arrays of the other contexts if the stack moves.
+    void* PushState(size_t size) {
+        char* const bottom = stateStack_.template Bottom<char>();
+        void* p = stateStack_.template Push<uint64_t>((size + sizeof(uint64_t) - 1) / sizeof(uint64_t));
+        char* const newBottom = stateStack_.template Bottom<char>();
+        if (bottom && newBottom != bottom)
+            for (Context* context = schemaStack_.template Bottom<Context>(); context != schemaStack_.template Bottom<Context>() + ContextCount(); context++) {
+                RebaseState(context->validators, bottom, newBottom);
+                RebaseState(context->patternSchemas, bottom, newBottom);
+                RebaseState(context->propertyExist, bottom, newBottom);
+                RebaseState(context->arrayElementHashes, bottom, newBottom);
+            }
+        return p;
+    }
+
+    void PopState(size_t size) {
+        stateStack_.template Pop<uint64_t>((size + sizeof(uint64_t) - 1) / sizeof(uint64_t));
+    }
+
+    template <typename T>
+    static void RebaseState(T*& p, const char* bottom, char* newBottom) {
+        if (p)
+            p = reinterpret_cast<T*>(newBottom + (reinterpret_cast<const char*>(p) - bottom));
+    }
+
+    HasherType* CreateHasher() {
+        if (!hasherPool_.Empty())
+            return *hasherPool_.template Pop<HasherType*>(1);
+        StateAllocator& allocator = GetStateAllocator();
+        return new (allocator.Malloc(sizeof(HasherType))) HasherType(&allocator);
+    }
+
+    SubValidatorType* CreateSubValidator(const SchemaType& root) {
+        if (!validatorPool_.Empty()) {
+            SubValidatorType* v = *validatorPool_.template Pop<SubValidatorType*>(1);
+            v->root_ = &root;
+            return v;
+        }
+        StateAllocator& allocator = GetStateAllocator();
+        return new (allocator.Malloc(sizeof(SubValidatorType))) SubValidatorType(*schemaDocument_, root, &allocator);
+    }
+
+    //! Record the failure of a context and the JSON pointer of its value.
+    /*! \param context Context of the failed validation, on the stack or of a scalar.
+        \param includeChild Whether the value is the current child of the top context.
+    */
+    bool Fail(const Context& context, bool includeChild) {
+        invalidSchema_ = context.schema;
+        invalidKeyword_ = context.invalidKeyword;
+        valid_ = false;
+        if (trackPath_)
+            BuildDocumentPath(includeChild);
+        return false;
+    }
+
+    //! Replace the names in documentStack_ by the JSON pointer of the invalid value.
+    /*! The name of the current member of each object context lies in documentStack_
+        up to the position of the next context. The index of the current element of
+        each array context is the one before its arrayElementIndex.
+    */
+    void BuildDocumentPath(bool includeChild) {
+        const size_t namesSize = documentStack_.GetSize();
+        const SizeType contextCount = ContextCount();
+        const SizeType count = includeChild || contextCount == 0 ? contextCount : contextCount - 1;
+        for (SizeType k = 0; k < count; k++) {
+            const Context& context = schemaStack_.template Bottom<Context>()[k];
+            if (context.inArray)
+                AppendIndex(context.arrayElementIndex - 1);
+            else {
+                const size_t end = k + 1 < contextCount ? schemaStack_.template Bottom<Context>()[k + 1].documentPathSize : namesSize;
+                AppendToken(context.documentPathSize, end);
+            }
+        }
+
+        const size_t pathSize = documentStack_.GetSize() - namesSize;
+        char* bottom = documentStack_.template Bottom<char>();
+        if (pathSize > 0)
+            std::memmove(bottom, bottom + namesSize, pathSize);
+        documentStack_.template Pop<char>(namesSize);
+    }
+
+    //! Append the escaped token of the name in documentStack_ between two offsets.
+    void AppendToken(size_t begin, size_t end) {
+        *documentStack_.template Push<Ch>() = '/';
+        for (size_t offset = begin; offset < end; offset += sizeof(Ch)) {
+            const Ch c = *reinterpret_cast<const Ch*>(documentStack_.template Bottom<char>() + offset); // Read before Push(), which may move the stack
+            if (c == '~' || c == '/') {
+                *documentStack_.template Push<Ch>() = '~';
+                *documentStack_.template Push<Ch>() = c == '~' ? '0' : '1';
+            }
+            else
+                *documentStack_.template Push<Ch>() = c;
+        }
+    }
+
+    void AppendIndex(SizeType index) {
+        char buffer[11];
+        buffer[0] = '/';
+        const char* end = internal::u32toa(index, buffer + 1);
+        for (const char* p = buffer; p != end; ++p)
+            *documentStack_.template Push<Ch>() = static_cast<Ch>(*p);
+    }
+
+    const SchemaDocumentType* schemaDocument_;
+    const SchemaType* root_;
+    OutputHandler* outputHandler_;
+    StateAllocator* stateAllocator_;
+    StateAllocator* ownStateAllocator_;
+    internal::Stack<StateAllocator> schemaStack_;   //!< Contexts of the values being validated.
+    internal::Stack<StateAllocator> documentStack_; //!< Names of the current members of the objects, then JSON pointer of the invalid value.
+    internal::Stack<StateAllocator> stateStack_;    //!< Arrays of the contexts: validators, propertyExist, patternSchemas and element hashes.
+    internal::Stack<StateAllocator> hasherPool_;    //!< Hashers released by the contexts, for reuse.
+    internal::Stack<StateAllocator> validatorPool_; //!< Sub-validators released by the contexts, for reuse.
+    const SchemaType* invalidSchema_;
+    const char* invalidKeyword_;
+    SizeType parallelCount_;                        //!< Number of contexts with a hasher or sub-validators.
+    size_t skip_;                                   //!< Number of objects and arrays skipped, in a value without constraint.
+    bool valid_;
+    bool trackPath_;                                //!< Whether documentStack_ is maintained, not in sub-validators.
+};
+
+//! GenericSchemaValidator with SchemaDocument and no output handler.
+typedef GenericSchemaValidator<SchemaDocument> SchemaValidator;
+
+///////////////////////////////////////////////////////////////////////////////
+// SchemaValidatingReader
+
+//! Generator parsing a JSON text with validation, for GenericDocument::Populate().
+/*! The document receives the events through a GenericSchemaValidator: the
+    parsing stops at the first value violating the schema, and the document
+    is left null.
+
+    \code
+    SchemaValidatingReader<kParseDefaultFlags, StringStream, UTF8<> > reader(is, schema);
+    Document d;
+    d.Populate(reader);
+    if (!reader.GetParseResult()) {
+        if (!reader.IsValid())
+            ... // reader.GetInvalidSchemaKeyword(), reader.GetInvalidDocumentPointer()
+        else
+            ... // GetParseError_En(reader.GetParseResult().Code())
+    }
+    \endcode
+
+    \tparam parseFlags Combination of \ref ParseFlag.
+    \tparam InputStream Type of input stream, implementing Stream concept.
+    \tparam SourceEncoding Encoding of the input stream.
+    \tparam SchemaDocumentType Type of the schema document, GenericSchemaDocument.
+    \tparam StackAllocator Allocator type of the stacks of the reader and of the validator.
+*/
+template <
+    unsigned parseFlags,
+    typename InputStream,
+    typename SourceEncoding,
+    typename SchemaDocumentType = SchemaDocument,
+    typename StackAllocator = CrtAllocator>
+class SchemaValidatingReader {
+public:
+    typedef typename SchemaDocumentType::PointerType PointerType;
+
+    //! Constructor.
+    /*! \param is Input stream to be parsed.
+        \param schemaDocument The schema document.
+    */
+    SchemaValidatingReader(InputStream& is, const SchemaDocumentType& schemaDocument) : is_(is), schemaDocument_(schemaDocument), invalidSchemaPointer_(), invalidSchemaKeyword_(), invalidDocumentPointer_(), isValid_(true) {}
+
+    template <typename Handler>
+    bool operator()(Handler& handler) {
+        GenericReader<SourceEncoding, typename SchemaDocumentType::EncodingType, StackAllocator> reader;
+        GenericSchemaValidator<SchemaDocumentType, Handler, StackAllocator> validator(schemaDocument_, handler);
+        parseResult_ = reader.template Parse<parseFlags>(is_, validator);
+
+        isValid_ = validator.IsValid();
+        if (isValid_) {
+            invalidSchemaPointer_ = PointerType();
+            invalidSchemaKeyword_ = 0;
+            invalidDocumentPointer_ = PointerType();
+        }
+        else {
+            invalidSchemaPointer_ = validator.GetInvalidSchemaPointer();
+            invalidSchemaKeyword_ = validator.GetInvalidSchemaKeyword();
+            invalidDocumentPointer_ = validator.GetInvalidDocumentPointer();
+        }
+
+        return parseResult_;
+    }
+
+    //! Result of the parsing: kParseErrorTermination for an invalid value.
+    const ParseResult& GetParseResult() const { return parseResult_; }
+    bool IsValid() const { return isValid_; }
+    const PointerType& GetInvalidSchemaPointer() const { return invalidSchemaPointer_; }
+    const char* GetInvalidSchemaKeyword() const { return invalidSchemaKeyword_; }
+    const PointerType& GetInvalidDocumentPointer() const { return invalidDocumentPointer_; }
+
+private:
+    // Prohibit copy constructor & assignment operator.
+    SchemaValidatingReader(const SchemaValidatingReader&);
+    SchemaValidatingReader& operator=(const SchemaValidatingReader&);
+
+    InputStream& is_;
+    const SchemaDocumentType& schemaDocument_;
+
+    ParseResult parseResult_;
+    PointerType invalidSchemaPointer_;
+    const char* invalidSchemaKeyword_;
+    PointerType invalidDocumentPointer_;
+    bool isValid_;
+};
+
+#undef RAPIDJSON_INVALID_KEYWORD_RETURN
+
+RAPIDJSON_NAMESPACE_END
+
+#endif // RAPIDJSON_SCHEMA_H_
@@ -20,6 +20,7 @@
 #include "internal/strfunc.h"
 #include "internal/dtoa.h"
 #include "internal/itoa.h"
+#include "internal/simd.h"
 #include "stringbuffer.h"
 #include <new>      // placement new
 
@@ -257,7 +258,7 @@ protected:
 
         os_->Put('\"');
         GenericStringStream<SourceEncoding> is(str);
-        while (is.Tell() < length) {
+        while (ScanWriteUnescapedString(is, length)) {
             const Ch c = is.Peek();
             if (!TargetEncoding::supportUnicode && (unsigned)c >= 0x80) {
                 // Unicode escaping
@@ -309,6 +310,14 @@ protected:
         return true;
     }
 
+    //! Copy the characters which need no escaping, and return whether the string has more characters.
+    /*! The generic version copies nothing, leaving each character to the escaping loop of WriteString().
+        \note This function has SSE2/SSE4.2/AVX2 specialization.
+    */
+    bool ScanWriteUnescapedString(GenericStringStream<SourceEncoding>& is, size_t length) {
+        return is.Tell() < length;
+    }
+
     bool WriteStartObject() { os_->Put('{'); return true; }
     bool WriteEndObject()   { os_->Put('}'); return true; }
     bool WriteStartArray()  { os_->Put('['); return true; }
@@ -386,6 +395,21 @@ inline bool Writer<StringBuffer>::WriteDouble(double d) {
     return true;
 }
 
+#ifdef RAPIDJSON_SIMD
+template<>
+inline bool Writer<StringBuffer>::ScanWriteUnescapedString(StringStream& is, size_t length) {
+    const char* p = is.src_;
+    const char* end = is.head_ + length;
+    const char* q = internal::ScanUnescapedString(p, end);
+    const size_t n = static_cast<size_t>(q - p);
+    if (n != 0) {
+        std::memcpy(os_->Push(n), p, n);
+        is.src_ = q;
+    }
+    return q != end;
+}
+#endif // RAPIDJSON_SIMD
+
 RAPIDJSON_NAMESPACE_END
 
 #ifdef _MSC_VER
@@ -0,0 +1,166 @@
+// Tencent is pleased to support the open source community by making RapidJSON available.
+//
+// Copyright (C) 2015 THL A29 Limited, a Tencent company, and Milo Yip. All rights reserved.
+//
+// Licensed under the MIT License (the "License"); you may not use this file except
+// in compliance with the License. You may obtain a copy of the License at
+//
+// http://opensource.org/licenses/MIT
+//
+// Unless required by applicable law or agreed to in writing, software distributed
+// under the License is distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR
+// CONDITIONS OF ANY KIND, either express or implied. See the License for the
+// specific language governing permissions and limitations under the License.
+
+
+// Conversions between a Document and a web::json::value of the C++ REST SDK (see cpprestjson.h),
+// directly through SAX events or through the JSON text, and parsing from a cpprest stream buffer
+// (see cpprestwrapper.h), in place or copied out of the buffer first.
+
+#include "perftest.h"
+#include "rapidjson/cpprestjson.h"
+#include "rapidjson/cpprestwrapper.h"
+#include "rapidjson/document.h"
+#include "rapidjson/stringbuffer.h"
+#include "rapidjson/writer.h"
+#include <cpprest/containerstream.h>
+#include <cpprest/rawptrstream.h>
+#include <cstdio>
+#include <string>
+
+using namespace rapidjson;
+using namespace concurrency::streams;
+
+//! Array of 20000 small records, of about 2 MB.
+class CppRestPerfTest : public ::testing::Test {
+public:
+    static void SetUpTestCase() {
+        json_ = new std::string("[");
+        for (int i = 0; i < 20000; i++) {
+            char record[256];
+            std::sprintf(record, "%s{\"id\":%d,\"name\":\"user %d\",\"score\":%d.25,\"tags\":[\"a\",\"b\",\"c\"],\"active\":true,\"parent\":null}",
+                i > 0 ? "," : "", i, i, i);
+            *json_ += record;
+        }
+        *json_ += "]";
+    }
+
+    static void TearDownTestCase() {
+        delete json_;
+        json_ = 0;
+    }
+
+protected:
+    static std::string* json_;
+};
+
+std::string* CppRestPerfTest::json_ = 0;
+
+TEST_F(CppRestPerfTest, ToCppRestValue) {
+    Document doc;
+    doc.Parse(json_->c_str());
+    ASSERT_FALSE(doc.HasParseError());
+
+    PerfTimer timer;
+    for (int i = 0; i < PerfTestRuns(); i++) {
+        timer.Start();
+        web::json::value v = ToCppRestValue(doc);
+        timer.Stop();
+        ASSERT_EQ(20000u, v.size());
+    }
+    PrintThroughput("ToCppRestValue", json_->size(), timer.GetBest());
+}
+
+TEST_F(CppRestPerfTest, ToCppRestValue_Text) {
+    Document doc;
+    doc.Parse(json_->c_str());
+    ASSERT_FALSE(doc.HasParseError());
+
+    PerfTimer timer;
+    for (int i = 0; i < PerfTestRuns(); i++) {
+        timer.Start();
+        StringBuffer sb;
+        Writer<StringBuffer> writer(sb);
+        doc.Accept(writer);
+        web::json::value v = web::json::value::parse(sb.GetString());
+        timer.Stop();
+        ASSERT_EQ(20000u, v.size());
+    }
+    PrintThroughput("Writer + value::parse", json_->size(), timer.GetBest());
+}
+
+TEST_F(CppRestPerfTest, FromCppRestValue) {
+    const web::json::value v = web::json::value::parse(*json_);
+
+    PerfTimer timer;
+    for (int i = 0; i < PerfTestRuns(); i++) {
+        Document doc;
+        timer.Start();
+        FromCppRestValue(v, doc);
+        timer.Stop();
+        ASSERT_EQ(20000u, doc.Size());
+    }
+    PrintThroughput("FromCppRestValue", json_->size(), timer.GetBest());
+}
+
+TEST_F(CppRestPerfTest, FromCppRestValue_Text) {
+    const web::json::value v = web::json::value::parse(*json_);
+
+    PerfTimer timer;
+    for (int i = 0; i < PerfTestRuns(); i++) {
+        Document doc;
+        timer.Start();
+        doc.Parse(v.serialize().c_str());
+        timer.Stop();
+        ASSERT_EQ(20000u, doc.Size());
+    }
+    PrintThroughput("value::serialize + Parse", json_->size(), timer.GetBest());
+}
+
+TEST_F(CppRestPerfTest, ReadStream_Acquire) {
+    PerfTimer timer;
+    for (int i = 0; i < PerfTestRuns(); i++) {
+        container_buffer<std::string> cb(*json_, std::ios_base::in);
+        char buffer[4096];
+        Document doc;
+        timer.Start();
+        BasicCppRestReadStream<char> is(cb, buffer, sizeof(buffer));
+        doc.ParseStream(is);
+        timer.Stop();
+        ASSERT_EQ(20000u, doc.Size());
+    }
+    PrintThroughput("ParseStream (acquire)", json_->size(), timer.GetBest());
+}
+
+TEST_F(CppRestPerfTest, ReadStream_Getn) {
+    PerfTimer timer;
+    for (int i = 0; i < PerfTestRuns(); i++) {
+        rawptr_buffer<char> rb(json_->data(), json_->size());
+        char buffer[4096];
+        Document doc;
+        timer.Start();
+        BasicCppRestReadStream<char> is(rb, buffer, sizeof(buffer));
+        doc.ParseStream(is);
+        timer.Stop();
+        ASSERT_EQ(20000u, doc.Size());
+    }
+    PrintThroughput("ParseStream (getn)", json_->size(), timer.GetBest());
+}
+
+TEST_F(CppRestPerfTest, ReadStream_Copy) {
+    PerfTimer timer;
+    for (int i = 0; i < PerfTestRuns(); i++) {
+        container_buffer<std::string> cb(*json_, std::ios_base::in);
+        Document doc;
+        timer.Start();
+        std::string copy;
+        char buffer[4096];
+        size_t n;
+        while ((n = cb.getn(buffer, sizeof(buffer)).get()) > 0)
+            copy.append(buffer, n);
+        doc.Parse(copy.c_str());
+        timer.Stop();
+        ASSERT_EQ(20000u, doc.Size());
+    }
+    PrintThroughput("getn copy + Parse", json_->size(), timer.GetBest());
+}
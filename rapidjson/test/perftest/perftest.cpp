@@ -0,0 +1,41 @@
+// Tencent is pleased to support the open source community by making RapidJSON available.
+//
+// Copyright (C) 2015 THL A29 Limited, a Tencent company, and Milo Yip. All rights reserved.
+//
+// Licensed under the MIT License (the "License"); you may not use this file except
+// in compliance with the License. You may obtain a copy of the License at
+//
+// http://opensource.org/licenses/MIT
+//
+// Unless required by applicable law or agreed to in writing, software distributed
+// under the License is distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR
+// CONDITIONS OF ANY KIND, either express or implied. See the License for the
+// specific language governing permissions and limitations under the License.
+
+
+#include "perftest.h"
+#include "rapidjson/rapidjson.h"
+#include <cstdio>
+#include <cstdlib>
+
+int PerfTestRuns() {
+    const char* runs = std::getenv("PERFTEST_RUNS");
+    const int n = runs ? std::atoi(runs) : 0;
+    return n > 0 ? n : 20;
+}
+
+const char* PerfTestInstructionSet() {
+#if defined(RAPIDJSON_AVX2)
+    return "AVX2";
+#elif defined(RAPIDJSON_SSE42)
+    return "SSE4.2";
+#elif defined(RAPIDJSON_SSE2)
+    return "SSE2";
+#else
+    return "scalar";
+#endif
+}
+
+void PrintThroughput(const char* name, size_t bytes, double seconds) {
+    std::printf("%-24s %-7s %8.1f MB/s (best of %d runs)\n", name, PerfTestInstructionSet(), static_cast<double>(bytes) / seconds / (1024 * 1024), PerfTestRuns());
+}
@@ -0,0 +1,52 @@
+// Tencent is pleased to support the open source community by making RapidJSON available.
+//
+// Copyright (C) 2015 THL A29 Limited, a Tencent company, and Milo Yip. All rights reserved.
+//
+// Licensed under the MIT License (the "License"); you may not use this file except
+// in compliance with the License. You may obtain a copy of the License at
+//
+// http://opensource.org/licenses/MIT
+//
+// Unless required by applicable law or agreed to in writing, software distributed
+// under the License is distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR
+// CONDITIONS OF ANY KIND, either express or implied. See the License for the
+// specific language governing permissions and limitations under the License.
+
+
+#ifndef PERFTEST_H_
+#define PERFTEST_H_
+
+#include "gtest/gtest.h"
+#include <chrono>
+#include <cstddef>
+
+//! Number of timed runs of each perftest, from the environment variable PERFTEST_RUNS (default 20).
+int PerfTestRuns();
+
+//! Name of the instruction set of the string scanning of this build.
+const char* PerfTestInstructionSet();
+
+//! Print the throughput of a perftest, from its best run.
+void PrintThroughput(const char* name, size_t bytes, double seconds);
+
+//! Timer of a perftest, keeping the best of its runs.
+class PerfTimer {
+public:
+    PerfTimer() : best_(1e30) {}
+
+    void Start() { start_ = std::chrono::steady_clock::now(); }
+    void Stop() {
+        const double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start_).count();
+        if (seconds < best_)
+            best_ = seconds;
+    }
+
+    //! Best duration in seconds.
+    double GetBest() const { return best_; }
+
+private:
+    std::chrono::steady_clock::time_point start_;
+    double best_;
+};
+
+#endif // PERFTEST_H_
@@ -0,0 +1,170 @@
+// Tencent is pleased to support the open source community by making RapidJSON available.
+//
+// Copyright (C) 2015 THL A29 Limited, a Tencent company, and Milo Yip. All rights reserved.
+//
+// Licensed under the MIT License (the "License"); you may not use this file except
+// in compliance with the License. You may obtain a copy of the License at
+//
+// http://opensource.org/licenses/MIT
+//
+// Unless required by applicable law or agreed to in writing, software distributed
+// under the License is distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR
+// CONDITIONS OF ANY KIND, either express or implied. See the License for the
+// specific language governing permissions and limitations under the License.
+
+
+// Overhead of the validation of a JSON Schema (see schema.h) over the parsing
+// alone, with the SAX validator and with SchemaValidatingReader into a Document.
+
+#include "perftest.h"
+#include "rapidjson/document.h"
+#include "rapidjson/reader.h"
+#include "rapidjson/schema.h"
+#include <cstdio>
+#include <string>
+
+using namespace rapidjson;
+
+//! Array of orders, of about 1 MB, with schemas of increasing cost.
+class SchemaPerfTest : public ::testing::Test {
+public:
+    static void SetUpTestCase() {
+        json_ = new std::string("[");
+        for (int i = 0; i < 2000; i++) {
+            char order[2048];
+            std::sprintf(order, "%s{\"id\":%d,\"status\":\"paid\",\"created\":\"2015-06-0%dT12:00:00Z\",\"user\":{\"name\":\"Customer number %d with a long name\",\"email\":\"c%d@example.com\",\"age\":%d},"
+                "\"items\":[{\"sku\":\"SKU-%05d\",\"qty\":%d,\"price\":%d.99,\"note\":null},{\"sku\":\"SKU-%05d\",\"qty\":1,\"price\":1234.5,\"note\":\"gift wrap, please deliver to the back door\"},{\"sku\":\"X\",\"qty\":3,\"price\":0.25}],"
+                "\"tags\":[\"alpha\",\"beta\",\"gamma\"],\"description\":\"Lorem ipsum dolor sit amet, consectetur adipiscing elit, sed do eiusmod tempor incididunt ut labore et dolore magna aliqua.\"}",
+                i > 0 ? "," : "", i + 1, i % 9 + 1, i, i, i % 100, i, i % 7 + 1, i % 500, i + 1);
+            *json_ += order;
+        }
+        *json_ += "]";
+
+        typeless_ = NewSchema("{}");
+        light_ = NewSchema("{\"type\":\"array\",\"items\":{\"type\":\"object\",\"required\":[\"id\"]}}");
+        full_ = NewSchema(
+            "{\"type\":\"array\",\"items\":{\"type\":\"object\",\"required\":[\"id\",\"user\",\"items\"],\"properties\":{"
+            "\"id\":{\"type\":\"integer\",\"minimum\":1},"
+            "\"status\":{\"enum\":[\"new\",\"paid\",\"shipped\"]},"
+            "\"created\":{\"type\":\"string\",\"minLength\":10},"
+            "\"user\":{\"$ref\":\"#/definitions/user\"},"
+            "\"items\":{\"type\":\"array\",\"minItems\":1,\"items\":{\"$ref\":\"#/definitions/item\"}},"
+            "\"tags\":{\"type\":\"array\",\"items\":{\"type\":\"string\"},\"uniqueItems\":true}}},"
+            "\"definitions\":{"
+            "\"user\":{\"type\":\"object\",\"required\":[\"name\",\"email\"],\"properties\":{\"name\":{\"type\":\"string\",\"maxLength\":64},\"email\":{\"type\":\"string\"},\"age\":{\"type\":\"integer\",\"minimum\":0,\"maximum\":150}}},"
+            "\"item\":{\"type\":\"object\",\"required\":[\"sku\",\"qty\",\"price\"],\"additionalProperties\":false,\"properties\":{\"sku\":{\"type\":\"string\"},\"qty\":{\"type\":\"integer\",\"minimum\":1},\"price\":{\"type\":\"number\",\"minimum\":0},\"note\":{\"type\":[\"string\",\"null\"]}}}}}");
+    }
+
+    static void TearDownTestCase() {
+        delete json_;
+        delete typeless_;
+        delete light_;
+        delete full_;
+        json_ = 0;
+        typeless_ = light_ = full_ = 0;
+    }
+
+protected:
+    static SchemaDocument* NewSchema(const char* json) {
+        Document sd;
+        sd.Parse(json);
+        SchemaDocument* schema = new SchemaDocument(sd);
+        EXPECT_TRUE(schema->IsValid());
+        return schema;
+    }
+
+    static void TestValidator(const char* name, const SchemaDocument& schema) {
+        PerfTimer timer;
+        for (int i = 0; i < PerfTestRuns(); i++) {
+            SchemaValidator validator(schema);
+            Reader reader;
+            StringStream s(json_->c_str());
+            timer.Start();
+            EXPECT_TRUE(reader.Parse(s, validator));
+            timer.Stop();
+        }
+        PrintThroughput(name, json_->size(), timer.GetBest());
+    }
+
+    static std::string* json_;
+    static SchemaDocument* typeless_;
+    static SchemaDocument* light_;
+    static SchemaDocument* full_;
+};
+
+std::string* SchemaPerfTest::json_ = 0;
+SchemaDocument* SchemaPerfTest::typeless_ = 0;
+SchemaDocument* SchemaPerfTest::light_ = 0;
+SchemaDocument* SchemaPerfTest::full_ = 0;
+
+TEST_F(SchemaPerfTest, ReaderParse_NullHandler) {
+    PerfTimer timer;
+    for (int i = 0; i < PerfTestRuns(); i++) {
+        BaseReaderHandler<> h;
+        Reader reader;
+        StringStream s(json_->c_str());
+        timer.Start();
+        EXPECT_TRUE(reader.Parse(s, h));
+        timer.Stop();
+    }
+    PrintThroughput("Reader::Parse", json_->size(), timer.GetBest());
+}
+
+TEST_F(SchemaPerfTest, SchemaValidator_Typeless) {
+    TestValidator("SchemaValidator {}", *typeless_);
+}
+
+TEST_F(SchemaPerfTest, SchemaValidator_Light) {
+    TestValidator("SchemaValidator light", *light_);
+}
+
+TEST_F(SchemaPerfTest, SchemaValidator_Full) {
+    TestValidator("SchemaValidator full", *full_);
+}
+
+TEST_F(SchemaPerfTest, DocumentParse) {
+    PerfTimer timer;
+    for (int i = 0; i < PerfTestRuns(); i++) {
+        Document doc;
+        timer.Start();
+        doc.Parse(json_->c_str());
+        timer.Stop();
+        ASSERT_FALSE(doc.HasParseError());
+    }
+    PrintThroughput("Document::Parse", json_->size(), timer.GetBest());
+}
+
+TEST_F(SchemaPerfTest, SchemaValidatingReader_Full) {
+    PerfTimer timer;
+    for (int i = 0; i < PerfTestRuns(); i++) {
+        Document doc;
+        StringStream s(json_->c_str());
+        timer.Start();
+        SchemaValidatingReader<kParseDefaultFlags, StringStream, UTF8<> > reader(s, *full_);
+        doc.Populate(reader);
+        timer.Stop();
+        ASSERT_TRUE(reader.IsValid());
+        ASSERT_FALSE(doc.HasParseError());
+    }
+    PrintThroughput("SchemaValidatingReader", json_->size(), timer.GetBest());
+}
+
+TEST_F(SchemaPerfTest, SchemaValidator_EarlyRejection) {
+    // An invalid quantity in the first order: the parse stops there
+    std::string json(*json_);
+    const size_t offset = json.find("\"qty\":");
+    json.replace(offset, 7, "\"qty\":0");
+
+    PerfTimer timer;
+    for (int i = 0; i < PerfTestRuns(); i++) {
+        SchemaValidator validator(*full_);
+        Reader reader;
+        StringStream s(json.c_str());
+        timer.Start();
+        EXPECT_EQ(kParseErrorTermination, reader.Parse(s, validator).Code());
+        timer.Stop();
+        EXPECT_STREQ("minimum", validator.GetInvalidSchemaKeyword());
+    }
+    std::printf("%-24s %-7s %8.1f us at offset %u of %u (best of %d runs)\n", "SchemaValidator reject", PerfTestInstructionSet(),
+        timer.GetBest() * 1e6, static_cast<unsigned>(offset), static_cast<unsigned>(json.size()), PerfTestRuns());
+}
@@ -0,0 +1,134 @@
+// Tencent is pleased to support the open source community by making RapidJSON available.
+//
+// Copyright (C) 2015 THL A29 Limited, a Tencent company, and Milo Yip. All rights reserved.
+//
+// Licensed under the MIT License (the "License"); you may not use this file except
+// in compliance with the License. You may obtain a copy of the License at
+//
+// http://opensource.org/licenses/MIT
+//
+// Unless required by applicable law or agreed to in writing, software distributed
+// under the License is distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR
+// CONDITIONS OF ANY KIND, either express or implied. See the License for the
+// specific language governing permissions and limitations under the License.
+
+
+// Throughput of the string scanning of Reader and Writer (see internal/simd.h)
+// on a string-heavy document, for the instruction set of the build.
+
+#include "perftest.h"
+#include "rapidjson/document.h"
+#include "rapidjson/reader.h"
+#include "rapidjson/stringbuffer.h"
+#include "rapidjson/writer.h"
+#include <cstring>
+#include <string>
+#include <vector>
+
+using namespace rapidjson;
+
+//! Document of about 4 MB of articles, whose text is mostly runs of characters needing no escape.
+class StringPerfTest : public ::testing::Test {
+public:
+    static void SetUpTestCase() {
+        unsigned seed = 1;
+        StringBuffer sb;
+        Writer<StringBuffer> writer(sb);
+        writer.StartArray();
+        while (sb.GetSize() < 4 * 1024 * 1024) {
+            writer.StartObject();
+            writer.Key("id");
+            writer.Uint(seed % 100000);
+            writer.Key("title");
+            std::string text = Text(seed, 20 + seed % 100);
+            writer.String(text.c_str(), static_cast<SizeType>(text.size()));
+            writer.Key("body");
+            text = Text(seed, 200 + seed % 2000);
+            writer.String(text.c_str(), static_cast<SizeType>(text.size()));
+            writer.EndObject();
+        }
+        writer.EndArray();
+        json_ = new std::string(sb.GetString(), sb.GetSize());
+    }
+
+    static void TearDownTestCase() {
+        delete json_;
+        json_ = 0;
+    }
+
+protected:
+    //! Words with an escaped character or a non-ASCII one from time to time.
+    static std::string Text(unsigned& seed, size_t length) {
+        static const char* const kWords[] = { "lorem ", "ipsum ", "dolor ", "sit ", "amet, ", "consectetur ", "adipiscing ", "elit. ",
+            "\"quoted\" ", "back\\slash ", "line\n", "caf\xC3\xA9 ", "tab\t" };
+        std::string text;
+        while (text.size() < length) {
+            seed = seed * 1103515245u + 12345u;
+            const unsigned r = (seed >> 16) % 64;
+            text += kWords[r < 8 ? r : (r < 60 ? r % 8 : 8 + r % 5)];
+        }
+        return text;
+    }
+
+    static std::string* json_;
+};
+
+std::string* StringPerfTest::json_ = 0;
+
+TEST_F(StringPerfTest, ReaderParse_NullHandler) {
+    PerfTimer timer;
+    for (int i = 0; i < PerfTestRuns(); i++) {
+        BaseReaderHandler<> h;
+        Reader reader;
+        StringStream s(json_->c_str());
+        timer.Start();
+        EXPECT_TRUE(reader.Parse(s, h));
+        timer.Stop();
+    }
+    PrintThroughput("Reader::Parse", json_->size(), timer.GetBest());
+}
+
+TEST_F(StringPerfTest, DocumentParse) {
+    PerfTimer timer;
+    for (int i = 0; i < PerfTestRuns(); i++) {
+        Document doc;
+        timer.Start();
+        doc.Parse(json_->c_str());
+        timer.Stop();
+        ASSERT_FALSE(doc.HasParseError());
+    }
+    PrintThroughput("Document::Parse", json_->size(), timer.GetBest());
+}
+
+TEST_F(StringPerfTest, DocumentParseInsitu) {
+    std::vector<char> buffer(json_->size() + 1);
+    PerfTimer timer;
+    for (int i = 0; i < PerfTestRuns(); i++) {
+        std::memcpy(&buffer[0], json_->c_str(), json_->size() + 1);
+        Document doc;
+        timer.Start();
+        doc.ParseInsitu(&buffer[0]);
+        timer.Stop();
+        ASSERT_FALSE(doc.HasParseError());
+    }
+    PrintThroughput("Document::ParseInsitu", json_->size(), timer.GetBest());
+}
+
+TEST_F(StringPerfTest, Writer) {
+    Document doc;
+    doc.Parse(json_->c_str());
+    ASSERT_FALSE(doc.HasParseError());
+
+    PerfTimer timer;
+    for (int i = 0; i < PerfTestRuns(); i++) {
+        StringBuffer sb;
+        Writer<StringBuffer> writer(sb);
+        timer.Start();
+        doc.Accept(writer);
+        timer.Stop();
+        // The document was written by Writer: the round trip is exact
+        ASSERT_EQ(json_->size(), sb.GetSize());
+        ASSERT_EQ(0, std::memcmp(json_->c_str(), sb.GetString(), json_->size()));
+    }
+    PrintThroughput("Writer", json_->size(), timer.GetBest());
+}
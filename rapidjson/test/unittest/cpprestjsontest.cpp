@@ -0,0 +1,150 @@
+// Tencent is pleased to support the open source community by making RapidJSON available.
+//
+// Copyright (C) 2015 THL A29 Limited, a Tencent company, and Milo Yip. All rights reserved.
+//
+// Licensed under the MIT License (the "License"); you may not use this file except
+// in compliance with the License. You may obtain a copy of the License at
+//
+// http://opensource.org/licenses/MIT
+//
+// Unless required by applicable law or agreed to in writing, software distributed
+// under the License is distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR
+// CONDITIONS OF ANY KIND, either express or implied. See the License for the
+// specific language governing permissions and limitations under the License.
+
+
+#include "gtest/gtest.h"
+#include "rapidjson/cpprestjson.h"
+#include "rapidjson/cpprestwrapper.h"
+#include "rapidjson/stringbuffer.h"
+#include "rapidjson/writer.h"
+#include <cpprest/containerstream.h>
+#include <cpprest/producerconsumerstream.h>
+#include <cpprest/rawptrstream.h>
+#include <algorithm>
+#include <cstring>
+#include <string>
+
+using namespace rapidjson;
+using namespace concurrency::streams;
+
+static const char kJson[] =
+    "{\"a\":[1,-2,4294967295,4294967296,-3000000000,18446744073709551615,1.5,true,false,null,\"x\\u00e9\\\"y\"],"
+    "\"b\":{},\"c\":[],\"d\":{\"e\":{\"f\":[[]]}}}";
+
+static std::string Serialize(const Value& v) {
+    StringBuffer sb;
+    Writer<StringBuffer> writer(sb);
+    v.Accept(writer);
+    return sb.GetString();
+}
+
+TEST(CppRestJson, RoundTrip) {
+    Document d;
+    d.Parse(kJson);
+    ASSERT_FALSE(d.HasParseError());
+
+    const web::json::value v = ToCppRestValue(d, true);
+    const web::json::array& a = v.at(U("a")).as_array();
+    ASSERT_EQ(11u, a.size());
+    EXPECT_EQ(1, a.at(0).as_integer());
+    EXPECT_EQ(-2, a.at(1).as_integer());
+    EXPECT_EQ(4294967295u, a.at(2).as_number().to_uint32());
+    EXPECT_EQ(4294967296ull, a.at(3).as_number().to_uint64());
+    EXPECT_EQ(-3000000000ll, a.at(4).as_number().to_int64());
+    EXPECT_EQ(18446744073709551615ull, a.at(5).as_number().to_uint64());
+    EXPECT_EQ(1.5, a.at(6).as_double());
+    EXPECT_TRUE(a.at(7).as_bool());
+    EXPECT_FALSE(a.at(8).as_bool());
+    EXPECT_TRUE(a.at(9).is_null());
+    EXPECT_EQ("x\xC3\xA9\"y", internal::FromCppRestString(a.at(10).as_string()));
+    EXPECT_TRUE(v.at(U("b")).is_object());
+    EXPECT_TRUE(v.at(U("c")).is_array());
+
+    Document d2;
+    FromCppRestValue(v, d2);
+    EXPECT_EQ(d, d2);
+    EXPECT_EQ(Serialize(d), Serialize(d2)); // Same integer types, and same order of the members
+}
+
+TEST(CppRestJson, ReaderHandler) {
+    CppRestValueHandler handler(true);
+    Reader reader;
+    StringStream s(kJson);
+    ASSERT_TRUE(reader.Parse(s, handler));
+
+    Document d;
+    d.Parse(kJson);
+    EXPECT_EQ(ToCppRestValue(d, true).serialize(), handler.GetValue().serialize());
+}
+
+TEST(CppRestReadStream, ContainerBuffer) {
+    // The blocks are acquired; the characters after the value stay in the stream buffer
+    container_buffer<std::string> cb(std::string(kJson) + "  tail", std::ios_base::in);
+    char buffer[8];
+    {
+        BasicCppRestReadStream<char> is(cb, buffer, sizeof(buffer));
+        Document d;
+        d.ParseStream<kParseStopWhenDoneFlag>(is);
+        ASSERT_FALSE(d.HasParseError());
+        EXPECT_EQ(std::strlen(kJson), is.Tell());
+    }
+    char rest[16];
+    const size_t n = cb.getn(rest, sizeof(rest)).get();
+    EXPECT_EQ("  tail", std::string(rest, n));
+}
+
+TEST(CppRestReadStream, RawPtrBuffer) {
+    // Copied into the user buffer with getn(), 4 bytes at a time
+    rawptr_buffer<uint8_t> rb(reinterpret_cast<const uint8_t*>(kJson), std::strlen(kJson));
+    char buffer[4];
+    CppRestReadStream is(rb, buffer, sizeof(buffer));
+    Document d;
+    d.ParseStream(is);
+    ASSERT_FALSE(d.HasParseError());
+
+    Document expected;
+    expected.Parse(kJson);
+    EXPECT_EQ(expected, d);
+}
+
+TEST(CppRestReadStream, ProducerConsumerBuffer) {
+    producer_consumer_buffer<uint8_t> pc;
+    const size_t length = std::strlen(kJson);
+    for (size_t i = 0; i < length; i += 7)
+        pc.putn_nocopy(reinterpret_cast<const uint8_t*>(kJson) + i, std::min<size_t>(7, length - i)).wait();
+    pc.close(std::ios_base::out).wait();
+
+    char buffer[8];
+    CppRestReadStream is(pc, buffer, sizeof(buffer));
+    Document d;
+    d.ParseStream(is);
+    ASSERT_FALSE(d.HasParseError());
+    EXPECT_EQ(length, is.Tell());
+}
+
+TEST(CppRestReadStream, Empty) {
+    container_buffer<std::string> cb(std::string(), std::ios_base::in);
+    char buffer[8];
+    BasicCppRestReadStream<char> is(cb, buffer, sizeof(buffer));
+    Document d;
+    d.ParseStream(is);
+    EXPECT_EQ(kParseErrorDocumentEmpty, d.GetParseError());
+}
+
+TEST(CppRestWriteStream, ContainerBuffer) {
+    Document d;
+    d.Parse(kJson);
+
+    container_buffer<std::string> cb;
+    char buffer[7];
+    BasicCppRestWriteStream<char> os(cb, buffer, sizeof(buffer));
+    Writer<BasicCppRestWriteStream<char> > writer(os);
+    d.Accept(writer);
+    os.Flush();
+    EXPECT_EQ(Serialize(d), cb.collection());
+
+    PutN(os, ' ', 20);
+    os.Flush();
+    EXPECT_EQ(Serialize(d) + std::string(20, ' '), cb.collection());
+}
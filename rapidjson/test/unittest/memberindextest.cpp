@@ -0,0 +1,201 @@
+// Tencent is pleased to support the open source community by making RapidJSON available.
+//
+// Copyright (C) 2015 THL A29 Limited, a Tencent company, and Milo Yip. All rights reserved.
+//
+// Licensed under the MIT License (the "License"); you may not use this file except
+// in compliance with the License. You may obtain a copy of the License at
+//
+// http://opensource.org/licenses/MIT
+//
+// Unless required by applicable law or agreed to in writing, software distributed
+// under the License is distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR
+// CONDITIONS OF ANY KIND, either express or implied. See the License for the
+// specific language governing permissions and limitations under the License.
+
+
+// Built with RAPIDJSON_MEMBER_INDEX=1 and a low RAPIDJSON_MEMBER_INDEX_THRESHOLD (see CMakeLists.txt),
+// so that the objects of a few members are indexed, and the smaller ones are not.
+#if !RAPIDJSON_MEMBER_INDEX
+#error "memberindextest.cpp must be built with RAPIDJSON_MEMBER_INDEX=1"
+#endif
+
+#include "gtest/gtest.h"
+#include "rapidjson/document.h"
+#include <cstdio>
+#include <map>
+#include <string>
+
+using namespace rapidjson;
+
+template <typename DocumentType>
+class MemberIndex : public ::testing::Test {
+};
+
+typedef ::testing::Types<GenericDocument<UTF8<>, MemoryPoolAllocator<> >, GenericDocument<UTF8<>, CrtAllocator> > DocumentTypes;
+TYPED_TEST_CASE(MemberIndex, DocumentTypes);
+
+//! Pseudo-random generator of the operations.
+class Random {
+public:
+    explicit Random(unsigned seed) : seed_(seed) {}
+    unsigned operator()(unsigned n) {
+        seed_ = seed_ * 1103515245u + 12345u;
+        return (seed_ >> 16) % n;
+    }
+private:
+    unsigned seed_;
+};
+
+//! One of 300 names, including the empty name and names with a null character.
+static std::string RandomName(Random& random) {
+    const unsigned n = random(300);
+    if (n == 0)
+        return std::string();
+    char buffer[16];
+    sprintf(buffer, "m%u", n);
+    std::string name(buffer);
+    if (n % 7 == 0)
+        name += std::string(1, '\0') + "x";
+    return name;
+}
+
+template <typename ValueType>
+static ValueType NameRef(const std::string& name) {
+    return ValueType(StringRef(name.data(), static_cast<SizeType>(name.size())));
+}
+
+//! Check the members of the object against the expected ones, looking up each one by name.
+template <typename ValueType>
+static void CheckMembers(ValueType& o, const std::map<std::string, int>& expected, Random& random) {
+    ASSERT_EQ(expected.size(), o.MemberCount());
+    for (std::map<std::string, int>::const_iterator it = expected.begin(); it != expected.end(); ++it) {
+        typename ValueType::MemberIterator m = o.FindMember(NameRef<ValueType>(it->first));
+        ASSERT_TRUE(m != o.MemberEnd()) << it->first;
+        EXPECT_EQ(it->second, m->value.GetInt());
+        EXPECT_EQ(it->first, std::string(m->name.GetString(), m->name.GetStringLength()));
+    }
+    for (typename ValueType::ConstMemberIterator m = o.MemberBegin(); m != o.MemberEnd(); ++m)
+        EXPECT_EQ(1u, expected.count(std::string(m->name.GetString(), m->name.GetStringLength())));
+    for (int i = 0; i < 10; i++) {
+        const std::string name = RandomName(random);
+        EXPECT_EQ(expected.count(name) != 0, o.HasMember(NameRef<ValueType>(name)));
+    }
+}
+
+TYPED_TEST(MemberIndex, RandomOperations) {
+    typedef typename TypeParam::ValueType ValueType;
+    typedef typename TypeParam::AllocatorType AllocatorType;
+
+    for (unsigned seed = 1; seed <= 20; seed++) {
+        SCOPED_TRACE(seed);
+        Random random(seed);
+        TypeParam d;
+        AllocatorType& a = d.GetAllocator();
+        d.SetObject();
+        std::map<std::string, int> expected;
+
+        for (int op = 0; op < 1000; op++) {
+            const unsigned kind = random(100);
+            const std::string name = RandomName(random);
+            typename ValueType::MemberIterator m = d.FindMember(NameRef<ValueType>(name));
+            ASSERT_EQ(expected.count(name) != 0, m != d.MemberEnd());
+
+            if (kind < 50) {
+                // Add a new member, or change the value of an existing one
+                if (m == d.MemberEnd()) {
+                    ValueType n(name.data(), static_cast<SizeType>(name.size()), a);
+                    ValueType v(op);
+                    d.AddMember(n, v, a);
+                }
+                else
+                    m->value.SetInt(op);
+                expected[name] = op;
+            }
+            else if (kind < 65) {
+                // Remove by name, moving the last member to its place
+                EXPECT_EQ(expected.erase(name) != 0, d.RemoveMember(NameRef<ValueType>(name)));
+            }
+            else if (kind < 75) {
+                // Remove by iterator
+                if (m != d.MemberEnd()) {
+                    d.RemoveMember(m);
+                    expected.erase(name);
+                }
+            }
+            else if (kind < 85) {
+                // Erase, keeping the order of the other members
+                if (m != d.MemberEnd()) {
+                    d.EraseMember(m);
+                    expected.erase(name);
+                }
+            }
+            else if (kind < 88) {
+                // Erase a range of members
+                const SizeType count = d.MemberCount();
+                if (count > 0) {
+                    const SizeType first = random(count);
+                    const SizeType last = first + random(count - first + 1);
+                    for (typename ValueType::MemberIterator it = d.MemberBegin() + first; it != d.MemberBegin() + last; ++it)
+                        expected.erase(std::string(it->name.GetString(), it->name.GetStringLength()));
+                    d.EraseMember(d.MemberBegin() + first, d.MemberBegin() + last);
+                }
+            }
+            else if (kind < 89) {
+                d.RemoveAllMembers();
+                expected.clear();
+            }
+            else if (kind < 90) {
+                // Deep copy, into an object whose capacity is its size
+                TypeParam copy;
+                copy.CopyFrom(d, copy.GetAllocator());
+                CheckMembers<ValueType>(copy, expected, random);
+            }
+            else {
+                // Lookup only, by the different ways
+                EXPECT_EQ(expected.count(name) != 0, d.HasMember(NameRef<ValueType>(name)));
+                if (m != d.MemberEnd()) {
+                    EXPECT_EQ(expected[name], d[NameRef<ValueType>(name)].GetInt());
+                }
+            }
+
+            if (op % 10 == 0)
+                CheckMembers<ValueType>(d, expected, random);
+        }
+        CheckMembers<ValueType>(d, expected, random);
+    }
+}
+
+TYPED_TEST(MemberIndex, ParsedObjects) {
+    typedef typename TypeParam::ValueType ValueType;
+
+    // The parsed objects have the capacity of their size: below the threshold, then above it
+    TypeParam d;
+    d.Parse("{\"small\":{\"a\":1,\"b\":2},\"large\":{\"a\":1,\"b\":2,\"c\":3,\"d\":4,\"e\":5,\"f\":6,\"a\":7}}");
+    ASSERT_FALSE(d.HasParseError());
+    EXPECT_EQ(2, d["small"]["b"].GetInt());
+    EXPECT_EQ(6, d["large"]["f"].GetInt());
+    EXPECT_FALSE(d["large"].HasMember("g"));
+
+    // With duplicated names, the lookups find one of them, and the removals remove them one at a time
+    ValueType& large = d["large"];
+    const int duplicated = large["a"].GetInt();
+    EXPECT_TRUE(duplicated == 1 || duplicated == 7);
+    EXPECT_TRUE(large.RemoveMember("a"));
+    EXPECT_EQ(8 - duplicated, large["a"].GetInt());
+    EXPECT_TRUE(large.RemoveMember("a"));
+    EXPECT_FALSE(large.HasMember("a"));
+
+    // Growing a small object past the threshold indexes it
+    ValueType& small = d["small"];
+    Random random(1);
+    std::map<std::string, int> expected;
+    expected["a"] = 1;
+    expected["b"] = 2;
+    for (int i = 0; i < 10; i++) {
+        char name[8];
+        sprintf(name, "n%d", i);
+        small.AddMember(ValueType(name, d.GetAllocator()).Move(), i, d.GetAllocator());
+        expected[name] = i;
+        CheckMembers(small, expected, random);
+    }
+}
@@ -0,0 +1,262 @@
+// Tencent is pleased to support the open source community by making RapidJSON available.
+//
+// Copyright (C) 2015 THL A29 Limited, a Tencent company, and Milo Yip. All rights reserved.
+//
+// Licensed under the MIT License (the "License"); you may not use this file except
+// in compliance with the License. You may obtain a copy of the License at
+//
+// http://opensource.org/licenses/MIT
+//
+// Unless required by applicable law or agreed to in writing, software distributed
+// under the License is distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR
+// CONDITIONS OF ANY KIND, either express or implied. See the License for the
+// specific language governing permissions and limitations under the License.
+
+
+#include "gtest/gtest.h"
+#include "rapidjson/pathfilter.h"
+#include "rapidjson/reader.h"
+#include "rapidjson/stringbuffer.h"
+#include "rapidjson/writer.h"
+#include <cstdio>
+#include <string>
+#include <vector>
+
+using namespace rapidjson;
+
+//! Handler recording the events, with the paths selecting them.
+struct PathRecorder {
+    bool StartPath(SizeType index) { return Append("<", index); }
+    bool EndPath(SizeType index) { return Append(">", index); }
+    bool Null() { return Append("null"); }
+    bool Bool(bool b) { return Append(b ? "true" : "false"); }
+    bool Int(int i) { return Append("", i); }
+    bool Uint(unsigned u) { return Append("", u); }
+    bool Int64(int64_t) { return Append("int64"); }
+    bool Uint64(uint64_t) { return Append("uint64"); }
+    bool Double(double) { return Append("double"); }
+    bool String(const char* str, SizeType length, bool) { return Append("\"" + std::string(str, length) + "\""); }
+    bool StartObject() { return Append("{"); }
+    bool Key(const char* str, SizeType length, bool) { return Append(std::string(str, length) + ":"); }
+    bool EndObject(SizeType) { return Append("}"); }
+    bool StartArray() { return Append("["); }
+    bool EndArray(SizeType) { return Append("]"); }
+
+    bool Append(const std::string& event) {
+        events += event;
+        events += ' ';
+        return true;
+    }
+    bool Append(const char* event, unsigned value) {
+        char buffer[16];
+        sprintf(buffer, "%u", value);
+        return Append(event + std::string(buffer));
+    }
+
+    std::string events;
+};
+
+static std::string Filter(const char* json, const char* const* paths, SizeType pathCount) {
+    std::vector<Pointer> pointers;
+    for (SizeType i = 0; i < pathCount; i++)
+        pointers.push_back(Pointer(paths[i]));
+    PathRecorder recorder;
+    GenericPathFilter<PathRecorder> filter(&pointers[0], pathCount, recorder);
+    Reader reader;
+    StringStream s(json);
+    EXPECT_TRUE(reader.Parse(s, filter));
+    return recorder.events;
+}
+
+static const char kLog[] = "{\"request\":{\"method\":\"GET\",\"uri\":\"/index\",\"headers\":[{\"name\":\"host\"},{\"name\":\"accept\"}]},"
+                           "\"response\":{\"status\":200,\"size\":512},\"tags\":[\"a\",[\"b\",\"c\"]]}";
+
+TEST(PathFilter, Select) {
+    const char* const paths[] = { "/response/status", "/request/method", "/missing" };
+    EXPECT_EQ("<1 \"GET\" >1 <0 200 >0 ", Filter(kLog, paths, 3));
+
+    const char* const root[] = { "" };
+    EXPECT_EQ("<0 [ 1 ] >0 ", Filter("[1]", root, 1));
+    EXPECT_EQ("<0 7 >0 ", Filter("7", root, 1));
+}
+
+TEST(PathFilter, Arrays) {
+    const char* const paths[] = { "/request/headers/1/name", "/tags/1/0", "/tags/-", "/tags/01" };
+    EXPECT_EQ("<0 \"accept\" >0 <1 \"b\" >1 ", Filter(kLog, paths, 4));
+
+    // A numeric token is a name in an object
+    const char* const names[] = { "/0", "/1" };
+    EXPECT_EQ("<0 \"x\" >0 <1 \"y\" >1 ", Filter("{\"0\":\"x\",\"1\":\"y\"}", names, 2));
+    EXPECT_EQ("<0 \"x\" >0 <1 \"y\" >1 ", Filter("[\"x\",\"y\"]", names, 2));
+}
+
+TEST(PathFilter, Escape) {
+    const char* const paths[] = { "/a~1b", "/m~0n", "/" };
+    EXPECT_EQ("<0 1 >0 <1 2 >1 <2 3 >2 ", Filter("{\"a/b\":1,\"m~n\":2,\"\":3,\"a\":{\"b\":4}}", paths, 3));
+}
+
+TEST(PathFilter, Nested) {
+    // A selected value inside another selected value, and a value selected by two pointers
+    const char* const paths[] = { "/request/headers", "/request/headers/0/name", "/request", "/request/headers" };
+    EXPECT_EQ("<2 { method: \"GET\" uri: \"/index\" headers: <0 <3 [ { name: <1 \"host\" >1 } { name: \"accept\" } ] >3 >0 } >2 ",
+              Filter(kLog, paths, 4));
+
+    // Overlapping pointers ending in the same object
+    const char* const overlapping[] = { "/response", "/response/size", "/response/status" };
+    EXPECT_EQ("<0 { status: <2 200 >2 size: <1 512 >1 } >0 ", Filter(kLog, overlapping, 3));
+}
+
+TEST(PathFilter, SkippedSubtrees) {
+    // The deep values around the selected one are skipped
+    const char* const paths[] = { "/b/1" };
+    EXPECT_EQ("<0 { c: [ [ ] ] } >0 ",
+              Filter("{\"a\":[[[{\"b\":[1,2]}]]],\"b\":[{\"x\":{}},{\"c\":[[]]},3],\"c\":{\"b\":[0,1]}}", paths, 1));
+}
+
+TEST(PathFilter, Reset) {
+    const Pointer paths[] = { Pointer("/a") };
+    PathRecorder recorder;
+    GenericPathFilter<PathRecorder> filter(paths, 1, recorder);
+    Reader reader;
+    StringStream bad("{\"a\":[1,");
+    EXPECT_FALSE(reader.Parse(bad, filter));
+
+    filter.Reset();
+    recorder.events.clear();
+    StringStream good("{\"b\":0,\"a\":true}");
+    EXPECT_TRUE(reader.Parse(good, filter));
+    EXPECT_EQ("<0 true >0 ", recorder.events);
+}
+
+//! Pseudo-random generator of the documents and pointers of the differential test.
+class Random {
+public:
+    explicit Random(unsigned seed) : seed_(seed) {}
+    unsigned operator()(unsigned n) {
+        seed_ = seed_ * 1103515245u + 12345u;
+        return (seed_ >> 16) % n;
+    }
+private:
+    unsigned seed_;
+};
+
+static const char* const kNames[] = { "a", "b", "0", "1", "01", "-", "", "a/b", "m~n" };
+
+static void RandomValue(Value& v, Document::AllocatorType& a, Random& random, int depth) {
+    const unsigned type = depth > 3 ? random(3) : random(6);
+    switch (type) {
+    case 0: v.SetInt(static_cast<int>(random(100))); break;
+    case 1: v.SetString(kNames[random(9)], a); break;
+    case 2: v.SetNull(); break;
+    case 3:
+    case 4:
+        {
+            // No duplicated names: Pointer::Get() finds only the first one
+            v.SetObject();
+            const unsigned count = random(6);
+            for (unsigned i = 0; i < count; i++) {
+                const char* name = kNames[random(9)];
+                if (v.HasMember(name))
+                    continue;
+                Value child;
+                RandomValue(child, a, random, depth + 1);
+                v.AddMember(Value(name, a).Move(), child, a);
+            }
+        }
+        break;
+    default:
+        {
+            v.SetArray();
+            const unsigned count = random(4);
+            for (unsigned i = 0; i < count; i++) {
+                Value child;
+                RandomValue(child, a, random, depth + 1);
+                v.PushBack(child, a);
+            }
+        }
+        break;
+    }
+}
+
+static std::string RandomPointer(Random& random) {
+    static const char* const kTokens[] = { "a", "b", "0", "1", "01", "-", "", "a~1b", "m~0n", "2", "c" };
+    std::string pointer;
+    const unsigned count = random(5);
+    for (unsigned i = 0; i < count; i++) {
+        pointer += '/';
+        pointer += kTokens[random(11)];
+    }
+    return pointer;
+}
+
+//! Handler writing the events of each selected value in the output of its pointer.
+struct PathWriter {
+    explicit PathWriter(size_t pathCount) : outputs(pathCount), writers(), selected(pathCount, 0) {
+        for (size_t i = 0; i < pathCount; i++)
+            writers.push_back(new Writer<StringBuffer>(outputs[i]));
+    }
+    ~PathWriter() {
+        for (size_t i = 0; i < writers.size(); i++)
+            delete writers[i];
+    }
+
+    bool StartPath(SizeType index) { active.push_back(index); selected[index]++; return true; }
+    bool EndPath(SizeType index) { EXPECT_EQ(index, active.back()); active.pop_back(); return true; }
+    bool Null() { for (size_t i = 0; i < active.size(); i++) writers[active[i]]->Null(); return true; }
+    bool Bool(bool b) { for (size_t i = 0; i < active.size(); i++) writers[active[i]]->Bool(b); return true; }
+    bool Int(int v) { for (size_t i = 0; i < active.size(); i++) writers[active[i]]->Int(v); return true; }
+    bool Uint(unsigned v) { for (size_t i = 0; i < active.size(); i++) writers[active[i]]->Uint(v); return true; }
+    bool Int64(int64_t v) { for (size_t i = 0; i < active.size(); i++) writers[active[i]]->Int64(v); return true; }
+    bool Uint64(uint64_t v) { for (size_t i = 0; i < active.size(); i++) writers[active[i]]->Uint64(v); return true; }
+    bool Double(double v) { for (size_t i = 0; i < active.size(); i++) writers[active[i]]->Double(v); return true; }
+    bool String(const char* str, SizeType length, bool copy) { for (size_t i = 0; i < active.size(); i++) writers[active[i]]->String(str, length, copy); return true; }
+    bool StartObject() { for (size_t i = 0; i < active.size(); i++) writers[active[i]]->StartObject(); return true; }
+    bool Key(const char* str, SizeType length, bool copy) { for (size_t i = 0; i < active.size(); i++) writers[active[i]]->Key(str, length, copy); return true; }
+    bool EndObject(SizeType count) { for (size_t i = 0; i < active.size(); i++) writers[active[i]]->EndObject(count); return true; }
+    bool StartArray() { for (size_t i = 0; i < active.size(); i++) writers[active[i]]->StartArray(); return true; }
+    bool EndArray(SizeType count) { for (size_t i = 0; i < active.size(); i++) writers[active[i]]->EndArray(count); return true; }
+
+    std::vector<StringBuffer> outputs;
+    std::vector<Writer<StringBuffer>*> writers;
+    std::vector<int> selected;
+    std::vector<SizeType> active;
+};
+
+TEST(PathFilter, Fuzz) {
+    // The values selected by the filter are the values found by Pointer::Get() in the DOM
+    Random random(7);
+    for (int round = 0; round < 500; round++) {
+        Document d;
+        RandomValue(d, d.GetAllocator(), random, 0);
+        StringBuffer json;
+        Writer<StringBuffer> writer(json);
+        d.Accept(writer);
+
+        std::vector<Pointer> pointers;
+        for (int i = 0; i < 10; i++)
+            pointers.push_back(Pointer(RandomPointer(random).c_str()));
+
+        PathWriter output(pointers.size());
+        GenericPathFilter<PathWriter> filter(&pointers[0], static_cast<SizeType>(pointers.size()), output);
+        Reader reader;
+        StringStream s(json.GetString());
+        ASSERT_TRUE(reader.Parse(s, filter));
+        EXPECT_TRUE(output.active.empty());
+
+        for (size_t i = 0; i < pointers.size(); i++) {
+            StringBuffer path;
+            pointers[i].Stringify(path);
+            SCOPED_TRACE(std::string(path.GetString()) + " in " + json.GetString());
+            const Value* v = pointers[i].Get(d);
+            if (v) {
+                StringBuffer expected;
+                Writer<StringBuffer> expectedWriter(expected);
+                v->Accept(expectedWriter);
+                EXPECT_EQ(1, output.selected[i]);
+                EXPECT_STREQ(expected.GetString(), output.outputs[i].GetString());
+            }
+            else
+                EXPECT_EQ(0, output.selected[i]);
+        }
+    }
+}
@@ -0,0 +1,355 @@
+// Tencent is pleased to support the open source community by making RapidJSON available.
+//
+// Copyright (C) 2015 THL A29 Limited, a Tencent company, and Milo Yip. All rights reserved.
+//
+// Licensed under the MIT License (the "License"); you may not use this file except
+// in compliance with the License. You may obtain a copy of the License at
+//
+// http://opensource.org/licenses/MIT
+//
+// Unless required by applicable law or agreed to in writing, software distributed
+// under the License is distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR
+// CONDITIONS OF ANY KIND, either express or implied. See the License for the
+// specific language governing permissions and limitations under the License.
+
+
+#include "gtest/gtest.h"
+#include "rapidjson/pointer.h"
+#include "rapidjson/stringbuffer.h"
+#include "rapidjson/writer.h"
+#include <string>
+#include <vector>
+
+using namespace rapidjson;
+
+static std::string Stringify(const Pointer& p) {
+    StringBuffer sb;
+    p.Stringify(sb);
+    return sb.GetString();
+}
+
+static std::string Stringify(const Value& v) {
+    StringBuffer sb;
+    Writer<StringBuffer> writer(sb);
+    v.Accept(writer);
+    return sb.GetString();
+}
+
+TEST(Pointer, Parse) {
+    Pointer root("");
+    EXPECT_TRUE(root.IsValid());
+    EXPECT_EQ(0u, root.GetTokenCount());
+
+    Pointer p("/foo/0/");
+    ASSERT_TRUE(p.IsValid());
+    ASSERT_EQ(3u, p.GetTokenCount());
+    EXPECT_STREQ("foo", p.GetTokens()[0].name);
+    EXPECT_EQ(kPointerInvalidIndex, p.GetTokens()[0].index);
+    EXPECT_STREQ("0", p.GetTokens()[1].name);
+    EXPECT_EQ(0u, p.GetTokens()[1].index);
+    EXPECT_EQ(0u, p.GetTokens()[2].length);
+    EXPECT_EQ(kPointerInvalidIndex, p.GetTokens()[2].index);
+
+    // A name with a null character, parsed with its length
+    Pointer n("/a\0b", 4);
+    ASSERT_TRUE(n.IsValid());
+    EXPECT_EQ(3u, n.GetTokens()[0].length);
+
+    Pointer noSolidus("foo");
+    EXPECT_FALSE(noSolidus.IsValid());
+    EXPECT_EQ(kPointerParseErrorTokenMustBeginWithSolidus, noSolidus.GetParseErrorCode());
+    EXPECT_EQ(0u, noSolidus.GetParseErrorOffset());
+}
+
+TEST(Pointer, Escape) {
+    // RFC 6901: "~0" is '~' and "~1" is '/', decoded once
+    Pointer p("/a~1b/m~0n/~01/~10");
+    ASSERT_TRUE(p.IsValid());
+    ASSERT_EQ(4u, p.GetTokenCount());
+    EXPECT_STREQ("a/b", p.GetTokens()[0].name);
+    EXPECT_STREQ("m~n", p.GetTokens()[1].name);
+    EXPECT_STREQ("~1", p.GetTokens()[2].name);
+    EXPECT_STREQ("/0", p.GetTokens()[3].name);
+    EXPECT_EQ(kPointerInvalidIndex, p.GetTokens()[2].index);
+    EXPECT_EQ("/a~1b/m~0n/~01/~10", Stringify(p));
+
+    Pointer invalid("/a~2");
+    EXPECT_FALSE(invalid.IsValid());
+    EXPECT_EQ(kPointerParseErrorInvalidEscape, invalid.GetParseErrorCode());
+    EXPECT_EQ(2u, invalid.GetParseErrorOffset());
+
+    Pointer truncated("/a/~");
+    EXPECT_FALSE(truncated.IsValid());
+    EXPECT_EQ(kPointerParseErrorInvalidEscape, truncated.GetParseErrorCode());
+    EXPECT_EQ(3u, truncated.GetParseErrorOffset());
+
+    // The examples of RFC 6901
+    Document d;
+    d.Parse("{\"foo\":[\"bar\",\"baz\"],\"\":0,\"a/b\":1,\"c%d\":2,\"e^f\":3,\"g|h\":4,\"i\\\\j\":5,\"k\\\"l\":6,\" \":7,\"m~n\":8}");
+    ASSERT_FALSE(d.HasParseError());
+    EXPECT_EQ(&d, Pointer("").Get(d));
+    EXPECT_EQ(&d["foo"], Pointer("/foo").Get(d));
+    EXPECT_EQ(&d["foo"][0], Pointer("/foo/0").Get(d));
+    EXPECT_EQ(0, Pointer("/").Get(d)->GetInt());
+    EXPECT_EQ(1, Pointer("/a~1b").Get(d)->GetInt());
+    EXPECT_EQ(2, Pointer("/c%d").Get(d)->GetInt());
+    EXPECT_EQ(3, Pointer("/e^f").Get(d)->GetInt());
+    EXPECT_EQ(4, Pointer("/g|h").Get(d)->GetInt());
+    EXPECT_EQ(5, Pointer("/i\\j").Get(d)->GetInt());
+    EXPECT_EQ(6, Pointer("/k\"l").Get(d)->GetInt());
+    EXPECT_EQ(7, Pointer("/ ").Get(d)->GetInt());
+    EXPECT_EQ(8, Pointer("/m~0n").Get(d)->GetInt());
+    EXPECT_TRUE(Pointer("/a/b").Get(d) == 0);
+}
+
+TEST(Pointer, IndexOrName) {
+    Pointer p("/0/01/-/4294967295/4294967294");
+    ASSERT_TRUE(p.IsValid());
+    EXPECT_EQ(0u, p.GetTokens()[0].index);
+    EXPECT_EQ(kPointerInvalidIndex, p.GetTokens()[1].index);   // Leading zero
+    EXPECT_EQ(kPointerInvalidIndex, p.GetTokens()[2].index);
+    EXPECT_EQ(kPointerInvalidIndex, p.GetTokens()[3].index);   // Overflow of SizeType
+    EXPECT_EQ(4294967294u, p.GetTokens()[4].index);
+
+    // A numeric token is an index in an array, and a name in an object
+    Document d;
+    d.Parse("{\"0\":\"zero\",\"01\":\"one\",\"a\":[\"x\",\"y\"],\"-\":\"dash\"}");
+    EXPECT_STREQ("zero", Pointer("/0").Get(d)->GetString());
+    EXPECT_STREQ("one", Pointer("/01").Get(d)->GetString());
+    EXPECT_STREQ("dash", Pointer("/-").Get(d)->GetString());
+    EXPECT_STREQ("y", Pointer("/a/1").Get(d)->GetString());
+
+    size_t unresolved = 0;
+    EXPECT_TRUE(Pointer("/a/01").Get(d, &unresolved) == 0);
+    EXPECT_EQ(1u, unresolved);
+    EXPECT_TRUE(Pointer("/a/2").Get(d, &unresolved) == 0);
+    EXPECT_EQ(1u, unresolved);
+    EXPECT_TRUE(Pointer("/a/-").Get(d, &unresolved) == 0);
+    EXPECT_EQ(1u, unresolved);
+    EXPECT_TRUE(Pointer("/0/0").Get(d, &unresolved) == 0);
+    EXPECT_EQ(1u, unresolved);
+    EXPECT_TRUE(Pointer("/b/0").Get(d, &unresolved) == 0);
+    EXPECT_EQ(0u, unresolved);
+}
+
+TEST(Pointer, Create) {
+    Document d;
+    d.SetObject();
+    bool exist = true;
+    Value& v = Pointer("/foo/2/bar").Create(d, &exist);
+    EXPECT_FALSE(exist);
+    EXPECT_TRUE(v.IsNull());
+    v.SetInt(1);
+    EXPECT_EQ("{\"foo\":[null,null,{\"bar\":1}]}", Stringify(d));
+
+    EXPECT_EQ(&v, &Pointer("/foo/2/bar").Create(d, &exist));
+    EXPECT_TRUE(exist);
+
+    // "-" appends to an array
+    Pointer("/foo/-").Create(d).SetString("end");
+    EXPECT_EQ("{\"foo\":[null,null,{\"bar\":1},\"end\"]}", Stringify(d));
+
+    // A name changes an array to an object, an index a scalar to an array
+    Pointer("/foo/x").Create(d).SetBool(true);
+    EXPECT_EQ("{\"foo\":{\"x\":true}}", Stringify(d));
+    Pointer("/foo/x/1").Create(d).SetInt(2);
+    EXPECT_EQ("{\"foo\":{\"x\":[null,2]}}", Stringify(d));
+
+    // A numeric token adds a member to an existing object
+    Pointer("/foo/0").Create(d).SetInt(3);
+    EXPECT_EQ("{\"foo\":{\"x\":[null,2],\"0\":3}}", Stringify(d));
+
+    // Escaped names are created unescaped
+    Pointer("/a~1b/~0").Create(d).SetInt(4);
+    EXPECT_EQ(4, d["a/b"]["~"].GetInt());
+}
+
+TEST(Pointer, GetWithDefaultAndSet) {
+    Document d;
+    d.Parse("{\"a\":{\"b\":1}}");
+    Document::AllocatorType& a = d.GetAllocator();
+
+    EXPECT_EQ(1, Pointer("/a/b").GetWithDefault(d, Value(2)).GetInt());
+    EXPECT_EQ(2, Pointer("/a/c").GetWithDefault(d, Value(2)).GetInt());
+    EXPECT_EQ(2, d["a"]["c"].GetInt());
+
+    const Value v("copied", a);
+    Pointer("/a/b").Set(d, v);
+    EXPECT_STREQ("copied", d["a"]["b"].GetString());
+    EXPECT_STREQ("copied", v.GetString());
+
+    Value m(kArrayType);
+    m.PushBack(1, a);
+    SetValueByPointer(d, Pointer("/x/y"), m, a);
+    EXPECT_TRUE(m.IsNull());    // Moved
+    EXPECT_EQ("{\"a\":{\"b\":\"copied\",\"c\":2},\"x\":{\"y\":[1]}}", Stringify(d));
+
+    SetValueByPointer(d, "/x/y/0", Value(5).Move(), a);
+    EXPECT_EQ(5, GetValueByPointer(d, "/x/y/0")->GetInt());
+    EXPECT_EQ(6, GetValueByPointerWithDefault(d, "/x/z", Value(6).Move(), a).GetInt());
+    EXPECT_EQ(&d["x"]["z"], &CreateValueByPointer(d, "/x/z", a));
+}
+
+TEST(Pointer, Erase) {
+    Document d;
+    d.Parse("{\"a\":[0,1,{\"b\":2,\"c\":3}],\"d/e\":4,\"0\":5}");
+    EXPECT_FALSE(Pointer("").Erase(d));
+    EXPECT_FALSE(Pointer("/x").Erase(d));
+    EXPECT_FALSE(Pointer("/a/3").Erase(d));
+    EXPECT_FALSE(Pointer("/a/-").Erase(d));
+    EXPECT_FALSE(Pointer("/a/0/x").Erase(d));
+    EXPECT_FALSE(Pointer("/x/y").Erase(d));
+
+    EXPECT_TRUE(Pointer("/a/2/b").Erase(d));
+    EXPECT_TRUE(Pointer("/a/0").Erase(d));
+    EXPECT_TRUE(EraseValueByPointer(d, "/d~1e"));
+    EXPECT_TRUE(EraseValueByPointer(d, Pointer("/0")));
+    EXPECT_EQ("{\"a\":[1,{\"c\":3}]}", Stringify(d));
+    EXPECT_FALSE(Pointer("/a/2").Erase(d));
+}
+
+TEST(Pointer, Equality) {
+    EXPECT_TRUE(Pointer("/a/0") == Pointer("/a/0"));
+    EXPECT_TRUE(Pointer("/a~1b") == Pointer("/a~1b"));
+    EXPECT_TRUE(Pointer("/a") != Pointer("/a/"));
+    EXPECT_TRUE(Pointer("/0") != Pointer("/00"));
+    EXPECT_TRUE(Pointer("x") != Pointer("x"));  // Invalid pointers are never equal
+
+    Pointer p("/a/b");
+    Pointer copy(p);
+    EXPECT_TRUE(copy == p);
+    Pointer assigned;
+    assigned = p;
+    EXPECT_EQ("/a/b", Stringify(assigned));
+}
+
+TEST(CompiledPointer, Get) {
+    CompiledPointer c(Pointer("/response/status"));
+    EXPECT_EQ("/response/status", Stringify(c.GetPointer()));
+
+    Document d1;
+    d1.Parse("{\"request\":{\"uri\":\"/\"},\"response\":{\"size\":10,\"status\":200}}");
+    EXPECT_EQ(&d1["response"]["status"], c.Get(d1));
+    EXPECT_EQ(&d1["response"]["status"], c.Get(d1));
+
+    // Different layouts invalidate the positions found by the previous queries
+    Document d2;
+    d2.Parse("{\"response\":{\"status\":404,\"size\":10},\"request\":{\"uri\":\"/\"}}");
+    EXPECT_EQ(404, c.Get(d2)->GetInt());
+    EXPECT_EQ(200, c.Get(d1)->GetInt());
+
+    // The member at the remembered position has another name, or is past the end of a smaller object
+    Document d3;
+    d3.Parse("{\"response\":{\"state\":1,\"status\":500}}");
+    EXPECT_EQ(500, c.Get(d3)->GetInt());
+    Document d4;
+    d4.Parse("{\"response\":{\"status\":501}}");
+    EXPECT_EQ(501, c.Get(d4)->GetInt());
+    Document d5;
+    d5.Parse("{\"response\":{\"size\":1,\"statuses\":2}}");
+    EXPECT_TRUE(c.Get(d5) == 0);
+    Document d6;
+    d6.Parse("{\"response\":[200]}");
+    EXPECT_TRUE(c.Get(d6) == 0);
+    EXPECT_EQ(200, c.Get(static_cast<const Document&>(d1))->GetInt());
+
+    // A numeric token is an index in arrays, and a name in objects
+    CompiledPointer index(Pointer("/0"));
+    Document a;
+    a.Parse("[\"a\"]");
+    Document o;
+    o.Parse("{\"x\":1,\"0\":\"b\"}");
+    EXPECT_STREQ("a", index.Get(a)->GetString());
+    EXPECT_STREQ("b", index.Get(o)->GetString());
+    EXPECT_STREQ("a", index.Get(a)->GetString());
+
+    CompiledPointer root(Pointer(""));
+    EXPECT_EQ(&a, root.Get(a));
+}
+
+//! Pseudo-random generator of the documents and pointers of the differential tests.
+class Random {
+public:
+    explicit Random(unsigned seed) : seed_(seed) {}
+    unsigned operator()(unsigned n) {
+        seed_ = seed_ * 1103515245u + 12345u;
+        return (seed_ >> 16) % n;
+    }
+private:
+    unsigned seed_;
+};
+
+static const char* const kNames[] = { "a", "b", "0", "1", "01", "-", "", "a/b", "m~n", "long name" };
+
+static void RandomValue(Value& v, Document::AllocatorType& a, Random& random, int depth) {
+    const unsigned type = depth > 3 ? random(3) : random(6);
+    switch (type) {
+    case 0: v.SetInt(static_cast<int>(random(100))); break;
+    case 1: v.SetString(kNames[random(10)], a); break;
+    case 2: v.SetNull(); break;
+    case 3:
+    case 4:
+        {
+            // Members in a random order, without duplicated names
+            v.SetObject();
+            const unsigned count = random(6);
+            for (unsigned i = 0; i < count; i++) {
+                const char* name = kNames[random(10)];
+                if (v.HasMember(name))
+                    continue;
+                Value child;
+                RandomValue(child, a, random, depth + 1);
+                v.AddMember(Value(name, a).Move(), child, a);
+            }
+        }
+        break;
+    default:
+        {
+            v.SetArray();
+            const unsigned count = random(4);
+            for (unsigned i = 0; i < count; i++) {
+                Value child;
+                RandomValue(child, a, random, depth + 1);
+                v.PushBack(child, a);
+            }
+        }
+        break;
+    }
+}
+
+//! Random pointer of tokens escaped as in kNames.
+static std::string RandomPointer(Random& random) {
+    static const char* const kTokens[] = { "a", "b", "0", "1", "01", "-", "", "a~1b", "m~0n", "long name", "2", "c" };
+    std::string pointer;
+    const unsigned count = random(5);
+    for (unsigned i = 0; i < count; i++) {
+        pointer += '/';
+        pointer += kTokens[random(12)];
+    }
+    return pointer;
+}
+
+TEST(CompiledPointer, Fuzz) {
+    // The same compiled pointers query random documents, in the order of the queries of a stream
+    Random random(42);
+    for (int round = 0; round < 20; round++) {
+        std::vector<Pointer> pointers;
+        for (int i = 0; i < 20; i++)
+            pointers.push_back(Pointer(RandomPointer(random).c_str()));
+        std::vector<CompiledPointer*> compiled;
+        for (size_t i = 0; i < pointers.size(); i++)
+            compiled.push_back(new CompiledPointer(pointers[i]));
+
+        for (int doc = 0; doc < 50; doc++) {
+            Document d;
+            RandomValue(d, d.GetAllocator(), random, 0);
+            for (size_t i = 0; i < pointers.size(); i++) {
+                SCOPED_TRACE(Stringify(pointers[i]) + " in " + Stringify(d));
+                EXPECT_EQ(pointers[i].Get(d), compiled[i]->Get(d));
+            }
+        }
+
+        for (size_t i = 0; i < compiled.size(); i++)
+            delete compiled[i];
+    }
+}
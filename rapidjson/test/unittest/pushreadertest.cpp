@@ -0,0 +1,244 @@
+// Tencent is pleased to support the open source community by making RapidJSON available.
+//
+// Copyright (C) 2015 THL A29 Limited, a Tencent company, and Milo Yip. All rights reserved.
+//
+// Licensed under the MIT License (the "License"); you may not use this file except
+// in compliance with the License. You may obtain a copy of the License at
+//
+// http://opensource.org/licenses/MIT
+//
+// Unless required by applicable law or agreed to in writing, software distributed
+// under the License is distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR
+// CONDITIONS OF ANY KIND, either express or implied. See the License for the
+// specific language governing permissions and limitations under the License.
+
+
+#include "gtest/gtest.h"
+#include "rapidjson/pushreader.h"
+#include <cstdio>
+#include <string>
+
+using namespace rapidjson;
+
+//! Handler recording the events as a string.
+struct EventRecorder {
+    bool Null() { return Append("null"); }
+    bool Bool(bool b) { return Append(b ? "true" : "false"); }
+    bool Int(int i) { return Append("i", static_cast<double>(i)); }
+    bool Uint(unsigned u) { return Append("u", static_cast<double>(u)); }
+    bool Int64(int64_t i) { return Append("I", static_cast<double>(i)); }
+    bool Uint64(uint64_t u) { return Append("U", static_cast<double>(u)); }
+    bool Double(double d) { return Append("d", d); }
+    bool String(const char* str, SizeType length, bool) { return Append("s:" + std::string(str, length)); }
+    bool StartObject() { return Append("{"); }
+    bool Key(const char* str, SizeType length, bool) { return Append("k:" + std::string(str, length)); }
+    bool EndObject(SizeType memberCount) { return Append("}", memberCount); }
+    bool StartArray() { return Append("["); }
+    bool EndArray(SizeType elementCount) { return Append("]", elementCount); }
+
+    bool Append(const std::string& event) {
+        events += event;
+        events += ' ';
+        return true;
+    }
+    bool Append(const char* event, double value) {
+        char buffer[32];
+        sprintf(buffer, "%.17g", value);
+        return Append(event + std::string(buffer));
+    }
+
+    std::string events;
+};
+
+//! Events and error of a JSON text, parsed at once by Reader or in chunks by PushReader.
+struct Result {
+    bool ok;
+    ParseErrorCode code;
+    size_t offset;
+    std::string events;
+};
+
+//! PushReader runs the state machine of kParseIterativeFlag, whose error offsets differ from the recursive parser after a missing separator.
+template <unsigned parseFlags>
+static Result ParseWithReader(const std::string& json) {
+    EventRecorder handler;
+    Reader reader;
+    StringStream s(json.c_str());
+    ParseResult r = reader.Parse<parseFlags | kParseIterativeFlag>(s, handler);
+    Result result = { !r.IsError(), r.Code(), r.Offset(), handler.events };
+    return result;
+}
+
+//! Feed the chunks ending at the given offsets, then the rest of the text, and finish.
+template <unsigned parseFlags>
+static Result ParseWithPushReader(PushReader& reader, const std::string& json, const size_t* splits, size_t splitCount) {
+    EventRecorder handler;
+    size_t begin = 0;
+    bool ok = true;
+    for (size_t i = 0; i <= splitCount && ok; i++) {
+        const size_t end = i < splitCount ? splits[i] : json.size();
+        ok = reader.Feed<parseFlags>(json.c_str() + begin, end - begin, handler);
+        begin = end;
+    }
+    if (ok)
+        ok = reader.Finish<parseFlags>(handler);
+    EXPECT_EQ(ok, !reader.HasParseError());
+    Result result = { ok, reader.GetParseErrorCode(), reader.GetErrorOffset(), handler.events };
+    return result;
+}
+
+template <unsigned parseFlags>
+static Result ParseWithPushReader(const std::string& json, const size_t* splits, size_t splitCount) {
+    PushReader reader;
+    return ParseWithPushReader<parseFlags>(reader, json, splits, splitCount);
+}
+
+static void ExpectSameResult(const Result& expected, const Result& actual) {
+    EXPECT_EQ(expected.ok, actual.ok);
+    EXPECT_EQ(expected.code, actual.code);
+    EXPECT_EQ(expected.offset, actual.offset);
+    EXPECT_EQ(expected.events, actual.events);
+}
+
+//! Compare with Reader the text in one chunk, split in two chunks at every position, and fed byte by byte.
+template <unsigned parseFlags>
+static void TestSplits(const std::string& json) {
+    SCOPED_TRACE(json);
+    const Result expected = ParseWithReader<parseFlags>(json);
+    ExpectSameResult(expected, ParseWithPushReader<parseFlags>(json, 0, 0));
+
+    for (size_t split = 0; split <= json.size(); split++) {
+        SCOPED_TRACE(split);
+        ExpectSameResult(expected, ParseWithPushReader<parseFlags>(json, &split, 1));
+    }
+
+    std::vector<size_t> splits;
+    for (size_t i = 1; i < json.size(); i++)
+        splits.push_back(i);
+    ExpectSameResult(expected, ParseWithPushReader<parseFlags>(json, splits.empty() ? 0 : &splits[0], splits.size()));
+}
+
+TEST(PushReader, SplitStrings) {
+    TestSplits<kParseDefaultFlags>("\"\"");
+    TestSplits<kParseDefaultFlags>("\"Hello, World!\"");
+    TestSplits<kParseDefaultFlags>("[\"a\\\"b\", \"\\\\\", \"\\/\\b\\f\\n\\r\\t\"]");
+    TestSplits<kParseDefaultFlags>("\"\\u0041\\u00e9\\u20AC\\uD834\\uDD1E\"");
+    TestSplits<kParseDefaultFlags>("{\"key\\\"\":\"value\\\\\",\"\":\"\"}");
+    TestSplits<kParseDefaultFlags>("[\"abcdefghijklmnopqrstuvwxyz0123456789ABCDEFGHIJKLMNOPQRSTUVWXYZ\\n\"]");
+    TestSplits<kParseValidateEncodingFlag>("\"\xC3\xA9\xE2\x82\xAC\xF0\x9D\x84\x9E\"");
+}
+
+TEST(PushReader, SplitNumbers) {
+    TestSplits<kParseDefaultFlags>("0");
+    TestSplits<kParseDefaultFlags>("-0");
+    TestSplits<kParseDefaultFlags>("123");
+    TestSplits<kParseDefaultFlags>("[1,-2,3.25,-4e-2,5E+3,6.5e10]");
+    TestSplits<kParseDefaultFlags>("[2147483648,-2147483649,4294967296,18446744073709551615,-9223372036854775808]");
+    TestSplits<kParseDefaultFlags>("{\"a\":12345678901234567890,\"b\":1.7976931348623157e308}");
+    TestSplits<kParseFullPrecisionFlag>("[0.1,1.2345678901234567,2.2250738585072014e-308]");
+}
+
+TEST(PushReader, SplitLiterals) {
+    TestSplits<kParseDefaultFlags>("true");
+    TestSplits<kParseDefaultFlags>("false");
+    TestSplits<kParseDefaultFlags>("null");
+    TestSplits<kParseDefaultFlags>(" [ true , false , null ] ");
+    TestSplits<kParseDefaultFlags>("{\"t\":true,\"f\":false,\"n\":null}");
+}
+
+TEST(PushReader, SplitDocument) {
+    TestSplits<kParseDefaultFlags>(
+        "{\"name\":\"rapidjson\",\"version\":1.0,\"tags\":[\"json\",\"sax\",\"\\u00e9\"],"
+        "\"nested\":{\"empty\":{},\"list\":[[],[1,[2,[3]]],{\"x\":null}]},\"ok\":true}\n");
+}
+
+TEST(PushReader, RandomChunks) {
+    std::string json = "[";
+    for (int i = 0; i < 200; i++) {
+        char buffer[128];
+        sprintf(buffer, "%s{\"id\":%d,\"value\":%.6g,\"name\":\"item \\\"%d\\\"\",\"flag\":%s}",
+            i > 0 ? "," : "", i * 7919 - 500000, i * 0.37 - 20.0, i, i % 3 == 0 ? "true" : (i % 3 == 1 ? "false" : "null"));
+        json += buffer;
+    }
+    json += "]";
+    const Result expected = ParseWithReader<kParseDefaultFlags>(json);
+    ASSERT_TRUE(expected.ok);
+
+    // Chunks of pseudo-random sizes from 1 to 16
+    unsigned seed = 1;
+    for (int round = 0; round < 50; round++) {
+        std::vector<size_t> splits;
+        size_t split = 0;
+        for (;;) {
+            seed = seed * 1103515245u + 12345u;
+            split += 1 + (seed >> 16) % 16;
+            if (split >= json.size())
+                break;
+            splits.push_back(split);
+        }
+        ExpectSameResult(expected, ParseWithPushReader<kParseDefaultFlags>(json, &splits[0], splits.size()));
+    }
+}
+
+TEST(PushReader, ErrorOffset) {
+    // The error and its offset in the whole text do not depend on the chunks
+    TestSplits<kParseDefaultFlags>("");
+    TestSplits<kParseDefaultFlags>("  ");
+    TestSplits<kParseDefaultFlags>("[1, tru]");
+    TestSplits<kParseDefaultFlags>("[1, nul");
+    TestSplits<kParseDefaultFlags>("{\"a\" 1}");
+    TestSplits<kParseDefaultFlags>("{\"a\":1 \"b\":2}");
+    TestSplits<kParseDefaultFlags>("{1:2}");
+    TestSplits<kParseDefaultFlags>("[1 2]");
+    TestSplits<kParseDefaultFlags>("[1,");
+    TestSplits<kParseDefaultFlags>("[-]");
+    TestSplits<kParseDefaultFlags>("[1.]");
+    TestSplits<kParseDefaultFlags>("[1e+]");
+    TestSplits<kParseDefaultFlags>("1e309");
+    TestSplits<kParseDefaultFlags>("\"abc");
+    TestSplits<kParseDefaultFlags>("[\"a\\x\"]");
+    TestSplits<kParseDefaultFlags>("[\"\\u12G4\"]");
+    TestSplits<kParseDefaultFlags>("[\"\\uD800\\u0041\"]");
+    TestSplits<kParseDefaultFlags>("[\"a\nb\"]");
+    TestSplits<kParseValidateEncodingFlag>("[\"\xC3\x28\"]");
+    TestSplits<kParseDefaultFlags>("[1] 2");
+    TestSplits<kParseDefaultFlags>("{} x");
+}
+
+TEST(PushReader, StopWhenDone) {
+    TestSplits<kParseStopWhenDoneFlag>("[1,\"a\"] garbage");
+    TestSplits<kParseStopWhenDoneFlag>("{\"a\":true}{\"b\":false}");
+    TestSplits<kParseStopWhenDoneFlag>("123 456");
+    TestSplits<kParseStopWhenDoneFlag>("\"x\" \"y");
+
+    // The rest of the text is ignored, even in the next chunks
+    PushReader reader;
+    EventRecorder handler;
+    EXPECT_TRUE(reader.Feed<kParseStopWhenDoneFlag>("[1] ", 4, handler));
+    EXPECT_TRUE(reader.IsComplete());
+    EXPECT_TRUE(reader.Feed<kParseStopWhenDoneFlag>("[[[", 3, handler));
+    EXPECT_TRUE(reader.Finish<kParseStopWhenDoneFlag>(handler));
+    EXPECT_EQ("[ u1 ]1 ", handler.events);
+}
+
+TEST(PushReader, Reset) {
+    PushReader reader;
+    const size_t split = 3;
+    Result result = ParseWithPushReader<kParseDefaultFlags>(reader, "[1, x]", &split, 1);
+    EXPECT_FALSE(result.ok);
+    EXPECT_EQ(kParseErrorValueInvalid, result.code);
+    EXPECT_EQ(4u, result.offset);
+
+    // A new text after Reset(), with the offsets starting again at 0
+    reader.Reset();
+    result = ParseWithPushReader<kParseDefaultFlags>(reader, "{\"a\":[true]}", &split, 1);
+    EXPECT_TRUE(result.ok);
+    EXPECT_EQ("{ k:a [ true ]1 }1 ", result.events);
+    EXPECT_TRUE(reader.IsComplete());
+
+    reader.Reset();
+    EXPECT_FALSE(reader.IsComplete());
+    result = ParseWithPushReader<kParseDefaultFlags>(reader, "[1 2]", &split, 1);
+    EXPECT_EQ(kParseErrorArrayMissCommaOrSquareBracket, result.code);
+    EXPECT_EQ(3u, result.offset);
+}
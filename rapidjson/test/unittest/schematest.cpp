@@ -0,0 +1,325 @@
+// Tencent is pleased to support the open source community by making RapidJSON available.
+//
+// Copyright (C) 2015 THL A29 Limited, a Tencent company, and Milo Yip. All rights reserved.
+//
+// Licensed under the MIT License (the "License"); you may not use this file except
+// in compliance with the License. You may obtain a copy of the License at
+//
+// http://opensource.org/licenses/MIT
+//
+// Unless required by applicable law or agreed to in writing, software distributed
+// under the License is distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR
+// CONDITIONS OF ANY KIND, either express or implied. See the License for the
+// specific language governing permissions and limitations under the License.
+
+
+#include "gtest/gtest.h"
+#include "rapidjson/schema.h"
+#include "rapidjson/stringbuffer.h"
+#include "rapidjson/writer.h"
+#include <string>
+
+using namespace rapidjson;
+
+static std::string Stringify(const Pointer& p) {
+    StringBuffer sb;
+    p.Stringify(sb);
+    return sb.GetString();
+}
+
+//! Validate a JSON text with Reader, then its Document with Accept(), and check the keyword and pointers of the failure.
+static void Validate(const char* schemaJson, const char* json, bool expected, const char* keyword = 0, const char* documentPointer = 0, const char* schemaPointer = 0) {
+    SCOPED_TRACE(std::string(schemaJson) + " " + json);
+    Document sd;
+    sd.Parse(schemaJson);
+    ASSERT_FALSE(sd.HasParseError());
+    SchemaDocument schema(sd);
+
+    SchemaValidator validator(schema);
+    Reader reader;
+    StringStream s(json);
+    EXPECT_EQ(expected, static_cast<bool>(reader.Parse(s, validator)));
+    EXPECT_EQ(expected, validator.IsValid());
+    if (!expected) {
+        if (keyword) {
+            ASSERT_TRUE(validator.GetInvalidSchemaKeyword() != 0);
+            EXPECT_STREQ(keyword, validator.GetInvalidSchemaKeyword());
+        }
+        if (documentPointer) {
+            EXPECT_EQ(documentPointer, Stringify(validator.GetInvalidDocumentPointer()));
+        }
+        if (schemaPointer) {
+            EXPECT_EQ(schemaPointer, Stringify(validator.GetInvalidSchemaPointer()));
+        }
+    }
+
+    Document d;
+    d.Parse(json);
+    ASSERT_FALSE(d.HasParseError());
+    SchemaValidator documentValidator(schema);
+    d.Accept(documentValidator);
+    EXPECT_EQ(expected, documentValidator.IsValid());
+}
+
+static const char kPerson[] = "{\"type\":\"object\",\"properties\":{\"name\":{\"type\":\"string\"},\"age\":{\"type\":\"integer\",\"minimum\":0}},\"required\":[\"name\"],\"additionalProperties\":false}";
+static const char kTree[] = "{\"definitions\":{\"node\":{\"type\":\"object\",\"properties\":{\"value\":{\"type\":\"integer\"},\"children\":{\"type\":\"array\",\"items\":{\"$ref\":\"#/definitions/node\"}}},\"required\":[\"value\"]}},\"$ref\":\"#/definitions/node\"}";
+
+TEST(SchemaValidator, Type) {
+    Validate("{}", "[1,{\"a\":null},\"x\"]", true);
+    Validate("{\"type\":\"string\"}", "\"x\"", true);
+    Validate("{\"type\":\"string\"}", "1", false, "type", "");
+    Validate("{\"type\":\"integer\"}", "1", true);
+    Validate("{\"type\":\"integer\"}", "1.5", false, "type");
+    Validate("{\"type\":\"number\"}", "1", true);
+    Validate("{\"type\":\"number\"}", "-1.5", true);
+    Validate("{\"type\":[\"null\",\"boolean\"]}", "true", true);
+    Validate("{\"type\":[\"null\",\"boolean\"]}", "null", true);
+    Validate("{\"type\":[\"null\",\"boolean\"]}", "{}", false, "type");
+    Validate("{\"type\":\"array\"}", "[]", true);
+    Validate("{\"type\":\"object\"}", "[]", false, "type");
+    Validate("true", "[1]", true);
+    Validate("false", "1", false, "type");
+}
+
+TEST(SchemaValidator, Enum) {
+    Validate("{\"enum\":[\"red\",1,{\"a\":[1,2]},null]}", "\"red\"", true);
+    Validate("{\"enum\":[\"red\",1,{\"a\":[1,2]},null]}", "1.0", true);
+    Validate("{\"enum\":[\"red\",1,{\"a\":[1,2],\"b\":2}]}", "{\"b\":2,\"a\":[1,2]}", true);
+    Validate("{\"enum\":[\"red\",1,{\"a\":[1,2]}]}", "{\"a\":[2,1]}", false, "enum");
+    Validate("{\"enum\":[\"red\",1]}", "\"blue\"", false, "enum");
+    Validate("{\"enum\":[-1]}", "-1", true);
+    Validate("{\"enum\":[-1]}", "1", false);
+    Validate("{\"const\":\"a\"}", "\"b\"", false, "const");
+    Validate("{\"properties\":{\"c\":{\"enum\":[\"x\"]}}}", "{\"c\":\"y\"}", false, "enum", "/c", "/properties/c");
+}
+
+TEST(SchemaValidator, Number) {
+    Validate("{\"minimum\":1}", "1", true);
+    Validate("{\"minimum\":1}", "0.5", false, "minimum");
+    Validate("{\"minimum\":1,\"exclusiveMinimum\":true}", "1", false, "minimum");
+    Validate("{\"exclusiveMinimum\":1}", "1", false, "minimum");
+    Validate("{\"exclusiveMinimum\":1}", "1.01", true);
+    Validate("{\"maximum\":10}", "10", true);
+    Validate("{\"maximum\":10,\"exclusiveMaximum\":true}", "10", false, "maximum");
+    Validate("{\"exclusiveMaximum\":10}", "9", true);
+    Validate("{\"maximum\":-5}", "-6", true);
+    Validate("{\"maximum\":-5}", "-4", false);
+    Validate("{\"multipleOf\":3}", "9", true);
+    Validate("{\"multipleOf\":3}", "-9", true);
+    Validate("{\"multipleOf\":3}", "10", false, "multipleOf");
+    Validate("{\"multipleOf\":3}", "9.5", false, "multipleOf");
+    Validate("{\"multipleOf\":0.5}", "4.5", true);
+    Validate("{\"multipleOf\":0.5}", "4", true);
+    Validate("{\"multipleOf\":0.5}", "4.25", false);
+    Validate("{\"multipleOf\":7}", "18446744073709551615", false);
+    Validate("{\"multipleOf\":5}", "18446744073709551615", true);
+}
+
+TEST(SchemaValidator, String) {
+    Validate("{\"minLength\":2,\"maxLength\":3}", "\"ab\"", true);
+    Validate("{\"minLength\":2,\"maxLength\":3}", "\"a\"", false, "minLength");
+    Validate("{\"minLength\":2,\"maxLength\":3}", "\"abcd\"", false, "maxLength");
+    Validate("{\"maxLength\":2}", "\"\\u00e9\\u00e9\"", true);
+    Validate("{\"maxLength\":1}", "\"\\ud83d\\ude00\"", true);
+#if RAPIDJSON_SCHEMA_USE_STDREGEX
+    Validate("{\"pattern\":\"^[a-z]+$\"}", "\"abc\"", true);
+    Validate("{\"pattern\":\"^[a-z]+$\"}", "\"aBc\"", false, "pattern");
+    Validate("{\"pattern\":\"b\"}", "\"abc\"", true);
+    Validate("{\"pattern\":\"(\"}", "\"abc\"", true); // invalid regex ignored
+    Validate("{\"patternProperties\":{\"^x-\":{\"type\":\"string\"}},\"additionalProperties\":false}", "{\"x-a\":\"s\"}", true);
+    Validate("{\"patternProperties\":{\"^x-\":{\"type\":\"string\"}},\"additionalProperties\":false}", "{\"x-a\":1}", false, "patternProperties", "/x-a");
+    Validate("{\"patternProperties\":{\"^x-\":{\"type\":\"string\"}},\"additionalProperties\":false}", "{\"y\":1}", false, "additionalProperties", "/y");
+    Validate("{\"properties\":{\"x-a\":{\"minLength\":3}},\"patternProperties\":{\"^x-\":{\"maxLength\":4}}}", "{\"x-a\":\"abcde\"}", false, "patternProperties");
+    Validate("{\"properties\":{\"x-a\":{\"minLength\":3}},\"patternProperties\":{\"^x-\":{\"maxLength\":4}}}", "{\"x-a\":\"ab\"}", false, "minLength");
+    Validate("{\"properties\":{\"x-a\":{\"minLength\":3}},\"patternProperties\":{\"^x-\":{\"maxLength\":4}}}", "{\"x-a\":\"abcd\"}", true);
+#endif
+}
+
+TEST(SchemaValidator, Object) {
+    Validate(kPerson, "{\"name\":\"a\",\"age\":3}", true);
+    Validate(kPerson, "{\"age\":3}", false, "required", "");
+    Validate(kPerson, "{\"name\":\"a\",\"age\":-3}", false, "minimum", "/age", "/properties/age");
+    Validate(kPerson, "{\"name\":\"a\",\"x\":1}", false, "additionalProperties", "/x");
+    Validate("{\"additionalProperties\":{\"type\":\"number\"}}", "{\"a\":1,\"b\":2.5}", true);
+    Validate("{\"additionalProperties\":{\"type\":\"number\"}}", "{\"a\":1,\"b\":\"x\"}", false, "type", "/b", "/additionalProperties");
+    Validate("{\"minProperties\":1,\"maxProperties\":2}", "{}", false, "minProperties");
+    Validate("{\"minProperties\":1,\"maxProperties\":2}", "{\"a\":1,\"b\":1,\"c\":1}", false, "maxProperties");
+    Validate("{\"minProperties\":1,\"maxProperties\":2}", "{\"a\":1}", true);
+    Validate("{\"dependencies\":{\"card\":[\"billing\"]}}", "{\"card\":1}", false, "dependencies");
+    Validate("{\"dependencies\":{\"card\":[\"billing\"]}}", "{\"card\":1,\"billing\":2}", true);
+    Validate("{\"dependencies\":{\"card\":[\"billing\"]}}", "{\"billing\":2}", true);
+    Validate("{\"dependencies\":{\"card\":{\"required\":[\"billing\"]}}}", "{\"card\":1}", false, "dependencies");
+    Validate("{\"dependencies\":{\"card\":{\"required\":[\"billing\"]}}}", "{\"card\":1,\"billing\":1}", true);
+    Validate("{\"dependencies\":{\"card\":{\"required\":[\"billing\"]}}}", "{\"x\":1}", true);
+    Validate("{\"properties\":{\"a/b\":{\"type\":\"null\"},\"c~d\":{\"properties\":{\"e\":{\"type\":\"null\"}}}}}", "{\"c~d\":{\"e\":1}}", false, "type", "/c~0d/e", "/properties/c~0d/properties/e");
+    Validate("{\"properties\":{\"a/b\":{\"type\":\"null\"}}}", "{\"a/b\":1}", false, "type", "/a~1b", "/properties/a~1b");
+}
+
+TEST(SchemaValidator, Array) {
+    Validate("{\"items\":{\"type\":\"integer\"}}", "[1,2,3]", true);
+    Validate("{\"items\":{\"type\":\"integer\"}}", "[1,2,\"x\"]", false, "type", "/2", "/items");
+    Validate("{\"items\":[{\"type\":\"integer\"},{\"type\":\"string\"}]}", "[1,\"x\",null]", true);
+    Validate("{\"items\":[{\"type\":\"integer\"},{\"type\":\"string\"}],\"additionalItems\":false}", "[1,\"x\",null]", false, "additionalItems", "/2");
+    Validate("{\"items\":[{\"type\":\"integer\"},{\"type\":\"string\"}],\"additionalItems\":false}", "[1,2]", false, "type", "/1", "/items/1");
+    Validate("{\"items\":[{\"type\":\"integer\"}],\"additionalItems\":{\"type\":\"null\"}}", "[1,null,null]", true);
+    Validate("{\"items\":[{\"type\":\"integer\"}],\"additionalItems\":{\"type\":\"null\"}}", "[1,null,2]", false, "type", "/2");
+    Validate("{\"additionalItems\":false}", "[1,2]", true);
+    Validate("{\"minItems\":1,\"maxItems\":2}", "[]", false, "minItems");
+    Validate("{\"minItems\":1,\"maxItems\":2}", "[1,2,3]", false, "maxItems");
+    Validate("{\"uniqueItems\":true}", "[1,2,\"1\",{\"a\":1},[1]]", true);
+    Validate("{\"uniqueItems\":true}", "[1,2,1.0]", false, "uniqueItems", "");
+    Validate("{\"uniqueItems\":true}", "[{\"a\":1,\"b\":2},{\"b\":2,\"a\":1}]", false, "uniqueItems");
+    Validate("{\"items\":{\"uniqueItems\":true}}", "[[1,2],[2,2]]", false, "uniqueItems", "/1");
+    Validate("{\"uniqueItems\":true,\"items\":{\"enum\":[1,2,3]}}", "[1,2,3]", true);
+    Validate("{\"uniqueItems\":true,\"items\":{\"enum\":[1,2,3]}}", "[1,2,4]", false, "enum", "/2");
+}
+
+TEST(SchemaValidator, Combinators) {
+    Validate("{\"allOf\":[{\"type\":\"string\"},{\"maxLength\":3}]}", "\"abc\"", true);
+    Validate("{\"allOf\":[{\"type\":\"string\"},{\"maxLength\":3}]}", "\"abcd\"", false, "allOf");
+    Validate("{\"anyOf\":[{\"type\":\"string\"},{\"type\":\"number\"}]}", "1", true);
+    Validate("{\"anyOf\":[{\"type\":\"string\"},{\"type\":\"number\"}]}", "null", false, "anyOf");
+    Validate("{\"oneOf\":[{\"multipleOf\":3},{\"multipleOf\":5}]}", "9", true);
+    Validate("{\"oneOf\":[{\"multipleOf\":3},{\"multipleOf\":5}]}", "15", false, "oneOf");
+    Validate("{\"oneOf\":[{\"multipleOf\":3},{\"multipleOf\":5}]}", "7", false, "oneOf");
+    Validate("{\"not\":{\"type\":\"null\"}}", "1", true);
+    Validate("{\"not\":{\"type\":\"null\"}}", "null", false, "not");
+    Validate("{\"anyOf\":[{\"type\":\"object\",\"properties\":{\"a\":{\"type\":\"string\"}},\"required\":[\"a\"]},{\"items\":{\"anyOf\":[{\"type\":\"null\"},{\"uniqueItems\":true}]}}]}",
+          "[null,[1,2],null]", true);
+    Validate("{\"anyOf\":[{\"type\":\"object\",\"properties\":{\"a\":{\"type\":\"string\"}},\"required\":[\"a\"]},{\"items\":{\"anyOf\":[{\"type\":\"null\"},{\"uniqueItems\":true}]}}]}",
+          "[null,[1,1],null]", false, "anyOf");
+    Validate("{\"anyOf\":[{\"type\":\"object\",\"properties\":{\"a\":{\"type\":\"string\"}},\"required\":[\"a\"]},{\"items\":{\"anyOf\":[{\"type\":\"null\"},{\"uniqueItems\":true}]}}]}",
+          "{\"a\":\"x\",\"b\":[1,1]}", true);
+    Validate("{\"properties\":{\"v\":{\"allOf\":[{\"type\":\"object\"},{\"required\":[\"k\"]}]}}}", "{\"v\":{\"k\":[{\"z\":1}]},\"w\":1}", true);
+    Validate("{\"properties\":{\"v\":{\"allOf\":[{\"type\":\"object\"},{\"required\":[\"k\"]}]}}}", "{\"v\":{\"j\":[{\"z\":1}]},\"w\":1}", false, "allOf", "/v", "/properties/v");
+}
+
+TEST(SchemaValidator, Ref) {
+    Validate(kTree, "{\"value\":1,\"children\":[{\"value\":2},{\"value\":3,\"children\":[{\"value\":4}]}]}", true);
+    Validate(kTree, "{\"value\":1,\"children\":[{\"value\":2},{\"value\":3,\"children\":[{\"value\":\"x\"}]}]}", false, "type", "/children/1/children/0/value", "/definitions/node/properties/value");
+    Validate(kTree, "{\"value\":1,\"children\":[{\"value\":2},{\"children\":[]}]}", false, "required", "/children/1", "/definitions/node");
+    Validate("{\"properties\":{\"next\":{\"$ref\":\"#\"}},\"type\":\"object\"}", "{\"next\":{\"next\":{}}}", true);
+    Validate("{\"properties\":{\"next\":{\"$ref\":\"#\"}},\"type\":\"object\"}", "{\"next\":{\"next\":1}}", false, "type", "/next/next", "");
+    Validate("{\"items\":{\"$ref\":\"#/definitions/p\"},\"definitions\":{\"p\":{\"type\":\"integer\"}}}", "[1,\"a\"]", false, "type", "/1", "/definitions/p");
+}
+
+TEST(SchemaValidator, DuplicateMembers) {
+    // The hashes of duplicate members do not cancel each other
+    Validate("{\"uniqueItems\":true}", "[{\"a\":1,\"a\":1},{}]", true);
+    Validate("{\"enum\":[{}]}", "{\"a\":1,\"a\":1}", false, "enum");
+    Validate("{\"enum\":[{\"a\":1}]}", "{\"a\":1,\"b\":2,\"b\":2}", false, "enum");
+}
+
+TEST(SchemaDocument, UnresolvedReference) {
+    Document sd;
+    sd.Parse(kTree);
+    {
+        SchemaDocument schema(sd);
+        EXPECT_TRUE(schema.IsValid());
+        EXPECT_TRUE(schema.GetInvalidReference() == 0);
+        EXPECT_EQ("", Stringify(schema.GetInvalidReferencePointer()));
+    }
+
+    // Remote reference, reference to a missing value, and cycles of references
+    const char* const kSchemas[][3] = {
+        { "{\"$ref\":\"http://example.com/x.json\"}", "http://example.com/x.json", "" },
+        { "{\"properties\":{\"a\":{\"$ref\":\"#/nope\"}}}", "#/nope", "/properties/a" },
+        { "{\"$ref\":\"#\"}", "#", "" },
+        { "{\"definitions\":{\"a\":{\"$ref\":\"#/definitions/b\"},\"b\":{\"$ref\":\"#/definitions/a\"}},\"items\":{\"$ref\":\"#/definitions/a\"}}", "#/definitions/a", "/definitions/b" }
+    };
+    for (size_t i = 0; i < sizeof(kSchemas) / sizeof(kSchemas[0]); i++) {
+        SCOPED_TRACE(kSchemas[i][0]);
+        sd.Parse(kSchemas[i][0]);
+        ASSERT_FALSE(sd.HasParseError());
+        SchemaDocument schema(sd);
+        EXPECT_FALSE(schema.IsValid());
+        ASSERT_TRUE(schema.GetInvalidReference() != 0);
+        EXPECT_STREQ(kSchemas[i][1], schema.GetInvalidReference());
+        EXPECT_EQ(kSchemas[i][2], Stringify(schema.GetInvalidReferencePointer()));
+
+        // The unresolved reference accepts any value
+        SchemaValidator validator(schema);
+        Reader reader;
+        StringStream s("[1]");
+        EXPECT_TRUE(reader.Parse(s, validator));
+    }
+}
+
+TEST(SchemaValidator, EarlyRejection) {
+    // The reader stops at the first invalid value, before the rest of the text
+    Document sd;
+    sd.Parse("{\"items\":{\"type\":\"integer\"}}");
+    SchemaDocument schema(sd);
+    SchemaValidator validator(schema);
+    Reader reader;
+    StringStream s("[1,2,\"x\",4, this is garbage");
+    const ParseResult result = reader.Parse(s, validator);
+    EXPECT_EQ(kParseErrorTermination, result.Code());
+    EXPECT_LE(result.Offset(), 9u);
+    EXPECT_FALSE(validator.IsValid());
+
+    validator.Reset();
+    StringStream s2("[1,2]");
+    EXPECT_TRUE(reader.Parse(s2, validator));
+    EXPECT_TRUE(validator.IsValid());
+}
+
+TEST(SchemaValidator, OutputHandler) {
+    Document sd;
+    sd.Parse(kPerson);
+    SchemaDocument schema(sd);
+    StringBuffer sb;
+    Writer<StringBuffer> writer(sb);
+    GenericSchemaValidator<SchemaDocument, Writer<StringBuffer> > validator(schema, writer);
+    Reader reader;
+    StringStream s("{\"name\":\"a\",\"age\":3}");
+    EXPECT_TRUE(reader.Parse(s, validator));
+    EXPECT_STREQ("{\"name\":\"a\",\"age\":3}", sb.GetString());
+}
+
+TEST(SchemaValidatingReader, Populate) {
+    typedef SchemaValidatingReader<kParseDefaultFlags, StringStream, UTF8<> > ValidatingReader;
+    Document sd;
+    sd.Parse(kTree);
+    SchemaDocument schema(sd);
+
+    StringStream s("{\"value\":1,\"children\":[{\"value\":2}]}");
+    ValidatingReader reader(s, schema);
+    Document d;
+    d.Populate(reader);
+    EXPECT_TRUE(reader.GetParseResult());
+    EXPECT_TRUE(reader.IsValid());
+    EXPECT_EQ(2, d["children"][0]["value"].GetInt());
+
+    // Invalid: the document is left null
+    StringStream s2("{\"value\":1,\"children\":[{\"value\":true}]}");
+    ValidatingReader reader2(s2, schema);
+    Document d2;
+    d2.Populate(reader2);
+    EXPECT_FALSE(reader2.GetParseResult());
+    EXPECT_FALSE(reader2.IsValid());
+    EXPECT_TRUE(d2.IsNull());
+    EXPECT_STREQ("type", reader2.GetInvalidSchemaKeyword());
+    EXPECT_EQ("/children/0/value", Stringify(reader2.GetInvalidDocumentPointer()));
+
+    // Syntax error: valid so far
+    StringStream s3("{\"value\":1,");
+    ValidatingReader reader3(s3, schema);
+    Document d3;
+    d3.Populate(reader3);
+    EXPECT_FALSE(reader3.GetParseResult());
+    EXPECT_TRUE(reader3.IsValid());
+}
+
+TEST(SchemaValidator, MemoryPoolAllocator) {
+    typedef GenericSchemaDocument<Value, MemoryPoolAllocator<> > PoolSchemaDocument;
+    Document sd;
+    sd.Parse(kTree);
+    MemoryPoolAllocator<> schemaAllocator;
+    PoolSchemaDocument schema(sd, &schemaAllocator);
+    MemoryPoolAllocator<> stateAllocator;
+    GenericSchemaValidator<PoolSchemaDocument, BaseReaderHandler<>, MemoryPoolAllocator<> > validator(schema, &stateAllocator);
+    Reader reader;
+    StringStream s("{\"value\":1,\"children\":[{\"value\":2}]}");
+    EXPECT_TRUE(reader.Parse(s, validator));
+}
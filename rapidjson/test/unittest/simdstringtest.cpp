@@ -0,0 +1,151 @@
+// Tencent is pleased to support the open source community by making RapidJSON available.
+//
+// Copyright (C) 2015 THL A29 Limited, a Tencent company, and Milo Yip. All rights reserved.
+//
+// Licensed under the MIT License (the "License"); you may not use this file except
+// in compliance with the License. You may obtain a copy of the License at
+//
+// http://opensource.org/licenses/MIT
+//
+// Unless required by applicable law or agreed to in writing, software distributed
+// under the License is distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR
+// CONDITIONS OF ANY KIND, either express or implied. See the License for the
+// specific language governing permissions and limitations under the License.
+
+
+// Built once per instruction set (see RAPIDJSON_SSE2/SSE42/AVX2 and CMakeLists.txt): the strings parsed from
+// StringStream/InsituStringStream and written to StringBuffer take the SIMD paths, and are compared with the
+// same strings through derived streams, which take the scalar paths.
+
+#include "gtest/gtest.h"
+#include "rapidjson/document.h"
+#include "rapidjson/writer.h"
+#include "rapidjson/stringbuffer.h"
+#include <cstring>
+#include <string>
+#include <vector>
+
+using namespace rapidjson;
+
+//! Streams of the scalar paths: the SIMD overloads only take the exact stream types.
+struct ScalarStringStream : StringStream {
+    explicit ScalarStringStream(const char* src) : StringStream(src) {}
+};
+
+struct ScalarInsituStringStream : InsituStringStream {
+    explicit ScalarInsituStringStream(char* src) : InsituStringStream(src) {}
+};
+
+struct ScalarStringBuffer : StringBuffer {
+};
+
+//! Buffer aligned on 32 bytes, to place the strings at every offset of a SIMD block.
+class AlignedBuffer {
+public:
+    explicit AlignedBuffer(size_t size) : buffer_(size + 64) {}
+
+    //! Copy a string, null-terminated, at an offset of an aligned address.
+    char* Set(const std::string& s, size_t offset) {
+        char* p = reinterpret_cast<char*>((reinterpret_cast<size_t>(&buffer_[0]) + 31) & ~static_cast<size_t>(31)) + offset;
+        std::memcpy(p, s.data(), s.size());
+        p[s.size()] = '\0';
+        return p;
+    }
+
+private:
+    std::vector<char> buffer_;
+};
+
+//! Characters which need no escaping, including the neighbours of '\"' and '\\', DEL and UTF-8 sequences.
+static std::string Filler(size_t length) {
+    static const char kUnescaped[] = " !#[]\x7F" "a\xC3\xA9" "~";
+    std::string s;
+    for (size_t i = 0; i < length; i++)
+        s += kUnescaped[i % (sizeof(kUnescaped) - 1)];
+    return s;
+}
+
+//! Parse a JSON text through the SIMD and the scalar paths, normal and insitu, and compare the results.
+static void TestParse(const std::string& json, size_t offset) {
+    SCOPED_TRACE(json);
+    AlignedBuffer scalarBuffer(json.size()), simdBuffer(json.size());
+
+    Document expected;
+    ScalarStringStream scalar(scalarBuffer.Set(json, offset));
+    expected.ParseStream<0>(scalar);
+    Document actual;
+    StringStream simd(simdBuffer.Set(json, offset));
+    actual.ParseStream<0>(simd);
+    ASSERT_EQ(expected.GetParseError(), actual.GetParseError());
+    ASSERT_EQ(expected.GetErrorOffset(), actual.GetErrorOffset());
+    if (!expected.HasParseError()) {
+        ASSERT_EQ(std::string(expected.GetString(), expected.GetStringLength()), std::string(actual.GetString(), actual.GetStringLength()));
+    }
+
+    Document expectedInsitu;
+    ScalarInsituStringStream scalarInsitu(scalarBuffer.Set(json, offset));
+    expectedInsitu.ParseStream<kParseInsituFlag>(scalarInsitu);
+    Document actualInsitu;
+    InsituStringStream simdInsitu(simdBuffer.Set(json, offset));
+    actualInsitu.ParseStream<kParseInsituFlag>(simdInsitu);
+    ASSERT_EQ(expected.GetParseError(), expectedInsitu.GetParseError());
+    ASSERT_EQ(expected.GetParseError(), actualInsitu.GetParseError());
+    ASSERT_EQ(expected.GetErrorOffset(), actualInsitu.GetErrorOffset());
+    if (!expected.HasParseError()) {
+        ASSERT_EQ(std::string(expectedInsitu.GetString(), expectedInsitu.GetStringLength()), std::string(actualInsitu.GetString(), actualInsitu.GetStringLength()));
+    }
+}
+
+//! Write a string through the SIMD and the scalar paths, and compare the results.
+static void TestWrite(const std::string& s, size_t offset) {
+    SCOPED_TRACE(s);
+    // Followed by a character to escape, which the scan must not reach past the length
+    const std::string padded = s + Filler(s.size() % 3) + '\\' + Filler(40);
+    AlignedBuffer buffer(padded.size());
+
+    ScalarStringBuffer expected;
+    Writer<ScalarStringBuffer> scalar(expected);
+    ASSERT_TRUE(scalar.String(buffer.Set(padded, offset), static_cast<SizeType>(s.size())));
+    StringBuffer actual;
+    Writer<StringBuffer> simd(actual);
+    ASSERT_TRUE(simd.String(buffer.Set(padded, offset), static_cast<SizeType>(s.size())));
+    ASSERT_STREQ(expected.GetString(), actual.GetString());
+
+    // And back
+    Document d;
+    d.Parse(actual.GetString());
+    ASSERT_FALSE(d.HasParseError());
+    ASSERT_EQ(s, std::string(d.GetString(), d.GetStringLength()));
+}
+
+TEST(SimdString, Parse) {
+    // Escapes, and unescaped control characters or end of text, which are errors
+    static const char* const kSpecials[] = { "\\\"", "\\\\", "\\/", "\\n", "\\u0001", "\\u00e9", "\x01", "\x1F", "\t", "" };
+    for (size_t offset = 0; offset < 32; offset++)
+        for (size_t length = 0; length <= 70; length++) {
+            const std::string filler = Filler(length);
+            TestParse("\"" + filler + "\"", offset);
+            for (size_t i = 0; i < length; i++)
+                for (size_t k = 0; k < sizeof(kSpecials) / sizeof(kSpecials[0]); k++) {
+                    const std::string special = *kSpecials[k] ? kSpecials[k] : std::string(1, '\0');
+                    TestParse("\"" + filler.substr(0, i) + special + filler.substr(i) + "\\t\"", offset);
+                    if (::testing::Test::HasFatalFailure())
+                        return;
+                }
+        }
+}
+
+TEST(SimdString, Write) {
+    static const char kSpecials[] = { '\"', '\\', '\0', '\x01', '\x1F', '\b', '\n', '\t' };
+    for (size_t offset = 0; offset < 32; offset++)
+        for (size_t length = 0; length <= 70; length++) {
+            const std::string filler = Filler(length);
+            TestWrite(filler, offset);
+            for (size_t i = 0; i < length; i++)
+                for (size_t k = 0; k < sizeof(kSpecials); k++) {
+                    TestWrite(filler.substr(0, i) + kSpecials[k] + filler.substr(i) + '\"', offset);
+                    if (::testing::Test::HasFatalFailure())
+                        return;
+                }
+        }
+}